@@ -169,3 +169,24 @@ bool DLL_IGES_ENTITY_120::SetAngles( double aStartAngle, double aEndAngle )
     ((IGES_ENTITY_120*)m_entity)->endAngle = aEndAngle;
     return true;
 }
+
+
+bool DLL_IGES_ENTITY_120::GetParameterRange( double& aT0, double& aT1,
+    double& aTheta0, double& aTheta1 )
+{
+    if( !m_valid || NULL == m_entity )
+        return false;
+
+    return ((IGES_ENTITY_120*)m_entity)->GetParameterRange( aT0, aT1, aTheta0, aTheta1 );
+}
+
+
+bool DLL_IGES_ENTITY_120::Evaluate( size_t aNParams, const double* aT, const double* aTheta,
+    MCAD_POINT* aPoint, MCAD_POINT* aDerivT, MCAD_POINT* aDerivTheta, bool xform )
+{
+    if( !m_valid || NULL == m_entity )
+        return false;
+
+    return ((IGES_ENTITY_120*)m_entity)->Evaluate( aNParams, aT, aTheta, aPoint,
+        aDerivT, aDerivTheta, xform );
+}
@@ -119,6 +119,7 @@ bool DLL_IGES_ENTITY_124::SetRootTransform( MCAD_TRANSFORM* aTX )
         return false;
 
     ((IGES_ENTITY_124*)m_entity)->T = *aTX;
+    m_entity->Touch();
     return true;
 }
 
@@ -129,5 +130,6 @@ bool DLL_IGES_ENTITY_124::SetRootTransform( MCAD_TRANSFORM& aTX )
         return false;
 
     ((IGES_ENTITY_124*)m_entity)->T = aTX;
+    m_entity->Touch();
     return true;
 }
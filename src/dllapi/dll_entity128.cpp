@@ -171,3 +171,15 @@ bool DLL_IGES_ENTITY_128::isPeriodic2( bool& aResult )
     aResult = ((IGES_ENTITY_128*)m_entity)->isPeriodic2();
     return true;
 }
+
+
+bool DLL_IGES_ENTITY_128::EvaluateGrid( size_t aNU, const double* aU, size_t aNV,
+    const double* aV, MCAD_POINT* aPoint, MCAD_POINT* aDerivU, MCAD_POINT* aDerivV,
+    MCAD_POINT* aNormal, bool xform )
+{
+    if( !m_valid || NULL == m_entity )
+        return false;
+
+    return ((IGES_ENTITY_128*)m_entity)->EvaluateGrid( aNU, aU, aNV, aV, aPoint,
+        aDerivU, aDerivV, aNormal, xform );
+}
@@ -23,6 +23,8 @@
  */
 
 
+#include <vector>
+#include <error_macros.h>
 #include <api/dll_entity142.h>
 #include <api/dll_iges.h>
 #include <core/iges.h>
@@ -225,3 +227,32 @@ bool DLL_IGES_ENTITY_142::SetCurveCreationFlag( CURVE_CREATION aFlag )
     ((IGES_ENTITY_142*)m_entity)->CRTN = (int)aFlag;
     return true;
 }
+
+
+bool DLL_IGES_ENTITY_142::GetPolyline( MCAD_POINT*& aPointList, int& aNumPoints, double aTolerance,
+    bool xform )
+{
+    if( !m_valid || NULL == m_entity )
+    {
+        return false;
+    }
+
+    if( NULL != aPointList || 0 != aNumPoints )
+    {
+        ERRMSG << "\n + [BUG] aPointList is not NULL or aNumPoints is not 0\n";
+        return false;
+    }
+
+    std::vector<MCAD_POINT> points;
+
+    if( !((IGES_ENTITY_142*)m_entity)->GetPolyline( points, aTolerance, xform ) || points.empty() )
+        return false;
+
+    aNumPoints = (int)points.size();
+    aPointList = new MCAD_POINT[aNumPoints];
+
+    for( int i = 0; i < aNumPoints; ++i )
+        aPointList[i] = points[i];
+
+    return true;
+}
@@ -204,3 +204,24 @@ bool DLL_IGES_ENTITY_144::DelCutout( DLL_IGES_ENTITY_142& aPtr )
 
     return ((IGES_ENTITY_144*)m_entity)->DelPTI( (IGES_ENTITY_142*) aPtr.GetRawPtr() );
 }
+
+
+bool DLL_IGES_ENTITY_144::ClassifyPoints( size_t aNPoints, const double* aU,
+    const double* aV, bool* aInside, double aTolerance )
+{
+    if( !m_valid || NULL == m_entity )
+        return false;
+
+    return ((IGES_ENTITY_144*)m_entity)->ClassifyPoints( aNPoints, aU, aV,
+        aInside, aTolerance );
+}
+
+
+bool DLL_IGES_ENTITY_144::ClearTrimCache( void )
+{
+    if( !m_valid || NULL == m_entity )
+        return false;
+
+    ((IGES_ENTITY_144*)m_entity)->ClearTrimCache();
+    return true;
+}
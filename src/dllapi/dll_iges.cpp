@@ -97,6 +97,42 @@ void DLL_IGES::Cull( bool vicious )
 }
 
 
+bool DLL_IGES::Deduplicate( IGES_DEDUP_STATS* aStats )
+{
+    if( m_valid && NULL != m_iges )
+        return m_iges->Deduplicate( aStats );
+
+    ERRMSG << "\n + [BUG] invoked with invalid IGES object\n";
+    return false;
+}
+
+
+bool DLL_IGES::GetEntitiesByType( IGES_ENTITY_TYPE aEntityType, size_t& aListSize,
+    IGES_ENTITY* const*& aList )
+{
+    if( m_valid && NULL != m_iges )
+        return m_iges->GetEntitiesByType( aEntityType, aListSize, aList );
+
+    ERRMSG << "\n + [BUG] invoked with invalid IGES object\n";
+    aListSize = 0;
+    aList = NULL;
+    return false;
+}
+
+
+bool DLL_IGES::GetEntities( const IGES_QUERY& aQuery, size_t& aListSize,
+    IGES_ENTITY* const*& aList )
+{
+    if( m_valid && NULL != m_iges )
+        return m_iges->GetEntities( aQuery, aListSize, aList );
+
+    ERRMSG << "\n + [BUG] invoked with invalid IGES object\n";
+    aListSize = 0;
+    aList = NULL;
+    return false;
+}
+
+
 bool DLL_IGES::Clear( void )
 {
     if( !m_valid || NULL == m_iges )
@@ -117,3 +117,33 @@ int DLL_IGES_CURVE::GetNSegments( void )
 
     return ((IGES_CURVE*)m_entity)->GetNSegments();
 }
+
+
+bool DLL_IGES_CURVE::GetPolyline( MCAD_POINT*& aPointList, int& aNumPoints, double aTolerance,
+    bool xform )
+{
+    if( !m_valid || NULL == m_entity )
+    {
+        ERRMSG << "\n + [BUG] invalid IGES_ENTITY object\n";
+        return false;
+    }
+
+    if( NULL != aPointList || 0 != aNumPoints )
+    {
+        ERRMSG << "\n + [BUG] aPointList is not NULL or aNumPoints is not 0\n";
+        return false;
+    }
+
+    std::vector<MCAD_POINT> points;
+
+    if( !((IGES_CURVE*)m_entity)->GetPolyline( points, aTolerance, xform ) || points.empty() )
+        return false;
+
+    aNumPoints = (int)points.size();
+    aPointList = new MCAD_POINT[aNumPoints];
+
+    for( int i = 0; i < aNumPoints; ++i )
+        aPointList[i] = points[i];
+
+    return true;
+}
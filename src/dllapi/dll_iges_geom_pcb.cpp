@@ -35,6 +35,7 @@
 #include <core/iges_curve.h>
 #include <core/entity126.h>
 #include <core/entity144.h>
+#include <core/entity408.h>
 #include <error_macros.h>
 
 DLL_IGES_GEOM_PCB::DLL_IGES_GEOM_PCB( bool create ) : DLL_MCAD_OUTLINE( false )
@@ -142,6 +143,62 @@ bool DLL_IGES_GEOM_PCB::GetVerticalSurface( IGES* aModel, bool& error,
 }
 
 
+// append the items of a list to a dynamic array
+template <class T> static void appendList( std::vector<T*>& aItems, T**& aList, int& nItems )
+{
+    if( aItems.empty() )
+        return;
+
+    int ts = (int)aItems.size();
+    int i = 0;
+    T** pl = NULL;
+
+    if( nItems > 0 && NULL != aList )
+    {
+        ts += nItems;
+        pl = new T*[ts];
+
+        for( i = 0; i < nItems; ++i )
+            pl[i] = aList[i];
+
+        delete [] aList;
+    }
+    else
+    {
+        pl = new T*[ts];
+    }
+
+    for( size_t j = 0; j < aItems.size(); ++j, ++i )
+        pl[i] = aItems[j];
+
+    nItems = ts;
+    aList = pl;
+    return;
+}
+
+
+bool DLL_IGES_GEOM_PCB::GetVerticalSurface( IGES* aModel, bool& error,
+    IGES_ENTITY_144**& aSurfaceList, int& nSurfaces,
+    IGES_ENTITY_408**& aDrillList, int& nDrills,
+    double aTopZ, double aBotZ )
+{
+    if( NULL == m_outline || !m_valid )
+        return false;
+
+    std::vector< IGES_ENTITY_144* > surfs;
+    std::vector< IGES_ENTITY_408* > drills;
+
+    if( !((IGES_GEOM_PCB*)m_outline)->GetVerticalSurface( aModel, error,
+        surfs, drills, aTopZ, aBotZ ) )
+        return false;
+
+    appendList( surfs, aSurfaceList, nSurfaces );
+    appendList( drills, aDrillList, nDrills );
+
+    return true;
+}
+
+
 bool DLL_IGES_GEOM_PCB::GetTrimmedPlane( IGES* aModel, bool& error,
     IGES_ENTITY_144**& aSurfaceList,
     int& nSurfaces, double aHeight, bool aReverse )
@@ -169,15 +169,15 @@ bool DLL_MCAD_OUTLINE::GetCutouts( MCAD_OUTLINE**& aCutoutList, int& aListSize )
     if( NULL == m_outline || !m_valid )
         return false;
 
-    std::list<MCAD_OUTLINE*>* lp = m_outline->GetCutouts();
+    const std::list<MCAD_OUTLINE*>* lp = m_outline->GetCutouts();
 
     if( NULL == lp || 0 == lp->size() )
         return false;
 
     aListSize = (int)lp->size();
     aCutoutList = new MCAD_OUTLINE*[aListSize];
-    std::list<MCAD_OUTLINE*>::iterator sL = lp->begin();
-    std::list<MCAD_OUTLINE*>::iterator eL = lp->end();
+    std::list<MCAD_OUTLINE*>::const_iterator sL = lp->begin();
+    std::list<MCAD_OUTLINE*>::const_iterator eL = lp->end();
     int i = 0;
 
     while( sL != eL )
@@ -420,6 +420,50 @@ bool DLL_MCAD_OUTLINE::SubOutline( DLL_MCAD_SEGMENT& aCircle, bool& error )
 }
 
 
+bool DLL_MCAD_OUTLINE::AddOutlines( MCAD_SEGMENT** aCircleList, int& aListSize, bool& error )
+{
+    if( NULL == m_outline || !m_valid || NULL == aCircleList || aListSize <= 0 )
+        return false;
+
+    std::list<MCAD_SEGMENT*> cl( aCircleList, aCircleList + aListSize );
+    bool res = m_outline->AddOutlines( cl, error );
+    std::list<MCAD_SEGMENT*>::iterator sC = cl.begin();
+    std::list<MCAD_SEGMENT*>::iterator eC = cl.end();
+
+    aListSize = 0;
+
+    while( sC != eC )
+    {
+        aCircleList[aListSize++] = *sC;
+        ++sC;
+    }
+
+    return res;
+}
+
+
+bool DLL_MCAD_OUTLINE::SubOutlines( MCAD_SEGMENT** aCircleList, int& aListSize, bool& error )
+{
+    if( NULL == m_outline || !m_valid || NULL == aCircleList || aListSize <= 0 )
+        return false;
+
+    std::list<MCAD_SEGMENT*> cl( aCircleList, aCircleList + aListSize );
+    bool res = m_outline->SubOutlines( cl, error );
+    std::list<MCAD_SEGMENT*>::iterator sC = cl.begin();
+    std::list<MCAD_SEGMENT*>::iterator eC = cl.end();
+
+    aListSize = 0;
+
+    while( sC != eC )
+    {
+        aCircleList[aListSize++] = *sC;
+        ++sC;
+    }
+
+    return res;
+}
+
+
 bool DLL_MCAD_OUTLINE::AddCutout( MCAD_OUTLINE* aCutout, bool overlaps, bool& error )
 {
     if( NULL == m_outline || !m_valid )
@@ -470,3 +514,12 @@ bool DLL_MCAD_OUTLINE::AddCutout( DLL_MCAD_SEGMENT& aCircle, bool overlaps, bool
 
     return false;
 }
+
+
+bool DLL_MCAD_OUTLINE::Simplify( double aTolerance, bool& error, MCAD_SIMPLIFY_STATS* aStats )
+{
+    if( NULL == m_outline || !m_valid )
+        return false;
+
+    return m_outline->Simplify( aTolerance, error, aStats );
+}
@@ -478,3 +478,97 @@ IGES_CURVE* IGES_ENTITY_100::GetCurve( int index )
 {
     return NULL;
 }
+
+
+bool IGES_ENTITY_100::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    MCAD_POINT c( xCenter, yCenter, zOffset );
+    MCAD_POINT ps( xStart, yStart, zOffset );
+    MCAD_POINT pe( xEnd, yEnd, zOffset );
+    double dx = xStart - xCenter;
+    double dy = yStart - yCenter;
+    double r = sqrt( dx * dx + dy * dy );
+    double a0 = atan2( dy, dx );
+    double a1 = atan2( yEnd - yCenter, xEnd - xCenter );
+
+    // the arc runs counterclockwise from the start point to the end point;
+    // coincident points represent a full circle
+    if( a1 <= a0 )
+        a1 += 2.0 * M_PI;
+
+    aBox.Add( ps );
+    aBox.Add( pe );
+
+    // include any extremes (0, 90, 180, 270 degrees) swept by the arc
+    for( int i = -4; i < 8; ++i )
+    {
+        double ang = i * M_PI * 0.5;
+
+        if( ang > a0 && ang < a1 )
+            aBox.Add( MCAD_POINT( xCenter + r * cos( ang ), yCenter + r * sin( ang ), zOffset ) );
+    }
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+bool IGES_ENTITY_100::AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+    bool xform )
+{
+    double dx = xStart - xCenter;
+    double dy = yStart - yCenter;
+    double r = sqrt( dx * dx + dy * dy );
+    double a0 = atan2( dy, dx );
+    double a1 = atan2( yEnd - yCenter, xEnd - xCenter );
+
+    // the arc runs counterclockwise from the start point to the end point;
+    // coincident points represent a full circle
+    if( a1 <= a0 )
+        a1 += 2.0 * M_PI;
+
+    // the chord error of a step 'da' is r * (1 - cos(da/2)) so the
+    // arc is divided into equal steps which satisfy the tolerance
+    double da = M_PI * 0.5;
+
+    if( aTolerance < r )
+    {
+        double ds = 2.0 * acos( 1.0 - aTolerance / r );
+
+        if( ds < da )
+            da = ds;
+    }
+
+    double sweep = a1 - a0;
+    int ns = (int)ceil( sweep / da );
+
+    if( ns < 1 )
+        ns = 1;
+
+    da = sweep / ns;
+    size_t first = aPoints.size();
+    aPoints.push_back( MCAD_POINT( xStart, yStart, zOffset ) );
+
+    for( int i = 1; i < ns; ++i )
+    {
+        double ang = a0 + i * da;
+        aPoints.push_back( MCAD_POINT( xCenter + r * cos( ang ), yCenter + r * sin( ang ), zOffset ) );
+    }
+
+    // use the exact end point to avoid a gap in composite curves
+    aPoints.push_back( MCAD_POINT( xEnd, yEnd, zOffset ) );
+
+    if( xform && pTransform )
+    {
+        MCAD_TRANSFORM T = pTransform->GetTransformMatrix();
+
+        for( size_t i = first; i < aPoints.size(); ++i )
+            aPoints[i] = T * aPoints[i];
+    }
+
+    return true;
+}
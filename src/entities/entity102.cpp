@@ -722,6 +722,8 @@ bool IGES_ENTITY_102::IsClosed( void )
 
 bool IGES_ENTITY_102::AddSegment( IGES_CURVE* aSegment )
 {
+    Touch();
+
     if( !aSegment )
     {
         ERRMSG << "\n + [ERROR] null pointer passed as aSegment\n";
@@ -764,3 +766,88 @@ bool IGES_ENTITY_102::AddSegment( IGES_CURVE* aSegment )
 
     return true;
 }
+
+
+bool IGES_ENTITY_102::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    if( curves.empty() )
+        return false;
+
+    std::list<IGES_CURVE*>::iterator sc = curves.begin();
+    std::list<IGES_CURVE*>::iterator ec = curves.end();
+    MCAD_BOX cb;
+
+    while( sc != ec )
+    {
+        // Point entities have no bounds and are ignored
+        if( (*sc)->GetBounds( cb, xform ) )
+            aBox.Add( cb );
+
+        ++sc;
+    }
+
+    if( aBox.IsEmpty() )
+        return false;
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+bool IGES_ENTITY_102::AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+    bool xform )
+{
+    if( curves.empty() )
+        return false;
+
+    size_t first = aPoints.size();
+    std::list<IGES_CURVE*>::iterator sc = curves.begin();
+    std::list<IGES_CURVE*>::iterator ec = curves.end();
+    // first point of each segment after the first
+    std::vector<size_t> joins;
+
+    while( sc != ec )
+    {
+        if( aPoints.size() > first && ( joins.empty() || joins.back() != aPoints.size() ) )
+            joins.push_back( aPoints.size() );
+
+        if( !(*sc)->AddPolyline( aPoints, aTolerance, xform ) )
+            return false;
+
+        ++sc;
+    }
+
+    // the first point of a segment normally coincides with the last point
+    // of the previous segment; such points are removed in a single pass
+    size_t dst = first;
+    size_t nj = 0;
+
+    for( size_t i = first; i < aPoints.size(); ++i )
+    {
+        if( nj < joins.size() && joins[nj] == i )
+        {
+            ++nj;
+
+            if( dst > first && PointMatches( aPoints[dst - 1], aPoints[i], aTolerance ) )
+                continue;
+        }
+
+        aPoints[dst++] = aPoints[i];
+    }
+
+    aPoints.resize( dst );
+
+    if( xform && pTransform )
+    {
+        MCAD_TRANSFORM T = pTransform->GetTransformMatrix();
+
+        for( size_t i = first; i < aPoints.size(); ++i )
+            aPoints[i] = T * aPoints[i];
+    }
+
+    return true;
+}
@@ -426,3 +426,293 @@ IGES_CURVE* IGES_ENTITY_104::GetCurve( int index )
 {
     return NULL;
 }
+
+
+bool IGES_ENTITY_104::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+    aBox.Add( MCAD_POINT( X1, Y1, ZT ) );
+    aBox.Add( MCAD_POINT( X2, Y2, ZT ) );
+
+    // note: the axes of the conic are parallel to Xt and Yt (B = 0)
+    if( 1 == getForm() )
+    {
+        // ellipse: use the bounds of the entire ellipse
+        double xc = -D / ( 2.0 * A );
+        double yc = -E / ( 2.0 * C );
+        double k = A * xc * xc + C * yc * yc - F;
+        double rx = sqrt( fabs( k / A ) );
+        double ry = sqrt( fabs( k / C ) );
+        aBox.Add( MCAD_POINT( xc - rx, yc - ry, ZT ) );
+        aBox.Add( MCAD_POINT( xc + rx, yc + ry, ZT ) );
+    }
+    else
+    {
+        // hyperbola or parabola: a single branch is monotonic in each
+        // coordinate except at the points where the tangent is parallel
+        // to an axis; include such points if they lie between the ends
+        if( 0.0 != C )
+        {
+            // vertical tangent at y = -E/2C
+            double y0 = -E / ( 2.0 * C );
+            double c0 = C * y0 * y0 + E * y0 + F;
+
+            if( ( Y1 - y0 ) * ( Y2 - y0 ) < 0.0 )
+            {
+                double x0 = 0.0;
+                bool ok = false;
+
+                if( 0.0 != A )
+                {
+                    double disc = D * D - 4.0 * A * c0;
+
+                    if( disc >= 0.0 )
+                    {
+                        // take the root on the same branch as the endpoints
+                        double xa = ( -D + sqrt( disc ) ) / ( 2.0 * A );
+                        double xb = ( -D - sqrt( disc ) ) / ( 2.0 * A );
+                        x0 = ( fabs( xa - X1 ) < fabs( xb - X1 ) ) ? xa : xb;
+                        ok = true;
+                    }
+                }
+                else if( 0.0 != D )
+                {
+                    x0 = -c0 / D;
+                    ok = true;
+                }
+
+                if( ok )
+                    aBox.Add( MCAD_POINT( x0, y0, ZT ) );
+            }
+        }
+
+        if( 0.0 != A )
+        {
+            // horizontal tangent at x = -D/2A
+            double x0 = -D / ( 2.0 * A );
+            double c0 = A * x0 * x0 + D * x0 + F;
+
+            if( ( X1 - x0 ) * ( X2 - x0 ) < 0.0 )
+            {
+                double y0 = 0.0;
+                bool ok = false;
+
+                if( 0.0 != C )
+                {
+                    double disc = E * E - 4.0 * C * c0;
+
+                    if( disc >= 0.0 )
+                    {
+                        double ya = ( -E + sqrt( disc ) ) / ( 2.0 * C );
+                        double yb = ( -E - sqrt( disc ) ) / ( 2.0 * C );
+                        y0 = ( fabs( ya - Y1 ) < fabs( yb - Y1 ) ) ? ya : yb;
+                        ok = true;
+                    }
+                }
+                else if( 0.0 != E )
+                {
+                    y0 = -c0 / E;
+                    ok = true;
+                }
+
+                if( ok )
+                    aBox.Add( MCAD_POINT( x0, y0, ZT ) );
+            }
+        }
+    }
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+// parameterizations of the conic used by AddPolyline()
+enum CONIC_KIND
+{
+    CONIC_ELLIPSE = 0,  // x = xc + a cos(t), y = yc + b sin(t)
+    CONIC_HYPER_X,      // x = xc + s a cosh(t), y = yc + b sinh(t)
+    CONIC_HYPER_Y,      // x = xc + a sinh(t), y = yc + s b cosh(t)
+    CONIC_PARAB_X,      // x = t, y = -(A t^2 + D t + F) / E
+    CONIC_PARAB_Y       // x = -(C t^2 + E t + F) / D, y = t
+};
+
+struct CONIC_PARAM
+{
+    CONIC_KIND kind;
+    double xc;
+    double yc;
+    double a;
+    double b;
+    double s;       // branch of a hyperbola (+1/-1)
+    const IGES_ENTITY_104* conic;
+};
+
+
+static bool evalConic( void* aData, double aParam, MCAD_POINT& aPoint )
+{
+    const CONIC_PARAM* cp = (const CONIC_PARAM*)aData;
+    const IGES_ENTITY_104* c = cp->conic;
+
+    aPoint.z = c->ZT;
+
+    switch( cp->kind )
+    {
+        case CONIC_ELLIPSE:
+            aPoint.x = cp->xc + cp->a * cos( aParam );
+            aPoint.y = cp->yc + cp->b * sin( aParam );
+            break;
+
+        case CONIC_HYPER_X:
+            aPoint.x = cp->xc + cp->s * cp->a * cosh( aParam );
+            aPoint.y = cp->yc + cp->b * sinh( aParam );
+            break;
+
+        case CONIC_HYPER_Y:
+            aPoint.x = cp->xc + cp->a * sinh( aParam );
+            aPoint.y = cp->yc + cp->s * cp->b * cosh( aParam );
+            break;
+
+        case CONIC_PARAB_X:
+            aPoint.x = aParam;
+            aPoint.y = -( c->A * aParam * aParam + c->D * aParam + c->F ) / c->E;
+            break;
+
+        default:
+            aPoint.x = -( c->C * aParam * aParam + c->E * aParam + c->F ) / c->D;
+            aPoint.y = aParam;
+            break;
+    }
+
+    return true;
+}
+
+
+bool IGES_ENTITY_104::AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+    bool xform )
+{
+    // note: the axes of the conic are parallel to Xt and Yt (B = 0)
+    CONIC_PARAM cp;
+    cp.conic = this;
+    cp.kind = CONIC_ELLIPSE;
+    cp.xc = 0.0;
+    cp.yc = 0.0;
+    cp.a = 0.0;
+    cp.b = 0.0;
+    cp.s = 1.0;
+
+    double t0 = 0.0;
+    double t1 = 0.0;
+    // initial number of intervals; each is subsequently bisected as required
+    int nb = 8;
+    int cform = getForm();
+
+    switch( cform )
+    {
+        case 1:
+        case 2:
+            do
+            {
+                cp.xc = -D / ( 2.0 * A );
+                cp.yc = -E / ( 2.0 * C );
+                double k = A * cp.xc * cp.xc + C * cp.yc * cp.yc - F;
+
+                if( 0.0 == k )
+                    break;
+
+                if( 1 == cform )
+                {
+                    cp.kind = CONIC_ELLIPSE;
+                    cp.a = sqrt( fabs( k / A ) );
+                    cp.b = sqrt( fabs( k / C ) );
+                    t0 = atan2( ( Y1 - cp.yc ) / cp.b, ( X1 - cp.xc ) / cp.a );
+                    t1 = atan2( ( Y2 - cp.yc ) / cp.b, ( X2 - cp.xc ) / cp.a );
+
+                    // the arc runs counterclockwise; coincident points
+                    // represent a full ellipse
+                    if( t1 <= t0 )
+                        t1 += 2.0 * M_PI;
+
+                    nb = (int)ceil( ( t1 - t0 ) / ( M_PI * 0.25 ) );
+                }
+                else if( k / A > 0.0 )
+                {
+                    cp.kind = CONIC_HYPER_X;
+                    cp.a = sqrt( k / A );
+                    cp.b = sqrt( -k / C );
+                    cp.s = ( X1 < cp.xc ) ? -1.0 : 1.0;
+                    t0 = asinh( ( Y1 - cp.yc ) / cp.b );
+                    t1 = asinh( ( Y2 - cp.yc ) / cp.b );
+                }
+                else
+                {
+                    cp.kind = CONIC_HYPER_Y;
+                    cp.a = sqrt( -k / A );
+                    cp.b = sqrt( k / C );
+                    cp.s = ( Y1 < cp.yc ) ? -1.0 : 1.0;
+                    t0 = asinh( ( X1 - cp.xc ) / cp.a );
+                    t1 = asinh( ( X2 - cp.xc ) / cp.a );
+                }
+            } while( 0 );
+
+            break;
+
+        case 3:
+            if( 0.0 == C && 0.0 != E )
+            {
+                cp.kind = CONIC_PARAB_X;
+                t0 = X1;
+                t1 = X2;
+                cp.a = 1.0;
+            }
+            else if( 0.0 == A && 0.0 != D )
+            {
+                cp.kind = CONIC_PARAB_Y;
+                t0 = Y1;
+                t1 = Y2;
+                cp.a = 1.0;
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    if( 0.0 == cp.a )
+    {
+        ERRMSG << "\n + [INFO] cannot parameterize the conic\n";
+        return false;
+    }
+
+    // rounding in ( t1 - t0 ) may push a full ellipse just past 8 intervals
+    if( nb < 1 )
+        nb = 1;
+    else if( nb > 8 )
+        nb = 8;
+
+    double breaks[9];
+
+    for( int i = 0; i <= nb; ++i )
+        breaks[i] = t0 + ( t1 - t0 ) * i / nb;
+
+    size_t first = aPoints.size();
+
+    if( !SubdividePolyline( evalConic, &cp, nb + 1, breaks, aTolerance, aPoints ) )
+        return false;
+
+    // use the exact end points to avoid gaps in composite curves
+    aPoints[first] = MCAD_POINT( X1, Y1, ZT );
+    aPoints.back() = MCAD_POINT( X2, Y2, ZT );
+
+    if( xform && pTransform )
+    {
+        MCAD_TRANSFORM T = pTransform->GetTransformMatrix();
+
+        for( size_t i = first; i < aPoints.size(); ++i )
+            aPoints[i] = T * aPoints[i];
+    }
+
+    return true;
+}
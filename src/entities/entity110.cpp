@@ -360,3 +360,36 @@ IGES_CURVE* IGES_ENTITY_110::GetCurve( int index )
 {
     return NULL;
 }
+
+
+bool IGES_ENTITY_110::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+    aBox.Add( MCAD_POINT( X1, Y1, Z1 ) );
+    aBox.Add( MCAD_POINT( X2, Y2, Z2 ) );
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+bool IGES_ENTITY_110::AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+    bool xform )
+{
+    MCAD_POINT p0( X1, Y1, Z1 );
+    MCAD_POINT p1( X2, Y2, Z2 );
+
+    if( xform && pTransform )
+    {
+        MCAD_TRANSFORM T = pTransform->GetTransformMatrix();
+        p0 = T * p0;
+        p1 = T * p1;
+    }
+
+    aPoints.push_back( p0 );
+    aPoints.push_back( p1 );
+
+    return true;
+}
@@ -26,12 +26,15 @@
 
 #include <sstream>
 #include <cmath>
+#include <algorithm>
 #include <error_macros.h>
 #include <core/iges.h>
 #include <core/iges_io.h>
 #include <core/iges_curve.h>
 #include <core/entity120.h>
+#include <core/entity110.h>
 #include <core/entity124.h>
+#include <core/entity126.h>
 
 using namespace std;
 
@@ -436,6 +439,8 @@ bool IGES_ENTITY_120::GetAxis( IGES_CURVE** aCurve )
 
 bool IGES_ENTITY_120::SetL( IGES_CURVE* aCurve )
 {
+    Touch();
+
     if( NULL == aCurve )
     {
         ERRMSG << "\n + [ERROR] NULL pointer passed for axis\n";
@@ -502,6 +507,8 @@ bool IGES_ENTITY_120::GetGeneratrix( IGES_CURVE** aCurve )
 
 bool IGES_ENTITY_120::SetC( IGES_CURVE* aCurve )
 {
+    Touch();
+
     if( NULL == aCurve )
     {
         ERRMSG << "\n + [ERROR] NULL pointer passed for generatrix\n";
@@ -539,3 +546,225 @@ bool IGES_ENTITY_120::SetGeneratrix( IGES_CURVE* aCurve )
 {
     return SetC( aCurve );
 }
+
+
+bool IGES_ENTITY_120::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    MCAD_POINT a;
+    MCAD_POINT b;
+    MCAD_BOX cb;
+
+    if( NULL == L || NULL == C || !L->GetStartPoint( a ) || !L->GetEndPoint( b )
+        || !C->GetBounds( cb ) )
+        return false;
+
+    MCAD_POINT u = b - a;
+    double len = sqrt( u.x * u.x + u.y * u.y + u.z * u.z );
+
+    if( len < 1e-12 )
+        return false;
+
+    u *= 1.0 / len;
+
+    // the surface lies within the cylinder about the axis which
+    // encloses the box of the generatrix
+    double t0 = 0.0;
+    double t1 = 0.0;
+    double r2 = 0.0;
+
+    for( int i = 0; i < 8; ++i )
+    {
+        MCAD_POINT p( ( i & 1 ) ? cb.hi.x : cb.lo.x, ( i & 2 ) ? cb.hi.y : cb.lo.y,
+            ( i & 4 ) ? cb.hi.z : cb.lo.z );
+        MCAD_POINT d = p - a;
+        double t = d.x * u.x + d.y * u.y + d.z * u.z;
+        double q = d.x * d.x + d.y * d.y + d.z * d.z - t * t;
+
+        if( 0 == i || t < t0 )
+            t0 = t;
+
+        if( 0 == i || t > t1 )
+            t1 = t;
+
+        if( q > r2 )
+            r2 = q;
+    }
+
+    double r = sqrt( r2 );
+    MCAD_POINT ext( r * sqrt( std::max( 0.0, 1.0 - u.x * u.x ) ),
+        r * sqrt( std::max( 0.0, 1.0 - u.y * u.y ) ),
+        r * sqrt( std::max( 0.0, 1.0 - u.z * u.z ) ) );
+
+    MCAD_POINT c0 = a + t0 * u;
+    MCAD_POINT c1 = a + t1 * u;
+    aBox.Add( c0 - ext );
+    aBox.Add( c0 + ext );
+    aBox.Add( c1 - ext );
+    aBox.Add( c1 + ext );
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+bool IGES_ENTITY_120::GetParameterRange( double& aT0, double& aT1,
+    double& aTheta0, double& aTheta1 )
+{
+    if( NULL == C )
+        return false;
+
+    switch( C->GetEntityType() )
+    {
+        case ENT_LINE:
+            aT0 = 0.0;
+            aT1 = 1.0;
+            break;
+
+        case ENT_NURBS_CURVE:
+            do
+            {
+                int nc;
+                int order;
+                double* knots;
+                double* coeffs;
+                bool rational;
+                bool closed;
+                bool periodic;
+
+                if( !((IGES_ENTITY_126*)C)->GetNURBSData( nc, order, &knots, &coeffs,
+                    rational, closed, periodic, aT0, aT1 ) )
+                    return false;
+
+            } while( 0 );
+
+            break;
+
+        default:
+            ERRMSG << "\n + [INFO] unsupported generatrix type: " << C->GetEntityType() << "\n";
+            return false;
+            break;
+    }
+
+    aTheta0 = startAngle;
+    aTheta1 = endAngle;
+    return true;
+}
+
+
+bool IGES_ENTITY_120::Evaluate( size_t aNParams, const double* aT, const double* aTheta,
+    MCAD_POINT* aPoint, MCAD_POINT* aDerivT, MCAD_POINT* aDerivTheta, bool xform )
+{
+    if( 0 == aNParams )
+        return true;
+
+    if( NULL == aT || NULL == aTheta )
+    {
+        ERRMSG << "\n + [BUG] NULL pointer to parameters\n";
+        return false;
+    }
+
+    MCAD_POINT a;
+    MCAD_POINT b;
+
+    if( NULL == L || NULL == C || !L->GetStartPoint( a ) || !L->GetEndPoint( b ) )
+    {
+        ERRMSG << "\n + [INFO] invalid surface of revolution\n";
+        return false;
+    }
+
+    int ctype = C->GetEntityType();
+
+    if( ENT_LINE != ctype && ENT_NURBS_CURVE != ctype )
+    {
+        ERRMSG << "\n + [INFO] unsupported generatrix type: " << ctype << "\n";
+        return false;
+    }
+
+    MCAD_POINT u = b - a;
+    double len = sqrt( u.x * u.x + u.y * u.y + u.z * u.z );
+
+    if( len < 1e-12 )
+    {
+        ERRMSG << "\n + [INFO] degenerate axis of revolution\n";
+        return false;
+    }
+
+    u *= 1.0 / len;
+
+    MCAD_POINT g0;
+    MCAD_POINT g1;
+
+    if( ENT_LINE == ctype && ( !C->GetStartPoint( g0 ) || !C->GetEndPoint( g1 ) ) )
+        return false;
+
+    MCAD_TRANSFORM T;
+    bool useT = xform && pTransform;
+
+    if( useT )
+        T = pTransform->GetTransformMatrix();
+
+    for( size_t i = 0; i < aNParams; ++i )
+    {
+        // point and tangent of the generatrix
+        MCAD_POINT p;
+        MCAD_POINT dp;
+
+        if( ENT_LINE == ctype )
+        {
+            dp = g1 - g0;
+            p = g0 + aT[i] * dp;
+        }
+        else if( !((IGES_ENTITY_126*)C)->Evaluate( 1, &aT[i], &p, &dp ) )
+        {
+            return false;
+        }
+
+        // rotate about the axis: the component along the axis is fixed
+        // and the normal component turns through aTheta[i]
+        double ct = cos( aTheta[i] );
+        double st = sin( aTheta[i] );
+        MCAD_POINT d = p - a;
+        double dl = d.x * u.x + d.y * u.y + d.z * u.z;
+        MCAD_POINT dn = d - dl * u;
+        MCAD_POINT w( u.y * d.z - u.z * d.y, u.z * d.x - u.x * d.z, u.x * d.y - u.y * d.x );
+        MCAD_POINT r = dn * ct + w * st;
+
+        if( aPoint )
+        {
+            aPoint[i] = a + dl * u;
+            aPoint[i] += r;
+
+            if( useT )
+                aPoint[i] = T * aPoint[i];
+        }
+
+        if( aDerivT )
+        {
+            double tl = dp.x * u.x + dp.y * u.y + dp.z * u.z;
+            MCAD_POINT tn = dp - tl * u;
+            MCAD_POINT tw( u.y * dp.z - u.z * dp.y, u.z * dp.x - u.x * dp.z,
+                u.x * dp.y - u.y * dp.x );
+
+            aDerivT[i] = tl * u + tn * ct;
+            aDerivT[i] += tw * st;
+
+            if( useT )
+                aDerivT[i] = T.R * aDerivT[i];
+        }
+
+        if( aDerivTheta )
+        {
+            aDerivTheta[i] = MCAD_POINT( u.y * r.z - u.z * r.y, u.z * r.x - u.x * r.z,
+                u.x * r.y - u.y * r.x );
+
+            if( useT )
+                aDerivTheta[i] = T.R * aDerivTheta[i];
+        }
+    }
+
+    return true;
+}
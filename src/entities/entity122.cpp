@@ -397,6 +397,8 @@ bool IGES_ENTITY_122::GetDE( IGES_CURVE*& aPtr )
 
 bool IGES_ENTITY_122::SetDE( IGES_CURVE* aPtr )
 {
+    Touch();
+
     if( DE )
     {
         DE->delReference(this);
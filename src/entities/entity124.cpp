@@ -41,6 +41,7 @@
 
 
 #include <sstream>
+#include <mutex>
 #include <error_macros.h>
 #include <core/iges.h>
 #include <core/iges_io.h>
@@ -54,6 +55,7 @@ IGES_ENTITY_124::IGES_ENTITY_124( IGES* aParent ) : IGES_ENTITY( aParent )
 {
     entityType = 124;
     form = 0;
+    m_cacheVersion = 0;
     return;
 }
 
@@ -471,16 +473,45 @@ bool IGES_ENTITY_124::SetLineWeightNum( int aLineWeight )
 }
 
 
+// source of version numbers for all Transform entities
+// serializes the rare updates of the cached transforms; readers
+// of a current cache never take the lock
+static std::mutex s_cacheLock;
+
+
 // retrieves the overall transform matrix
 MCAD_TRANSFORM IGES_ENTITY_124::GetTransformMatrix( void )
 {
-    MCAD_TRANSFORM V;
+    unsigned long version = GetContentVersion();
+
+    if( m_cacheVersion.load( std::memory_order_acquire ) == version )
+        return m_worldT;
+
+    // note: as per spec, any referenced Transforms are applied later;
+    // the chain is evaluated outside the lock since each link caches
+    // its own result
+    MCAD_TRANSFORM wT;
 
-    // note: as per spec, any referenced Transforms are applied later
     if( pTransform )
-        V = ((IGES_ENTITY_124*)pTransform)->GetTransformMatrix() * T;
+        wT = pTransform->GetTransformMatrix() * T;
     else
-        V = T;
+        wT = T;
+
+    lock_guard<mutex> lk( s_cacheLock );
+
+    // another thread may have stored the same result in the meantime;
+    // m_worldT is only written while no reader can accept it
+    if( m_cacheVersion.load( std::memory_order_relaxed ) != version )
+    {
+        m_worldT = wT;
+        m_cacheVersion.store( version, std::memory_order_release );
+    }
+
+    return wT;
+}
+
 
-    return V;
+unsigned long IGES_ENTITY_124::GetVersion( void )
+{
+    return GetContentVersion();
 }
@@ -25,10 +25,12 @@
  */
 
 #include <sstream>
+#include <algorithm>
 #include <error_macros.h>
 #include <core/iges.h>
 #include <core/iges_io.h>
 #include <geom/mcad_helpers.h>
+#include <geom/mcad_nurbs.h>
 #include <core/entity124.h>
 #include <core/entity126.h>
 #include <core/entity142.h>
@@ -53,21 +55,12 @@ IGES_ENTITY_126::IGES_ENTITY_126( IGES* aParent ) : IGES_CURVE( aParent )
     knots = NULL;
     coeffs = NULL;
 
-#ifdef USE_SISL
-    scurve = NULL;
-#endif
-
     return;
 }
 
 
 IGES_ENTITY_126::~IGES_ENTITY_126()
 {
-#ifdef USE_SISL
-    if( NULL != scurve )
-        freeCurve( scurve );
-#endif
-
     if( knots )
         delete [] knots;
 
@@ -829,56 +822,7 @@ bool IGES_ENTITY_126::GetStartPoint( MCAD_POINT& pt, bool xform )
     if( nCoeffs < 2 )
         return false;
 
-    // XXX - To be reimplemented with self-contained de Boors - Cox algorithm
-#ifdef USE_SISL
-    if( !scurve )
-    {
-        scurve = newCurve( nCoeffs, M + 1, knots, coeffs, PROP3 ? 1 : 2, 3, 0 );
-
-        if( !scurve )
-        {
-            ERRMSG << "\n + [INFO] memory allocation failed in SISL newCurve()\n";
-            return false;
-        }
-    }
-
-    double vals[6];
-    int kt = 0;
-    double r = 0;
-    int stat = 0;
-
-    s1225( scurve, 0, V0, &kt, vals, &vals[3], &r, &stat );
-
-    switch( stat )
-    {
-        case 0:
-            break;
-
-        case 1:
-            ERRMSG << "\n + [WARNING] unspecified warning from SISL s1225() [evaluate position from left]\n";
-            stat = 0;
-            break;
-
-        default:
-            ERRMSG << "\n + [ERROR] SISL s1225() could not compute the position on a curve\n";
-            return false;
-            break;
-    }
-
-    pt.x = vals[0];
-    pt.y = vals[1];
-    pt.z = vals[2];
-#else
-    // nCoeffs >= 2 and SISL is not linked
-    pt.x = coeffs[0];
-    pt.y = coeffs[1];
-    pt.z = coeffs[2];
-#endif
-
-    if( xform && pTransform )
-        pt = pTransform->GetTransformMatrix() * pt;
-
-    return true;
+    return Evaluate( 1, &V0, &pt, NULL, NULL, xform );
 }
 
 
@@ -887,65 +831,40 @@ bool IGES_ENTITY_126::GetEndPoint( MCAD_POINT& pt, bool xform )
     if( nCoeffs < 2 )
         return false;
 
-    // XXX - To be reimplemented with self-contained de Boors - Cox algorithm
-#ifdef USE_SISL
-    if( !scurve )
-    {
-        scurve = newCurve( nCoeffs, M + 1, knots, coeffs, PROP3 ? 1 : 2, 3, 0 );
-
-        if( !scurve )
-        {
-            ERRMSG << "\n + [INFO] memory allocation failed in SISL newCurve()\n";
-            return false;
-        }
-    }
-
-    double vals[6];
-    int kt = 0;
-    double r = 0;
-    int stat = 0;
+    return Evaluate( 1, &V1, &pt, NULL, NULL, xform );
+}
 
-    s1225( scurve, 0, V1, &kt, vals, &vals[3], &r, &stat );
 
-    switch( stat )
+bool IGES_ENTITY_126::Evaluate( size_t aNParams, const double* aParams, MCAD_POINT* aPoint,
+    MCAD_POINT* aDeriv1, MCAD_POINT* aDeriv2, bool xform )
+{
+    if( !knots || !coeffs )
     {
-        case 0:
-            break;
+        ERRMSG << "\n + [INFO] no curve data\n";
+        return false;
+    }
 
-        case 1:
-            ERRMSG << "\n + [WARNING] unspecified warning from SISL s1225() [evaluate position from left]\n";
-            stat = 0;
-            break;
+    if( !EvalNURBSCurve( M + 1, nCoeffs, knots, coeffs, 0 == PROP3, aNParams, aParams,
+        aPoint, aDeriv1, aDeriv2 ) )
+        return false;
 
-        default:
-            ERRMSG << "\n + [ERROR] SISL s1225() could not compute the position on a curve\n";
-            return false;
-            break;
-    }
+    if( !xform || !pTransform )
+        return true;
 
-    pt.x = vals[0];
-    pt.y = vals[1];
-    pt.z = vals[2];
-#else
-    // nCoeffs >= 2 and SISL is not linked
-    int index;
+    MCAD_TRANSFORM T = pTransform->GetTransformMatrix();
 
-    if ( 0 == PROP3 )   // rational B-spline
+    // positions are transformed; derivatives are only rotated
+    for( size_t i = 0; i < aNParams; ++i )
     {
-        index = (nCoeffs - 1) << 2;
-    }
-    else                // B-spline
-    {
-        index = (nCoeffs - 1) * 3;
-    }
+        if( aPoint )
+            aPoint[i] = T * aPoint[i];
 
-    pt.x = coeffs[index++];
-    pt.y = coeffs[index++];
-    pt.z = coeffs[index];
-#endif
+        if( aDeriv1 )
+            aDeriv1[i] = T.R * aDeriv1[i];
 
-    if( xform && pTransform )
-        pt = pTransform->GetTransformMatrix() * pt;
+        if( aDeriv2 )
+            aDeriv2[i] = T.R * aDeriv2[i];
+    }
 
     return true;
 }
@@ -965,8 +884,12 @@ bool IGES_ENTITY_126::GetNURBSData( int& nCoeff, int& order, double** knot,
 {
     nCoeff = 0;
     order =0 ;
-    knot = NULL;
-    coeff = NULL;
+
+    if( !knot || !coeff )
+        return false;
+
+    *knot = NULL;
+    *coeff = NULL;
 
     if( !knots )
         return false;
@@ -1000,10 +923,7 @@ bool IGES_ENTITY_126::GetNURBSData( int& nCoeff, int& order, double** knot,
 bool IGES_ENTITY_126::SetNURBSData( int nCoeff, int order, const double* knot,
     const double* coeff, bool isRational, double v0, double v1 )
 {
-#ifdef USE_SISL
-    if( NULL != scurve )
-        freeCurve( scurve );
-#endif
+    Touch();
 
     if( !knot || !coeff )
     {
@@ -1187,3 +1107,94 @@ bool IGES_ENTITY_126::hasUniquePlane( MCAD_POINT* norm )
 
     return true;
 }
+
+
+bool IGES_ENTITY_126::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    if( NULL == coeffs || nCoeffs < 1 )
+        return false;
+
+    // the curve lies within the convex hull of its control points
+    int nv = ( 0 == PROP3 ) ? 4 : 3;
+    double* pc = coeffs;
+
+    for( int i = 0; i < nCoeffs; ++i, pc += nv )
+        aBox.Add( MCAD_POINT( pc[0], pc[1], pc[2] ) );
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+static bool evalCurve126( void* aData, double aParam, MCAD_POINT& aPoint )
+{
+    return ((IGES_ENTITY_126*)aData)->Evaluate( 1, &aParam, &aPoint, NULL, NULL, false );
+}
+
+
+bool IGES_ENTITY_126::AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+    bool xform )
+{
+    if( !knots || !coeffs || nCoeffs < 2 )
+        return false;
+
+    // Each knot span within V0 .. V1 is initially divided into M intervals
+    // so that no interval is likely to contain an inflection which lies on
+    // its chord; the intervals are then bisected as required.
+    std::vector<double> breaks;
+    int nsub = M > 1 ? M : 1;
+    double t0 = V0;
+    double t1 = V1;
+    bool reverse = false;
+
+    if( t1 < t0 )
+    {
+        std::swap( t0, t1 );
+        reverse = true;
+    }
+
+    breaks.push_back( t0 );
+
+    for( int i = M + 1; i <= nCoeffs; ++i )
+    {
+        double ka = breaks.back();
+        double kb = ( i < nCoeffs ) ? knots[i] : t1;
+
+        if( kb > t1 )
+            kb = t1;
+
+        if( kb <= ka )
+            continue;
+
+        for( int j = 1; j <= nsub; ++j )
+            breaks.push_back( ka + ( kb - ka ) * j / nsub );
+    }
+
+    if( breaks.back() < t1 )
+        breaks.push_back( t1 );
+
+    if( breaks.size() < 2 )
+        return false;
+
+    if( reverse )
+        std::reverse( breaks.begin(), breaks.end() );
+
+    size_t first = aPoints.size();
+
+    if( !SubdividePolyline( evalCurve126, this, breaks.size(), &breaks[0], aTolerance, aPoints ) )
+        return false;
+
+    if( xform && pTransform )
+    {
+        MCAD_TRANSFORM T = pTransform->GetTransformMatrix();
+
+        for( size_t i = first; i < aPoints.size(); ++i )
+            aPoints[i] = T * aPoints[i];
+    }
+
+    return true;
+}
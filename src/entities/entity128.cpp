@@ -29,6 +29,7 @@
 #include <core/iges.h>
 #include <core/iges_io.h>
 #include <geom/mcad_helpers.h>
+#include <geom/mcad_nurbs.h>
 #include <core/entity124.h>
 #include <core/entity128.h>
 
@@ -889,9 +890,13 @@ bool IGES_ENTITY_128::GetNURBSData( int& nCoeff1, int& nCoeff2,
     nCoeff2 = 0;
     order1 = 0 ;
     order2 = 0 ;
-    knot1 = NULL;
-    knot2 = NULL;
-    coeff = NULL;
+
+    if( !knot1 || !knot2 || !coeff )
+        return false;
+
+    *knot1 = NULL;
+    *knot2 = NULL;
+    *coeff = NULL;
 
     if( !knots1 )
         return false;
@@ -942,6 +947,8 @@ bool IGES_ENTITY_128::SetNURBSData( int nCoeff1, int nCoeff2, int order1, int or
     const double* knot1, const double* knot2, const double* coeff, bool isRational,
     bool isPeriodic1, bool isPeriodic2, double u0, double u1, double v0, double v1 )
 {
+    Touch();
+
     if( !knot1 || !knot2 || !coeff )
     {
         ERRMSG << "\n + [INFO] invalid NURBS parameter pointer (NULL)\n";
@@ -1111,3 +1118,66 @@ bool IGES_ENTITY_128::SetNURBSData( int nCoeff1, int nCoeff2, int order1, int or
 
     return true;
 }
+
+
+bool IGES_ENTITY_128::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    int nc = nCoeffs1 * nCoeffs2;
+
+    if( NULL == coeffs || nc < 1 )
+        return false;
+
+    // the surface lies within the convex hull of its control points
+    int nv = ( 0 == PROP3 ) ? 4 : 3;
+    double* pc = coeffs;
+
+    for( int i = 0; i < nc; ++i, pc += nv )
+        aBox.Add( MCAD_POINT( pc[0], pc[1], pc[2] ) );
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+bool IGES_ENTITY_128::EvaluateGrid( size_t aNU, const double* aU, size_t aNV, const double* aV,
+    MCAD_POINT* aPoint, MCAD_POINT* aDerivU, MCAD_POINT* aDerivV, MCAD_POINT* aNormal,
+    bool xform )
+{
+    if( !knots1 || !knots2 || !coeffs )
+    {
+        ERRMSG << "\n + [INFO] no surface data\n";
+        return false;
+    }
+
+    if( !EvalNURBSSurfaceGrid( M1 + 1, M2 + 1, nCoeffs1, nCoeffs2, knots1, knots2,
+        coeffs, 0 == PROP3, aNU, aU, aNV, aV, aPoint, aDerivU, aDerivV, aNormal ) )
+        return false;
+
+    if( !xform || !pTransform )
+        return true;
+
+    MCAD_TRANSFORM T = pTransform->GetTransformMatrix();
+    size_t np = aNU * aNV;
+
+    // positions are transformed; derivatives and normals are only rotated
+    for( size_t i = 0; i < np; ++i )
+    {
+        if( aPoint )
+            aPoint[i] = T * aPoint[i];
+
+        if( aDerivU )
+            aDerivU[i] = T.R * aDerivU[i];
+
+        if( aDerivV )
+            aDerivV[i] = T.R * aDerivV[i];
+
+        if( aNormal )
+            aNormal[i] = T.R * aNormal[i];
+    }
+
+    return true;
+}
@@ -25,11 +25,16 @@
  */
 
 #include <sstream>
+#include <cmath>
+#include <algorithm>
 #include <error_macros.h>
 #include <core/iges.h>
 #include <core/iges_io.h>
 #include <core/entity124.h>
+#include <core/entity128.h>
 #include <core/entity142.h>
+#include <core/iges_curve.h>
+#include <geom/mcad_nurbs.h>
 
 using namespace std;
 
@@ -558,6 +563,8 @@ bool IGES_ENTITY_142::GetSPTR( IGES_ENTITY** aPtr )
 
 bool IGES_ENTITY_142::SetSPTR( IGES_ENTITY* aPtr )
 {
+    Touch();
+
     if( NULL != SPTR )
         SPTR->delReference(this);
 
@@ -604,6 +611,8 @@ bool IGES_ENTITY_142::GetBPTR( IGES_ENTITY** aPtr )
 
 bool IGES_ENTITY_142::SetBPTR( IGES_ENTITY* aPtr )
 {
+    Touch();
+
     if( NULL != BPTR )
         BPTR->delReference(this);
 
@@ -650,6 +659,8 @@ bool IGES_ENTITY_142::GetCPTR( IGES_ENTITY** aPtr )
 
 bool IGES_ENTITY_142::SetCPTR( IGES_ENTITY* aPtr )
 {
+    Touch();
+
     if( NULL != CPTR )
         CPTR->delReference(this);
 
@@ -681,3 +692,241 @@ bool IGES_ENTITY_142::SetCPTR( IGES_ENTITY* aPtr )
 
     return true;
 }
+
+
+bool IGES_ENTITY_142::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    // prefer the model space curve; otherwise the curve is bounded by
+    // the surface on which it lies
+    if( ( NULL == CPTR || !CPTR->GetBounds( aBox, xform ) )
+        && ( NULL == SPTR || !SPTR->GetBounds( aBox, xform ) ) )
+        return false;
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+// a parameter space polyline on a NURBS surface; the integer part of
+// the curve parameter selects the segment of the polyline. The surface
+// data and its transform are retrieved once per polyline.
+struct SURF_POLYLINE
+{
+    int nc[2];
+    int order[2];
+    double* knots[2];
+    double* coeffs;
+    bool rational;
+    bool xform;
+    MCAD_TRANSFORM T;
+    const std::vector<MCAD_POINT>* uv;
+};
+
+
+static bool evalSurfPolyline( void* aData, double aParam, MCAD_POINT& aPoint )
+{
+    SURF_POLYLINE* sp = (SURF_POLYLINE*)aData;
+    const std::vector<MCAD_POINT>& uv = *sp->uv;
+    size_t i = (size_t)aParam;
+
+    if( i > uv.size() - 2 )
+        i = uv.size() - 2;
+
+    double f = aParam - i;
+    double u = uv[i].x + f * ( uv[i + 1].x - uv[i].x );
+    double v = uv[i].y + f * ( uv[i + 1].y - uv[i].y );
+
+    if( !EvalNURBSSurfacePoints( sp->order[0], sp->order[1], sp->nc[0], sp->nc[1],
+        sp->knots[0], sp->knots[1], sp->coeffs, sp->rational, 1, &u, &v, &aPoint ) )
+        return false;
+
+    if( sp->xform )
+        aPoint = sp->T * aPoint;
+
+    return true;
+}
+
+
+// Upper bound of the distance moved in model space per unit distance
+// moved in the parameter space of a NURBS surface. The derivative of a
+// B-Spline is itself a B-Spline so the partial derivatives are bounded
+// by the differences of the control points; for rational surfaces the
+// bound is increased by the square of the ratio of the extreme weights.
+// Returns a negative value if the surface data is not valid.
+static double calcSurfaceSpeed( IGES_ENTITY_128* aSurf, bool xform )
+{
+    int nc[2];
+    int order[2];
+    double* knots[2];
+    double* coeffs;
+    bool rational;
+    bool closed[2];
+    bool periodic[2];
+    double u0, u1, v0, v1;
+
+    if( !aSurf->GetNURBSData( nc[0], nc[1], order[0], order[1], &knots[0], &knots[1],
+        &coeffs, rational, closed[0], closed[1], periodic[0], periodic[1], u0, u1, v0, v1 )
+        || NULL == coeffs )
+        return -1.0;
+
+    int stride = rational ? 4 : 3;
+    double wMin = 1.0;
+    double wMax = 1.0;
+
+    if( rational )
+    {
+        wMin = coeffs[3];
+        wMax = coeffs[3];
+
+        for( int i = 1; i < nc[0] * nc[1]; ++i )
+        {
+            wMin = min( wMin, coeffs[i * stride + 3] );
+            wMax = max( wMax, coeffs[i * stride + 3] );
+        }
+
+        if( wMin <= 0.0 )
+            return -1.0;
+    }
+
+    IGES_ENTITY* tp = NULL;
+    MCAD_MATRIX R;
+    bool rotate = false;
+
+    if( xform && aSurf->GetTransform( &tp ) && NULL != tp )
+    {
+        R = ((IGES_ENTITY_124*)tp)->GetTransformMatrix().R;
+        rotate = true;
+    }
+
+    double speed = 0.0;
+
+    for( int d = 0; d < 2; ++d )
+    {
+        int di = d ? nc[0] : 1;
+        double maxD = 0.0;
+
+        for( int j = 0; j < nc[1] - d; ++j )
+        {
+            for( int i = 0; i < nc[0] - 1 + d; ++i )
+            {
+                int k = ( d ? j : i ) + 1;
+                double dt = knots[d][k + order[d] - 1] - knots[d][k];
+
+                if( dt <= 0.0 )
+                    continue;
+
+                const double* p0 = coeffs + ( j * nc[0] + i ) * stride;
+                const double* p1 = p0 + di * stride;
+                MCAD_POINT dp( p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] );
+
+                if( rotate )
+                    dp = R * dp;
+
+                maxD = max( maxD, ( order[d] - 1 ) * sqrt( dp.x * dp.x
+                    + dp.y * dp.y + dp.z * dp.z ) / dt );
+            }
+        }
+
+        speed += maxD * ( wMax / wMin ) * ( wMax / wMin );
+    }
+
+    return speed;
+}
+
+
+bool IGES_ENTITY_142::GetPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+    bool xform )
+{
+    aPoints.clear();
+
+    if( aTolerance <= 0.0 && parent )
+        aTolerance = parent->globalData.minResolution;
+
+    if( aTolerance <= 0.0 )
+        aTolerance = 0.001;
+
+    IGES_CURVE* cp = dynamic_cast<IGES_CURVE*>( CPTR );
+    IGES_CURVE* bp = dynamic_cast<IGES_CURVE*>( BPTR );
+
+    if( NULL != cp )
+    {
+        if( !cp->AddPolyline( aPoints, aTolerance, xform ) )
+            return false;
+    }
+    else if( NULL != bp && NULL != SPTR && ENT_NURBS_SURFACE == SPTR->GetEntityType() )
+    {
+        // Half of the tolerance is allowed for the discretization of the
+        // parameter space curve; its tolerance is scaled by the bound of
+        // the speed of the surface so that the image of the parameter space
+        // polyline lies within half of the tolerance of the curve in model
+        // space. The image of each segment is then bisected until the surface
+        // points lie within the remaining half of the tolerance of the chord.
+        double speed = calcSurfaceSpeed( (IGES_ENTITY_128*)SPTR, xform );
+
+        if( speed < 0.0 )
+        {
+            ERRMSG << "\n + [INFO] invalid NURBS surface data\n";
+            return false;
+        }
+
+        double uvTol = 0.5 * aTolerance;
+
+        if( speed > 1.0 )
+            uvTol /= speed;
+
+        std::vector<MCAD_POINT> uv;
+
+        if( !bp->GetPolyline( uv, uvTol, true ) || uv.size() < 2 )
+            return false;
+
+        std::vector<double> breaks( uv.size() );
+
+        for( size_t i = 0; i < uv.size(); ++i )
+            breaks[i] = (double)i;
+
+        SURF_POLYLINE sp;
+        IGES_ENTITY_128* surf = (IGES_ENTITY_128*)SPTR;
+        bool closed[2];
+        bool periodic[2];
+        double u0, u1, v0, v1;
+
+        if( !surf->GetNURBSData( sp.nc[0], sp.nc[1], sp.order[0], sp.order[1],
+            &sp.knots[0], &sp.knots[1], &sp.coeffs, sp.rational, closed[0], closed[1],
+            periodic[0], periodic[1], u0, u1, v0, v1 ) || NULL == sp.coeffs )
+        {
+            ERRMSG << "\n + [INFO] invalid NURBS surface data\n";
+            return false;
+        }
+
+        IGES_ENTITY* tp = NULL;
+        sp.xform = xform && surf->GetTransform( &tp ) && NULL != tp;
+
+        if( sp.xform )
+            sp.T = ((IGES_ENTITY_124*)tp)->GetTransformMatrix();
+
+        sp.uv = &uv;
+
+        if( !IGES_CURVE::SubdividePolyline( evalSurfPolyline, &sp, breaks.size(),
+            &breaks[0], 0.5 * aTolerance, aPoints ) )
+            return false;
+    }
+    else
+    {
+        ERRMSG << "\n + [INFO] no model space curve and the surface is not a NURBS surface\n";
+        return false;
+    }
+
+    if( xform && pTransform )
+    {
+        MCAD_TRANSFORM T = pTransform->GetTransformMatrix();
+
+        for( size_t i = 0; i < aPoints.size(); ++i )
+            aPoints[i] = T * aPoints[i];
+    }
+
+    return true;
+}
@@ -31,6 +31,7 @@
 #include <core/entity124.h>
 #include <core/entity142.h>
 #include <core/entity144.h>
+#include <core/iges_trim.h>
 
 using namespace std;
 
@@ -90,6 +91,9 @@ IGES_ENTITY_144::IGES_ENTITY_144( IGES* aParent ) : IGES_ENTITY( aParent )
     iPTO = 0;
     PTS = NULL;
     PTO = NULL;
+    trimGrid = NULL;
+    trimTol = 0.0;
+    trimVersion = 0;
 
     return;
 }
@@ -112,6 +116,7 @@ IGES_ENTITY_144::~IGES_ENTITY_144()
         ++sPTI;
     }
 
+    ClearTrimCache();
     return;
 }
 
@@ -120,6 +125,7 @@ void IGES_ENTITY_144::Compact( void )
 {
     IGES_ENTITY::Compact();
     vPTI.clear();
+    ClearTrimCache();
     return;
 }
 
@@ -401,12 +407,14 @@ bool IGES_ENTITY_144::unlink(IGES_ENTITY *aChild)
     if( aChild == PTS )
     {
         PTS = NULL;
+        ClearTrimCache();
         return true;
     }
 
     if( aChild == PTO )
     {
         PTO = NULL;
+        ClearTrimCache();
         return true;
     }
 
@@ -421,6 +429,7 @@ bool IGES_ENTITY_144::unlink(IGES_ENTITY *aChild)
             {
                 PTI.erase( sPTI );
                 N2 = (int)PTI.size();
+                ClearTrimCache();
                 return true;
             }
 
@@ -672,6 +681,8 @@ bool IGES_ENTITY_144::GetPTS( IGES_ENTITY*& aPtr )
 
 bool IGES_ENTITY_144::SetPTS( IGES_ENTITY* aPtr )
 {
+    Touch();
+
     if( PTS )
         PTS->delReference(this);
 
@@ -729,6 +740,8 @@ bool IGES_ENTITY_144::GetPTO( IGES_ENTITY_142*& aPtr )
 
 bool IGES_ENTITY_144::SetPTO( IGES_ENTITY_142* aPtr )
 {
+    Touch();
+
     if( PTO )
         PTO->delReference(this);
 
@@ -857,6 +870,7 @@ bool IGES_ENTITY_144::AddPTI( IGES_ENTITY_142* aPtr )
     N2 = (int)PTI.size();
 
     vPTI.clear();
+    Touch();
 
     if( NULL != parent && parent != aPtr->GetParentIGES() )
         parent->AddEntity( aPtr );
@@ -876,6 +890,7 @@ bool IGES_ENTITY_144::DelPTI( IGES_ENTITY_142* aPtr )
         {
             PTI.erase( bref );
             N2 = (int)PTI.size();
+            Touch();
             return true;
         }
 
@@ -884,3 +899,59 @@ bool IGES_ENTITY_144::DelPTI( IGES_ENTITY_142* aPtr )
 
     return false;
 }
+
+
+bool IGES_ENTITY_144::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    // the trimmed surface lies within the bounds of the untrimmed surface
+    if( NULL == PTS || !PTS->GetBounds( aBox, xform ) )
+        return false;
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
+
+
+bool IGES_ENTITY_144::ClassifyPoints( size_t aNPoints, const double* aU,
+    const double* aV, bool* aInside, double aTolerance )
+{
+    if( NULL == aU || NULL == aV || NULL == aInside )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    if( NULL == trimGrid || trimTol != aTolerance || trimVersion != m_contentVersion )
+    {
+        if( NULL == trimGrid )
+            trimGrid = new IGES_TRIM_GRID;
+
+        if( !trimGrid->Build( this, aTolerance ) )
+        {
+            ClearTrimCache();
+            return false;
+        }
+
+        trimTol = aTolerance;
+        trimVersion = m_contentVersion;
+    }
+
+    trimGrid->Classify( aNPoints, aU, aV, aInside );
+    return true;
+}
+
+
+void IGES_ENTITY_144::ClearTrimCache( void )
+{
+    if( NULL != trimGrid )
+    {
+        delete trimGrid;
+        trimGrid = NULL;
+    }
+
+    return;
+}
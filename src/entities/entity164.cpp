@@ -464,6 +464,8 @@ bool IGES_ENTITY_164::GetClosedCurve( IGES_CURVE** aCurve )
 
 bool IGES_ENTITY_164::SetClosedCurve( IGES_CURVE* aCurve )
 {
+    Touch();
+
     if( !aCurve )
     {
         ERRMSG << "\n + [ERROR] NULL passed as curve entity pointer\n";
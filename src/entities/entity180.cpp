@@ -552,6 +552,8 @@ bool IGES_ENTITY_180::SetHierarchy( IGES_STAT_HIER aHierarchy )
 
 bool IGES_ENTITY_180::AddOp( BTREE_OPERATOR op )
 {
+    Touch();
+
     if( op < OP_START || op >= OP_END )
     {
         ERRMSG << "\n + [BUG] invalid OPERATOR (" << op << ")\n";
@@ -582,6 +584,8 @@ bool IGES_ENTITY_180::AddOp( BTREE_OPERATOR op )
 
 bool IGES_ENTITY_180::AddArg( IGES_ENTITY* aOperand )
 {
+    Touch();
+
     int iEnt = aOperand->GetEntityType();
 
     if( !typeOK( iEnt ) )
@@ -509,6 +509,22 @@ bool IGES_ENTITY_186::readPD(std::ifstream &aFile, int &aSequenceVar)
 }
 
 
+bool IGES_ENTITY_186::GetShell( IGES_ENTITY_514*& aShell, bool& aOrientation )
+{
+    aShell = mshell;
+    aOrientation = mSOF;
+    return NULL != mshell;
+}
+
+
+bool IGES_ENTITY_186::GetVoids( std::vector< std::pair<IGES_ENTITY_514*, bool> >& aVoids )
+{
+    aVoids.clear();
+    aVoids.insert( aVoids.end(), mvoids.begin(), mvoids.end() );
+    return !aVoids.empty();
+}
+
+
 bool IGES_ENTITY_186::SetEntityForm( int aForm )
 {
     if( 0 == aForm )
@@ -502,6 +502,8 @@ bool IGES_ENTITY_308::GetDEList( size_t& aDESize, IGES_ENTITY**& aDEList )
 
 bool IGES_ENTITY_308::AddDE(IGES_ENTITY *aPtr)
 {
+    Touch();
+
     if( NULL == aPtr )
     {
         ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
@@ -547,20 +549,15 @@ bool IGES_ENTITY_308::AddDE(IGES_ENTITY *aPtr)
         ++bExt;
     }
 
-    bref = DE.begin();
-    eref = DE.end();
-
-    while( bref != eref )
+    // aPtr refers back to this entity only if it is already in the DE list
+    // since all other references were rejected above; checking the child's
+    // short list of parents avoids a search of the (possibly long) DE list.
+    // While this is a bug, we can do the right thing and simply ignore the
+    // additional reference
+    if( aPtr->hasParentRef( this ) )
     {
-        // while this is a bug, we can do the right thing and simply ignore the
-        // additional reference
-        if( aPtr == *bref )
-        {
-            m_DE.clear();
-            return true;
-        }
-
-        ++bref;
+        m_DE.clear();
+        return true;
     }
 
     bool dup = false;
@@ -591,6 +588,8 @@ bool IGES_ENTITY_308::AddDE(IGES_ENTITY *aPtr)
 
 bool IGES_ENTITY_308::DelDE( IGES_ENTITY* aPtr )
 {
+    Touch();
+
     std::list<IGES_ENTITY*>::iterator bref = DE.begin();
     std::list<IGES_ENTITY*>::iterator eref = DE.end();
 
@@ -652,3 +651,29 @@ int IGES_ENTITY_308::getDepthLevel( void )
 
     return nd;
 }
+
+
+bool IGES_ENTITY_308::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    std::list<IGES_ENTITY*>::iterator sD = DE.begin();
+    std::list<IGES_ENTITY*>::iterator eD = DE.end();
+    MCAD_BOX eb;
+
+    while( sD != eD )
+    {
+        if( (*sD)->GetBounds( eb, xform ) )
+            aBox.Add( eb );
+
+        ++sD;
+    }
+
+    if( aBox.IsEmpty() )
+        return false;
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
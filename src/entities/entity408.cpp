@@ -419,6 +419,8 @@ bool IGES_ENTITY_408::GetDE( IGES_ENTITY_308*& aPtr )
 
 bool IGES_ENTITY_408::SetDE( IGES_ENTITY_308* aPtr )
 {
+    Touch();
+
     if( DE )
         DE->delReference(this);
 
@@ -474,3 +476,24 @@ int IGES_ENTITY_408::getDepthLevel( void )
 
     return 0;
 }
+
+
+bool IGES_ENTITY_408::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    aBox.Clear();
+
+    if( NULL == DE || !DE->GetBounds( aBox, xform ) )
+        return false;
+
+    // the Subfigure Definition is scaled and translated into place and
+    // the result is subject to this entity's transform
+    MCAD_TRANSFORM tx;
+    tx.R *= S;
+    tx.T = MCAD_POINT( X, Y, Z );
+    aBox = tx * aBox;
+
+    if( xform && pTransform )
+        aBox = pTransform->GetTransformMatrix() * aBox;
+
+    return true;
+}
@@ -288,7 +288,7 @@ bool IGES_ENTITY_504::unlink(IGES_ENTITY *aChildEntity)
 
     if( 502 == eType )
     {
-        if( delVertexList( (IGES_ENTITY_502*)aChildEntity, true ) )
+        if( delVertexList( (IGES_ENTITY_502*)aChildEntity, true, true ) )
         {
             // we must disassociate all curves referencing the vertex list
             while( sE != eE )
@@ -557,7 +557,7 @@ bool IGES_ENTITY_504::SetHierarchy( IGES_STAT_HIER aHierarchy )
 
 
 bool
-IGES_ENTITY_504::GetEdges( size_t aListSize, EDGE_DATA const*& aEdgeList )
+IGES_ENTITY_504::GetEdges( size_t& aListSize, EDGE_DATA const*& aEdgeList )
 {
     if( edges.empty() )
     {
@@ -580,9 +580,9 @@ IGES_ENTITY_504::GetEdges( size_t aListSize, EDGE_DATA const*& aEdgeList )
         }
     }
 
-    aListSize = 0;
+    aListSize = vedges.size();
     aEdgeList = &vedges[0];
-    return false;
+    return true;
 }
 
 
@@ -768,7 +768,8 @@ bool IGES_ENTITY_504::addVertexList( IGES_ENTITY_502* aVertexList )
 
 
 // decrement a Vertex List's reference count and delete references if appropriate
-bool IGES_ENTITY_504::delVertexList( IGES_ENTITY_502* aVertexList, bool aFlagAll )
+bool IGES_ENTITY_504::delVertexList( IGES_ENTITY_502* aVertexList, bool aFlagAll,
+    bool aFlagUnlink )
 {
     if( !aVertexList )
     {
@@ -787,7 +788,9 @@ bool IGES_ENTITY_504::delVertexList( IGES_ENTITY_502* aVertexList, bool aFlagAll
 
             if( aFlagAll || 0 == sV->second )
             {
-                sV->first->delReference(this);
+                if( !aFlagUnlink )
+                    sV->first->delReference(this);
+
                 vertices.erase( sV );
             }
 
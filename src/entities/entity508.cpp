@@ -766,26 +766,24 @@ bool IGES_ENTITY_508::delEdge( IGES_ENTITY* aEdge, bool aFlagAll, bool aFlagUnli
 
             if( aFlagAll || (--sE->second == 0) )
             {
-                vector< LOOP_DATA* >::reverse_iterator sF = edges.rbegin();
-                vector< LOOP_DATA* >::reverse_iterator eF = edges.rend();
+                vector< LOOP_DATA* >::iterator sF = edges.begin();
 
-                while( sF != eF )
+                while( sF != edges.end() )
                 {
                     if( (*sF)->data == ep )
                     {
-                        vector< LOOP_PAIR* >::reverse_iterator sP = (*sF)->pcurves.rbegin();
-                        vector< LOOP_PAIR* >::reverse_iterator eP = (*sF)->pcurves.rend();
+                        vector< LOOP_PAIR* >::iterator sP = (*sF)->pcurves.begin();
+                        vector< LOOP_PAIR* >::iterator eP = (*sF)->pcurves.end();
 
                         while( sP != eP )
                         {
-                            delPCurve( (*sP)->curve, false, false );
+                            (*sP)->curve->delReference(this);
                             delete *sP;
                             ++sP;
                         }
 
                         delete *sF;
-                        --sF;
-                        edges.pop_back();
+                        sF = edges.erase( sF );
                         continue;
                     }
 
@@ -870,6 +868,7 @@ bool IGES_ENTITY_508::delPCurve( IGES_ENTITY* aCurve, bool aFlagDelEdge, bool aF
                     while( !(*sF)->pcurves.empty() )
                     {
                         (*sF)->pcurves.back()->curve->delReference(this);
+                        delete (*sF)->pcurves.back();
                         (*sF)->pcurves.pop_back();
                     }
 
@@ -881,7 +880,7 @@ bool IGES_ENTITY_508::delPCurve( IGES_ENTITY* aCurve, bool aFlagDelEdge, bool aF
                         (*sP)->curve->delReference(this);
 
                     delete *sP;
-                    (*sF)->pcurves.pop_back();
+                    (*sF)->pcurves.erase( --(sP.base()) );
                 }
 
                 return true;
@@ -897,7 +896,7 @@ bool IGES_ENTITY_508::delPCurve( IGES_ENTITY* aCurve, bool aFlagDelEdge, bool aF
 }
 
 
-bool IGES_ENTITY_508::GetLoopData( size_t aListSize, LOOP_DATA**& aEdgeList )
+bool IGES_ENTITY_508::GetLoopData( size_t& aListSize, LOOP_DATA**& aEdgeList )
 {
     if( edges.empty() )
     {
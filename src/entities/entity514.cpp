@@ -418,6 +418,53 @@ bool IGES_ENTITY_514::readPD(std::ifstream &aFile, int &aSequenceVar)
 }
 
 
+bool IGES_ENTITY_514::GetFaces( size_t& aListSize,
+    std::pair<IGES_ENTITY_510*, bool> const*& aFaceList )
+{
+    if( mfaces.empty() )
+    {
+        aListSize = 0;
+        aFaceList = NULL;
+        return false;
+    }
+
+    aListSize = mfaces.size();
+    aFaceList = &mfaces[0];
+    return true;
+}
+
+
+bool IGES_ENTITY_514::AddFace( IGES_ENTITY_510* aFace, bool aOrientFlag )
+{
+    if( NULL == aFace )
+    {
+        ERRMSG << "\n + [BUG] NULL pointer passed for face\n";
+        return false;
+    }
+
+    bool dup = false;
+
+    if( !aFace->addReference( this, dup ) )
+    {
+        ERRMSG << "\n + [INFO] could not add parent reference to face\n";
+        return false;
+    }
+
+    if( dup )
+    {
+        ERRMSG << "\n + [BUG] duplicate face entity\n";
+        return false;
+    }
+
+    mfaces.push_back( pair<IGES_ENTITY_510*, bool>( aFace, aOrientFlag ) );
+
+    if( NULL != parent && parent != aFace->GetParentIGES() )
+        parent->AddEntity( (IGES_ENTITY*)aFace );
+
+    return true;
+}
+
+
 bool IGES_ENTITY_514::SetEntityForm( int aForm )
 {
     if( 1 == aForm || 2 == aForm )
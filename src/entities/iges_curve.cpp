@@ -44,3 +44,119 @@ IGES_CURVE::~IGES_CURVE()
 {
     return;
 }
+
+
+// maximum depth of bisection of each interval in SubdividePolyline()
+#define POLYLINE_MAX_DEPTH 20
+
+
+// square of the distance from point aP to the segment aP0 .. aP1
+static double chordDist2( const MCAD_POINT& aP0, const MCAD_POINT& aP1, const MCAD_POINT& aP )
+{
+    double vx = aP1.x - aP0.x;
+    double vy = aP1.y - aP0.y;
+    double vz = aP1.z - aP0.z;
+    double wx = aP.x - aP0.x;
+    double wy = aP.y - aP0.y;
+    double wz = aP.z - aP0.z;
+    double vv = vx * vx + vy * vy + vz * vz;
+    double t = 0.0;
+
+    if( vv > 0.0 )
+    {
+        t = ( wx * vx + wy * vy + wz * vz ) / vv;
+
+        if( t < 0.0 )
+            t = 0.0;
+        else if( t > 1.0 )
+            t = 1.0;
+    }
+
+    wx -= t * vx;
+    wy -= t * vy;
+    wz -= t * vz;
+
+    return wx * wx + wy * wy + wz * wz;
+}
+
+
+// bisect the interval aT0 .. aT1 until the chord error is within tolerance;
+// the curve is tested at the midpoint (aTM, aPM) and at the quarter points,
+// which become the midpoints of the halves if the interval is bisected.
+// The point at aT1 is appended but the point at aT0 is not.
+static bool refineInterval( IGES_CURVE::POLYLINE_EVAL aFunc, void* aData,
+    double aT0, const MCAD_POINT& aP0, double aTM, const MCAD_POINT& aPM,
+    double aT1, const MCAD_POINT& aP1, double aTol2, int aDepth,
+    std::vector<MCAD_POINT>& aPoints )
+{
+    double tq1 = 0.5 * ( aT0 + aTM );
+    double tq3 = 0.5 * ( aTM + aT1 );
+    MCAD_POINT q1;
+    MCAD_POINT q3;
+
+    if( !aFunc( aData, tq1, q1 ) || !aFunc( aData, tq3, q3 ) )
+        return false;
+
+    if( aDepth < POLYLINE_MAX_DEPTH
+        && ( chordDist2( aP0, aP1, aPM ) > aTol2
+            || chordDist2( aP0, aP1, q1 ) > aTol2
+            || chordDist2( aP0, aP1, q3 ) > aTol2 ) )
+    {
+        return refineInterval( aFunc, aData, aT0, aP0, tq1, q1, aTM, aPM, aTol2, aDepth + 1, aPoints )
+            && refineInterval( aFunc, aData, aTM, aPM, tq3, q3, aT1, aP1, aTol2, aDepth + 1, aPoints );
+    }
+
+    aPoints.push_back( aP1 );
+    return true;
+}
+
+
+bool IGES_CURVE::SubdividePolyline( POLYLINE_EVAL aFunc, void* aData, size_t aNBreaks,
+    const double* aBreaks, double aTolerance, std::vector<MCAD_POINT>& aPoints )
+{
+    if( !aFunc || !aBreaks || aNBreaks < 2 )
+    {
+        ERRMSG << "\n + [BUG] invalid polyline parameters\n";
+        return false;
+    }
+
+    MCAD_POINT p0;
+    MCAD_POINT p1;
+    MCAD_POINT pm;
+
+    if( !aFunc( aData, aBreaks[0], p0 ) )
+        return false;
+
+    aPoints.push_back( p0 );
+    double tol2 = aTolerance * aTolerance;
+
+    for( size_t i = 1; i < aNBreaks; ++i )
+    {
+        double tm = 0.5 * ( aBreaks[i - 1] + aBreaks[i] );
+
+        if( !aFunc( aData, aBreaks[i], p1 ) || !aFunc( aData, tm, pm ) )
+            return false;
+
+        if( !refineInterval( aFunc, aData, aBreaks[i - 1], p0, tm, pm, aBreaks[i], p1,
+            tol2, 0, aPoints ) )
+            return false;
+
+        p0 = p1;
+    }
+
+    return true;
+}
+
+
+bool IGES_CURVE::GetPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance, bool xform )
+{
+    aPoints.clear();
+
+    if( aTolerance <= 0.0 && parent )
+        aTolerance = parent->globalData.minResolution;
+
+    if( aTolerance <= 0.0 )
+        aTolerance = 0.001;
+
+    return AddPolyline( aPoints, aTolerance, xform );
+}
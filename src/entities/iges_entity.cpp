@@ -28,6 +28,7 @@
 
 #include <iomanip>
 #include <sstream>
+#include <atomic>
 #include <error_macros.h>
 #include <core/iges.h>
 #include <core/all_entities.h>
@@ -36,6 +37,9 @@
 
 using namespace std;
 
+// source of the content versions of all entities
+static std::atomic<unsigned long> s_contentCounter( 0 );
+
 
 IGES_ENTITY::IGES_ENTITY(IGES* aParent)
 {
@@ -110,6 +114,8 @@ IGES_ENTITY::IGES_ENTITY(IGES* aParent)
     pLabelAssoc = NULL;
     pColor = NULL;
 
+    m_contentVersion = ++s_contentCounter;
+
     return;
 }   // IGES_ENTITY::IGES_ENTITY(IGES*)
 
@@ -135,6 +141,8 @@ IGES_ENTITY::~IGES_ENTITY()
 
         while( rbeg != rend )
         {
+            (*rbeg)->Touch();
+
             if( !(*rbeg)->unlink(this) )
                 ERRMSG << "\n + [BUG] could not unlink a parent entity\n";
 
@@ -2204,6 +2212,7 @@ bool IGES_ENTITY::GetTransform(IGES_ENTITY** aTransform)
 
 bool IGES_ENTITY::SetTransform( IGES_ENTITY* aTransform )
 {
+    Touch();
     transform = 0;
 
     if( pTransform )
@@ -2257,6 +2266,64 @@ bool IGES_ENTITY::SetTransform( IGES_ENTITY* aTransform )
 }
 
 
+unsigned long IGES_ENTITY::GetContentVersion( void )
+{
+    return m_contentVersion;
+}
+
+
+void IGES_ENTITY::Touch( void )
+{
+    // all entities reached are given the same new version, which also
+    // marks them as visited; each entity is therefore visited once even
+    // if it is reached along several paths or a malformed file contains
+    // a reference cycle
+    unsigned long version = ++s_contentCounter;
+    std::vector<IGES_ENTITY*> stack;
+
+    m_contentVersion = version;
+    stack.push_back( this );
+
+    while( !stack.empty() )
+    {
+        IGES_ENTITY* ep = stack.back();
+        stack.pop_back();
+
+        std::list<IGES_ENTITY*>::iterator sR = ep->refs.begin();
+        std::list<IGES_ENTITY*>::iterator eR = ep->refs.end();
+
+        while( sR != eR )
+        {
+            if( (*sR)->m_contentVersion != version )
+            {
+                (*sR)->m_contentVersion = version;
+                stack.push_back( *sR );
+            }
+
+            ++sR;
+        }
+    }
+
+    return;
+}
+
+
+void IGES_ENTITY::touchAll( std::vector<IGES_ENTITY*>& aList )
+{
+    unsigned long version = ++s_contentCounter;
+    std::vector<IGES_ENTITY*>::iterator sL = aList.begin();
+    std::vector<IGES_ENTITY*>::iterator eL = aList.end();
+
+    while( sL != eL )
+    {
+        (*sL)->m_contentVersion = version;
+        ++sL;
+    }
+
+    return;
+}
+
+
 bool IGES_ENTITY::GetLabelAssoc(IGES_ENTITY** aLabelAssoc)
 {
     *aLabelAssoc = NULL;
@@ -2548,6 +2615,13 @@ bool IGES_ENTITY::GetHierarchy(IGES_STAT_HIER& aHierarchy)
     return true;
 }
 
+
+bool IGES_ENTITY::GetBounds( MCAD_BOX& aBox, bool xform )
+{
+    // by default an entity has no geometry
+    return false;
+}
+
 // read optional (extra) PD parameters
 bool IGES_ENTITY::readExtraParams( int& index )
 {
@@ -3069,3 +3143,20 @@ IGES_ENTITY* IGES_ENTITY::getFirstParentRef( void )
 
     return refs.front();
 }
+
+
+bool IGES_ENTITY::hasParentRef( IGES_ENTITY* aParentEntity )
+{
+    std::list<IGES_ENTITY*>::iterator sR = refs.begin();
+    std::list<IGES_ENTITY*>::iterator eR = refs.end();
+
+    while( sR != eR )
+    {
+        if( aParentEntity == *sR )
+            return true;
+
+        ++sR;
+    }
+
+    return false;
+}
@@ -92,6 +92,9 @@ void IGES_GEOM_CYLINDER::init( void )
     for( int i = 0; i < 6; ++i )
         angles[i] = 0.0;
 
+    nbounds = 0;
+    rbounds = false;
+
     return;
 }
 
@@ -111,6 +114,9 @@ void IGES_GEOM_CYLINDER::clear( void )
         arcs[i].z = 0.0;
     }
 
+    nbounds = 0;
+    rbounds = false;
+
     return;
 }
 
@@ -285,6 +291,134 @@ bool IGES_GEOM_CYLINDER::SetParams( MCAD_POINT center, MCAD_POINT start, MCAD_PO
 }
 
 
+bool IGES_GEOM_CYLINDER::CalcBounds( bool aReverse )
+{
+    nbounds = 0;
+
+    if( !narcs )
+    {
+        ERRMSG << "\n + [ERROR] no model data to calculate bounds\n";
+        return false;
+    }
+
+    // the bounds are all linear:
+    // (0, startAng, 0) .. (0, endAng, 0)
+    // (0, endAng, 0) .. (1, endAng, 0)
+    // (1, endAng, 0) .. (1, startAng, 0)
+    // (1, startAng, 0) .. (0, startAng, 0)
+    SISLCurve* inurbs[12];
+
+    for( int i = 0; i < 12; ++i )
+        inurbs[i] = NULL;
+
+#define FREE_NURBS do { \
+    for( int i = 0; i < 12; ++i ) \
+    { \
+        if( inurbs[i] ) \
+            freeCurve( inurbs[i] ); \
+        inurbs[i] = NULL; \
+    } } while( 0 );
+
+    for( int i = 0; i < narcs; ++i )
+    {
+        int idx = i * 4;
+        int idx2 = i * 2;
+        double data[6]; // 2 control points for inurbs
+
+        // (0, startAng, 0) .. (0, endAng, 0)
+        data[0] = 0.0;
+        data[1] = angles[idx2];
+        data[2] = 0.0;
+        data[3] = 0.0;
+        data[4] = angles[idx2 + 1];
+        data[5] = 0.0;
+
+        if( aReverse )
+        {
+            data[1] = 2.0 * M_PI - data[1];
+            data[4] = 2.0 * M_PI - data[4];
+        }
+
+        if( !makeNurb( data, &data[3], &inurbs[idx] ) )
+        {
+            ERRMSG << "\n + [BUG] could not create NURBS bound #" << i << ".1\n";
+            FREE_NURBS;
+            return false;
+        }
+
+        // (0, endAng, 0) .. (1, endAng, 0)
+        data[0] = 0.0;
+        data[1] = data[4];
+        data[2] = 0.0;
+        data[3] = 1.0;
+        data[5] = 0.0;
+
+        if( !makeNurb( data, &data[3], &inurbs[idx +1] ) )
+        {
+            ERRMSG << "\n + [BUG] could not create NURBS bound #" << i << ".2\n";
+            FREE_NURBS;
+            return false;
+        }
+
+        // (1, endAng, 0) .. (1, startAng, 0)
+        data[0] = 1.0;
+        data[2] = 0.0;
+        data[3] = 1.0;
+        data[4] = angles[idx2];
+        data[5] = 0.0;
+
+        if( aReverse )
+            data[4] = 2.0 * M_PI - data[4];
+
+        if( !makeNurb( data, &data[3], &inurbs[idx +2] ) )
+        {
+            ERRMSG << "\n + [BUG] could not create NURBS bound #" << i << ".3\n";
+            FREE_NURBS;
+            return false;
+        }
+
+        // (1, startAng, 0) .. (0, startAng, 0)
+        data[0] = 1.0;
+        data[1] = data[4];
+        data[2] = 0.0;
+        data[3] = 0.0;
+        data[5] = 0.0;
+
+        if( !makeNurb( data, &data[3], &inurbs[idx +3] ) )
+        {
+            ERRMSG << "\n + [BUG] could not create NURBS bound #" << i << ".4\n";
+            FREE_NURBS;
+            return false;
+        }
+    }
+
+    int nsegs = narcs * 4;
+
+    for( int i = 0; i < nsegs; ++i )
+    {
+        if( 2 != inurbs[i]->in || 2 != inurbs[i]->ik )
+        {
+            ERRMSG << "\n + [BUG] unexpected order of NURBS bound #" << i << "\n";
+            FREE_NURBS;
+            return false;
+        }
+
+        for( int j = 0; j < 4; ++j )
+            bknots[i][j] = inurbs[i]->et[j];
+
+        for( int j = 0; j < 6; ++j )
+            bcoeffs[i][j] = inurbs[i]->ecoef[j];
+    }
+
+    FREE_NURBS;
+#undef FREE_NURBS
+
+    nbounds = nsegs;
+    rbounds = aReverse;
+    return true;
+}
+
+
 bool IGES_GEOM_CYLINDER::Instantiate( IGES* model, double top, double bot,
     IGES_ENTITY_144**& result, int& nParts, bool aReverse )
 {
@@ -336,7 +470,6 @@ bool IGES_GEOM_CYLINDER::Instantiate( IGES* model, double top, double bot,
     #define N_IBOUNDS 3
     #define N_ITPS 3
     #define N_ITRANS 3
-    #define N_INURBS 12
 
     IGES_ENTITY_110* iline[N_ILINE];
     IGES_ENTITY_120* isurf[N_ISURF];
@@ -346,7 +479,6 @@ bool IGES_GEOM_CYLINDER::Instantiate( IGES* model, double top, double bot,
     IGES_ENTITY_142* ibound[N_IBOUNDS];
     IGES_ENTITY_144* itps[N_ITPS];
     IGES_ENTITY_124* itrans[N_ITRANS];
-    SISLCurve* inurbs[N_INURBS];
 
     for( int i = 0; i < N_ILINE; ++i )
         iline[i] = NULL;
@@ -372,9 +504,6 @@ bool IGES_GEOM_CYLINDER::Instantiate( IGES* model, double top, double bot,
     for( int i = 0; i < N_ITRANS; ++i )
         itrans[i] = NULL;
 
-    for( int i = 0; i < N_INURBS; ++i )
-        inurbs[i] = NULL;
-
 #define CLEANUP do { \
     for( int i = 0; i < N_ILINE; ++i ) \
     { \
@@ -423,12 +552,6 @@ bool IGES_GEOM_CYLINDER::Instantiate( IGES* model, double top, double bot,
         if( itrans[i] ) \
             model->DelEntity((IGES_ENTITY*)itrans[i]); \
             itrans[i] = NULL; \
-    }\
-    for( int i = 0; i < N_INURBS; ++i ) \
-    { \
-        if( inurbs[i] ) \
-            freeCurve( inurbs[i] ); \
-        inurbs[i] = NULL; \
     } } while( 0 );
 
     MCAD_POINT p0;
@@ -818,92 +941,17 @@ bool IGES_GEOM_CYLINDER::Instantiate( IGES* model, double top, double bot,
     }
 
     // at this stage we have the geometric bounds; now we must
-    // calculate the NURBS bounds; these are all linear bounds:
-    // (0, startAng, 0) .. (0, endAng, 0)
-    // (0, endAng, 0) .. (1, endAng, 0)
-    // (1, endAng, 0) .. (1, startAng, 0)
-    // (1, startAng, 0) .. (0, startAng, 0)
-    for( int i = 0; i < narcs; ++i )
+    // set the NURBS bounds
+    if( ( nbounds != narcs * 4 || rbounds != aReverse ) && !CalcBounds( aReverse ) )
     {
-        int idx = i * 4;
-        int idx2 = i * 2;
-        double data[6]; // 2 control points for inurbs
-
-        // (0, startAng, 0) .. (0, endAng, 0)
-        data[0] = 0.0;
-        data[1] = angles[idx2];
-        data[2] = 0.0;
-        data[3] = 0.0;
-        data[4] = angles[idx2 + 1];
-        data[5] = 0.0;
-
-        if( aReverse )
-        {
-            data[1] = 2.0 * M_PI - data[1];
-            data[4] = 2.0 * M_PI - data[4];
-        }
-
-        if( !makeNurb( data, &data[3], &inurbs[idx] ) )
-        {
-            ERRMSG << "\n + [BUG] could not create NURBS bound #" << i << ".1\n";
-            CLEANUP;
-            return false;
-        }
-
-        // (0, endAng, 0) .. (1, endAng, 0)
-        data[0] = 0.0;
-        data[1] = data[4];
-        data[2] = 0.0;
-        data[3] = 1.0;
-        data[5] = 0.0;
-
-        if( !makeNurb( data, &data[3], &inurbs[idx +1] ) )
-        {
-            ERRMSG << "\n + [BUG] could not create NURBS bound #" << i << ".2\n";
-            CLEANUP;
-            return false;
-        }
-
-        // (1, endAng, 0) .. (1, startAng, 0)
-        data[0] = 1.0;
-        data[2] = 0.0;
-        data[3] = 1.0;
-        data[4] = angles[idx2];
-        data[5] = 0.0;
-
-        if( aReverse )
-            data[4] = 2.0 * M_PI - data[4];
-
-        if( !makeNurb( data, &data[3], &inurbs[idx +2] ) )
-        {
-            ERRMSG << "\n + [BUG] could not create NURBS bound #" << i << ".3\n";
-            CLEANUP;
-            return false;
-        }
-
-        // (1, startAng, 0) .. (0, startAng, 0)
-        data[0] = 1.0;
-        data[1] = data[4];
-        data[2] = 0.0;
-        data[3] = 0.0;
-        data[5] = 0.0;
-
-        if( !makeNurb( data, &data[3], &inurbs[idx +3] ) )
-        {
-            ERRMSG << "\n + [BUG] could not create NURBS bound #" << i << ".4\n";
-            CLEANUP;
-            return false;
-        }
+        CLEANUP;
+        return false;
     }
 
-    nsegs = narcs * 4;
-
-    for( int i = 0; i < nsegs; ++i )
+    for( int i = 0; i < nbounds; ++i )
     {
-        int iKE = inurbs[i]->in + inurbs[i]->ik - 1;
-
-        if( !icurve[i]->SetNURBSData( inurbs[i]->in, inurbs[i]->ik, inurbs[i]->et,
-            inurbs[i]->ecoef, false, inurbs[i]->et[0], inurbs[i]->et[iKE] ) )
+        if( !icurve[i]->SetNURBSData( 2, 2, bknots[i], bcoeffs[i], false,
+            bknots[i][0], bknots[i][3] ) )
         {
             ERRMSG << "\n + [BUG] could not transfer bounds data to NURBS #" << i << "\n";
             CLEANUP;
@@ -985,14 +1033,6 @@ bool IGES_GEOM_CYLINDER::Instantiate( IGES* model, double top, double bot,
         for( int i = 0; i < N_ITRANS; ++i )
             itrans[i] = NULL;
 
-        for( int i = 0; i < N_INURBS; ++i )
-        {
-            if( inurbs[i] )
-                freeCurve( inurbs[i] );
-
-            inurbs[i] = NULL;
-        }
-
     } while( 0 );
 
     nParts = (int)parts.size();
@@ -29,7 +29,9 @@
 
 #include <sstream>
 #include <cmath>
+#include <map>
 #include <core/iges.h>
+#include <core/iges_pool.h>
 #include <error_macros.h>
 #include <geom/mcad_helpers.h>
 #include <geom/mcad_segment.h>
@@ -44,6 +46,8 @@
 #include <core/entity128.h>
 #include <core/entity142.h>
 #include <core/entity144.h>
+#include <core/entity308.h>
+#include <core/entity408.h>
 #include <sisl.h>
 
 
@@ -150,11 +154,389 @@ static bool newArc126( IGES* aModel, IGES_ENTITY_126** ap )
 }
 
 
+// minimum number of segments for which the NURBS data is
+// calculated by more than one thread
+#define PCB_MIN_PARALLEL 64
+
+// tolerance within which collinear lines and co-circular arcs
+// are merged before the surfaces are created
+#define PCB_SIMPLIFY_TOL 1e-8
+
+
+// NURBS curves representing a segment on the parametric plane of the
+// board; the curves are calculated in advance of the creation of the
+// IGES entities so that the curves of many segments may be calculated
+// concurrently.
+struct PCB_COP_CURVES
+{
+    int ncurves;            // number of curves; 0 if the calculation failed
+    SISLCurve* curves[3];   // curves in the order of the IGES entities
+
+    PCB_COP_CURVES()
+    {
+        ncurves = 0;
+
+        for( int i = 0; i < 3; ++i )
+            curves[i] = NULL;
+    }
+
+    ~PCB_COP_CURVES()
+    {
+        Clear();
+    }
+
+    void Clear( void )
+    {
+        for( int i = 0; i < 3; ++i )
+        {
+            if( curves[i] )
+                freeCurve( curves[i] );
+
+            curves[i] = NULL;
+        }
+
+        ncurves = 0;
+    }
+
+private:
+    PCB_COP_CURVES( const PCB_COP_CURVES& );
+    PCB_COP_CURVES& operator=( const PCB_COP_CURVES& );
+};
+
+
+// segments whose curves on plane are calculated by a batch of tasks
+struct PCB_COP_BATCH
+{
+    double minX;
+    double maxX;
+    double minY;
+    double maxY;
+    double zHeight;
+    bool reverse;
+    std::vector<MCAD_SEGMENT*> segments;
+    PCB_COP_CURVES* curves;
+};
+
+
+// vertical surface of a segment; the NURBS data of the surface is
+// calculated in advance of the creation of the IGES entities
+struct PCB_WALL_JOB
+{
+    MCAD_SEGMENT* segment;
+    bool reverse;
+    int kind;                   // 0 = outline, 1 = drill hole, 2 = cutout
+    IGES_GEOM_CYLINDER cyl;     // arcs and circles
+    IGES_GEOM_WALL* wall;       // lines
+};
+
+
+// segments whose vertical surfaces are calculated by a batch of tasks;
+// the walls are owned by the batch
+struct PCB_WALL_BATCH
+{
+    double topZ;
+    double botZ;
+    std::vector<PCB_WALL_JOB> jobs;
+
+    ~PCB_WALL_BATCH()
+    {
+        for( size_t i = 0; i < jobs.size(); ++i )
+            delete jobs[i].wall;
+    }
+};
+
+
+static bool calcCopCircle( double offX, double offY, double aScale, double zHeight,
+                           MCAD_SEGMENT* aSegment, bool aReverse, PCB_COP_CURVES& aData );
+static bool calcCopArc( double offX, double offY, double aScale, double zHeight,
+                        MCAD_SEGMENT* aSegment, bool aReverse, PCB_COP_CURVES& aData );
+static bool calcCopLine( double offX, double offY, double aScale, double zHeight,
+                         MCAD_SEGMENT* aSegment, bool aReverse, PCB_COP_CURVES& aData );
+
+
+// calculate the curves representing a segment on the parametric plane
+static bool calcCurveOnPlane( double aMinX, double aMaxX, double aMinY, double aMaxY,
+                              double zHeight, MCAD_SEGMENT* aSegment, bool aReverse,
+                              PCB_COP_CURVES& aData )
+{
+    double scale = 1.0 / ( aMaxX - aMinX ); // scale factor (must be same for X and Y axes)
+
+    aData.Clear();
+
+    switch( aSegment->GetSegType() )
+    {
+        case MCAD_SEGTYPE_CIRCLE:
+            return calcCopCircle( aMinX, aMinY, scale, zHeight, aSegment, aReverse, aData );
+            break;
+
+        case MCAD_SEGTYPE_ARC:
+            return calcCopArc( aMinX, aMinY, scale, zHeight, aSegment, aReverse, aData );
+            break;
+
+        case MCAD_SEGTYPE_LINE:
+            return calcCopLine( aMinX, aMinY, scale, zHeight, aSegment, aReverse, aData );
+            break;
+
+        default:
+            ERRMSG << "\n + [INFO] invalid segment type: " << aSegment->GetSegType() << "\n";
+            break;
+    }
+
+    return false;
+}
+
+
+// create the NURBS curve entities from previously calculated curves
+// and release the curves
+static bool makeCurveOnPlane( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
+                              PCB_COP_CURVES& aData )
+{
+    if( !aData.ncurves )
+        return false;
+
+    IGES_ENTITY_126* cp[3];
+
+    for( int i = 0; i < aData.ncurves; ++i )
+    {
+        if( !newArc126( aModel, &cp[i] ) )
+        {
+            for( int j = 0; j < i; ++j )
+                aModel->DelEntity( (IGES_ENTITY*)(cp[j]) );
+
+            aData.Clear();
+            ERRMSG << "\n + [INFO] could not instantiate IGES NURBS curve\n";
+            return false;
+        }
+    }
+
+    for( int i = 0; i < aData.ncurves; ++i )
+    {
+        SISLCurve* pCurve = aData.curves[i];
+        int iKE = pCurve->in + pCurve->ik - 1;
+
+        if( !cp[i]->SetNURBSData( pCurve->in, pCurve->ik, pCurve->et,
+            pCurve->ecoef, false, pCurve->et[0], pCurve->et[iKE] ) )
+        {
+            for( int j = 0; j < aData.ncurves; ++j )
+                aModel->DelEntity( (IGES_ENTITY*)(cp[j]) );
+
+            aData.Clear();
+            ERRMSG << "\n + [WARNING] problems setting data in NURBS curve\n";
+            return false;
+        }
+    }
+
+    for( int i = 0; i < aData.ncurves; ++i )
+        aCurves.push_back( cp[i] );
+
+    aData.Clear();
+    return true;
+}
+
+
+static void copTask( void* aData, size_t aTask, int aWorker )
+{
+    PCB_COP_BATCH* bp = (PCB_COP_BATCH*)aData;
+
+    calcCurveOnPlane( bp->minX, bp->maxX, bp->minY, bp->maxY, bp->zHeight,
+                      bp->segments[aTask], bp->reverse, bp->curves[aTask] );
+
+    return;
+}
+
+
+// calculate the NURBS data of the vertical surface of a segment
+static void calcSegmentWall( double aTopZ, double aBotZ, PCB_WALL_JOB& aJob )
+{
+    MCAD_SEGMENT* sp = aJob.segment;
+
+    switch( sp->GetSegType() )
+    {
+        case MCAD_SEGTYPE_CIRCLE:
+        case MCAD_SEGTYPE_ARC:
+
+            if( aJob.cyl.SetParams( sp->GetCenter(), sp->GetStart(), sp->GetEnd() ) )
+                aJob.cyl.CalcBounds( ( sp->IsCW() && !aJob.reverse )
+                                     || ( !sp->IsCW() && aJob.reverse ) );
+
+            break;
+
+        case MCAD_SEGTYPE_LINE:
+            do
+            {
+                aJob.wall = new IGES_GEOM_WALL;
+                MCAD_POINT p0 = sp->GetMStart();
+                p0.z = aTopZ;
+                MCAD_POINT p1 = sp->GetMEnd();
+                p1.z = aTopZ;
+                MCAD_POINT p2 = sp->GetMEnd();
+                p2.z = aBotZ;
+                MCAD_POINT p3 = sp->GetMStart();
+                p3.z = aBotZ;
+
+                if( aJob.reverse )
+                    aJob.wall->SetParams( p0, p1, p2, p3 );
+                else
+                    aJob.wall->SetParams( p3, p2, p1, p0 );
+
+            } while( 0 );
+
+            break;
+
+        default:
+            break;
+    }
+
+    return;
+}
+
+
+// create the entities of the vertical surface of a segment from the
+// previously calculated NURBS data
+static bool makeSegmentWall( IGES* aModel, std::vector<IGES_ENTITY_144*>& aSurface,
+                             double aTopZ, double aBotZ, PCB_WALL_JOB& aJob )
+{
+    if( !aModel )
+    {
+        ERRMSG << "\n + [ERROR] null pointer passed for IGES model\n";
+        return false;
+    }
+
+    if( abs( aTopZ - aBotZ ) < 1e-6 )
+    {
+        ERRMSG << "\n + [ERROR] degenerate surface\n";
+        return false;
+    }
+
+    if( !aJob.segment->GetSegType() )
+    {
+        ERRMSG << "\n + [ERROR] no model data to work with\n";
+        return false;
+    }
+
+    bool ok = false;
+
+    switch( aJob.segment->GetSegType() )
+    {
+        case MCAD_SEGTYPE_CIRCLE:
+        case MCAD_SEGTYPE_ARC:
+            do
+            {
+                IGES_ENTITY_144** surfs = NULL;
+                int nParts;
+                bool cw = aJob.segment->IsCW();
+
+                if( ( cw && !aJob.reverse ) || ( !cw && aJob.reverse ) )
+                    ok = aJob.cyl.Instantiate( aModel, aTopZ, aBotZ, surfs, nParts, true );
+                else
+                    ok = aJob.cyl.Instantiate( aModel, aTopZ, aBotZ, surfs, nParts, false );
+
+                if( ok )
+                {
+                    for( int i = 0; i < nParts; ++i )
+                        aSurface.push_back( surfs[i] );
+
+                    delete [] surfs;
+                }
+
+            } while( 0 );
+
+            break;
+
+        default:
+            do
+            {
+                IGES_ENTITY_144* ep = NULL;
+
+                if( aJob.wall )
+                    ep = aJob.wall->Instantiate( aModel );
+
+                if( NULL == ep )
+                {
+                    ERRMSG << "\n + [ERROR] could not create solid model feature\n";
+                    ok = false;
+                }
+                else
+                {
+                    aSurface.push_back( ep );
+                    ok = true;
+                }
+
+            } while( 0 );
+
+            break;
+    }
+
+    return ok;
+}
+
+
+// create a Subfigure Definition of the barrel of a drill hole centered on the origin
+static IGES_ENTITY_308* makeDrillBarrel( IGES* aModel, double aRadius,
+                                         double aTopZ, double aBotZ, bool aReverse )
+{
+    IGES_GEOM_CYLINDER cyl;
+    MCAD_POINT pc( 0.0, 0.0, 0.0 );
+    MCAD_POINT ps( aRadius, 0.0, 0.0 );
+
+    if( !cyl.SetParams( pc, ps, ps ) )
+        return NULL;
+
+    IGES_ENTITY_144** surfs = NULL;
+    int nParts;
+
+    if( !cyl.Instantiate( aModel, aTopZ, aBotZ, surfs, nParts, aReverse ) )
+        return NULL;
+
+    IGES_ENTITY* ep;
+    IGES_ENTITY_308* barrel = NULL;
+
+    if( aModel->NewEntity( ENT_SUBFIGURE_DEFINITION, &ep ) )
+    {
+        barrel = dynamic_cast<IGES_ENTITY_308*>( ep );
+
+        if( NULL == barrel )
+            aModel->DelEntity( ep );
+    }
+
+    for( int i = 0; i < nParts && NULL != barrel; ++i )
+    {
+        if( !barrel->AddDE( (IGES_ENTITY*)surfs[i] ) )
+        {
+            aModel->DelEntity( (IGES_ENTITY*)barrel );
+            barrel = NULL;
+        }
+    }
+
+    if( NULL == barrel )
+    {
+        ERRMSG << "\n + [INFO] could not create a drill barrel\n";
+
+        for( int i = 0; i < nParts; ++i )
+            aModel->DelEntity( (IGES_ENTITY*)surfs[i] );
+    }
+
+    delete [] surfs;
+    return barrel;
+}
+
+
+static void wallTask( void* aData, size_t aTask, int aWorker )
+{
+    PCB_WALL_BATCH* bp = (PCB_WALL_BATCH*)aData;
+
+    calcSegmentWall( bp->topZ, bp->botZ, bp->jobs[aTask] );
+
+    return;
+}
+
+
 IGES_GEOM_PCB::IGES_GEOM_PCB()
 {
     mIsClosed = false;
     mWinding = 0.0;
     mBBisOK = false;
+    mEdgeIndexOK = false;
     m_OutlineType = MCAD_OT_PCB;
     return;
 }
@@ -188,7 +570,27 @@ IGES_GEOM_PCB::~IGES_GEOM_PCB()
 // of the main outline and all cutouts
 bool IGES_GEOM_PCB::GetVerticalSurface( IGES* aModel, bool& error,
                                             std::vector<IGES_ENTITY_144*>& aSurface,
-                                            double aTopZ, double aBotZ )
+                                            double aTopZ, double aBotZ, int aNThreads )
+{
+    return getVerticalSurface( aModel, error, aSurface, NULL, aTopZ, aBotZ, aNThreads );
+}
+
+
+// retrieve trimmed parametric surfaces representing vertical sides of the
+// main outline and all cutouts and instances representing the drill holes
+bool IGES_GEOM_PCB::GetVerticalSurface( IGES* aModel, bool& error,
+                                            std::vector<IGES_ENTITY_144*>& aSurface,
+                                            std::vector<IGES_ENTITY_408*>& aDrills,
+                                            double aTopZ, double aBotZ, int aNThreads )
+{
+    return getVerticalSurface( aModel, error, aSurface, &aDrills, aTopZ, aBotZ, aNThreads );
+}
+
+
+bool IGES_GEOM_PCB::getVerticalSurface( IGES* aModel, bool& error,
+                                            std::vector<IGES_ENTITY_144*>& aSurface,
+                                            std::vector<IGES_ENTITY_408*>* aDrills,
+                                            double aTopZ, double aBotZ, int aNThreads )
 {
     error = false;
 
@@ -214,34 +616,130 @@ bool IGES_GEOM_PCB::GetVerticalSurface( IGES* aModel, bool& error,
         return false;
     }
 
+    // merge collinear and co-circular segments to reduce the number
+    // of surfaces and seams
+    Simplify( PCB_SIMPLIFY_TOL, error );
+
+    if( error )
+        return false;
+
+    // collect the segments of the outline, drill holes and cutouts; the
+    // NURBS data of all surfaces is calculated concurrently and the
+    // entities are then created in the order of the segments
+    PCB_WALL_BATCH batch;
+    PCB_WALL_JOB job;
+    job.wall = NULL;
+    batch.topZ = aTopZ;
+    batch.botZ = aBotZ;
+
     list<MCAD_SEGMENT*>::iterator sSeg = msegments.begin();
     list<MCAD_SEGMENT*>::iterator eSeg = msegments.end();
+    job.reverse = false;
+    job.kind = 0;
 
     while( sSeg != eSeg )
     {
-        if( !GetSegmentWall( aModel, aSurface, aTopZ, aBotZ, *sSeg, false ) )
+        job.segment = *sSeg;
+        batch.jobs.push_back( job );
+        ++sSeg;
+    }
+
+    sSeg = mholes.begin();
+    eSeg = mholes.end();
+    job.reverse = true;
+    job.kind = 1;
+
+    while( sSeg != eSeg && NULL == aDrills )
+    {
+        job.segment = *sSeg;
+        batch.jobs.push_back( job );
+        ++sSeg;
+    }
+
+    list<MCAD_OUTLINE*>::iterator sOtln = mcutouts.begin();
+    list<MCAD_OUTLINE*>::iterator eOtln = mcutouts.end();
+    job.kind = 2;
+
+    while( sOtln != eOtln )
+    {
+        list<MCAD_SEGMENT*>* segments = (*sOtln)->GetSegments();
+        sSeg = segments->begin();
+        eSeg = segments->end();
+
+        while( sSeg != eSeg )
+        {
+            job.segment = *sSeg;
+            batch.jobs.push_back( job );
+            ++sSeg;
+        }
+
+        ++sOtln;
+    }
+
+    size_t nJobs = batch.jobs.size();
+
+    IGES_WORK_POOL::Run( nJobs, wallTask, &batch,
+                         nJobs < PCB_MIN_PARALLEL ? 1 : aNThreads );
+
+    for( size_t i = 0; i < nJobs; ++i )
+    {
+        if( !makeSegmentWall( aModel, aSurface, aTopZ, aBotZ, batch.jobs[i] ) )
         {
             ostringstream msg;
             GEOM_ERR( msg );
-            msg << "[ERROR] could not render a vertical surface of a segment";
+
+            switch( batch.jobs[i].kind )
+            {
+                case 0:
+                    msg << "[ERROR] could not render a vertical surface of a segment";
+                    break;
+
+                case 1:
+                    msg << "[ERROR] could not render a vertical surface of a hole";
+                    break;
+
+                default:
+                    msg << "[ERROR] could not render a vertical surface of a cutout";
+                    break;
+            }
+
             ERRMSG << msg.str() << "\n";
             errors.push_back( msg.str() );
             error = true;
             return false;
         }
 
-        ++sSeg;
+        delete batch.jobs[i].wall;
+        batch.jobs[i].wall = NULL;
     }
 
-    if( !mholes.empty() )
+    if( NULL == aDrills || mholes.empty() )
+        return true;
+
+    // the barrels are centered on the origin and are shared by all drill
+    // holes of the same radius and orientation; radii which differ by no
+    // more than the tolerance of the segment geometry are considered equal
+    map<double, IGES_ENTITY_308*> barrels[2];
+    map<double, IGES_ENTITY_308*>::iterator sB;
+    sSeg = mholes.begin();
+    eSeg = mholes.end();
+
+    while( sSeg != eSeg )
     {
-        sSeg = mholes.begin();
-        eSeg = mholes.end();
+        double rad = (*sSeg)->GetRadius();
+        int rev = (*sSeg)->IsCW() ? 0 : 1;
+        IGES_ENTITY_308* barrel = NULL;
 
-        while( sSeg != eSeg )
+        sB = barrels[rev].lower_bound( rad - 1e-8 );
+
+        if( sB != barrels[rev].end() && sB->first <= rad + 1e-8 )
+            barrel = sB->second;
+
+        if( NULL == barrel )
         {
+            barrel = makeDrillBarrel( aModel, rad, aTopZ, aBotZ, 1 == rev );
 
-            if( !GetSegmentWall( aModel, aSurface, aTopZ, aBotZ, *sSeg, true ) )
+            if( NULL == barrel )
             {
                 ostringstream msg;
                 GEOM_ERR( msg );
@@ -252,40 +750,40 @@ bool IGES_GEOM_PCB::GetVerticalSurface( IGES* aModel, bool& error,
                 return false;
             }
 
-            ++sSeg;
+            barrels[rev].insert( pair<double, IGES_ENTITY_308*>( rad, barrel ) );
         }
-    }
 
-    if( !mcutouts.empty() )
-    {
-        list<MCAD_OUTLINE*>* cutouts = GetCutouts();
-        list<MCAD_OUTLINE*>::iterator sOtln = cutouts->begin();
-        list<MCAD_OUTLINE*>::iterator eOtln = cutouts->end();
+        IGES_ENTITY* ep;
+        IGES_ENTITY_408* dp = NULL;
 
-        while( sOtln != eOtln )
+        if( aModel->NewEntity( ENT_SINGULAR_SUBFIGURE_INSTANCE, &ep ) )
         {
-            list<MCAD_SEGMENT*>* segments = (*sOtln)->GetSegments();
-            sSeg = segments->begin();
-            eSeg = segments->end();
+            dp = dynamic_cast<IGES_ENTITY_408*>( ep );
 
-            while( sSeg != eSeg )
+            if( NULL == dp || !dp->SetDE( barrel ) )
             {
-                if( !GetSegmentWall( aModel, aSurface, aTopZ, aBotZ, *sSeg, true ) )
-                {
-                    ostringstream msg;
-                    GEOM_ERR( msg );
-                    msg << "[ERROR] could not render a vertical surface of a cutout";
-                    ERRMSG << msg.str() << "\n";
-                    errors.push_back( msg.str() );
-                    error = true;
-                    return false;
-                }
-
-                ++sSeg;
+                aModel->DelEntity( ep );
+                dp = NULL;
             }
+        }
 
-            ++sOtln;
+        if( NULL == dp )
+        {
+            ostringstream msg;
+            GEOM_ERR( msg );
+            msg << "[ERROR] could not instantiate a drill hole";
+            ERRMSG << msg.str() << "\n";
+            errors.push_back( msg.str() );
+            error = true;
+            return false;
         }
+
+        MCAD_POINT pc = (*sSeg)->GetCenter();
+        dp->X = pc.x;
+        dp->Y = pc.y;
+        dp->Z = 0.0;
+        aDrills->push_back( dp );
+        ++sSeg;
     }
 
     return true;
@@ -296,7 +794,7 @@ bool IGES_GEOM_PCB::GetVerticalSurface( IGES* aModel, bool& error,
 // top or bottom plane of the board
 bool IGES_GEOM_PCB::GetTrimmedPlane( IGES* aModel, bool& error,
                       std::vector<IGES_ENTITY_144*>& aSurface,
-                      double aHeight, bool aReverse )
+                      double aHeight, bool aReverse, int aNThreads )
 {
     error = false;
 
@@ -324,6 +822,47 @@ bool IGES_GEOM_PCB::GetTrimmedPlane( IGES* aModel, bool& error,
         return false;
     }
 
+    // merge collinear and co-circular segments to reduce the number
+    // of surfaces and seams
+    if( Simplify( PCB_SIMPLIFY_TOL, error ) )
+        calcBoundingBox();
+
+    if( error )
+        return false;
+
+    // calculate the curves on plane of the outline, cutouts and drill
+    // holes concurrently; the entities are created in the order of
+    // the segments as the trimming curves are assembled below
+    PCB_COP_BATCH batch;
+    batch.minX = mBottomLeft.x;
+    batch.maxX = mTopRight.x;
+    batch.minY = mBottomLeft.y;
+    batch.maxY = mTopRight.y;
+    batch.zHeight = aHeight;
+    batch.reverse = aReverse;
+    batch.segments.insert( batch.segments.end(), msegments.begin(), msegments.end() );
+
+    list<MCAD_OUTLINE*>::iterator sOtln = mcutouts.begin();
+    list<MCAD_OUTLINE*>::iterator eOtln = mcutouts.end();
+
+    while( sOtln != eOtln )
+    {
+        list<MCAD_SEGMENT*>* pSegList = (*sOtln)->GetSegments();
+        batch.segments.insert( batch.segments.end(), pSegList->begin(), pSegList->end() );
+        ++sOtln;
+    }
+
+    batch.segments.insert( batch.segments.end(), mholes.begin(), mholes.end() );
+
+    size_t nStaged = batch.segments.size();
+    vector<PCB_COP_CURVES> staged( nStaged );
+    batch.curves = &staged[0];
+
+    IGES_WORK_POOL::Run( nStaged, copTask, &batch,
+                         nStaged < PCB_MIN_PARALLEL ? 1 : aNThreads );
+
+    size_t iStaged = 0;
+
     // Step 1: create the plane to be trimmed;
     IGES_ENTITY_144* plane = getUntrimmedPlane( aModel, aHeight, aReverse );
 
@@ -362,8 +901,7 @@ bool IGES_GEOM_PCB::GetTrimmedPlane( IGES* aModel, bool& error,
     int acc = 0;
     while( sSeg != eSeg )
     {
-        if( !GetCurveOnPlane( aModel, bcurves, mBottomLeft.x, mTopRight.x,
-            mBottomLeft.y, mTopRight.y, aHeight, *sSeg, aReverse ) )
+        if( !makeCurveOnPlane( aModel, bcurves, staged[iStaged++] ) )
         {
             ostringstream msg;
             GEOM_ERR( msg );
@@ -512,8 +1050,7 @@ bool IGES_GEOM_PCB::GetTrimmedPlane( IGES* aModel, bool& error,
 
         while( sSeg != eSeg )
         {
-            if( !GetCurveOnPlane( aModel, bcurves, mBottomLeft.x, mTopRight.x,
-                mBottomLeft.y, mTopRight.y, aHeight, *sSeg, aReverse ) )
+            if( !makeCurveOnPlane( aModel, bcurves, staged[iStaged++] ) )
             {
                 ostringstream msg;
                 GEOM_ERR( msg );
@@ -640,8 +1177,7 @@ bool IGES_GEOM_PCB::GetTrimmedPlane( IGES* aModel, bool& error,
             }
         }
 
-        if( !GetCurveOnPlane( aModel, bcurves, mBottomLeft.x, mTopRight.x,
-            mBottomLeft.y, mTopRight.y, aHeight, *sDH, aReverse ) )
+        if( !makeCurveOnPlane( aModel, bcurves, staged[iStaged++] ) )
         {
             ostringstream msg;
             GEOM_ERR( msg );
@@ -959,34 +1495,10 @@ bool IGES_GEOM_PCB::GetCurveOnPlane(  IGES* aModel, std::list<IGES_ENTITY_126*>&
                                           double aMinX, double aMaxX, double aMinY, double aMaxY,
                                           double zHeight, MCAD_SEGMENT* aSegment, bool aReverse )
 {
-    double scale = 1.0 / ( aMaxX - aMinX ); // scale factor (must be same for X and Y axes)
-    bool ok;
-
-    switch( aSegment->GetSegType() )
-    {
-        case MCAD_SEGTYPE_CIRCLE:
-            ok = copCircle( aModel, aCurves, aMinX, aMinY, scale, zHeight, aSegment, aReverse );
-            break;
-
-        case MCAD_SEGTYPE_ARC:
-            ok = copArc( aModel, aCurves, aMinX, aMinY, scale, zHeight, aSegment, aReverse );
-            break;
-
-        case MCAD_SEGTYPE_LINE:
-            ok = copLine(aModel, aCurves, aMinX, aMinY, scale, zHeight, aSegment, aReverse);
-            break;
-
-        default:
-            do
-            {
-                ERRMSG << "\n + [INFO] invalid segment type: " << aSegment->GetSegType() << "\n";
-                return false;
-            } while( 0 );
-
-            break;
-    }
+    PCB_COP_CURVES data;
 
-    if( !ok )
+    if( !calcCurveOnPlane( aMinX, aMaxX, aMinY, aMaxY, zHeight, aSegment, aReverse, data )
+        || !makeCurveOnPlane( aModel, aCurves, data ) )
     {
         ERRMSG << "\n + [INFO] failure; see messages above\n";
         return false;
@@ -1000,92 +1512,17 @@ bool IGES_GEOM_PCB::GetCurveOnPlane(  IGES* aModel, std::list<IGES_ENTITY_126*>&
 bool IGES_GEOM_PCB::GetSegmentWall( IGES* aModel, std::vector<IGES_ENTITY_144*>& aSurface,
     double aTopZ, double aBotZ, MCAD_SEGMENT* aSegment, bool aReverse )
 {
-    if( !aModel )
-    {
-        ERRMSG << "\n + [ERROR] null pointer passed for IGES model\n";
-        return false;
-    }
+    PCB_WALL_JOB job;
+    job.segment = aSegment;
+    job.reverse = aReverse;
+    job.kind = 0;
+    job.wall = NULL;
 
-    if( abs( aTopZ - aBotZ ) < 1e-6 )
-    {
-        ERRMSG << "\n + [ERROR] degenerate surface\n";
-        return false;
-    }
-
-    if( !aSegment->GetSegType() )
-    {
-        ERRMSG << "\n + [ERROR] no model data to work with\n";
-        return false;
-    }
-
-    bool ok = false;
-
-    switch( aSegment->GetSegType() )
-    {
-        case MCAD_SEGTYPE_CIRCLE:
-        case MCAD_SEGTYPE_ARC:
-            do
-            {
-                IGES_GEOM_CYLINDER cyl;
+    if( aModel && abs( aTopZ - aBotZ ) >= 1e-6 )
+        calcSegmentWall( aTopZ, aBotZ, job );
 
-                cyl.SetParams( aSegment->GetCenter(), aSegment->GetStart(),
-                    aSegment->GetEnd() );
-
-                IGES_ENTITY_144** surfs = NULL;
-                int nParts;
-
-                if( ( aSegment->IsCW() && !aReverse ) || ( !aSegment->IsCW() && aReverse ) )
-                    ok = cyl.Instantiate( aModel, aTopZ, aBotZ, surfs, nParts, true );
-                else
-                    ok = cyl.Instantiate( aModel, aTopZ, aBotZ, surfs, nParts, false );
-
-                if( ok )
-                {
-                    for( int i = 0; i < nParts; ++i )
-                        aSurface.push_back( surfs[i] );
-
-                    delete [] surfs;
-                }
-
-            } while( 0 );
-
-            break;
-
-        default:
-            do
-            {
-                IGES_GEOM_WALL wall;
-                MCAD_POINT p0 = aSegment->GetMStart();
-                p0.z = aTopZ;
-                MCAD_POINT p1 = aSegment->GetMEnd();
-                p1.z = aTopZ;
-                MCAD_POINT p2 = aSegment->GetMEnd();
-                p2.z = aBotZ;
-                MCAD_POINT p3 = aSegment->GetMStart();
-                p3.z = aBotZ;
-
-                if( aReverse )
-                    wall.SetParams( p0, p1, p2, p3 );
-                else
-                    wall.SetParams( p3, p2, p1, p0 );
-
-                IGES_ENTITY_144* ep = wall.Instantiate( aModel );
-
-                if( NULL == ep )
-                {
-                    ERRMSG << "\n + [ERROR] could not create solid model feature\n";
-                    ok = false;
-                }
-                else
-                {
-                    aSurface.push_back( ep );
-                    ok = true;
-                }
-
-            } while( 0 );
-
-            break;
-    }
+    bool ok = makeSegmentWall( aModel, aSurface, aTopZ, aBotZ, job );
+    delete job.wall;
 
     return ok;
 }
@@ -1503,24 +1940,9 @@ bool IGES_GEOM_PCB::getCurveLine( IGES* aModel, std::list<IGES_CURVE*>& aCurves,
 }
 
 
-bool IGES_GEOM_PCB::copCircle( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
-                                   double offX, double offY, double aScale,
-                                   double zHeight, MCAD_SEGMENT* aSegment, bool aReverse )
+static bool calcCopCircle( double offX, double offY, double aScale, double zHeight,
+                           MCAD_SEGMENT* aSegment, bool aReverse, PCB_COP_CURVES& aData )
 {
-    IGES_ENTITY_126* cp[2];
-
-    for( int i = 0; i < 2; ++ i )
-    {
-        if( !newArc126( aModel, &cp[i] ) )
-        {
-            for( int j = 0; j < i; ++j )
-                aModel->DelEntity( (IGES_ENTITY*)(cp[j]) );
-
-            ERRMSG << "\n + [INFO] could not instantiate IGES NURBS curve\n";
-            return false;
-        }
-    }
-
     MCAD_POINT mcenter = aSegment->GetCenter();
     double mradius = aSegment->GetRadius();
     double axis[3] = { 0.0, 0.0, 1.0 }; // normal to the plane of the arc
@@ -1569,9 +1991,6 @@ bool IGES_GEOM_PCB::copCircle( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurve
                 for( int j = 0; j < i; ++j )
                     freeCurve( pCurve[j] );
 
-                for( int j = 0; j < 2; ++j )
-                    aModel->DelEntity( (IGES_ENTITY*)(cp[j]) );
-
                 ERRMSG << "\n + [ERROR] could not create NURBS arc\n";
                 return false;
                 break;
@@ -1579,42 +1998,16 @@ bool IGES_GEOM_PCB::copCircle( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurve
     }
 
     for( int i = 0; i < 2; ++i )
-    {
-        int iKE = pCurve[i]->in + pCurve[i]->ik - 1;
-
-        if( !cp[i]->SetNURBSData( pCurve[i]->in, pCurve[i]->ik, pCurve[i]->et,
-            pCurve[i]->ecoef, false, pCurve[i]->et[0], pCurve[i]->et[iKE]) )
-        {
-            for( int j = 0; j < 2; ++j )
-            {
-                freeCurve( pCurve[j] );
-                aModel->DelEntity( (IGES_ENTITY*)(cp[j]) );
-            }
-
-            ERRMSG << "\n + [WARNING] problems setting data in NURBS arc\n";
-            return false;
-        }
-    }
-
-    for( int i = 0; i < 2; ++i )
-    {
-        freeCurve( pCurve[i] );
-        aCurves.push_back( cp[i] );
-    }
+        aData.curves[i] = pCurve[i];
 
+    aData.ncurves = 2;
     return true;
 }
 
 
-bool IGES_GEOM_PCB::copArc( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
-                                double offX, double offY, double aScale,
-                                double zHeight, MCAD_SEGMENT* aSegment, bool aReverse )
+static bool calcCopArc( double offX, double offY, double aScale, double zHeight,
+                        MCAD_SEGMENT* aSegment, bool aReverse, PCB_COP_CURVES& aData )
 {
-    IGES_ENTITY_126* cp[3]; // we may have up to 3 entities to describe a single arc
-
-    for( int i = 0; i < 3; ++i )
-        cp[i] = NULL;
-
     MCAD_POINT mstart = aSegment->GetStart();
     MCAD_POINT mend = aSegment->GetEnd();
     MCAD_POINT mcenter = aSegment->GetCenter();
@@ -1749,18 +2142,6 @@ bool IGES_GEOM_PCB::copArc( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
         }
     }
 
-    for( int i = 0; i < na; ++ i )
-    {
-        if( !newArc126( aModel, &cp[i] ) )
-        {
-            for( int j = 0; j < i; ++j )
-                aModel->DelEntity( (IGES_ENTITY*)(cp[j]) );
-
-            ERRMSG << "\n + [INFO] could not instantiate IGES NURBS curve\n";
-            return false;
-        }
-    }
-
     double axis[3] = { 0.0, 0.0, 1.0 }; // normal to the plane of the arc
     double startp[3];
     SISLCurve* pCurve[3] = { NULL, NULL, NULL };
@@ -1810,64 +2191,30 @@ bool IGES_GEOM_PCB::copArc( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
                 for( int j = 0; j < i; ++j )
                     freeCurve( pCurve[j] );
 
-                for( int j = 0; j < na; ++j )
-                    aModel->DelEntity( (IGES_ENTITY*)(cp[j]) );
-
                 ERRMSG << "\n + [ERROR] could not create NURBS arc\n";
                 return false;
                 break;
         }
     }
 
+    // we may have up to 3 entities to describe a single arc; the
+    // entities are always in the direction of the segment
     for( int i = 0; i < na; ++i )
     {
-        int idx;
-
-        if( aSegment->IsCW()  )
-            idx = na - i - 1;
+        if( aSegment->IsCW() )
+            aData.curves[i] = pCurve[na - i - 1];
         else
-            idx = i;
-
-        int iKE = pCurve[idx]->in + pCurve[idx]->ik - 1;
-
-        if( !cp[i]->SetNURBSData( pCurve[idx]->in, pCurve[idx]->ik, pCurve[idx]->et,
-            pCurve[idx]->ecoef, false, pCurve[idx]->et[0], pCurve[idx]->et[iKE] ) )
-        {
-            for( int j = 0; j < na; ++j )
-            {
-                if( pCurve[j] )
-                    freeCurve( pCurve[j] );
-
-                aModel->DelEntity( (IGES_ENTITY*)(cp[j]) );
-            }
-
-            ERRMSG << "\n + [WARNING] problems setting data in NURBS arc\n";
-            return false;
-        }
-    }
-
-    for( int i = 0; i < na; ++i )
-    {
-        freeCurve( pCurve[i] );
-        aCurves.push_back( cp[i] );
+            aData.curves[i] = pCurve[i];
     }
 
+    aData.ncurves = na;
     return true;
 }
 
 
-bool IGES_GEOM_PCB::copLine( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
-                                 double offX, double offY, double aScale,
-                                 double zHeight, MCAD_SEGMENT* aSegment, bool aReverse )
+static bool calcCopLine( double offX, double offY, double aScale, double zHeight,
+                         MCAD_SEGMENT* aSegment, bool aReverse, PCB_COP_CURVES& aData )
 {
-    IGES_ENTITY_126* cp;
-
-    if( !newArc126( aModel, &cp ) )
-    {
-        ERRMSG << "\n + [INFO] could not instantiate IGES NURBS curve\n";
-        return false;
-    }
-
     MCAD_POINT mstart = aSegment->GetMStart();
     MCAD_POINT mend = aSegment->GetMEnd();
 
@@ -1908,18 +2255,7 @@ bool IGES_GEOM_PCB::copLine( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
             break;
     }
 
-    int iKE = pCurve->in + pCurve->ik - 1;
-
-    if( !cp->SetNURBSData( pCurve->in, pCurve->ik, pCurve->et, pCurve->ecoef, false,
-        pCurve->et[0], pCurve->et[iKE] ) )
-    {
-        ERRMSG << "\n + [WARNING] problems setting data in NURBS curve\n";
-        aModel->DelEntity( (IGES_ENTITY*)cp );
-        freeCurve( pCurve );
-        return false;
-    }
-
-    freeCurve( pCurve );
-    aCurves.push_back( cp );
+    aData.curves[0] = pCurve;
+    aData.ncurves = 1;
     return true;
 }
@@ -0,0 +1,1203 @@
+/*
+ * file: mcad_boolean.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: Boolean operations on any number of closed outlines
+ * consisting of lines, arcs and circles.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <sstream>
+#include <cmath>
+#include <map>
+#include <algorithm>
+#include <core/iges.h>
+#include <error_macros.h>
+#include <geom/mcad_helpers.h>
+#include <geom/mcad_segment.h>
+#include <geom/mcad_outline.h>
+#include <geom/mcad_boxtree.h>
+#include <geom/iges_geom_pcb.h>
+#include <geom/mcad_boolean.h>
+
+using namespace std;
+
+#define GEOM_ERR( msg ) do { \
+    msg.str(""); \
+    msg << __FILE__ << ":" << __LINE__ << ":" << __FUNCTION__ << ": "; \
+} while( 0 )
+
+// points closer than this are the same vertex; this is the tolerance
+// used to join the segments of an outline
+#define BOOL_VTOL ( 1e-8 )
+
+// an operand; 'outline' is NULL for a circle
+struct BOOL_OPERAND
+{
+    MCAD_OUTLINE* outline;
+    MCAD_POINT center;
+    double radius;
+    bool sub;
+};
+
+// a segment of an operand; lines are parameterized as p0 + t(p1 - p0) and
+// arcs and circles as c + r(cos(a), sin(a)) with a = a0 + t * sw
+struct BOOL_EDGE
+{
+    int op;
+    bool arc;
+    bool full;          // true for a complete circle
+    MCAD_POINT p0;
+    MCAD_POINT p1;
+    MCAD_POINT c;
+    double r;
+    double a0;
+    double sw;          // sweep angle; > 0 for a CCW arc
+    MCAD_POINT bb0;
+    MCAD_POINT bb1;
+    int v0;             // vertex at t = 0
+    int v1;             // vertex at t = 1
+    vector< pair<double, int> > cuts;   // (t, vertex) of each intersection
+};
+
+// a part of an edge between 2 consecutive vertices
+struct BOOL_PIECE
+{
+    int edge;
+    double t0;
+    double t1;
+    int va;             // vertex at t0
+    int vb;             // vertex at t1
+    bool rev;           // the result runs from t1 to t0
+    bool used;
+};
+
+// registry of the vertices of the operation; points within BOOL_VTOL
+// of an existing vertex are merged with that vertex
+struct BOOL_VERTICES
+{
+    vector<MCAD_POINT> pts;
+    map< pair<long long, long long>, vector<int> > grid;
+
+    int Add( const MCAD_POINT& aPoint )
+    {
+        const double cell = 1e-6;
+        long long ix = (long long)floor( aPoint.x / cell );
+        long long iy = (long long)floor( aPoint.y / cell );
+
+        for( long long i = ix - 1; i <= ix + 1; ++i )
+        {
+            for( long long j = iy - 1; j <= iy + 1; ++j )
+            {
+                map< pair<long long, long long>, vector<int> >::iterator sG =
+                    grid.find( pair<long long, long long>( i, j ) );
+
+                if( sG == grid.end() )
+                    continue;
+
+                for( size_t k = 0; k < sG->second.size(); ++k )
+                {
+                    const MCAD_POINT& p = pts[sG->second[k]];
+                    double dx = p.x - aPoint.x;
+                    double dy = p.y - aPoint.y;
+
+                    if( dx * dx + dy * dy <= BOOL_VTOL * BOOL_VTOL )
+                        return sG->second[k];
+                }
+            }
+        }
+
+        MCAD_POINT p( aPoint.x, aPoint.y, 0.0 );
+        pts.push_back( p );
+        grid[pair<long long, long long>( ix, iy )].push_back( (int)pts.size() - 1 );
+        return (int)pts.size() - 1;
+    }
+};
+
+
+static inline double cross2( const MCAD_POINT& a, const MCAD_POINT& b )
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+
+static inline double dot2( const MCAD_POINT& a, const MCAD_POINT& b )
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+
+static MCAD_POINT edgePoint( const BOOL_EDGE& e, double t )
+{
+    MCAD_POINT p;
+
+    if( e.arc )
+    {
+        double a = e.a0 + t * e.sw;
+        p.x = e.c.x + e.r * cos( a );
+        p.y = e.c.y + e.r * sin( a );
+    }
+    else
+    {
+        p.x = e.p0.x + t * ( e.p1.x - e.p0.x );
+        p.y = e.p0.y + t * ( e.p1.y - e.p0.y );
+    }
+
+    return p;
+}
+
+
+// unit tangent in the direction of increasing t
+static MCAD_POINT edgeTangent( const BOOL_EDGE& e, double t )
+{
+    MCAD_POINT d;
+
+    if( e.arc )
+    {
+        double a = e.a0 + t * e.sw;
+        double s = ( e.sw < 0.0 ) ? -1.0 : 1.0;
+        d.x = -s * sin( a );
+        d.y = s * cos( a );
+    }
+    else
+    {
+        d = e.p1 - e.p0;
+        double l = sqrt( dot2( d, d ) );
+        d.x /= l;
+        d.y /= l;
+    }
+
+    return d;
+}
+
+
+static double edgeLength( const BOOL_EDGE& e )
+{
+    if( e.arc )
+        return e.r * abs( e.sw );
+
+    MCAD_POINT d = e.p1 - e.p0;
+    return sqrt( dot2( d, d ) );
+}
+
+
+// calculate the parameter of a point which lies on the curve of an edge;
+// returns false if the point is not within the extent of the edge
+static bool edgeParam( const BOOL_EDGE& e, const MCAD_POINT& q, double& t )
+{
+    if( e.arc )
+    {
+        double off = atan2( q.y - e.c.y, q.x - e.c.x );
+
+        if( e.sw > 0.0 )
+            off -= e.a0;
+        else
+            off = e.a0 - off;
+
+        off = fmod( off, 2.0 * M_PI );
+
+        if( off < 0.0 )
+            off += 2.0 * M_PI;
+
+        double asw = abs( e.sw );
+        double atol = BOOL_VTOL / e.r;
+
+        if( off <= asw + atol )
+        {
+            t = min( off / asw, 1.0 );
+            return true;
+        }
+
+        if( 2.0 * M_PI - off <= atol )
+        {
+            t = 0.0;
+            return true;
+        }
+
+        return false;
+    }
+
+    MCAD_POINT d = e.p1 - e.p0;
+    double l2 = dot2( d, d );
+    double tl = BOOL_VTOL / sqrt( l2 );
+    t = dot2( q - e.p0, d ) / l2;
+
+    if( t < -tl || t > 1.0 + tl )
+        return false;
+
+    t = max( 0.0, min( t, 1.0 ) );
+    return true;
+}
+
+
+// add a cut to both edges if the point lies on both
+static void addCut( BOOL_EDGE& a, BOOL_EDGE& b, const MCAD_POINT& q, BOOL_VERTICES& verts )
+{
+    double ta;
+    double tb;
+
+    if( !edgeParam( a, q, ta ) || !edgeParam( b, q, tb ) )
+        return;
+
+    int v = verts.Add( q );
+    a.cuts.push_back( pair<double, int>( ta, v ) );
+    b.cuts.push_back( pair<double, int>( tb, v ) );
+    return;
+}
+
+
+// edges 'a' and 'b' lie on the same line or circle: each is cut at
+// the endpoints of the other
+static void addOverlap( BOOL_EDGE& a, BOOL_EDGE& b )
+{
+    double t;
+
+    if( !b.full )
+    {
+        if( edgeParam( a, b.p0, t ) )
+            a.cuts.push_back( pair<double, int>( t, b.v0 ) );
+
+        if( edgeParam( a, b.p1, t ) )
+            a.cuts.push_back( pair<double, int>( t, b.v1 ) );
+    }
+
+    if( !a.full )
+    {
+        if( edgeParam( b, a.p0, t ) )
+            b.cuts.push_back( pair<double, int>( t, a.v0 ) );
+
+        if( edgeParam( b, a.p1, t ) )
+            b.cuts.push_back( pair<double, int>( t, a.v1 ) );
+    }
+
+    return;
+}
+
+
+static void intersectLines( BOOL_EDGE& a, BOOL_EDGE& b, BOOL_VERTICES& verts )
+{
+    MCAD_POINT d1 = a.p1 - a.p0;
+    MCAD_POINT d2 = b.p1 - b.p0;
+    double l1 = sqrt( dot2( d1, d1 ) );
+
+    // collinear lines
+    if( abs( cross2( d1, b.p0 - a.p0 ) ) <= BOOL_VTOL * l1
+        && abs( cross2( d1, b.p1 - a.p0 ) ) <= BOOL_VTOL * l1 )
+    {
+        addOverlap( a, b );
+        return;
+    }
+
+    double den = cross2( d1, d2 );
+
+    if( 0.0 == den )
+        return;
+
+    double s = cross2( b.p0 - a.p0, d2 ) / den;
+    MCAD_POINT q = a.p0 + s * d1;
+    addCut( a, b, q, verts );
+    return;
+}
+
+
+static void intersectLineArc( BOOL_EDGE& ln, BOOL_EDGE& ar, BOOL_VERTICES& verts )
+{
+    MCAD_POINT u = ln.p1 - ln.p0;
+    double l = sqrt( dot2( u, u ) );
+    u.x /= l;
+    u.y /= l;
+
+    MCAD_POINT w = ar.c - ln.p0;
+    double tf = dot2( w, u );
+    double dist = abs( cross2( u, w ) );
+    MCAD_POINT foot = ln.p0 + tf * u;
+
+    if( dist > ar.r + BOOL_VTOL )
+        return;
+
+    if( abs( dist - ar.r ) <= BOOL_VTOL )
+    {
+        addCut( ln, ar, foot, verts );
+        return;
+    }
+
+    double h = sqrt( ar.r * ar.r - dist * dist );
+    addCut( ln, ar, foot - h * u, verts );
+    addCut( ln, ar, foot + h * u, verts );
+    return;
+}
+
+
+static void intersectArcs( BOOL_EDGE& a, BOOL_EDGE& b, BOOL_VERTICES& verts )
+{
+    MCAD_POINT dv = b.c - a.c;
+    double d = sqrt( dot2( dv, dv ) );
+
+    // arcs on the same circle
+    if( d <= BOOL_VTOL && abs( a.r - b.r ) <= BOOL_VTOL )
+    {
+        addOverlap( a, b );
+        return;
+    }
+
+    if( d <= BOOL_VTOL || d > a.r + b.r + BOOL_VTOL || d < abs( a.r - b.r ) - BOOL_VTOL )
+        return;
+
+    double x = ( a.r * a.r - b.r * b.r + d * d ) / ( 2.0 * d );
+    double h2 = a.r * a.r - x * x;
+    MCAD_POINT ux( dv.x / d, dv.y / d, 0.0 );
+    MCAD_POINT uy( -ux.y, ux.x, 0.0 );
+    MCAD_POINT pm = a.c + x * ux;
+
+    // tangent circles
+    if( h2 <= 0.0 || abs( d - a.r - b.r ) <= BOOL_VTOL
+        || abs( d - abs( a.r - b.r ) ) <= BOOL_VTOL )
+    {
+        addCut( a, b, pm, verts );
+        return;
+    }
+
+    double h = sqrt( h2 );
+    addCut( a, b, pm - h * uy, verts );
+    addCut( a, b, pm + h * uy, verts );
+    return;
+}
+
+
+static void intersectEdges( BOOL_EDGE& a, BOOL_EDGE& b, BOOL_VERTICES& verts )
+{
+    if( a.arc && b.arc )
+        intersectArcs( a, b, verts );
+    else if( a.arc )
+        intersectLineArc( b, a, verts );
+    else if( b.arc )
+        intersectLineArc( a, b, verts );
+    else
+        intersectLines( a, b, verts );
+
+    return;
+}
+
+
+static bool lessBB0x( const BOOL_EDGE* a, const BOOL_EDGE* b )
+{
+    return a->bb0.x < b->bb0.x;
+}
+
+
+// oriented tangent at the start or end of a piece
+static MCAD_POINT pieceTangent( const BOOL_EDGE& e, const BOOL_PIECE& p, bool aEnd )
+{
+    MCAD_POINT d = edgeTangent( e, ( aEnd != p.rev ) ? p.t1 : p.t0 );
+
+    if( p.rev )
+    {
+        d.x = -d.x;
+        d.y = -d.y;
+    }
+
+    return d;
+}
+
+
+// contribution of an oriented piece to the integral of x dy around a loop
+static double pieceArea( const BOOL_EDGE& e, const BOOL_PIECE& p, const vector<MCAD_POINT>& pts )
+{
+    if( e.arc )
+    {
+        double a0 = e.a0 + p.t0 * e.sw;
+        double a1 = e.a0 + p.t1 * e.sw;
+
+        if( p.rev )
+            swap( a0, a1 );
+
+        return e.c.x * e.r * ( sin( a1 ) - sin( a0 ) )
+            + 0.5 * e.r * e.r * ( ( a1 - a0 ) + 0.5 * ( sin( 2.0 * a1 ) - sin( 2.0 * a0 ) ) );
+    }
+
+    const MCAD_POINT& p0 = pts[p.rev ? p.vb : p.va];
+    const MCAD_POINT& p1 = pts[p.rev ? p.va : p.vb];
+    return 0.5 * ( p0.x + p1.x ) * ( p1.y - p0.y );
+}
+
+
+MCAD_BOOLEAN::MCAD_BOOLEAN()
+{
+    return;
+}
+
+
+MCAD_BOOLEAN::~MCAD_BOOLEAN()
+{
+    return;
+}
+
+
+void MCAD_BOOLEAN::Clear( void )
+{
+    mOutlines.clear();
+    mOutlineSub.clear();
+    mCircles.clear();
+    mCircleSub.clear();
+    return;
+}
+
+
+const std::list< std::string >* MCAD_BOOLEAN::GetErrors( void )
+{
+    return &errors;
+}
+
+
+void MCAD_BOOLEAN::ClearErrors( void )
+{
+    errors.clear();
+    return;
+}
+
+
+bool MCAD_BOOLEAN::AddOperand( MCAD_OUTLINE* aOutline, bool aSubtract, bool& error )
+{
+    error = false;
+
+    if( NULL == aOutline )
+    {
+        ostringstream msg;
+        GEOM_ERR( msg );
+        msg << "[BUG] NULL pointer";
+        ERRMSG << msg.str() << "\n";
+        errors.push_back( msg.str() );
+        error = true;
+        return false;
+    }
+
+    if( !aOutline->IsClosed() )
+    {
+        ostringstream msg;
+        GEOM_ERR( msg );
+        msg << "[BUG] outline is not closed";
+        ERRMSG << msg.str() << "\n";
+        errors.push_back( msg.str() );
+        error = true;
+        return false;
+    }
+
+    mOutlines.push_back( aOutline );
+    mOutlineSub.push_back( aSubtract );
+    return true;
+}
+
+
+bool MCAD_BOOLEAN::AddOperand( MCAD_SEGMENT* aCircle, bool aSubtract, bool& error )
+{
+    error = false;
+
+    if( NULL == aCircle )
+    {
+        ostringstream msg;
+        GEOM_ERR( msg );
+        msg << "[BUG] NULL pointer";
+        ERRMSG << msg.str() << "\n";
+        errors.push_back( msg.str() );
+        error = true;
+        return false;
+    }
+
+    if( MCAD_SEGTYPE_CIRCLE != aCircle->GetSegType() )
+    {
+        ostringstream msg;
+        GEOM_ERR( msg );
+        msg << "[BUG] segment is not a circle";
+        ERRMSG << msg.str() << "\n";
+        errors.push_back( msg.str() );
+        error = true;
+        return false;
+    }
+
+    mCircles.push_back( aCircle );
+    mCircleSub.push_back( aSubtract );
+    return true;
+}
+
+
+bool MCAD_BOOLEAN::Execute( std::list<MCAD_OUTLINE*>& aResult, bool& error,
+                            MCAD_OUTLINE_TYPE aType )
+{
+    error = false;
+
+    // gather the operands; the cutouts and holes of an added outline
+    // are subtracted
+    vector<BOOL_OPERAND> ops;
+    BOOL_OPERAND op;
+
+    for( size_t i = 0; i < mOutlines.size(); ++i )
+    {
+        op.outline = mOutlines[i];
+        op.radius = 0.0;
+        op.sub = mOutlineSub[i];
+        ops.push_back( op );
+
+        if( op.sub )
+            continue;
+
+        const list<MCAD_OUTLINE*>* cl = mOutlines[i]->GetCutouts();
+        list<MCAD_OUTLINE*>::const_iterator sC = cl->begin();
+        list<MCAD_OUTLINE*>::const_iterator eC = cl->end();
+
+        while( sC != eC )
+        {
+            op.outline = *sC;
+            op.sub = true;
+            ops.push_back( op );
+            ++sC;
+        }
+
+        list<MCAD_SEGMENT*>* hl = mOutlines[i]->GetDrillHoles();
+        list<MCAD_SEGMENT*>::iterator sH = hl->begin();
+        list<MCAD_SEGMENT*>::iterator eH = hl->end();
+
+        while( sH != eH )
+        {
+            op.outline = NULL;
+            op.center = (*sH)->GetCenter();
+            op.radius = (*sH)->GetRadius();
+            op.sub = true;
+            ops.push_back( op );
+            ++sH;
+        }
+    }
+
+    for( size_t i = 0; i < mCircles.size(); ++i )
+    {
+        op.outline = NULL;
+        op.center = mCircles[i]->GetCenter();
+        op.radius = mCircles[i]->GetRadius();
+        op.sub = mCircleSub[i];
+        ops.push_back( op );
+    }
+
+    // collect the edges and index the operands by their extent
+    vector<BOOL_EDGE> edges;
+    BOOL_VERTICES verts;
+    MCAD_BOXTREE opTree;
+    MCAD_POINT mbb0;
+    MCAD_POINT mbb1;
+
+    for( size_t i = 0; i < ops.size(); ++i )
+    {
+        list<MCAD_SEGMENT*> tmp;
+        list<MCAD_SEGMENT*>* sl = &tmp;
+        MCAD_SEGMENT circ;
+
+        if( NULL == ops[i].outline )
+        {
+            if( !circ.SetParams( ops[i].center, ops[i].center + MCAD_POINT( ops[i].radius, 0.0, 0.0 ),
+                ops[i].center + MCAD_POINT( ops[i].radius, 0.0, 0.0 ), false ) )
+            {
+                ostringstream msg;
+                GEOM_ERR( msg );
+                msg << "[BUG] invalid circle";
+                ERRMSG << msg.str() << "\n";
+                errors.push_back( msg.str() );
+                error = true;
+                return false;
+            }
+
+            tmp.push_back( &circ );
+        }
+        else
+        {
+            sl = ops[i].outline->GetSegments();
+        }
+
+        list<MCAD_SEGMENT*>::iterator sS = sl->begin();
+        list<MCAD_SEGMENT*>::iterator eS = sl->end();
+        MCAD_POINT obb0;
+        MCAD_POINT obb1;
+        bool first = true;
+
+        while( sS != eS )
+        {
+            BOOL_EDGE e;
+            MCAD_SEGMENT* sp = *sS;
+            e.op = (int)i;
+            e.full = false;
+            e.r = 0.0;
+            e.a0 = 0.0;
+            e.sw = 0.0;
+
+            switch( sp->GetSegType() )
+            {
+                case MCAD_SEGTYPE_LINE:
+                    e.arc = false;
+                    e.p0 = sp->GetMStart();
+                    e.p1 = sp->GetMEnd();
+                    break;
+
+                case MCAD_SEGTYPE_ARC:
+                    e.arc = true;
+                    e.c = sp->GetCenter();
+                    e.r = sp->GetRadius();
+                    e.a0 = sp->GetMSAngle();
+                    e.sw = sp->GetMEAngle() - sp->GetMSAngle();
+                    e.p0 = sp->GetMStart();
+                    e.p1 = sp->GetMEnd();
+                    break;
+
+                case MCAD_SEGTYPE_CIRCLE:
+                    e.arc = true;
+                    e.full = true;
+                    e.c = sp->GetCenter();
+                    e.r = sp->GetRadius();
+                    e.a0 = 0.0;
+                    e.sw = 2.0 * M_PI;
+                    e.p0 = e.c;
+                    e.p0.x += e.r;
+                    e.p1 = e.p0;
+                    break;
+
+                default:
+                    do
+                    {
+                        ostringstream msg;
+                        GEOM_ERR( msg );
+                        msg << "[BUG] invalid segment type";
+                        ERRMSG << msg.str() << "\n";
+                        errors.push_back( msg.str() );
+                        error = true;
+                        return false;
+                    } while( 0 );
+
+                    break;
+            }
+
+            e.p0.z = 0.0;
+            e.p1.z = 0.0;
+            e.c.z = 0.0;
+            sp->GetBoundingBox( e.bb0, e.bb1 );
+            e.v0 = verts.Add( e.p0 );
+            e.v1 = e.full ? e.v0 : verts.Add( e.p1 );
+            edges.push_back( e );
+
+            if( first )
+            {
+                obb0 = e.bb0;
+                obb1 = e.bb1;
+                first = false;
+            }
+            else
+            {
+                obb0.x = min( obb0.x, e.bb0.x );
+                obb0.y = min( obb0.y, e.bb0.y );
+                obb1.x = max( obb1.x, e.bb1.x );
+                obb1.y = max( obb1.y, e.bb1.y );
+            }
+
+            ++sS;
+        }
+
+        if( first )
+            continue;
+
+        opTree.Insert( obb0, obb1, i );
+
+        if( 0 == i )
+        {
+            mbb0 = obb0;
+            mbb1 = obb1;
+        }
+        else
+        {
+            mbb0.x = min( mbb0.x, obb0.x );
+            mbb0.y = min( mbb0.y, obb0.y );
+            mbb1.x = max( mbb1.x, obb1.x );
+            mbb1.y = max( mbb1.y, obb1.y );
+        }
+    }
+
+    if( edges.empty() )
+        return true;
+
+    double scale = max( mbb1.x - mbb0.x, mbb1.y - mbb0.y );
+    // distance at which the region is sampled to each side of a piece
+    double offTol = 1e-6 * ( 1.0 + scale );
+
+    // sweep across the edges in X to find the pairs of edges from
+    // different operands whose bounding boxes overlap
+    do
+    {
+        vector<BOOL_EDGE*> order( edges.size() );
+
+        for( size_t i = 0; i < edges.size(); ++i )
+            order[i] = &edges[i];
+
+        sort( order.begin(), order.end(), lessBB0x );
+
+        vector<BOOL_EDGE*> active;
+
+        for( size_t i = 0; i < order.size(); ++i )
+        {
+            BOOL_EDGE* ep = order[i];
+            size_t j = 0;
+
+            while( j < active.size() )
+            {
+                BOOL_EDGE* ap = active[j];
+
+                if( ap->bb1.x < ep->bb0.x - BOOL_VTOL )
+                {
+                    active[j] = active.back();
+                    active.pop_back();
+                    continue;
+                }
+
+                if( ap->op != ep->op && ap->bb0.y <= ep->bb1.y + BOOL_VTOL
+                    && ap->bb1.y >= ep->bb0.y - BOOL_VTOL )
+                    intersectEdges( *ap, *ep, verts );
+
+                ++j;
+            }
+
+            active.push_back( ep );
+        }
+    } while( 0 );
+
+    // split the edges at their intersections
+    vector<BOOL_PIECE> pieces;
+
+    for( size_t i = 0; i < edges.size(); ++i )
+    {
+        BOOL_EDGE& e = edges[i];
+        vector< pair<double, int> >& cl = e.cuts;
+        sort( cl.begin(), cl.end() );
+
+        vector< pair<double, int> > seq;
+
+        if( !e.full )
+            seq.push_back( pair<double, int>( 0.0, e.v0 ) );
+
+        for( size_t j = 0; j < cl.size(); ++j )
+        {
+            if( !e.full && ( cl[j].second == e.v0 || cl[j].second == e.v1 ) )
+                continue;
+
+            if( !seq.empty() && seq.back().second == cl[j].second )
+                continue;
+
+            seq.push_back( cl[j] );
+        }
+
+        if( e.full )
+        {
+            while( seq.size() > 1 && seq.back().second == seq.front().second )
+                seq.pop_back();
+
+            if( seq.empty() )
+                seq.push_back( pair<double, int>( 0.0, e.v0 ) );
+
+            // the circle closes on the first cut
+            seq.push_back( pair<double, int>( seq.front().first + 1.0, seq.front().second ) );
+        }
+        else
+        {
+            seq.push_back( pair<double, int>( 1.0, e.v1 ) );
+        }
+
+        for( size_t j = 0; j + 1 < seq.size(); ++j )
+        {
+            // a single cut on a circle leaves a complete circle
+            if( seq[j].second == seq[j + 1].second && !( e.full && 2 == seq.size() ) )
+                continue;
+
+            BOOL_PIECE p;
+            p.edge = (int)i;
+            p.t0 = seq[j].first;
+            p.t1 = seq[j + 1].first;
+            p.va = seq[j].second;
+            p.vb = seq[j + 1].second;
+            p.rev = false;
+            p.used = false;
+            pieces.push_back( p );
+        }
+    }
+
+    // keep the pieces which separate the inside of the result from the
+    // outside and orient them with the inside to the left
+    vector<BOOL_PIECE> kept;
+    map< pair<int, int>, vector<size_t> > keyMap;
+    vector<size_t> cand;
+
+    for( size_t i = 0; i < pieces.size(); ++i )
+    {
+        BOOL_PIECE& p = pieces[i];
+        const BOOL_EDGE& e = edges[p.edge];
+        double tm = 0.5 * ( p.t0 + p.t1 );
+        MCAD_POINT m = edgePoint( e, tm );
+        MCAD_POINT tv = edgeTangent( e, tm );
+        double eps = min( offTol, 0.25 * ( p.t1 - p.t0 ) * edgeLength( e ) );
+
+        if( e.arc )
+            eps = min( eps, 0.25 * e.r );
+
+        bool inside[2];
+
+        for( int k = 0; k < 2; ++k )
+        {
+            double s = ( 0 == k ) ? eps : -eps;
+            MCAD_POINT q( m.x - s * tv.y, m.y + s * tv.x, 0.0 );
+            bool inAdd = false;
+            bool inSub = false;
+
+            cand.clear();
+            opTree.Query( q, q, cand );
+
+            for( size_t j = 0; j < cand.size() && !inSub; ++j )
+            {
+                const BOOL_OPERAND& o = ops[cand[j]];
+
+                if( !o.sub && inAdd )
+                    continue;
+
+                bool in;
+
+                if( NULL == o.outline )
+                {
+                    double dx = q.x - o.center.x;
+                    double dy = q.y - o.center.y;
+                    in = dx * dx + dy * dy < o.radius * o.radius;
+                }
+                else
+                {
+                    bool err = false;
+                    in = o.outline->IsInside( q, err );
+                }
+
+                if( in )
+                {
+                    if( o.sub )
+                        inSub = true;
+                    else
+                        inAdd = true;
+                }
+            }
+
+            inside[k] = inAdd && !inSub;
+        }
+
+        if( inside[0] == inside[1] )
+            continue;
+
+        p.rev = !inside[0];
+
+        // merge coincident pieces from different operands
+        pair<int, int> key = p.rev ? pair<int, int>( p.vb, p.va ) : pair<int, int>( p.va, p.vb );
+        vector<size_t>& kl = keyMap[key];
+        bool dup = false;
+
+        for( size_t j = 0; j < kl.size() && !dup; ++j )
+        {
+            const BOOL_PIECE& o = kept[kl[j]];
+            const BOOL_EDGE& oe = edges[o.edge];
+            MCAD_POINT om = edgePoint( oe, 0.5 * ( o.t0 + o.t1 ) );
+
+            if( oe.arc == e.arc && PointMatches( om, m, offTol ) )
+                dup = true;
+        }
+
+        if( dup )
+            continue;
+
+        kl.push_back( kept.size() );
+        kept.push_back( p );
+    }
+
+    // join the pieces into loops
+    const vector<MCAD_POINT>& pts = verts.pts;
+    vector< vector<size_t> > outgoing( pts.size() );
+    vector< vector<size_t> > loops;
+    vector<double> areas;
+
+    for( size_t i = 0; i < kept.size(); ++i )
+    {
+        if( kept[i].va != kept[i].vb )
+            outgoing[kept[i].rev ? kept[i].vb : kept[i].va].push_back( i );
+    }
+
+    for( size_t i = 0; i < kept.size(); ++i )
+    {
+        if( kept[i].used )
+            continue;
+
+        vector<size_t> loop;
+        size_t cur = i;
+        int vStart = kept[i].rev ? kept[i].vb : kept[i].va;
+        kept[i].used = true;
+        loop.push_back( i );
+
+        // a complete circle is a loop by itself
+        while( kept[cur].va != kept[cur].vb )
+        {
+            int v = kept[cur].rev ? kept[cur].va : kept[cur].vb;
+
+            if( v == vStart )
+                break;
+
+            MCAD_POINT tin = pieceTangent( edges[kept[cur].edge], kept[cur], true );
+            vector<size_t>& ol = outgoing[v];
+            size_t best = kept.size();
+            double bestAng = 0.0;
+
+            for( size_t j = 0; j < ol.size(); ++j )
+            {
+                if( kept[ol[j]].used )
+                    continue;
+
+                MCAD_POINT tout = pieceTangent( edges[kept[ol[j]].edge], kept[ol[j]], false );
+                double ang = atan2( cross2( tin, tout ), dot2( tin, tout ) );
+
+                if( best == kept.size() || ang < bestAng )
+                {
+                    best = ol[j];
+                    bestAng = ang;
+                }
+            }
+
+            if( best == kept.size() )
+            {
+                ostringstream msg;
+                GEOM_ERR( msg );
+                msg << "[BUG] open boundary at (" << pts[v].x << ", " << pts[v].y << ")";
+                ERRMSG << msg.str() << "\n";
+                errors.push_back( msg.str() );
+                error = true;
+                return false;
+            }
+
+            kept[best].used = true;
+            loop.push_back( best );
+            cur = best;
+        }
+
+        double area = 0.0;
+
+        for( size_t j = 0; j < loop.size(); ++j )
+            area += pieceArea( edges[kept[loop[j]].edge], kept[loop[j]], pts );
+
+        // discard slivers produced by nearly coincident edges
+        if( abs( area ) <= BOOL_VTOL * ( 1.0 + scale ) * offTol )
+            continue;
+
+        loops.push_back( loop );
+        areas.push_back( area );
+    }
+
+    // create the bodies from the counterclockwise loops and add the
+    // clockwise loops to the smallest body which encloses them
+    list<MCAD_OUTLINE*> bodies;
+    vector<MCAD_OUTLINE*> bodyList;
+    vector<double> bodyArea;
+    MCAD_BOXTREE bodyTree;
+
+#define BOOL_FAIL( text ) do { \
+    ostringstream msg; \
+    GEOM_ERR( msg ); \
+    msg << text; \
+    ERRMSG << msg.str() << "\n"; \
+    errors.push_back( msg.str() ); \
+    error = true; \
+    while( !bodies.empty() ) { delete bodies.back(); bodies.pop_back(); } \
+    return false; } while( 0 )
+
+    // the segments of the result are allocated together
+    MCAD_SEGPOOL segPool;
+    MCAD_SEGPOOL_SCOPE poolScope( &segPool );
+
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        for( size_t i = 0; i < loops.size(); ++i )
+        {
+            bool isHole = areas[i] < 0.0;
+
+            if( isHole != ( 1 == pass ) )
+                continue;
+
+            vector<MCAD_SEGMENT*> segs;
+
+            for( size_t j = 0; j < loops[i].size(); ++j )
+            {
+                const BOOL_PIECE& p = kept[loops[i][j]];
+                const BOOL_EDGE& e = edges[p.edge];
+                const MCAD_POINT& ps = pts[p.rev ? p.vb : p.va];
+                const MCAD_POINT& pe = pts[p.rev ? p.va : p.vb];
+                MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+                bool ok;
+
+                if( !e.arc )
+                    ok = sp->SetParams( ps, pe );
+                else if( p.va == p.vb )
+                    ok = sp->SetParams( e.c, ps, ps, false );
+                else
+                    ok = sp->SetParams( e.c, ps, pe, ( e.sw < 0.0 ) != p.rev );
+
+                segs.push_back( sp );
+
+                if( !ok )
+                {
+                    for( size_t k = 0; k < segs.size(); ++k )
+                        delete segs[k];
+
+                    BOOL_FAIL( "[BUG] could not create a segment of the result" );
+                }
+            }
+
+            MCAD_OUTLINE* body = NULL;
+
+            if( isHole )
+            {
+                // find the smallest body enclosing the hole
+                MCAD_POINT q;
+                segs.front()->GetMidpoint( q );
+                cand.clear();
+                bodyTree.Query( q, q, cand );
+                double ba = 0.0;
+
+                for( size_t j = 0; j < cand.size(); ++j )
+                {
+                    bool err = false;
+
+                    if( ( NULL == body || bodyArea[cand[j]] < ba )
+                        && bodyList[cand[j]]->IsInside( q, err ) )
+                    {
+                        body = bodyList[cand[j]];
+                        ba = bodyArea[cand[j]];
+                    }
+                }
+
+                if( NULL == body )
+                {
+                    for( size_t k = 0; k < segs.size(); ++k )
+                        delete segs[k];
+
+                    BOOL_FAIL( "[BUG] cutout is not within any body" );
+                }
+
+                bool err = false;
+
+                if( 1 == segs.size() && MCAD_SEGTYPE_CIRCLE == segs[0]->GetSegType() )
+                {
+                    if( !body->AddCutout( segs[0], false, err ) )
+                    {
+                        delete segs[0];
+                        BOOL_FAIL( "[BUG] could not add drill hole to body" );
+                    }
+
+                    continue;
+                }
+
+                MCAD_OUTLINE* hole = new MCAD_OUTLINE;
+
+                for( size_t j = 0; j < segs.size(); ++j )
+                {
+                    if( !hole->AddSegment( segs[j], err ) )
+                    {
+                        for( size_t k = j; k < segs.size(); ++k )
+                            delete segs[k];
+
+                        delete hole;
+                        BOOL_FAIL( "[BUG] could not create cutout" );
+                    }
+                }
+
+                if( !hole->IsClosed() || !body->AddCutout( hole, false, err ) )
+                {
+                    delete hole;
+                    BOOL_FAIL( "[BUG] could not add cutout to body" );
+                }
+
+                continue;
+            }
+
+            if( MCAD_OT_PCB == aType )
+                body = new IGES_GEOM_PCB;
+            else
+                body = new MCAD_OUTLINE;
+
+            bodies.push_back( body );
+
+            for( size_t j = 0; j < segs.size(); ++j )
+            {
+                bool err = false;
+
+                if( !body->AddSegment( segs[j], err ) )
+                {
+                    for( size_t k = j; k < segs.size(); ++k )
+                        delete segs[k];
+
+                    BOOL_FAIL( "[BUG] could not create outline" );
+                }
+            }
+
+            if( !body->IsClosed() )
+                BOOL_FAIL( "[BUG] outline is not closed" );
+
+            // index the body by its extent
+            MCAD_POINT bb0;
+            MCAD_POINT bb1;
+            segs[0]->GetBoundingBox( bb0, bb1 );
+
+            for( size_t j = 1; j < segs.size(); ++j )
+            {
+                MCAD_POINT p0;
+                MCAD_POINT p1;
+                segs[j]->GetBoundingBox( p0, p1 );
+                bb0.x = min( bb0.x, p0.x );
+                bb0.y = min( bb0.y, p0.y );
+                bb1.x = max( bb1.x, p1.x );
+                bb1.y = max( bb1.y, p1.y );
+            }
+
+            bodyTree.Insert( bb0, bb1, bodyList.size() );
+            bodyList.push_back( body );
+            bodyArea.push_back( areas[i] );
+        }
+    }
+
+    // pieces of a single edge and collinear edges of different operands
+    // leave redundant vertices on the boundary; merge the pieces
+    list<MCAD_OUTLINE*>::iterator sB = bodies.begin();
+    list<MCAD_OUTLINE*>::iterator eB = bodies.end();
+
+    while( sB != eB )
+    {
+        bool err = false;
+        (*sB)->Simplify( BOOL_VTOL, err );
+
+        if( err )
+            BOOL_FAIL( "[BUG] could not simplify outline" );
+
+        ++sB;
+    }
+
+#undef BOOL_FAIL
+
+    aResult.splice( aResult.end(), bodies );
+    return true;
+}
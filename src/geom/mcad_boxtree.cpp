@@ -0,0 +1,371 @@
+/*
+ * file: mcad_boxtree.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: dynamic tree of axis aligned bounding boxes used
+ * to find the outlines and holes which may overlap a region.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <algorithm>
+#include <geom/mcad_boxtree.h>
+
+using namespace std;
+
+
+// half the perimeter of the union of 2 boxes
+static double unionCost( const MCAD_POINT& a0, const MCAD_POINT& a1,
+                         const MCAD_POINT& b0, const MCAD_POINT& b1 )
+{
+    return ( max( a1.x, b1.x ) - min( a0.x, b0.x ) )
+        + ( max( a1.y, b1.y ) - min( a0.y, b0.y ) );
+}
+
+
+MCAD_BOXTREE::MCAD_BOXTREE()
+{
+    mRoot = -1;
+    mFree = -1;
+    mLeaves = 0;
+    return;
+}
+
+
+MCAD_BOXTREE::~MCAD_BOXTREE()
+{
+    return;
+}
+
+
+void MCAD_BOXTREE::Clear( void )
+{
+    mNodes.clear();
+    mRoot = -1;
+    mFree = -1;
+    mLeaves = 0;
+    return;
+}
+
+
+size_t MCAD_BOXTREE::Size( void ) const
+{
+    return mLeaves;
+}
+
+
+int MCAD_BOXTREE::allocNode( void )
+{
+    int id;
+
+    if( mFree < 0 )
+    {
+        mNodes.push_back( NODE() );
+        id = (int)mNodes.size() - 1;
+    }
+    else
+    {
+        id = mFree;
+        mFree = mNodes[id].parent;
+    }
+
+    NODE& n = mNodes[id];
+    n.parent = -1;
+    n.child1 = -1;
+    n.child2 = -1;
+    n.height = 0;
+    n.key = 0;
+    return id;
+}
+
+
+void MCAD_BOXTREE::freeNode( int aNode )
+{
+    mNodes[aNode].parent = mFree;
+    mNodes[aNode].height = -1;
+    mFree = aNode;
+    return;
+}
+
+
+int MCAD_BOXTREE::Insert( const MCAD_POINT& bb0, const MCAD_POINT& bb1, size_t aKey )
+{
+    int leaf = allocNode();
+    mNodes[leaf].bb0 = bb0;
+    mNodes[leaf].bb1 = bb1;
+    mNodes[leaf].key = aKey;
+    insertLeaf( leaf );
+    ++mLeaves;
+    return leaf;
+}
+
+
+bool MCAD_BOXTREE::Remove( int aLeaf )
+{
+    if( aLeaf < 0 || aLeaf >= (int)mNodes.size() || 0 != mNodes[aLeaf].height )
+        return false;
+
+    removeLeaf( aLeaf );
+    freeNode( aLeaf );
+    --mLeaves;
+    return true;
+}
+
+
+bool MCAD_BOXTREE::Update( int aLeaf, const MCAD_POINT& bb0, const MCAD_POINT& bb1 )
+{
+    if( aLeaf < 0 || aLeaf >= (int)mNodes.size() || 0 != mNodes[aLeaf].height )
+        return false;
+
+    removeLeaf( aLeaf );
+    mNodes[aLeaf].bb0 = bb0;
+    mNodes[aLeaf].bb1 = bb1;
+    insertLeaf( aLeaf );
+    return true;
+}
+
+
+void MCAD_BOXTREE::Query( const MCAD_POINT& bb0, const MCAD_POINT& bb1,
+                          std::vector<size_t>& aKeyList ) const
+{
+    if( mRoot < 0 )
+        return;
+
+    vector<int> stack;
+    stack.push_back( mRoot );
+
+    while( !stack.empty() )
+    {
+        const NODE& n = mNodes[stack.back()];
+        stack.pop_back();
+
+        if( n.bb0.x > bb1.x || n.bb1.x < bb0.x || n.bb0.y > bb1.y || n.bb1.y < bb0.y )
+            continue;
+
+        if( n.child1 < 0 )
+        {
+            aKeyList.push_back( n.key );
+            continue;
+        }
+
+        stack.push_back( n.child1 );
+        stack.push_back( n.child2 );
+    }
+
+    return;
+}
+
+
+void MCAD_BOXTREE::refit( int aNode )
+{
+    NODE& n = mNodes[aNode];
+    const NODE& c1 = mNodes[n.child1];
+    const NODE& c2 = mNodes[n.child2];
+
+    n.bb0.x = min( c1.bb0.x, c2.bb0.x );
+    n.bb0.y = min( c1.bb0.y, c2.bb0.y );
+    n.bb1.x = max( c1.bb1.x, c2.bb1.x );
+    n.bb1.y = max( c1.bb1.y, c2.bb1.y );
+    n.height = 1 + max( c1.height, c2.height );
+    return;
+}
+
+
+void MCAD_BOXTREE::insertLeaf( int aLeaf )
+{
+    if( mRoot < 0 )
+    {
+        mRoot = aLeaf;
+        mNodes[aLeaf].parent = -1;
+        return;
+    }
+
+    // descend to the sibling which least increases the perimeter
+    MCAD_POINT lb0 = mNodes[aLeaf].bb0;
+    MCAD_POINT lb1 = mNodes[aLeaf].bb1;
+    int idx = mRoot;
+
+    while( mNodes[idx].child1 >= 0 )
+    {
+        const NODE& n = mNodes[idx];
+        double area = ( n.bb1.x - n.bb0.x ) + ( n.bb1.y - n.bb0.y );
+        double combined = unionCost( n.bb0, n.bb1, lb0, lb1 );
+
+        // cost of making a new parent for this node and the leaf
+        double cost = 2.0 * combined;
+        // minimum cost of pushing the leaf further down
+        double inherit = 2.0 * ( combined - area );
+
+        const NODE& c1 = mNodes[n.child1];
+        const NODE& c2 = mNodes[n.child2];
+        double cost1 = unionCost( c1.bb0, c1.bb1, lb0, lb1 ) + inherit;
+        double cost2 = unionCost( c2.bb0, c2.bb1, lb0, lb1 ) + inherit;
+
+        if( c1.child1 >= 0 )
+            cost1 -= ( c1.bb1.x - c1.bb0.x ) + ( c1.bb1.y - c1.bb0.y );
+
+        if( c2.child1 >= 0 )
+            cost2 -= ( c2.bb1.x - c2.bb0.x ) + ( c2.bb1.y - c2.bb0.y );
+
+        if( cost < cost1 && cost < cost2 )
+            break;
+
+        idx = ( cost1 < cost2 ) ? n.child1 : n.child2;
+    }
+
+    int sibling = idx;
+    int oldParent = mNodes[sibling].parent;
+    int newParent = allocNode();
+
+    mNodes[newParent].parent = oldParent;
+    mNodes[newParent].child1 = sibling;
+    mNodes[newParent].child2 = aLeaf;
+    mNodes[sibling].parent = newParent;
+    mNodes[aLeaf].parent = newParent;
+    refit( newParent );
+
+    if( oldParent < 0 )
+    {
+        mRoot = newParent;
+    }
+    else
+    {
+        if( mNodes[oldParent].child1 == sibling )
+            mNodes[oldParent].child1 = newParent;
+        else
+            mNodes[oldParent].child2 = newParent;
+    }
+
+    // rebalance and refit the ancestors
+    idx = mNodes[aLeaf].parent;
+
+    while( idx >= 0 )
+    {
+        idx = balance( idx );
+        refit( idx );
+        idx = mNodes[idx].parent;
+    }
+
+    return;
+}
+
+
+void MCAD_BOXTREE::removeLeaf( int aLeaf )
+{
+    if( aLeaf == mRoot )
+    {
+        mRoot = -1;
+        return;
+    }
+
+    int parent = mNodes[aLeaf].parent;
+    int grandParent = mNodes[parent].parent;
+    int sibling = ( mNodes[parent].child1 == aLeaf ) ?
+        mNodes[parent].child2 : mNodes[parent].child1;
+
+    freeNode( parent );
+
+    if( grandParent < 0 )
+    {
+        mRoot = sibling;
+        mNodes[sibling].parent = -1;
+        return;
+    }
+
+    if( mNodes[grandParent].child1 == parent )
+        mNodes[grandParent].child1 = sibling;
+    else
+        mNodes[grandParent].child2 = sibling;
+
+    mNodes[sibling].parent = grandParent;
+
+    int idx = grandParent;
+
+    while( idx >= 0 )
+    {
+        idx = balance( idx );
+        refit( idx );
+        idx = mNodes[idx].parent;
+    }
+
+    return;
+}
+
+
+// if the subtrees of node A differ in height by more than 1 then
+// rotate the taller child C up to the position of A; returns the
+// node which now occupies the position of A
+int MCAD_BOXTREE::balance( int aNode )
+{
+    int iA = aNode;
+
+    if( mNodes[iA].child1 < 0 || mNodes[iA].height < 2 )
+        return iA;
+
+    int iB = mNodes[iA].child1;
+    int iC = mNodes[iA].child2;
+    int diff = mNodes[iC].height - mNodes[iB].height;
+
+    if( diff >= -1 && diff <= 1 )
+        return iA;
+
+    // make 'iC' the taller child and 'iB' the other
+    bool leftTall = diff < 0;
+
+    if( leftTall )
+        swap( iB, iC );
+
+    int iF = mNodes[iC].child1;
+    int iG = mNodes[iC].child2;
+
+    // C takes the place of A
+    mNodes[iC].child1 = iA;
+    mNodes[iC].parent = mNodes[iA].parent;
+    mNodes[iA].parent = iC;
+
+    if( mNodes[iC].parent < 0 )
+    {
+        mRoot = iC;
+    }
+    else
+    {
+        if( mNodes[mNodes[iC].parent].child1 == iA )
+            mNodes[mNodes[iC].parent].child1 = iC;
+        else
+            mNodes[mNodes[iC].parent].child2 = iC;
+    }
+
+    // the taller grandchild stays with C and the other goes to A
+    if( mNodes[iF].height < mNodes[iG].height )
+        swap( iF, iG );
+
+    mNodes[iC].child2 = iF;
+
+    if( leftTall )
+        mNodes[iA].child1 = iG;
+    else
+        mNodes[iA].child2 = iG;
+
+    mNodes[iG].parent = iA;
+    refit( iA );
+    refit( iC );
+
+    return iC;
+}
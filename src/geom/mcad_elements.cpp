@@ -26,6 +26,8 @@
 
 
 #include <cstring>
+#include <limits>
+#include <algorithm>
 #include <geom/mcad_elements.h>
 
 MCAD_POINT::MCAD_POINT()
@@ -337,3 +339,135 @@ MCAD_POINT operator*( const MCAD_TRANSFORM& m, const MCAD_POINT& v  )
 
     return p;
 }
+
+
+MCAD_BOX::MCAD_BOX()
+{
+    Clear();
+    return;
+}
+
+
+void MCAD_BOX::Clear( void )
+{
+    double big = std::numeric_limits<double>::max();
+    lo = MCAD_POINT( big, big, big );
+    hi = MCAD_POINT( -big, -big, -big );
+    return;
+}
+
+
+bool MCAD_BOX::IsEmpty( void ) const
+{
+    return lo.x > hi.x || lo.y > hi.y || lo.z > hi.z;
+}
+
+
+void MCAD_BOX::Add( const MCAD_POINT& p )
+{
+    lo.x = std::min( lo.x, p.x );
+    lo.y = std::min( lo.y, p.y );
+    lo.z = std::min( lo.z, p.z );
+    hi.x = std::max( hi.x, p.x );
+    hi.y = std::max( hi.y, p.y );
+    hi.z = std::max( hi.z, p.z );
+    return;
+}
+
+
+void MCAD_BOX::Add( const MCAD_BOX& b )
+{
+    if( b.IsEmpty() )
+        return;
+
+    Add( b.lo );
+    Add( b.hi );
+    return;
+}
+
+
+bool MCAD_BOX::Intersects( const MCAD_BOX& b ) const
+{
+    if( lo.x > b.hi.x || hi.x < b.lo.x
+        || lo.y > b.hi.y || hi.y < b.lo.y
+        || lo.z > b.hi.z || hi.z < b.lo.z )
+        return false;
+
+    return true;
+}
+
+
+MCAD_POINT MCAD_BOX::Center( void ) const
+{
+    return MCAD_POINT( 0.5 * ( lo.x + hi.x ), 0.5 * ( lo.y + hi.y ),
+        0.5 * ( lo.z + hi.z ) );
+}
+
+
+double MCAD_BOX::Distance2( const MCAD_POINT& p ) const
+{
+    double d[3];
+    d[0] = std::max( std::max( lo.x - p.x, p.x - hi.x ), 0.0 );
+    d[1] = std::max( std::max( lo.y - p.y, p.y - hi.y ), 0.0 );
+    d[2] = std::max( std::max( lo.z - p.z, p.z - hi.z ), 0.0 );
+
+    return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+}
+
+
+bool MCAD_BOX::RayHit( const MCAD_POINT& aOrigin, const MCAD_POINT& aInvDir, double& aT ) const
+{
+    // slab test; infinite reciprocals are handled by IEEE arithmetic
+    double t0 = 0.0;
+    double t1 = std::numeric_limits<double>::max();
+    const double o[3] = { aOrigin.x, aOrigin.y, aOrigin.z };
+    const double r[3] = { aInvDir.x, aInvDir.y, aInvDir.z };
+    const double l[3] = { lo.x, lo.y, lo.z };
+    const double h[3] = { hi.x, hi.y, hi.z };
+
+    for( int i = 0; i < 3; ++i )
+    {
+        double tn = ( l[i] - o[i] ) * r[i];
+        double tf = ( h[i] - o[i] ) * r[i];
+
+        // a ray parallel to and within a slab yields NaN; treat it as a pass
+        if( tn != tn || tf != tf )
+        {
+            if( o[i] < l[i] || o[i] > h[i] )
+                return false;
+
+            continue;
+        }
+
+        if( tn > tf )
+            std::swap( tn, tf );
+
+        t0 = std::max( t0, tn );
+        t1 = std::min( t1, tf );
+
+        if( t0 > t1 )
+            return false;
+    }
+
+    aT = t0;
+    return true;
+}
+
+
+// TX * BOX (bounds of the transformed box)
+MCAD_BOX operator*( const MCAD_TRANSFORM& m, const MCAD_BOX& b )
+{
+    MCAD_BOX v;
+
+    if( b.IsEmpty() )
+        return v;
+
+    for( int i = 0; i < 8; ++i )
+    {
+        MCAD_POINT p( ( i & 1 ) ? b.hi.x : b.lo.x, ( i & 2 ) ? b.hi.y : b.lo.y,
+            ( i & 4 ) ? b.hi.z : b.lo.z );
+        v.Add( m * p );
+    }
+
+    return v;
+}
@@ -0,0 +1,718 @@
+/*
+ * file: mcad_nurbs.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: self-contained evaluation of B-Spline and rational
+ * B-Spline (NURBS) curves and surfaces
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined( __AVX__ )
+    #include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+    #include <emmintrin.h>
+    #define MCAD_NURBS_SSE2
+#endif
+
+#include <error_macros.h>
+#include <geom/mcad_nurbs.h>
+
+
+using namespace std;
+
+
+// highest derivative supported by the evaluators
+#define NURBS_MAX_DERIV 2
+// work space (in doubles) reserved on the stack by EvalNURBSCurve();
+// sufficient for curves up to order 11
+#define NURBS_STACK_SIZE 256
+
+
+// size of the scratch space (in doubles) required by calcBasis()
+static inline size_t basisScratch( int aOrder )
+{
+    return (size_t)( aOrder * aOrder + 2 * aOrder + 2 * ( NURBS_MAX_DERIV + 1 ) );
+}
+
+
+// The Piegl & Tiller algorithm A2.3 for the non-zero basis functions and
+// their derivatives; aScratch must hold basisScratch( aOrder ) values.
+static void calcBasis( int aOrder, const double* aKnots, int aSpan, double aParam,
+    int aNDerivs, double* aResult, double* aScratch )
+{
+    const int p = aOrder - 1;
+    // ndu[j][r] is stored at ndu[j * aOrder + r]; the upper triangle holds
+    // the basis functions and the lower triangle holds the knot differences
+    double* ndu = aScratch;
+    double* left = ndu + aOrder * aOrder;
+    double* right = left + aOrder;
+    double* a[2];
+    a[0] = right + aOrder;
+    a[1] = a[0] + NURBS_MAX_DERIV + 1;
+
+    ndu[0] = 1.0;
+
+    for( int j = 1; j <= p; ++j )
+    {
+        left[j] = aParam - aKnots[aSpan + 1 - j];
+        right[j] = aKnots[aSpan + j] - aParam;
+        double saved = 0.0;
+
+        for( int r = 0; r < j; ++r )
+        {
+            ndu[j * aOrder + r] = right[r + 1] + left[j - r];
+            double temp = ndu[r * aOrder + j - 1] / ndu[j * aOrder + r];
+            ndu[r * aOrder + j] = saved + right[r + 1] * temp;
+            saved = left[j - r] * temp;
+        }
+
+        ndu[j * aOrder + j] = saved;
+    }
+
+    for( int j = 0; j <= p; ++j )
+        aResult[j] = ndu[j * aOrder + p];
+
+    int nd = aNDerivs < p ? aNDerivs : p;
+
+    // derivatives higher than the degree vanish
+    for( int k = nd + 1; k <= aNDerivs; ++k )
+    {
+        for( int j = 0; j <= p; ++j )
+            aResult[k * aOrder + j] = 0.0;
+    }
+
+    if( nd < 1 )
+        return;
+
+    for( int r = 0; r <= p; ++r )
+    {
+        int s1 = 0;
+        int s2 = 1;
+        a[0][0] = 1.0;
+
+        for( int k = 1; k <= nd; ++k )
+        {
+            double d = 0.0;
+            int rk = r - k;
+            int pk = p - k;
+
+            if( r >= k )
+            {
+                a[s2][0] = a[s1][0] / ndu[( pk + 1 ) * aOrder + rk];
+                d = a[s2][0] * ndu[rk * aOrder + pk];
+            }
+
+            int j1 = ( rk >= -1 ) ? 1 : -rk;
+            int j2 = ( r - 1 <= pk ) ? k - 1 : p - r;
+
+            for( int j = j1; j <= j2; ++j )
+            {
+                a[s2][j] = ( a[s1][j] - a[s1][j - 1] ) / ndu[( pk + 1 ) * aOrder + rk + j];
+                d += a[s2][j] * ndu[( rk + j ) * aOrder + pk];
+            }
+
+            if( r <= pk )
+            {
+                a[s2][k] = -a[s1][k - 1] / ndu[( pk + 1 ) * aOrder + r];
+                d += a[s2][k] * ndu[r * aOrder + pk];
+            }
+
+            aResult[k * aOrder + r] = d;
+            std::swap( s1, s2 );
+        }
+    }
+
+    double f = p;
+
+    for( int k = 1; k <= nd; ++k )
+    {
+        for( int j = 0; j <= p; ++j )
+            aResult[k * aOrder + j] *= f;
+
+        f *= p - k;
+    }
+
+    return;
+}
+
+
+// Sum aNTerms homogeneous points starting at aHW and separated by aStride
+// values, weighted by the basis functions and their derivatives (aBasis,
+// as computed by calcBasis() with aNTerms = order); aResult receives 3
+// homogeneous points (derivatives 0 .. 2) and the derivatives above
+// aNDerivs are set to zero.
+#if defined( __AVX__ )
+
+static inline void blendPoints( int aNTerms, int aNDerivs, const double* aBasis,
+    const double* aHW, size_t aStride, double* aResult )
+{
+    __m256d s0 = _mm256_setzero_pd();
+    __m256d s1 = _mm256_setzero_pd();
+    __m256d s2 = _mm256_setzero_pd();
+
+    for( int j = 0; j < aNTerms; ++j, aHW += aStride )
+    {
+        __m256d p = _mm256_loadu_pd( aHW );
+        s0 = _mm256_add_pd( s0, _mm256_mul_pd( _mm256_set1_pd( aBasis[j] ), p ) );
+
+        if( aNDerivs > 0 )
+            s1 = _mm256_add_pd( s1, _mm256_mul_pd( _mm256_set1_pd( aBasis[aNTerms + j] ), p ) );
+
+        if( aNDerivs > 1 )
+            s2 = _mm256_add_pd( s2, _mm256_mul_pd( _mm256_set1_pd( aBasis[2 * aNTerms + j] ), p ) );
+    }
+
+    _mm256_storeu_pd( aResult, s0 );
+    _mm256_storeu_pd( aResult + 4, s1 );
+    _mm256_storeu_pd( aResult + 8, s2 );
+    return;
+}
+
+#elif defined( MCAD_NURBS_SSE2 )
+
+static inline void blendPoints( int aNTerms, int aNDerivs, const double* aBasis,
+    const double* aHW, size_t aStride, double* aResult )
+{
+    __m128d s0a = _mm_setzero_pd();
+    __m128d s0b = _mm_setzero_pd();
+    __m128d s1a = _mm_setzero_pd();
+    __m128d s1b = _mm_setzero_pd();
+    __m128d s2a = _mm_setzero_pd();
+    __m128d s2b = _mm_setzero_pd();
+
+    for( int j = 0; j < aNTerms; ++j, aHW += aStride )
+    {
+        __m128d pa = _mm_loadu_pd( aHW );
+        __m128d pb = _mm_loadu_pd( aHW + 2 );
+        __m128d b = _mm_set1_pd( aBasis[j] );
+        s0a = _mm_add_pd( s0a, _mm_mul_pd( b, pa ) );
+        s0b = _mm_add_pd( s0b, _mm_mul_pd( b, pb ) );
+
+        if( aNDerivs > 0 )
+        {
+            b = _mm_set1_pd( aBasis[aNTerms + j] );
+            s1a = _mm_add_pd( s1a, _mm_mul_pd( b, pa ) );
+            s1b = _mm_add_pd( s1b, _mm_mul_pd( b, pb ) );
+        }
+
+        if( aNDerivs > 1 )
+        {
+            b = _mm_set1_pd( aBasis[2 * aNTerms + j] );
+            s2a = _mm_add_pd( s2a, _mm_mul_pd( b, pa ) );
+            s2b = _mm_add_pd( s2b, _mm_mul_pd( b, pb ) );
+        }
+    }
+
+    _mm_storeu_pd( aResult, s0a );
+    _mm_storeu_pd( aResult + 2, s0b );
+    _mm_storeu_pd( aResult + 4, s1a );
+    _mm_storeu_pd( aResult + 6, s1b );
+    _mm_storeu_pd( aResult + 8, s2a );
+    _mm_storeu_pd( aResult + 10, s2b );
+    return;
+}
+
+#else
+
+static inline void blendPoints( int aNTerms, int aNDerivs, const double* aBasis,
+    const double* aHW, size_t aStride, double* aResult )
+{
+    for( int i = 0; i < 12; ++i )
+        aResult[i] = 0.0;
+
+    for( int k = 0; k <= aNDerivs; ++k )
+    {
+        const double* bp = aBasis + k * aNTerms;
+        double* rp = aResult + 4 * k;
+        const double* pp = aHW;
+
+        for( int j = 0; j < aNTerms; ++j, pp += aStride )
+        {
+            rp[0] += bp[j] * pp[0];
+            rp[1] += bp[j] * pp[1];
+            rp[2] += bp[j] * pp[2];
+            rp[3] += bp[j] * pp[3];
+        }
+    }
+
+    return;
+}
+
+#endif
+
+
+// convert the homogeneous sums produced by blendPoints() into the
+// position and derivatives of the (rational) spline
+static inline bool projectPoints( const double* aSum, MCAD_POINT* aPoint,
+    MCAD_POINT* aDeriv1, MCAD_POINT* aDeriv2 )
+{
+    double w = aSum[3];
+
+    if( w == 0.0 )
+        return false;
+
+    double iw = 1.0 / w;
+    MCAD_POINT c( aSum[0] * iw, aSum[1] * iw, aSum[2] * iw );
+
+    if( aPoint )
+        *aPoint = c;
+
+    if( !aDeriv1 && !aDeriv2 )
+        return true;
+
+    const double* s1 = aSum + 4;
+    MCAD_POINT d1( ( s1[0] - s1[3] * c.x ) * iw,
+                   ( s1[1] - s1[3] * c.y ) * iw,
+                   ( s1[2] - s1[3] * c.z ) * iw );
+
+    if( aDeriv1 )
+        *aDeriv1 = d1;
+
+    if( aDeriv2 )
+    {
+        const double* s2 = aSum + 8;
+        aDeriv2->x = ( s2[0] - 2.0 * s1[3] * d1.x - s2[3] * c.x ) * iw;
+        aDeriv2->y = ( s2[1] - 2.0 * s1[3] * d1.y - s2[3] * c.y ) * iw;
+        aDeriv2->z = ( s2[2] - 2.0 * s1[3] * d1.z - s2[3] * c.z ) * iw;
+    }
+
+    return true;
+}
+
+
+// convert the control points to homogeneous form (wx, wy, wz, w)
+static void toHomogeneous( size_t aNCoeffs, const double* aCoeffs, bool aRational,
+    double* aResult )
+{
+    double* dp = aResult;
+
+    if( aRational )
+    {
+        for( size_t i = 0; i < aNCoeffs; ++i, aCoeffs += 4, dp += 4 )
+        {
+            dp[0] = aCoeffs[0] * aCoeffs[3];
+            dp[1] = aCoeffs[1] * aCoeffs[3];
+            dp[2] = aCoeffs[2] * aCoeffs[3];
+            dp[3] = aCoeffs[3];
+        }
+    }
+    else
+    {
+        for( size_t i = 0; i < aNCoeffs; ++i, aCoeffs += 3, dp += 4 )
+        {
+            dp[0] = aCoeffs[0];
+            dp[1] = aCoeffs[1];
+            dp[2] = aCoeffs[2];
+            dp[3] = 1.0;
+        }
+    }
+
+    return;
+}
+
+
+// calculate the knot spans and the basis functions (stride 2 * aOrder)
+// and optionally their first derivatives for each of the parameters
+static void calcParamBasis( int aOrder, int aNCoeffs, const double* aKnots,
+    size_t aNParams, const double* aParams, int aNDerivs, vector<int>& aSpans,
+    vector<double>& aBasis, double* aScratch )
+{
+    const double uMin = aKnots[aOrder - 1];
+    const double uMax = aKnots[aNCoeffs];
+
+    aSpans.resize( aNParams );
+    aBasis.resize( aNParams * 2 * aOrder );
+
+    for( size_t i = 0; i < aNParams; ++i )
+    {
+        double u = aParams[i];
+
+        if( u < uMin )
+            u = uMin;
+        else if( u > uMax )
+            u = uMax;
+
+        aSpans[i] = FindKnotSpan( aOrder, aNCoeffs, aKnots, u );
+        calcBasis( aOrder, aKnots, aSpans[i], u, aNDerivs, &aBasis[i * 2 * aOrder], aScratch );
+    }
+
+    return;
+}
+
+
+int FindKnotSpan( int aOrder, int aNCoeffs, const double* aKnots, double aParam )
+{
+    const double* first = aKnots + aOrder;
+    const double* last = aKnots + aNCoeffs;
+
+    // the first knot greater than aParam within knot[order .. nCoeffs)
+    int span = (int)( upper_bound( first, last, aParam ) - aKnots ) - 1;
+
+    // at the end of the range use the last non-empty span
+    while( span > aOrder - 1 && aKnots[span] >= aKnots[span + 1] )
+        --span;
+
+    return span;
+}
+
+
+void CalcBasisDerivs( int aOrder, const double* aKnots, int aSpan,
+    double aParam, int aNDerivs, double* aResult )
+{
+    if( aNDerivs > NURBS_MAX_DERIV )
+        aNDerivs = NURBS_MAX_DERIV;
+
+    if( aNDerivs < 0 )
+        aNDerivs = 0;
+
+    vector<double> scratch( basisScratch( aOrder ) );
+    calcBasis( aOrder, aKnots, aSpan, aParam, aNDerivs, aResult, &scratch[0] );
+    return;
+}
+
+
+bool EvalNURBSCurve( int aOrder, int aNCoeffs, const double* aKnots,
+    const double* aCoeffs, bool aRational, size_t aNParams, const double* aParams,
+    MCAD_POINT* aPoint, MCAD_POINT* aDeriv1, MCAD_POINT* aDeriv2 )
+{
+    if( aOrder < 1 || aNCoeffs < aOrder || !aKnots || !aCoeffs )
+    {
+        ERRMSG << "\n + [INFO] invalid curve data\n";
+        return false;
+    }
+
+    if( 0 == aNParams )
+        return true;
+
+    if( !aParams )
+    {
+        ERRMSG << "\n + [INFO] NULL pointer to parameters\n";
+        return false;
+    }
+
+    int nd = 0;
+
+    if( aDeriv2 )
+        nd = 2;
+    else if( aDeriv1 )
+        nd = 1;
+
+    // Only the aOrder control points of the current knot span are converted
+    // to homogeneous form; for the usual low order curves the work space is
+    // on the stack so that single point evaluations do not allocate memory.
+    double stackBuf[NURBS_STACK_SIZE];
+    vector<double> heapBuf;
+    double* scratch = stackBuf;
+    size_t nBuf = basisScratch( aOrder ) + ( NURBS_MAX_DERIV + 1 ) * aOrder + 4 * aOrder;
+
+    if( nBuf > NURBS_STACK_SIZE )
+    {
+        heapBuf.resize( nBuf );
+        scratch = &heapBuf[0];
+    }
+
+    double* basis = scratch + basisScratch( aOrder );
+    double* hw = basis + ( NURBS_MAX_DERIV + 1 ) * aOrder;
+    double sum[12];
+
+    const double uMin = aKnots[aOrder - 1];
+    const double uMax = aKnots[aNCoeffs];
+    int span = -1;
+
+    for( size_t i = 0; i < aNParams; ++i )
+    {
+        double u = aParams[i];
+
+        if( u < uMin )
+            u = uMin;
+        else if( u > uMax )
+            u = uMax;
+
+        // ordered parameters frequently fall within the previous span
+        if( span < 0 || u < aKnots[span] || u >= aKnots[span + 1] )
+        {
+            int ns = FindKnotSpan( aOrder, aNCoeffs, aKnots, u );
+
+            if( ns != span )
+            {
+                span = ns;
+                int stride = aRational ? 4 : 3;
+                toHomogeneous( aOrder, aCoeffs + stride * ( span - aOrder + 1 ), aRational, hw );
+            }
+        }
+
+        calcBasis( aOrder, aKnots, span, u, nd, basis, scratch );
+        blendPoints( aOrder, nd, basis, hw, 4, sum );
+
+        if( !projectPoints( sum, aPoint ? &aPoint[i] : NULL,
+            aDeriv1 ? &aDeriv1[i] : NULL, aDeriv2 ? &aDeriv2[i] : NULL ) )
+        {
+            ERRMSG << "\n + [INFO] curve has a zero weight at parameter " << u << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool EvalNURBSSurfaceGrid( int aOrder1, int aOrder2, int aNCoeffs1, int aNCoeffs2,
+    const double* aKnots1, const double* aKnots2, const double* aCoeffs, bool aRational,
+    size_t aNU, const double* aU, size_t aNV, const double* aV, MCAD_POINT* aPoint,
+    MCAD_POINT* aDerivU, MCAD_POINT* aDerivV, MCAD_POINT* aNormal )
+{
+    if( aOrder1 < 1 || aOrder2 < 1 || aNCoeffs1 < aOrder1 || aNCoeffs2 < aOrder2
+        || !aKnots1 || !aKnots2 || !aCoeffs )
+    {
+        ERRMSG << "\n + [INFO] invalid surface data\n";
+        return false;
+    }
+
+    if( 0 == aNU || 0 == aNV )
+        return true;
+
+    if( !aU || !aV )
+    {
+        ERRMSG << "\n + [INFO] NULL pointer to parameters\n";
+        return false;
+    }
+
+    int nd = ( aDerivU || aDerivV || aNormal ) ? 1 : 0;
+
+    vector<double> hw( 4 * (size_t)aNCoeffs1 * aNCoeffs2 );
+    toHomogeneous( (size_t)aNCoeffs1 * aNCoeffs2, aCoeffs, aRational, &hw[0] );
+
+    // basis functions are evaluated once per U and V parameter
+    vector<double> scratch( basisScratch( std::max( aOrder1, aOrder2 ) ) );
+    vector<int> spanU;
+    vector<int> spanV;
+    vector<double> basisU;
+    vector<double> basisV;
+    calcParamBasis( aOrder1, aNCoeffs1, aKnots1, aNU, aU, nd, spanU, basisU, &scratch[0] );
+    calcParamBasis( aOrder2, aNCoeffs2, aKnots2, aNV, aV, nd, spanV, basisV, &scratch[0] );
+
+    // For each V parameter the control net is reduced to a row of
+    // homogeneous points (and their V derivatives) which is then
+    // evaluated as a curve at each U parameter.
+    const size_t rowStride = 4 * (size_t)aNCoeffs1;
+    vector<double> row( rowStride );
+    vector<double> rowV( rowStride );
+    double sum[12];
+    double sumV[12];
+
+    for( size_t j = 0; j < aNV; ++j )
+    {
+        const double* bv = &basisV[j * 2 * aOrder2];
+        const double* net = &hw[( spanV[j] - aOrder2 + 1 ) * rowStride];
+
+        for( int i = 0; i < aNCoeffs1; ++i )
+        {
+            blendPoints( aOrder2, nd, bv, net + 4 * i, rowStride, sum );
+
+            for( int k = 0; k < 4; ++k )
+            {
+                row[4 * i + k] = sum[k];
+                rowV[4 * i + k] = sum[4 + k];
+            }
+        }
+
+        for( size_t i = 0; i < aNU; ++i )
+        {
+            const double* bu = &basisU[i * 2 * aOrder1];
+            size_t off = 4 * (size_t)( spanU[i] - aOrder1 + 1 );
+            size_t idx = j * aNU + i;
+
+            blendPoints( aOrder1, nd, bu, &row[off], 4, sum );
+
+            double w = sum[3];
+
+            if( w == 0.0 )
+            {
+                ERRMSG << "\n + [INFO] surface has a zero weight at parameter ("
+                    << aU[i] << ", " << aV[j] << ")\n";
+                return false;
+            }
+
+            double iw = 1.0 / w;
+            MCAD_POINT c( sum[0] * iw, sum[1] * iw, sum[2] * iw );
+
+            if( aPoint )
+                aPoint[idx] = c;
+
+            if( !nd )
+                continue;
+
+            blendPoints( aOrder1, 0, bu, &rowV[off], 4, sumV );
+
+            MCAD_POINT du( ( sum[4] - sum[7] * c.x ) * iw,
+                           ( sum[5] - sum[7] * c.y ) * iw,
+                           ( sum[6] - sum[7] * c.z ) * iw );
+
+            MCAD_POINT dv( ( sumV[0] - sumV[3] * c.x ) * iw,
+                           ( sumV[1] - sumV[3] * c.y ) * iw,
+                           ( sumV[2] - sumV[3] * c.z ) * iw );
+
+            if( aDerivU )
+                aDerivU[idx] = du;
+
+            if( aDerivV )
+                aDerivV[idx] = dv;
+
+            if( aNormal )
+            {
+                MCAD_POINT n( du.y * dv.z - du.z * dv.y,
+                              du.z * dv.x - du.x * dv.z,
+                              du.x * dv.y - du.y * dv.x );
+
+                double ln = sqrt( n.x * n.x + n.y * n.y + n.z * n.z );
+
+                if( ln > 0.0 )
+                {
+                    ln = 1.0 / ln;
+                    n.x *= ln;
+                    n.y *= ln;
+                    n.z *= ln;
+                }
+
+                aNormal[idx] = n;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool EvalNURBSSurfacePoints( int aOrder1, int aOrder2, int aNCoeffs1, int aNCoeffs2,
+    const double* aKnots1, const double* aKnots2, const double* aCoeffs, bool aRational,
+    size_t aNParams, const double* aU, const double* aV, MCAD_POINT* aPoint )
+{
+    if( aOrder1 < 1 || aOrder2 < 1 || aNCoeffs1 < aOrder1 || aNCoeffs2 < aOrder2
+        || !aKnots1 || !aKnots2 || !aCoeffs )
+    {
+        ERRMSG << "\n + [INFO] invalid surface data\n";
+        return false;
+    }
+
+    if( 0 == aNParams )
+        return true;
+
+    if( !aU || !aV || !aPoint )
+    {
+        ERRMSG << "\n + [INFO] NULL pointer to parameters or results\n";
+        return false;
+    }
+
+    // work space: basis scratch, the basis functions in U and V, the
+    // homogeneous control points of the current patch and the row sums
+    double stackBuf[NURBS_STACK_SIZE];
+    vector<double> heapBuf;
+    double* scratch = stackBuf;
+    size_t nBuf = basisScratch( std::max( aOrder1, aOrder2 ) ) + aOrder1 + aOrder2
+        + 4 * aOrder1 * aOrder2 + 4 * aOrder2;
+
+    if( nBuf > NURBS_STACK_SIZE )
+    {
+        heapBuf.resize( nBuf );
+        scratch = &heapBuf[0];
+    }
+
+    double* bu = scratch + basisScratch( std::max( aOrder1, aOrder2 ) );
+    double* bv = bu + aOrder1;
+    double* hw = bv + aOrder2;
+    double* row = hw + 4 * aOrder1 * aOrder2;
+    double sum[12];
+
+    const double uMin = aKnots1[aOrder1 - 1];
+    const double uMax = aKnots1[aNCoeffs1];
+    const double vMin = aKnots2[aOrder2 - 1];
+    const double vMax = aKnots2[aNCoeffs2];
+    const int stride = aRational ? 4 : 3;
+    int spanU = -1;
+    int spanV = -1;
+
+    for( size_t i = 0; i < aNParams; ++i )
+    {
+        double u = aU[i];
+        double v = aV[i];
+
+        if( u < uMin )
+            u = uMin;
+        else if( u > uMax )
+            u = uMax;
+
+        if( v < vMin )
+            v = vMin;
+        else if( v > vMax )
+            v = vMax;
+
+        int su = spanU;
+        int sv = spanV;
+
+        // nearby parameters frequently fall within the previous patch
+        if( su < 0 || u < aKnots1[su] || u >= aKnots1[su + 1] )
+            su = FindKnotSpan( aOrder1, aNCoeffs1, aKnots1, u );
+
+        if( sv < 0 || v < aKnots2[sv] || v >= aKnots2[sv + 1] )
+            sv = FindKnotSpan( aOrder2, aNCoeffs2, aKnots2, v );
+
+        if( su != spanU || sv != spanV )
+        {
+            spanU = su;
+            spanV = sv;
+
+            for( int j = 0; j < aOrder2; ++j )
+            {
+                size_t idx = (size_t)( spanV - aOrder2 + 1 + j ) * aNCoeffs1
+                    + spanU - aOrder1 + 1;
+                toHomogeneous( aOrder1, aCoeffs + stride * idx, aRational,
+                    hw + 4 * aOrder1 * j );
+            }
+        }
+
+        calcBasis( aOrder1, aKnots1, spanU, u, 0, bu, scratch );
+        calcBasis( aOrder2, aKnots2, spanV, v, 0, bv, scratch );
+
+        // reduce each row of the patch in U, then the column of sums in V
+        for( int j = 0; j < aOrder2; ++j )
+        {
+            blendPoints( aOrder1, 0, bu, hw + 4 * aOrder1 * j, 4, sum );
+
+            for( int k = 0; k < 4; ++k )
+                row[4 * j + k] = sum[k];
+        }
+
+        blendPoints( aOrder2, 0, bv, row, 4, sum );
+
+        if( !projectPoints( sum, &aPoint[i], NULL, NULL ) )
+        {
+            ERRMSG << "\n + [INFO] surface has a zero weight at parameter ("
+                << u << ", " << v << ")\n";
+            return false;
+        }
+    }
+
+    return true;
+}
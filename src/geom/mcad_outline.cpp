@@ -115,7 +115,10 @@ MCAD_OUTLINE::MCAD_OUTLINE()
     mIsClosed = false;
     mWinding = 0.0;
     mBBisOK = false;
+    mEdgeIndexOK = false;
+    mEdgeTol = 0.0;
     m_OutlineType = MCAD_OT_BASE;
+    mSegPool = new MCAD_SEGPOOL;
     return;
 }
 
@@ -140,6 +143,10 @@ MCAD_OUTLINE::~MCAD_OUTLINE()
         mholes.pop_back();
     }
 
+    // segments allocated from the pool which are still in use elsewhere
+    // retain their storage
+    delete mSegPool;
+
     list< bool* >::iterator sVF = m_validFlags.begin();
     list< bool* >::iterator eVF = m_validFlags.end();
 
@@ -291,6 +298,163 @@ bool MCAD_OUTLINE::IsInside( MCAD_POINT aPoint, bool& error )
         return false;
     }
 
+    if( !mEdgeIndexOK )
+        buildEdgeIndex();
+
+    vector<size_t> eList;
+    return isInside( aPoint, eList );
+}
+
+
+// Test a list of points against this outline
+bool MCAD_OUTLINE::IsInside( const std::vector<MCAD_POINT>& aPoints,
+                             std::vector<bool>& aResult, bool& error )
+{
+    aResult.clear();
+
+    if( !mIsClosed )
+    {
+        ostringstream msg;
+        GEOM_ERR( msg );
+        msg << "[BUG] outline is not closed";
+        ERRMSG << msg.str() << "\n";
+        errors.push_back( msg.str() );
+        error = true;
+        return false;
+    }
+
+    if( !mEdgeIndexOK )
+        buildEdgeIndex();
+
+    vector<size_t> eList;
+    aResult.resize( aPoints.size() );
+
+    for( size_t i = 0; i < aPoints.size(); ++i )
+        aResult[i] = isInside( aPoints[i], eList );
+
+    return true;
+}
+
+
+// order the segments of the index by their minimum Y
+static bool lessFirst( const pair< double, list<MCAD_SEGMENT*>::iterator >& a,
+                       const pair< double, list<MCAD_SEGMENT*>::iterator >& b )
+{
+    return a.first < b.first;
+}
+
+
+void MCAD_OUTLINE::buildEdgeIndex( void )
+{
+    vector< pair< double, list<MCAD_SEGMENT*>::iterator > > order;
+    list<MCAD_SEGMENT*>::iterator sSegs = msegments.begin();
+    list<MCAD_SEGMENT*>::iterator eSegs = msegments.end();
+    MCAD_POINT bb0;
+    MCAD_POINT bb1;
+
+    order.reserve( msegments.size() );
+
+    while( sSegs != eSegs )
+    {
+        (*sSegs)->GetBoundingBox( bb0, bb1 );
+        order.push_back( pair< double, list<MCAD_SEGMENT*>::iterator >( bb0.y, sSegs ) );
+        ++sSegs;
+    }
+
+    // a stable sort keeps the index independent of the iterator values
+    stable_sort( order.begin(), order.end(), lessFirst );
+
+    size_t nE = order.size();
+    mEdgeSegs.resize( nE );
+    mEdgeBB0.resize( nE );
+    mEdgeBB1.resize( nE );
+    mEdgeMaxY.resize( nE );
+
+    mEdgeTol = 0.0;
+
+    for( size_t i = 0; i < nE; ++i )
+    {
+        mEdgeSegs[i] = order[i].second;
+        (*order[i].second)->GetBoundingBox( mEdgeBB0[i], mEdgeBB1[i] );
+        mEdgeMaxY[i] = mEdgeBB1[i].y;
+        mEdgeTol = max( mEdgeTol, mEdgeBB1[i].x - mEdgeBB0[i].x );
+        mEdgeTol = max( mEdgeTol, mEdgeBB1[i].y - mEdgeBB0[i].y );
+    }
+
+    // intersections are accepted within a relative tolerance of 1e-8
+    // along each segment; a much larger margin is used to be safe
+    mEdgeTol = 1e-6 * ( 1.0 + mEdgeTol );
+
+    // the node of the range [lo, hi) is (lo + hi) / 2; calculate the
+    // maximum Y of each subtree from the smallest subtrees upwards
+    vector< pair<size_t, size_t> > stack;
+    vector< pair<size_t, size_t> > nodes;
+
+    if( nE > 0 )
+        stack.push_back( pair<size_t, size_t>( 0, nE ) );
+
+    while( !stack.empty() )
+    {
+        pair<size_t, size_t> r = stack.back();
+        stack.pop_back();
+        nodes.push_back( r );
+
+        size_t mid = ( r.first + r.second ) / 2;
+
+        if( r.first < mid )
+            stack.push_back( pair<size_t, size_t>( r.first, mid ) );
+
+        if( mid + 1 < r.second )
+            stack.push_back( pair<size_t, size_t>( mid + 1, r.second ) );
+    }
+
+    // children are always listed after their parents
+    for( size_t i = nodes.size(); i > 0; --i )
+    {
+        size_t lo = nodes[i - 1].first;
+        size_t hi = nodes[i - 1].second;
+        size_t mid = ( lo + hi ) / 2;
+
+        if( lo < mid && mEdgeMaxY[( lo + mid ) / 2] > mEdgeMaxY[mid] )
+            mEdgeMaxY[mid] = mEdgeMaxY[( lo + mid ) / 2];
+
+        if( mid + 1 < hi && mEdgeMaxY[( mid + 1 + hi ) / 2] > mEdgeMaxY[mid] )
+            mEdgeMaxY[mid] = mEdgeMaxY[( mid + 1 + hi ) / 2];
+    }
+
+    mEdgeIndexOK = true;
+    return;
+}
+
+
+void MCAD_OUTLINE::findEdges( size_t aLo, size_t aHi, double aY0, double aY1,
+                              std::vector<size_t>& aList ) const
+{
+    while( aLo < aHi )
+    {
+        size_t mid = ( aLo + aHi ) / 2;
+
+        if( mEdgeMaxY[mid] < aY0 )
+            return;
+
+        findEdges( aLo, mid, aY0, aY1, aList );
+
+        // all segments to the right start at or above this one
+        if( mEdgeBB0[mid].y > aY1 )
+            return;
+
+        if( mEdgeBB1[mid].y >= aY0 )
+            aList.push_back( mid );
+
+        aLo = mid + 1;
+    }
+
+    return;
+}
+
+
+bool MCAD_OUTLINE::isInside( const MCAD_POINT& aPoint, std::vector<size_t>& aList )
+{
     // Steps:
     // 1. take a line passing through this point and directly to the
     //    left or right, whichever is the shortest segment.
@@ -298,6 +462,9 @@ bool MCAD_OUTLINE::IsInside( MCAD_POINT aPoint, bool& error )
     //    count it as a node if ALL points of the segment touched
     //    are <= aPoint.y.
     // 3. odd nodes = inside, even nodes = outside
+    //
+    // Only the segments whose bounding box spans aPoint.y (within the
+    // tolerance of the intersection calculations) and the line are tested.
 
     MCAD_POINT bb0 = mBottomLeft;
     MCAD_POINT bb1 = mTopRight;
@@ -317,19 +484,29 @@ bool MCAD_OUTLINE::IsInside( MCAD_POINT aPoint, bool& error )
 
     p2.y = aPoint.y;
 
+    double tol = mEdgeTol + 1e-6 * abs( aPoint.x - p2.x );
+    double lx0 = min( aPoint.x, p2.x ) - tol;
+    double lx1 = max( aPoint.x, p2.x ) + tol;
+
+    aList.clear();
+    findEdges( 0, mEdgeSegs.size(), aPoint.y - tol, aPoint.y + tol, aList );
+
     MCAD_SEGMENT ls0;
     ls0.SetParams( aPoint, p2 );
     int nI = 0; // number of intersections with the outline
 
-    list<MCAD_SEGMENT*>::iterator sSegs = msegments.begin();
+    list<MCAD_SEGMENT*>::iterator sSegs;
     list<MCAD_SEGMENT*>::iterator eSegs = msegments.end();
     list<MCAD_POINT> iList;
     MCAD_INTERSECT_FLAG flag;
 
-    int acc = 0;
-
-    while( sSegs != eSegs )
+    for( size_t i = 0; i < aList.size(); ++i )
     {
+        if( mEdgeBB0[aList[i]].x > lx1 || mEdgeBB1[aList[i]].x < lx0 )
+            continue;
+
+        sSegs = mEdgeSegs[aList[i]];
+
         if( (*sSegs)->GetIntersections( ls0, iList, flag ) )
         {
             list<MCAD_POINT>::iterator sL = iList.begin();
@@ -403,8 +580,6 @@ bool MCAD_OUTLINE::IsInside( MCAD_POINT aPoint, bool& error )
 
             iList.clear();
         }
-
-        ++sSegs;
     }
 
     // note: an odd number means the point is inside the outline
@@ -454,6 +629,7 @@ bool MCAD_OUTLINE::AddSegment( MCAD_SEGMENT* aSegment, bool& error )
     }
 
     error = false;
+    mEdgeIndexOK = false;
 
     if( MCAD_SEGTYPE_CIRCLE == aSegment->GetSegType() )
     {
@@ -610,7 +786,9 @@ bool MCAD_OUTLINE::AddSegment( MCAD_SEGMENT* aSegment, bool& error )
 // operate on the outline (add/subtract)
 bool MCAD_OUTLINE::opOutline( MCAD_SEGMENT* aCircle, bool& error, bool opsub )
 {
+    MCAD_SEGPOOL_SCOPE pool( mSegPool );
     mBBisOK = false;
+    mEdgeIndexOK = false;
 
     if( !mIsClosed )
     {
@@ -1177,7 +1355,9 @@ bool MCAD_OUTLINE::opOutline( MCAD_OUTLINE* aOutline, bool& error, bool opsub )
     //       CCW order along aOutline.
     //
 
+    MCAD_SEGPOOL_SCOPE pool( mSegPool );
     mBBisOK = false;
+    mEdgeIndexOK = false;
 
     if( !mIsClosed )
     {
@@ -1201,6 +1381,10 @@ bool MCAD_OUTLINE::opOutline( MCAD_OUTLINE* aOutline, bool& error, bool opsub )
         return false;
     }
 
+    // the segments of aOutline are split below and aOutline->IsInside()
+    // must not use an index of the segments prior to the split
+    aOutline->mEdgeIndexOK = false;
+
     if( !aOutline->IsClosed() )
     {
         ostringstream msg;
@@ -1924,6 +2108,13 @@ bool MCAD_OUTLINE::AddOutline( MCAD_OUTLINE* aOutline, bool& error )
 {
     bool res = opOutline( aOutline, error, false );
 
+    // the index is rebuilt on demand after the segments have changed
+    mEdgeIndexOK = false;
+
+    // aOutline is deleted if the operation succeeds
+    if( !res && NULL != aOutline )
+        aOutline->mEdgeIndexOK = false;
+
     if( error )
     {
         ostringstream msg;
@@ -1941,6 +2132,7 @@ bool MCAD_OUTLINE::AddOutline( MCAD_OUTLINE* aOutline, bool& error )
 bool MCAD_OUTLINE::AddOutline( MCAD_SEGMENT* aCircle, bool& error )
 {
     bool res = opOutline( aCircle, error, false );
+    mEdgeIndexOK = false;
 
     if( error )
     {
@@ -1965,6 +2157,7 @@ bool MCAD_OUTLINE::AddOutline( MCAD_SEGMENT* aCircle, bool& error )
 bool MCAD_OUTLINE::SubOutline( MCAD_SEGMENT* aCircle, bool& error )
 {
     bool res = opOutline( aCircle, error, true );
+    mEdgeIndexOK = false;
 
     if( error )
     {
@@ -1989,6 +2182,11 @@ bool MCAD_OUTLINE::SubOutline( MCAD_SEGMENT* aCircle, bool& error )
 bool MCAD_OUTLINE::SubOutline( MCAD_OUTLINE* aOutline, bool& error )
 {
     bool res = opOutline( aOutline, error, true );
+    mEdgeIndexOK = false;
+
+    // aOutline is deleted if the operation succeeds
+    if( !res && NULL != aOutline )
+        aOutline->mEdgeIndexOK = false;
 
     if( error )
     {
@@ -2004,6 +2202,170 @@ bool MCAD_OUTLINE::SubOutline( MCAD_OUTLINE* aOutline, bool& error )
 }
 
 
+// operate on a list of circular outlines (add/subtract); each circle
+// is tested against the edge in the order of the list so the result
+// is the same as invoking opOutline() on each circle in turn.
+bool MCAD_OUTLINE::opOutlines( std::list<MCAD_SEGMENT*>& aCircles, bool& error, bool opsub )
+{
+    MCAD_SEGPOOL_SCOPE pool( mSegPool );
+    error = false;
+
+    if( !mIsClosed )
+    {
+        ostringstream msg;
+        GEOM_ERR( msg );
+        msg << "[BUG] outline is not closed";
+        ERRMSG << msg.str() << "\n";
+        errors.push_back( msg.str() );
+        error = true;
+        return false;
+    }
+
+    if( aCircles.empty() )
+        return false;
+
+    if( !mEdgeIndexOK )
+        buildEdgeIndex();
+
+    // Pass 1: find the circles whose bounding boxes overlap the bounding
+    // box of a segment of the current edge; the other circles cannot
+    // intersect the edge unless they intersect a circle which is merged
+    // with the edge by this operation.
+    list<MCAD_SEGMENT*>::iterator sC = aCircles.begin();
+    list<MCAD_SEGMENT*>::iterator eC = aCircles.end();
+    vector<MCAD_POINT> cBB0;
+    vector<MCAD_POINT> cBB1;
+    vector<bool> nearEdge;
+    vector<size_t> eList;
+    size_t nE = mEdgeSegs.size();
+
+    cBB0.reserve( aCircles.size() );
+    cBB1.reserve( aCircles.size() );
+    nearEdge.reserve( aCircles.size() );
+
+    while( sC != eC )
+    {
+        MCAD_POINT bb0;
+        MCAD_POINT bb1;
+        bool isNear = false;
+
+        // invalid items are reported by opOutline() in pass 2
+        if( NULL != *sC && MCAD_SEGTYPE_CIRCLE == (*sC)->GetSegType() )
+        {
+            (*sC)->GetBoundingBox( bb0, bb1 );
+            bb0.x -= mEdgeTol;
+            bb0.y -= mEdgeTol;
+            bb1.x += mEdgeTol;
+            bb1.y += mEdgeTol;
+
+            eList.clear();
+            findEdges( 0, nE, bb0.y, bb1.y, eList );
+
+            for( size_t i = 0; i < eList.size(); ++i )
+            {
+                if( mEdgeBB0[eList[i]].x <= bb1.x && mEdgeBB1[eList[i]].x >= bb0.x )
+                {
+                    isNear = true;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            isNear = true;
+        }
+
+        cBB0.push_back( bb0 );
+        cBB1.push_back( bb1 );
+        nearEdge.push_back( isNear );
+        ++sC;
+    }
+
+    // Pass 2: apply the circles which may touch the edge in order
+    vector<size_t> merged;  // circles which have been merged with the edge
+    bool res = false;
+    size_t idx = 0;
+    sC = aCircles.begin();
+
+    while( sC != eC )
+    {
+        bool isNear = nearEdge[idx];
+
+        for( size_t i = 0; i < merged.size() && !isNear; ++i )
+        {
+            size_t j = merged[i];
+
+            if( cBB0[j].x <= cBB1[idx].x && cBB1[j].x >= cBB0[idx].x
+                && cBB0[j].y <= cBB1[idx].y && cBB1[j].y >= cBB0[idx].y )
+                isNear = true;
+        }
+
+        if( isNear )
+        {
+            if( opOutline( *sC, error, opsub ) )
+            {
+                delete *sC;
+                sC = aCircles.erase( sC );
+                merged.push_back( idx );
+                res = true;
+                ++idx;
+                continue;
+            }
+
+            if( error )
+            {
+                ostringstream msg;
+                GEOM_ERR( msg );
+                msg << "[INFO] see above messages";
+                ERRMSG << msg.str() << "\n";
+                errors.push_back( msg.str() );
+                return false;
+            }
+        }
+
+        if( opsub )
+        {
+            mholes.push_back( *sC );
+            sC = aCircles.erase( sC );
+        }
+        else
+        {
+            ++sC;
+        }
+
+        ++idx;
+    }
+
+    return res;
+}   // opOutlines( std::list<MCAD_SEGMENT*>& aCircles, bool& error, bool opsub )
+
+
+// Merge each circle in the list with this outline
+bool MCAD_OUTLINE::AddOutlines( std::list<MCAD_SEGMENT*>& aCircles, bool& error )
+{
+    bool res = opOutlines( aCircles, error, false );
+    mEdgeIndexOK = false;
+
+    if( error )
+        return false;
+
+    return res;
+}
+
+
+// Subtract each circle in the list from this outline
+bool MCAD_OUTLINE::SubOutlines( std::list<MCAD_SEGMENT*>& aCircles, bool& error )
+{
+    bool res = opOutlines( aCircles, error, true );
+    mEdgeIndexOK = false;
+
+    if( error )
+        return false;
+
+    return res;
+}
+
+
 // Add the given cutout in preparation for exporting a solid model.
 // If the cutout is known to be non-overlapping then the 'overlaps'
 // flag may be set to 'false' to skip overlap tests. If the user
@@ -2038,7 +2400,7 @@ bool MCAD_OUTLINE::AddCutout( MCAD_OUTLINE* aCutout, bool overlaps, bool& error
 
     if( !overlaps )
     {
-        mcutouts.push_back( aCutout );
+        pushCutout( aCutout );
         return true;
     }
 
@@ -2055,14 +2417,21 @@ bool MCAD_OUTLINE::AddCutout( MCAD_OUTLINE* aCutout, bool overlaps, bool& error
         return false;
     }
 
-    // check for overlaps with internal cutouts
-    list<MCAD_OUTLINE*>::iterator sC = mcutouts.begin();
-    list<MCAD_OUTLINE*>::iterator eC = mcutouts.end();
+    // check for overlaps with internal cutouts; only the cutouts
+    // whose bounding boxes overlap the new cutout are tried
+    MCAD_POINT bb0;
+    MCAD_POINT bb1;
+    vector<size_t> cList;
+    aCutout->getExtent( bb0, bb1 );
+    findCutouts( bb0, bb1, cList );
 
-    while( sC != eC )
+    for( size_t i = 0; i < cList.size(); ++i )
     {
-        if( (*sC)->AddOutline( aCutout, error ) )
+        if( mCutoutItems[cList[i]]->AddOutline( aCutout, error ) )
+        {
+            updateCutout( cList[i] );
             return true;
+        }
 
         if( error )
         {
@@ -2073,11 +2442,9 @@ bool MCAD_OUTLINE::AddCutout( MCAD_OUTLINE* aCutout, bool overlaps, bool& error
             errors.push_back( msg.str() );
             return false;
         }
-
-        ++sC;
     }
 
-    mcutouts.push_back( aCutout );
+    pushCutout( aCutout );
     return true;
 }
 
@@ -2131,14 +2498,21 @@ bool MCAD_OUTLINE::AddCutout( MCAD_SEGMENT* aCircle, bool overlaps, bool& error
         return false;
     }
 
-    // check for overlaps with internal cutouts
-    list<MCAD_OUTLINE*>::iterator sC = mcutouts.begin();
-    list<MCAD_OUTLINE*>::iterator eC = mcutouts.end();
+    // check for overlaps with internal cutouts; only the cutouts
+    // whose bounding boxes overlap the circle are tried
+    MCAD_POINT bb0;
+    MCAD_POINT bb1;
+    vector<size_t> cList;
+    aCircle->GetBoundingBox( bb0, bb1 );
+    findCutouts( bb0, bb1, cList );
 
-    while( sC != eC )
+    for( size_t i = 0; i < cList.size(); ++i )
     {
-        if( (*sC)->AddOutline( aCircle, error ) )
+        if( mCutoutItems[cList[i]]->AddOutline( aCircle, error ) )
+        {
+            updateCutout( cList[i] );
             return true;
+        }
 
         if( error )
         {
@@ -2149,8 +2523,6 @@ bool MCAD_OUTLINE::AddCutout( MCAD_SEGMENT* aCircle, bool overlaps, bool& error
             errors.push_back( msg.str() );
             return false;
         }
-
-        ++sC;
     }
 
     mholes.push_back( aCircle );
@@ -2158,40 +2530,349 @@ bool MCAD_OUTLINE::AddCutout( MCAD_SEGMENT* aCircle, bool overlaps, bool& error
 }
 
 
+// state of a run of segments being merged into the first segment of the run
+struct MCAD_SIMPLIFY_RUN
+{
+    MCAD_POINT start;   // start point of the run
+    MCAD_POINT dir;     // unit direction of the first line of the run
+    double lo;          // lower bound of the angle of the merged line relative to dir
+    double hi;          // upper bound of the angle of the merged line relative to dir
+    double sweep;       // total sweep (radians, absolute) of a run of arcs
+};
+
+
+static void startRun( MCAD_SEGMENT* aSeg, MCAD_SIMPLIFY_RUN& aRun )
+{
+    // the window of permissible directions is set by the first removed vertex
+    aRun.start = aSeg->GetMStart();
+    aRun.lo = -M_PI * 0.5;
+    aRun.hi = M_PI * 0.5;
+    aRun.sweep = 0.0;
+
+    if( MCAD_SEGTYPE_LINE == aSeg->GetSegType() )
+    {
+        MCAD_POINT p = aSeg->GetMEnd();
+        double dx = p.x - aRun.start.x;
+        double dy = p.y - aRun.start.y;
+        double dl = sqrt( dx*dx + dy*dy );
+
+        aRun.dir.x = dx / dl;
+        aRun.dir.y = dy / dl;
+    }
+    else if( MCAD_SEGTYPE_ARC == aSeg->GetSegType() )
+    {
+        aRun.sweep = abs( aSeg->GetMEAngle() - aSeg->GetMSAngle() );
+    }
+
+    return;
+}
+
+
+// Attempt to merge aNext into aSeg, which is the first segment of the
+// given run; aNext must follow aSeg in the outline. If aApply is 'false'
+// the segments are only tested and neither the run nor aSeg is changed.
+static bool mergeRun( MCAD_SEGMENT* aSeg, MCAD_SEGMENT* aNext, double aTolerance,
+                      MCAD_SIMPLIFY_RUN& aRun, bool aApply )
+{
+    if( aSeg->GetSegType() != aNext->GetSegType() )
+        return false;
+
+    MCAD_POINT p = aSeg->GetMEnd();
+    MCAD_POINT q = aNext->GetMEnd();
+
+    if( MCAD_SEGTYPE_LINE == aSeg->GetSegType() )
+    {
+        // the merged line must advance along the run and every removed
+        // vertex must lie within aTolerance of it; the range of permissible
+        // directions is narrowed by each removed vertex in turn
+        double px = p.x - aRun.start.x;
+        double py = p.y - aRun.start.y;
+        double qx = q.x - aRun.start.x;
+        double qy = q.y - aRun.start.y;
+        double pd = px * aRun.dir.x + py * aRun.dir.y;
+        double qd = qx * aRun.dir.x + qy * aRun.dir.y;
+
+        if( qd <= pd || pd <= 0.0 )
+            return false;
+
+        double pa = atan2( aRun.dir.x * py - aRun.dir.y * px, pd );
+        double w = aTolerance / sqrt( px*px + py*py );
+        w = ( w >= 1.0 ) ? M_PI * 0.5 : asin( w );
+
+        double lo = max( aRun.lo, pa - w );
+        double hi = min( aRun.hi, pa + w );
+        double qa = atan2( aRun.dir.x * qy - aRun.dir.y * qx, qd );
+
+        if( qa < lo || qa > hi )
+            return false;
+
+        if( !aApply )
+            return true;
+
+        if( !aSeg->SetParams( aRun.start, q ) )
+            return false;
+
+        aRun.lo = lo;
+        aRun.hi = hi;
+        return true;
+    }
+
+    if( MCAD_SEGTYPE_ARC != aSeg->GetSegType() || aSeg->IsCW() != aNext->IsCW() )
+        return false;
+
+    // the arcs must lie on the same circle and the merged arc must not
+    // close upon itself
+    MCAD_POINT c0 = aSeg->GetCenter();
+    double r0 = aSeg->GetRadius();
+
+    if( !PointMatches( c0, aNext->GetCenter(), aTolerance )
+        || abs( r0 - aNext->GetRadius() ) > aTolerance )
+        return false;
+
+    double sweep = aRun.sweep + abs( aNext->GetMEAngle() - aNext->GetMSAngle() );
+
+    if( sweep >= 2.0 * M_PI - 1e-6 || PointMatches( aRun.start, q, 1e-8 ) )
+        return false;
+
+    double dx = q.x - c0.x;
+    double dy = q.y - c0.y;
+
+    // the end point must also satisfy the radius test of SetParams()
+    if( abs( sqrt( dx*dx + dy*dy ) - r0 ) > 1e-8 )
+        return false;
+
+    if( !aApply )
+        return true;
+
+    bool cw = aSeg->IsCW();
+    MCAD_POINT s0 = aSeg->GetMStart();
+    MCAD_POINT e0 = aSeg->GetMEnd();
+
+    if( !aSeg->SetParams( c0, aRun.start, q, cw ) )
+    {
+        aSeg->SetParams( c0, s0, e0, cw );
+        return false;
+    }
+
+    aRun.sweep = sweep;
+    return true;
+}
+
+
+void MCAD_OUTLINE::simplifyLoop( std::list<MCAD_SEGMENT*>& aLoop, double aTolerance,
+                                 MCAD_SIMPLIFY_STATS& aStats )
+{
+    aStats.nSegmentsIn += aLoop.size();
+
+    if( aLoop.size() < 3 )
+    {
+        aStats.nSegmentsOut += aLoop.size();
+        return;
+    }
+
+    MCAD_SIMPLIFY_RUN run;
+    list<MCAD_SEGMENT*>::iterator sSeg = aLoop.begin();
+    list<MCAD_SEGMENT*>::iterator sNext;
+
+    // if the last segment may be merged with the first then the loop
+    // is rotated to begin at the first vertex which must be retained;
+    // if there is no such vertex the loop is left as it is.
+    startRun( aLoop.back(), run );
+
+    if( mergeRun( aLoop.back(), aLoop.front(), aTolerance, run, false ) )
+    {
+        sNext = sSeg;
+        ++sNext;
+
+        while( sNext != aLoop.end() )
+        {
+            startRun( *sSeg, run );
+
+            if( !mergeRun( *sSeg, *sNext, aTolerance, run, false ) )
+                break;
+
+            ++sSeg;
+            ++sNext;
+        }
+
+        if( sNext != aLoop.end() )
+            aLoop.splice( aLoop.end(), aLoop, aLoop.begin(), sNext );
+    }
+
+    // merge each run into its first segment in a single pass
+    sSeg = aLoop.begin();
+
+    while( sSeg != aLoop.end() )
+    {
+        startRun( *sSeg, run );
+        sNext = sSeg;
+        ++sNext;
+
+        while( sNext != aLoop.end() && aLoop.size() > 2
+               && mergeRun( *sSeg, *sNext, aTolerance, run, true ) )
+        {
+            if( MCAD_SEGTYPE_LINE == (*sNext)->GetSegType() )
+                ++aStats.nLines;
+            else
+                ++aStats.nArcs;
+
+            delete *sNext;
+            sNext = aLoop.erase( sNext );
+        }
+
+        sSeg = sNext;
+    }
+
+    aStats.nSegmentsOut += aLoop.size();
+    return;
+}
+
+
+// Merge runs of collinear lines and co-circular arcs within the
+// outline and its cutouts; drill holes are not affected.
+bool MCAD_OUTLINE::Simplify( double aTolerance, bool& error, MCAD_SIMPLIFY_STATS* aStats )
+{
+    error = false;
+
+    if( !mIsClosed )
+    {
+        ostringstream msg;
+        GEOM_ERR( msg );
+        msg << "[ERROR] outline is not closed";
+        ERRMSG << msg.str() << "\n";
+        errors.push_back( msg.str() );
+        error = true;
+        return false;
+    }
+
+    if( aTolerance < 0.0 )
+    {
+        ostringstream msg;
+        GEOM_ERR( msg );
+        msg << "[ERROR] invalid tolerance (" << aTolerance << ")";
+        ERRMSG << msg.str() << "\n";
+        errors.push_back( msg.str() );
+        error = true;
+        return false;
+    }
+
+    MCAD_SIMPLIFY_STATS stats;
+
+    simplifyLoop( msegments, aTolerance, stats );
+
+    if( stats.nSegmentsOut != stats.nSegmentsIn )
+    {
+        mBBisOK = false;
+        mEdgeIndexOK = false;
+    }
+
+    for( size_t i = 0; i < mCutoutItems.size(); ++i )
+    {
+        MCAD_OUTLINE* op = mCutoutItems[i];
+        size_t nSegs = op->msegments.size();
+
+        simplifyLoop( op->msegments, aTolerance, stats );
+
+        if( op->msegments.size() != nSegs )
+        {
+            op->mBBisOK = false;
+            op->mEdgeIndexOK = false;
+            updateCutout( i );
+        }
+    }
+
+    if( NULL != aStats )
+        *aStats = stats;
+
+    return stats.nSegmentsOut != stats.nSegmentsIn;
+}
+
 void MCAD_OUTLINE::calcBoundingBox( void )
 {
-    if( msegments.empty() || !mIsClosed )
+    if( !getExtent( mBottomLeft, mTopRight ) )
         return;
 
+    mBBisOK = true;
+    adjustBoundingBox();
+    return;
+}
+
+
+bool MCAD_OUTLINE::getExtent( MCAD_POINT& bb0, MCAD_POINT& bb1 )
+{
+    if( msegments.empty() || !mIsClosed )
+        return false;
+
     list<MCAD_SEGMENT*>::iterator sSeg = msegments.begin();
     list<MCAD_SEGMENT*>::iterator eSeg = msegments.end();
 
-    MCAD_POINT bb0;
-    MCAD_POINT bb1;
-    (*sSeg)->GetBoundingBox( mBottomLeft, mTopRight );
+    MCAD_POINT p0;
+    MCAD_POINT p1;
+    (*sSeg)->GetBoundingBox( bb0, bb1 );
     ++sSeg;
 
     while( sSeg != eSeg )
     {
-        (*sSeg)->GetBoundingBox( bb0, bb1 );
+        (*sSeg)->GetBoundingBox( p0, p1 );
 
-        if( bb0.x < mBottomLeft.x )
-            mBottomLeft.x = bb0.x;
+        if( p0.x < bb0.x )
+            bb0.x = p0.x;
 
-        if( bb0.y < mBottomLeft.y )
-            mBottomLeft.y = bb0.y;
+        if( p0.y < bb0.y )
+            bb0.y = p0.y;
 
-        if( bb1.x > mTopRight.x )
-            mTopRight.x = bb1.x;
+        if( p1.x > bb1.x )
+            bb1.x = p1.x;
 
-        if( bb1.y > mTopRight.y )
-            mTopRight.y = bb1.y;
+        if( p1.y > bb1.y )
+            bb1.y = p1.y;
 
         ++sSeg;
     }
 
-    mBBisOK = true;
-    adjustBoundingBox();
+    return true;
+}
+
+
+void MCAD_OUTLINE::pushCutout( MCAD_OUTLINE* aCutout )
+{
+    MCAD_POINT bb0;
+    MCAD_POINT bb1;
+
+    mcutouts.push_back( aCutout );
+    aCutout->getExtent( bb0, bb1 );
+    mCutoutLeaves.push_back( mCutoutTree.Insert( bb0, bb1, mCutoutItems.size() ) );
+    mCutoutItems.push_back( aCutout );
+    return;
+}
+
+
+void MCAD_OUTLINE::findCutouts( MCAD_POINT bb0, MCAD_POINT bb1, std::vector<size_t>& aList )
+{
+    aList.clear();
+
+    // intersections are accepted within a small tolerance so the
+    // region is expanded by a much larger margin to be safe
+    double tol = 1e-6 * ( 1.0 + max( bb1.x - bb0.x, bb1.y - bb0.y ) );
+    bb0.x -= tol;
+    bb0.y -= tol;
+    bb1.x += tol;
+    bb1.y += tol;
+
+    mCutoutTree.Query( bb0, bb1, aList );
+    sort( aList.begin(), aList.end() );
+    return;
+}
+
+
+void MCAD_OUTLINE::updateCutout( size_t aIndex )
+{
+    MCAD_POINT bb0;
+    MCAD_POINT bb1;
+
+    if( mCutoutItems[aIndex]->getExtent( bb0, bb1 ) )
+        mCutoutTree.Update( mCutoutLeaves[aIndex], bb0, bb1 );
+
     return;
 }
 
@@ -2232,7 +2913,7 @@ std::list<MCAD_SEGMENT*>* MCAD_OUTLINE::GetSegments( void )
 }
 
 
-std::list<MCAD_OUTLINE*>* MCAD_OUTLINE::GetCutouts( void )
+const std::list<MCAD_OUTLINE*>* MCAD_OUTLINE::GetCutouts( void )
 {
     return &mcutouts;
 }
@@ -27,13 +27,152 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <new>
+
+#if defined( __AVX__ )
+    #include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+    #include <emmintrin.h>
+    #define MCAD_SEGMENT_SSE2
+#endif
+
 #include <error_macros.h>
 #include <geom/mcad_segment.h>
 #include <geom/mcad_helpers.h>
 
 using namespace std;
 
+// number of segments in each block of a segment pool
+#define SEGPOOL_BLOCK ( 64 )
+
+// Each segment allocated via MCAD_SEGMENT::operator new is preceded by
+// a header which identifies the pool block holding it; the block is NULL
+// if the segment was allocated from the heap. The size of the header
+// preserves the alignment of the segment.
+union SEGPOOL_HEADER
+{
+    MCAD_SEGPOOL_BLOCK* block;
+    double align[2];
+};
+
+// A block of segment slots; the slots follow the block in memory. The
+// block holds a reference for each segment which has not been deleted
+// and one for the pool while the pool hands out its slots.
+struct MCAD_SEGPOOL_BLOCK
+{
+    std::atomic<size_t> nRefs;
+    size_t nUsed;               // number of slots handed out
+};
+
+// size of a slot and offset of the first slot within a block
+#define SEGPOOL_ALIGN( n ) ( ( (n) + sizeof( SEGPOOL_HEADER ) - 1 ) \
+    / sizeof( SEGPOOL_HEADER ) * sizeof( SEGPOOL_HEADER ) )
+#define SEGPOOL_SLOT SEGPOOL_ALIGN( sizeof( SEGPOOL_HEADER ) + sizeof( MCAD_SEGMENT ) )
+#define SEGPOOL_FIRST SEGPOOL_ALIGN( sizeof( MCAD_SEGPOOL_BLOCK ) )
+
+// the segment pool which is active on each thread
+static thread_local MCAD_SEGPOOL* s_activePool = NULL;
+
+
+static void releaseBlock( MCAD_SEGPOOL_BLOCK* aBlock )
+{
+    if( 1 != aBlock->nRefs.fetch_sub( 1, std::memory_order_acq_rel ) )
+        return;
+
+    aBlock->~MCAD_SEGPOOL_BLOCK();
+    ::operator delete( aBlock );
+    return;
+}
+
+
+MCAD_SEGPOOL::MCAD_SEGPOOL()
+{
+    m_block = NULL;
+    return;
+}
+
+
+MCAD_SEGPOOL::~MCAD_SEGPOOL()
+{
+    if( NULL != m_block )
+        releaseBlock( m_block );
+
+    return;
+}
+
+
+void* MCAD_SEGPOOL::alloc( void )
+{
+    if( NULL == m_block || SEGPOOL_BLOCK == m_block->nUsed )
+    {
+        if( NULL != m_block )
+            releaseBlock( m_block );
+
+        void* mem = ::operator new( SEGPOOL_FIRST + SEGPOOL_BLOCK * SEGPOOL_SLOT );
+        m_block = new( mem ) MCAD_SEGPOOL_BLOCK;
+        m_block->nRefs.store( 1, std::memory_order_relaxed );
+        m_block->nUsed = 0;
+    }
+
+    SEGPOOL_HEADER* hp = (SEGPOOL_HEADER*)( (char*)m_block + SEGPOOL_FIRST
+        + SEGPOOL_SLOT * m_block->nUsed++ );
+    hp->block = m_block;
+    m_block->nRefs.fetch_add( 1, std::memory_order_relaxed );
+    return hp;
+}
+
+
+MCAD_SEGPOOL_SCOPE::MCAD_SEGPOOL_SCOPE( MCAD_SEGPOOL* aPool )
+{
+    m_prev = s_activePool;
+    s_activePool = aPool;
+    return;
+}
+
+
+MCAD_SEGPOOL_SCOPE::~MCAD_SEGPOOL_SCOPE()
+{
+    s_activePool = m_prev;
+    return;
+}
+
+
+void* MCAD_SEGMENT::operator new( size_t aSize )
+{
+    SEGPOOL_HEADER* hp;
+
+    if( NULL != s_activePool && sizeof( MCAD_SEGMENT ) == aSize )
+    {
+        hp = (SEGPOOL_HEADER*)s_activePool->alloc();
+    }
+    else
+    {
+        hp = (SEGPOOL_HEADER*)::operator new( sizeof( SEGPOOL_HEADER ) + aSize );
+        hp->block = NULL;
+    }
+
+    return hp + 1;
+}
+
+
+void MCAD_SEGMENT::operator delete( void* aSegment )
+{
+    if( NULL == aSegment )
+        return;
+
+    SEGPOOL_HEADER* hp = (SEGPOOL_HEADER*)aSegment - 1;
+
+    if( NULL == hp->block )
+        ::operator delete( hp );
+    else
+        releaseBlock( hp->block );
+
+    return;
+}
+
 
 // ensure the start angle a0 is in the range -M_PI < a0 <= +M_PI
 // a0, a1 = start, end angle (must ensure CCW order)
@@ -2021,3 +2160,362 @@ bool MCAD_SEGMENT::splitCircle( std::list<MCAD_POINT>& aIntersectList,
 
     return true;
 }
+
+
+// Operations on a vector of doubles used by the batched intersection
+// tests; the comparisons return a bit mask with bit N set if the
+// comparison is true for element N.
+#if defined( __AVX__ )
+
+#define SEG_LANES ( 4 )
+typedef __m256d SEG_VD;
+
+static inline SEG_VD vLoad( const double* p ) { return _mm256_loadu_pd( p ); }
+static inline void vStore( double* p, SEG_VD a ) { _mm256_storeu_pd( p, a ); }
+static inline SEG_VD vSet( double a ) { return _mm256_set1_pd( a ); }
+static inline SEG_VD vAdd( SEG_VD a, SEG_VD b ) { return _mm256_add_pd( a, b ); }
+static inline SEG_VD vSub( SEG_VD a, SEG_VD b ) { return _mm256_sub_pd( a, b ); }
+static inline SEG_VD vMul( SEG_VD a, SEG_VD b ) { return _mm256_mul_pd( a, b ); }
+static inline SEG_VD vDiv( SEG_VD a, SEG_VD b ) { return _mm256_div_pd( a, b ); }
+static inline SEG_VD vSqrt( SEG_VD a ) { return _mm256_sqrt_pd( a ); }
+static inline SEG_VD vAbs( SEG_VD a ) { return _mm256_andnot_pd( _mm256_set1_pd( -0.0 ), a ); }
+static inline int vGT( SEG_VD a, SEG_VD b ) { return _mm256_movemask_pd( _mm256_cmp_pd( a, b, _CMP_GT_OQ ) ); }
+static inline int vLT( SEG_VD a, SEG_VD b ) { return _mm256_movemask_pd( _mm256_cmp_pd( a, b, _CMP_LT_OQ ) ); }
+
+#elif defined( MCAD_SEGMENT_SSE2 )
+
+#define SEG_LANES ( 2 )
+typedef __m128d SEG_VD;
+
+static inline SEG_VD vLoad( const double* p ) { return _mm_loadu_pd( p ); }
+static inline void vStore( double* p, SEG_VD a ) { _mm_storeu_pd( p, a ); }
+static inline SEG_VD vSet( double a ) { return _mm_set1_pd( a ); }
+static inline SEG_VD vAdd( SEG_VD a, SEG_VD b ) { return _mm_add_pd( a, b ); }
+static inline SEG_VD vSub( SEG_VD a, SEG_VD b ) { return _mm_sub_pd( a, b ); }
+static inline SEG_VD vMul( SEG_VD a, SEG_VD b ) { return _mm_mul_pd( a, b ); }
+static inline SEG_VD vDiv( SEG_VD a, SEG_VD b ) { return _mm_div_pd( a, b ); }
+static inline SEG_VD vSqrt( SEG_VD a ) { return _mm_sqrt_pd( a ); }
+static inline SEG_VD vAbs( SEG_VD a ) { return _mm_andnot_pd( _mm_set1_pd( -0.0 ), a ); }
+static inline int vGT( SEG_VD a, SEG_VD b ) { return _mm_movemask_pd( _mm_cmpgt_pd( a, b ) ); }
+static inline int vLT( SEG_VD a, SEG_VD b ) { return _mm_movemask_pd( _mm_cmplt_pd( a, b ) ); }
+
+#else
+
+#define SEG_LANES ( 1 )
+typedef double SEG_VD;
+
+static inline SEG_VD vLoad( const double* p ) { return *p; }
+static inline void vStore( double* p, SEG_VD a ) { *p = a; }
+static inline SEG_VD vSet( double a ) { return a; }
+static inline SEG_VD vAdd( SEG_VD a, SEG_VD b ) { return a + b; }
+static inline SEG_VD vSub( SEG_VD a, SEG_VD b ) { return a - b; }
+static inline SEG_VD vMul( SEG_VD a, SEG_VD b ) { return a * b; }
+static inline SEG_VD vDiv( SEG_VD a, SEG_VD b ) { return a / b; }
+static inline SEG_VD vSqrt( SEG_VD a ) { return sqrt( a ); }
+static inline SEG_VD vAbs( SEG_VD a ) { return abs( a ); }
+static inline int vGT( SEG_VD a, SEG_VD b ) { return a > b ? 1 : 0; }
+static inline int vLT( SEG_VD a, SEG_VD b ) { return a < b ? 1 : 0; }
+
+#endif
+
+
+// record the result of testing one member of a block
+static void addHit( size_t aIndex, bool aResult, MCAD_INTERSECT_FLAG aFlag,
+                    std::list<MCAD_POINT>& aPoints, std::vector<MCAD_SEGHIT>& aHitList,
+                    std::vector<MCAD_POINT>& aPointList )
+{
+    if( !aResult && MCAD_IFLAG_NONE == aFlag )
+        return;
+
+    MCAD_SEGHIT hit;
+    hit.index = aIndex;
+    hit.flags = aFlag;
+    hit.intersects = aResult;
+    hit.firstPoint = aPointList.size();
+    hit.nPoints = aPoints.size();
+    aPointList.insert( aPointList.end(), aPoints.begin(), aPoints.end() );
+    aHitList.push_back( hit );
+    return;
+}
+
+
+static bool lessHitIndex( const MCAD_SEGHIT& a, const MCAD_SEGHIT& b )
+{
+    return a.index < b.index;
+}
+
+
+bool MCAD_SEGMENT::GetIntersections( const MCAD_SEGBLOCK& aBlock,
+                                     std::vector<MCAD_SEGHIT>& aHitList,
+                                     std::vector<MCAD_POINT>& aPointList )
+{
+    if( MCAD_SEGTYPE_NONE == msegtype )
+    {
+        ERRMSG << "\n + [ERROR] no data in segment\n";
+        return false;
+    }
+
+    size_t nHits = aHitList.size();
+    std::list<MCAD_POINT> iList;
+    MCAD_INTERSECT_FLAG flag;
+    bool res;
+
+    // the members which are not handled by a vectorized test
+    const std::vector< size_t >* scalarList[3] = { &aBlock.mAIdx, NULL, NULL };
+    int nScalar = 1;
+
+    if( MCAD_SEGTYPE_LINE == msegtype )
+    {
+        scalarList[nScalar++] = &aBlock.mCIdx;
+
+        // line/line: this is the calculation of checkLines() for the case
+        // where the lines are not parallel; the parallel case is rare and
+        // is passed to checkLines()
+        double XA1 = mend.x - mstart.x;
+        double YA1 = mend.y - mstart.y;
+        double XB1 = mstart.x;
+        double YB1 = mstart.y;
+        bool useY = abs( XA1 ) < abs( YA1 );
+        SEG_VD vXA1 = vSet( XA1 );
+        SEG_VD vYA1 = vSet( YA1 );
+        SEG_VD vXB1 = vSet( XB1 );
+        SEG_VD vYB1 = vSet( YB1 );
+        SEG_VD vTmin = vSet( -1e-8 );
+        SEG_VD vTmax = vSet( 1 + 1e-8 );
+        SEG_VD vTol = vSet( 1e-6 );
+        double t1v[SEG_LANES];
+        double t2v[SEG_LANES];
+        size_t nl = aBlock.mLIdx.size();
+
+        for( size_t i = 0; i < nl; i += SEG_LANES )
+        {
+            int nLanes = SEG_LANES;
+            int parallel = 0;
+            int inside = 0;
+
+            if( i + SEG_LANES <= nl )
+            {
+                SEG_VD XB2 = vLoad( &aBlock.mLX0[i] );
+                SEG_VD YB2 = vLoad( &aBlock.mLY0[i] );
+                SEG_VD XA2 = vSub( vLoad( &aBlock.mLX1[i] ), XB2 );
+                SEG_VD YA2 = vSub( vLoad( &aBlock.mLY1[i] ), YB2 );
+                SEG_VD num = vSub( vMul( vXA1, vSub( YB2, vYB1 ) ), vMul( vYA1, vSub( XB2, vXB1 ) ) );
+                SEG_VD den = vSub( vMul( XA2, vYA1 ), vMul( YA2, vXA1 ) );
+                SEG_VD t2 = vDiv( num, den );
+                SEG_VD t1;
+
+                if( useY )
+                    t1 = vDiv( vSub( vAdd( vMul( t2, YA2 ), YB2 ), vYB1 ), vYA1 );
+                else
+                    t1 = vDiv( vSub( vAdd( vMul( t2, XA2 ), XB2 ), vXB1 ), vXA1 );
+
+                parallel = vLT( vAbs( den ), vTol );
+                inside = vGT( t2, vTmin ) & vLT( t2, vTmax ) & vGT( t1, vTmin ) & vLT( t1, vTmax );
+                inside &= ~parallel;
+                vStore( t1v, t1 );
+                vStore( t2v, t2 );
+            }
+            else
+            {
+                // the remaining members are tested individually
+                nLanes = (int)( nl - i );
+                parallel = ( 1 << nLanes ) - 1;
+            }
+
+            for( int k = 0; k < nLanes; ++k )
+            {
+                size_t idx = aBlock.mLIdx[i + k];
+
+                if( parallel & ( 1 << k ) )
+                {
+                    iList.clear();
+                    flag = MCAD_IFLAG_NONE;
+                    res = checkLines( *aBlock.mSegments[idx], iList, flag );
+                    addHit( idx, res, flag, iList, aHitList, aPointList );
+                    continue;
+                }
+
+                if( !( inside & ( 1 << k ) ) )
+                    continue;
+
+                double t1 = t1v[k];
+                double t2 = t2v[k];
+                MCAD_POINT p0 = aBlock.mSegments[idx]->GetStart();
+                p0.x = t2 * ( aBlock.mLX1[i + k] - aBlock.mLX0[i + k] ) + aBlock.mLX0[i + k];
+                p0.y = t2 * ( aBlock.mLY1[i + k] - aBlock.mLY0[i + k] ) + aBlock.mLY0[i + k];
+
+                flag = MCAD_IFLAG_NONE;
+
+                if( abs( t1 ) < 1e-8 || abs( t1 - 1.0 ) < 1e-8
+                    || abs( t2 ) < 1e-8 || abs( t2 - 1.0 ) < 1e-8 )
+                    flag = MCAD_IFLAG_ENDPOINT;
+
+                iList.clear();
+                iList.push_back( p0 );
+                addHit( idx, true, flag, iList, aHitList, aPointList );
+            }
+        }
+    }
+    else if( MCAD_SEGTYPE_CIRCLE == msegtype )
+    {
+        scalarList[nScalar++] = &aBlock.mLIdx;
+
+        // circle/circle: most pairs are rejected by the first test of
+        // checkCircles(); the remaining pairs are passed to checkCircles()
+        SEG_VD vCX = vSet( mcenter.x );
+        SEG_VD vCY = vSet( mcenter.y );
+        SEG_VD vR = vSet( mradius );
+        size_t nc = aBlock.mCIdx.size();
+
+        for( size_t i = 0; i < nc; i += SEG_LANES )
+        {
+            int nLanes = SEG_LANES;
+            int apart = 0;
+
+            if( i + SEG_LANES <= nc )
+            {
+                SEG_VD dx = vSub( vCX, vLoad( &aBlock.mCX[i] ) );
+                SEG_VD dy = vSub( vCY, vLoad( &aBlock.mCY[i] ) );
+                SEG_VD d = vSqrt( vAdd( vMul( dx, dx ), vMul( dy, dy ) ) );
+                apart = vGT( d, vAdd( vR, vLoad( &aBlock.mCR[i] ) ) );
+            }
+            else
+            {
+                nLanes = (int)( nc - i );
+            }
+
+            for( int k = 0; k < nLanes; ++k )
+            {
+                if( apart & ( 1 << k ) )
+                    continue;
+
+                size_t idx = aBlock.mCIdx[i + k];
+                iList.clear();
+                flag = MCAD_IFLAG_NONE;
+                res = checkCircles( *aBlock.mSegments[idx], iList, flag );
+                addHit( idx, res, flag, iList, aHitList, aPointList );
+            }
+        }
+    }
+    else
+    {
+        scalarList[nScalar++] = &aBlock.mLIdx;
+        scalarList[nScalar++] = &aBlock.mCIdx;
+    }
+
+    for( int j = 0; j < nScalar; ++j )
+    {
+        const std::vector< size_t >& sl = *scalarList[j];
+
+        for( size_t i = 0; i < sl.size(); ++i )
+        {
+            iList.clear();
+            res = GetIntersections( *aBlock.mSegments[sl[i]], iList, flag );
+            addHit( sl[i], res, flag, iList, aHitList, aPointList );
+        }
+    }
+
+    std::sort( aHitList.begin() + nHits, aHitList.end(), lessHitIndex );
+
+    for( size_t i = nHits; i < aHitList.size(); ++i )
+    {
+        if( aHitList[i].intersects )
+            return true;
+    }
+
+    return false;
+}
+
+
+void MCAD_SEGBLOCK::Clear( void )
+{
+    mSegments.clear();
+    mLX0.clear();
+    mLY0.clear();
+    mLX1.clear();
+    mLY1.clear();
+    mLIdx.clear();
+    mCX.clear();
+    mCY.clear();
+    mCR.clear();
+    mCIdx.clear();
+    mAIdx.clear();
+    return;
+}
+
+
+void MCAD_SEGBLOCK::Reserve( size_t aSize )
+{
+    mSegments.reserve( aSize );
+    mLX0.reserve( aSize );
+    mLY0.reserve( aSize );
+    mLX1.reserve( aSize );
+    mLY1.reserve( aSize );
+    mLIdx.reserve( aSize );
+    mCX.reserve( aSize );
+    mCY.reserve( aSize );
+    mCR.reserve( aSize );
+    mCIdx.reserve( aSize );
+    return;
+}
+
+
+size_t MCAD_SEGBLOCK::Size( void ) const
+{
+    return mSegments.size();
+}
+
+
+bool MCAD_SEGBLOCK::Add( const MCAD_SEGMENT* aSegment )
+{
+    if( NULL == aSegment )
+        return false;
+
+    size_t idx = mSegments.size();
+
+    switch( aSegment->GetSegType() )
+    {
+        case MCAD_SEGTYPE_LINE:
+            do
+            {
+                MCAD_POINT p0 = aSegment->GetStart();
+                MCAD_POINT p1 = aSegment->GetEnd();
+                mLX0.push_back( p0.x );
+                mLY0.push_back( p0.y );
+                mLX1.push_back( p1.x );
+                mLY1.push_back( p1.y );
+                mLIdx.push_back( idx );
+            } while( 0 );
+            break;
+
+        case MCAD_SEGTYPE_CIRCLE:
+            do
+            {
+                MCAD_POINT c = aSegment->GetCenter();
+                mCX.push_back( c.x );
+                mCY.push_back( c.y );
+                mCR.push_back( aSegment->GetRadius() );
+                mCIdx.push_back( idx );
+            } while( 0 );
+            break;
+
+        case MCAD_SEGTYPE_ARC:
+            mAIdx.push_back( idx );
+            break;
+
+        default:
+            return false;
+    }
+
+    mSegments.push_back( aSegment );
+    return true;
+}
+
+
+const MCAD_SEGMENT* MCAD_SEGBLOCK::GetSegment( size_t aIndex ) const
+{
+    if( aIndex >= mSegments.size() )
+        return NULL;
+
+    return mSegments[aIndex];
+}
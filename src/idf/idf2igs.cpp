@@ -39,16 +39,19 @@
 #include <list>
 #include <utility>
 #include <clocale>
+#include <cstring>
 #include <vector>
 
 #include <idf_helpers.h>
 #include <idf_common.h>
 #include <idf_parser.h>
+#include <idf_drills.h>
 
 #include <error_macros.h>
 #include <api/dll_iges.h>
 #include <geom/geom_wall.h>
 #include <geom/geom_cylinder.h>
+#include <geom/mcad_outline.h>
 #include <api/dll_mcad_segment.h>
 #include <api/dll_iges_geom_pcb.h>
 #include <api/all_api_entities.h>
@@ -69,6 +72,7 @@ static struct
 {
     string basename;
     IGES_ENTITY_314* colors[NCOLORS];
+    bool instanceDrills;    // render drill holes as instances of shared barrels
 } globs;
 
 bool initColors( DLL_IGES& model, IGES_ENTITY_314** colors );
@@ -76,15 +80,6 @@ bool initColors( DLL_IGES& model, IGES_ENTITY_314** colors );
 // convert IDF outline to IGS outline
 bool convertOln( MCAD_OUTLINE* olnIGS, IDF_OUTLINE* olnIDF );
 bool convertDrills( list< MCAD_SEGMENT* >& drills, const list< IDF_DRILL_DATA* >* dh );
-// merge overlapping drills into cutouts; return true if any drills were merged;
-// if invalid geometry was encountered the error flag will be set
-bool mergeDrills( list< MCAD_SEGMENT* >& drills, list< MCAD_OUTLINE* >& cutouts, bool& error );
-// take given drill list and punch a cutout using nearest holes in succession
-bool bundleDrills( list< MCAD_SEGMENT* >* drills, list< MCAD_OUTLINE* >& cutouts );
-// delete drill data
-void killDrills( list< MCAD_SEGMENT* >& drills );
-// delete cutout data
-void killCutouts( list< MCAD_OUTLINE* >& cutouts );
 
 bool MakeBoard( IDF3_BOARD& board, DLL_IGES& model );
 bool MakeComponents( IDF3_BOARD& board, DLL_IGES& model );
@@ -102,13 +97,23 @@ int GetComponentColor( void );
 
 void PrintUsage( void )
 {
-    cerr << "-\nUsage: idfigs input_file.emn\n";
+    cerr << "-\nUsage: idfigs [-i] input_file.emn\n";
+    cerr << "   -i: render each drill size once and place the drill holes as instances\n";
     return;
 }
 
 
 int main( int argc, char **argv )
 {
+    globs.instanceDrills = false;
+
+    if( argc == 3 && !strcmp( argv[1], "-i" ) )
+    {
+        globs.instanceDrills = true;
+        --argc;
+        ++argv;
+    }
+
     if( argc != 2 )
     {
         PrintUsage();
@@ -177,6 +182,16 @@ int main( int argc, char **argv )
     // STEP 3: Render the OTHER outlines
     MakeOtherOutlines( pcb, model );
 
+    // STEP 4: Merge duplicate transforms, colors and curves
+    IGES_DEDUP_STATS dstats;
+
+    if( model.Deduplicate( &dstats ) )
+    {
+        cerr << "Merged " << dstats.nTransforms << " transforms, ";
+        cerr << dstats.nColors << " colors and " << dstats.nCurves << " curves; ";
+        cerr << "entities: " << dstats.nEntitiesIn << " -> " << dstats.nEntitiesOut << "\n";
+    }
+
     model.Write( fname.c_str(), true );
 
     return 0;
@@ -264,67 +279,51 @@ bool MakeBoard( IDF3_BOARD& board, DLL_IGES& model )
         return false;
     }
 
-    // subtract drill holes from PCB edge
-    list< MCAD_SEGMENT* >::iterator sDH;
-    list< MCAD_SEGMENT* >::iterator eDH;
+    // merge drill holes with the cutouts; the drills are held in an array
+    // which is compacted by each operation to the drills not yet used
+    vector< MCAD_SEGMENT* > dv( drills.begin(), drills.end() );
+    int nDrills = (int)dv.size();
+    drills.clear();
 
-    sDH = drills.begin();
-    eDH = drills.end();
+    list< MCAD_OUTLINE* >::iterator sMO = cutouts.begin();
+    list< MCAD_OUTLINE* >::iterator eMO = cutouts.end();
+    DLL_MCAD_OUTLINE mO( false );
 
-    while( sDH != eDH )
+    while( sMO != eMO && nDrills > 0 )
     {
-        if( otln.SubOutline( *sDH , dud ) )
-        {
-            sDH = drills.erase( sDH );
-            continue;
-        }
+        mO.Attach( *sMO );
+        mO.AddOutlines( &dv[0], nDrills, dud );
+        mO.Detach();
 
         if( dud )
         {
-            ERROR_IDF << "\n + fatal error encountered while attempting to add drill hole to main outline\n";
+            ERROR_IDF << "\n + fatal error encountered while attempting to add drill hole to cutout\n";
+            drills.insert( drills.end(), dv.begin(), dv.begin() + nDrills );
             killDrills( drills );
             killCutouts( cutouts );
             return false;
         }
 
-        ++sDH;
+        ++sMO;
     }
 
-    // add drill holes to outline edges
-    list< MCAD_OUTLINE* >::iterator sMO = cutouts.begin();
-    list< MCAD_OUTLINE* >::iterator eMO = cutouts.end();
-    DLL_MCAD_OUTLINE mO( false );
-
-    while( sMO != eMO )
+    // subtract drill holes from PCB edge; all remaining drills
+    // become holes within the main outline
+    if( nDrills > 0 )
     {
-        sDH = drills.begin();
-        eDH = drills.end();
-        mO.Attach( *sMO );
+        otln.SubOutlines( &dv[0], nDrills, dud );
 
-        while( sDH != eDH )
+        if( dud )
         {
-            if( mO.AddOutline( *sDH , dud ) )
-            {
-                sDH = drills.erase( sDH );
-                continue;
-            }
-
-            if( dud )
-            {
-                ERROR_IDF << "\n + fatal error encountered while attempting to add drill hole to cutout\n";
-                killDrills( drills );
-                killCutouts( cutouts );
-                return false;
-            }
-
-            ++sDH;
+            ERROR_IDF << "\n + fatal error encountered while attempting to add drill hole to main outline\n";
+            drills.insert( drills.end(), dv.begin(), dv.begin() + nDrills );
+            killDrills( drills );
+            killCutouts( cutouts );
+            return false;
         }
-
-        mO.Detach();
-        ++sMO;
     }
 
-    // add all cutouts and remaining drills to the main outline
+    // add all cutouts to the main outline
     sMO = cutouts.begin();
     eMO = cutouts.end();
 
@@ -334,21 +333,30 @@ bool MakeBoard( IDF3_BOARD& board, DLL_IGES& model )
         ++sMO;
     }
 
-    sDH = drills.begin();
-    eDH = drills.end();
+    // merge collinear lines and co-circular arcs; this is also done
+    // when the surfaces are created but is done here to report savings
+    MCAD_SIMPLIFY_STATS sstats;
 
-    while( sDH != eDH )
+    if( otln.Simplify( 1e-8, dud, &sstats ) )
     {
-        otln.AddCutout( *sDH, false, dud );
-        ++sDH;
+        cerr << "Simplified board outline: merged " << sstats.nLines << " lines and ";
+        cerr << sstats.nArcs << " arcs; segments: " << sstats.nSegmentsIn;
+        cerr << " -> " << sstats.nSegmentsOut << "\n";
     }
 
     // put in part and solid instance, names, and color
     // create the PCB model
     IGES_ENTITY_144** surfs = NULL;
     int nSurfs = 0;
+    IGES_ENTITY_408** holes = NULL;
+    int nHoles = 0;
     double th = 0.5 * board.GetBoardThickness();
-    otln.GetVerticalSurface( model.GetRawPtr(), dud, surfs, nSurfs, th, -th );
+
+    if( globs.instanceDrills )
+        otln.GetVerticalSurface( model.GetRawPtr(), dud, surfs, nSurfs, holes, nHoles, th, -th );
+    else
+        otln.GetVerticalSurface( model.GetRawPtr(), dud, surfs, nSurfs, th, -th );
+
     otln.GetTrimmedPlane( model.GetRawPtr(), dud, surfs, nSurfs, th, false );
     otln.GetTrimmedPlane( model.GetRawPtr(), dud, surfs, nSurfs, -th, true );
     otln.Detach();
@@ -359,6 +367,7 @@ bool MakeBoard( IDF3_BOARD& board, DLL_IGES& model )
     {
         ERROR_IDF << "\n + could not create a subfigure entity\n";
         delete [] surfs;
+        delete [] holes;
         return false;
     }
 
@@ -374,6 +383,20 @@ bool MakeBoard( IDF3_BOARD& board, DLL_IGES& model )
         e308.AddDE( (IGES_ENTITY *)surfs[i] );
     }
 
+    delete [] surfs;
+
+    DLL_IGES_ENTITY_408 eHole( model, false );
+
+    for( int i = 0; i < nHoles; ++i )
+    {
+        eHole.Attach( (IGES_ENTITY*)holes[i] );
+        eHole.SetColor( (IGES_ENTITY*) globs.colors[0] );
+        eHole.Detach();
+        e308.AddDE( (IGES_ENTITY *)holes[i] );
+    }
+
+    delete [] holes;
+
     // add the name
     #ifdef ENABLE_TYPE_406
     DLL_IGES_ENTITY_406 e406( model, true );
@@ -515,277 +538,6 @@ bool convertDrills( list< MCAD_SEGMENT* >& drills, const list<IDF_DRILL_DATA*>*
 }
 
 
-// merge overlapping drills into cutouts; return true if any drills were merged;
-// if invalid geometry was encountered the error flag will be set
-bool mergeDrills( list< MCAD_SEGMENT* >& drills, list< MCAD_OUTLINE* >& cutouts, bool& error )
-{
-    error = false;
-
-    if( drills.empty() )
-        return false;
-
-    list< MCAD_SEGMENT* >::iterator sD = drills.begin();
-    list< MCAD_SEGMENT* >::iterator eD = drills.end();
-    list< MCAD_SEGMENT* >::iterator iD;
-    MCAD_POINT* ilist = NULL;
-    int nPoints = 0;
-    MCAD_INTERSECT_FLAG flag = MCAD_IFLAG_NONE;
-
-#define CLEAR_ILIST() do {\
-    if( NULL != ilist ) delete [] ilist; \
-    ilist = NULL; \
-    nPoints = 0; } while( 0 )
-
-    list< list< MCAD_SEGMENT* >* >bundles;
-    list< MCAD_SEGMENT* >* sp;
-
-    DLL_MCAD_SEGMENT seg0( false );
-    DLL_MCAD_SEGMENT seg1( false );
-    DLL_MCAD_SEGMENT seg2( false );
-
-    while( sD != eD )
-    {
-        seg2.Attach( *sD );
-        iD = sD;
-        ++iD;
-
-        bool skip = false;
-
-        while( iD != eD )
-        {
-            if( seg2.GetIntersections( *iD, ilist, nPoints, flag ) )
-            {
-                skip = true;
-                CLEAR_ILIST();
-                sp = new list< MCAD_SEGMENT* >;
-                bundles.push_back( sp );
-                sp->push_back( *sD );
-                sp->push_back( *iD );
-
-                drills.erase( iD );
-                sD = drills.erase( sD );
-
-                // search for all overlapping holes
-                list< MCAD_SEGMENT* >::iterator sS = sp->begin();
-                list< MCAD_SEGMENT* >::iterator eS = sp->end();
-                list< MCAD_SEGMENT* >::iterator sD1;
-                list< MCAD_SEGMENT* >::iterator eD1;
-
-                // find every drill which overlaps with each drill in
-                // the list; this may result in an incredible number of
-                // permutations but is necessary to ensure that overlapping
-                // drill holes do not generate invalid geometry.
-                while( sS != eS )
-                {
-                    sD1 = drills.begin();
-                    eD1 = drills.end();
-                    seg0.Attach( *sS );
-
-                    while( sD1 != eD1 )
-                    {
-                        seg1.Attach( *sD1 );
-
-                        if( seg0.GetIntersections( seg1, ilist, nPoints, flag ) )
-                        {
-                            CLEAR_ILIST();
-
-                            sp->push_back( *sD1 );
-
-                            if( sD == sD1 )
-                            {
-                                sD1 = drills.erase( sD1 );
-                                sD = sD1;
-                            }
-                            else
-                            {
-                                sD1 = drills.erase( sD1 );
-                            }
-
-                            seg1.Detach();
-                            continue;
-                        }
-
-                        seg1.Detach();
-
-                        if( flag )
-                        {
-                            ERROR_IDF << "\n + [INFO] geometry error (flag = " << flag << ")\n";
-                            seg0.Detach();
-                            seg2.Detach();
-                            return false;
-                        }
-
-                        ++sD1;
-                    }
-
-                    seg0.Detach();
-                    ++sS;
-                }
-
-                iD = sD;
-                continue;
-            }
-
-            if( flag )
-            {
-                seg2.Detach();
-                ERROR_IDF << "\n + [INFO] geometry error (flag = " << flag << ")\n";
-                return false;
-            }
-
-            ++iD;
-        }
-
-        seg2.Detach();
-
-        if( skip )
-            continue;
-
-        ++sD;
-    }
-
-    if( bundles.empty() )
-        return false;
-
-    // create outlines from each 'bundle'
-    list< list< MCAD_SEGMENT* >* >::iterator sB = bundles.begin();
-    list< list< MCAD_SEGMENT* >* >::iterator eB = bundles.end();
-
-    while( sB != eB )
-    {
-        if( !bundleDrills( *sB, cutouts ) )
-        {
-            ERROR_IDF << "\n + [INFO] problems encountered while merging drill holes\n";
-            return false;
-        }
-
-        ++sB;
-    }
-
-    return true;
-}
-
-
-// take given drill list and punch a cutout using nearest holes in succession
-bool bundleDrills( list< MCAD_SEGMENT* >* drills, list< MCAD_OUTLINE* >& cutouts )
-{
-    vector< pair<double, MCAD_SEGMENT*> > dist; // distance of each from first drill
-    list< MCAD_SEGMENT* >::iterator sD = drills->begin();
-    list< MCAD_SEGMENT* >::iterator eD = drills->end();
-    ++sD;
-
-    MCAD_POINT p0;
-    MCAD_POINT p1;
-    double dx;
-    double dy;
-    double r0;
-    double r1;
-    double r2;
-
-    DLL_MCAD_SEGMENT seg0( false );
-    seg0.Attach( drills->front() );
-    seg0.GetCenter( p0 );
-    seg0.GetRadius( r0 );
-    seg0.Detach();
-
-    // calculate [distance - (R0 + R1)] between each drill hole
-    while( sD != eD )
-    {
-        seg0.Attach( *sD );
-        seg0.GetCenter( p1 );
-        seg0.GetRadius( r1 );
-        seg0.Detach();
-
-        r2 = r0 + r1;
-        dx = p1.x - p0.x;
-        dy = p1.y - p0.y;
-        dx = dx*dx + dy*dy;
-        dx = sqrt( dx );
-        dx -= r2;
-        dist.push_back( pair<double, MCAD_SEGMENT*>( dx, *sD ) );
-        ++sD;
-    }
-
-    // sort according to distances
-    size_t nd = dist.size();
-    pair<double, MCAD_SEGMENT*> tdrill;
-
-    for( size_t i = 0; i < nd -1; ++i )
-    {
-        for( size_t j = i + 1; j < nd; ++j )
-        {
-            if( dist[j].first < dist[i].first )
-            {
-                tdrill = dist[i];
-                dist[i] = dist[j];
-                dist[j] = tdrill;
-            }
-        }
-    }
-
-    DLL_MCAD_OUTLINE op( true );
-    bool dud = false;
-    op.AddSegment( drills->front(), dud );
-    cutouts.push_back( op.GetRawPtr() );
-
-    for( size_t i = 0; i < nd; ++i )
-    {
-        if( !op.AddOutline( dist[i].second, dud ) )
-        {
-            ERROR_IDF << "\n + [INFO] could not merge drill holes\n";
-            return false;
-        }
-    }
-
-    op.Detach();
-    drills->clear();
-    return true;
-}
-
-
-// delete drill data
-void killDrills( list< MCAD_SEGMENT* >& drills )
-{
-    if( drills.empty() )
-        return;
-
-    list< MCAD_SEGMENT* >::iterator sD = drills.begin();
-    list< MCAD_SEGMENT* >::iterator eD = drills.end();
-    DLL_MCAD_SEGMENT seg0( false );
-
-    while( sD != eD )
-    {
-        seg0.Attach( *sD );
-        seg0.DelSegment();
-        ++sD;
-    }
-
-    drills.clear();
-    return;
-}
-
-// delete cutout data
-void killCutouts( list< MCAD_OUTLINE* >& cutouts )
-{
-    if( cutouts.empty() )
-        return;
-
-    list< MCAD_OUTLINE* >::iterator sO = cutouts.begin();
-    list< MCAD_OUTLINE* >::iterator eO = cutouts.end();
-    DLL_MCAD_OUTLINE out0( false );
-
-    while( sO != eO )
-    {
-        out0.Attach( *sO );
-        out0.DelOutline();
-        ++sO;
-    }
-
-    cutouts.clear();
-    return;
-}
-
-
 bool initColors( DLL_IGES& model, IGES_ENTITY_314** colors )
 {
     unsigned char cdef[NCOLORS][3] = {
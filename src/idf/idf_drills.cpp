@@ -0,0 +1,464 @@
+/*
+ * file: idf_drills.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include <idf_helpers.h>
+#include <idf_drills.h>
+
+#include <geom/mcad_outline.h>
+#include <api/dll_mcad_segment.h>
+#include <api/dll_mcad_outline.h>
+
+using namespace std;
+
+
+// a drill hole and the cell of the search grid containing its center
+struct DRILL_CELL
+{
+    long ix;
+    long iy;
+    size_t idx;
+
+    bool operator<( const DRILL_CELL& aCell ) const
+    {
+        if( ix != aCell.ix )
+            return ix < aCell.ix;
+
+        if( iy != aCell.iy )
+            return iy < aCell.iy;
+
+        return idx < aCell.idx;
+    }
+};
+
+
+// find the drills whose bounding boxes overlap; only these may intersect
+// or produce a geometry error. The drills are binned into a uniform grid
+// with cells the size of the largest drill so that each drill need only
+// be compared with the drills in the 9 cells around its center.
+static void findDrillPairs( const vector< MCAD_SEGMENT* >& drills,
+    vector< vector< size_t > >& candidates )
+{
+    size_t nd = drills.size();
+    vector< MCAD_POINT > ctr( nd );
+    vector< double > rad( nd );
+    DLL_MCAD_SEGMENT seg( false );
+    double maxR = 0.0;
+    double x0 = 0.0;
+    double y0 = 0.0;
+
+    for( size_t i = 0; i < nd; ++i )
+    {
+        seg.Attach( drills[i] );
+        seg.GetCenter( ctr[i] );
+        seg.GetRadius( rad[i] );
+        seg.Detach();
+
+        if( rad[i] > maxR )
+            maxR = rad[i];
+
+        if( 0 == i || ctr[i].x < x0 )
+            x0 = ctr[i].x;
+
+        if( 0 == i || ctr[i].y < y0 )
+            y0 = ctr[i].y;
+    }
+
+    // drills with centers in cells which are not adjacent are more
+    // than 2 * maxR apart and cannot touch
+    double cell = 2.0 * maxR + 0.01;
+    vector< DRILL_CELL > grid( nd );
+
+    for( size_t i = 0; i < nd; ++i )
+    {
+        grid[i].ix = (long)floor( ( ctr[i].x - x0 ) / cell );
+        grid[i].iy = (long)floor( ( ctr[i].y - y0 ) / cell );
+        grid[i].idx = i;
+    }
+
+    sort( grid.begin(), grid.end() );
+    candidates.clear();
+    candidates.resize( nd );
+
+    for( size_t i = 0; i < nd; ++i )
+    {
+        const DRILL_CELL& dc = grid[i];
+        size_t id = dc.idx;
+
+        for( long ix = dc.ix - 1; ix <= dc.ix + 1; ++ix )
+        {
+            for( long iy = dc.iy - 1; iy <= dc.iy + 1; ++iy )
+            {
+                DRILL_CELL key;
+                key.ix = ix;
+                key.iy = iy;
+                key.idx = 0;
+
+                vector< DRILL_CELL >::iterator sG = lower_bound( grid.begin(), grid.end(), key );
+
+                while( sG != grid.end() && sG->ix == ix && sG->iy == iy )
+                {
+                    size_t jd = sG->idx;
+                    double lim = rad[id] + rad[jd] + 0.01;
+
+                    if( jd != id && abs( ctr[id].x - ctr[jd].x ) <= lim
+                        && abs( ctr[id].y - ctr[jd].y ) <= lim )
+                        candidates[id].push_back( jd );
+
+                    ++sG;
+                }
+            }
+        }
+
+        sort( candidates[id].begin(), candidates[id].end() );
+    }
+
+    return;
+}
+
+
+// group the overlapping drills into bundles of indices; return false
+// if invalid geometry was encountered
+bool findDrillBundles( const vector< MCAD_SEGMENT* >& dv, list< vector< size_t > >& bundles )
+{
+    bundles.clear();
+
+    // Drills are clustered in the order of the list: the first drill which
+    // overlaps a later drill starts a bundle, then each drill in the bundle
+    // in turn collects all remaining drills which overlap it. The order of
+    // the drills within a bundle determines the order in which the holes
+    // are merged so it must not change; only the pairs of drills which are
+    // close enough to overlap are tested.
+    vector< vector< size_t > > candidates;
+    findDrillPairs( dv, candidates );
+
+    size_t nd = dv.size();
+    vector< char > used( nd, 0 );       // the drill has been placed in a bundle
+    MCAD_POINT* ilist = NULL;
+    int nPoints = 0;
+    MCAD_INTERSECT_FLAG flag = MCAD_IFLAG_NONE;
+    bool ok = true;
+
+#define CLEAR_ILIST() do {\
+    if( NULL != ilist ) delete [] ilist; \
+    ilist = NULL; \
+    nPoints = 0; } while( 0 )
+
+    DLL_MCAD_SEGMENT seg0( false );
+    DLL_MCAD_SEGMENT seg1( false );
+
+    for( size_t i = 0; i < nd && ok; ++i )
+    {
+        if( used[i] )
+            continue;
+
+        // find the first later drill which overlaps this one
+        const vector< size_t >& cl = candidates[i];
+        size_t first = nd;
+        seg0.Attach( dv[i] );
+
+        for( size_t j = 0; j < cl.size(); ++j )
+        {
+            if( cl[j] <= i || used[cl[j]] )
+                continue;
+
+            seg1.Attach( dv[cl[j]] );
+
+            if( seg0.GetIntersections( seg1, ilist, nPoints, flag ) )
+            {
+                CLEAR_ILIST();
+                seg1.Detach();
+                first = cl[j];
+                break;
+            }
+
+            seg1.Detach();
+
+            if( flag )
+            {
+                ERROR_IDF << "\n + [INFO] geometry error (flag = " << flag << ")\n";
+                ok = false;
+                break;
+            }
+        }
+
+        seg0.Detach();
+
+        if( !ok || nd == first )
+            continue;
+
+        bundles.push_back( vector< size_t >() );
+        vector< size_t >& bundle = bundles.back();
+        bundle.push_back( i );
+        bundle.push_back( first );
+        used[i] = 1;
+        used[first] = 1;
+
+        // find every drill which overlaps with each drill in the bundle;
+        // this is necessary to ensure that overlapping drill holes do not
+        // generate invalid geometry.
+        for( size_t k = 0; k < bundle.size() && ok; ++k )
+        {
+            const vector< size_t >& bl = candidates[bundle[k]];
+            seg0.Attach( dv[bundle[k]] );
+
+            for( size_t j = 0; j < bl.size(); ++j )
+            {
+                if( used[bl[j]] )
+                    continue;
+
+                seg1.Attach( dv[bl[j]] );
+
+                if( seg0.GetIntersections( seg1, ilist, nPoints, flag ) )
+                {
+                    CLEAR_ILIST();
+                    seg1.Detach();
+                    bundle.push_back( bl[j] );
+                    used[bl[j]] = 1;
+                    continue;
+                }
+
+                seg1.Detach();
+
+                if( flag )
+                {
+                    ERROR_IDF << "\n + [INFO] geometry error (flag = " << flag << ")\n";
+                    ok = false;
+                    break;
+                }
+            }
+
+            seg0.Detach();
+        }
+    }
+
+#undef CLEAR_ILIST
+
+    return ok;
+}
+
+
+// merge overlapping drills into cutouts; return true if any drills were merged;
+// if invalid geometry was encountered the error flag will be set
+bool mergeDrills( list< MCAD_SEGMENT* >& drills, list< MCAD_OUTLINE* >& cutouts, bool& error )
+{
+    error = false;
+
+    if( drills.empty() )
+        return false;
+
+    vector< MCAD_SEGMENT* > dv( drills.begin(), drills.end() );
+    list< vector< size_t > > bundles;
+    bool ok = findDrillBundles( dv, bundles );
+    size_t nd = dv.size();
+    vector< char > used( nd, 0 );
+
+    list< vector< size_t > >::iterator sB = bundles.begin();
+    list< vector< size_t > >::iterator eB = bundles.end();
+
+    while( sB != eB )
+    {
+        for( size_t i = 0; i < sB->size(); ++i )
+            used[(*sB)[i]] = 1;
+
+        ++sB;
+    }
+
+    // the drills which were placed in bundles are removed from the list
+    drills.clear();
+
+    for( size_t i = 0; i < nd; ++i )
+    {
+        if( !used[i] )
+            drills.push_back( dv[i] );
+    }
+
+    sB = bundles.begin();
+    list< MCAD_SEGMENT* > bl;
+
+    // on a geometry error the bundles are abandoned
+    if( !ok )
+    {
+        error = true;
+
+        while( sB != eB )
+        {
+            for( size_t i = 0; i < sB->size(); ++i )
+                bl.push_back( dv[(*sB)[i]] );
+
+            ++sB;
+        }
+
+        killDrills( bl );
+        return false;
+    }
+
+    if( bundles.empty() )
+        return false;
+
+    // create outlines from each 'bundle'
+    while( sB != eB )
+    {
+        bl.clear();
+
+        for( size_t i = 0; i < sB->size(); ++i )
+            bl.push_back( dv[(*sB)[i]] );
+
+        if( !bundleDrills( &bl, cutouts ) )
+        {
+            ERROR_IDF << "\n + [INFO] problems encountered while merging drill holes\n";
+            error = true;
+            return false;
+        }
+
+        ++sB;
+    }
+
+    return true;
+}
+
+
+// take given drill list and punch a cutout using nearest holes in succession
+bool bundleDrills( list< MCAD_SEGMENT* >* drills, list< MCAD_OUTLINE* >& cutouts )
+{
+    vector< pair<double, MCAD_SEGMENT*> > dist; // distance of each from first drill
+    list< MCAD_SEGMENT* >::iterator sD = drills->begin();
+    list< MCAD_SEGMENT* >::iterator eD = drills->end();
+    ++sD;
+
+    MCAD_POINT p0;
+    MCAD_POINT p1;
+    double dx;
+    double dy;
+    double r0;
+    double r1;
+    double r2;
+
+    DLL_MCAD_SEGMENT seg0( false );
+    seg0.Attach( drills->front() );
+    seg0.GetCenter( p0 );
+    seg0.GetRadius( r0 );
+    seg0.Detach();
+
+    // calculate [distance - (R0 + R1)] between each drill hole
+    while( sD != eD )
+    {
+        seg0.Attach( *sD );
+        seg0.GetCenter( p1 );
+        seg0.GetRadius( r1 );
+        seg0.Detach();
+
+        r2 = r0 + r1;
+        dx = p1.x - p0.x;
+        dy = p1.y - p0.y;
+        dx = dx*dx + dy*dy;
+        dx = sqrt( dx );
+        dx -= r2;
+        dist.push_back( pair<double, MCAD_SEGMENT*>( dx, *sD ) );
+        ++sD;
+    }
+
+    // sort according to distances
+    size_t nd = dist.size();
+    pair<double, MCAD_SEGMENT*> tdrill;
+
+    for( size_t i = 0; i < nd -1; ++i )
+    {
+        for( size_t j = i + 1; j < nd; ++j )
+        {
+            if( dist[j].first < dist[i].first )
+            {
+                tdrill = dist[i];
+                dist[i] = dist[j];
+                dist[j] = tdrill;
+            }
+        }
+    }
+
+    DLL_MCAD_OUTLINE op( true );
+    bool dud = false;
+    op.AddSegment( drills->front(), dud );
+    cutouts.push_back( op.GetRawPtr() );
+
+    for( size_t i = 0; i < nd; ++i )
+    {
+        if( !op.AddOutline( dist[i].second, dud ) )
+        {
+            ERROR_IDF << "\n + [INFO] could not merge drill holes\n";
+            return false;
+        }
+    }
+
+    op.Detach();
+    drills->clear();
+    return true;
+}
+
+
+// delete drill data
+void killDrills( list< MCAD_SEGMENT* >& drills )
+{
+    if( drills.empty() )
+        return;
+
+    list< MCAD_SEGMENT* >::iterator sD = drills.begin();
+    list< MCAD_SEGMENT* >::iterator eD = drills.end();
+    DLL_MCAD_SEGMENT seg0( false );
+
+    while( sD != eD )
+    {
+        seg0.Attach( *sD );
+        seg0.DelSegment();
+        ++sD;
+    }
+
+    drills.clear();
+    return;
+}
+
+// delete cutout data
+void killCutouts( list< MCAD_OUTLINE* >& cutouts )
+{
+    if( cutouts.empty() )
+        return;
+
+    list< MCAD_OUTLINE* >::iterator sO = cutouts.begin();
+    list< MCAD_OUTLINE* >::iterator eO = cutouts.end();
+    DLL_MCAD_OUTLINE out0( false );
+
+    while( sO != eO )
+    {
+        out0.Attach( *sO );
+        out0.DelOutline();
+        ++sO;
+    }
+
+    cutouts.clear();
+    return;
+}
@@ -0,0 +1,57 @@
+/*
+ * file: idf_drills.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+ */
+
+/*
+ *  Routines used by idf2igs to merge overlapping drill holes into
+ *  cutouts before the holes are punched into the board outline.
+ */
+
+#ifndef IDF_DRILLS_H
+#define IDF_DRILLS_H
+
+#include <cstddef>
+#include <list>
+#include <vector>
+
+class MCAD_SEGMENT;
+class MCAD_OUTLINE;
+
+// group the overlapping drills into bundles of indices; the first drill
+// which overlaps a later drill starts a bundle and each drill of the
+// bundle in turn collects all remaining drills which overlap it, in the
+// order of the list. Return false if invalid geometry was encountered.
+bool findDrillBundles( const std::vector< MCAD_SEGMENT* >& drills,
+    std::list< std::vector< size_t > >& bundles );
+// merge overlapping drills into cutouts; return true if any drills were merged;
+// if invalid geometry was encountered the error flag will be set
+bool mergeDrills( std::list< MCAD_SEGMENT* >& drills, std::list< MCAD_OUTLINE* >& cutouts,
+    bool& error );
+// take given drill list and punch a cutout using nearest holes in succession
+bool bundleDrills( std::list< MCAD_SEGMENT* >* drills, std::list< MCAD_OUTLINE* >& cutouts );
+// delete drill data
+void killDrills( std::list< MCAD_SEGMENT* >& drills );
+// delete cutout data
+void killCutouts( std::list< MCAD_OUTLINE* >& cutouts );
+
+#endif  // IDF_DRILLS_H
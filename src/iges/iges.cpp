@@ -45,11 +45,14 @@
 #include <iomanip>
 #include <ctime>
 #include <algorithm>
+#include <cmath>
+#include <unordered_map>
 #include <error_macros.h>
 #include <core/iges.h>
 #include <core/iges_io.h>
 #include <core/all_entities.h>
 #include <core/iges.h>
+#include <core/iges_cache.h>
 #include <geom/mcad_utils.h>
 
 
@@ -265,6 +268,7 @@ public:
 
 IGES::IGES()
 {
+    tessCache = new IGES_TESS_CACHE;
     init();
     return;
 }   // IGES()
@@ -283,6 +287,7 @@ IGES::~IGES()
 
     m_validFlags.clear();
     Clear();
+    delete tessCache;
     return;
 }
 
@@ -413,6 +418,10 @@ bool IGES::Clear( void )
         entities.clear();
     }
 
+    typeIndex.clear();
+    entitySet.clear();
+    queryResult.clear();
+    tessCache->Clear();
     init();
     return true;
 }
@@ -940,6 +949,7 @@ bool IGES::NewEntity( int aEntityType, IGES_ENTITY** aEntityPointer )
 
     *aEntityPointer = ep;
     entities.push_back( ep );
+    indexAdd( ep );
     return true;
 }
 
@@ -953,18 +963,11 @@ bool IGES::AddEntity( IGES_ENTITY* aEntity )
         return false;
     }
 
-    std::vector<IGES_ENTITY*>::iterator sEnt = entities.begin();
-    std::vector<IGES_ENTITY*>::iterator eEnt = entities.end();
-
-    while( sEnt != eEnt )
-    {
-        if( *sEnt == aEntity )
-            return true;
-
-        ++sEnt;
-    }
+    if( entitySet.count( aEntity ) )
+        return true;
 
     entities.push_back( aEntity );
+    indexAdd( aEntity );
     aEntity->parent = this;
 
     return true;
@@ -987,6 +990,7 @@ bool IGES::DelEntity( IGES_ENTITY* aEntity )
     {
         if( *sEnt == aEntity )
         {
+            indexDel( aEntity );
             delete *sEnt;
             entities.erase( sEnt );
             return true;
@@ -1015,6 +1019,7 @@ bool IGES::UnlinkEntity( IGES_ENTITY* aEntity )
     {
         if( *sEnt == aEntity )
         {
+            indexDel( aEntity );
             entities.erase( sEnt );
             return true;
         }
@@ -1771,6 +1776,7 @@ void IGES::Cull( bool vicious )
 
     entities.clear();
     entities = tmpEnts;
+    indexRebuild();
 
 #ifdef DEBUG
     cerr << " + [INFO] Entities culled: " << nCulled << "\n";
@@ -1781,6 +1787,717 @@ void IGES::Cull( bool vicious )
 }
 
 
+// fixed tolerance for dimensionless values such as rotation coefficients,
+// knots, weights and color intensities
+#define DEDUP_PARAM_TOL (1.0e-12)
+
+
+// combine a hash value into a running seed
+static inline void dedupCombine( size_t& seed, size_t aValue )
+{
+    seed ^= aValue + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+}
+
+
+// the size of a cell of the grid used to bucket entities, in multiples of
+// the tolerance of the key; a cell of at least twice the tolerance ensures
+// that at most 2 cells in each direction lie within tolerance of a key
+#define DEDUP_CELL (4.0)
+
+
+// combine the hash of the grid cell (aX, aY, aZ) into the seed
+static inline size_t dedupCell( size_t seed, double aX, double aY, double aZ )
+{
+    // note: + 0.0 collapses -0 onto 0 so both produce the same hash
+    dedupCombine( seed, std::hash<double>()( aX + 0.0 ) );
+    dedupCombine( seed, std::hash<double>()( aY + 0.0 ) );
+    dedupCombine( seed, std::hash<double>()( aZ + 0.0 ) );
+    return seed;
+}
+
+
+static inline bool dedupEqual( double aValue0, double aValue1, double aTol )
+{
+    return fabs( aValue0 - aValue1 ) <= aTol;
+}
+
+
+// returns true if the curve is the parameter space curve (BPTR) of a
+// Curve on a Parametric Surface (142) or a member of such a curve; this
+// mirrors the ancestor walk in IGES_ENTITY_126::rescale() so that curves
+// which are scaled differently are never merged
+static bool dedupIsBPTR( IGES_ENTITY* aEntity )
+{
+    std::list<IGES_ENTITY*> eps;
+    eps.push_back( aEntity );
+
+    IGES_ENTITY* ep = aEntity->getFirstParentRef();
+
+    while( ep )
+    {
+        if( ep->GetEntityType() == ENT_CURVE_ON_PARAMETRIC_SURFACE )
+        {
+            IGES_ENTITY* bp = NULL;
+
+            if( !((IGES_ENTITY_142*)ep)->GetBPTR( &bp ) )
+                return false;
+
+            return eps.end() != std::find( eps.begin(), eps.end(), bp );
+        }
+
+        eps.push_back( ep );
+        ep = ep->getFirstParentRef();
+    }
+
+    return false;
+}
+
+
+size_t IGES::dedupHash( IGES_ENTITY* aEntity, double aTol, double aKey[3], double& aKeyTol )
+{
+    size_t seed = (size_t)aEntity->entityType;
+
+    aKey[0] = 0.0;
+    aKey[1] = 0.0;
+    aKey[2] = 0.0;
+    aKeyTol = aTol;
+
+    // DE attributes; associated entities have already been
+    // made canonical by the time this function is invoked
+    dedupCombine( seed, (size_t)aEntity->form );
+    dedupCombine( seed, (size_t)aEntity->pStructure );
+    dedupCombine( seed, (size_t)aEntity->pLineFontPattern );
+    dedupCombine( seed, (size_t)aEntity->pLevel );
+    dedupCombine( seed, (size_t)aEntity->pView );
+    dedupCombine( seed, (size_t)aEntity->pTransform );
+    dedupCombine( seed, (size_t)aEntity->pLabelAssoc );
+    dedupCombine( seed, (size_t)aEntity->pColor );
+    dedupCombine( seed, (size_t)aEntity->colorNum );
+    dedupCombine( seed, (size_t)aEntity->lineFontPattern );
+    dedupCombine( seed, (size_t)aEntity->level );
+    dedupCombine( seed, (size_t)aEntity->lineWeightNum );
+    dedupCombine( seed, std::hash<std::string>()( aEntity->label ) );
+
+    // only exact data is hashed; the floating point data is compared
+    // within tolerance by dedupMatch() and 3 of the values are used
+    // as the key to the grid cells
+    switch( aEntity->entityType )
+    {
+        case ENT_TRANSFORMATION_MATRIX:
+            do
+            {
+                MCAD_TRANSFORM& T = ((IGES_ENTITY_124*)aEntity)->T;
+                aKey[0] = T.T.x;
+                aKey[1] = T.T.y;
+                aKey[2] = T.T.z;
+            } while( 0 );
+
+            break;
+
+        case ENT_COLOR_DEFINITION:
+            do
+            {
+                IGES_ENTITY_314* cp = (IGES_ENTITY_314*)aEntity;
+                dedupCombine( seed, std::hash<std::string>()( cp->cname ) );
+                aKey[0] = cp->red;
+                aKey[1] = cp->green;
+                aKey[2] = cp->blue;
+                aKeyTol = DEDUP_PARAM_TOL;
+            } while( 0 );
+
+            break;
+
+        case ENT_NURBS_CURVE:
+            do
+            {
+                IGES_ENTITY_126* cp = (IGES_ENTITY_126*)aEntity;
+                dedupCombine( seed, (size_t)cp->K );
+                dedupCombine( seed, (size_t)cp->M );
+                dedupCombine( seed, (size_t)cp->PROP3 );
+                dedupCombine( seed, (size_t)cp->PROP4 );
+                dedupCombine( seed, (size_t)dedupIsBPTR( aEntity ) );
+
+                // the key is the first control point
+                if( NULL != cp->coeffs && cp->nCoeffs > 0 )
+                {
+                    aKey[0] = cp->coeffs[0];
+                    aKey[1] = cp->coeffs[1];
+                    aKey[2] = cp->coeffs[2];
+                }
+            } while( 0 );
+
+            break;
+
+        default:
+            break;
+    }
+
+    return seed;
+}
+
+
+bool IGES::dedupMatch( IGES_ENTITY* aEntity0, IGES_ENTITY* aEntity1, double aTol )
+{
+    if( aEntity0->entityType != aEntity1->entityType
+        || aEntity0->form != aEntity1->form
+        || aEntity0->pStructure != aEntity1->pStructure
+        || aEntity0->pLineFontPattern != aEntity1->pLineFontPattern
+        || aEntity0->pLevel != aEntity1->pLevel
+        || aEntity0->pView != aEntity1->pView
+        || aEntity0->pTransform != aEntity1->pTransform
+        || aEntity0->pLabelAssoc != aEntity1->pLabelAssoc
+        || aEntity0->pColor != aEntity1->pColor
+        || aEntity0->colorNum != aEntity1->colorNum
+        || aEntity0->lineFontPattern != aEntity1->lineFontPattern
+        || aEntity0->level != aEntity1->level
+        || aEntity0->visible != aEntity1->visible
+        || aEntity0->depends != aEntity1->depends
+        || aEntity0->use != aEntity1->use
+        || aEntity0->hierarchy != aEntity1->hierarchy
+        || aEntity0->lineWeightNum != aEntity1->lineWeightNum
+        || aEntity0->label != aEntity1->label
+        || aEntity0->entitySubscript != aEntity1->entitySubscript )
+        return false;
+
+    switch( aEntity0->entityType )
+    {
+        case ENT_TRANSFORMATION_MATRIX:
+            do
+            {
+                MCAD_TRANSFORM& T0 = ((IGES_ENTITY_124*)aEntity0)->T;
+                MCAD_TRANSFORM& T1 = ((IGES_ENTITY_124*)aEntity1)->T;
+
+                for( int i = 0; i < 3; ++i )
+                {
+                    for( int j = 0; j < 3; ++j )
+                    {
+                        if( !dedupEqual( T0.R.v[i][j], T1.R.v[i][j], DEDUP_PARAM_TOL ) )
+                            return false;
+                    }
+                }
+
+                if( !dedupEqual( T0.T.x, T1.T.x, aTol )
+                    || !dedupEqual( T0.T.y, T1.T.y, aTol )
+                    || !dedupEqual( T0.T.z, T1.T.z, aTol ) )
+                    return false;
+            } while( 0 );
+
+            break;
+
+        case ENT_COLOR_DEFINITION:
+            do
+            {
+                IGES_ENTITY_314* c0 = (IGES_ENTITY_314*)aEntity0;
+                IGES_ENTITY_314* c1 = (IGES_ENTITY_314*)aEntity1;
+
+                if( !dedupEqual( c0->red, c1->red, DEDUP_PARAM_TOL )
+                    || !dedupEqual( c0->green, c1->green, DEDUP_PARAM_TOL )
+                    || !dedupEqual( c0->blue, c1->blue, DEDUP_PARAM_TOL )
+                    || c0->cname != c1->cname )
+                    return false;
+            } while( 0 );
+
+            break;
+
+        case ENT_NURBS_CURVE:
+            do
+            {
+                IGES_ENTITY_126* c0 = (IGES_ENTITY_126*)aEntity0;
+                IGES_ENTITY_126* c1 = (IGES_ENTITY_126*)aEntity1;
+
+                if( c0->K != c1->K || c0->M != c1->M
+                    || c0->PROP1 != c1->PROP1 || c0->PROP2 != c1->PROP2
+                    || c0->PROP3 != c1->PROP3 || c0->PROP4 != c1->PROP4
+                    || c0->nKnots != c1->nKnots || c0->nCoeffs != c1->nCoeffs
+                    || NULL == c0->knots || NULL == c1->knots
+                    || NULL == c0->coeffs || NULL == c1->coeffs )
+                    return false;
+
+                if( !dedupEqual( c0->V0, c1->V0, DEDUP_PARAM_TOL )
+                    || !dedupEqual( c0->V1, c1->V1, DEDUP_PARAM_TOL )
+                    || !dedupEqual( c0->vnorm.x, c1->vnorm.x, DEDUP_PARAM_TOL )
+                    || !dedupEqual( c0->vnorm.y, c1->vnorm.y, DEDUP_PARAM_TOL )
+                    || !dedupEqual( c0->vnorm.z, c1->vnorm.z, DEDUP_PARAM_TOL ) )
+                    return false;
+
+                for( int i = 0; i < c0->nKnots; ++i )
+                {
+                    if( !dedupEqual( c0->knots[i], c1->knots[i], DEDUP_PARAM_TOL ) )
+                        return false;
+                }
+
+                int nv = ( 0 == c0->PROP3 ) ? 4 : 3;
+                int nd = nv * c0->nCoeffs;
+
+                for( int i = 0; i < nd; ++i )
+                {
+                    double tol = ( 3 == ( i % nv ) ) ? DEDUP_PARAM_TOL : aTol;
+
+                    if( !dedupEqual( c0->coeffs[i], c1->coeffs[i], tol ) )
+                        return false;
+                }
+
+                if( dedupIsBPTR( aEntity0 ) != dedupIsBPTR( aEntity1 ) )
+                    return false;
+            } while( 0 );
+
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+
+bool IGES::rewireChild( IGES_ENTITY* aParent, IGES_ENTITY* aOld, IGES_ENTITY* aNew )
+{
+    bool dup = false;
+
+    // a parent which already refers to the new child cannot be rewired
+    if( !aNew->addReference( aParent, dup ) || dup )
+        return false;
+
+    bool ok = false;
+
+    if( aParent->pTransform == aOld )
+    {
+        aParent->pTransform = (IGES_ENTITY_124*)aNew;
+        ok = true;
+    }
+    else if( aParent->pColor == aOld )
+    {
+        aParent->pColor = aNew;
+        ok = true;
+    }
+    else if( aParent->entityType == ENT_COMPOSITE_CURVE )
+    {
+        IGES_ENTITY_102* cp = (IGES_ENTITY_102*)aParent;
+        std::list<IGES_CURVE*>::iterator sC = cp->curves.begin();
+        std::list<IGES_CURVE*>::iterator eC = cp->curves.end();
+
+        while( sC != eC )
+        {
+            if( *sC == aOld )
+            {
+                *sC = (IGES_CURVE*)((IGES_ENTITY_126*)aNew);
+                ok = true;
+                break;
+            }
+
+            ++sC;
+        }
+    }
+    else if( aParent->entityType == ENT_CURVE_ON_PARAMETRIC_SURFACE )
+    {
+        IGES_ENTITY_142* cp = (IGES_ENTITY_142*)aParent;
+
+        if( cp->BPTR == aOld )
+        {
+            cp->BPTR = aNew;
+            ok = true;
+        }
+        else if( cp->CPTR == aOld )
+        {
+            cp->CPTR = aNew;
+            ok = true;
+        }
+    }
+
+    if( !ok )
+    {
+        // the reference is held by an entity or field which is not
+        // handled here; leave the original association intact
+        aNew->delReference( aParent );
+        return false;
+    }
+
+    aOld->delReference( aParent );
+    aParent->Touch();
+    return true;
+}
+
+
+bool IGES::Deduplicate( IGES_DEDUP_STATS* aStats )
+{
+    IGES_DEDUP_STATS stats;
+    stats.nEntitiesIn = entities.size();
+
+    double tol = globalData.minResolution;
+
+    if( tol <= 0.0 )
+        tol = 1.0e-8;
+
+    // Transforms are processed in order of their depth in a chain of
+    // transforms so that each entity's own transform is canonical
+    // before the entity is hashed; colors and curves are processed
+    // afterwards since they may refer to transforms.
+    std::vector< std::vector<IGES_ENTITY*> > passes;
+    std::vector<IGES_ENTITY*> colors;
+    std::vector<IGES_ENTITY*> curves;
+    size_t nEnt = entities.size();
+
+    for( size_t i = 0; i < nEnt; ++i )
+    {
+        IGES_ENTITY* ep = entities[i];
+
+        // entities with optional data are never merged
+        if( !ep->extras.empty() || !ep->comments.empty() )
+            continue;
+
+        switch( ep->entityType )
+        {
+            case ENT_TRANSFORMATION_MATRIX:
+                do
+                {
+                    size_t depth = 0;
+                    IGES_ENTITY_124* tp = ep->pTransform;
+
+                    while( NULL != tp && depth <= nEnt )
+                    {
+                        ++depth;
+                        tp = tp->pTransform;
+                    }
+
+                    if( depth > nEnt )
+                    {
+                        ERRMSG << "\n + [CORRUPT FILE] circular chain of transforms\n";
+                        return false;
+                    }
+
+                    if( passes.size() <= depth )
+                        passes.resize( depth + 1 );
+
+                    passes[depth].push_back( ep );
+                } while( 0 );
+
+                break;
+
+            case ENT_COLOR_DEFINITION:
+                colors.push_back( ep );
+                break;
+
+            case ENT_NURBS_CURVE:
+                curves.push_back( ep );
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    passes.push_back( colors );
+    passes.push_back( curves );
+
+    std::unordered_map< size_t, std::vector<IGES_ENTITY*> > buckets;
+    std::vector<IGES_ENTITY*> deleted;
+
+    for( size_t iPass = 0; iPass < passes.size(); ++iPass )
+    {
+        std::vector<IGES_ENTITY*>::iterator sE = passes[iPass].begin();
+        std::vector<IGES_ENTITY*>::iterator eE = passes[iPass].end();
+        buckets.clear();
+
+        while( sE != eE )
+        {
+            IGES_ENTITY* ep = *sE;
+            ++sE;
+
+            double key[3];
+            double keyTol;
+            size_t seed = dedupHash( ep, tol, key, keyTol );
+            double cell = DEDUP_CELL * keyTol;
+            double c0[3];   // lowest cell within tolerance of the key
+            double c1[3];   // highest cell within tolerance of the key
+            int nc[3];      // number of cells; 1 or 2 since cell > 2 * keyTol
+
+            // search all cells which lie within tolerance of the key so
+            // that keys on either side of a cell boundary are matched
+            for( int i = 0; i < 3; ++i )
+            {
+                c0[i] = floor( ( key[i] - keyTol ) / cell );
+                c1[i] = floor( ( key[i] + keyTol ) / cell );
+                nc[i] = ( c1[i] > c0[i] ) ? 2 : 1;
+            }
+
+            IGES_ENTITY* match = NULL;
+
+            for( int ix = 0; ix < nc[0] && NULL == match; ++ix )
+            {
+                for( int iy = 0; iy < nc[1] && NULL == match; ++iy )
+                {
+                    for( int iz = 0; iz < nc[2] && NULL == match; ++iz )
+                    {
+                        std::unordered_map< size_t, std::vector<IGES_ENTITY*> >::iterator sC =
+                            buckets.find( dedupCell( seed, ix ? c1[0] : c0[0],
+                                iy ? c1[1] : c0[1], iz ? c1[2] : c0[2] ) );
+
+                        if( sC == buckets.end() )
+                            continue;
+
+                        std::vector<IGES_ENTITY*>::iterator sB = sC->second.begin();
+                        std::vector<IGES_ENTITY*>::iterator eB = sC->second.end();
+
+                        while( sB != eB && !dedupMatch( *sB, ep, tol ) )
+                            ++sB;
+
+                        if( sB != eB )
+                            match = *sB;
+                    }
+                }
+            }
+
+            std::vector<IGES_ENTITY*>& bucket = buckets[dedupCell( seed,
+                floor( key[0] / cell ), floor( key[1] / cell ), floor( key[2] / cell ) )];
+
+            // entities without parents are independent objects
+            // in the model and are never merged
+            if( NULL == match || ep->refs.empty() )
+            {
+                bucket.push_back( ep );
+                continue;
+            }
+
+            // rewire all parents to refer to the surviving entity
+            std::list<IGES_ENTITY*> parents = ep->refs;
+            std::list<IGES_ENTITY*>::iterator sP = parents.begin();
+            std::list<IGES_ENTITY*>::iterator eP = parents.end();
+
+            while( sP != eP )
+            {
+                rewireChild( *sP, ep, match );
+                ++sP;
+            }
+
+            if( !ep->refs.empty() )
+            {
+                // some parents could not be rewired; the entity is kept
+                bucket.push_back( ep );
+                continue;
+            }
+
+            switch( ep->entityType )
+            {
+                case ENT_TRANSFORMATION_MATRIX:
+                    ++stats.nTransforms;
+                    break;
+
+                case ENT_COLOR_DEFINITION:
+                    ++stats.nColors;
+                    break;
+
+                default:
+                    ++stats.nCurves;
+                    break;
+            }
+
+            deleted.push_back( ep );
+        }
+    }
+
+    if( !deleted.empty() )
+    {
+        // remove the merged entities from the list in a single pass
+        std::sort( deleted.begin(), deleted.end() );
+        std::vector<IGES_ENTITY*>::iterator sE = entities.begin();
+        std::vector<IGES_ENTITY*>::iterator eE = entities.end();
+        std::vector<IGES_ENTITY*>::iterator dE = sE;
+
+        while( sE != eE )
+        {
+            if( std::binary_search( deleted.begin(), deleted.end(), *sE ) )
+                delete *sE;
+            else
+                *dE++ = *sE;
+
+            ++sE;
+        }
+
+        entities.erase( dE, entities.end() );
+        indexRebuild();
+    }
+
+    stats.nEntitiesOut = entities.size();
+
+    if( NULL != aStats )
+        *aStats = stats;
+
+    return true;
+}
+
+
+void IGES::GetWorldTransforms( std::vector<IGES_ENTITY*>* aEntities,
+    std::vector<MCAD_TRANSFORM>& aTransforms )
+{
+    aTransforms.clear();
+    aTransforms.reserve( entities.size() );
+
+    if( NULL != aEntities )
+        *aEntities = entities;
+
+    // consecutive entities frequently share a transform; remember the
+    // last result to avoid validating the same chain repeatedly
+    MCAD_TRANSFORM ident;
+    MCAD_TRANSFORM last;
+    IGES_ENTITY_124* lastTx = NULL;
+    std::vector<IGES_ENTITY*>::iterator sE = entities.begin();
+    std::vector<IGES_ENTITY*>::iterator eE = entities.end();
+
+    while( sE != eE )
+    {
+        IGES_ENTITY_124* tx = (*sE)->pTransform;
+
+        if( NULL == tx )
+        {
+            aTransforms.push_back( ident );
+        }
+        else
+        {
+            if( tx != lastTx )
+            {
+                last = tx->GetTransformMatrix();
+                lastTx = tx;
+            }
+
+            aTransforms.push_back( last );
+        }
+
+        ++sE;
+    }
+
+    return;
+}
+
+
+IGES_TESS_CACHE* IGES::GetTessCache( void )
+{
+    return tessCache;
+}
+
+void IGES::indexAdd( IGES_ENTITY* aEntity )
+{
+    typeIndex[aEntity->entityType].push_back( aEntity );
+    entitySet.insert( aEntity );
+    return;
+}
+
+
+void IGES::indexDel( IGES_ENTITY* aEntity )
+{
+    entitySet.erase( aEntity );
+
+    std::map< int, std::vector<IGES_ENTITY*> >::iterator sT = typeIndex.find( aEntity->entityType );
+
+    if( sT == typeIndex.end() )
+        return;
+
+    std::vector<IGES_ENTITY*>::iterator sE = std::find( sT->second.begin(),
+        sT->second.end(), aEntity );
+
+    if( sE != sT->second.end() )
+        sT->second.erase( sE );
+
+    if( sT->second.empty() )
+        typeIndex.erase( sT );
+
+    return;
+}
+
+
+void IGES::indexRebuild( void )
+{
+    typeIndex.clear();
+    entitySet.clear();
+    queryResult.clear();
+
+    std::vector<IGES_ENTITY*>::iterator sE = entities.begin();
+    std::vector<IGES_ENTITY*>::iterator eE = entities.end();
+
+    while( sE != eE )
+    {
+        typeIndex[(*sE)->entityType].push_back( *sE );
+        entitySet.insert( *sE );
+        ++sE;
+    }
+
+    return;
+}
+
+
+bool IGES::GetEntitiesByType( int aEntityType, size_t& aListSize, IGES_ENTITY* const*& aList )
+{
+    std::map< int, std::vector<IGES_ENTITY*> >::iterator sT = typeIndex.find( aEntityType );
+
+    if( sT == typeIndex.end() || sT->second.empty() )
+    {
+        aListSize = 0;
+        aList = NULL;
+        return false;
+    }
+
+    aListSize = sT->second.size();
+    aList = &sT->second[0];
+    return true;
+}
+
+
+size_t IGES::GetEntities( const IGES_QUERY& aQuery, std::vector<IGES_ENTITY*>& aResult )
+{
+    aResult.clear();
+
+    std::map< int, std::vector<IGES_ENTITY*> >::iterator sT = typeIndex.find( aQuery.entityType );
+
+    if( sT == typeIndex.end() )
+        return 0;
+
+    std::vector<IGES_ENTITY*>::iterator sE = sT->second.begin();
+    std::vector<IGES_ENTITY*>::iterator eE = sT->second.end();
+
+    while( sE != eE )
+    {
+        IGES_ENTITY* ep = *sE;
+        ++sE;
+
+        if( aQuery.form >= 0 && ep->form != aQuery.form )
+            continue;
+
+        if( aQuery.level >= 0 && ( NULL != ep->pLevel || ep->level != aQuery.level ) )
+            continue;
+
+        if( aQuery.color >= 0 && ( NULL != ep->pColor || ep->colorNum != aQuery.color ) )
+            continue;
+
+        if( NULL != aQuery.colorEntity && ep->pColor != aQuery.colorEntity )
+            continue;
+
+        if( NULL != aQuery.label && ep->label.compare( aQuery.label ) )
+            continue;
+
+        if( aQuery.visible >= 0 && ep->visible != ( aQuery.visible != 0 ) )
+            continue;
+
+        aResult.push_back( ep );
+    }
+
+    return aResult.size();
+}
+
+
+bool IGES::GetEntities( const IGES_QUERY& aQuery, size_t& aListSize, IGES_ENTITY* const*& aList )
+{
+    aListSize = GetEntities( aQuery, queryResult );
+
+    if( 0 == aListSize )
+    {
+        aList = NULL;
+        return false;
+    }
+
+    aList = &queryResult[0];
+    return true;
+}
+
 bool IGES::ConvertUnits( IGES_UNIT newUnit )
 {
     if( globalData.unitsFlag == newUnit )
@@ -1811,6 +2528,7 @@ bool IGES::ConvertUnits( IGES_UNIT newUnit )
 
     // scale all existing entities
     size_t nEnt = entities.size();
+    IGES_ENTITY::touchAll( entities );
 
     for( size_t i = 0; i < nEnt; ++ i )
     {
@@ -1847,6 +2565,7 @@ bool IGES::ChangeModelScale( double aScale )
 
     // scale all existing entities
     size_t nEnt = entities.size();
+    IGES_ENTITY::touchAll( entities );
 
     for( size_t i = 0; i < nEnt; ++ i )
     {
@@ -2397,6 +3116,12 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
     if( entities.empty() )
         return true;
 
+    if( newParent == this )
+    {
+        ERRMSG << "\n + [BUG] Export() invoked with itself as the new parent\n";
+        return false;
+    }
+
     // extract information from parent IGES
     // + int maxLinewidthGrad
     // + double modelScale
@@ -2405,11 +3130,50 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
     double pms = newParent->globalData.modelScale;
     IGES_UNIT pUF = newParent->globalData.unitsFlag;
 
-    if( globalData.modelScale != pms )
-        ChangeModelScale( pms );
+    // Calculate a single scale factor which combines the change of model
+    // scale and the conversion of units so that all entities are rescaled
+    // within the same pass which prepares them for transfer.
+    double cf = 1.0;
+    bool rescale = false;
+
+    if( pms < 6.0e-8 )
+    {
+        ERRMSG << "\n + [INFO] rejecting scale (< 6.0e-8)\n";
+    }
+    else if( pms > 17000000.0 )
+    {
+        ERRMSG << "\n + [INFO] rejecting scale (> 17000000.0)\n";
+    }
+    else if( globalData.modelScale != pms )
+    {
+        cf = pms / globalData.modelScale;
+        globalData.minResolution *= pms;
+        globalData.modelScale = pms;
+        rescale = true;
+    }
 
     if( globalData.unitsFlag != pUF )
-        ConvertUnits( pUF );
+    {
+        if( UNIT_EXTERN == globalData.unitsFlag || UNIT_EXTERN == pUF )
+        {
+            ERRMSG << "\n + [INFO] cannot convert units; UNIT_EXTERN specified\n";
+        }
+        else
+        {
+            double ucf = UNIT_TO_MM[globalData.unitsFlag - UNIT_START]
+                / UNIT_TO_MM[pUF - UNIT_START];
+
+            // as in ConvertUnits() the units are left unchanged when
+            // the conversion factor is effectively 1
+            if( ucf <= 0.9999998 || ucf >= 1.000001 )
+            {
+                globalData.minResolution *= ucf;
+                globalData.unitsFlag = pUF;
+                cf *= ucf;
+                rescale = true;
+            }
+        }
+    }
 
     size_t nEnt = entities.size();
 
@@ -2419,22 +3183,8 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
     double lws = maxLWG / globalData.maxLinewidthGrad;
     int llw;
 
-    for( size_t i = 0; i < nEnt; ++ i )
-    {
-        llw = entities[i]->lineWeightNum;
-
-        if( llw > 0 )
-        {
-            llw = (int)(double(llw) * lws);
-
-            if( llw == 0 )
-                llw = 1;
-        }
-
-        entities[i]->lineWeightNum = llw;
-    }
-
-    // iterate through the list of entities and store lists of
+    // iterate through the list of entities, rescale them and adjust the
+    // linewidths, and store lists of
     // + (a) top level Entity 144 (Trimmed Parametric Surfaces)
     // + (b) top level Entity 408 (Singular Subfigure Instance)
     // + (c) Manifold Solid B-Rep Objects (Entity 186)
@@ -2455,8 +3205,29 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
     int tEnt;
     size_t nRefs;
 
+    if( rescale )
+        IGES_ENTITY::touchAll( entities );
+
     for( size_t i = 0; i < nEnt; ++ i )
     {
+        if( rescale && !entities[i]->rescale( cf ) )
+        {
+            ERRMSG << "\n + [BUG] cannot convert units\n";
+            return false;
+        }
+
+        llw = entities[i]->lineWeightNum;
+
+        if( llw > 0 )
+        {
+            llw = (int)(double(llw) * lws);
+
+            if( llw == 0 )
+                llw = 1;
+        }
+
+        entities[i]->lineWeightNum = llw;
+
         tEnt = entities[i]->GetEntityType();
         nRefs = entities[i]->getNRefs();
 
@@ -2520,9 +3291,15 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
             {
                 ERRMSG << "\n + [INFO] could not transfer entity to Subfigure Definition\n";
                 ep = p308;
+                // remove the entities which were added before the failure
+                eEnt = sEnt;
                 sEnt = sslist.begin();
 
-                while( p308->DelDE( *sEnt ) && sEnt != eEnt );
+                while( sEnt != eEnt )
+                {
+                    p308->DelDE( *sEnt );
+                    ++sEnt;
+                }
 
                 newParent->DelEntity( ep );
                 return false;
@@ -2541,9 +3318,15 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
             if( !p308->AddDE(*sEnt) )
             {
                 ERRMSG << "\n + [INFO] could not transfer entity to Subfigure Definition\n";
+                // remove the entities which were added before the failure
+                eEnt = sEnt;
                 sEnt = tplist.begin();
 
-                while( p308->DelDE( *sEnt ) && sEnt != eEnt );
+                while( sEnt != eEnt )
+                {
+                    p308->DelDE( *sEnt );
+                    ++sEnt;
+                }
 
                 newParent->DelEntity( ep );
                 return false;
@@ -2562,9 +3345,15 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
             if( !p308->AddDE(*sEnt) )
             {
                 ERRMSG << "\n + [INFO] could not transfer MSBO entity to Subfigure Definition\n";
+                // remove the entities which were added before the failure
+                eEnt = sEnt;
                 sEnt = brlist.begin();
 
-                while( p308->DelDE( *sEnt ) && sEnt != eEnt );
+                while( sEnt != eEnt )
+                {
+                    p308->DelDE( *sEnt );
+                    ++sEnt;
+                }
 
                 newParent->DelEntity( ep );
                 return false;
@@ -2574,24 +3363,18 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
         }
     }
 
+    // transfer all entities to the new parent in a single pass; entities
+    // which have already been transferred (the Subfigure Definition adds
+    // its members to its own parent) are identified by their parent
+    // pointer so no search of the new parent's list is required
     for( size_t i = 0; i < nEnt; ++ i )
     {
-        if( !newParent->AddEntity( entities[i] ) )
-        {
-            ERRMSG << "\n + [INFO] could not transfer entity to parent\n";
-
-            ep = (IGES_ENTITY*)p308;
-            newParent->UnlinkEntity( ep );
+        if( entities[i]->parent == newParent )
+            continue;
 
-            for( size_t j = 0; j < i; ++j )
-            {
-                newParent->UnlinkEntity( entities[j] );
-                entities[j]->parent = this;
-            }
-
-            delete ep;
-            return false;
-        }
+        entities[i]->parent = newParent;
+        newParent->entities.push_back( entities[i] );
+        newParent->indexAdd( entities[i] );
     }
 
     *packagedEntity = p308;
@@ -2615,6 +3398,9 @@ bool IGES::Export( IGES* newParent, IGES_ENTITY_308** packagedEntity )
     }
 
     entities.clear();
+    typeIndex.clear();
+    entitySet.clear();
+    queryResult.clear();
 
     return true;
 }
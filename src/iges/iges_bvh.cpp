@@ -0,0 +1,550 @@
+/*
+ * file: iges_bvh.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: Bounding Volume Hierarchy over the bounds of IGES
+ * entities to support region, ray and proximity queries.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <queue>
+#include <thread>
+#include <error_macros.h>
+#include <core/iges.h>
+#include <core/iges_entity.h>
+#include <core/iges_bvh.h>
+
+
+using namespace std;
+
+// maximum number of entities in a leaf node
+#define BVH_LEAF_SIZE (4)
+// minimum number of entities handled by a worker thread
+#define BVH_MIN_THREAD_LOAD (1024)
+
+
+// entity types considered by Build( IGES* )
+static const int BVH_TYPES[] =
+{
+    ENT_CIRCULAR_ARC,
+    ENT_COMPOSITE_CURVE,
+    ENT_CONIC_ARC,
+    ENT_LINE,
+    ENT_SURFACE_OF_REVOLUTION,
+    ENT_NURBS_CURVE,
+    ENT_NURBS_SURFACE,
+    ENT_CURVE_ON_PARAMETRIC_SURFACE,
+    ENT_TRIMMED_PARAMETRIC_SURFACE,
+    ENT_SINGULAR_SUBFIGURE_INSTANCE
+};
+
+
+static int getNThreads( int aNThreads )
+{
+    if( aNThreads > 0 )
+        return aNThreads;
+
+    int nt = (int)thread::hardware_concurrency();
+
+    return nt > 0 ? nt : 1;
+}
+
+
+// compares the centroids of 2 items along a given axis
+struct BVH_CMP
+{
+    const vector<MCAD_POINT>* centroids;
+    int axis;
+
+    bool operator()( int a, int b ) const
+    {
+        const MCAD_POINT& pa = (*centroids)[a];
+        const MCAD_POINT& pb = (*centroids)[b];
+
+        if( 0 == axis )
+            return pa.x < pb.x;
+
+        if( 1 == axis )
+            return pa.y < pb.y;
+
+        return pa.z < pb.z;
+    }
+};
+
+
+IGES_BVH::IGES_BVH()
+{
+    return;
+}
+
+
+IGES_BVH::~IGES_BVH()
+{
+    return;
+}
+
+
+void IGES_BVH::Clear( void )
+{
+    nodes.clear();
+    items.clear();
+    boxes.clear();
+    itemLeaf.clear();
+    itemIndex.clear();
+    return;
+}
+
+
+void IGES_BVH::calcBounds( size_t aFirst, size_t aLast, int aNThreads )
+{
+    size_t n = aLast - aFirst;
+
+    if( aNThreads > 1 && n >= 2 * BVH_MIN_THREAD_LOAD )
+    {
+        size_t mid = aFirst + n / 2;
+        thread worker( &IGES_BVH::calcBounds, this, aFirst, mid, aNThreads / 2 );
+        calcBounds( mid, aLast, aNThreads - aNThreads / 2 );
+        worker.join();
+        return;
+    }
+
+    for( size_t i = aFirst; i < aLast; ++i )
+    {
+        if( !items[i]->GetBounds( boxes[i] ) )
+            boxes[i].Clear();
+    }
+
+    return;
+}
+
+
+void IGES_BVH::buildNode( int aNode, int aParent, int aFirst, int aLast, int aNThreads,
+    vector<int>& aPerm, const vector<MCAD_POINT>& aCentroids )
+{
+    NODE& node = nodes[aNode];
+    node.parent = aParent;
+    node.left = -1;
+    node.right = -1;
+    node.first = aFirst;
+    node.count = aLast - aFirst;
+
+    if( node.count <= BVH_LEAF_SIZE )
+    {
+        for( int i = aFirst; i < aLast; ++i )
+            itemLeaf[i] = aNode;
+
+        return;
+    }
+
+    // split at the median centroid along the longest axis of the centroids
+    MCAD_BOX cb;
+
+    for( int i = aFirst; i < aLast; ++i )
+        cb.Add( aCentroids[aPerm[i]] );
+
+    BVH_CMP cmp;
+    cmp.centroids = &aCentroids;
+    cmp.axis = 0;
+
+    double dx = cb.hi.x - cb.lo.x;
+    double dy = cb.hi.y - cb.lo.y;
+    double dz = cb.hi.z - cb.lo.z;
+
+    if( dy > dx && dy >= dz )
+        cmp.axis = 1;
+    else if( dz > dx && dz > dy )
+        cmp.axis = 2;
+
+    int mid = aFirst + ( aLast - aFirst ) / 2;
+    nth_element( aPerm.begin() + aFirst, aPerm.begin() + mid, aPerm.begin() + aLast, cmp );
+
+    // a subtree of N items occupies at most 2N - 1 nodes so each subtree
+    // is given its own range of nodes and no synchronization is required
+    node.count = 0;
+    node.left = aNode + 1;
+    node.right = aNode + 2 * ( mid - aFirst );
+    int left = node.left;
+    int right = node.right;
+
+    if( aNThreads > 1 && aLast - aFirst >= 2 * BVH_MIN_THREAD_LOAD )
+    {
+        thread worker( &IGES_BVH::buildNode, this, left, aNode, aFirst, mid,
+            aNThreads / 2, ref( aPerm ), cref( aCentroids ) );
+        buildNode( right, aNode, mid, aLast, aNThreads - aNThreads / 2, aPerm, aCentroids );
+        worker.join();
+    }
+    else
+    {
+        buildNode( left, aNode, aFirst, mid, 1, aPerm, aCentroids );
+        buildNode( right, aNode, mid, aLast, 1, aPerm, aCentroids );
+    }
+
+    return;
+}
+
+
+void IGES_BVH::updateNode( int aNode )
+{
+    NODE& node = nodes[aNode];
+    node.box.Clear();
+
+    if( node.left < 0 )
+    {
+        for( int i = node.first; i < node.first + node.count; ++i )
+            node.box.Add( boxes[i] );
+
+        return;
+    }
+
+    node.box.Add( nodes[node.left].box );
+    node.box.Add( nodes[node.right].box );
+    return;
+}
+
+
+bool IGES_BVH::build( const vector<IGES_ENTITY*>& aEntities, int aNThreads )
+{
+    Clear();
+
+    if( aEntities.empty() )
+        return false;
+
+    int nt = getNThreads( aNThreads );
+
+    vector<IGES_ENTITY*>::const_iterator sE = aEntities.begin();
+    vector<IGES_ENTITY*>::const_iterator eE = aEntities.end();
+
+    items.reserve( aEntities.size() );
+
+    for( ; sE != eE; ++sE )
+    {
+        if( NULL != *sE )
+            items.push_back( *sE );
+    }
+
+    boxes.resize( items.size() );
+    calcBounds( 0, items.size(), nt );
+
+    // discard entities without bounds
+    size_t n = 0;
+
+    for( size_t i = 0; i < items.size(); ++i )
+    {
+        if( boxes[i].IsEmpty() )
+            continue;
+
+        items[n] = items[i];
+        boxes[n] = boxes[i];
+        ++n;
+    }
+
+    items.resize( n );
+    boxes.resize( n );
+
+    if( 0 == n )
+        return false;
+
+    vector<int> perm( n );
+    vector<MCAD_POINT> centroids( n );
+
+    for( size_t i = 0; i < n; ++i )
+    {
+        perm[i] = (int)i;
+        centroids[i] = boxes[i].Center();
+    }
+
+    nodes.resize( 2 * n - 1 );
+    itemLeaf.resize( n );
+    buildNode( 0, -1, 0, (int)n, nt, perm, centroids );
+
+    // arrange the items in leaf order
+    vector<IGES_ENTITY*> tItems( n );
+    vector<MCAD_BOX> tBoxes( n );
+
+    for( size_t i = 0; i < n; ++i )
+    {
+        tItems[i] = items[perm[i]];
+        tBoxes[i] = boxes[perm[i]];
+        itemIndex[tItems[i]] = (int)i;
+    }
+
+    items.swap( tItems );
+    boxes.swap( tBoxes );
+
+    // children always follow their parent so a reverse sweep
+    // computes the boxes from the bottom up
+    for( int i = (int)nodes.size() - 1; i >= 0; --i )
+        updateNode( i );
+
+    return true;
+}
+
+
+bool IGES_BVH::Build( IGES* aModel, int aNThreads )
+{
+    Clear();
+
+    if( NULL == aModel )
+    {
+        ERRMSG << "\n + [BUG] NULL pointer passed for model\n";
+        return false;
+    }
+
+    vector<IGES_ENTITY*> ents;
+    int nTypes = (int)( sizeof( BVH_TYPES ) / sizeof( BVH_TYPES[0] ) );
+
+    for( int i = 0; i < nTypes; ++i )
+    {
+        size_t nList = 0;
+        IGES_ENTITY* const* pList = NULL;
+
+        if( !aModel->GetEntitiesByType( BVH_TYPES[i], nList, pList ) )
+            continue;
+
+        for( size_t j = 0; j < nList; ++j )
+        {
+            IGES_STAT_DEPENDS dep;
+
+            if( pList[j]->GetDependency( dep ) && STAT_INDEPENDENT == dep )
+                ents.push_back( pList[j] );
+        }
+    }
+
+    return build( ents, aNThreads );
+}
+
+
+bool IGES_BVH::Build( const vector<IGES_ENTITY*>& aEntities, int aNThreads )
+{
+    return build( aEntities, aNThreads );
+}
+
+
+bool IGES_BVH::Refit( IGES_ENTITY* aEntity )
+{
+    map<IGES_ENTITY*, int>::iterator sI = itemIndex.find( aEntity );
+
+    if( sI == itemIndex.end() )
+        return false;
+
+    MCAD_BOX& box = boxes[sI->second];
+
+    if( !aEntity->GetBounds( box ) )
+        box.Clear();
+
+    int node = itemLeaf[sI->second];
+
+    while( node >= 0 )
+    {
+        updateNode( node );
+        node = nodes[node].parent;
+    }
+
+    return true;
+}
+
+
+void IGES_BVH::Refit( int aNThreads )
+{
+    if( items.empty() )
+        return;
+
+    calcBounds( 0, items.size(), getNThreads( aNThreads ) );
+
+    for( int i = (int)nodes.size() - 1; i >= 0; --i )
+        updateNode( i );
+
+    return;
+}
+
+
+size_t IGES_BVH::GetNEntities( void ) const
+{
+    return items.size();
+}
+
+
+bool IGES_BVH::GetBounds( MCAD_BOX& aBox ) const
+{
+    if( nodes.empty() )
+    {
+        aBox.Clear();
+        return false;
+    }
+
+    aBox = nodes[0].box;
+    return true;
+}
+
+
+size_t IGES_BVH::QueryBox( const MCAD_BOX& aBox, vector<IGES_ENTITY*>& aResult ) const
+{
+    aResult.clear();
+
+    if( nodes.empty() || aBox.IsEmpty() )
+        return 0;
+
+    vector<int> stack;
+    stack.push_back( 0 );
+
+    while( !stack.empty() )
+    {
+        const NODE& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if( !node.box.Intersects( aBox ) )
+            continue;
+
+        if( node.left < 0 )
+        {
+            for( int i = node.first; i < node.first + node.count; ++i )
+            {
+                if( boxes[i].Intersects( aBox ) )
+                    aResult.push_back( items[i] );
+            }
+
+            continue;
+        }
+
+        stack.push_back( node.right );
+        stack.push_back( node.left );
+    }
+
+    return aResult.size();
+}
+
+
+size_t IGES_BVH::QueryRay( const MCAD_POINT& aOrigin, const MCAD_POINT& aDirection,
+    vector<IGES_ENTITY*>& aResult, vector<double>* aDistance ) const
+{
+    aResult.clear();
+
+    if( NULL != aDistance )
+        aDistance->clear();
+
+    if( nodes.empty() )
+        return 0;
+
+    if( 0.0 == aDirection.x && 0.0 == aDirection.y && 0.0 == aDirection.z )
+    {
+        ERRMSG << "\n + [INFO] invalid ray direction\n";
+        return 0;
+    }
+
+    double inf = numeric_limits<double>::infinity();
+    MCAD_POINT inv( 0.0 == aDirection.x ? inf : 1.0 / aDirection.x,
+        0.0 == aDirection.y ? inf : 1.0 / aDirection.y,
+        0.0 == aDirection.z ? inf : 1.0 / aDirection.z );
+
+    vector< pair<double, IGES_ENTITY*> > hits;
+    vector<int> stack;
+    stack.push_back( 0 );
+    double t;
+
+    while( !stack.empty() )
+    {
+        const NODE& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if( !node.box.RayHit( aOrigin, inv, t ) )
+            continue;
+
+        if( node.left < 0 )
+        {
+            for( int i = node.first; i < node.first + node.count; ++i )
+            {
+                if( boxes[i].RayHit( aOrigin, inv, t ) )
+                    hits.push_back( pair<double, IGES_ENTITY*>( t, items[i] ) );
+            }
+
+            continue;
+        }
+
+        stack.push_back( node.right );
+        stack.push_back( node.left );
+    }
+
+    sort( hits.begin(), hits.end() );
+    aResult.reserve( hits.size() );
+
+    for( size_t i = 0; i < hits.size(); ++i )
+    {
+        aResult.push_back( hits[i].second );
+
+        if( NULL != aDistance )
+            aDistance->push_back( hits[i].first );
+    }
+
+    return aResult.size();
+}
+
+
+IGES_ENTITY* IGES_BVH::QueryNearest( const MCAD_POINT& aPoint, double* aDistance ) const
+{
+    if( nodes.empty() )
+        return NULL;
+
+    // best-first search ordered by the distance to each node's box
+    typedef pair<double, int> QITEM;
+    priority_queue< QITEM, vector<QITEM>, greater<QITEM> > queue;
+    queue.push( QITEM( nodes[0].box.Distance2( aPoint ), 0 ) );
+
+    double best = numeric_limits<double>::max();
+    IGES_ENTITY* result = NULL;
+
+    while( !queue.empty() )
+    {
+        QITEM qi = queue.top();
+        queue.pop();
+
+        if( qi.first >= best )
+            break;
+
+        const NODE& node = nodes[qi.second];
+
+        if( node.left < 0 )
+        {
+            for( int i = node.first; i < node.first + node.count; ++i )
+            {
+                double d2 = boxes[i].Distance2( aPoint );
+
+                if( d2 < best )
+                {
+                    best = d2;
+                    result = items[i];
+                }
+            }
+
+            continue;
+        }
+
+        queue.push( QITEM( nodes[node.left].box.Distance2( aPoint ), node.left ) );
+        queue.push( QITEM( nodes[node.right].box.Distance2( aPoint ), node.right ) );
+    }
+
+    if( NULL != aDistance && NULL != result )
+        *aDistance = sqrt( best );
+
+    return result;
+}
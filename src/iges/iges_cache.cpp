@@ -0,0 +1,374 @@
+/*
+ * file: iges_cache.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: bounded cache of curve discretizations and surface
+ * meshes keyed by entity, content version and tolerance.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <cmath>
+#include <error_macros.h>
+#include <core/iges.h>
+#include <core/iges_curve.h>
+#include <core/entity124.h>
+#include <core/entity144.h>
+#include <core/iges_cache.h>
+
+
+using namespace std;
+
+// default memory limit
+#define CACHE_DEFAULT_LIMIT (64 << 20)
+// number of tolerance buckets per factor of 2
+#define CACHE_BUCKETS_PER_OCTAVE (4)
+
+// kinds of entries
+#define CACHE_POLYLINE (0)
+#define CACHE_MESH (1)
+
+
+// return the bucket of a tolerance; the smallest tolerance of
+// bucket 'b' is 2^(b / CACHE_BUCKETS_PER_OCTAVE)
+static int getBucket( double aTolerance )
+{
+    return (int)floor( log2( aTolerance ) * CACHE_BUCKETS_PER_OCTAVE );
+}
+
+
+static double getBucketTolerance( int aBucket )
+{
+    return exp2( (double)aBucket / CACHE_BUCKETS_PER_OCTAVE );
+}
+
+
+bool IGES_TESS_CACHE::KEY::operator<( const KEY& aKey ) const
+{
+    // the entity is compared first so that Invalidate() may find
+    // all entries of an entity as a single range
+    if( entity != aKey.entity )
+        return entity < aKey.entity;
+
+    if( version != aKey.version )
+        return version < aKey.version;
+
+    if( xformVersion != aKey.xformVersion )
+        return xformVersion < aKey.xformVersion;
+
+    if( kind != aKey.kind )
+        return kind < aKey.kind;
+
+    if( bucket0 != aKey.bucket0 )
+        return bucket0 < aKey.bucket0;
+
+    return bucket1 < aKey.bucket1;
+}
+
+
+IGES_TESS_CACHE::IGES_TESS_CACHE()
+{
+    memLimit = CACHE_DEFAULT_LIMIT;
+    memUsed = 0;
+    nHits = 0;
+    nMisses = 0;
+    nEvictions = 0;
+    return;
+}
+
+
+IGES_TESS_CACHE::~IGES_TESS_CACHE()
+{
+    return;
+}
+
+
+void IGES_TESS_CACHE::Clear( void )
+{
+    lock_guard<mutex> lk( lock );
+    entries.clear();
+    usage.clear();
+    memUsed = 0;
+    return;
+}
+
+
+void IGES_TESS_CACHE::Invalidate( IGES_ENTITY* aEntity )
+{
+    lock_guard<mutex> lk( lock );
+    KEY key;
+    key.entity = aEntity;
+    key.version = 0;
+    key.xformVersion = 0;
+    key.kind = 0;
+    key.bucket0 = -2147483647 - 1;
+    key.bucket1 = key.bucket0;
+
+    map<KEY, ENTRY>::iterator sE = entries.lower_bound( key );
+
+    while( sE != entries.end() && sE->first.entity == aEntity )
+    {
+        memUsed -= sE->second.bytes;
+        usage.erase( sE->second.lru );
+        entries.erase( sE++ );
+    }
+
+    return;
+}
+
+
+void IGES_TESS_CACHE::SetMemoryLimit( size_t aBytes )
+{
+    lock_guard<mutex> lk( lock );
+    memLimit = aBytes;
+    trim();
+    return;
+}
+
+
+size_t IGES_TESS_CACHE::GetMemoryLimit( void ) const
+{
+    lock_guard<mutex> lk( lock );
+    return memLimit;
+}
+
+
+size_t IGES_TESS_CACHE::GetMemoryUsed( void ) const
+{
+    lock_guard<mutex> lk( lock );
+    return memUsed;
+}
+
+
+size_t IGES_TESS_CACHE::GetNEntries( void ) const
+{
+    lock_guard<mutex> lk( lock );
+    return entries.size();
+}
+
+
+void IGES_TESS_CACHE::GetStats( size_t& aHits, size_t& aMisses, size_t& aEvictions ) const
+{
+    lock_guard<mutex> lk( lock );
+    aHits = nHits;
+    aMisses = nMisses;
+    aEvictions = nEvictions;
+    return;
+}
+
+
+void IGES_TESS_CACHE::ResetStats( void )
+{
+    lock_guard<mutex> lk( lock );
+    nHits = 0;
+    nMisses = 0;
+    nEvictions = 0;
+    return;
+}
+
+
+void IGES_TESS_CACHE::makeKey( IGES_ENTITY* aEntity, bool aXform, int aKind, KEY& aKey )
+{
+    aKey.entity = aEntity;
+    aKey.version = aEntity->GetContentVersion();
+    aKey.xformVersion = 0;
+    aKey.kind = aKind;
+    aKey.bucket0 = 0;
+    aKey.bucket1 = 0;
+
+    IGES_ENTITY* tx = NULL;
+
+    // transform versions are never 0 once calculated
+    if( aXform && aEntity->GetTransform( &tx ) )
+        aKey.xformVersion = ((IGES_ENTITY_124*)tx)->GetVersion();
+
+    return;
+}
+
+
+IGES_TESS_CACHE::ENTRY* IGES_TESS_CACHE::find( const KEY& aKey )
+{
+    map<KEY, ENTRY>::iterator sE = entries.find( aKey );
+
+    if( sE == entries.end() )
+    {
+        ++nMisses;
+        return NULL;
+    }
+
+    ++nHits;
+    usage.splice( usage.begin(), usage, sE->second.lru );
+    return &sE->second;
+}
+
+
+void IGES_TESS_CACHE::insert( const KEY& aKey, ENTRY& aEntry )
+{
+    aEntry.points.shrink_to_fit();
+    aEntry.mesh.vertices.shrink_to_fit();
+    aEntry.mesh.normals.shrink_to_fit();
+    aEntry.mesh.params.shrink_to_fit();
+    aEntry.mesh.indices.shrink_to_fit();
+
+    aEntry.bytes = sizeof( ENTRY ) + sizeof( KEY ) * 2
+        + aEntry.points.capacity() * sizeof( MCAD_POINT )
+        + aEntry.mesh.vertices.capacity() * sizeof( MCAD_POINT )
+        + aEntry.mesh.normals.capacity() * sizeof( MCAD_POINT )
+        + aEntry.mesh.params.capacity() * sizeof( MCAD_POINT )
+        + aEntry.mesh.indices.capacity() * sizeof( int );
+
+    // an entry which can never fit is not stored
+    if( aEntry.bytes > memLimit )
+        return;
+
+    pair< map<KEY, ENTRY>::iterator, bool > res =
+        entries.insert( pair<KEY, ENTRY>( aKey, ENTRY() ) );
+
+    // another thread has already stored the result
+    if( !res.second )
+        return;
+
+    ENTRY& ent = res.first->second;
+    ent.points.swap( aEntry.points );
+    ent.mesh.surface = aEntry.mesh.surface;
+    ent.mesh.vertices.swap( aEntry.mesh.vertices );
+    ent.mesh.normals.swap( aEntry.mesh.normals );
+    ent.mesh.params.swap( aEntry.mesh.params );
+    ent.mesh.indices.swap( aEntry.mesh.indices );
+    ent.bytes = aEntry.bytes;
+    usage.push_front( aKey );
+    ent.lru = usage.begin();
+    memUsed += ent.bytes;
+    trim();
+    return;
+}
+
+
+void IGES_TESS_CACHE::trim( void )
+{
+    while( memUsed > memLimit && !usage.empty() )
+    {
+        map<KEY, ENTRY>::iterator sE = entries.find( usage.back() );
+        memUsed -= sE->second.bytes;
+        entries.erase( sE );
+        usage.pop_back();
+        ++nEvictions;
+    }
+
+    return;
+}
+
+
+bool IGES_TESS_CACHE::GetPolyline( IGES_CURVE* aCurve, std::vector<MCAD_POINT>& aPoints,
+    double aTolerance, bool xform )
+{
+    aPoints.clear();
+
+    if( NULL == aCurve )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    // resolve the default tolerance as IGES_CURVE::GetPolyline() does
+    if( aTolerance <= 0.0 && aCurve->GetParentIGES() )
+        aTolerance = aCurve->GetParentIGES()->globalData.minResolution;
+
+    if( aTolerance <= 0.0 )
+        aTolerance = 0.001;
+
+    KEY key;
+    makeKey( aCurve, xform, CACHE_POLYLINE, key );
+    key.bucket0 = getBucket( aTolerance );
+
+    do
+    {
+        lock_guard<mutex> lk( lock );
+        ENTRY* ep = find( key );
+
+        if( NULL == ep )
+            break;
+
+        aPoints = ep->points;
+        return true;
+
+    } while( 0 );
+
+    ENTRY ent;
+
+    if( !aCurve->GetPolyline( ent.points, getBucketTolerance( key.bucket0 ), xform ) )
+        return false;
+
+    aPoints = ent.points;
+
+    lock_guard<mutex> lk( lock );
+    insert( key, ent );
+    return true;
+}
+
+
+bool IGES_TESS_CACHE::GetMesh( IGES_ENTITY_144* aSurface, const IGES_TESSELLATOR& aTessellator,
+    IGES_MESH& aMesh )
+{
+    aMesh.Clear();
+
+    if( NULL == aSurface )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    double chordTol;
+    double angleTol;
+    aTessellator.GetTolerance( chordTol, angleTol );
+
+    KEY key;
+    makeKey( aSurface, aTessellator.GetTransform(), CACHE_MESH, key );
+    key.bucket0 = getBucket( chordTol );
+    key.bucket1 = getBucket( angleTol );
+
+    do
+    {
+        lock_guard<mutex> lk( lock );
+        ENTRY* ep = find( key );
+
+        if( NULL == ep )
+            break;
+
+        aMesh = ep->mesh;
+        return true;
+
+    } while( 0 );
+
+    IGES_TESSELLATOR tess;
+    tess.SetTolerance( getBucketTolerance( key.bucket0 ), getBucketTolerance( key.bucket1 ) );
+    tess.SetTransform( aTessellator.GetTransform() );
+
+    ENTRY ent;
+
+    if( !tess.Tessellate( aSurface, ent.mesh ) )
+        return false;
+
+    aMesh = ent.mesh;
+
+    lock_guard<mutex> lk( lock );
+    insert( key, ent );
+    return true;
+}
@@ -0,0 +1,723 @@
+/*
+ * file: iges_meshout.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: streaming export of the tessellated surfaces of a
+ * model to binary STL, binary PLY and Wavefront OBJ files.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <error_macros.h>
+#include <core/iges.h>
+#include <core/entity144.h>
+#include <core/iges_cache.h>
+#include <core/iges_pool.h>
+#include <core/iges_scene.h>
+#include <core/iges_meshout.h>
+
+
+using namespace std;
+
+// size of the output buffers
+#define MESHOUT_BUFSIZE (1 << 20)
+// number of parts per thread which may await output by default
+#define MESHOUT_PARTS_PER_THREAD (4)
+// minimum number of parts which may await output
+#define MESHOUT_MIN_WINDOW (8)
+// offset of the triangle count in a binary STL file
+#define STL_COUNT_OFFSET (80)
+
+
+// buffered output to a stdio stream
+class MESHOUT_BUFFER
+{
+private:
+    FILE* fp;
+    vector<char> buf;
+    bool ok;
+
+public:
+    MESHOUT_BUFFER( FILE* aFile ) : fp( aFile ), ok( true )
+    {
+        buf.reserve( MESHOUT_BUFSIZE );
+    }
+
+    void Put( const char* aData, size_t aSize )
+    {
+        if( buf.size() + aSize > MESHOUT_BUFSIZE )
+            Flush();
+
+        if( aSize > MESHOUT_BUFSIZE )
+        {
+            if( fwrite( aData, 1, aSize, fp ) != aSize )
+                ok = false;
+
+            return;
+        }
+
+        buf.insert( buf.end(), aData, aData + aSize );
+    }
+
+    void Put( const vector<char>& aData )
+    {
+        if( !aData.empty() )
+            Put( &aData[0], aData.size() );
+    }
+
+    bool Flush( void )
+    {
+        if( !buf.empty() && fwrite( &buf[0], 1, buf.size(), fp ) != buf.size() )
+            ok = false;
+
+        buf.clear();
+        return ok;
+    }
+
+    bool IsOK( void ) const
+    {
+        return ok;
+    }
+};
+
+
+// little-endian encoding of binary values
+static void putU8( vector<char>& aBuf, unsigned int aVal )
+{
+    aBuf.push_back( (char)( aVal & 0xff ) );
+}
+
+
+static void putU16( vector<char>& aBuf, unsigned int aVal )
+{
+    aBuf.push_back( (char)( aVal & 0xff ) );
+    aBuf.push_back( (char)( ( aVal >> 8 ) & 0xff ) );
+}
+
+
+static void putU32( vector<char>& aBuf, unsigned int aVal )
+{
+    aBuf.push_back( (char)( aVal & 0xff ) );
+    aBuf.push_back( (char)( ( aVal >> 8 ) & 0xff ) );
+    aBuf.push_back( (char)( ( aVal >> 16 ) & 0xff ) );
+    aBuf.push_back( (char)( ( aVal >> 24 ) & 0xff ) );
+}
+
+
+static void putF32( vector<char>& aBuf, double aVal )
+{
+    float f = (float)aVal;
+    unsigned int u;
+    memcpy( &u, &f, sizeof( u ) );
+    putU32( aBuf, u );
+}
+
+
+static void putPoint( vector<char>& aBuf, const MCAD_POINT& aPoint )
+{
+    putF32( aBuf, aPoint.x );
+    putF32( aBuf, aPoint.y );
+    putF32( aBuf, aPoint.z );
+}
+
+
+static void putText( vector<char>& aBuf, const char* aText )
+{
+    aBuf.insert( aBuf.end(), aText, aText + strlen( aText ) );
+}
+
+
+// a single placement of a surface
+struct MESHOUT_PART
+{
+    IGES_ENTITY_144* surface;
+    const MCAD_TRANSFORM* transform;
+    bool shared;                        // the surface is placed more than once
+};
+
+
+// an encoded part awaiting output
+struct MESHOUT_RESULT
+{
+    bool ready;
+    size_t nVertices;
+    vector<int> indices;                // triangles (PLY and OBJ only)
+    vector<char> data;                  // encoded vertices or triangles
+};
+
+
+// state shared by the workers meshing the parts
+struct MESHOUT_JOB
+{
+    IGES_MESH_FORMAT format;
+    const IGES_TESSELLATOR* tess;
+    IGES_TESS_CACHE* cache;
+    const vector<MESHOUT_PART>* parts;
+    vector<MESHOUT_RESULT> results;     // ring of parts awaiting output; part i uses
+                                        // slot i % size and may only be stored once
+                                        // part i - size has been written
+    size_t claimed;                     // number of parts taken by the workers
+    size_t next;                        // index of the next part to write
+    bool abort;                         // the output failed; remaining parts are skipped
+    mutex lock;
+    condition_variable written;         // signalled when parts have been written
+
+    MESHOUT_BUFFER* out;
+    MESHOUT_BUFFER* faces;              // PLY face spool
+    size_t nParts;
+    size_t nVertices;
+    size_t nTriangles;
+    size_t nFailed;                     // surfaces which could not be meshed
+    vector<char> scratch;               // face encoding; used with the lock held
+};
+
+
+// place a mesh into the world and encode the parts of the output
+// which do not depend on the preceding parts
+static void encodeMesh( MESHOUT_JOB* aJob, IGES_MESH& aMesh, const MCAD_TRANSFORM& aTransform,
+    MESHOUT_RESULT& aResult )
+{
+    vector<MCAD_POINT>& vp = aMesh.vertices;
+    vector<MCAD_POINT>& np = aMesh.normals;
+    vector<int>& ip = aMesh.indices;
+    size_t nv = vp.size();
+    size_t nt = ip.size() / 3;
+
+    // the transforms of subfigure instances are rotations with a
+    // uniform scale so the normals are transformed by the matrix
+    for( size_t i = 0; i < nv; ++i )
+    {
+        vp[i] = aTransform * vp[i];
+
+        if( i < np.size() )
+        {
+            MCAD_POINT n = aTransform.R * np[i];
+            double d = sqrt( n.x * n.x + n.y * n.y + n.z * n.z );
+
+            if( d > 1e-12 )
+                n *= 1.0 / d;
+
+            np[i] = n;
+        }
+    }
+
+    // a mirroring transform reverses the winding of the triangles
+    const double (*m)[3] = aTransform.R.v;
+    double det = m[0][0] * ( m[1][1] * m[2][2] - m[1][2] * m[2][1] )
+               - m[0][1] * ( m[1][0] * m[2][2] - m[1][2] * m[2][0] )
+               + m[0][2] * ( m[1][0] * m[2][1] - m[1][1] * m[2][0] );
+
+    if( det < 0.0 )
+    {
+        for( size_t i = 0; i < nt; ++i )
+        {
+            int t = ip[i * 3 + 1];
+            ip[i * 3 + 1] = ip[i * 3 + 2];
+            ip[i * 3 + 2] = t;
+        }
+    }
+
+    aResult.nVertices = nv;
+    aResult.data.clear();
+
+    switch( aJob->format )
+    {
+    case MESH_FORMAT_STL:
+        aResult.data.reserve( nt * 50 );
+
+        for( size_t i = 0; i < nt; ++i )
+        {
+            const MCAD_POINT& p0 = vp[ip[i * 3]];
+            const MCAD_POINT& p1 = vp[ip[i * 3 + 1]];
+            const MCAD_POINT& p2 = vp[ip[i * 3 + 2]];
+            MCAD_POINT e0 = p1 - p0;
+            MCAD_POINT e1 = p2 - p0;
+            MCAD_POINT n( e0.y * e1.z - e0.z * e1.y,
+                          e0.z * e1.x - e0.x * e1.z,
+                          e0.x * e1.y - e0.y * e1.x );
+            double d = sqrt( n.x * n.x + n.y * n.y + n.z * n.z );
+
+            if( d > 1e-30 )
+                n *= 1.0 / d;
+
+            putPoint( aResult.data, n );
+            putPoint( aResult.data, p0 );
+            putPoint( aResult.data, p1 );
+            putPoint( aResult.data, p2 );
+            putU16( aResult.data, 0 );
+        }
+
+        aResult.indices.clear();
+        aResult.nVertices = nt * 3;
+        break;
+
+    case MESH_FORMAT_PLY:
+        aResult.data.reserve( nv * 24 );
+
+        for( size_t i = 0; i < nv; ++i )
+        {
+            putPoint( aResult.data, vp[i] );
+            putPoint( aResult.data, i < np.size() ? np[i] : MCAD_POINT( 0.0, 0.0, 0.0 ) );
+        }
+
+        aResult.indices.swap( ip );
+        break;
+
+    default:
+        do
+        {
+            char tbuf[128];
+
+            for( size_t i = 0; i < nv; ++i )
+            {
+                sprintf( tbuf, "v %.9g %.9g %.9g\n", vp[i].x, vp[i].y, vp[i].z );
+                putText( aResult.data, tbuf );
+            }
+
+            for( size_t i = 0; i < nv; ++i )
+            {
+                MCAD_POINT n = i < np.size() ? np[i] : MCAD_POINT( 0.0, 0.0, 0.0 );
+                sprintf( tbuf, "vn %.6g %.6g %.6g\n", n.x, n.y, n.z );
+                putText( aResult.data, tbuf );
+            }
+
+        } while( 0 );
+
+        aResult.indices.swap( ip );
+        break;
+    }
+
+    return;
+}
+
+
+// write a part; must be called with the lock held and in order
+static void writePart( MESHOUT_JOB* aJob, MESHOUT_RESULT& aResult )
+{
+    size_t nt = aResult.indices.size() / 3;
+    vector<char>& sb = aJob->scratch;
+
+    switch( aJob->format )
+    {
+    case MESH_FORMAT_STL:
+        aJob->out->Put( aResult.data );
+        nt = aResult.data.size() / 50;
+        break;
+
+    case MESH_FORMAT_PLY:
+        aJob->out->Put( aResult.data );
+        sb.clear();
+
+        for( size_t i = 0; i < aResult.indices.size(); ++i )
+        {
+            if( 0 == i % 3 )
+                putU8( sb, 3 );
+
+            putU32( sb, (unsigned int)( aResult.indices[i] + aJob->nVertices ) );
+        }
+
+        aJob->faces->Put( sb );
+        break;
+
+    default:
+        do
+        {
+            char tbuf[128];
+            sb.clear();
+            sprintf( tbuf, "g part%lu\n", (unsigned long)aJob->nParts );
+            putText( sb, tbuf );
+            aJob->out->Put( sb );
+            aJob->out->Put( aResult.data );
+            sb.clear();
+
+            // OBJ indices are 1-based
+            for( size_t i = 0; i < nt; ++i )
+            {
+                unsigned long i0 = aResult.indices[i * 3] + aJob->nVertices + 1;
+                unsigned long i1 = aResult.indices[i * 3 + 1] + aJob->nVertices + 1;
+                unsigned long i2 = aResult.indices[i * 3 + 2] + aJob->nVertices + 1;
+                sprintf( tbuf, "f %lu//%lu %lu//%lu %lu//%lu\n", i0, i0, i1, i1, i2, i2 );
+                putText( sb, tbuf );
+            }
+
+            aJob->out->Put( sb );
+
+        } while( 0 );
+
+        break;
+    }
+
+    ++aJob->nParts;
+    aJob->nVertices += aResult.nVertices;
+    aJob->nTriangles += nt;
+    return;
+}
+
+
+// Each call takes the next part in order rather than the part given by
+// aTask; since the parts are taken in order the earliest unwritten part
+// is always being meshed by a worker which is not waiting for a slot.
+static void meshTask( void* aData, size_t aTask, int aWorker )
+{
+    (void)aTask;
+    (void)aWorker;
+    MESHOUT_JOB* job = (MESHOUT_JOB*)aData;
+    size_t idx;
+
+    do
+    {
+        lock_guard<mutex> lk( job->lock );
+
+        if( job->abort )
+            return;
+
+        idx = job->claimed++;
+    } while( 0 );
+
+    const MESHOUT_PART& part = (*job->parts)[idx];
+    MESHOUT_RESULT res;
+    IGES_MESH mesh;
+    bool ok;
+
+    if( part.shared && NULL != job->cache )
+        ok = job->cache->GetMesh( part.surface, *job->tess, mesh );
+    else
+        ok = job->tess->Tessellate( part.surface, mesh );
+
+    if( ok && !mesh.indices.empty() )
+        encodeMesh( job, mesh, *part.transform, res );
+    else
+        ok = false;
+
+    size_t nr = job->results.size();
+    unique_lock<mutex> lk( job->lock );
+
+    // wait for the slot of the part to be written out
+    while( idx >= job->next + nr && !job->abort )
+        job->written.wait( lk );
+
+    if( job->abort )
+        return;
+
+    MESHOUT_RESULT& slot = job->results[idx % nr];
+    slot.nVertices = res.nVertices;
+    slot.indices.swap( res.indices );
+    slot.data.swap( res.data );
+    slot.ready = true;
+
+    if( !ok )
+        ++job->nFailed;
+
+    // write all parts which are now ready in order
+    size_t first = job->next;
+
+    while( job->results[job->next % nr].ready )
+    {
+        MESHOUT_RESULT& rp = job->results[job->next % nr];
+
+        if( !rp.data.empty() )
+            writePart( job, rp );
+
+        rp.ready = false;
+        vector<int>().swap( rp.indices );
+        vector<char>().swap( rp.data );
+        ++job->next;
+    }
+
+    if( !job->out->IsOK() || !job->faces->IsOK() )
+        job->abort = true;
+
+    if( job->next != first || job->abort )
+        job->written.notify_all();
+
+    return;
+}
+
+
+IGES_MESH_WRITER::IGES_MESH_WRITER()
+{
+    window = 0;
+    nParts = 0;
+    nVertices = 0;
+    nTriangles = 0;
+    nFailed = 0;
+    tess.SetTransform( true );
+    return;
+}
+
+
+IGES_MESH_WRITER::~IGES_MESH_WRITER()
+{
+    return;
+}
+
+
+void IGES_MESH_WRITER::SetTolerance( double aChordTol, double aAngleTol )
+{
+    tess.SetTolerance( aChordTol, aAngleTol );
+    return;
+}
+
+
+void IGES_MESH_WRITER::SetWindow( size_t aNParts )
+{
+    window = aNParts;
+    return;
+}
+
+
+void IGES_MESH_WRITER::GetStats( size_t& aNParts, size_t& aNVertices, size_t& aNTriangles,
+    size_t& aNFailed ) const
+{
+    aNParts = nParts;
+    aNVertices = nVertices;
+    aNTriangles = nTriangles;
+    aNFailed = nFailed;
+    return;
+}
+
+
+bool IGES_MESH_WRITER::Write( IGES* aModel, const char* aFileName, IGES_MESH_FORMAT aFormat,
+    int aNThreads )
+{
+    nParts = 0;
+    nVertices = 0;
+    nTriangles = 0;
+    nFailed = 0;
+
+    if( NULL == aModel || NULL == aFileName )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    if( aFormat != MESH_FORMAT_STL && aFormat != MESH_FORMAT_PLY
+        && aFormat != MESH_FORMAT_OBJ )
+    {
+        ERRMSG << "\n + [INFO] [BUG] invalid mesh format: " << aFormat << "\n";
+        return false;
+    }
+
+    // list the placements of all surfaces; the instance transforms
+    // are owned by the scene
+    IGES_SCENE scene;
+    vector<MESHOUT_PART> parts;
+    scene.Build( aModel );
+
+    vector<size_t> nUses( scene.GetNDefinitions(), 0 );
+
+    for( size_t i = 0; i < scene.GetNInstances(); ++i )
+        ++nUses[scene.GetInstance( i )->definition];
+
+    for( size_t i = 0; i < scene.GetNInstances(); ++i )
+    {
+        const IGES_SCENE_INSTANCE* ip = scene.GetInstance( i );
+        const IGES_SCENE_DEF* dp = scene.GetDefinition( ip->definition );
+
+        for( size_t j = 0; j < dp->surfaces.size(); ++j )
+        {
+            MESHOUT_PART part;
+            part.surface = dp->surfaces[j];
+            part.transform = &ip->transform;
+            part.shared = nUses[ip->definition] > 1;
+            parts.push_back( part );
+        }
+    }
+
+    FILE* fp = fopen( aFileName, "wb" );
+
+    if( NULL == fp )
+    {
+        ERRMSG << "\n + [INFO] could not open file\n";
+        cerr << " + filename: '" << aFileName << "'\n";
+        return false;
+    }
+
+    FILE* fspool = NULL;
+
+    if( MESH_FORMAT_PLY == aFormat )
+    {
+        fspool = tmpfile();
+
+        if( NULL == fspool )
+        {
+            ERRMSG << "\n + [INFO] could not create a temporary file\n";
+            fclose( fp );
+            return false;
+        }
+    }
+
+    MESHOUT_BUFFER out( fp );
+    MESHOUT_BUFFER faces( fspool );
+    vector<char> hdr;
+    long offVertex = 0;     // offsets of the PLY element counts
+    long offFace = 0;
+
+    // headers; counts are written once they are known
+    switch( aFormat )
+    {
+    case MESH_FORMAT_STL:
+        hdr.resize( STL_COUNT_OFFSET, ' ' );
+        memcpy( &hdr[0], "libIGES binary STL", 18 );
+        putU32( hdr, 0 );
+        break;
+
+    case MESH_FORMAT_PLY:
+        putText( hdr, "ply\nformat binary_little_endian 1.0\ncomment libIGES\n" );
+        putText( hdr, "element vertex " );
+        offVertex = (long)hdr.size();
+        putText( hdr, "0000000000\n" );
+        putText( hdr, "property float x\nproperty float y\nproperty float z\n" );
+        putText( hdr, "property float nx\nproperty float ny\nproperty float nz\n" );
+        putText( hdr, "element face " );
+        offFace = (long)hdr.size();
+        putText( hdr, "0000000000\n" );
+        putText( hdr, "property list uchar int vertex_indices\nend_header\n" );
+        break;
+
+    default:
+        putText( hdr, "# libIGES\n" );
+        break;
+    }
+
+    out.Put( hdr );
+
+    size_t nw = window;
+
+    if( 0 == nw )
+    {
+        nw = (size_t)IGES_WORK_POOL::GetNThreads( aNThreads ) * MESHOUT_PARTS_PER_THREAD;
+
+        if( nw < MESHOUT_MIN_WINDOW )
+            nw = MESHOUT_MIN_WINDOW;
+    }
+
+    MESHOUT_JOB job;
+    job.format = aFormat;
+    job.tess = &tess;
+    job.cache = aModel->GetTessCache();
+    job.parts = &parts;
+    job.claimed = 0;
+    job.next = 0;
+    job.abort = false;
+    job.out = &out;
+    job.faces = &faces;
+    job.nParts = 0;
+    job.nVertices = 0;
+    job.nTriangles = 0;
+    job.nFailed = 0;
+
+    // a single batch over all parts; the workers are kept busy while the
+    // number of parts awaiting output is bounded by the size of the ring
+    if( !parts.empty() )
+    {
+        job.results.resize( nw );
+
+        for( size_t i = 0; i < nw; ++i )
+        {
+            job.results[i].ready = false;
+            job.results[i].nVertices = 0;
+        }
+
+        IGES_WORK_POOL::Run( parts.size(), meshTask, &job, aNThreads );
+    }
+
+    bool ok = true;
+
+    if( MESH_FORMAT_PLY == aFormat && faces.Flush() )
+    {
+        // append the spooled faces
+        vector<char> blk( MESHOUT_BUFSIZE );
+        size_t nr;
+
+        rewind( fspool );
+
+        while( ( nr = fread( &blk[0], 1, blk.size(), fspool ) ) > 0 )
+            out.Put( &blk[0], nr );
+
+        if( ferror( fspool ) )
+            ok = false;
+    }
+
+    if( !out.Flush() || !faces.IsOK() )
+        ok = false;
+
+    if( ok && MESH_FORMAT_PLY == aFormat && job.nVertices > 0xffffffffUL )
+    {
+        ERRMSG << "\n + [INFO] too many vertices for the file format\n";
+        ok = false;
+    }
+
+    // write the counts
+    if( ok && MESH_FORMAT_STL == aFormat )
+    {
+        hdr.clear();
+        putU32( hdr, (unsigned int)job.nTriangles );
+
+        if( fseek( fp, STL_COUNT_OFFSET, SEEK_SET )
+            || fwrite( &hdr[0], 1, hdr.size(), fp ) != hdr.size() )
+            ok = false;
+    }
+    else if( ok && MESH_FORMAT_PLY == aFormat )
+    {
+        char tbuf[32];
+        sprintf( tbuf, "%010lu", (unsigned long)job.nVertices );
+
+        if( fseek( fp, offVertex, SEEK_SET ) || fwrite( tbuf, 1, 10, fp ) != 10 )
+            ok = false;
+
+        sprintf( tbuf, "%010lu", (unsigned long)job.nTriangles );
+
+        if( ok && ( fseek( fp, offFace, SEEK_SET ) || fwrite( tbuf, 1, 10, fp ) != 10 ) )
+            ok = false;
+    }
+
+    if( NULL != fspool )
+        fclose( fspool );
+
+    if( fclose( fp ) )
+        ok = false;
+
+    if( !ok )
+    {
+        ERRMSG << "\n + [INFO] could not write file\n";
+        cerr << " + filename: '" << aFileName << "'\n";
+        return false;
+    }
+
+    if( job.nFailed > 0 )
+    {
+        ERRMSG << "\n + [WARNING]: " << job.nFailed << " surfaces could not be meshed";
+        cerr << " and were not written\n";
+        cerr << " + filename: '" << aFileName << "'\n";
+    }
+
+    nParts = job.nParts;
+    nVertices = job.nVertices;
+    nTriangles = job.nTriangles;
+    nFailed = job.nFailed;
+    return true;
+}
@@ -0,0 +1,193 @@
+/*
+ * file: iges_pool.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: work stealing thread pool for running a batch of
+ * independent tasks of uneven cost.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <core/iges_pool.h>
+
+using namespace std;
+
+
+// the range of tasks not yet taken by a worker
+struct POOL_RANGE
+{
+    mutex lock;
+    size_t first;
+    size_t last;
+};
+
+
+struct POOL_BATCH
+{
+    IGES_WORK_POOL::TASK task;
+    void* data;
+    vector<POOL_RANGE> ranges;
+
+    POOL_BATCH( size_t aNWorkers ) : ranges( aNWorkers ) {}
+};
+
+
+// take the task at the front of a worker's own range
+static bool takeTask( POOL_RANGE& aRange, size_t& aTask )
+{
+    lock_guard<mutex> lk( aRange.lock );
+
+    if( aRange.first >= aRange.last )
+        return false;
+
+    aTask = aRange.first++;
+    return true;
+}
+
+
+// move the back half of the largest range of another worker to the
+// worker's own range, which must be empty; returns false if no tasks remain
+static bool stealTasks( POOL_BATCH& aBatch, int aWorker )
+{
+    int nw = (int)aBatch.ranges.size();
+
+    while( true )
+    {
+        int victim = -1;
+        size_t best = 0;
+
+        for( int i = 0; i < nw; ++i )
+        {
+            if( i == aWorker )
+                continue;
+
+            POOL_RANGE& r = aBatch.ranges[i];
+            lock_guard<mutex> lk( r.lock );
+
+            if( r.last > r.first && r.last - r.first > best )
+            {
+                best = r.last - r.first;
+                victim = i;
+            }
+        }
+
+        if( victim < 0 )
+            return false;
+
+        size_t first = 0;
+        size_t last = 0;
+
+        do
+        {
+            POOL_RANGE& r = aBatch.ranges[victim];
+            lock_guard<mutex> lk( r.lock );
+
+            if( r.first >= r.last )
+                break;
+
+            first = r.first + ( r.last - r.first ) / 2;
+            last = r.last;
+            r.last = first;
+        } while( 0 );
+
+        // the victim may have run out of tasks in the meantime
+        if( last <= first )
+            continue;
+
+        POOL_RANGE& own = aBatch.ranges[aWorker];
+        lock_guard<mutex> lk( own.lock );
+        own.first = first;
+        own.last = last;
+        return true;
+    }
+}
+
+
+static void runWorker( POOL_BATCH* aBatch, int aWorker )
+{
+    size_t task;
+
+    do
+    {
+        while( takeTask( aBatch->ranges[aWorker], task ) )
+            aBatch->task( aBatch->data, task, aWorker );
+
+    } while( stealTasks( *aBatch, aWorker ) );
+
+    return;
+}
+
+
+int IGES_WORK_POOL::GetNThreads( int aNThreads )
+{
+    if( aNThreads > 0 )
+        return aNThreads;
+
+    int nt = (int)thread::hardware_concurrency();
+
+    return nt > 0 ? nt : 1;
+}
+
+
+void IGES_WORK_POOL::Run( size_t aNTasks, TASK aTask, void* aData, int aNThreads )
+{
+    if( 0 == aNTasks || NULL == aTask )
+        return;
+
+    size_t nw = (size_t)GetNThreads( aNThreads );
+
+    if( nw > aNTasks )
+        nw = aNTasks;
+
+    if( nw < 2 )
+    {
+        for( size_t i = 0; i < aNTasks; ++i )
+            aTask( aData, i, 0 );
+
+        return;
+    }
+
+    POOL_BATCH batch( nw );
+    batch.task = aTask;
+    batch.data = aData;
+
+    for( size_t i = 0; i < nw; ++i )
+    {
+        batch.ranges[i].first = aNTasks * i / nw;
+        batch.ranges[i].last = aNTasks * ( i + 1 ) / nw;
+    }
+
+    // the calling thread acts as worker 0
+    vector<thread> workers;
+    workers.reserve( nw - 1 );
+
+    for( size_t i = 1; i < nw; ++i )
+        workers.push_back( thread( runWorker, &batch, (int)i ) );
+
+    runWorker( &batch, 0 );
+
+    for( size_t i = 0; i < workers.size(); ++i )
+        workers[i].join();
+
+    return;
+}
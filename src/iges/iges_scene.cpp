@@ -0,0 +1,346 @@
+/*
+ * file: iges_scene.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: instanced scene extracted from a model; each Subfigure
+ * Definition (308) is meshed once and every Singular Subfigure
+ * Instance (408) refers to those meshes with a world transform.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <map>
+#include <set>
+#include <error_macros.h>
+#include <core/iges.h>
+#include <core/entity124.h>
+#include <core/entity144.h>
+#include <core/entity308.h>
+#include <core/entity408.h>
+#include <core/iges_scene.h>
+
+
+using namespace std;
+
+
+// state shared by the recursive instance walk
+struct SCENE_WALK
+{
+    map<IGES_ENTITY_308*, int> defIndex;        // index of each definition within the scene
+    map<IGES_ENTITY_308*, vector<IGES_ENTITY_408*> > nested;   // instances within each definition
+    set<IGES_ENTITY_308*> used;                 // definitions which are instanced
+    set<IGES_ENTITY_308*> active;               // definitions on the current path
+    vector<IGES_SCENE_DEF>* defs;
+    vector<IGES_SCENE_INSTANCE>* instances;
+};
+
+
+// mark a definition and all definitions nested within it as used
+static void markUsed( SCENE_WALK& aWalk, IGES_ENTITY_408* aInstance )
+{
+    IGES_ENTITY_308* def = NULL;
+
+    if( !aInstance->GetDE( def ) || NULL == def
+        || !aWalk.used.insert( def ).second )
+        return;
+
+    map<IGES_ENTITY_308*, vector<IGES_ENTITY_408*> >::iterator sN = aWalk.nested.find( def );
+
+    if( sN == aWalk.nested.end() )
+        return;
+
+    for( size_t i = 0; i < sN->second.size(); ++i )
+        markUsed( aWalk, sN->second[i] );
+
+    return;
+}
+
+
+// return the transform which places a subfigure instance in the
+// space of the entity which refers to it
+static MCAD_TRANSFORM getInstanceTransform( IGES_ENTITY_408* aInstance )
+{
+    MCAD_TRANSFORM tx;
+    tx.R *= aInstance->S;
+    tx.T = MCAD_POINT( aInstance->X, aInstance->Y, aInstance->Z );
+
+    IGES_ENTITY* ep = NULL;
+
+    if( aInstance->GetTransform( &ep ) )
+        tx = ((IGES_ENTITY_124*)ep)->GetTransformMatrix() * tx;
+
+    return tx;
+}
+
+
+// record the instances of a definition and of all definitions nested within it
+static void walkInstance( SCENE_WALK& aWalk, IGES_ENTITY_408* aInstance,
+    IGES_ENTITY_408* aOuter, const MCAD_TRANSFORM& aParent )
+{
+    IGES_ENTITY_308* def = NULL;
+
+    if( !aInstance->GetDE( def ) || NULL == def )
+        return;
+
+    // a definition which instances itself cannot be expanded
+    if( aWalk.active.find( def ) != aWalk.active.end() )
+    {
+        ERRMSG << "\n + [CORRUPT FILE] recursive Subfigure Definition\n";
+        return;
+    }
+
+    MCAD_TRANSFORM world = aParent * getInstanceTransform( aInstance );
+    map<IGES_ENTITY_308*, int>::iterator sD = aWalk.defIndex.find( def );
+
+    if( sD != aWalk.defIndex.end() && !(*aWalk.defs)[sD->second].surfaces.empty() )
+    {
+        IGES_SCENE_INSTANCE inst;
+        inst.definition = sD->second;
+        inst.transform = world;
+        inst.instance = aOuter;
+        aWalk.instances->push_back( inst );
+    }
+
+    map<IGES_ENTITY_308*, vector<IGES_ENTITY_408*> >::iterator sN = aWalk.nested.find( def );
+
+    if( sN == aWalk.nested.end() )
+        return;
+
+    aWalk.active.insert( def );
+
+    for( size_t i = 0; i < sN->second.size(); ++i )
+        walkInstance( aWalk, sN->second[i], aOuter, world );
+
+    aWalk.active.erase( def );
+    return;
+}
+
+
+IGES_SCENE::IGES_SCENE()
+{
+    return;
+}
+
+
+IGES_SCENE::~IGES_SCENE()
+{
+    return;
+}
+
+
+void IGES_SCENE::Clear( void )
+{
+    defs.clear();
+    instances.clear();
+    return;
+}
+
+
+bool IGES_SCENE::Build( IGES* aModel )
+{
+    Clear();
+
+    if( NULL == aModel )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    SCENE_WALK walk;
+    walk.defs = &defs;
+    walk.instances = &instances;
+
+    // surfaces and instances which belong to a definition
+    set<IGES_ENTITY*> members;
+    map<IGES_ENTITY_308*, vector<IGES_ENTITY_144*> > defSurfaces;
+    size_t nl = 0;
+    IGES_ENTITY* const* lp = NULL;
+
+    // the definition of independent surfaces is always index 0
+    defs.push_back( IGES_SCENE_DEF() );
+    defs.back().definition = NULL;
+
+    if( aModel->GetEntitiesByType( ENT_SUBFIGURE_DEFINITION, nl, lp ) )
+    {
+        for( size_t i = 0; i < nl; ++i )
+        {
+            IGES_ENTITY_308* def = (IGES_ENTITY_308*)lp[i];
+            size_t nd = 0;
+            IGES_ENTITY** dp = NULL;
+
+            walk.defIndex[def] = (int)defs.size();
+            defs.push_back( IGES_SCENE_DEF() );
+            defs.back().definition = def;
+
+            if( !def->GetDEList( nd, dp ) )
+                continue;
+
+            for( size_t j = 0; j < nd; ++j )
+            {
+                members.insert( dp[j] );
+
+                if( ENT_TRIMMED_PARAMETRIC_SURFACE == dp[j]->GetEntityType() )
+                    defSurfaces[def].push_back( (IGES_ENTITY_144*)dp[j] );
+                else if( ENT_SINGULAR_SUBFIGURE_INSTANCE == dp[j]->GetEntityType() )
+                    walk.nested[def].push_back( (IGES_ENTITY_408*)dp[j] );
+            }
+        }
+    }
+
+    // only the definitions which are instanced are meshed
+    vector<IGES_ENTITY_408*> roots;
+
+    if( aModel->GetEntitiesByType( ENT_SINGULAR_SUBFIGURE_INSTANCE, nl, lp ) )
+    {
+        for( size_t i = 0; i < nl; ++i )
+        {
+            if( members.find( lp[i] ) == members.end() )
+                roots.push_back( (IGES_ENTITY_408*)lp[i] );
+        }
+    }
+
+    for( size_t i = 0; i < roots.size(); ++i )
+        markUsed( walk, roots[i] );
+
+    map<IGES_ENTITY_308*, vector<IGES_ENTITY_144*> >::iterator sS = defSurfaces.begin();
+
+    while( sS != defSurfaces.end() )
+    {
+        if( walk.used.find( sS->first ) != walk.used.end() )
+            defs[walk.defIndex[sS->first]].surfaces.swap( sS->second );
+
+        ++sS;
+    }
+
+    if( aModel->GetEntitiesByType( ENT_TRIMMED_PARAMETRIC_SURFACE, nl, lp ) )
+    {
+        for( size_t i = 0; i < nl; ++i )
+        {
+            if( members.find( lp[i] ) == members.end() )
+                defs[0].surfaces.push_back( (IGES_ENTITY_144*)lp[i] );
+        }
+    }
+
+    if( !defs[0].surfaces.empty() )
+    {
+        IGES_SCENE_INSTANCE inst;
+        inst.definition = 0;
+        inst.instance = NULL;
+        instances.push_back( inst );
+    }
+
+    MCAD_TRANSFORM ident;
+
+    for( size_t i = 0; i < roots.size(); ++i )
+        walkInstance( walk, roots[i], roots[i], ident );
+
+    return !instances.empty();
+}
+
+
+bool IGES_SCENE::Build( IGES* aModel, const IGES_TESSELLATOR& aTessellator, int aNThreads )
+{
+    if( !Build( aModel ) )
+        return false;
+
+    // mesh all surfaces in a single batch so that the work of all
+    // definitions is shared among the threads
+    vector<IGES_ENTITY_144*> surfaces;
+
+    for( size_t i = 0; i < defs.size(); ++i )
+        surfaces.insert( surfaces.end(), defs[i].surfaces.begin(), defs[i].surfaces.end() );
+
+    IGES_TESSELLATOR tess( aTessellator );
+    tess.SetTransform( true );
+
+    vector<IGES_MESH> meshes;
+    tess.Tessellate( surfaces, meshes, aNThreads );
+
+    size_t idx = 0;
+
+    for( size_t i = 0; i < defs.size(); ++i )
+    {
+        defs[i].meshes.resize( defs[i].surfaces.size() );
+
+        for( size_t j = 0; j < defs[i].surfaces.size(); ++j, ++idx )
+        {
+            IGES_MESH& mesh = defs[i].meshes[j];
+            mesh.surface = meshes[idx].surface;
+            mesh.vertices.swap( meshes[idx].vertices );
+            mesh.normals.swap( meshes[idx].normals );
+            mesh.params.swap( meshes[idx].params );
+            mesh.indices.swap( meshes[idx].indices );
+        }
+    }
+
+    return true;
+}
+
+
+size_t IGES_SCENE::GetNDefinitions( void ) const
+{
+    return defs.size();
+}
+
+
+const IGES_SCENE_DEF* IGES_SCENE::GetDefinition( size_t aIndex ) const
+{
+    if( aIndex >= defs.size() )
+        return NULL;
+
+    return &defs[aIndex];
+}
+
+
+size_t IGES_SCENE::GetNInstances( void ) const
+{
+    return instances.size();
+}
+
+
+const IGES_SCENE_INSTANCE* IGES_SCENE::GetInstance( size_t aIndex ) const
+{
+    if( aIndex >= instances.size() )
+        return NULL;
+
+    return &instances[aIndex];
+}
+
+
+void IGES_SCENE::GetNTriangles( size_t& aMeshed, size_t& aExpanded ) const
+{
+    aMeshed = 0;
+    aExpanded = 0;
+
+    vector<size_t> nt( defs.size(), 0 );
+
+    for( size_t i = 0; i < defs.size(); ++i )
+    {
+        for( size_t j = 0; j < defs[i].meshes.size(); ++j )
+            nt[i] += defs[i].meshes[j].indices.size() / 3;
+
+        aMeshed += nt[i];
+    }
+
+    for( size_t i = 0; i < instances.size(); ++i )
+        aExpanded += nt[instances[i].definition];
+
+    return;
+}
@@ -0,0 +1,2772 @@
+/*
+ * file: iges_tess.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: tessellation of Trimmed Parametric Surfaces (Entity 144)
+ * into indexed triangle meshes.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * The polygon triangulation (class TESS_EARCUT) is a port of the
+ * earcut library by Mapbox (https://github.com/mapbox/earcut) and is
+ * distributed under the following license:
+ *
+ * ISC License
+ *
+ * Copyright (c) 2016, Mapbox
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose
+ * with or without fee is hereby granted, provided that the above copyright notice
+ * and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ * THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+ * IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+ * CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA
+ * OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+ * ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <cmath>
+#include <map>
+#include <algorithm>
+#include <error_macros.h>
+#include <core/iges.h>
+#include <core/iges_curve.h>
+#include <core/entity120.h>
+#include <core/entity124.h>
+#include <core/entity128.h>
+#include <core/entity142.h>
+#include <core/entity144.h>
+#include <core/entity186.h>
+#include <core/entity510.h>
+#include <core/entity514.h>
+#include <core/iges_pool.h>
+#include <core/iges_tess.h>
+#include <core/iges_topology.h>
+
+using namespace std;
+
+// default chord tolerance (model units)
+#define TESS_DEFAULT_CHORD (0.01)
+// default angle tolerance (radians)
+#define TESS_DEFAULT_ANGLE (M_PI / 12.0)
+// number of samples along each parameter used to estimate the surface speed
+#define TESS_NSAMPLES (9)
+// maximum number of triangles in the mesh of a single surface
+#define TESS_MAX_TRIS (1 << 20)
+// fraction of the estimated parameter step used to divide the boundary
+#define TESS_STEP_MARGIN (0.9)
+// maximum number of segments into which a boundary segment is divided
+#define TESS_MAX_SEGS (1024)
+// minimum number of vertices for which the triangulation uses z-order hashing
+#define TESS_EARCUT_HASH (80)
+// maximum length of a longest edge propagation path
+#define TESS_MAX_LEPP (1024)
+// maximum number of Newton iterations when inverting a surface point
+#define TESS_MAX_NEWTON (32)
+
+
+static inline MCAD_POINT tessCross( const MCAD_POINT& a, const MCAD_POINT& b )
+{
+    return MCAD_POINT( a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x );
+}
+
+
+static inline double tessDot( const MCAD_POINT& a, const MCAD_POINT& b )
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+
+static inline bool tessNormalize( MCAD_POINT& a )
+{
+    double len = sqrt( tessDot( a, a ) );
+
+    if( len < 1e-300 )
+    {
+        a = MCAD_POINT( 0.0, 0.0, 0.0 );
+        return false;
+    }
+
+    a *= 1.0 / len;
+    return true;
+}
+
+
+// distance from point p to the line through a and b
+static double tessLineDist( const MCAD_POINT& p, const MCAD_POINT& a, const MCAD_POINT& b )
+{
+    MCAD_POINT ab = b - a;
+    MCAD_POINT ap = p - a;
+    double l2 = tessDot( ab, ab );
+
+    if( l2 < 1e-300 )
+        return sqrt( tessDot( ap, ap ) );
+
+    MCAD_POINT c = tessCross( ab, ap );
+    return sqrt( tessDot( c, c ) / l2 );
+}
+
+
+// distance from point p to the plane through a, b and c
+static double tessPlaneDist( const MCAD_POINT& p, const MCAD_POINT& a,
+    const MCAD_POINT& b, const MCAD_POINT& c )
+{
+    MCAD_POINT n = tessCross( b - a, c - a );
+
+    if( !tessNormalize( n ) )
+        return tessLineDist( p, a, b );
+
+    return fabs( tessDot( p - a, n ) );
+}
+
+
+// underlying surface of a trimmed surface
+struct TESS_SURF
+{
+    IGES_ENTITY_128* nurbs;
+    IGES_ENTITY_120* rev;
+    bool xform;
+    bool useT;
+    MCAD_TRANSFORM T;   // transform of the trimmed surface entity
+    double u0;
+    double u1;
+    double v0;
+    double v1;
+
+    TESS_SURF() : nurbs( NULL ), rev( NULL ), xform( true ), useT( false ),
+        u0( 0.0 ), u1( 1.0 ), v0( 0.0 ), v1( 1.0 ) {}
+
+    bool init( IGES_ENTITY_144* aSurface, bool aXform );
+    bool initSurface( IGES_ENTITY* aSurface, bool aXform );
+    bool eval( double aU, double aV, MCAD_POINT& aPoint, MCAD_POINT& aNormal,
+        MCAD_POINT* aDerivU = NULL, MCAD_POINT* aDerivV = NULL ) const;
+    double invert( const MCAD_POINT& aPoint, double& aU, double& aV ) const;
+};
+
+
+bool TESS_SURF::init( IGES_ENTITY_144* aSurface, bool aXform )
+{
+    IGES_ENTITY* ps = NULL;
+
+    if( !aSurface->GetPTS( ps ) )
+    {
+        ERRMSG << "\n + [INFO] trimmed surface has no underlying surface\n";
+        return false;
+    }
+
+    if( !initSurface( ps, aXform ) )
+        return false;
+
+    IGES_ENTITY* tx = NULL;
+
+    if( xform && aSurface->GetTransform( &tx ) )
+    {
+        T = ((IGES_ENTITY_124*)tx)->GetTransformMatrix();
+        useT = true;
+    }
+
+    return true;
+}
+
+
+bool TESS_SURF::initSurface( IGES_ENTITY* aSurface, bool aXform )
+{
+    IGES_ENTITY* ps = aSurface;
+
+    if( NULL == ps )
+    {
+        ERRMSG << "\n + [INFO] no underlying surface\n";
+        return false;
+    }
+
+    xform = aXform;
+
+    switch( ps->GetEntityType() )
+    {
+        case ENT_NURBS_SURFACE:
+            do
+            {
+                int nc1, nc2;
+                int order1, order2;
+                double* knot1;
+                double* knot2;
+                double* coeff;
+                bool rational;
+                bool closed1, closed2;
+                bool periodic1, periodic2;
+
+                nurbs = (IGES_ENTITY_128*)ps;
+
+                if( !nurbs->GetNURBSData( nc1, nc2, order1, order2, &knot1, &knot2,
+                    &coeff, rational, closed1, closed2, periodic1, periodic2,
+                    u0, u1, v0, v1 ) )
+                    return false;
+
+            } while( 0 );
+
+            break;
+
+        case ENT_SURFACE_OF_REVOLUTION:
+            rev = (IGES_ENTITY_120*)ps;
+
+            if( !rev->GetParameterRange( u0, u1, v0, v1 ) )
+                return false;
+
+            break;
+
+        default:
+            ERRMSG << "\n + [INFO] unsupported surface type: " << ps->GetEntityType() << "\n";
+            return false;
+            break;
+    }
+
+    if( u1 <= u0 || v1 <= v0 )
+    {
+        ERRMSG << "\n + [INFO] invalid parameter range\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+bool TESS_SURF::eval( double aU, double aV, MCAD_POINT& aPoint, MCAD_POINT& aNormal,
+    MCAD_POINT* aDerivU, MCAD_POINT* aDerivV ) const
+{
+    MCAD_POINT du;
+    MCAD_POINT dv;
+
+    if( nurbs )
+    {
+        if( !nurbs->EvaluateGrid( 1, &aU, 1, &aV, &aPoint, &du, &dv, NULL, xform ) )
+            return false;
+    }
+    else if( !rev->Evaluate( 1, &aU, &aV, &aPoint, &du, &dv, xform ) )
+    {
+        return false;
+    }
+
+    if( useT )
+    {
+        aPoint = T * aPoint;
+        du = T.R * du;
+        dv = T.R * dv;
+    }
+
+    // the normal is taken from the transformed derivatives so that it
+    // agrees with the orientation of the triangles
+    aNormal = tessCross( du, dv );
+    tessNormalize( aNormal );
+
+    if( aDerivU )
+        *aDerivU = du;
+
+    if( aDerivV )
+        *aDerivV = dv;
+
+    return true;
+}
+
+
+// find the parameters of the point of the surface nearest to the given
+// point by Newton iteration from the given parameters; returns the distance
+// between the points or a negative value if the surface cannot be evaluated
+double TESS_SURF::invert( const MCAD_POINT& aPoint, double& aU, double& aV ) const
+{
+    MCAD_POINT p;
+    MCAD_POINT n;
+    MCAD_POINT du;
+    MCAD_POINT dv;
+    double epsU = ( u1 - u0 ) * 1e-12;
+    double epsV = ( v1 - v0 ) * 1e-12;
+
+    for( int i = 0; i < TESS_MAX_NEWTON; ++i )
+    {
+        if( !eval( aU, aV, p, n, &du, &dv ) )
+            return -1.0;
+
+        MCAD_POINT r = aPoint - p;
+        double a = tessDot( du, du );
+        double b = tessDot( du, dv );
+        double c = tessDot( dv, dv );
+        double f = tessDot( du, r );
+        double g = tessDot( dv, r );
+        double det = a * c - b * b;
+        double stepU = 0.0;
+        double stepV = 0.0;
+
+        // at a degenerate point (a pole) only the regular direction is used
+        if( det > 1e-12 * a * c && det > 0.0 )
+        {
+            stepU = ( c * f - b * g ) / det;
+            stepV = ( a * g - b * f ) / det;
+        }
+        else if( a >= c && a > 0.0 )
+        {
+            stepU = f / a;
+        }
+        else if( c > 0.0 )
+        {
+            stepV = g / c;
+        }
+
+        aU = min( u1, max( u0, aU + stepU ) );
+        aV = min( v1, max( v0, aV + stepV ) );
+
+        if( fabs( stepU ) <= epsU && fabs( stepV ) <= epsV )
+            break;
+    }
+
+    if( !eval( aU, aV, p, n ) )
+        return -1.0;
+
+    p -= aPoint;
+    return sqrt( tessDot( p, p ) );
+}
+
+
+// Triangulation of a polygon with holes by ear clipping, ported from the
+// Mapbox earcut library (ISC license, see above); holes are joined
+// to the outer boundary by bridges and the result is clipped as a single
+// polygon. Degenerate input is handled by progressively more permissive
+// passes which remove collinear points, cure local self-intersections and
+// finally split the polygon along valid diagonals.
+class TESS_EARCUT
+{
+private:
+    struct NODE
+    {
+        int i;          // index of the vertex
+        double x;
+        double y;
+        int prev;
+        int next;
+        int z;          // z-order curve value
+        int prevZ;      // previous and next nodes in z-order
+        int nextZ;
+        bool steiner;
+    };
+
+    vector<NODE> nodes;
+    vector<int>* tris;
+    double minX;        // offset and scale of the z-order coordinates
+    double minY;
+    double invSize;
+
+    int insertNode( int aIndex, double aX, double aY, int aLast );
+    void removeNode( int p );
+    int linkedList( const vector<MCAD_POINT>& aPoints, size_t aFirst, size_t aLast, bool aCCW );
+    int filterPoints( int aStart, int aEnd );
+    void earcutLinked( int aEar, int aPass );
+    bool isEar( int aEar );
+    bool isEarHashed( int aEar );
+    bool isEarBlocked( int p, int aEar, double ax, double ay, double bx, double by,
+        double cx, double cy, double x0, double y0, double x1, double y1 );
+    int zOrder( double aX, double aY ) const;
+    void indexCurve( int aStart );
+    void sortLinked( int aList );
+    int cureLocalIntersections( int aStart );
+    void splitEarcut( int aStart );
+    int eliminateHole( int aHole, int aOuter );
+    int findHoleBridge( int aHole, int aOuter );
+    bool sectorContainsSector( int m, int p );
+    int getLeftmost( int aStart );
+    bool isValidDiagonal( int a, int b );
+    bool intersectsPolygon( int a, int b );
+    bool locallyInside( int a, int b );
+    bool middleInside( int a, int b );
+    int splitPolygon( int a, int b );
+
+    double area( int p, int q, int r ) const
+    {
+        const NODE& np = nodes[p];
+        const NODE& nq = nodes[q];
+        const NODE& nr = nodes[r];
+        return ( nq.y - np.y ) * ( nr.x - nq.x ) - ( nq.x - np.x ) * ( nr.y - nq.y );
+    }
+
+    bool equals( int a, int b ) const
+    {
+        return nodes[a].x == nodes[b].x && nodes[a].y == nodes[b].y;
+    }
+
+    bool onSegment( int p, int q, int r ) const
+    {
+        const NODE& np = nodes[p];
+        const NODE& nq = nodes[q];
+        const NODE& nr = nodes[r];
+
+        return nq.x <= max( np.x, nr.x ) && nq.x >= min( np.x, nr.x )
+            && nq.y <= max( np.y, nr.y ) && nq.y >= min( np.y, nr.y );
+    }
+
+    static int sign( double v )
+    {
+        return v > 0.0 ? 1 : ( v < 0.0 ? -1 : 0 );
+    }
+
+    bool intersects( int p1, int q1, int p2, int q2 ) const;
+
+    static bool pointInTriangle( double ax, double ay, double bx, double by,
+        double cx, double cy, double px, double py )
+    {
+        return ( cx - px ) * ( ay - py ) >= ( ax - px ) * ( cy - py )
+            && ( ax - px ) * ( by - py ) >= ( bx - px ) * ( ay - py )
+            && ( bx - px ) * ( cy - py ) >= ( cx - px ) * ( by - py );
+    }
+
+    void addTriangle( int a, int b, int c )
+    {
+        tris->push_back( nodes[a].i );
+        tris->push_back( nodes[b].i );
+        tris->push_back( nodes[c].i );
+    }
+
+public:
+    /**
+     * Function Triangulate
+     * triangulates a polygon with holes; the triangles are counter-clockwise
+     * and their vertex indices refer to aPoints. Returns false if no
+     * triangles were created.
+     *
+     * @param aPoints = (x, y) coordinates of the vertices of all loops
+     * @param aLoops = index of the first vertex of each loop; the first loop
+     *        is the outer boundary and the remaining loops are holes
+     * @param aTris = list to hold 3 vertex indices per triangle
+     */
+    bool Triangulate( const vector<MCAD_POINT>& aPoints, const vector<size_t>& aLoops,
+        vector<int>& aTris );
+};
+
+
+int TESS_EARCUT::insertNode( int aIndex, double aX, double aY, int aLast )
+{
+    NODE n;
+    n.i = aIndex;
+    n.x = aX;
+    n.y = aY;
+    n.z = 0;
+    n.prevZ = -1;
+    n.nextZ = -1;
+    n.steiner = false;
+
+    int p = (int)nodes.size();
+
+    if( aLast < 0 )
+    {
+        n.prev = p;
+        n.next = p;
+        nodes.push_back( n );
+    }
+    else
+    {
+        n.next = nodes[aLast].next;
+        n.prev = aLast;
+        nodes.push_back( n );
+        nodes[nodes[aLast].next].prev = p;
+        nodes[aLast].next = p;
+    }
+
+    return p;
+}
+
+
+void TESS_EARCUT::removeNode( int p )
+{
+    nodes[nodes[p].next].prev = nodes[p].prev;
+    nodes[nodes[p].prev].next = nodes[p].next;
+
+    if( nodes[p].prevZ >= 0 )
+        nodes[nodes[p].prevZ].nextZ = nodes[p].nextZ;
+
+    if( nodes[p].nextZ >= 0 )
+        nodes[nodes[p].nextZ].prevZ = nodes[p].prevZ;
+
+    return;
+}
+
+
+int TESS_EARCUT::linkedList( const vector<MCAD_POINT>& aPoints, size_t aFirst,
+    size_t aLast, bool aCCW )
+{
+    double sum = 0.0;
+
+    for( size_t i = aFirst, j = aLast - 1; i < aLast; j = i++ )
+        sum += ( aPoints[j].x - aPoints[i].x ) * ( aPoints[i].y + aPoints[j].y );
+
+    int last = -1;
+
+    if( aCCW == ( sum > 0.0 ) )
+    {
+        for( size_t i = aFirst; i < aLast; ++i )
+            last = insertNode( (int)i, aPoints[i].x, aPoints[i].y, last );
+    }
+    else
+    {
+        for( size_t i = aLast; i > aFirst; --i )
+            last = insertNode( (int)i - 1, aPoints[i - 1].x, aPoints[i - 1].y, last );
+    }
+
+    if( last >= 0 && equals( last, nodes[last].next ) )
+    {
+        int nx = nodes[last].next;
+        removeNode( last );
+        last = nx;
+    }
+
+    return last;
+}
+
+
+int TESS_EARCUT::filterPoints( int aStart, int aEnd )
+{
+    if( aStart < 0 )
+        return aStart;
+
+    if( aEnd < 0 )
+        aEnd = aStart;
+
+    int p = aStart;
+    bool again;
+
+    do
+    {
+        again = false;
+
+        if( !nodes[p].steiner && ( equals( p, nodes[p].next )
+            || 0.0 == area( nodes[p].prev, p, nodes[p].next ) ) )
+        {
+            removeNode( p );
+            p = aEnd = nodes[p].prev;
+
+            if( p == nodes[p].next )
+                break;
+
+            again = true;
+        }
+        else
+        {
+            p = nodes[p].next;
+        }
+    } while( again || p != aEnd );
+
+    return aEnd;
+}
+
+
+void TESS_EARCUT::earcutLinked( int aEar, int aPass )
+{
+    if( aEar < 0 )
+        return;
+
+    if( 0 == aPass && invSize > 0.0 )
+        indexCurve( aEar );
+
+    int ear = aEar;
+    int stop = ear;
+
+    while( nodes[ear].prev != nodes[ear].next )
+    {
+        int prev = nodes[ear].prev;
+        int next = nodes[ear].next;
+
+        if( invSize > 0.0 ? isEarHashed( ear ) : isEar( ear ) )
+        {
+            addTriangle( prev, ear, next );
+            removeNode( ear );
+            ear = nodes[next].next;
+            stop = ear;
+            continue;
+        }
+
+        ear = next;
+
+        if( ear == stop )
+        {
+            if( 0 == aPass )
+            {
+                earcutLinked( filterPoints( ear, -1 ), 1 );
+            }
+            else if( 1 == aPass )
+            {
+                ear = cureLocalIntersections( filterPoints( ear, -1 ) );
+                earcutLinked( ear, 2 );
+            }
+            else if( 2 == aPass )
+            {
+                splitEarcut( ear );
+            }
+
+            break;
+        }
+    }
+
+    return;
+}
+
+
+bool TESS_EARCUT::isEar( int aEar )
+{
+    int a = nodes[aEar].prev;
+    int b = aEar;
+    int c = nodes[aEar].next;
+
+    // reflex vertices cannot be ears
+    if( area( a, b, c ) >= 0.0 )
+        return false;
+
+    double ax = nodes[a].x;
+    double ay = nodes[a].y;
+    double bx = nodes[b].x;
+    double by = nodes[b].y;
+    double cx = nodes[c].x;
+    double cy = nodes[c].y;
+    double x0 = min( ax, min( bx, cx ) );
+    double y0 = min( ay, min( by, cy ) );
+    double x1 = max( ax, max( bx, cx ) );
+    double y1 = max( ay, max( by, cy ) );
+
+    int p = nodes[c].next;
+
+    while( p != a )
+    {
+        const NODE& np = nodes[p];
+
+        if( np.x >= x0 && np.x <= x1 && np.y >= y0 && np.y <= y1
+            && pointInTriangle( ax, ay, bx, by, cx, cy, np.x, np.y )
+            && area( np.prev, p, np.next ) >= 0.0 )
+            return false;
+
+        p = np.next;
+    }
+
+    return true;
+}
+
+
+// true if node p lies within the ear (a, b, c) and is not a reflex
+// vertex, in which case the ear cannot be clipped
+bool TESS_EARCUT::isEarBlocked( int p, int aEar, double ax, double ay, double bx, double by,
+    double cx, double cy, double x0, double y0, double x1, double y1 )
+{
+    const NODE& np = nodes[p];
+
+    return p != nodes[aEar].prev && p != nodes[aEar].next
+        && np.x >= x0 && np.x <= x1 && np.y >= y0 && np.y <= y1
+        && pointInTriangle( ax, ay, bx, by, cx, cy, np.x, np.y )
+        && area( np.prev, p, np.next ) >= 0.0;
+}
+
+
+bool TESS_EARCUT::isEarHashed( int aEar )
+{
+    int a = nodes[aEar].prev;
+    int b = aEar;
+    int c = nodes[aEar].next;
+
+    if( area( a, b, c ) >= 0.0 )
+        return false;
+
+    double ax = nodes[a].x;
+    double ay = nodes[a].y;
+    double bx = nodes[b].x;
+    double by = nodes[b].y;
+    double cx = nodes[c].x;
+    double cy = nodes[c].y;
+    double x0 = min( ax, min( bx, cx ) );
+    double y0 = min( ay, min( by, cy ) );
+    double x1 = max( ax, max( bx, cx ) );
+    double y1 = max( ay, max( by, cy ) );
+
+    // only the nodes whose z-order values lie within the range of
+    // the ear's bounding box need to be tested
+    int minZ = zOrder( x0, y0 );
+    int maxZ = zOrder( x1, y1 );
+    int p = nodes[aEar].prevZ;
+    int n = nodes[aEar].nextZ;
+
+    while( p >= 0 && nodes[p].z >= minZ && n >= 0 && nodes[n].z <= maxZ )
+    {
+        if( isEarBlocked( p, aEar, ax, ay, bx, by, cx, cy, x0, y0, x1, y1 ) )
+            return false;
+
+        p = nodes[p].prevZ;
+
+        if( isEarBlocked( n, aEar, ax, ay, bx, by, cx, cy, x0, y0, x1, y1 ) )
+            return false;
+
+        n = nodes[n].nextZ;
+    }
+
+    while( p >= 0 && nodes[p].z >= minZ )
+    {
+        if( isEarBlocked( p, aEar, ax, ay, bx, by, cx, cy, x0, y0, x1, y1 ) )
+            return false;
+
+        p = nodes[p].prevZ;
+    }
+
+    while( n >= 0 && nodes[n].z <= maxZ )
+    {
+        if( isEarBlocked( n, aEar, ax, ay, bx, by, cx, cy, x0, y0, x1, y1 ) )
+            return false;
+
+        n = nodes[n].nextZ;
+    }
+
+    return true;
+}
+
+
+int TESS_EARCUT::zOrder( double aX, double aY ) const
+{
+    // interleave the bits of the 15-bit scaled coordinates
+    unsigned int x = (unsigned int)( ( aX - minX ) * invSize );
+    unsigned int y = (unsigned int)( ( aY - minY ) * invSize );
+
+    x = ( x | ( x << 8 ) ) & 0x00FF00FF;
+    x = ( x | ( x << 4 ) ) & 0x0F0F0F0F;
+    x = ( x | ( x << 2 ) ) & 0x33333333;
+    x = ( x | ( x << 1 ) ) & 0x55555555;
+
+    y = ( y | ( y << 8 ) ) & 0x00FF00FF;
+    y = ( y | ( y << 4 ) ) & 0x0F0F0F0F;
+    y = ( y | ( y << 2 ) ) & 0x33333333;
+    y = ( y | ( y << 1 ) ) & 0x55555555;
+
+    return (int)( x | ( y << 1 ) );
+}
+
+
+void TESS_EARCUT::indexCurve( int aStart )
+{
+    int p = aStart;
+
+    do
+    {
+        if( 0 == nodes[p].z )
+            nodes[p].z = zOrder( nodes[p].x, nodes[p].y );
+
+        nodes[p].prevZ = nodes[p].prev;
+        nodes[p].nextZ = nodes[p].next;
+        p = nodes[p].next;
+    } while( p != aStart );
+
+    nodes[nodes[p].prevZ].nextZ = -1;
+    nodes[p].prevZ = -1;
+
+    sortLinked( p );
+    return;
+}
+
+
+// merge sort of the z-order list (S. Tatham)
+void TESS_EARCUT::sortLinked( int aList )
+{
+    int inSize = 1;
+    int nMerges;
+
+    do
+    {
+        int p = aList;
+        int tail = -1;
+
+        aList = -1;
+        nMerges = 0;
+
+        while( p >= 0 )
+        {
+            ++nMerges;
+
+            int q = p;
+            int pSize = 0;
+
+            for( int i = 0; i < inSize; ++i )
+            {
+                ++pSize;
+                q = nodes[q].nextZ;
+
+                if( q < 0 )
+                    break;
+            }
+
+            int qSize = inSize;
+
+            while( pSize > 0 || ( qSize > 0 && q >= 0 ) )
+            {
+                int e;
+
+                if( 0 != pSize && ( 0 == qSize || q < 0 || nodes[p].z <= nodes[q].z ) )
+                {
+                    e = p;
+                    p = nodes[p].nextZ;
+                    --pSize;
+                }
+                else
+                {
+                    e = q;
+                    q = nodes[q].nextZ;
+                    --qSize;
+                }
+
+                if( tail >= 0 )
+                    nodes[tail].nextZ = e;
+                else
+                    aList = e;
+
+                nodes[e].prevZ = tail;
+                tail = e;
+            }
+
+            p = q;
+        }
+
+        nodes[tail].nextZ = -1;
+        inSize *= 2;
+    } while( nMerges > 1 );
+
+    return;
+}
+
+
+int TESS_EARCUT::cureLocalIntersections( int aStart )
+{
+    int p = aStart;
+
+    do
+    {
+        int a = nodes[p].prev;
+        int b = nodes[nodes[p].next].next;
+
+        if( !equals( a, b ) && intersects( a, p, nodes[p].next, b )
+            && locallyInside( a, b ) && locallyInside( b, a ) )
+        {
+            addTriangle( a, p, b );
+            removeNode( nodes[p].next );
+            removeNode( p );
+            p = aStart = b;
+        }
+
+        p = nodes[p].next;
+    } while( p != aStart );
+
+    return filterPoints( p, -1 );
+}
+
+
+void TESS_EARCUT::splitEarcut( int aStart )
+{
+    int a = aStart;
+
+    do
+    {
+        int b = nodes[nodes[a].next].next;
+
+        while( b != nodes[a].prev )
+        {
+            if( nodes[a].i != nodes[b].i && isValidDiagonal( a, b ) )
+            {
+                int c = splitPolygon( a, b );
+
+                a = filterPoints( a, nodes[a].next );
+                c = filterPoints( c, nodes[c].next );
+
+                earcutLinked( a, 0 );
+                earcutLinked( c, 0 );
+                return;
+            }
+
+            b = nodes[b].next;
+        }
+
+        a = nodes[a].next;
+    } while( a != aStart );
+
+    return;
+}
+
+
+int TESS_EARCUT::eliminateHole( int aHole, int aOuter )
+{
+    int bridge = findHoleBridge( aHole, aOuter );
+
+    if( bridge < 0 )
+        return aOuter;
+
+    int bridgeReverse = splitPolygon( bridge, aHole );
+
+    filterPoints( bridgeReverse, nodes[bridgeReverse].next );
+    return filterPoints( bridge, nodes[bridge].next );
+}
+
+
+int TESS_EARCUT::findHoleBridge( int aHole, int aOuter )
+{
+    int p = aOuter;
+    double hx = nodes[aHole].x;
+    double hy = nodes[aHole].y;
+    double qx = -HUGE_VAL;
+    int m = -1;
+
+    // find a segment intersected by a ray from the hole's leftmost
+    // point to the left; the segment's endpoint with the lesser x
+    // is a potential connection point
+    do
+    {
+        int nx = nodes[p].next;
+
+        if( hy <= nodes[p].y && hy >= nodes[nx].y && nodes[nx].y != nodes[p].y )
+        {
+            double x = nodes[p].x + ( hy - nodes[p].y ) * ( nodes[nx].x - nodes[p].x )
+                / ( nodes[nx].y - nodes[p].y );
+
+            if( x <= hx && x > qx )
+            {
+                qx = x;
+                m = nodes[p].x < nodes[nx].x ? p : nx;
+
+                if( x == hx )
+                    return m;
+            }
+        }
+
+        p = nx;
+    } while( p != aOuter );
+
+    if( m < 0 )
+        return -1;
+
+    // look for points inside the triangle of the hole point, the segment
+    // intersection and the endpoint; if there are none the endpoint is
+    // the connection point, otherwise the point of minimum angle with
+    // the ray is used
+    int stop = m;
+    double mx = nodes[m].x;
+    double my = nodes[m].y;
+    double tanMin = HUGE_VAL;
+
+    p = m;
+
+    do
+    {
+        double px = nodes[p].x;
+        double py = nodes[p].y;
+
+        if( hx >= px && px >= mx && hx != px
+            && pointInTriangle( hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, px, py ) )
+        {
+            double tn = fabs( hy - py ) / ( hx - px );
+
+            if( locallyInside( p, aHole ) && ( tn < tanMin || ( tn == tanMin
+                && ( px > nodes[m].x || ( px == nodes[m].x && sectorContainsSector( m, p ) ) ) ) ) )
+            {
+                m = p;
+                tanMin = tn;
+            }
+        }
+
+        p = nodes[p].next;
+    } while( p != stop );
+
+    return m;
+}
+
+
+bool TESS_EARCUT::sectorContainsSector( int m, int p )
+{
+    return area( nodes[m].prev, m, nodes[p].prev ) < 0.0
+        && area( nodes[p].next, m, nodes[m].next ) < 0.0;
+}
+
+
+int TESS_EARCUT::getLeftmost( int aStart )
+{
+    int p = aStart;
+    int leftmost = aStart;
+
+    do
+    {
+        if( nodes[p].x < nodes[leftmost].x
+            || ( nodes[p].x == nodes[leftmost].x && nodes[p].y < nodes[leftmost].y ) )
+            leftmost = p;
+
+        p = nodes[p].next;
+    } while( p != aStart );
+
+    return leftmost;
+}
+
+
+bool TESS_EARCUT::isValidDiagonal( int a, int b )
+{
+    const NODE& na = nodes[a];
+    const NODE& nb = nodes[b];
+
+    if( nodes[na.next].i == nb.i || nodes[na.prev].i == nb.i || intersectsPolygon( a, b ) )
+        return false;
+
+    if( locallyInside( a, b ) && locallyInside( b, a ) && middleInside( a, b )
+        && ( 0.0 != area( na.prev, a, nb.prev ) || 0.0 != area( a, nb.prev, b ) ) )
+        return true;
+
+    return equals( a, b ) && area( na.prev, a, na.next ) > 0.0
+        && area( nb.prev, b, nb.next ) > 0.0;
+}
+
+
+bool TESS_EARCUT::intersects( int p1, int q1, int p2, int q2 ) const
+{
+    int o1 = sign( area( p1, q1, p2 ) );
+    int o2 = sign( area( p1, q1, q2 ) );
+    int o3 = sign( area( p2, q2, p1 ) );
+    int o4 = sign( area( p2, q2, q1 ) );
+
+    if( o1 != o2 && o3 != o4 )
+        return true;
+
+    if( 0 == o1 && onSegment( p1, p2, q1 ) )
+        return true;
+
+    if( 0 == o2 && onSegment( p1, q2, q1 ) )
+        return true;
+
+    if( 0 == o3 && onSegment( p2, p1, q2 ) )
+        return true;
+
+    if( 0 == o4 && onSegment( p2, q1, q2 ) )
+        return true;
+
+    return false;
+}
+
+
+bool TESS_EARCUT::intersectsPolygon( int a, int b )
+{
+    int p = a;
+    int ia = nodes[a].i;
+    int ib = nodes[b].i;
+
+    do
+    {
+        int nx = nodes[p].next;
+
+        if( nodes[p].i != ia && nodes[nx].i != ia && nodes[p].i != ib && nodes[nx].i != ib
+            && intersects( p, nx, a, b ) )
+            return true;
+
+        p = nx;
+    } while( p != a );
+
+    return false;
+}
+
+
+bool TESS_EARCUT::locallyInside( int a, int b )
+{
+    int pv = nodes[a].prev;
+    int nx = nodes[a].next;
+
+    if( area( pv, a, nx ) < 0.0 )
+        return area( a, b, nx ) >= 0.0 && area( a, pv, b ) >= 0.0;
+
+    return area( a, b, pv ) < 0.0 || area( a, nx, b ) < 0.0;
+}
+
+
+bool TESS_EARCUT::middleInside( int a, int b )
+{
+    int p = a;
+    bool inside = false;
+    double px = ( nodes[a].x + nodes[b].x ) * 0.5;
+    double py = ( nodes[a].y + nodes[b].y ) * 0.5;
+
+    do
+    {
+        const NODE& n0 = nodes[p];
+        const NODE& n1 = nodes[n0.next];
+
+        if( ( ( n0.y > py ) != ( n1.y > py ) ) && n1.y != n0.y
+            && ( px < ( n1.x - n0.x ) * ( py - n0.y ) / ( n1.y - n0.y ) + n0.x ) )
+            inside = !inside;
+
+        p = n0.next;
+    } while( p != a );
+
+    return inside;
+}
+
+
+// link a to b with a bridge; if the vertices belong to the same loop the
+// loop is split in two, otherwise the loops are merged; returns the copy
+// of b which begins the second loop
+int TESS_EARCUT::splitPolygon( int a, int b )
+{
+    int a2 = insertNode( nodes[a].i, nodes[a].x, nodes[a].y, -1 );
+    int b2 = insertNode( nodes[b].i, nodes[b].x, nodes[b].y, -1 );
+    int an = nodes[a].next;
+    int bp = nodes[b].prev;
+
+    nodes[a].next = b;
+    nodes[b].prev = a;
+
+    nodes[a2].next = an;
+    nodes[an].prev = a2;
+
+    nodes[b2].next = a2;
+    nodes[a2].prev = b2;
+
+    nodes[bp].next = b2;
+    nodes[b2].prev = bp;
+
+    return b2;
+}
+
+
+bool TESS_EARCUT::Triangulate( const vector<MCAD_POINT>& aPoints,
+    const vector<size_t>& aLoops, vector<int>& aTris )
+{
+    aTris.clear();
+    nodes.clear();
+    tris = &aTris;
+
+    if( aLoops.empty() || aPoints.size() < 3 )
+        return false;
+
+    nodes.reserve( aPoints.size() * 3 / 2 + 4 * aLoops.size() );
+
+    size_t outerEnd = aLoops.size() > 1 ? aLoops[1] : aPoints.size();
+    int outer = linkedList( aPoints, aLoops[0], outerEnd, true );
+
+    if( outer < 0 || nodes[outer].next == nodes[outer].prev )
+        return false;
+
+    // large polygons are indexed along a z-order curve so that the test
+    // of an ear only considers the nodes near the ear
+    invSize = 0.0;
+
+    if( aPoints.size() > TESS_EARCUT_HASH )
+    {
+        double maxX = aPoints[0].x;
+        double maxY = aPoints[0].y;
+
+        minX = maxX;
+        minY = maxY;
+
+        for( size_t i = 1; i < aPoints.size(); ++i )
+        {
+            minX = min( minX, aPoints[i].x );
+            minY = min( minY, aPoints[i].y );
+            maxX = max( maxX, aPoints[i].x );
+            maxY = max( maxY, aPoints[i].y );
+        }
+
+        invSize = max( maxX - minX, maxY - minY );
+        invSize = invSize > 0.0 ? 32767.0 / invSize : 0.0;
+    }
+
+    if( aLoops.size() > 1 )
+    {
+        // join the holes to the outer boundary from left to right
+        vector< pair<double, int> > queue;
+
+        for( size_t i = 1; i < aLoops.size(); ++i )
+        {
+            size_t last = ( i + 1 < aLoops.size() ) ? aLoops[i + 1] : aPoints.size();
+
+            if( last - aLoops[i] < 3 )
+                continue;
+
+            int list = linkedList( aPoints, aLoops[i], last, false );
+
+            if( list < 0 )
+                continue;
+
+            if( list == nodes[list].next )
+                nodes[list].steiner = true;
+
+            int lm = getLeftmost( list );
+            queue.push_back( pair<double, int>( nodes[lm].x, lm ) );
+        }
+
+        sort( queue.begin(), queue.end() );
+
+        for( size_t i = 0; i < queue.size(); ++i )
+            outer = eliminateHole( queue[i].second, outer );
+    }
+
+    earcutLinked( outer, 0 );
+    tris = NULL;
+
+    return !aTris.empty();
+}
+
+
+// state of the mesh of a single surface during refinement
+class TESS_MESHER
+{
+private:
+    struct TRI
+    {
+        int v[3];   // vertices, counter-clockwise in parameter space
+        int nb[3];  // neighbor across edge (v[k], v[k+1]) or -1
+    };
+
+    const TESS_SURF* surf;
+    double chordTol;
+    double cosAngle;
+    double minUV;
+    double scaleU;      // scale factors of the parameters; edge lengths are
+    double scaleV;      // compared in the scaled parameter space
+
+    vector<MCAD_POINT> uv;
+    vector<MCAD_POINT> pos;
+    vector<MCAD_POINT> nrm;
+    vector<TRI> tris;
+    vector<int> pending;
+    vector<char> queued;
+    vector<char> fixed; // boundary vertices whose edges may not be split
+    bool evalOK;
+
+    int addVertex( double aU, double aV );
+    void queue( int aTri );
+    void setNeighbor( int aTri, int aOld, int aNew );
+    bool isFixed( int aTri, int aEdge ) const;
+    int longestEdge( int aTri ) const;
+    bool needsSplit( int aTri );
+    int splitEdge( int aTri, int aEdge, int aVertex = -1 );
+    bool bisect( int aTri );
+    void buildAdjacency( void );
+    void restoreBoundary( const vector<size_t>& aLoops, size_t aNPoints );
+    bool flipEdge( int aTri, int aEdge );
+    void makeDelaunay( void );
+
+public:
+    TESS_MESHER( const TESS_SURF* aSurf, double aChordTol, double aAngleTol,
+        double aScaleU, double aScaleV );
+
+    // mesh the region bounded by the given parameter space loops; if aFixed
+    // is given the boundary segments between vertices flagged as fixed are
+    // never split and the model space positions of those vertices are
+    // taken from aPos rather than from the surface
+    bool Mesh( const vector<MCAD_POINT>& aUV, const vector<size_t>& aLoops, IGES_MESH& aMesh,
+        const vector<MCAD_POINT>* aPos = NULL, const vector<char>* aFixed = NULL );
+};
+
+
+TESS_MESHER::TESS_MESHER( const TESS_SURF* aSurf, double aChordTol, double aAngleTol,
+    double aScaleU, double aScaleV )
+{
+    surf = aSurf;
+    chordTol = aChordTol;
+    cosAngle = cos( aAngleTol );
+    minUV = 1e-9 * max( aSurf->u1 - aSurf->u0, aSurf->v1 - aSurf->v0 );
+    scaleU = aScaleU;
+    scaleV = aScaleV;
+    evalOK = true;
+    return;
+}
+
+
+int TESS_MESHER::addVertex( double aU, double aV )
+{
+    MCAD_POINT p;
+    MCAD_POINT n;
+
+    if( !surf->eval( aU, aV, p, n ) )
+        evalOK = false;
+
+    uv.push_back( MCAD_POINT( aU, aV, 0.0 ) );
+    pos.push_back( p );
+    nrm.push_back( n );
+
+    return (int)uv.size() - 1;
+}
+
+
+void TESS_MESHER::queue( int aTri )
+{
+    if( (size_t)aTri >= queued.size() )
+        queued.resize( tris.size(), 0 );
+
+    if( !queued[aTri] )
+    {
+        queued[aTri] = 1;
+        pending.push_back( aTri );
+    }
+
+    return;
+}
+
+
+void TESS_MESHER::setNeighbor( int aTri, int aOld, int aNew )
+{
+    if( aTri < 0 )
+        return;
+
+    for( int k = 0; k < 3; ++k )
+    {
+        if( tris[aTri].nb[k] == aOld )
+        {
+            tris[aTri].nb[k] = aNew;
+            return;
+        }
+    }
+
+    return;
+}
+
+
+bool TESS_MESHER::isFixed( int aTri, int aEdge ) const
+{
+    const TRI& t = tris[aTri];
+
+    if( t.nb[aEdge] >= 0 )
+        return false;
+
+    size_t a = (size_t)t.v[aEdge];
+    size_t b = (size_t)t.v[( aEdge + 1 ) % 3];
+
+    return a < fixed.size() && b < fixed.size() && fixed[a] && fixed[b];
+}
+
+
+int TESS_MESHER::longestEdge( int aTri ) const
+{
+    // edges are ordered by length and then by their vertex indices so
+    // that adjacent triangles agree on the order of a shared edge;
+    // fixed edges are never chosen and -1 is returned if all are fixed
+    const TRI& t = tris[aTri];
+    int best = -1;
+    double bl = -1.0;
+    int blo = 0;
+    int bhi = 0;
+
+    for( int k = 0; k < 3; ++k )
+    {
+        if( isFixed( aTri, k ) )
+            continue;
+
+        int a = t.v[k];
+        int b = t.v[( k + 1 ) % 3];
+        int lo = min( a, b );
+        int hi = max( a, b );
+        double du = ( uv[hi].x - uv[lo].x ) * scaleU;
+        double dv = ( uv[hi].y - uv[lo].y ) * scaleV;
+        double l = du * du + dv * dv;
+
+        if( l > bl || ( l == bl && ( lo > blo || ( lo == blo && hi > bhi ) ) ) )
+        {
+            best = k;
+            bl = l;
+            blo = lo;
+            bhi = hi;
+        }
+    }
+
+    return best;
+}
+
+
+bool TESS_MESHER::needsSplit( int aTri )
+{
+    const TRI& t = tris[aTri];
+    int va = t.v[0];
+    int vb = t.v[1];
+    int vc = t.v[2];
+    double maxUV = 0.0;
+
+    for( int k = 0; k < 3; ++k )
+    {
+        MCAD_POINT d = uv[t.v[( k + 1 ) % 3]] - uv[t.v[k]];
+        maxUV = max( maxUV, fabs( d.x ) + fabs( d.y ) );
+    }
+
+    if( maxUV < minUV )
+        return false;
+
+    MCAD_POINT p;
+    MCAD_POINT n;
+    bool hasFixed = false;
+
+    for( int k = 0; k < 3; ++k )
+    {
+        int a = t.v[k];
+        int b = t.v[( k + 1 ) % 3];
+
+        // a fixed edge already meets the tolerances of the boundary
+        if( isFixed( aTri, k ) )
+        {
+            hasFixed = true;
+            continue;
+        }
+
+        if( tessDot( nrm[a], nrm[b] ) < cosAngle
+            && 0.0 != tessDot( nrm[a], nrm[a] ) && 0.0 != tessDot( nrm[b], nrm[b] ) )
+            return true;
+
+        if( !surf->eval( 0.5 * ( uv[a].x + uv[b].x ), 0.5 * ( uv[a].y + uv[b].y ), p, n ) )
+        {
+            evalOK = false;
+            return false;
+        }
+
+        if( tessLineDist( p, pos[a], pos[b] ) > chordTol )
+            return true;
+    }
+
+    // the centroid of a triangle on a fixed edge is not tested since the
+    // deviation of the boundary from the surface cannot be reduced
+    if( hasFixed )
+        return false;
+
+    if( !surf->eval( ( uv[va].x + uv[vb].x + uv[vc].x ) / 3.0,
+        ( uv[va].y + uv[vb].y + uv[vc].y ) / 3.0, p, n ) )
+    {
+        evalOK = false;
+        return false;
+    }
+
+    return tessPlaneDist( p, pos[va], pos[vb], pos[vc] ) > chordTol;
+}
+
+
+// split an edge at its midpoint or at the given vertex; returns the
+// index of the new triangle which holds the second half of the edge
+int TESS_MESHER::splitEdge( int aTri, int aEdge, int aVertex )
+{
+    TRI t = tris[aTri];
+    int a = t.v[aEdge];
+    int b = t.v[( aEdge + 1 ) % 3];
+    int c = t.v[( aEdge + 2 ) % 3];
+    int nBC = t.nb[( aEdge + 1 ) % 3];
+    int nCA = t.nb[( aEdge + 2 ) % 3];
+    int n = t.nb[aEdge];
+
+    int m = aVertex;
+
+    if( m < 0 )
+        m = addVertex( 0.5 * ( uv[a].x + uv[b].x ), 0.5 * ( uv[a].y + uv[b].y ) );
+
+    int t2 = (int)tris.size();
+
+    TRI r0 = { { a, m, c }, { -1, t2, nCA } };
+    TRI r1 = { { m, b, c }, { -1, nBC, aTri } };
+
+    tris[aTri] = r0;
+    tris.push_back( r1 );
+    setNeighbor( nBC, aTri, t2 );
+
+    if( n >= 0 )
+    {
+        TRI s = tris[n];
+        int en = 0;
+
+        while( en < 3 && !( s.v[en] == b && s.v[( en + 1 ) % 3] == a ) )
+            ++en;
+
+        int d = s.v[( en + 2 ) % 3];
+        int nAD = s.nb[( en + 1 ) % 3];
+        int nDB = s.nb[( en + 2 ) % 3];
+        int n2 = (int)tris.size();
+
+        TRI s0 = { { b, m, d }, { t2, n2, nDB } };
+        TRI s1 = { { m, a, d }, { aTri, nAD, n } };
+
+        tris[n] = s0;
+        tris.push_back( s1 );
+        setNeighbor( nAD, n, n2 );
+
+        tris[aTri].nb[0] = n2;
+        tris[t2].nb[0] = n;
+
+        queue( n );
+        queue( n2 );
+    }
+
+    queue( aTri );
+    queue( t2 );
+    return t2;
+}
+
+
+bool TESS_MESHER::bisect( int aTri )
+{
+    // Rivara's longest edge propagation path: a triangle is bisected
+    // together with the neighbor sharing its longest edge once that edge
+    // is also the longest edge of the neighbor
+    vector<int> path;
+    path.push_back( aTri );
+
+    while( !path.empty() )
+    {
+        if( path.size() > TESS_MAX_LEPP )
+            return false;
+
+        int c = path.back();
+        int e = longestEdge( c );
+
+        if( e < 0 )
+            return false;
+
+        int n = tris[c].nb[e];
+        int en = n < 0 ? -1 : longestEdge( n );
+
+        if( n < 0 || ( en >= 0 && tris[n].nb[en] == c ) )
+        {
+            splitEdge( c, e );
+            path.pop_back();
+        }
+        else
+        {
+            path.push_back( n );
+        }
+    }
+
+    return true;
+}
+
+
+void TESS_MESHER::buildAdjacency( void )
+{
+    map< pair<int, int>, int > edges;
+
+    for( size_t i = 0; i < tris.size(); ++i )
+    {
+        for( int k = 0; k < 3; ++k )
+        {
+            tris[i].nb[k] = -1;
+            edges.insert( pair< pair<int, int>, int >(
+                pair<int, int>( tris[i].v[k], tris[i].v[( k + 1 ) % 3] ), (int)i ) );
+        }
+    }
+
+    for( size_t i = 0; i < tris.size(); ++i )
+    {
+        for( int k = 0; k < 3; ++k )
+        {
+            map< pair<int, int>, int >::iterator it =
+                edges.find( pair<int, int>( tris[i].v[( k + 1 ) % 3], tris[i].v[k] ) );
+
+            if( it != edges.end() )
+                tris[i].nb[k] = it->second;
+        }
+    }
+
+    return;
+}
+
+
+// The triangulation removes collinear and repeated boundary points; the
+// fixed boundary vertices which were removed are inserted again into the
+// boundary edges which span them so that the boundary of the mesh
+// matches the boundary which was given.
+void TESS_MESHER::restoreBoundary( const vector<size_t>& aLoops, size_t aNPoints )
+{
+    vector<char> used( aNPoints, 0 );
+
+    for( size_t i = 0; i < tris.size(); ++i )
+    {
+        for( int k = 0; k < 3; ++k )
+        {
+            if( (size_t)tris[i].v[k] < aNPoints )
+                used[tris[i].v[k]] = 1;
+        }
+    }
+
+    // boundary edges and the triangle and edge index which hold them
+    map< pair<int, int>, pair<int, int> > bnd;
+
+    for( size_t i = 0; i < tris.size(); ++i )
+    {
+        for( int k = 0; k < 3; ++k )
+        {
+            if( tris[i].nb[k] < 0 )
+                bnd[pair<int, int>( tris[i].v[k], tris[i].v[( k + 1 ) % 3] )] =
+                    pair<int, int>( (int)i, k );
+        }
+    }
+
+    for( size_t l = 0; l < aLoops.size(); ++l )
+    {
+        int first = (int)aLoops[l];
+        int np = (int)( ( l + 1 < aLoops.size() ? aLoops[l + 1] : aNPoints ) - aLoops[l] );
+        int start = -1;
+
+        for( int j = 0; j < np && start < 0; ++j )
+        {
+            if( used[first + j] )
+                start = j;
+        }
+
+        if( start < 0 )
+            continue;
+
+        vector<int> run;
+        int a = first + start;
+
+        for( int j = 1; j <= np; ++j )
+        {
+            int b = first + ( start + j ) % np;
+
+            if( !used[b] )
+            {
+                if( (size_t)b < fixed.size() && fixed[b] )
+                    run.push_back( b );
+
+                continue;
+            }
+
+            if( !run.empty() )
+            {
+                // the edge may run in either direction since the
+                // triangulation orients the loops
+                map< pair<int, int>, pair<int, int> >::iterator it =
+                    bnd.find( pair<int, int>( a, b ) );
+
+                if( it == bnd.end() )
+                {
+                    it = bnd.find( pair<int, int>( b, a ) );
+                    reverse( run.begin(), run.end() );
+                }
+
+                if( it != bnd.end() )
+                {
+                    int tri = it->second.first;
+                    int edge = it->second.second;
+
+                    bnd.erase( it );
+
+                    for( size_t r = 0; r < run.size(); ++r )
+                    {
+                        int t2 = splitEdge( tri, edge, run[r] );
+                        used[run[r]] = 1;
+
+                        // the triangles are (a, m, c) and (m, b, c); the edges
+                        // (c, a) and (b, c) have moved and may be boundary edges
+                        bnd[pair<int, int>( tris[tri].v[0], tris[tri].v[1] )] =
+                            pair<int, int>( tri, 0 );
+
+                        if( tris[tri].nb[2] < 0 )
+                            bnd[pair<int, int>( tris[tri].v[2], tris[tri].v[0] )] =
+                                pair<int, int>( tri, 2 );
+
+                        if( tris[t2].nb[1] < 0 )
+                            bnd[pair<int, int>( tris[t2].v[1], tris[t2].v[2] )] =
+                                pair<int, int>( t2, 1 );
+
+                        tri = t2;
+                        edge = 0;
+                    }
+
+                    bnd[pair<int, int>( tris[tri].v[0], tris[tri].v[1] )] =
+                        pair<int, int>( tri, 0 );
+                }
+
+                run.clear();
+            }
+
+            a = b;
+        }
+    }
+
+    return;
+}
+
+
+// replace the edge (a, b) shared by triangles (a, b, c) and (b, a, d) with
+// the edge (c, d) if (c, d) lies within the quadrilateral and d lies within
+// the circumcircle of (a, b, c) in the scaled parameter space; returns true
+// if the edge was flipped
+bool TESS_MESHER::flipEdge( int aTri, int aEdge )
+{
+    int n = tris[aTri].nb[aEdge];
+
+    if( n < 0 )
+        return false;
+
+    TRI t = tris[aTri];
+    TRI s = tris[n];
+    int a = t.v[aEdge];
+    int b = t.v[( aEdge + 1 ) % 3];
+    int c = t.v[( aEdge + 2 ) % 3];
+    int en = 0;
+
+    while( en < 3 && !( s.v[en] == b && s.v[( en + 1 ) % 3] == a ) )
+        ++en;
+
+    if( en > 2 )
+        return false;
+
+    int d = s.v[( en + 2 ) % 3];
+
+    double ax = uv[a].x * scaleU;
+    double ay = uv[a].y * scaleV;
+    double bx = uv[b].x * scaleU;
+    double by = uv[b].y * scaleV;
+    double cx = uv[c].x * scaleU;
+    double cy = uv[c].y * scaleV;
+    double dx = uv[d].x * scaleU;
+    double dy = uv[d].y * scaleV;
+
+    // the new triangles (c, a, d) and (d, b, c) must be counter-clockwise
+    double s0 = ( ax - cx ) * ( dy - cy ) - ( ay - cy ) * ( dx - cx );
+    double s1 = ( bx - dx ) * ( cy - dy ) - ( by - dy ) * ( cx - dx );
+
+    if( s0 <= 0.0 || s1 <= 0.0 )
+        return false;
+
+    double adx = ax - dx;
+    double ady = ay - dy;
+    double bdx = bx - dx;
+    double bdy = by - dy;
+    double cdx = cx - dx;
+    double cdy = cy - dy;
+    double ad = adx * adx + ady * ady;
+    double bd = bdx * bdx + bdy * bdy;
+    double cd = cdx * cdx + cdy * cdy;
+    double det = adx * ( bdy * cd - bd * cdy ) - ady * ( bdx * cd - bd * cdx )
+        + ad * ( bdx * cdy - bdy * cdx );
+
+    // a small threshold prevents cycling among cocircular points
+    if( det <= 1e-12 * ( ad + bd + cd ) * ( ad + bd + cd ) )
+        return false;
+
+    int nBC = t.nb[( aEdge + 1 ) % 3];
+    int nCA = t.nb[( aEdge + 2 ) % 3];
+    int nAD = s.nb[( en + 1 ) % 3];
+    int nDB = s.nb[( en + 2 ) % 3];
+
+    TRI r0 = { { c, a, d }, { nCA, nAD, n } };
+    TRI r1 = { { d, b, c }, { nDB, nBC, aTri } };
+
+    tris[aTri] = r0;
+    tris[n] = r1;
+    setNeighbor( nAD, n, aTri );
+    setNeighbor( nBC, aTri, n );
+
+    return true;
+}
+
+
+void TESS_MESHER::makeDelaunay( void )
+{
+    // Lawson's algorithm: edges are flipped until all triangles satisfy
+    // the Delaunay criterion; boundary edges are never flipped
+    vector< pair<int, int> > edges;
+
+    for( int i = (int)tris.size() - 1; i >= 0; --i )
+    {
+        for( int k = 0; k < 3; ++k )
+            edges.push_back( pair<int, int>( i, k ) );
+    }
+
+    size_t maxFlips = tris.size() * 64;
+
+    while( !edges.empty() && maxFlips > 0 )
+    {
+        int t = edges.back().first;
+        int k = edges.back().second;
+        int n = tris[t].nb[k];
+
+        edges.pop_back();
+
+        if( !flipEdge( t, k ) )
+            continue;
+
+        --maxFlips;
+
+        // the outer edges of the new pair of triangles must be checked again
+        edges.push_back( pair<int, int>( t, 0 ) );
+        edges.push_back( pair<int, int>( t, 1 ) );
+        edges.push_back( pair<int, int>( n, 0 ) );
+        edges.push_back( pair<int, int>( n, 1 ) );
+    }
+
+    return;
+}
+
+
+bool TESS_MESHER::Mesh( const vector<MCAD_POINT>& aUV, const vector<size_t>& aLoops,
+    IGES_MESH& aMesh, const vector<MCAD_POINT>* aPos, const vector<char>* aFixed )
+{
+    vector<int> idx;
+    TESS_EARCUT ec;
+
+    if( !ec.Triangulate( aUV, aLoops, idx ) )
+    {
+        ERRMSG << "\n + [INFO] could not triangulate the trimmed region\n";
+        return false;
+    }
+
+    uv.reserve( aUV.size() * 4 );
+    pos.reserve( aUV.size() * 4 );
+    nrm.reserve( aUV.size() * 4 );
+
+    for( size_t i = 0; i < aUV.size(); ++i )
+        addVertex( aUV[i].x, aUV[i].y );
+
+    if( !evalOK )
+        return false;
+
+    if( NULL != aFixed && NULL != aPos )
+    {
+        fixed = *aFixed;
+
+        for( size_t i = 0; i < fixed.size() && i < aPos->size(); ++i )
+        {
+            if( fixed[i] )
+                pos[i] = (*aPos)[i];
+        }
+    }
+
+    for( size_t i = 0; i + 2 < idx.size(); i += 3 )
+    {
+        TRI t = { { idx[i], idx[i + 1], idx[i + 2] }, { -1, -1, -1 } };
+        tris.push_back( t );
+    }
+
+    buildAdjacency();
+
+    if( !fixed.empty() )
+        restoreBoundary( aLoops, aUV.size() );
+
+    makeDelaunay();
+
+    for( int i = (int)tris.size() - 1; i >= 0; --i )
+        queue( i );
+
+    bool capped = false;
+
+    while( !pending.empty() && evalOK )
+    {
+        int t = pending.back();
+        pending.pop_back();
+        queued[t] = 0;
+
+        if( tris.size() >= TESS_MAX_TRIS )
+        {
+            capped = true;
+            break;
+        }
+
+        if( needsSplit( t ) )
+            bisect( t );
+    }
+
+    if( !evalOK )
+        return false;
+
+    if( capped )
+        ERRMSG << "\n + [INFO] triangle limit reached; the mesh may exceed the tolerance\n";
+
+    // vertices at which the normal is undefined take the average
+    // normal of the adjoining triangles
+    vector<MCAD_POINT> fn;
+
+    for( size_t i = 0; i < tris.size(); ++i )
+    {
+        const TRI& t = tris[i];
+
+        for( int k = 0; k < 3; ++k )
+        {
+            int v = t.v[k];
+
+            if( 0.0 != tessDot( nrm[v], nrm[v] ) )
+                continue;
+
+            if( fn.empty() )
+                fn.resize( nrm.size(), MCAD_POINT( 0.0, 0.0, 0.0 ) );
+
+            fn[v] += tessCross( pos[t.v[1]] - pos[t.v[0]], pos[t.v[2]] - pos[t.v[0]] );
+        }
+    }
+
+    for( size_t i = 0; i < fn.size(); ++i )
+    {
+        if( 0.0 == tessDot( nrm[i], nrm[i] ) )
+        {
+            nrm[i] = fn[i];
+            tessNormalize( nrm[i] );
+        }
+    }
+
+    aMesh.vertices.swap( pos );
+    aMesh.normals.swap( nrm );
+    aMesh.params.swap( uv );
+    aMesh.indices.resize( tris.size() * 3 );
+
+    for( size_t i = 0; i < tris.size(); ++i )
+    {
+        aMesh.indices[i * 3] = tris[i].v[0];
+        aMesh.indices[i * 3 + 1] = tris[i].v[1];
+        aMesh.indices[i * 3 + 2] = tris[i].v[2];
+    }
+
+    return true;
+}
+
+
+// retrieve the parameter space boundary of a Curve on a Parametric Surface
+// as a loop of points without the closing point
+static bool getLoop( IGES_ENTITY_142* aCurve, double aTol, vector<MCAD_POINT>& aPoints )
+{
+    aPoints.clear();
+
+    IGES_ENTITY* bp = NULL;
+    IGES_CURVE* cp = NULL;
+
+    if( NULL == aCurve || !aCurve->GetBPTR( &bp )
+        || NULL == ( cp = dynamic_cast<IGES_CURVE*>( bp ) ) )
+    {
+        ERRMSG << "\n + [INFO] boundary has no parameter space curve\n";
+        return false;
+    }
+
+    vector<MCAD_POINT> pts;
+
+    if( !cp->GetPolyline( pts, aTol, true ) )
+        return false;
+
+    if( pts.size() > 1 && pts.back().x == pts.front().x && pts.back().y == pts.front().y )
+        pts.pop_back();
+
+    if( pts.size() < 3 )
+    {
+        ERRMSG << "\n + [INFO] degenerate boundary\n";
+        return false;
+    }
+
+    for( size_t i = 0; i < pts.size(); ++i )
+        aPoints.push_back( MCAD_POINT( pts[i].x, pts[i].y, 0.0 ) );
+
+    return true;
+}
+
+
+// append a loop to the list of points; segments are subdivided so that
+// their length in the scaled parameter space does not exceed 1
+static void addLoop( const vector<MCAD_POINT>& aLoop, double aScaleU, double aScaleV,
+    vector<MCAD_POINT>& aPoints )
+{
+    size_t np = aLoop.size();
+
+    for( size_t i = 0; i < np; ++i )
+    {
+        const MCAD_POINT& p0 = aLoop[i];
+        const MCAD_POINT& p1 = aLoop[( i + 1 ) % np];
+        double du = ( p1.x - p0.x ) * aScaleU;
+        double dv = ( p1.y - p0.y ) * aScaleV;
+        int ns = (int)min( ceil( sqrt( du * du + dv * dv ) ), (double)TESS_MAX_SEGS );
+
+        aPoints.push_back( p0 );
+
+        for( int j = 1; j < ns; ++j )
+        {
+            double t = (double)j / ns;
+            aPoints.push_back( MCAD_POINT( p0.x + ( p1.x - p0.x ) * t,
+                p0.y + ( p1.y - p0.y ) * t, 0.0 ) );
+        }
+    }
+
+    return;
+}
+
+
+// estimate the parameter step at which the chord and angle tolerances are
+// met from the second difference of the positions at steps of aH and the
+// normals at the ends of a step
+static double calcStep( const MCAD_POINT& aD2, double aH, const MCAD_POINT& aN0,
+    const MCAD_POINT& aN1, double aChordTol, double aAngleTol )
+{
+    double step = HUGE_VAL;
+
+    // the chord error of a step s is about |S''| s^2 / 8
+    double c = sqrt( tessDot( aD2, aD2 ) ) / ( aH * aH );
+
+    if( c > 0.0 )
+        step = sqrt( 8.0 * aChordTol / c );
+
+    if( 0.0 != tessDot( aN0, aN0 ) && 0.0 != tessDot( aN1, aN1 ) )
+    {
+        double a = acos( max( -1.0, min( 1.0, tessDot( aN0, aN1 ) ) ) );
+
+        if( a > 0.0 )
+            step = min( step, aH * aAngleTol / a );
+    }
+
+    return step;
+}
+
+
+// parameter scales of a surface
+struct TESS_SCALE
+{
+    double scaleU;      // inverse of the parameter steps which meet the tolerances
+    double scaleV;
+    double uvTol;       // parameter space tolerance of the boundaries
+    double step;        // length of the shorter step in model space
+    MCAD_POINT pts[TESS_NSAMPLES][TESS_NSAMPLES];   // surface samples
+};
+
+
+// The surface is sampled on a coarse grid to estimate its greatest
+// speed and the parameter steps at which the chord and angle tolerances
+// are met in each direction. The trim loops are discretized in parameter
+// space with the tolerance scaled by the speed so that the error of the
+// boundary in model space does not exceed the chord tolerance; the steps
+// set the relative scale of the parameters during refinement so that
+// the triangles are stretched along directions of low curvature.
+static bool calcScale( const TESS_SURF& aSurf, double aChordTol, double aAngleTol,
+    TESS_SCALE& aScale )
+{
+    const int ns = TESS_NSAMPLES;
+    MCAD_POINT (&sp)[TESS_NSAMPLES][TESS_NSAMPLES] = aScale.pts;
+    MCAD_POINT sn[TESS_NSAMPLES][TESS_NSAMPLES];
+    double hu = ( aSurf.u1 - aSurf.u0 ) / ( ns - 1 );
+    double hv = ( aSurf.v1 - aSurf.v0 ) / ( ns - 1 );
+    double speedU = 0.0;
+    double speedV = 0.0;
+    MCAD_POINT du;
+    MCAD_POINT dv;
+
+    for( int j = 0; j < ns; ++j )
+    {
+        for( int i = 0; i < ns; ++i )
+        {
+            if( !aSurf.eval( aSurf.u0 + hu * i, aSurf.v0 + hv * j, sp[i][j], sn[i][j], &du, &dv ) )
+                return false;
+
+            speedU = max( speedU, tessDot( du, du ) );
+            speedV = max( speedV, tessDot( dv, dv ) );
+        }
+    }
+
+    double stepU = aSurf.u1 - aSurf.u0;
+    double stepV = aSurf.v1 - aSurf.v0;
+
+    for( int j = 0; j < ns; ++j )
+    {
+        for( int i = 0; i < ns; ++i )
+        {
+            if( i > 0 && i < ns - 1 )
+            {
+                MCAD_POINT d2 = sp[i + 1][j] - sp[i][j];
+                d2 -= sp[i][j] - sp[i - 1][j];
+                stepU = min( stepU, calcStep( d2, hu, sn[i][j], sn[i + 1][j],
+                    aChordTol, aAngleTol ) );
+            }
+
+            if( j > 0 && j < ns - 1 )
+            {
+                MCAD_POINT d2 = sp[i][j + 1] - sp[i][j];
+                d2 -= sp[i][j] - sp[i][j - 1];
+                stepV = min( stepV, calcStep( d2, hv, sn[i][j], sn[i][j + 1],
+                    aChordTol, aAngleTol ) );
+            }
+        }
+    }
+
+    speedU = sqrt( speedU );
+    speedV = sqrt( speedV );
+
+    double speed = max( speedU, speedV );
+    aScale.uvTol = max( aSurf.u1 - aSurf.u0, aSurf.v1 - aSurf.v0 ) * 1e-6;
+
+    if( speed * aScale.uvTol < aChordTol )
+        aScale.uvTol = aChordTol / speed;
+
+    // the steps are reduced slightly so that boundary segments of a
+    // single step do not fail the tolerances due to rounding
+    aScale.scaleU = 1.0 / ( TESS_STEP_MARGIN * stepU );
+    aScale.scaleV = 1.0 / ( TESS_STEP_MARGIN * stepV );
+    aScale.step = TESS_STEP_MARGIN * min( stepU * speedU, stepV * speedV );
+
+    return true;
+}
+
+
+struct TESS_BATCH
+{
+    const IGES_TESSELLATOR* tess;
+    const vector<IGES_ENTITY_144*>* surfaces;
+    vector<IGES_MESH>* meshes;
+    vector<char> ok;
+};
+
+
+static void tessTask( void* aData, size_t aTask, int aWorker )
+{
+    TESS_BATCH* bp = (TESS_BATCH*)aData;
+    IGES_MESH& mesh = (*bp->meshes)[aTask];
+
+    bp->ok[aTask] = bp->tess->Tessellate( (*bp->surfaces)[aTask], mesh ) ? 1 : 0;
+
+    return;
+}
+
+
+IGES_TESSELLATOR::IGES_TESSELLATOR()
+{
+    chordTol = TESS_DEFAULT_CHORD;
+    angleTol = TESS_DEFAULT_ANGLE;
+    xform = true;
+    return;
+}
+
+
+IGES_TESSELLATOR::~IGES_TESSELLATOR()
+{
+    return;
+}
+
+
+void IGES_TESSELLATOR::SetTolerance( double aChordTol, double aAngleTol )
+{
+    chordTol = aChordTol > 0.0 ? aChordTol : TESS_DEFAULT_CHORD;
+    angleTol = ( aAngleTol > 0.0 && aAngleTol < M_PI ) ? aAngleTol : TESS_DEFAULT_ANGLE;
+    return;
+}
+
+
+void IGES_TESSELLATOR::GetTolerance( double& aChordTol, double& aAngleTol ) const
+{
+    aChordTol = chordTol;
+    aAngleTol = angleTol;
+    return;
+}
+
+
+void IGES_TESSELLATOR::SetTransform( bool aTransform )
+{
+    xform = aTransform;
+    return;
+}
+
+
+bool IGES_TESSELLATOR::GetTransform( void ) const
+{
+    return xform;
+}
+
+
+bool IGES_TESSELLATOR::Tessellate( IGES_ENTITY_144* aSurface, IGES_MESH& aMesh ) const
+{
+    aMesh.Clear();
+
+    if( NULL == aSurface )
+    {
+        ERRMSG << "\n + [BUG] NULL pointer to surface\n";
+        return false;
+    }
+
+    aMesh.surface = aSurface;
+    TESS_SURF surf;
+
+    if( !surf.init( aSurface, xform ) )
+        return false;
+
+    TESS_SCALE sc;
+
+    if( !calcScale( surf, chordTol, angleTol, sc ) )
+        return false;
+
+    vector<MCAD_POINT> uv;
+    vector<size_t> loops;
+    IGES_ENTITY_142* pto = NULL;
+
+    vector<MCAD_POINT> loop;
+    double scaleU = sc.scaleU;
+    double scaleV = sc.scaleV;
+    double uvTol = sc.uvTol;
+
+    loops.push_back( 0 );
+
+    if( 0 != aSurface->N1 && aSurface->GetPTO( pto ) && NULL != pto )
+    {
+        if( !getLoop( pto, uvTol, loop ) )
+            return false;
+    }
+    else
+    {
+        loop.push_back( MCAD_POINT( surf.u0, surf.v0, 0.0 ) );
+        loop.push_back( MCAD_POINT( surf.u1, surf.v0, 0.0 ) );
+        loop.push_back( MCAD_POINT( surf.u1, surf.v1, 0.0 ) );
+        loop.push_back( MCAD_POINT( surf.u0, surf.v1, 0.0 ) );
+    }
+
+    addLoop( loop, scaleU, scaleV, uv );
+
+    size_t nPTI = 0;
+    IGES_ENTITY_142** pti = NULL;
+
+    if( aSurface->GetPTIList( nPTI, pti ) )
+    {
+        for( size_t i = 0; i < nPTI; ++i )
+        {
+            loops.push_back( uv.size() );
+
+            if( !getLoop( pti[i], uvTol, loop ) )
+                return false;
+
+            addLoop( loop, scaleU, scaleV, uv );
+        }
+    }
+
+    TESS_MESHER mesher( &surf, chordTol, angleTol, scaleU, scaleV );
+
+    if( !mesher.Mesh( uv, loops, aMesh ) )
+    {
+        aMesh.Clear();
+        aMesh.surface = aSurface;
+        return false;
+    }
+
+    return true;
+}
+
+
+size_t IGES_TESSELLATOR::Tessellate( IGES* aModel, vector<IGES_MESH>& aMeshes,
+    int aNThreads ) const
+{
+    aMeshes.clear();
+
+    if( NULL == aModel )
+    {
+        ERRMSG << "\n + [BUG] NULL pointer to model\n";
+        return 0;
+    }
+
+    size_t ns = 0;
+    IGES_ENTITY* const* sp = NULL;
+
+    if( !aModel->GetEntitiesByType( ENT_TRIMMED_PARAMETRIC_SURFACE, ns, sp ) || 0 == ns )
+        return 0;
+
+    vector<IGES_ENTITY_144*> surfaces( ns );
+
+    for( size_t i = 0; i < ns; ++i )
+        surfaces[i] = (IGES_ENTITY_144*)sp[i];
+
+    return Tessellate( surfaces, aMeshes, aNThreads );
+}
+
+
+size_t IGES_TESSELLATOR::Tessellate( const vector<IGES_ENTITY_144*>& aSurfaces,
+    vector<IGES_MESH>& aMeshes, int aNThreads ) const
+{
+    aMeshes.clear();
+
+    if( aSurfaces.empty() )
+        return 0;
+
+    aMeshes.resize( aSurfaces.size() );
+
+    TESS_BATCH batch;
+    batch.tess = this;
+    batch.surfaces = &aSurfaces;
+    batch.meshes = &aMeshes;
+    batch.ok.resize( aSurfaces.size(), 0 );
+
+    IGES_WORK_POOL::Run( aSurfaces.size(), tessTask, &batch, aNThreads );
+
+    size_t nok = 0;
+
+    for( size_t i = 0; i < batch.ok.size(); ++i )
+    {
+        if( batch.ok[i] )
+            ++nok;
+    }
+
+    return nok;
+}
+
+
+// an edge of a shell
+struct BREP_EDGE
+{
+    IGES_ENTITY* curve;
+    int sv;                         // shell vertex index of the start vertex
+    int tv;                         // shell vertex index of the terminate vertex
+    double step;                    // maximum length of a segment
+    vector<MCAD_POINT> points;      // points between the vertices
+    vector<int> verts;              // shell vertex indices from start to terminate
+};
+
+
+// a face of a shell
+struct BREP_FACE
+{
+    IGES_ENTITY_510* face;
+    bool flip;                      // the triangles must be reversed
+    bool outer;                     // the first loop is the outer boundary
+    vector< vector<IGES_BREP_USE> > loops;
+    TESS_SURF surf;
+    TESS_SCALE scale;
+    bool ok;
+    IGES_MESH mesh;
+    vector<int> vmap;               // shell vertex index of each boundary vertex or -1
+};
+
+
+struct BREP_JOB
+{
+    double chordTol;
+    double angleTol;
+    vector<MCAD_POINT> verts;       // shell vertex positions
+    vector<BREP_EDGE> edges;
+    vector<BREP_FACE> faces;
+};
+
+
+static void brepScaleTask( void* aData, size_t aTask, int aWorker )
+{
+    BREP_JOB* jp = (BREP_JOB*)aData;
+    BREP_FACE& face = jp->faces[aTask];
+
+    face.ok = face.surf.initSurface( face.face->GetSurface(), true )
+        && calcScale( face.surf, jp->chordTol, jp->angleTol, face.scale );
+
+    return;
+}
+
+
+static void brepEdgeTask( void* aData, size_t aTask, int aWorker )
+{
+    BREP_JOB* jp = (BREP_JOB*)aData;
+    BREP_EDGE& edge = jp->edges[aTask];
+    const MCAD_POINT& p0 = jp->verts[edge.sv];
+    const MCAD_POINT& p1 = jp->verts[edge.tv];
+    IGES_CURVE* cp = dynamic_cast<IGES_CURVE*>( edge.curve );
+    vector<MCAD_POINT> pts;
+
+    if( NULL == cp || !cp->GetPolyline( pts, jp->chordTol, true ) || pts.size() < 2 )
+    {
+        ERRMSG << "\n + [INFO] could not discretize an edge; using a straight line\n";
+        pts.clear();
+    }
+
+    // the curve may run against the edge
+    if( pts.size() > 1 )
+    {
+        MCAD_POINT d0 = pts.front() - p0;
+        MCAD_POINT d1 = pts.back() - p1;
+        MCAD_POINT r0 = pts.back() - p0;
+        MCAD_POINT r1 = pts.front() - p1;
+
+        if( tessDot( r0, r0 ) + tessDot( r1, r1 ) < tessDot( d0, d0 ) + tessDot( d1, d1 ) )
+            reverse( pts.begin(), pts.end() );
+    }
+
+    // the ends of the polyline are replaced by the vertices and segments
+    // are subdivided to the step of the adjoining faces
+    if( pts.size() < 2 )
+        pts.resize( 2 );
+
+    pts.front() = p0;
+    pts.back() = p1;
+
+    for( size_t i = 0; i + 1 < pts.size(); ++i )
+    {
+        MCAD_POINT d = pts[i + 1] - pts[i];
+        int ns = (int)min( ceil( sqrt( tessDot( d, d ) ) / edge.step ), (double)TESS_MAX_SEGS );
+
+        if( i > 0 )
+            edge.points.push_back( pts[i] );
+
+        for( int j = 1; j < ns; ++j )
+            edge.points.push_back( pts[i] + d * ( (double)j / ns ) );
+    }
+
+    return;
+}
+
+
+// find the parameters of a boundary point; the previous parameters are
+// tried first and then the nearest sample of the surface
+static double brepInvert( const BREP_FACE& aFace, const MCAD_POINT& aPoint, bool aUsePrev,
+    double& aU, double& aV )
+{
+    double tol = 0.0;
+    double dist = -1.0;
+
+    if( aUsePrev )
+    {
+        double u = aU;
+        double v = aV;
+        dist = aFace.surf.invert( aPoint, u, v );
+
+        // the tolerance is relative to the size of the surface
+        MCAD_POINT ext = aFace.scale.pts[TESS_NSAMPLES - 1][TESS_NSAMPLES - 1]
+            - aFace.scale.pts[0][0];
+        tol = 1e-3 * sqrt( tessDot( ext, ext ) );
+
+        if( dist >= 0.0 && dist <= tol )
+        {
+            aU = u;
+            aV = v;
+            return dist;
+        }
+    }
+
+    const int ns = TESS_NSAMPLES;
+    const TESS_SURF& sf = aFace.surf;
+    double bd = -1.0;
+
+    for( int j = 0; j < ns; ++j )
+    {
+        for( int i = 0; i < ns; ++i )
+        {
+            MCAD_POINT d = aFace.scale.pts[i][j] - aPoint;
+            double dd = tessDot( d, d );
+
+            if( bd < 0.0 || dd < bd )
+            {
+                bd = dd;
+                aU = sf.u0 + ( sf.u1 - sf.u0 ) * i / ( ns - 1 );
+                aV = sf.v0 + ( sf.v1 - sf.v0 ) * j / ( ns - 1 );
+            }
+        }
+    }
+
+    return sf.invert( aPoint, aU, aV );
+}
+
+
+static void brepFaceTask( void* aData, size_t aTask, int aWorker )
+{
+    BREP_JOB* jp = (BREP_JOB*)aData;
+    BREP_FACE& face = jp->faces[aTask];
+
+    if( !face.ok )
+        return;
+
+    face.ok = false;
+
+    const TESS_SURF& sf = face.surf;
+    vector<MCAD_POINT> uv;
+    vector<MCAD_POINT> pos;
+    vector<char> fix;
+    vector<size_t> loops;
+    vector<int> seq;
+    double maxDist = 0.0;
+
+    // without an outer loop the face is bounded by the parameter range
+    if( !face.outer )
+    {
+        vector<MCAD_POINT> loop;
+        loop.push_back( MCAD_POINT( sf.u0, sf.v0, 0.0 ) );
+        loop.push_back( MCAD_POINT( sf.u1, sf.v0, 0.0 ) );
+        loop.push_back( MCAD_POINT( sf.u1, sf.v1, 0.0 ) );
+        loop.push_back( MCAD_POINT( sf.u0, sf.v1, 0.0 ) );
+
+        loops.push_back( 0 );
+        addLoop( loop, face.scale.scaleU, face.scale.scaleV, uv );
+        pos.resize( uv.size() );
+        fix.resize( uv.size(), 0 );
+        face.vmap.resize( uv.size(), -1 );
+    }
+
+    for( size_t l = 0; l < face.loops.size(); ++l )
+    {
+        const vector<IGES_BREP_USE>& lp = face.loops[l];
+        seq.clear();
+
+        for( size_t i = 0; i < lp.size(); ++i )
+        {
+            if( lp[i].edge < 0 )
+            {
+                if( seq.empty() || seq.back() != lp[i].vertex )
+                    seq.push_back( lp[i].vertex );
+
+                continue;
+            }
+
+            const vector<int>& ev = jp->edges[lp[i].edge].verts;
+
+            for( size_t j = 0; j < ev.size(); ++j )
+            {
+                int v = lp[i].reverse ? ev[ev.size() - 1 - j] : ev[j];
+
+                if( seq.empty() || seq.back() != v )
+                    seq.push_back( v );
+            }
+        }
+
+        if( seq.size() > 1 && seq.front() == seq.back() )
+            seq.pop_back();
+
+        if( seq.size() < 3 )
+        {
+            ERRMSG << "\n + [INFO] degenerate loop in face\n";
+            return;
+        }
+
+        loops.push_back( uv.size() );
+
+        double u = sf.u0;
+        double v = sf.v0;
+
+        for( size_t i = 0; i < seq.size(); ++i )
+        {
+            const MCAD_POINT& p = jp->verts[seq[i]];
+            double d = brepInvert( face, p, i > 0, u, v );
+
+            if( d < 0.0 )
+                return;
+
+            maxDist = max( maxDist, d );
+            uv.push_back( MCAD_POINT( u, v, 0.0 ) );
+            pos.push_back( p );
+            fix.push_back( 1 );
+            face.vmap.push_back( seq[i] );
+        }
+    }
+
+    if( maxDist > 10.0 * jp->chordTol )
+    {
+        ERRMSG << "\n + [INFO] face boundary deviates from the surface by " << maxDist << "\n";
+    }
+
+    TESS_MESHER mesher( &sf, jp->chordTol, jp->angleTol, face.scale.scaleU, face.scale.scaleV );
+
+    if( !mesher.Mesh( uv, loops, face.mesh, &pos, &fix ) )
+    {
+        face.mesh.Clear();
+        return;
+    }
+
+    face.vmap.resize( face.mesh.vertices.size(), -1 );
+
+    if( face.flip )
+    {
+        vector<int>& ip = face.mesh.indices;
+
+        for( size_t i = 0; i + 2 < ip.size(); i += 3 )
+            swap( ip[i + 1], ip[i + 2] );
+
+        for( size_t i = 0; i < face.mesh.normals.size(); ++i )
+            face.mesh.normals[i] *= -1.0;
+    }
+
+    face.ok = true;
+    return;
+}
+
+
+bool IGES_TESSELLATOR::TessellateShell( IGES_ENTITY_514* aShell, IGES_MESH& aMesh,
+    bool aOrientation, int aNThreads ) const
+{
+    aMesh.Clear();
+
+    if( NULL == aShell )
+    {
+        ERRMSG << "\n + [BUG] NULL pointer to shell\n";
+        return false;
+    }
+
+    // the vertices and edges are numbered by the topology index;
+    // each is shared by all faces which use it
+    IGES_BREP_TOPOLOGY topo;
+
+    if( !topo.Build( aShell, aOrientation ) )
+    {
+        ERRMSG << "\n + [INFO] invalid shell\n";
+        return false;
+    }
+
+    BREP_JOB job;
+    size_t nf = topo.GetNFaces();
+    bool ok = true;
+
+    job.chordTol = chordTol;
+    job.angleTol = angleTol;
+    job.verts.resize( topo.GetNVertices() );
+    job.edges.resize( topo.GetNEdges() );
+    job.faces.resize( nf );
+
+    for( size_t i = 0; i < job.verts.size(); ++i )
+        job.verts[i] = topo.GetVertex( (int)i )->point;
+
+    for( size_t i = 0; i < job.edges.size(); ++i )
+    {
+        const IGES_BREP_EDGE* ep = topo.GetEdge( (int)i );
+        BREP_EDGE& edge = job.edges[i];
+        edge.curve = ep->curve;
+        edge.sv = ep->vertex[0];
+        edge.tv = ep->vertex[1];
+        edge.step = HUGE_VAL;
+    }
+
+    for( size_t f = 0; f < nf; ++f )
+    {
+        const IGES_BREP_FACE* fp = topo.GetFace( (int)f );
+        BREP_FACE& face = job.faces[f];
+        face.face = fp->face;
+        face.flip = fp->reverse;
+        face.outer = face.face->GetOuterLoopFlag();
+        face.ok = false;
+        face.loops.resize( fp->nLoops );
+
+        for( int l = 0; l < fp->nLoops; ++l )
+        {
+            const IGES_BREP_LOOP* lp = topo.GetLoop( fp->firstLoop + l );
+
+            for( int i = 0; i < lp->nUses; ++i )
+                face.loops[l].push_back( *topo.GetUse( lp->firstUse + i ) );
+        }
+    }
+
+    // the step of each edge is the smallest step of the faces which use it
+    IGES_WORK_POOL::Run( nf, brepScaleTask, &job, aNThreads );
+
+    for( size_t f = 0; f < nf; ++f )
+    {
+        if( !job.faces[f].ok )
+            continue;
+
+        for( size_t l = 0; l < job.faces[f].loops.size(); ++l )
+        {
+            const vector<IGES_BREP_USE>& lp = job.faces[f].loops[l];
+
+            for( size_t i = 0; i < lp.size(); ++i )
+            {
+                if( lp[i].edge >= 0 )
+                    job.edges[lp[i].edge].step =
+                        min( job.edges[lp[i].edge].step, job.faces[f].scale.step );
+            }
+        }
+    }
+
+    IGES_WORK_POOL::Run( job.edges.size(), brepEdgeTask, &job, aNThreads );
+
+    // number the points of the edges; each edge is discretized once
+    // so the faces on either side share its vertices
+    for( size_t i = 0; i < job.edges.size(); ++i )
+    {
+        BREP_EDGE& edge = job.edges[i];
+        edge.verts.push_back( edge.sv );
+
+        for( size_t j = 0; j < edge.points.size(); ++j )
+        {
+            edge.verts.push_back( (int)job.verts.size() );
+            job.verts.push_back( edge.points[j] );
+        }
+
+        edge.verts.push_back( edge.tv );
+        vector<MCAD_POINT>().swap( edge.points );
+    }
+
+    IGES_WORK_POOL::Run( nf, brepFaceTask, &job, aNThreads );
+
+    // merge the faces; the normals of shared vertices are averaged
+    vector<int> vmap( job.verts.size(), -1 );
+    vector<int> lmap;
+
+    for( size_t f = 0; f < nf; ++f )
+    {
+        BREP_FACE& face = job.faces[f];
+
+        if( !face.ok )
+        {
+            ok = false;
+            continue;
+        }
+
+        lmap.resize( face.mesh.vertices.size() );
+
+        for( size_t i = 0; i < face.mesh.vertices.size(); ++i )
+        {
+            int sv = face.vmap[i];
+            int gv;
+
+            if( sv >= 0 && vmap[sv] >= 0 )
+            {
+                gv = vmap[sv];
+                aMesh.normals[gv] += face.mesh.normals[i];
+            }
+            else
+            {
+                gv = (int)aMesh.vertices.size();
+                aMesh.vertices.push_back( sv >= 0 ? job.verts[sv] : face.mesh.vertices[i] );
+                aMesh.normals.push_back( face.mesh.normals[i] );
+
+                if( sv >= 0 )
+                    vmap[sv] = gv;
+            }
+
+            lmap[i] = gv;
+        }
+
+        for( size_t i = 0; i < face.mesh.indices.size(); ++i )
+            aMesh.indices.push_back( lmap[face.mesh.indices[i]] );
+
+        face.mesh.Clear();
+    }
+
+    for( size_t i = 0; i < aMesh.normals.size(); ++i )
+        tessNormalize( aMesh.normals[i] );
+
+    if( !ok )
+        ERRMSG << "\n + [INFO] some faces of the shell could not be meshed\n";
+
+    return ok;
+}
+
+
+size_t IGES_TESSELLATOR::TessellateSolid( IGES_ENTITY_186* aSolid, vector<IGES_MESH>& aMeshes,
+    int aNThreads ) const
+{
+    aMeshes.clear();
+
+    if( NULL == aSolid )
+    {
+        ERRMSG << "\n + [BUG] NULL pointer to solid\n";
+        return 0;
+    }
+
+    vector< pair<IGES_ENTITY_514*, bool> > shells;
+    IGES_ENTITY_514* sp = NULL;
+    bool sof = true;
+
+    if( !aSolid->GetShell( sp, sof ) )
+    {
+        ERRMSG << "\n + [INFO] solid has no shell\n";
+        return 0;
+    }
+
+    shells.push_back( pair<IGES_ENTITY_514*, bool>( sp, sof ) );
+
+    vector< pair<IGES_ENTITY_514*, bool> > voids;
+    aSolid->GetVoids( voids );
+    shells.insert( shells.end(), voids.begin(), voids.end() );
+
+    aMeshes.resize( shells.size() );
+    size_t nok = 0;
+
+    for( size_t i = 0; i < shells.size(); ++i )
+    {
+        if( TessellateShell( shells[i].first, aMeshes[i], shells[i].second, aNThreads ) )
+            ++nok;
+    }
+
+    return nok;
+}
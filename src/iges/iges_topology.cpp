@@ -0,0 +1,678 @@
+/*
+ * file: iges_topology.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: adjacency index of the vertices, edges, loops, faces
+ * and shells of Boundary Representation (B-REP) models.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <algorithm>
+#include <set>
+#include <error_macros.h>
+#include <core/iges.h>
+#include <core/entity186.h>
+#include <core/entity502.h>
+#include <core/entity504.h>
+#include <core/entity508.h>
+#include <core/entity510.h>
+#include <core/entity514.h>
+#include <core/iges_topology.h>
+
+
+using namespace std;
+
+
+IGES_BREP_TOPOLOGY::IGES_BREP_TOPOLOGY()
+{
+    return;
+}
+
+
+IGES_BREP_TOPOLOGY::~IGES_BREP_TOPOLOGY()
+{
+    return;
+}
+
+
+void IGES_BREP_TOPOLOGY::Clear( void )
+{
+    vertices.clear();
+    edges.clear();
+    uses.clear();
+    loops.clear();
+    faces.clear();
+    shells.clear();
+    vertStart.clear();
+    vertEdges.clear();
+    edgeStart.clear();
+    edgeUses.clear();
+    listBase.clear();
+    slots.clear();
+    return;
+}
+
+
+// return the first slot of a Vertex or Edge List; each entry of the
+// list has a slot which holds the index of its element or -1
+int IGES_BREP_TOPOLOGY::getSlot( IGES_ENTITY* aList, int aListSize )
+{
+    map<IGES_ENTITY*, int>::iterator sL = listBase.find( aList );
+
+    if( sL != listBase.end() )
+        return sL->second;
+
+    int base = (int)slots.size();
+    slots.resize( slots.size() + aListSize, -1 );
+    listBase.insert( pair<IGES_ENTITY*, int>( aList, base ) );
+    return base;
+}
+
+
+// return the index of a vertex, adding it if necessary, or -1 if the
+// vertex does not exist
+int IGES_BREP_TOPOLOGY::getVertex( IGES_ENTITY_502* aList, int aIndex )
+{
+    size_t nv = 0;
+    MCAD_POINT const* pp = NULL;
+
+    if( NULL == aList || !aList->GetVertices( nv, pp ) || aIndex < 1 || aIndex > (int)nv )
+    {
+        ERRMSG << "\n + [INFO] invalid vertex index\n";
+        return -1;
+    }
+
+    int slot = getSlot( aList, (int)nv ) + aIndex - 1;
+
+    if( slots[slot] < 0 )
+    {
+        slots[slot] = (int)vertices.size();
+
+        IGES_BREP_VERTEX vertex;
+        vertex.list = aList;
+        vertex.index = aIndex;
+        vertex.point = pp[aIndex - 1];
+        vertices.push_back( vertex );
+    }
+
+    return slots[slot];
+}
+
+
+bool IGES_BREP_TOPOLOGY::addShell( IGES_ENTITY_514* aShell, IGES_ENTITY_186* aSolid,
+    bool aOrientation )
+{
+    size_t nf = 0;
+    pair<IGES_ENTITY_510*, bool> const* fp = NULL;
+
+    if( NULL == aShell || !aShell->GetFaces( nf, fp ) )
+    {
+        ERRMSG << "\n + [INFO] shell has no faces\n";
+        return false;
+    }
+
+    IGES_BREP_SHELL shell;
+    shell.shell = aShell;
+    shell.solid = aSolid;
+    shell.reverse = !aOrientation;
+    shell.firstFace = (int)faces.size();
+    shell.nFaces = (int)nf;
+    shells.push_back( shell );
+
+    for( size_t f = 0; f < nf; ++f )
+    {
+        size_t nl = 0;
+        IGES_ENTITY_508** lp = NULL;
+
+        if( !fp[f].first->GetBounds( nl, lp ) )
+        {
+            ERRMSG << "\n + [INFO] face has no loops\n";
+            return false;
+        }
+
+        IGES_BREP_FACE face;
+        face.face = fp[f].first;
+        face.shell = (int)shells.size() - 1;
+        face.reverse = ( fp[f].second != aOrientation );
+        face.firstLoop = (int)loops.size();
+        face.nLoops = (int)nl;
+        faces.push_back( face );
+
+        for( size_t l = 0; l < nl; ++l )
+        {
+            size_t nd = 0;
+            LOOP_DATA** ld = NULL;
+
+            if( !lp[l]->GetLoopData( nd, ld ) )
+            {
+                ERRMSG << "\n + [INFO] empty loop\n";
+                return false;
+            }
+
+            IGES_BREP_LOOP loop;
+            loop.loop = lp[l];
+            loop.face = (int)faces.size() - 1;
+            loop.firstUse = (int)uses.size();
+            loop.nUses = (int)nd;
+            loops.push_back( loop );
+
+            for( size_t i = 0; i < nd; ++i )
+            {
+                IGES_BREP_USE use;
+                use.edge = -1;
+                use.vertex = -1;
+                use.loop = (int)loops.size() - 1;
+                use.reverse = !ld[i]->orientFlag;
+
+                if( ld[i]->isVertex )
+                {
+                    use.vertex = getVertex( (IGES_ENTITY_502*)ld[i]->data, ld[i]->idx );
+
+                    if( use.vertex < 0 )
+                        return false;
+
+                    uses.push_back( use );
+                    continue;
+                }
+
+                IGES_ENTITY_504* el = (IGES_ENTITY_504*)ld[i]->data;
+                size_t ne = 0;
+                EDGE_DATA const* ed = NULL;
+
+                if( NULL == el || !el->GetEdges( ne, ed ) || ld[i]->idx < 1
+                    || ld[i]->idx > (int)ne )
+                {
+                    ERRMSG << "\n + [INFO] invalid edge index in loop\n";
+                    return false;
+                }
+
+                int slot = getSlot( el, (int)ne ) + ld[i]->idx - 1;
+
+                if( slots[slot] < 0 )
+                {
+                    const EDGE_DATA& data = ed[ld[i]->idx - 1];
+                    IGES_BREP_EDGE edge;
+                    edge.list = el;
+                    edge.index = ld[i]->idx;
+                    edge.curve = data.curv;
+                    edge.vertex[0] = getVertex( data.svp, data.sv );
+                    edge.vertex[1] = getVertex( data.tvp, data.tv );
+
+                    if( edge.vertex[0] < 0 || edge.vertex[1] < 0 )
+                        return false;
+
+                    slots[slot] = (int)edges.size();
+                    edges.push_back( edge );
+                }
+
+                use.edge = slots[slot];
+                uses.push_back( use );
+            }
+        }
+    }
+
+    return true;
+}
+
+
+// build the compressed rows of edges per vertex and uses per edge
+void IGES_BREP_TOPOLOGY::buildRows( void )
+{
+    vertStart.assign( vertices.size() + 1, 0 );
+    edgeStart.assign( edges.size() + 1, 0 );
+
+    for( size_t i = 0; i < edges.size(); ++i )
+    {
+        ++vertStart[edges[i].vertex[0] + 1];
+
+        if( edges[i].vertex[1] != edges[i].vertex[0] )
+            ++vertStart[edges[i].vertex[1] + 1];
+    }
+
+    for( size_t i = 0; i < uses.size(); ++i )
+    {
+        if( uses[i].edge >= 0 )
+            ++edgeStart[uses[i].edge + 1];
+    }
+
+    for( size_t i = 1; i < vertStart.size(); ++i )
+        vertStart[i] += vertStart[i - 1];
+
+    for( size_t i = 1; i < edgeStart.size(); ++i )
+        edgeStart[i] += edgeStart[i - 1];
+
+    // fill the rows using a running position per row
+    vector<int> pos( vertStart.begin(), vertStart.end() - 1 );
+    vertEdges.resize( vertStart.back() );
+
+    for( size_t i = 0; i < edges.size(); ++i )
+    {
+        vertEdges[pos[edges[i].vertex[0]]++] = (int)i;
+
+        if( edges[i].vertex[1] != edges[i].vertex[0] )
+            vertEdges[pos[edges[i].vertex[1]]++] = (int)i;
+    }
+
+    pos.assign( edgeStart.begin(), edgeStart.end() - 1 );
+    edgeUses.resize( edgeStart.back() );
+
+    for( size_t i = 0; i < uses.size(); ++i )
+    {
+        if( uses[i].edge >= 0 )
+            edgeUses[pos[uses[i].edge]++] = (int)i;
+    }
+
+    // the list mapping is only needed while building
+    listBase.clear();
+    vector<int>().swap( slots );
+    return;
+}
+
+
+bool IGES_BREP_TOPOLOGY::Build( IGES_ENTITY_514* aShell, bool aOrientation )
+{
+    Clear();
+
+    if( NULL == aShell )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    if( !addShell( aShell, NULL, aOrientation ) )
+    {
+        Clear();
+        return false;
+    }
+
+    buildRows();
+    return true;
+}
+
+
+bool IGES_BREP_TOPOLOGY::Build( IGES_ENTITY_186* aSolid )
+{
+    Clear();
+
+    if( NULL == aSolid )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    IGES_ENTITY_514* sp = NULL;
+    bool sof = true;
+    vector< pair<IGES_ENTITY_514*, bool> > voids;
+
+    if( !aSolid->GetShell( sp, sof ) )
+    {
+        ERRMSG << "\n + [INFO] solid has no shell\n";
+        return false;
+    }
+
+    aSolid->GetVoids( voids );
+    bool ok = addShell( sp, aSolid, sof );
+
+    for( size_t i = 0; i < voids.size() && ok; ++i )
+        ok = addShell( voids[i].first, aSolid, voids[i].second );
+
+    if( !ok )
+    {
+        Clear();
+        return false;
+    }
+
+    buildRows();
+    return true;
+}
+
+
+bool IGES_BREP_TOPOLOGY::Build( IGES* aModel )
+{
+    Clear();
+
+    if( NULL == aModel )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    set<IGES_ENTITY*> used;     // shells which are part of a solid
+    size_t nl = 0;
+    IGES_ENTITY* const* lp = NULL;
+    bool ok = true;
+
+    if( aModel->GetEntitiesByType( ENT_MANIFOLD_SOLID_BREP, nl, lp ) )
+    {
+        for( size_t i = 0; i < nl && ok; ++i )
+        {
+            IGES_ENTITY_186* solid = (IGES_ENTITY_186*)lp[i];
+            IGES_ENTITY_514* sp = NULL;
+            bool sof = true;
+            vector< pair<IGES_ENTITY_514*, bool> > voids;
+
+            if( !solid->GetShell( sp, sof ) )
+            {
+                ERRMSG << "\n + [INFO] solid has no shell\n";
+                ok = false;
+                break;
+            }
+
+            solid->GetVoids( voids );
+            used.insert( sp );
+            ok = addShell( sp, solid, sof );
+
+            for( size_t j = 0; j < voids.size() && ok; ++j )
+            {
+                used.insert( voids[j].first );
+                ok = addShell( voids[j].first, solid, voids[j].second );
+            }
+        }
+    }
+
+    if( ok && aModel->GetEntitiesByType( ENT_SHELL, nl, lp ) )
+    {
+        for( size_t i = 0; i < nl && ok; ++i )
+        {
+            if( used.find( lp[i] ) == used.end() )
+                ok = addShell( (IGES_ENTITY_514*)lp[i], NULL, true );
+        }
+    }
+
+    if( !ok )
+    {
+        Clear();
+        return false;
+    }
+
+    buildRows();
+    return !shells.empty();
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetNVertices( void ) const
+{
+    return vertices.size();
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetNEdges( void ) const
+{
+    return edges.size();
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetNUses( void ) const
+{
+    return uses.size();
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetNLoops( void ) const
+{
+    return loops.size();
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetNFaces( void ) const
+{
+    return faces.size();
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetNShells( void ) const
+{
+    return shells.size();
+}
+
+
+const IGES_BREP_VERTEX* IGES_BREP_TOPOLOGY::GetVertex( int aIndex ) const
+{
+    if( aIndex < 0 || aIndex >= (int)vertices.size() )
+        return NULL;
+
+    return &vertices[aIndex];
+}
+
+
+const IGES_BREP_EDGE* IGES_BREP_TOPOLOGY::GetEdge( int aIndex ) const
+{
+    if( aIndex < 0 || aIndex >= (int)edges.size() )
+        return NULL;
+
+    return &edges[aIndex];
+}
+
+
+const IGES_BREP_USE* IGES_BREP_TOPOLOGY::GetUse( int aIndex ) const
+{
+    if( aIndex < 0 || aIndex >= (int)uses.size() )
+        return NULL;
+
+    return &uses[aIndex];
+}
+
+
+const IGES_BREP_LOOP* IGES_BREP_TOPOLOGY::GetLoop( int aIndex ) const
+{
+    if( aIndex < 0 || aIndex >= (int)loops.size() )
+        return NULL;
+
+    return &loops[aIndex];
+}
+
+
+const IGES_BREP_FACE* IGES_BREP_TOPOLOGY::GetFace( int aIndex ) const
+{
+    if( aIndex < 0 || aIndex >= (int)faces.size() )
+        return NULL;
+
+    return &faces[aIndex];
+}
+
+
+const IGES_BREP_SHELL* IGES_BREP_TOPOLOGY::GetShell( int aIndex ) const
+{
+    if( aIndex < 0 || aIndex >= (int)shells.size() )
+        return NULL;
+
+    return &shells[aIndex];
+}
+
+
+int IGES_BREP_TOPOLOGY::FindFace( IGES_ENTITY_510* aFace ) const
+{
+    for( size_t i = 0; i < faces.size(); ++i )
+    {
+        if( faces[i].face == aFace )
+            return (int)i;
+    }
+
+    return -1;
+}
+
+
+bool IGES_BREP_TOPOLOGY::GetVertexEdges( int aVertex, size_t& aListSize,
+    int const*& aEdgeList ) const
+{
+    aListSize = 0;
+    aEdgeList = NULL;
+
+    if( aVertex < 0 || aVertex >= (int)vertices.size() )
+        return false;
+
+    aListSize = vertStart[aVertex + 1] - vertStart[aVertex];
+
+    if( 0 == aListSize )
+        return false;
+
+    aEdgeList = &vertEdges[vertStart[aVertex]];
+    return true;
+}
+
+
+bool IGES_BREP_TOPOLOGY::GetEdgeUses( int aEdge, size_t& aListSize,
+    int const*& aUseList ) const
+{
+    aListSize = 0;
+    aUseList = NULL;
+
+    if( aEdge < 0 || aEdge >= (int)edges.size() )
+        return false;
+
+    aListSize = edgeStart[aEdge + 1] - edgeStart[aEdge];
+
+    if( 0 == aListSize )
+        return false;
+
+    aUseList = &edgeUses[edgeStart[aEdge]];
+    return true;
+}
+
+
+bool IGES_BREP_TOPOLOGY::GetEdgeFaces( int aEdge, std::vector<int>& aFaceList ) const
+{
+    aFaceList.clear();
+
+    size_t nu = 0;
+    int const* up = NULL;
+
+    if( !GetEdgeUses( aEdge, nu, up ) )
+        return false;
+
+    for( size_t i = 0; i < nu; ++i )
+    {
+        int face = loops[uses[up[i]].loop].face;
+
+        if( find( aFaceList.begin(), aFaceList.end(), face ) == aFaceList.end() )
+            aFaceList.push_back( face );
+    }
+
+    return true;
+}
+
+
+bool IGES_BREP_TOPOLOGY::GetFaceNeighbors( int aFace, std::vector<int>& aFaceList ) const
+{
+    aFaceList.clear();
+
+    if( aFace < 0 || aFace >= (int)faces.size() )
+        return false;
+
+    const IGES_BREP_FACE& face = faces[aFace];
+
+    for( int l = face.firstLoop; l < face.firstLoop + face.nLoops; ++l )
+    {
+        for( int u = loops[l].firstUse; u < loops[l].firstUse + loops[l].nUses; ++u )
+        {
+            int edge = uses[u].edge;
+
+            if( edge < 0 )
+                continue;
+
+            for( int i = edgeStart[edge]; i < edgeStart[edge + 1]; ++i )
+            {
+                int nf = loops[uses[edgeUses[i]].loop].face;
+
+                if( nf != aFace )
+                    aFaceList.push_back( nf );
+            }
+        }
+    }
+
+    sort( aFaceList.begin(), aFaceList.end() );
+    aFaceList.erase( unique( aFaceList.begin(), aFaceList.end() ), aFaceList.end() );
+    return !aFaceList.empty();
+}
+
+
+bool IGES_BREP_TOPOLOGY::IsUseReversed( int aUse ) const
+{
+    if( aUse < 0 || aUse >= (int)uses.size() )
+        return false;
+
+    return uses[aUse].reverse != faces[loops[uses[aUse].loop].face].reverse;
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetOpenEdges( std::vector<int>& aEdgeList ) const
+{
+    aEdgeList.clear();
+
+    for( size_t i = 0; i < edges.size(); ++i )
+    {
+        if( edgeStart[i + 1] - edgeStart[i] < 2 )
+            aEdgeList.push_back( (int)i );
+    }
+
+    return aEdgeList.size();
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetNonManifoldEdges( std::vector<int>& aEdgeList ) const
+{
+    aEdgeList.clear();
+
+    for( size_t i = 0; i < edges.size(); ++i )
+    {
+        if( edgeStart[i + 1] - edgeStart[i] > 2 )
+            aEdgeList.push_back( (int)i );
+    }
+
+    return aEdgeList.size();
+}
+
+
+size_t IGES_BREP_TOPOLOGY::GetMisorientedEdges( std::vector<int>& aEdgeList ) const
+{
+    aEdgeList.clear();
+
+    for( size_t i = 0; i < edges.size(); ++i )
+    {
+        if( edgeStart[i + 1] - edgeStart[i] != 2 )
+            continue;
+
+        if( IsUseReversed( edgeUses[edgeStart[i]] )
+            == IsUseReversed( edgeUses[edgeStart[i] + 1] ) )
+            aEdgeList.push_back( (int)i );
+    }
+
+    return aEdgeList.size();
+}
+
+
+bool IGES_BREP_TOPOLOGY::IsManifold( void ) const
+{
+    if( edges.empty() )
+        return false;
+
+    for( size_t i = 0; i < edges.size(); ++i )
+    {
+        if( edgeStart[i + 1] - edgeStart[i] != 2 )
+            return false;
+
+        if( IsUseReversed( edgeUses[edgeStart[i]] )
+            == IsUseReversed( edgeUses[edgeStart[i] + 1] ) )
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,449 @@
+/*
+ * file: iges_trim.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: uniform grid over the parameter space boundaries of a
+ * Trimmed Parametric Surface (144) to classify (u, v) points as inside
+ * or outside of the trimmed region.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <error_macros.h>
+#include <core/iges_curve.h>
+#include <core/entity120.h>
+#include <core/entity128.h>
+#include <core/entity142.h>
+#include <core/entity144.h>
+#include <core/iges_trim.h>
+
+
+using namespace std;
+
+// maximum number of cells along each axis of the grid
+#define TRIM_MAX_CELLS (1024)
+
+
+// append the parameter space polyline of a boundary curve to the loops
+static bool addLoop( IGES_ENTITY_142* aCurve, double aTolerance,
+    vector< vector<MCAD_POINT> >& aLoops )
+{
+    IGES_ENTITY* bp = NULL;
+    IGES_CURVE* cp = NULL;
+
+    if( NULL == aCurve || !aCurve->GetBPTR( &bp )
+        || NULL == ( cp = dynamic_cast<IGES_CURVE*>( bp ) ) )
+    {
+        ERRMSG << "\n + [INFO] boundary has no parameter space curve\n";
+        return false;
+    }
+
+    aLoops.push_back( vector<MCAD_POINT>() );
+
+    if( !cp->GetPolyline( aLoops.back(), aTolerance, true ) )
+    {
+        aLoops.pop_back();
+        return false;
+    }
+
+    return true;
+}
+
+
+// retrieve the parameter range of the untrimmed surface if it is known
+static bool getDomain( IGES_ENTITY* aSurface, double& aU0, double& aU1,
+    double& aV0, double& aV1 )
+{
+    if( NULL == aSurface )
+        return false;
+
+    if( ENT_NURBS_SURFACE == aSurface->GetEntityType() )
+    {
+        int nCoeff1, nCoeff2, order1, order2;
+        double* knot1;
+        double* knot2;
+        double* coeff;
+        bool isRational, isClosed1, isClosed2, isPeriodic1, isPeriodic2;
+
+        return ((IGES_ENTITY_128*)aSurface)->GetNURBSData( nCoeff1, nCoeff2,
+            order1, order2, &knot1, &knot2, &coeff, isRational, isClosed1,
+            isClosed2, isPeriodic1, isPeriodic2, aU0, aU1, aV0, aV1 );
+    }
+
+    if( ENT_SURFACE_OF_REVOLUTION == aSurface->GetEntityType() )
+        return ((IGES_ENTITY_120*)aSurface)->GetParameterRange( aU0, aU1, aV0, aV1 );
+
+    return false;
+}
+
+
+IGES_TRIM_GRID::IGES_TRIM_GRID()
+{
+    Clear();
+    return;
+}
+
+
+IGES_TRIM_GRID::~IGES_TRIM_GRID()
+{
+    return;
+}
+
+
+void IGES_TRIM_GRID::Clear( void )
+{
+    segs.clear();
+    cellStart.clear();
+    cellSegs.clear();
+    cellState.clear();
+    minU = 0.0;
+    minV = 0.0;
+    cellU = 1.0;
+    cellV = 1.0;
+    nU = 0;
+    nV = 0;
+    hasOuter = false;
+    return;
+}
+
+
+bool IGES_TRIM_GRID::Build( const vector< vector<MCAD_POINT> >& aLoops, bool aHasOuter )
+{
+    Clear();
+
+    for( size_t i = 0; i < aLoops.size(); ++i )
+    {
+        const vector<MCAD_POINT>& loop = aLoops[i];
+        size_t np = loop.size();
+
+        // drop an explicit closing point
+        if( np > 1 && loop[0].x == loop[np - 1].x && loop[0].y == loop[np - 1].y )
+            --np;
+
+        if( np < 3 )
+        {
+            ERRMSG << "\n + [INFO] degenerate boundary\n";
+            Clear();
+            return false;
+        }
+
+        for( size_t j = 0; j < np; ++j )
+        {
+            const MCAD_POINT& p0 = loop[j];
+            const MCAD_POINT& p1 = loop[( j + 1 ) % np];
+
+            if( p0.x == p1.x && p0.y == p1.y )
+                continue;
+
+            segs.push_back( MCAD_POINT( p0.x, p0.y, 0.0 ) );
+            segs.push_back( MCAD_POINT( p1.x, p1.y, 0.0 ) );
+        }
+    }
+
+    hasOuter = aHasOuter;
+
+    if( segs.empty() )
+        return true;
+
+    double maxU = segs[0].x;
+    double maxV = segs[0].y;
+    minU = maxU;
+    minV = maxV;
+
+    for( size_t i = 1; i < segs.size(); ++i )
+    {
+        minU = min( minU, segs[i].x );
+        maxU = max( maxU, segs[i].x );
+        minV = min( minV, segs[i].y );
+        maxV = max( maxV, segs[i].y );
+    }
+
+    // pad the bounds so that no boundary lies on the edge of the grid
+    double pad = 1e-6 * max( maxU - minU, maxV - minV );
+
+    if( pad <= 0.0 )
+        pad = 1e-9;
+
+    minU -= pad;
+    minV -= pad;
+    maxU += pad;
+    maxV += pad;
+
+    // aim for roughly one segment per cell with square cells
+    int nSegs = (int)( segs.size() / 2 );
+    double aspect = ( maxU - minU ) / ( maxV - minV );
+    double fu = ceil( sqrt( nSegs * aspect ) );
+    double fv = ceil( nSegs / fu );
+
+    nU = (int)max( 1.0, min( fu, (double)TRIM_MAX_CELLS ) );
+    nV = (int)max( 1.0, min( fv, (double)TRIM_MAX_CELLS ) );
+    cellU = ( maxU - minU ) / nU;
+    cellV = ( maxV - minV ) / nV;
+
+    // assign each segment to every cell which it touches; the ranges are
+    // widened slightly so that rounding never loses a segment
+    vector< pair<int, int> > entries;
+    double epsU = 1e-9 * cellU;
+    double epsV = 1e-9 * cellV;
+
+    for( int s = 0; s < nSegs; ++s )
+    {
+        const MCAD_POINT& a = segs[2 * s];
+        const MCAD_POINT& b = segs[2 * s + 1];
+        double y0 = min( a.y, b.y ) - epsV;
+        double y1 = max( a.y, b.y ) + epsV;
+        int j0 = max( 0, (int)floor( ( y0 - minV ) / cellV ) );
+        int j1 = min( nV - 1, (int)floor( ( y1 - minV ) / cellV ) );
+
+        for( int j = j0; j <= j1; ++j )
+        {
+            // clip the segment to the band of row j
+            double by0 = max( y0, minV + j * cellV );
+            double by1 = min( y1, minV + ( j + 1 ) * cellV );
+            double x0, x1;
+
+            if( a.y == b.y )
+            {
+                x0 = min( a.x, b.x );
+                x1 = max( a.x, b.x );
+            }
+            else
+            {
+                double t0 = ( by0 - a.y ) / ( b.y - a.y );
+                double t1 = ( by1 - a.y ) / ( b.y - a.y );
+                t0 = max( 0.0, min( 1.0, t0 ) );
+                t1 = max( 0.0, min( 1.0, t1 ) );
+                x0 = a.x + t0 * ( b.x - a.x );
+                x1 = a.x + t1 * ( b.x - a.x );
+
+                if( x0 > x1 )
+                    swap( x0, x1 );
+            }
+
+            int i0 = max( 0, (int)floor( ( x0 - epsU - minU ) / cellU ) );
+            int i1 = min( nU - 1, (int)floor( ( x1 + epsU - minU ) / cellU ) );
+
+            for( int i = i0; i <= i1; ++i )
+                entries.push_back( pair<int, int>( j * nU + i, s ) );
+        }
+    }
+
+    sort( entries.begin(), entries.end() );
+
+    int nCells = nU * nV;
+    cellStart.resize( nCells + 1, 0 );
+    cellSegs.resize( entries.size() );
+
+    for( size_t i = 0; i < entries.size(); ++i )
+    {
+        ++cellStart[entries[i].first + 1];
+        cellSegs[i] = entries[i].second;
+    }
+
+    for( int i = 0; i < nCells; ++i )
+        cellStart[i + 1] += cellStart[i];
+
+    // calculate the state of the cell centers one row at a time by
+    // casting a ray along the row; every segment which crosses the
+    // center line of the row is listed in one of the cells of the row
+    cellState.resize( nCells, 0 );
+    vector<int> lastRow( nSegs, -1 );
+    vector<double> xings;
+
+    for( int j = 0; j < nV; ++j )
+    {
+        double yc = minV + ( j + 0.5 ) * cellV;
+        xings.clear();
+
+        for( int k = cellStart[j * nU]; k < cellStart[( j + 1 ) * nU]; ++k )
+        {
+            int s = cellSegs[k];
+
+            if( lastRow[s] == j )
+                continue;
+
+            lastRow[s] = j;
+            const MCAD_POINT& a = segs[2 * s];
+            const MCAD_POINT& b = segs[2 * s + 1];
+
+            if( ( a.y > yc ) != ( b.y > yc ) )
+                xings.push_back( a.x + ( yc - a.y ) * ( b.x - a.x ) / ( b.y - a.y ) );
+        }
+
+        sort( xings.begin(), xings.end() );
+        size_t nx = 0;
+
+        for( int i = 0; i < nU; ++i )
+        {
+            double xc = minU + ( i + 0.5 ) * cellU;
+
+            while( nx < xings.size() && xings[nx] <= xc )
+                ++nx;
+
+            cellState[j * nU + i] = (char)( nx & 1 );
+        }
+    }
+
+    return true;
+}
+
+
+bool IGES_TRIM_GRID::Build( IGES_ENTITY_144* aSurface, double aTolerance )
+{
+    Clear();
+
+    if( NULL == aSurface )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return false;
+    }
+
+    vector< vector<MCAD_POINT> > loops;
+    IGES_ENTITY_142* pto = NULL;
+    bool outer = true;
+
+    if( 0 != aSurface->N1 )
+    {
+        if( !aSurface->GetPTO( pto ) || !addLoop( pto, aTolerance, loops ) )
+            return false;
+    }
+    else
+    {
+        IGES_ENTITY* pts = NULL;
+        double u0, u1, v0, v1;
+
+        if( aSurface->GetPTS( pts ) && getDomain( pts, u0, u1, v0, v1 ) )
+        {
+            loops.push_back( vector<MCAD_POINT>() );
+            loops.back().push_back( MCAD_POINT( u0, v0, 0.0 ) );
+            loops.back().push_back( MCAD_POINT( u1, v0, 0.0 ) );
+            loops.back().push_back( MCAD_POINT( u1, v1, 0.0 ) );
+            loops.back().push_back( MCAD_POINT( u0, v1, 0.0 ) );
+        }
+        else
+        {
+            outer = false;
+        }
+    }
+
+    size_t nPTI = 0;
+    IGES_ENTITY_142** pti = NULL;
+
+    if( aSurface->GetPTIList( nPTI, pti ) )
+    {
+        for( size_t i = 0; i < nPTI; ++i )
+        {
+            if( !addLoop( pti[i], aTolerance, loops ) )
+                return false;
+        }
+    }
+
+    return Build( loops, outer );
+}
+
+
+bool IGES_TRIM_GRID::classify( double aU, double aV ) const
+{
+    if( 0 == nU )
+        return !hasOuter;
+
+    double fu = ( aU - minU ) / cellU;
+    double fv = ( aV - minV ) / cellV;
+
+    // a point outside the grid is outside of every loop
+    if( !( fu >= 0.0 && fu < nU && fv >= 0.0 && fv < nV ) )
+        return !hasOuter;
+
+    int i = min( nU - 1, (int)fu );
+    int j = min( nV - 1, (int)fv );
+    int cell = j * nU + i;
+    double xc = minU + ( i + 0.5 ) * cellU;
+    double yc = minV + ( j + 0.5 ) * cellV;
+    bool odd = cellState[cell] != 0;
+
+    // walk from the cell center horizontally to (aU, yc) and then
+    // vertically to (aU, aV); the crossing rules match those used for
+    // the cell centers so that each vertex is counted consistently
+    double x0 = min( xc, aU );
+    double x1 = max( xc, aU );
+    double y0 = min( yc, aV );
+    double y1 = max( yc, aV );
+
+    for( int k = cellStart[cell]; k < cellStart[cell + 1]; ++k )
+    {
+        const MCAD_POINT& a = segs[2 * cellSegs[k]];
+        const MCAD_POINT& b = segs[2 * cellSegs[k] + 1];
+
+        if( ( a.y > yc ) != ( b.y > yc ) )
+        {
+            double x = a.x + ( yc - a.y ) * ( b.x - a.x ) / ( b.y - a.y );
+
+            if( x > x0 && x <= x1 )
+                odd = !odd;
+        }
+
+        if( ( a.x > aU ) != ( b.x > aU ) )
+        {
+            double y = a.y + ( aU - a.x ) * ( b.y - a.y ) / ( b.x - a.x );
+
+            if( y > y0 && y <= y1 )
+                odd = !odd;
+        }
+    }
+
+    return hasOuter ? odd : !odd;
+}
+
+
+bool IGES_TRIM_GRID::IsInside( double aU, double aV ) const
+{
+    return classify( aU, aV );
+}
+
+
+size_t IGES_TRIM_GRID::Classify( size_t aNPoints, const double* aU, const double* aV,
+    bool* aInside ) const
+{
+    if( NULL == aU || NULL == aV || NULL == aInside )
+    {
+        ERRMSG << "\n + [INFO] [BUG] NULL pointer passed\n";
+        return 0;
+    }
+
+    size_t nIn = 0;
+
+    for( size_t i = 0; i < aNPoints; ++i )
+    {
+        aInside[i] = classify( aU[i], aV[i] );
+
+        if( aInside[i] )
+            ++nIn;
+    }
+
+    return nIn;
+}
+
+
+size_t IGES_TRIM_GRID::GetNSegments( void ) const
+{
+    return segs.size() / 2;
+}
@@ -32,6 +32,7 @@
 #include <libigesconf.h>
 #include <api/dll_iges_entity.h>
 #include <api/dll_iges_curve.h>
+#include <geom/mcad_elements.h>
 
 
 class MCAD_API DLL_IGES_ENTITY_120 : public DLL_IGES_ENTITY
@@ -51,6 +52,10 @@ public:
     bool SetGeneratrix( DLL_IGES_CURVE& aCurve );
     bool GetAngles( double& aStartAngle, double& aEndAngle );
     bool SetAngles( double aStartAngle, double aEndAngle );
+    bool GetParameterRange( double& aT0, double& aT1, double& aTheta0, double& aTheta1 );
+    bool Evaluate( size_t aNParams, const double* aT, const double* aTheta,
+        MCAD_POINT* aPoint, MCAD_POINT* aDerivT = NULL, MCAD_POINT* aDerivTheta = NULL,
+        bool xform = true );
 };
 
 #endif  // ENTITY_TEMP_H
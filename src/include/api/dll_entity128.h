@@ -60,6 +60,11 @@ public:
     bool isClosed2( bool& aResult );
     bool isPeriodic1( bool& aResult );
     bool isPeriodic2( bool& aResult );
+
+    bool EvaluateGrid( size_t aNU, const double* aU, size_t aNV, const double* aV,
+                       MCAD_POINT* aPoint, MCAD_POINT* aDerivU = NULL,
+                       MCAD_POINT* aDerivV = NULL, MCAD_POINT* aNormal = NULL,
+                       bool xform = true );
 };
 
 #endif  // DLL_ENTITY_128_H
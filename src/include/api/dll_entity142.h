@@ -31,6 +31,7 @@
 
 #include <libigesconf.h>
 #include <api/dll_iges_entity.h>
+#include <geom/mcad_elements.h>
 
 enum BOUND_CURVE_PREF
 {
@@ -72,6 +73,11 @@ public:
     bool SetCurvePreference( BOUND_CURVE_PREF aPref );
     bool GetCurveCreationFlag( CURVE_CREATION& aFlag );
     bool SetCurveCreationFlag( CURVE_CREATION aFlag );
+    // calculate a polyline which approximates the curve to within the given
+    // chord tolerance; if aPointList returns with a non-NULL value then the
+    // user is responsible for its destruction via delete []
+    bool GetPolyline( MCAD_POINT*& aPointList, int& aNumPoints, double aTolerance = 0.0,
+                      bool xform = true );
 };
 
 #endif  // DLL_ENTITY_142_H
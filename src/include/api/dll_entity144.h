@@ -54,6 +54,9 @@ public:
     bool AddCutout( DLL_IGES_ENTITY_142& aPtr );
     bool DelCutout( IGES_ENTITY_142* aPtr );
     bool DelCutout( DLL_IGES_ENTITY_142& aPtr );
+    bool ClassifyPoints( size_t aNPoints, const double* aU, const double* aV,
+        bool* aInside, double aTolerance = 0.0 );
+    bool ClearTrimCache( void );
 };
 
 #endif  // DLL_ENTITY_144_H
@@ -74,6 +74,39 @@ public:
      */
     void Cull( bool vicious = false );
 
+    /**
+     * Function Deduplicate
+     * merges identical Transformation Matrix (124), Color Definition (314)
+     * and NURBS Curve (126) entities; see IGES::Deduplicate()
+     *
+     * @param aStats = optional pointer to store a summary of the savings
+     */
+    bool Deduplicate( IGES_DEDUP_STATS* aStats = NULL );
+
+    /**
+     * Function GetEntitiesByType
+     * retrieves all entities of the given type; see IGES::GetEntitiesByType()
+     *
+     * @param aEntityType = the type of entity to retrieve
+     * @param aListSize [out] = the number of entities in the list
+     * @param aList [out] = the entities of the given type
+     */
+    bool GetEntitiesByType( IGES_ENTITY_TYPE aEntityType, size_t& aListSize,
+        IGES_ENTITY* const*& aList );
+
+    /**
+     * Function GetEntities
+     * retrieves all entities which satisfy the given query; the list
+     * remains valid until the next query or until entities are added
+     * or removed. See IGES::GetEntities()
+     *
+     * @param aQuery = criteria which the entities must satisfy
+     * @param aListSize [out] = the number of entities found
+     * @param aList [out] = the entities which satisfy the query
+     */
+    bool GetEntities( const IGES_QUERY& aQuery, size_t& aListSize,
+        IGES_ENTITY* const*& aList );
+
     /**
      * Function Clear
      * deletes all entities and reinitializes global data
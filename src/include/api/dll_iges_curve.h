@@ -51,6 +51,11 @@ public:
     bool GetStartPoint( MCAD_POINT& pt, bool xform = true );
     bool GetEndPoint( MCAD_POINT& pt, bool xform = true );
     int GetNSegments( void );
+    // calculate a polyline which approximates the curve to within the given
+    // chord tolerance; if aPointList returns with a non-NULL value then the
+    // user is responsible for its destruction via delete []
+    bool GetPolyline( MCAD_POINT*& aPointList, int& aNumPoints, double aTolerance = 0.0,
+                      bool xform = true );
 };
 
 #endif  // IGES_CURVE_H
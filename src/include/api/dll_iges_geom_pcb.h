@@ -73,6 +73,7 @@
 class IGES_CURVE;
 class IGES_ENTITY_126;
 class IGES_ENTITY_144;
+class IGES_ENTITY_408;
 class IGES_GEOM_PCB;
 class MCAD_SEGMENT;
 class IGES;
@@ -104,6 +105,30 @@ public:
                              IGES_ENTITY_144**& aSurfaceList,
                              int& nSurfaces, double aTopZ, double aBotZ );
 
+    /**
+     * Function GetVerticalSurface
+     * retrieves trimmed parametric surfaces representing vertical sides
+     * of the main outline and all cutouts and subfigure instances
+     * representing the vertical sides of all drill holes; the barrel of
+     * each unique drill size is a single shared Subfigure Definition.
+     *
+     * @param aModel is a pointer to the IGES object which shall own all entities created
+     * @param error is set to true if an error is encountered; extended error information
+     * is available via GetErrors().
+     * @param aSurface [in, out] is a dynamic array of surfaces to append to; the caller is
+     * responsible for deleting the array (but not its contents) when it is no longer required.
+     * @param aDrillList [in, out] is a dynamic array of drill instances to append to; the
+     * caller is responsible for deleting the array (but not its contents) when it is no
+     * longer required.
+     * @param aTopZ is the top height of the plane
+     * @param aBotZ is the bottom height of the plane
+     * @return true on success
+     */
+    bool GetVerticalSurface( IGES* aModel, bool& error,
+                             IGES_ENTITY_144**& aSurfaceList, int& nSurfaces,
+                             IGES_ENTITY_408**& aDrillList, int& nDrills,
+                             double aTopZ, double aBotZ );
+
     // retrieve the trimmed parametric surfaces representing the
     // top or bottom plane of the board
     // note: aSurfaceList [in/out] must be deleted [] by the caller
@@ -67,12 +67,14 @@
 #ifndef DLL_MCAD_OUTLINE_H
 #define DLL_MCAD_OUTLINE_H
 
+#include <cstddef>
 #include <libigesconf.h>
 #include <geom/mcad_elements.h>
 #include <api/dll_mcad_segment.h>
 
 class MCAD_SEGMENT;
 class MCAD_OUTLINE;
+struct MCAD_SIMPLIFY_STATS;
 
 class MCAD_API DLL_MCAD_OUTLINE
 {
@@ -176,6 +178,20 @@ public:
     bool SubOutline( MCAD_SEGMENT* aCircle, bool& error );
     bool SubOutline( DLL_MCAD_SEGMENT& aCircle, bool& error );
 
+    // Merge each circle in the list with this outline; on return the
+    // first aListSize entries of aCircleList hold the circles which
+    // were not merged, in their original order. The merged circles
+    // are destroyed. Returns true if at least one circle was merged.
+    bool AddOutlines( MCAD_SEGMENT** aCircleList, int& aListSize, bool& error );
+
+    // Subtract each circle in the list from this outline; circles which
+    // do not intersect the edge are added to the list of drill holes.
+    // On success aListSize is set to 0 and this object manages all of
+    // the circles; on error the first aListSize entries of aCircleList
+    // hold the circles which the caller must dispose of. Returns true
+    // if at least one circle intersected the edge.
+    bool SubOutlines( MCAD_SEGMENT** aCircleList, int& aListSize, bool& error );
+
     // Add the given cutout in preparation for exporting a solid model.
     // If the cutout is known to be non-overlapping then the 'overlaps'
     // flag may be set to 'false' to skip overlap tests. If the user
@@ -200,6 +216,10 @@ public:
     bool AddCutout( MCAD_SEGMENT* aCircle, bool overlaps, bool& error );
     bool AddCutout( DLL_MCAD_SEGMENT& aCircle, bool overlaps, bool& error );
 
+    // Merge runs of collinear lines and co-circular arcs within the
+    // outline and its cutouts; see MCAD_OUTLINE::Simplify()
+    bool Simplify( double aTolerance, bool& error, MCAD_SIMPLIFY_STATS* aStats = NULL );
+
 };
 
 #endif  // DLL_MCAD_OUTLINE_H
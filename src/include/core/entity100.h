@@ -87,6 +87,9 @@ public:
     // Inherited from IGES_CURVE
     virtual bool GetStartPoint( MCAD_POINT& pt, bool xform = true );
     virtual bool GetEndPoint( MCAD_POINT& pt, bool xform = true );
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
+    virtual bool AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+        bool xform = true );
 
     virtual int GetNSegments( void );
     virtual bool IsClosed( void );
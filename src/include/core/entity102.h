@@ -127,6 +127,9 @@ public:
     virtual IGES_CURVE* GetCurve( int index );
     virtual bool GetStartPoint( MCAD_POINT& pt, bool xform = true );
     virtual bool GetEndPoint( MCAD_POINT& pt, bool xform = true );
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
+    virtual bool AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+        bool xform = true );
     virtual int GetNSegments( void );
 };
 
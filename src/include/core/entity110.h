@@ -93,6 +93,9 @@ public:
     // methods required of parameterized curve entities
     virtual bool GetStartPoint( MCAD_POINT& pt, bool xform = true );
     virtual bool GetEndPoint( MCAD_POINT& pt, bool xform = true );
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
+    virtual bool AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+        bool xform = true );
     virtual int GetNSegments( void );
     virtual bool IsClosed( void );
     virtual int GetNCurves( void );
@@ -172,6 +172,42 @@ public:
         double TA;
         double endAngle;
     };
+
+    /**
+     * Function GetParameterRange
+     * retrieves the range of the surface parameters (t, theta) where
+     * t is the parameter of the generatrix and theta is the angle of
+     * rotation; returns true on success. Only generatrices of type
+     * 110 (t = 0 .. 1) and 126 (t = V0 .. V1) are supported.
+     *
+     * @param aT0 = variable to store the start parameter of the generatrix
+     * @param aT1 = variable to store the end parameter of the generatrix
+     * @param aTheta0 = variable to store the start angle
+     * @param aTheta1 = variable to store the end angle
+     */
+    bool GetParameterRange( double& aT0, double& aT1, double& aTheta0, double& aTheta1 );
+
+    /**
+     * Function Evaluate
+     * calculates the position and optionally the partial derivatives of
+     * the surface at each of the given (t, theta) parameter pairs and
+     * returns true on success. Only generatrices of type 110 and 126
+     * are supported.
+     *
+     * @param aNParams = number of parameter pairs
+     * @param aT = generatrix parameters
+     * @param aTheta = angles of rotation (radians)
+     * @param aPoint = array of aNParams points to hold the positions or NULL
+     * @param aDerivT = array of aNParams points to hold dS/dt or NULL
+     * @param aDerivTheta = array of aNParams points to hold dS/dtheta or NULL
+     * @param xform = true to express the results in model coordinates
+     */
+    bool Evaluate( size_t aNParams, const double* aT, const double* aTheta,
+        MCAD_POINT* aPoint, MCAD_POINT* aDerivT = NULL, MCAD_POINT* aDerivTheta = NULL,
+        bool xform = true );
+
+    // Inherited from IGES_ENTITY
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
 };
 
 #endif  // ENTITY_TEMP_H
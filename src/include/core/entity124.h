@@ -29,6 +29,7 @@
 #ifndef ENTITY_124_H
 #define ENTITY_124_H
 
+#include <atomic>
 #include <libigesconf.h>
 #include <geom/mcad_elements.h>
 #include <core/iges_entity.h>
@@ -81,6 +82,14 @@
  */
 class IGES_ENTITY_124 : public IGES_ENTITY
 {
+private:
+    // cached composition of this transform with all referenced transforms
+    MCAD_TRANSFORM m_worldT;
+    // content version of this entity at the time m_worldT was calculated;
+    // Touch() on any transform in the chain reaches this entity, so the
+    // cache is current while the 2 versions are equal
+    std::atomic<unsigned long> m_cacheVersion;
+
 protected:
 
     friend class IGES;
@@ -132,9 +141,22 @@ public:
      * returns the overall transformation matrix for this entity
      * which is equal to the local transform data multiplied by the
      * overall transformation matrix of the referenced transform
-     * entity if any.
+     * entity if any. The result is cached and is only recalculated
+     * when the content version of this entity changes; users who modify
+     * T directly must invoke Touch() afterwards. This function may be
+     * invoked concurrently provided that no transform in the chain is
+     * being modified at the same time.
      */
     MCAD_TRANSFORM GetTransformMatrix( void );
+
+    /**
+     * Function GetVersion
+     * returns a number which changes whenever the overall
+     * transformation matrix of this entity changes; users may compare
+     * values to decide whether data derived from the transform is stale.
+     * This is the content version of the entity (see Touch()).
+     */
+    unsigned long GetVersion( void );
 };
 
 #endif  // ENTITY_124_H
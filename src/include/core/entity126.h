@@ -33,13 +33,6 @@
 #include <core/iges_curve.h>
 #include <geom/mcad_elements.h>
 
-// XXX - NOTE: for now if we build with SISL support we can calculate
-// the first and last points on a NURBS curve. Since the aim is to
-// remove SISL from the core IGES code this should be deprecated in
-// favor of a libIGES implementation of the de Boors - Cox algorithm.
-#ifdef USE_SISL
-    #include <sisl.h>
-#endif
 
 
 // NOTE:
@@ -85,9 +78,6 @@ class IGES_ENTITY_126 : public IGES_CURVE
 private:
     // norm: if provided the normal to the plane will be returned
     bool hasUniquePlane( MCAD_POINT* norm = NULL );
-#ifdef USE_SISL
-    SISLCurve* scurve;
-#endif
 
 protected:
 
@@ -138,8 +128,29 @@ public:
     virtual IGES_CURVE* GetCurve( int index );
     virtual bool GetStartPoint( MCAD_POINT& pt, bool xform = true );
     virtual bool GetEndPoint( MCAD_POINT& pt, bool xform = true );
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
+    virtual bool AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+        bool xform = true );
     virtual int GetNSegments( void );
 
+    /**
+     * Function Evaluate
+     * calculates the position and optionally the first and second
+     * derivatives of the curve at each of the given parameters and
+     * returns true on success. Parameters outside the knot range
+     * are clamped to the range.
+     *
+     * @param aNParams = number of parameters
+     * @param aParams = parameters to evaluate
+     * @param aPoint = array of aNParams points to hold the positions or NULL
+     * @param aDeriv1 = array of aNParams points to hold the first derivatives or NULL
+     * @param aDeriv2 = array of aNParams points to hold the second derivatives or NULL
+     * @param xform = true if the results are to be transformed by the
+     *        Transformation Matrix of the curve
+     */
+    bool Evaluate( size_t aNParams, const double* aParams, MCAD_POINT* aPoint,
+        MCAD_POINT* aDeriv1 = NULL, MCAD_POINT* aDeriv2 = NULL, bool xform = true );
+
     /**
      * Function GetNURBSData
      * retrieves parameters from the internal SISLCurve
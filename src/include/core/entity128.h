@@ -208,6 +208,33 @@ public:
      */
     bool isPeriodic2( void );
 
+    /**
+     * Function EvaluateGrid
+     * calculates the position and optionally the partial derivatives
+     * and unit normal of the surface at each point of the grid formed
+     * by the given U and V parameters and returns true on success. The
+     * result for (aU[i], aV[j]) is stored at index j * aNU + i of each
+     * of the caller-provided arrays. Parameters outside the knot range
+     * are clamped to the range.
+     *
+     * @param aNU = number of U parameters
+     * @param aU = U parameters to evaluate
+     * @param aNV = number of V parameters
+     * @param aV = V parameters to evaluate
+     * @param aPoint = array of aNU * aNV points to hold the positions or NULL
+     * @param aDerivU = array of aNU * aNV points to hold dS/du or NULL
+     * @param aDerivV = array of aNU * aNV points to hold dS/dv or NULL
+     * @param aNormal = array of aNU * aNV points to hold the normals or NULL;
+     *        a zero vector is stored where the normal is undefined
+     * @param xform = true if the results are to be transformed by the
+     *        Transformation Matrix of the surface
+     */
+    bool EvaluateGrid( size_t aNU, const double* aU, size_t aNV, const double* aV,
+        MCAD_POINT* aPoint, MCAD_POINT* aDerivU = NULL, MCAD_POINT* aDerivV = NULL,
+        MCAD_POINT* aNormal = NULL, bool xform = true );
+
+    // Inherited from IGES_ENTITY
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
 };
 
 #endif  // ENTITY_128_H
@@ -31,6 +31,7 @@
 
 #include <libigesconf.h>
 #include <core/iges_entity.h>
+#include <geom/mcad_elements.h>
 
 // NOTE:
 // The associated parameter data are:
@@ -154,6 +155,26 @@ public:
      * @param aPtr = pointer to the Model Space Curve
      */
     bool SetCPTR( IGES_ENTITY* aPtr );
+
+    /**
+     * Function GetPolyline
+     * calculates a model space polyline which approximates the curve to
+     * within the given chord tolerance and returns true on success. The
+     * Model Space Curve (CPTR) is used if it exists; otherwise the Parameter
+     * Space Curve (BPTR) is mapped onto the underlying surface, which must
+     * be a NURBS surface (Entity 128). The points replace the contents of
+     * aPoints but its storage is retained.
+     *
+     * @param aPoints = buffer to hold the points of the polyline
+     * @param aTolerance = maximum distance between the curve and the polyline;
+     *        if not positive the minimum resolution of the model is used
+     * @param xform = set to true to apply any associated transforms to the points
+     */
+    bool GetPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance = 0.0,
+        bool xform = true );
+
+    // Inherited from IGES_ENTITY
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
 };
 
 #endif  // ENTITY_142_H
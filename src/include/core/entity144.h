@@ -31,6 +31,7 @@
 #include <core/iges_entity.h>
 
 class IGES_ENTITY_142;
+class IGES_TRIM_GRID;
 
 // NOTE:
 // The associated parameter data are:
@@ -77,6 +78,10 @@ protected:
     std::list<IGES_ENTITY_142*>PTI; // inner cutouts
     std::vector<IGES_ENTITY_142*>vPTI;  // convenience for passing data via DLL
 
+    IGES_TRIM_GRID* trimGrid;       // cached point classifier for the boundaries
+    double trimTol;                 // tolerance at which trimGrid was built
+    unsigned long trimVersion;      // content version at which trimGrid was built
+
     friend class IGES;
     virtual bool format( int &index );
     virtual bool rescale( double sf );
@@ -173,6 +178,35 @@ public:
      * @param aPtr = pointer to the inner boundary curve to be removed
      */
     bool DelPTI( IGES_ENTITY_142* aPtr );
+
+    /**
+     * Function ClassifyPoints
+     * determines whether each of a batch of (u, v) points lies within the
+     * trimmed region and returns true on success. The boundaries are
+     * discretized to the given tolerance and placed in a grid which is
+     * cached by this entity and reused while the tolerance and the
+     * content version of this entity are unchanged. The cache is not
+     * built in a thread safe manner; threads may only share an entity
+     * once it has classified points at the tolerance used.
+     *
+     * @param aNPoints = number of points
+     * @param aU = U parameters of the points
+     * @param aV = V parameters of the points
+     * @param aInside = array of aNPoints values to hold the results
+     * @param aTolerance = chord tolerance in parameter space; if not positive
+     *        the minimum resolution of the model is used
+     */
+    bool ClassifyPoints( size_t aNPoints, const double* aU, const double* aV,
+        bool* aInside, double aTolerance = 0.0 );
+
+    /**
+     * Function ClearTrimCache
+     * discards the cached point classifier of this surface
+     */
+    void ClearTrimCache( void );
+
+    // Inherited from IGES_ENTITY
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
 };
 
 #endif  // ENTITY_144_H
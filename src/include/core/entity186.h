@@ -80,7 +80,28 @@ public:
     virtual bool SetEntityForm( int aForm );
 
     // functions unique to E186
-    // XXX - TO BE IMPLEMENTED
+
+    /**
+     * Function GetShell
+     * retrieves the outer shell of the solid and its orientation
+     * flag and returns true if the solid has a shell.
+     *
+     * @param aShell = variable to store a pointer to the shell
+     * @param aOrientation = variable to store the orientation flag; true
+     *        if the normals of the faces point out of the solid
+     */
+    bool GetShell( IGES_ENTITY_514*& aShell, bool& aOrientation );
+
+    /**
+     * Function GetVoids
+     * retrieves the void shells of the solid and their orientation
+     * flags and returns true if the solid has at least one void.
+     *
+     * @param aVoids = list to hold the voids and their orientation flags
+     */
+    bool GetVoids( std::vector< std::pair<IGES_ENTITY_514*, bool> >& aVoids );
+
+    // XXX - TO BE IMPLEMENTED: functions to create a MSBO
 };
 
 #endif  // ENTITY_186_H
@@ -135,6 +135,9 @@ public:
      * @param aPtr = pointer of entity to be disassociated
      */
     bool DelDE( IGES_ENTITY* aPtr );
+
+    // Inherited from IGES_ENTITY
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
 };
 
 #endif  // ENTITY_308_H
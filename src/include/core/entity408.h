@@ -117,6 +117,9 @@ public:
      * establish correct Depth Level values as per the IGES specification.
      */
     int getDepthLevel( void );
+
+    // Inherited from IGES_ENTITY
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
 };
 
 #endif  // ENTITY_408_H
@@ -92,8 +92,12 @@ private:
     /// add a parent reference to a Vertex List and maintain a reference count
     bool addVertexList( IGES_ENTITY_502* aVertexList );
 
-    /// decrement a Vertex List's reference count and delete references if appropriate
-    bool delVertexList( IGES_ENTITY_502* aVertexList, bool aFlagAll );
+    /**
+     * decrement a Vertex List's reference count and delete references if appropriate;
+     * aFlagUnlink indicates that the Vertex List is being destroyed and must not
+     * be notified
+     */
+    bool delVertexList( IGES_ENTITY_502* aVertexList, bool aFlagAll, bool aFlagUnlink = false );
 
 protected:
 
@@ -141,9 +145,13 @@ public:
 
     /**
      * Function GetEdges
-     * returns a vector containing Edge data for convenient access by users
+     * retrieves a pointer to the list of Edge data for convenient access
+     * by users and returns true if the list is not empty.
+     *
+     * @param aListSize = variable to store the number of edges
+     * @param aEdgeList = variable to store a pointer to the list of edges
      */
-    bool GetEdges( size_t aListSize, EDGE_DATA const*& aEdgeList );
+    bool GetEdges( size_t& aListSize, EDGE_DATA const*& aEdgeList );
 
 
     /**
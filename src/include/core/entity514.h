@@ -97,10 +97,28 @@ public:
     virtual bool SetLineWeightNum( int aLineWeight );
 
     // functions unique to E514
-    // WARNING: TO BE IMPLEMENTED
-    // Access methods must be provided if a user ever wishes to create
-    // a MSBO
-    // XXX - TO BE IMPLEMENTED
+
+    /**
+     * Function GetFaces
+     * retrieves a pointer to the list of faces of the shell and their
+     * orientation flags and returns true if the shell has faces; a flag
+     * is true if the normal of the face agrees with the normal of its
+     * surface.
+     *
+     * @param aListSize = variable to store the number of faces
+     * @param aFaceList = variable to store a pointer to the list of faces
+     */
+    bool GetFaces( size_t& aListSize, std::pair<IGES_ENTITY_510*, bool> const*& aFaceList );
+
+    /**
+     * Function AddFace
+     * adds a face to the shell and returns true on success
+     *
+     * @param aFace = the face to add
+     * @param aOrientFlag = true if the normal of the face agrees with
+     *        the normal of its surface
+     */
+    bool AddFace( IGES_ENTITY_510* aFace, bool aOrientFlag );
 };
 
 #endif  // ENTITY_514_H
@@ -29,14 +29,18 @@
 #define IGES_H
 
 #include <list>
+#include <map>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include <fstream>
 #include <libigesconf.h>
 #include <core/iges_base.h>
+#include <geom/mcad_elements.h>
 #include <core/iges_entity.h>
 
 class IGES_ENTITY_308;
+class IGES_TESS_CACHE;
 
 /**
  * Struct IGES_GLOBAL
@@ -96,6 +100,10 @@ private:
     int                    nPDSecLines;     //< number of lines in the Parameter Data section
 
     std::vector<IGES_ENTITY*> entities;     //< all existing IGES entities and their data
+    std::map< int, std::vector<IGES_ENTITY*> > typeIndex;  //< entities grouped by type
+    std::unordered_set<IGES_ENTITY*> entitySet;  //< members of entities[] for constant time lookup
+    std::vector<IGES_ENTITY*> queryResult;  //< temp. result of GetEntities() for DLL access
+    IGES_TESS_CACHE* tessCache;             //< cache of curve discretizations and surface meshes
 
     // initialize internal data structures
     bool init(void);
@@ -113,6 +121,20 @@ private:
     // write out the GLOBAL SECTION
     bool writeGlobals( std::ofstream& file );
 
+    // hash the exact content of an entity considered by Deduplicate() and
+    // retrieve the 3 values and their tolerance which locate its grid cell
+    size_t dedupHash( IGES_ENTITY* aEntity, double aTol, double aKey[3], double& aKeyTol );
+    // return true if 2 entities of the same type have equal content
+    bool dedupMatch( IGES_ENTITY* aEntity0, IGES_ENTITY* aEntity1, double aTol );
+    // replace aParent's reference to aOld with a reference to aNew
+    bool rewireChild( IGES_ENTITY* aParent, IGES_ENTITY* aOld, IGES_ENTITY* aNew );
+
+    // add an entity to or remove an entity from the type index and membership set
+    void indexAdd( IGES_ENTITY* aEntity );
+    void indexDel( IGES_ENTITY* aEntity );
+    // rebuild the type index and membership set from the list of entities
+    void indexRebuild( void );
+
 public:
     IGES();
     ~IGES();
@@ -152,6 +174,87 @@ public:
      */
     void Cull( bool vicious = false );
 
+    /**
+     * Function Deduplicate
+     * merges Transformation Matrix (124), Color Definition (314) and
+     * NURBS Curve (126) entities whose content is identical to within
+     * globalData.minResolution. The parents of each duplicate are
+     * rewired to refer to a single surviving entity and the duplicate
+     * is deleted; entities carrying optional entities or comments are
+     * never merged. Entities are bucketed by a hash of their exact
+     * content and a grid cell of 3 representative values; the cells
+     * within tolerance of an entity are searched, so the cost is linear
+     * in the number of entities. Returns true on success.
+     *
+     * @param aStats = optional pointer to store a summary of the savings
+     */
+    bool Deduplicate( IGES_DEDUP_STATS* aStats = NULL );
+
+    /**
+     * Function GetWorldTransforms
+     * retrieves the overall transform applied to each entity in the
+     * model; the results are in the same order as the entity list and
+     * an entity without a Transformation Matrix (124) is given the
+     * identity transform. Each distinct transform chain is evaluated
+     * only once. Only the entity's own chain of transforms is applied;
+     * placements applied by referring entities such as Singular
+     * Subfigure Instances (408) are not included, so an entity which
+     * is reached along several paths still has a single entry and
+     * each placement must be obtained from the referring entities.
+     *
+     * @param aEntities = optional list to store the corresponding entities
+     * @param aTransforms = list to store the transforms
+     */
+    void GetWorldTransforms( std::vector<IGES_ENTITY*>* aEntities,
+        std::vector<MCAD_TRANSFORM>& aTransforms );
+
+    /**
+     * Function GetTessCache
+     * returns the cache of curve discretizations and surface meshes of
+     * this model; the cache is emptied when the model is cleared.
+     */
+    IGES_TESS_CACHE* GetTessCache( void );
+
+    /**
+     * Function GetEntitiesByType
+     * retrieves all entities of the given type; the list is maintained
+     * as entities are created and deleted so the cost does not depend on
+     * the number of entities of other types. The list is invalidated by
+     * any operation which adds or removes entities.
+     *
+     * @param aEntityType = the type of entity to retrieve
+     * @param aListSize [out] = the number of entities in the list
+     * @param aList [out] = the entities of the given type
+     * @return true if there is at least one entity of the given type
+     */
+    bool GetEntitiesByType( int aEntityType, size_t& aListSize, IGES_ENTITY* const*& aList );
+
+    /**
+     * Function GetEntities
+     * retrieves all entities which satisfy the given query; only the
+     * entities of the requested type are examined. The form, level,
+     * color, label and visibility are mutable attributes and are
+     * checked when the query is made.
+     *
+     * @param aQuery = criteria which the entities must satisfy
+     * @param aResult [out] = the entities which satisfy the query
+     * @return the number of entities found
+     */
+    size_t GetEntities( const IGES_QUERY& aQuery, std::vector<IGES_ENTITY*>& aResult );
+
+    /**
+     * Function GetEntities
+     * retrieves all entities which satisfy the given query; the list
+     * is held internally and remains valid until the next query or
+     * until entities are added or removed.
+     *
+     * @param aQuery = criteria which the entities must satisfy
+     * @param aListSize [out] = the number of entities found
+     * @param aList [out] = the entities which satisfy the query
+     * @return true if at least one entity was found
+     */
+    bool GetEntities( const IGES_QUERY& aQuery, size_t& aListSize, IGES_ENTITY* const*& aList );
+
     /**
      * Function Clear
      * deletes all entities and reinitializes global data
@@ -329,4 +329,55 @@ struct MCAD_API EDGE_DATA
     }
 };
 
+
+/**
+ * Struct IGES_DEDUP_STATS
+ * reports the savings achieved by IGES::Deduplicate()
+ */
+struct MCAD_API IGES_DEDUP_STATS
+{
+    size_t nTransforms;     // number of Transformation Matrix entities (124) merged
+    size_t nColors;         // number of Color Definition entities (314) merged
+    size_t nCurves;         // number of NURBS Curve entities (126) merged
+    size_t nEntitiesIn;     // number of entities before the pass
+    size_t nEntitiesOut;    // number of entities after the pass
+
+    IGES_DEDUP_STATS()
+    {
+        nTransforms = 0;
+        nColors = 0;
+        nCurves = 0;
+        nEntitiesIn = 0;
+        nEntitiesOut = 0;
+    }
+};
+
+/**
+ * Struct IGES_QUERY
+ * describes the entities to be retrieved by IGES::GetEntities();
+ * only entities of the given type are considered and any
+ * other criterion which is left at its default value is ignored.
+ */
+struct MCAD_API IGES_QUERY
+{
+    int entityType;             // entity type (IGES_ENTITY_TYPE) to retrieve
+    int form;                   // form number or -1 for any form
+    int level;                  // level number or -1 for any level
+    int color;                  // predefined color (IGES_COLOR) or -1 for any color
+    const void* colorEntity;    // Color Definition (314) entity or NULL for any color
+    const char* label;          // entity label or NULL for any label
+    int visible;                // 1 = visible, 0 = blanked, -1 for either
+
+    IGES_QUERY( int aEntityType = 0 )
+    {
+        entityType = aEntityType;
+        form = -1;
+        level = -1;
+        color = -1;
+        colorEntity = NULL;
+        label = NULL;
+        visible = -1;
+    }
+};
+
 #endif  // IGES_BASE_H
@@ -0,0 +1,191 @@
+/*
+ * file: iges_bvh.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: Bounding Volume Hierarchy over the bounds of IGES
+ * entities to support region, ray and proximity queries.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef IGES_BVH_H
+#define IGES_BVH_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+
+class IGES;
+class IGES_ENTITY;
+
+// NOTE:
+// The hierarchy holds pointers to the indexed entities and the world
+// space bounds of each entity at the time of the last Build() or Refit().
+// If an entity is modified the hierarchy must be refit; if an entity is
+// deleted the hierarchy must be rebuilt.
+//
+// All bounds are those reported by IGES_ENTITY::GetBounds() and are
+// conservative; queries therefore report the entities whose bounds
+// satisfy the query and the caller must apply any exact test required.
+//
+
+/**
+ * Class IGES_BVH
+ * is a Bounding Volume Hierarchy over the world space bounds of
+ * IGES entities.
+ */
+class IGES_BVH
+{
+private:
+    struct NODE
+    {
+        MCAD_BOX box;
+        int parent;     // index of the parent node or -1 for the root
+        int left;       // index of the left child or -1 for a leaf
+        int right;      // index of the right child or -1 for a leaf
+        int first;      // index of the first item of a leaf
+        int count;      // number of items in a leaf
+
+        NODE() : parent( -1 ), left( -1 ), right( -1 ), first( 0 ), count( 0 ) {}
+    };
+
+    std::vector<NODE> nodes;                // nodes; children follow their parent
+    std::vector<IGES_ENTITY*> items;        // indexed entities, in leaf order
+    std::vector<MCAD_BOX> boxes;            // bounds of the indexed entities
+    std::vector<int> itemLeaf;              // leaf node containing each item
+    std::map<IGES_ENTITY*, int> itemIndex;  // position of each entity within items
+
+    // compute the bounds of items[aFirst .. aLast) with up to aNThreads threads
+    void calcBounds( size_t aFirst, size_t aLast, int aNThreads );
+    // build the subtree for aPerm[aFirst .. aLast) rooted at node aNode
+    void buildNode( int aNode, int aParent, int aFirst, int aLast, int aNThreads,
+        std::vector<int>& aPerm, const std::vector<MCAD_POINT>& aCentroids );
+    // recalculate the box of a node from its children or items
+    void updateNode( int aNode );
+    // shared implementation of Build()
+    bool build( const std::vector<IGES_ENTITY*>& aEntities, int aNThreads );
+
+public:
+    IGES_BVH();
+    ~IGES_BVH();
+
+    /**
+     * Function Clear
+     * removes all entities from the hierarchy
+     */
+    void Clear( void );
+
+    /**
+     * Function Build
+     * builds the hierarchy over all independent geometric entities of
+     * the model including Singular Subfigure Instances (408); entities
+     * which are subordinate to another entity are represented by the
+     * bounds of their parent. Returns true if at least one entity was
+     * indexed.
+     *
+     * @param aModel = the model to index
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    bool Build( IGES* aModel, int aNThreads = 0 );
+
+    /**
+     * Function Build
+     * builds the hierarchy over the given entities; entities which
+     * report no bounds are ignored. Returns true if at least one entity
+     * was indexed.
+     *
+     * @param aEntities = the entities to index
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    bool Build( const std::vector<IGES_ENTITY*>& aEntities, int aNThreads = 0 );
+
+    /**
+     * Function Refit
+     * recalculates the bounds of the given entity and of the nodes which
+     * contain it; the structure of the hierarchy is not changed. Returns
+     * false if the entity is not in the hierarchy.
+     *
+     * @param aEntity = the entity which has been modified
+     */
+    bool Refit( IGES_ENTITY* aEntity );
+
+    /**
+     * Function Refit
+     * recalculates the bounds of all entities and nodes without
+     * changing the structure of the hierarchy.
+     *
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    void Refit( int aNThreads = 0 );
+
+    /**
+     * Function GetNEntities
+     * returns the number of entities in the hierarchy
+     */
+    size_t GetNEntities( void ) const;
+
+    /**
+     * Function GetBounds
+     * retrieves the bounds of all entities in the hierarchy and
+     * returns false if the hierarchy is empty.
+     *
+     * @param aBox = variable to store the bounds
+     */
+    bool GetBounds( MCAD_BOX& aBox ) const;
+
+    /**
+     * Function QueryBox
+     * retrieves all entities whose bounds intersect the given box and
+     * returns the number of entities found.
+     *
+     * @param aBox = the region of interest
+     * @param aResult = list to store the entities
+     */
+    size_t QueryBox( const MCAD_BOX& aBox, std::vector<IGES_ENTITY*>& aResult ) const;
+
+    /**
+     * Function QueryRay
+     * retrieves all entities whose bounds are hit by the given ray,
+     * ordered by the distance at which the ray enters the bounds, and
+     * returns the number of entities found.
+     *
+     * @param aOrigin = origin of the ray
+     * @param aDirection = direction of the ray
+     * @param aResult = list to store the entities
+     * @param aDistance = optional list to store the entry distance of each entity
+     *        in units of the length of aDirection
+     */
+    size_t QueryRay( const MCAD_POINT& aOrigin, const MCAD_POINT& aDirection,
+        std::vector<IGES_ENTITY*>& aResult, std::vector<double>* aDistance = NULL ) const;
+
+    /**
+     * Function QueryNearest
+     * returns the entity whose bounds are nearest to the given point
+     * or NULL if the hierarchy is empty.
+     *
+     * @param aPoint = the point of interest
+     * @param aDistance = optional variable to store the distance to the bounds
+     */
+    IGES_ENTITY* QueryNearest( const MCAD_POINT& aPoint, double* aDistance = NULL ) const;
+};
+
+#endif  // IGES_BVH_H
@@ -0,0 +1,202 @@
+/*
+ * file: iges_cache.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: bounded cache of curve discretizations and surface
+ * meshes keyed by entity, content version and tolerance.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef IGES_CACHE_H
+#define IGES_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+#include <core/iges_tess.h>
+
+class IGES_ENTITY;
+class IGES_CURVE;
+class IGES_ENTITY_144;
+
+// NOTE:
+// Entries are keyed by the address and content version of the entity
+// (IGES_ENTITY::GetContentVersion()), the version of its transform when
+// the result is in model coordinates and the tolerance bucket. Content
+// versions change whenever an entity or one of its children is modified
+// through a setter and are never reused, so stale entries are never
+// returned; they are simply not found again and age out of the cache.
+//
+// Tolerances are grouped into buckets of a quarter octave and results
+// are calculated at the smallest tolerance of the bucket, so a result
+// always satisfies the tolerance which was requested. When the memory
+// used exceeds the limit the least recently used entries are evicted.
+//
+// All functions may be called concurrently provided that no entity
+// involved is modified meanwhile; the keys depend on the transform
+// caches, which are guarded (see IGES_ENTITY_124), and on content
+// versions, which only change when an entity is modified. Results are
+// calculated without holding the lock so concurrent requests for an
+// entry which is not yet cached may each calculate it.
+
+/**
+ * Class IGES_TESS_CACHE
+ * is a bounded least-recently-used cache of curve discretizations
+ * and surface meshes.
+ */
+class IGES_TESS_CACHE
+{
+private:
+    struct KEY
+    {
+        IGES_ENTITY* entity;
+        unsigned long version;          // content version of the entity
+        unsigned long xformVersion;     // transform version or 0 for local coordinates
+        int kind;                       // polyline or mesh
+        int bucket0;                    // chord tolerance bucket
+        int bucket1;                    // angle tolerance bucket (meshes only)
+
+        bool operator<( const KEY& aKey ) const;
+    };
+
+    struct ENTRY
+    {
+        std::vector<MCAD_POINT> points; // polyline
+        IGES_MESH mesh;                 // mesh
+        size_t bytes;                   // approximate memory used
+        std::list<KEY>::iterator lru;   // position in the usage list
+    };
+
+    std::map<KEY, ENTRY> entries;
+    std::list<KEY> usage;               // keys, most recently used first
+    size_t memLimit;
+    size_t memUsed;
+    size_t nHits;
+    size_t nMisses;
+    size_t nEvictions;
+    mutable std::mutex lock;
+
+    // fill in the entity, versions and kind of a key
+    void makeKey( IGES_ENTITY* aEntity, bool aXform, int aKind, KEY& aKey );
+    // look up an entry and mark it as most recently used; must be called with the lock held
+    ENTRY* find( const KEY& aKey );
+    // store an entry and evict entries as required; must be called with the lock held
+    void insert( const KEY& aKey, ENTRY& aEntry );
+    // evict entries until the memory limit is respected; must be called with the lock held
+    void trim( void );
+
+public:
+    IGES_TESS_CACHE();
+    ~IGES_TESS_CACHE();
+
+    /**
+     * Function Clear
+     * removes all entries from the cache; the statistics are not reset.
+     */
+    void Clear( void );
+
+    /**
+     * Function Invalidate
+     * removes all entries which belong to the given entity
+     *
+     * @param aEntity = the entity whose entries are to be removed
+     */
+    void Invalidate( IGES_ENTITY* aEntity );
+
+    /**
+     * Function SetMemoryLimit
+     * sets the approximate maximum number of bytes used by the entries;
+     * entries are evicted immediately if the limit is exceeded.
+     *
+     * @param aBytes = memory limit (default 64 MiB)
+     */
+    void SetMemoryLimit( size_t aBytes );
+
+    /**
+     * Function GetMemoryLimit
+     * returns the memory limit in bytes
+     */
+    size_t GetMemoryLimit( void ) const;
+
+    /**
+     * Function GetMemoryUsed
+     * returns the approximate number of bytes used by the entries
+     */
+    size_t GetMemoryUsed( void ) const;
+
+    /**
+     * Function GetNEntries
+     * returns the number of entries in the cache
+     */
+    size_t GetNEntries( void ) const;
+
+    /**
+     * Function GetStats
+     * retrieves the number of lookups which were satisfied by the
+     * cache, the number which were not and the number of entries
+     * which were evicted to respect the memory limit.
+     *
+     * @param aHits = variable to store the number of hits
+     * @param aMisses = variable to store the number of misses
+     * @param aEvictions = variable to store the number of evictions
+     */
+    void GetStats( size_t& aHits, size_t& aMisses, size_t& aEvictions ) const;
+
+    /**
+     * Function ResetStats
+     * sets the hit, miss and eviction counts to 0
+     */
+    void ResetStats( void );
+
+    /**
+     * Function GetPolyline
+     * retrieves a polyline which approximates the given curve to within
+     * the given tolerance (see IGES_CURVE::GetPolyline()) and returns
+     * true on success.
+     *
+     * @param aCurve = the curve
+     * @param aPoints = buffer to hold the points of the polyline
+     * @param aTolerance = maximum distance between the curve and the polyline;
+     *        if not positive the minimum resolution of the model is used
+     * @param xform = set to true to apply any associated transforms to the points
+     */
+    bool GetPolyline( IGES_CURVE* aCurve, std::vector<MCAD_POINT>& aPoints,
+        double aTolerance = 0.0, bool xform = true );
+
+    /**
+     * Function GetMesh
+     * retrieves a mesh of the given surface calculated with the
+     * tolerances and settings of the given tessellator and returns
+     * true on success.
+     *
+     * @param aSurface = the surface
+     * @param aTessellator = tessellator whose settings are to be used
+     * @param aMesh = mesh to hold the result
+     */
+    bool GetMesh( IGES_ENTITY_144* aSurface, const IGES_TESSELLATOR& aTessellator,
+        IGES_MESH& aMesh );
+};
+
+#endif  // IGES_CACHE_H
@@ -44,6 +44,7 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <vector>
 
 #include <libigesconf.h>
 #include <core/iges_base.h>
@@ -75,6 +76,28 @@ public:
     virtual bool readDE(IGES_RECORD *aRecord, std::ifstream &aFile, int &aSequenceVar) = 0;
     virtual bool readPD(std::ifstream &aFile, int &aSequenceVar) = 0;
 
+    /**
+     * Function SubdividePolyline
+     * appends to aPoints a polyline approximating the curve defined by the
+     * given evaluation function between the first and last break parameters.
+     * Each interval between consecutive breaks is bisected until the points
+     * of the curve at the middle and quarters of the interval lie within
+     * aTolerance of the chord; the breaks must be close enough that the
+     * curve does not deviate from the chord between these samples. The
+     * point at the first break is always appended.
+     *
+     * @param aFunc = function to evaluate the curve at a given parameter;
+     *        it returns false on failure
+     * @param aData = curve data to pass to aFunc
+     * @param aNBreaks = number of break parameters (at least 2)
+     * @param aBreaks = break parameters in order of traversal
+     * @param aTolerance = maximum chord error
+     * @param aPoints = buffer to which the points are appended
+     */
+    typedef bool (*POLYLINE_EVAL)( void* aData, double aParam, MCAD_POINT& aPoint );
+    static bool SubdividePolyline( POLYLINE_EVAL aFunc, void* aData, size_t aNBreaks,
+        const double* aBreaks, double aTolerance, std::vector<MCAD_POINT>& aPoints );
+
 public:
     IGES_CURVE( IGES* aParent );
     virtual ~IGES_CURVE();
@@ -140,6 +163,35 @@ public:
     virtual int GetNSegments( void ) = 0;
 
 
+    /**
+     * Function GetPolyline
+     * calculates a polyline which approximates this curve to within
+     * the given chord tolerance and returns true on success. The points
+     * replace the contents of aPoints but its storage is retained so
+     * that a single buffer may be reused for many curves.
+     *
+     * @param aPoints = buffer to hold the points of the polyline
+     * @param aTolerance = maximum distance between the curve and the polyline;
+     *        if not positive the minimum resolution of the model is used
+     * @param xform = set to true to apply any associated transforms to the points
+     */
+    bool GetPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance = 0.0,
+        bool xform = true );
+
+
+    /**
+     * Function AddPolyline
+     * appends to aPoints a polyline which approximates this curve to
+     * within the given chord tolerance and returns true on success.
+     *
+     * @param aPoints = buffer to which the points are appended
+     * @param aTolerance = maximum distance between the curve and the polyline (> 0)
+     * @param xform = set to true to apply any associated transforms to the points
+     */
+    virtual bool AddPolyline( std::vector<MCAD_POINT>& aPoints, double aTolerance,
+        bool xform = true ) = 0;
+
+
     // members inherited from IGES_ENTITY
     virtual bool SetEntityForm( int aForm ) = 0;
 };
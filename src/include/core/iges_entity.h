@@ -39,6 +39,7 @@
 class IGES;             // Overarching data structure and parent to all entities
 struct IGES_RECORD;     // Partially parsed single line of data from an IGES file
 class IGES_ENTITY_124;  // Transform entity
+struct MCAD_BOX;        // Axis aligned bounding box
 
 /**
  * Class IGES_ENTITY
@@ -80,6 +81,8 @@ protected:
     std::list< bool* > m_validFlags;
     /// list of referring (parent) entities
     std::list<IGES_ENTITY*> refs;
+    /// changed whenever the data of this entity or of a child entity changes
+    unsigned long m_contentVersion;
     /// list of extra entities (optional PD entries)
     std::vector<IGES_ENTITY*> extras;
     std::list<int> iExtras;
@@ -191,6 +194,25 @@ public:
     IGES_ENTITY* getFirstParentRef( void );
 
 
+    /**
+     * Function hasParentRef
+     * returns true if aParentEntity is in this entity's Reference
+     * List; the list holds one entry per unique parent so this is
+     * far cheaper than searching the parent's list of children.
+     */
+    bool hasParentRef( IGES_ENTITY* aParentEntity );
+
+
+    /**
+     * Function touchAll
+     * assigns a single new content version to all of the given entities.
+     * When the list holds every entity of a model it also holds every
+     * entity which refers to them, so this has the effect of invoking
+     * Touch() on each entity at the cost of a single pass.
+     */
+    static void touchAll( std::vector<IGES_ENTITY*>& aList );
+
+
     /**
      * Function associate
      * associates DE pointers with other entities after reading all data;
@@ -601,6 +623,30 @@ public:
     bool GetTransform( IGES_ENTITY** aTransform );
 
 
+    /**
+     * Function GetContentVersion
+     * returns a number which changes whenever this entity or any of its
+     * child entities is modified through a setter; users may compare
+     * values to decide whether data derived from the entity is stale.
+     * Versions are drawn from a single counter so an entity created at
+     * the address of a deleted entity never repeats its version.
+     * Transforms are versioned separately (see IGES_ENTITY_124).
+     */
+    unsigned long GetContentVersion( void );
+
+
+    /**
+     * Function Touch
+     * assigns a new content version to this entity and to all entities
+     * which refer to it, directly or indirectly; each is visited once.
+     * This is invoked by the setters of libIGES; users who modify public
+     * data members directly, for example the coordinates of a Line (110)
+     * or the matrix of a Transformation Matrix (124), must invoke it
+     * themselves.
+     */
+    void Touch( void );
+
+
     /**
      * Function SetLabelAssoc
      * sets the ASSOCIATIVITY INSTANCE entity which refers to this entity
@@ -819,6 +865,19 @@ public:
      * @param aHierarchy = variable to store the hierarchy flag value
      */
     bool GetHierarchy( IGES_STAT_HIER& aHierarchy );
+
+
+    /**
+     * Function GetBounds
+     * retrieves an axis aligned box which encloses the geometry of
+     * this entity and returns true on success; entities which do not
+     * represent geometry return false. The box is not necessarily tight;
+     * for example the box of a NURBS entity is that of its control points.
+     *
+     * @param aBox = variable to store the bounding box
+     * @param xform = set to true to apply any associated transforms to the box
+     */
+    virtual bool GetBounds( MCAD_BOX& aBox, bool xform = true );
 };
 
 #endif  // IGES_ENTITY_H
@@ -0,0 +1,122 @@
+/*
+ * file: iges_meshout.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: streaming export of the tessellated surfaces of a
+ * model to binary STL, binary PLY and Wavefront OBJ files.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef IGES_MESHOUT_H
+#define IGES_MESHOUT_H
+
+#include <cstddef>
+#include <libigesconf.h>
+#include <core/iges_tess.h>
+
+class IGES;
+
+// NOTE:
+// Every placement of a surface in the world is written as a separate
+// part: the independent surfaces of the model followed by the surfaces
+// of each Subfigure Instance (408) in the order given by IGES_SCENE.
+// Parts are taken in order by the worker threads of a single batch and
+// each part is encoded by the worker which meshed it. A part is handed
+// to the output as soon as all preceding parts have been written, so
+// the output does not depend on the number of threads; a worker waits
+// while 'window' earlier parts await output so the memory used depends
+// on the window rather than on the size of the model. Surfaces placed more than once are meshed through
+// the tessellation cache of the model (IGES::GetTessCache()).
+//
+// Output is in model coordinates; binary files are little-endian.
+// + STL: the number of triangles is written once all parts are done
+// + PLY: vertices carry normals; faces are spooled to a temporary file
+//   and appended once all vertices are written
+// + OBJ: each part is a group named 'part<n>' with vertex normals
+
+enum IGES_MESH_FORMAT
+{
+    MESH_FORMAT_STL = 0,    // binary STL
+    MESH_FORMAT_PLY,        // binary PLY
+    MESH_FORMAT_OBJ         // Wavefront OBJ
+};
+
+/**
+ * Class IGES_MESH_WRITER
+ * writes the tessellated surfaces of a model to a mesh file
+ */
+class IGES_MESH_WRITER
+{
+private:
+    IGES_TESSELLATOR tess;
+    size_t window;
+    size_t nParts;
+    size_t nVertices;
+    size_t nTriangles;
+    size_t nFailed;
+
+public:
+    IGES_MESH_WRITER();
+    ~IGES_MESH_WRITER();
+
+    /**
+     * Function SetTolerance
+     * sets the tolerances of the meshes (see IGES_TESSELLATOR::SetTolerance())
+     *
+     * @param aChordTol = maximum distance between the mesh and the surface
+     * @param aAngleTol = maximum angle (radians) between the normals at the ends of an edge
+     */
+    void SetTolerance( double aChordTol, double aAngleTol );
+
+    /**
+     * Function SetWindow
+     * sets the maximum number of meshed parts which may await output
+     *
+     * @param aNParts = number of parts or 0 for 4 per thread (the default)
+     */
+    void SetWindow( size_t aNParts );
+
+    /**
+     * Function Write
+     * meshes all surfaces of the model and writes them to the given file;
+     * returns true on success. A placement of a surface which cannot be
+     * meshed is not written; a warning is printed and the number of such
+     * placements is reported by GetStats().
+     *
+     * @param aModel = the model to export
+     * @param aFileName = name of the output file
+     * @param aFormat = format of the output file
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    bool Write( IGES* aModel, const char* aFileName, IGES_MESH_FORMAT aFormat,
+        int aNThreads = 0 );
+
+    /**
+     * Function GetStats
+     * retrieves the number of parts, vertices and triangles written
+     * by the last call to Write() and the number of parts which were
+     * not written because the surface could not be meshed
+     */
+    void GetStats( size_t& aNParts, size_t& aNVertices, size_t& aNTriangles,
+        size_t& aNFailed ) const;
+};
+
+#endif  // IGES_MESHOUT_H
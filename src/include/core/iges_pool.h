@@ -0,0 +1,86 @@
+/*
+ * file: iges_pool.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: work stealing thread pool for running a batch of
+ * independent tasks of uneven cost.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef IGES_POOL_H
+#define IGES_POOL_H
+
+#include <cstddef>
+
+// NOTE:
+// The tasks of a batch are numbered 0 .. N-1 and are initially divided
+// into contiguous ranges, one per worker. Each worker takes tasks from
+// the front of its own range; a worker whose range is exhausted steals
+// the back half of the largest remaining range. Neighbouring tasks are
+// therefore usually run by the same worker while a few expensive tasks
+// cannot hold up the batch.
+//
+// The task function is called concurrently and must not modify shared
+// data without synchronization. The transform caches of the entities
+// involved are guarded and may be evaluated by the tasks.
+
+/**
+ * Class IGES_WORK_POOL
+ * runs batches of independent tasks on a set of worker threads.
+ */
+class IGES_WORK_POOL
+{
+public:
+    /**
+     * Typedef TASK
+     * is the function run for each task of a batch.
+     *
+     * @param aData = user data passed to Run()
+     * @param aTask = index of the task, 0 .. aNTasks - 1
+     * @param aWorker = index of the worker running the task, 0 .. N - 1 where
+     *        N is the value returned by GetNThreads(); this may be used to
+     *        select per-worker scratch data
+     */
+    typedef void (*TASK)( void* aData, size_t aTask, int aWorker );
+
+    /**
+     * Function GetNThreads
+     * returns the number of workers used for a requested number of threads.
+     *
+     * @param aNThreads = number of threads requested or 0 for the number of processors
+     */
+    static int GetNThreads( int aNThreads );
+
+    /**
+     * Function Run
+     * runs the given number of tasks and returns when all tasks are complete.
+     * If only one thread is requested or there is only one task the tasks
+     * are run on the calling thread.
+     *
+     * @param aNTasks = number of tasks
+     * @param aTask = function to run for each task
+     * @param aData = user data passed to each call of aTask
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    static void Run( size_t aNTasks, TASK aTask, void* aData, int aNThreads = 0 );
+};
+
+#endif  // IGES_POOL_H
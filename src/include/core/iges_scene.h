@@ -0,0 +1,163 @@
+/*
+ * file: iges_scene.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: instanced scene extracted from a model; each Subfigure
+ * Definition (308) is meshed once and every Singular Subfigure
+ * Instance (408) refers to those meshes with a world transform.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef IGES_SCENE_H
+#define IGES_SCENE_H
+
+#include <cstddef>
+#include <vector>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+#include <core/iges_tess.h>
+
+class IGES;
+class IGES_ENTITY_144;
+class IGES_ENTITY_308;
+class IGES_ENTITY_408;
+
+// NOTE:
+// The Trimmed Parametric Surfaces (144) listed directly by a Subfigure
+// Definition are meshed once in the coordinate space of the definition
+// (the transform of each surface is applied). Surfaces which are not
+// part of any definition are collected in a definition with a NULL
+// pointer which is instanced once with the identity transform.
+//
+// An instance record is produced for every path from an independent
+// Singular Subfigure Instance through nested instances to a definition
+// with at least one surface. The world transform of an instance of
+// definition D through the chain of instances I1 .. In is:
+//
+//   W = M(I1) * M(I2) * ... * M(In)
+//   M(I) = T(I) * [ S(I) * x + (X, Y, Z)(I) ]
+//
+// where T(I) is the Transformation Matrix (124) of the instance if any.
+
+/**
+ * Struct IGES_SCENE_DEF
+ * holds the surfaces and meshes of a single Subfigure Definition
+ */
+struct IGES_SCENE_DEF
+{
+    IGES_ENTITY_308* definition;            // the definition or NULL for independent surfaces
+    std::vector<IGES_ENTITY_144*> surfaces; // surfaces listed by the definition
+    std::vector<IGES_MESH> meshes;          // mesh of each surface; empty if it could not be meshed
+};
+
+/**
+ * Struct IGES_SCENE_INSTANCE
+ * places the meshes of a definition into the world
+ */
+struct IGES_SCENE_INSTANCE
+{
+    int definition;                     // index of the definition within the scene
+    MCAD_TRANSFORM transform;           // definition space to world space
+    IGES_ENTITY_408* instance;          // the outermost instance or NULL
+};
+
+/**
+ * Class IGES_SCENE
+ * is an instanced view of the surfaces of a model
+ */
+class IGES_SCENE
+{
+private:
+    std::vector<IGES_SCENE_DEF> defs;
+    std::vector<IGES_SCENE_INSTANCE> instances;
+
+public:
+    IGES_SCENE();
+    ~IGES_SCENE();
+
+    /**
+     * Function Clear
+     * removes all definitions and instances
+     */
+    void Clear( void );
+
+    /**
+     * Function Build
+     * records the surfaces of every Subfigure Definition of the model
+     * which is instanced and every surface which is not part of a
+     * definition, then records the instances; no meshes are produced.
+     * Returns true if at least one instance was found.
+     *
+     * @param aModel = the model
+     */
+    bool Build( IGES* aModel );
+
+    /**
+     * Function Build
+     * meshes every Subfigure Definition of the model which is instanced
+     * and every surface which is not part of a definition, then records
+     * the instances; returns true if at least one instance was found.
+     *
+     * @param aModel = the model
+     * @param aTessellator = tessellator whose settings are to be used; the
+     *        transform setting is ignored and surface transforms are applied
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    bool Build( IGES* aModel, const IGES_TESSELLATOR& aTessellator, int aNThreads = 0 );
+
+    /**
+     * Function GetNDefinitions
+     * returns the number of definitions in the scene
+     */
+    size_t GetNDefinitions( void ) const;
+
+    /**
+     * Function GetDefinition
+     * returns the definition with the given index or NULL if the
+     * index is out of range
+     */
+    const IGES_SCENE_DEF* GetDefinition( size_t aIndex ) const;
+
+    /**
+     * Function GetNInstances
+     * returns the number of instances in the scene
+     */
+    size_t GetNInstances( void ) const;
+
+    /**
+     * Function GetInstance
+     * returns the instance with the given index or NULL if the
+     * index is out of range
+     */
+    const IGES_SCENE_INSTANCE* GetInstance( size_t aIndex ) const;
+
+    /**
+     * Function GetNTriangles
+     * retrieves the number of triangles which were meshed and the
+     * number of triangles in the scene once all instances are expanded
+     *
+     * @param aMeshed = variable to store the number of meshed triangles
+     * @param aExpanded = variable to store the number of expanded triangles
+     */
+    void GetNTriangles( size_t& aMeshed, size_t& aExpanded ) const;
+};
+
+#endif  // IGES_SCENE_H
@@ -0,0 +1,216 @@
+/*
+ * file: iges_tess.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: tessellation of Trimmed Parametric Surfaces (Entity 144)
+ * into indexed triangle meshes.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef IGES_TESS_H
+#define IGES_TESS_H
+
+#include <cstddef>
+#include <vector>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+
+class IGES;
+class IGES_ENTITY_144;
+class IGES_ENTITY_186;
+class IGES_ENTITY_514;
+
+// NOTE:
+// A surface is meshed in its parameter space. The outer boundary and
+// the inner boundaries are taken from the parameter space curves (BPTR)
+// of the Curve on a Parametric Surface entities (142) of the trimmed
+// surface; if the outer boundary is the boundary of the untrimmed
+// surface (N1 = 0) the full parameter range of the surface is used.
+// The parameter space is scaled in U and V by the step sizes which
+// the curvature of the surface requires for the given tolerances; the
+// boundaries are subdivided to that step and the trimmed region is
+// triangulated and made Delaunay in the scaled space. Triangles are
+// then bisected along their longest (scaled) edges until:
+//
+//  + the surface point at the middle of every edge and at the centroid
+//    of every triangle lies within the chord tolerance of the triangle
+//  + the angle between the surface normals at the ends of every edge
+//    does not exceed the angle tolerance
+//
+// Bisection along the longest edge keeps the mesh conforming and the
+// triangle shapes bounded. Underlying surfaces of the following types
+// are supported:
+//
+//  + 128 (Rational B-Spline Surface)
+//  + 120 (Surface of Revolution) with a generatrix of type 110 or 126
+//
+// Vertices are shared within the mesh of a surface but not between
+// the meshes of adjacent surfaces.
+//
+// The faces (510) of a Shell (514) are meshed into a single mesh in which
+// adjacent faces share vertices. Each Edge (504) is discretized once in
+// model space to the chord tolerance and to the step required by the
+// faces on either side; the loops (508) of each face are mapped onto the
+// surface of the face by point inversion and the boundary segments are
+// never split during refinement, so the mesh of a shell is watertight
+// where its faces are meshed. Shell meshes are always in model coordinates
+// and carry no surface parameters; the triangles are oriented by the face
+// and shell orientation flags.
+
+/**
+ * Struct IGES_MESH
+ * is an indexed triangle mesh of a single trimmed surface
+ */
+struct IGES_MESH
+{
+    IGES_ENTITY_144* surface;           // the surface which was meshed
+    std::vector<MCAD_POINT> vertices;   // vertex positions
+    std::vector<MCAD_POINT> normals;    // unit surface normal at each vertex
+    std::vector<MCAD_POINT> params;     // (u, v, 0) surface parameters of each vertex
+    std::vector<int> indices;           // 3 vertex indices per triangle
+
+    IGES_MESH() : surface( NULL ) {}
+
+    void Clear( void )
+    {
+        surface = NULL;
+        vertices.clear();
+        normals.clear();
+        params.clear();
+        indices.clear();
+    }
+};
+
+
+/**
+ * Class IGES_TESSELLATOR
+ * creates triangle meshes of Trimmed Parametric Surfaces
+ */
+class IGES_TESSELLATOR
+{
+private:
+    double chordTol;
+    double angleTol;
+    bool   xform;
+
+public:
+    IGES_TESSELLATOR();
+    ~IGES_TESSELLATOR();
+
+    /**
+     * Function SetTolerance
+     * sets the tolerances of the mesh; invalid values are replaced
+     * by the defaults (0.01 model units, 15 degrees)
+     *
+     * @param aChordTol = maximum distance between the mesh and the surface
+     * @param aAngleTol = maximum angle (radians) between the normals at the ends of an edge
+     */
+    void SetTolerance( double aChordTol, double aAngleTol );
+
+    /**
+     * Function GetTolerance
+     * retrieves the tolerances of the mesh
+     *
+     * @param aChordTol = variable to store the chord tolerance
+     * @param aAngleTol = variable to store the angle tolerance (radians)
+     */
+    void GetTolerance( double& aChordTol, double& aAngleTol ) const;
+
+    /**
+     * Function SetTransform
+     * sets whether the vertices are expressed in model coordinates (true,
+     * the default) or in the defining space of the surface (false)
+     */
+    void SetTransform( bool aTransform );
+
+    /**
+     * Function GetTransform
+     * returns true if the vertices are expressed in model coordinates
+     */
+    bool GetTransform( void ) const;
+
+    /**
+     * Function Tessellate
+     * meshes a single surface and returns true on success; the function
+     * may be called concurrently for different surfaces provided that
+     * the model is not modified meanwhile.
+     *
+     * @param aSurface = the surface to mesh
+     * @param aMesh = mesh to hold the result
+     */
+    bool Tessellate( IGES_ENTITY_144* aSurface, IGES_MESH& aMesh ) const;
+
+    /**
+     * Function Tessellate
+     * meshes all Trimmed Parametric Surfaces of a model and returns
+     * the number of surfaces which were meshed successfully; surfaces
+     * which cannot be meshed yield an empty mesh.
+     *
+     * @param aModel = the model
+     * @param aMeshes = list to hold one mesh per surface
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    size_t Tessellate( IGES* aModel, std::vector<IGES_MESH>& aMeshes, int aNThreads = 0 ) const;
+
+    /**
+     * Function Tessellate
+     * meshes the given surfaces and returns the number of surfaces
+     * which were meshed successfully; aMeshes[i] holds the mesh of
+     * aSurfaces[i] and is empty if the surface could not be meshed.
+     *
+     * @param aSurfaces = the surfaces to mesh
+     * @param aMeshes = list to hold one mesh per surface
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    size_t Tessellate( const std::vector<IGES_ENTITY_144*>& aSurfaces,
+        std::vector<IGES_MESH>& aMeshes, int aNThreads = 0 ) const;
+
+    /**
+     * Function TessellateShell
+     * meshes the faces of a shell into a single indexed mesh and returns
+     * true if every face was meshed; faces which cannot be meshed are
+     * left out of the mesh. The faces are meshed concurrently.
+     *
+     * @param aShell = the shell to mesh
+     * @param aMesh = mesh to hold the result
+     * @param aOrientation = orientation flag of the shell; if false the
+     *        triangles are reversed
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    bool TessellateShell( IGES_ENTITY_514* aShell, IGES_MESH& aMesh,
+        bool aOrientation = true, int aNThreads = 0 ) const;
+
+    /**
+     * Function TessellateSolid
+     * meshes the shell and the voids of a Manifold Solid B-Rep Object
+     * and returns the number of shells which were meshed completely;
+     * aMeshes[0] holds the mesh of the shell and is followed by the
+     * meshes of the voids.
+     *
+     * @param aSolid = the solid to mesh
+     * @param aMeshes = list to hold one mesh per shell
+     * @param aNThreads = number of threads to use or 0 for the number of processors
+     */
+    size_t TessellateSolid( IGES_ENTITY_186* aSolid, std::vector<IGES_MESH>& aMeshes,
+        int aNThreads = 0 ) const;
+};
+
+#endif  // IGES_TESS_H
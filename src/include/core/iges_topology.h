@@ -0,0 +1,294 @@
+/*
+ * file: iges_topology.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: adjacency index of the vertices, edges, loops, faces
+ * and shells of Boundary Representation (B-REP) models.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef IGES_TOPOLOGY_H
+#define IGES_TOPOLOGY_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+
+class IGES;
+class IGES_ENTITY;
+class IGES_ENTITY_186;
+class IGES_ENTITY_502;
+class IGES_ENTITY_504;
+class IGES_ENTITY_508;
+class IGES_ENTITY_510;
+class IGES_ENTITY_514;
+
+// NOTE:
+// The index is a snapshot of the associated entities; it holds plain
+// pointers and must be rebuilt whenever the B-REP entities change.
+//
+// Every element is identified by a 0-based index into a flat array.
+// A vertex is an entry of a Vertex List (502) and an edge is an entry
+// of an Edge List (504); only the entries which are reachable from
+// the indexed shells are given an index. Shells, faces, loops and edge
+// uses are numbered in the order of the Closed Shell (514), Face (510)
+// and Loop (508) lists so that the faces of a shell, the loops of a
+// face and the uses of a loop are contiguous ranges. The edges at each
+// vertex and the uses of each edge are held in compressed row arrays.
+// The index is built in time linear in the number of edge uses and
+// logarithmic in the number of Vertex and Edge List entities.
+//
+// The direction of an edge use as seen from outside the shell is the
+// direction of the edge, reversed if the use is reversed and reversed
+// again if the face is reversed with respect to the shell. A closed
+// orientable shell uses every edge exactly twice in opposite directions;
+// a seam uses its edge twice within the same loop.
+
+/**
+ * Struct IGES_BREP_VERTEX
+ * is a vertex of the index
+ */
+struct IGES_BREP_VERTEX
+{
+    IGES_ENTITY_502* list;          // Vertex List entity
+    int index;                      // 1-based index within the list
+    MCAD_POINT point;
+};
+
+/**
+ * Struct IGES_BREP_EDGE
+ * is an edge of the index
+ */
+struct IGES_BREP_EDGE
+{
+    IGES_ENTITY_504* list;          // Edge List entity
+    int index;                      // 1-based index within the list
+    IGES_ENTITY* curve;             // model space curve
+    int vertex[2];                  // start and terminate vertices
+};
+
+/**
+ * Struct IGES_BREP_USE
+ * is an entry of a loop: a use of an edge or of a single vertex
+ */
+struct IGES_BREP_USE
+{
+    int edge;                       // the edge or -1 for a vertex
+    int vertex;                     // the vertex if 'edge' is -1, otherwise -1
+    int loop;                       // the loop containing the use
+    bool reverse;                   // the edge runs against the loop
+};
+
+/**
+ * Struct IGES_BREP_LOOP
+ * is a loop of the index
+ */
+struct IGES_BREP_LOOP
+{
+    IGES_ENTITY_508* loop;
+    int face;                       // the face bounded by the loop
+    int firstUse;
+    int nUses;
+};
+
+/**
+ * Struct IGES_BREP_FACE
+ * is a face of the index
+ */
+struct IGES_BREP_FACE
+{
+    IGES_ENTITY_510* face;
+    int shell;                      // the shell containing the face
+    bool reverse;                   // the face is reversed with respect to the outside of the shell
+    int firstLoop;                  // the first loop is the outer loop if the face has one
+    int nLoops;
+};
+
+/**
+ * Struct IGES_BREP_SHELL
+ * is a shell of the index
+ */
+struct IGES_BREP_SHELL
+{
+    IGES_ENTITY_514* shell;
+    IGES_ENTITY_186* solid;         // the solid using the shell or NULL
+    bool reverse;                   // the outside of the shell is opposite to its faces
+    int firstFace;
+    int nFaces;
+};
+
+/**
+ * Class IGES_BREP_TOPOLOGY
+ * is an adjacency index over one or more Closed Shells
+ */
+class IGES_BREP_TOPOLOGY
+{
+private:
+    std::vector<IGES_BREP_VERTEX> vertices;
+    std::vector<IGES_BREP_EDGE> edges;
+    std::vector<IGES_BREP_USE> uses;
+    std::vector<IGES_BREP_LOOP> loops;
+    std::vector<IGES_BREP_FACE> faces;
+    std::vector<IGES_BREP_SHELL> shells;
+
+    // compressed rows: the edges at vertex 'v' are
+    // vertEdges[vertStart[v] .. vertStart[v+1]) and similarly for uses
+    std::vector<int> vertStart;
+    std::vector<int> vertEdges;
+    std::vector<int> edgeStart;
+    std::vector<int> edgeUses;
+
+    // per-list bases used to map (list, index) to an element while building
+    std::map<IGES_ENTITY*, int> listBase;
+    std::vector<int> slots;
+
+    int getSlot( IGES_ENTITY* aList, int aListSize );
+    int getVertex( IGES_ENTITY_502* aList, int aIndex );
+    bool addShell( IGES_ENTITY_514* aShell, IGES_ENTITY_186* aSolid, bool aOrientation );
+    void buildRows( void );
+
+public:
+    IGES_BREP_TOPOLOGY();
+    ~IGES_BREP_TOPOLOGY();
+
+    /**
+     * Function Clear
+     * removes all elements from the index
+     */
+    void Clear( void );
+
+    /**
+     * Function Build
+     * indexes a single shell; returns true on success. If the shell is
+     * invalid the index is left empty.
+     *
+     * @param aShell = the shell
+     * @param aOrientation = false if the outside of the shell is opposite to its faces
+     */
+    bool Build( IGES_ENTITY_514* aShell, bool aOrientation = true );
+
+    /**
+     * Function Build
+     * indexes the shell and the voids of a solid; returns true on success
+     */
+    bool Build( IGES_ENTITY_186* aSolid );
+
+    /**
+     * Function Build
+     * indexes the shells of all solids (186) of a model followed by all
+     * Closed Shells which are not part of a solid; returns true if at
+     * least one shell was indexed. If any shell is invalid the index is
+     * left empty.
+     */
+    bool Build( IGES* aModel );
+
+    size_t GetNVertices( void ) const;
+    size_t GetNEdges( void ) const;
+    size_t GetNUses( void ) const;
+    size_t GetNLoops( void ) const;
+    size_t GetNFaces( void ) const;
+    size_t GetNShells( void ) const;
+
+    /**
+     * Functions GetVertex, GetEdge, GetUse, GetLoop, GetFace and GetShell
+     * return the element with the given index or NULL if the index is
+     * out of range
+     */
+    const IGES_BREP_VERTEX* GetVertex( int aIndex ) const;
+    const IGES_BREP_EDGE* GetEdge( int aIndex ) const;
+    const IGES_BREP_USE* GetUse( int aIndex ) const;
+    const IGES_BREP_LOOP* GetLoop( int aIndex ) const;
+    const IGES_BREP_FACE* GetFace( int aIndex ) const;
+    const IGES_BREP_SHELL* GetShell( int aIndex ) const;
+
+    /**
+     * Function FindFace
+     * returns the index of the given face or -1 if it is not indexed
+     */
+    int FindFace( IGES_ENTITY_510* aFace ) const;
+
+    /**
+     * Function GetVertexEdges
+     * retrieves the edges which start or terminate at a vertex; an edge
+     * which starts and terminates at the vertex is listed once
+     *
+     * @param aVertex = index of the vertex
+     * @param aListSize = variable to store the number of edges
+     * @param aEdgeList = variable to store a pointer to the edge indices
+     */
+    bool GetVertexEdges( int aVertex, size_t& aListSize, int const*& aEdgeList ) const;
+
+    /**
+     * Function GetEdgeUses
+     * retrieves the uses of an edge by the loops of the index
+     */
+    bool GetEdgeUses( int aEdge, size_t& aListSize, int const*& aUseList ) const;
+
+    /**
+     * Function GetEdgeFaces
+     * retrieves the faces which use an edge; a face which uses the edge
+     * more than once (a seam) is listed once
+     */
+    bool GetEdgeFaces( int aEdge, std::vector<int>& aFaceList ) const;
+
+    /**
+     * Function GetFaceNeighbors
+     * retrieves the faces other than the given face which share an edge
+     * with it
+     */
+    bool GetFaceNeighbors( int aFace, std::vector<int>& aFaceList ) const;
+
+    /**
+     * Function IsUseReversed
+     * returns true if the use runs against its edge as seen from
+     * outside the shell
+     */
+    bool IsUseReversed( int aUse ) const;
+
+    /**
+     * Function GetOpenEdges
+     * retrieves the edges which are used only once; returns the number of edges
+     */
+    size_t GetOpenEdges( std::vector<int>& aEdgeList ) const;
+
+    /**
+     * Function GetNonManifoldEdges
+     * retrieves the edges which are used more than twice; returns the number of edges
+     */
+    size_t GetNonManifoldEdges( std::vector<int>& aEdgeList ) const;
+
+    /**
+     * Function GetMisorientedEdges
+     * retrieves the edges which are used twice in the same direction as
+     * seen from outside the shell; returns the number of edges
+     */
+    size_t GetMisorientedEdges( std::vector<int>& aEdgeList ) const;
+
+    /**
+     * Function IsManifold
+     * returns true if every edge is used exactly twice in opposite directions
+     */
+    bool IsManifold( void ) const;
+};
+
+#endif  // IGES_TOPOLOGY_H
@@ -0,0 +1,140 @@
+/*
+ * file: iges_trim.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: uniform grid over the parameter space boundaries of a
+ * Trimmed Parametric Surface (144) to classify (u, v) points as inside
+ * or outside of the trimmed region.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef IGES_TRIM_H
+#define IGES_TRIM_H
+
+#include <cstddef>
+#include <vector>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+
+class IGES_ENTITY_144;
+
+// NOTE:
+// The boundaries are discretized to polylines and the segments are
+// distributed over a uniform grid with roughly as many cells as there
+// are segments. The state (inside or outside) of the center of every
+// cell is calculated when the grid is built; a point is classified by
+// counting the crossings of the path from the center of its cell to the
+// point with the few segments within that cell, so the time taken per
+// point does not depend on the total number of segments.
+//
+// The even-odd rule is used so the orientation of the loops does not
+// matter. Points which lie on a boundary, to within the tolerance of
+// the discretization, may be classified either way.
+
+/**
+ * Class IGES_TRIM_GRID
+ * is a uniform grid over the parameter space boundaries of
+ * a trimmed surface.
+ */
+class IGES_TRIM_GRID
+{
+private:
+    std::vector<MCAD_POINT> segs;   // segment endpoints, 2 per segment
+    std::vector<int> cellStart;     // first entry of each cell within cellSegs
+    std::vector<int> cellSegs;      // segment indices of all cells
+    std::vector<char> cellState;    // state of the center of each cell
+    double minU;
+    double minV;
+    double cellU;                   // cell size in U
+    double cellV;                   // cell size in V
+    int nU;                         // number of cells in U
+    int nV;                         // number of cells in V
+    bool hasOuter;                  // true if an outer boundary exists
+
+    bool classify( double aU, double aV ) const;
+
+public:
+    IGES_TRIM_GRID();
+    ~IGES_TRIM_GRID();
+
+    /**
+     * Function Clear
+     * removes all boundaries from the grid; every point is then
+     * classified as inside.
+     */
+    void Clear( void );
+
+    /**
+     * Function Build
+     * builds the grid from closed polylines and returns true on
+     * success. The loops need not be explicitly closed.
+     *
+     * @param aLoops = boundary loops as (u, v) points; z is ignored
+     * @param aHasOuter = true if the first loop is an outer boundary;
+     *        if false all loops are treated as inner boundaries and
+     *        points outside of every loop are inside the trimmed region
+     */
+    bool Build( const std::vector< std::vector<MCAD_POINT> >& aLoops, bool aHasOuter );
+
+    /**
+     * Function Build
+     * builds the grid from the parameter space curves of the boundaries
+     * of the given trimmed surface and returns true on success. If the
+     * outer boundary is the boundary of the untrimmed surface (N1 = 0)
+     * the parameter range of the surface is used when it is known
+     * (types 120 and 128); otherwise only the inner boundaries are
+     * considered.
+     *
+     * @param aSurface = the trimmed surface
+     * @param aTolerance = chord tolerance of the discretization in parameter space
+     */
+    bool Build( IGES_ENTITY_144* aSurface, double aTolerance );
+
+    /**
+     * Function IsInside
+     * returns true if the given point lies within the trimmed region
+     *
+     * @param aU = U parameter of the point
+     * @param aV = V parameter of the point
+     */
+    bool IsInside( double aU, double aV ) const;
+
+    /**
+     * Function Classify
+     * classifies a batch of points and returns the number of points
+     * which lie within the trimmed region.
+     *
+     * @param aNPoints = number of points
+     * @param aU = U parameters of the points
+     * @param aV = V parameters of the points
+     * @param aInside = array of aNPoints values to hold the results
+     */
+    size_t Classify( size_t aNPoints, const double* aU, const double* aV,
+        bool* aInside ) const;
+
+    /**
+     * Function GetNSegments
+     * returns the number of boundary segments in the grid
+     */
+    size_t GetNSegments( void ) const;
+};
+
+#endif  // IGES_TRIM_H
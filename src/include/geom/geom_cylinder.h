@@ -45,6 +45,13 @@ private:
     double radius;
     double angles[6];       // start/end angles for arc1, arc2, arc3
 
+    // linear NURBS bounds of each sub-arc in parameter space
+    // (4 per sub-arc) as calculated by CalcBounds()
+    int nbounds;            // number of bounds calculated; 0 if not calculated
+    bool rbounds;           // true if the bounds are for the reversed surface
+    double bknots[12][4];   // knots of each bound
+    double bcoeffs[12][6];  // control points of each bound
+
     void init( void );
     void clear( void );
 
@@ -54,6 +61,21 @@ public:
 
     bool SetParams( MCAD_POINT center, MCAD_POINT start, MCAD_POINT end );
 
+    /**
+     * Function CalcBounds
+     * calculates the NURBS data of the bounds of the surface in
+     * parameter space. The calculation does not involve an IGES
+     * object so the bounds of many cylinders may be calculated
+     * concurrently in advance of Instantiate(); Instantiate()
+     * calculates the bounds if they have not been calculated
+     * for the given orientation.
+     *
+     * @param aReverse is the orientation which shall be passed
+     * to Instantiate()
+     * @return true if the bounds were successfully calculated
+     */
+    bool CalcBounds( bool aReverse );
+
     /**
      * Function Instantiate
      * uses current parameters to create IGES entities which represent
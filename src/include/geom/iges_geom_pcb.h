@@ -62,6 +62,19 @@
  *   the main ouline will not be split into separate bodies but in such
  *   circumstances the user must work around the 2-point restriction by
  *   dividing the offending cutout into at least 2 separate bodies.
+ *
+ * + GetVerticalSurface: drill holes may optionally be rendered as instances
+ *   of shared barrels; the barrel of each unique drill radius is created
+ *   once as a Subfigure Definition (Type 308) centered on the origin and
+ *   each drill hole is a Singular Subfigure Instance (Type 408) translated
+ *   to the center of the hole. The caller is responsible for placing the
+ *   instances within the model, for example within the Subfigure Definition
+ *   of the board. The trimming loops of the drill holes on the top and
+ *   bottom planes are not affected.
+ *
+ * + GetVerticalSurface, GetTrimmedPlane: the outline and cutouts are first
+ *   simplified with MCAD_OUTLINE::Simplify() so that runs of collinear lines
+ *   or co-circular arcs produce a single surface and trimming curve.
  */
 
 #ifndef IGES_GEOM_OUTLINE_H
@@ -75,6 +88,7 @@
 class IGES_CURVE;
 class IGES_ENTITY_126;
 class IGES_ENTITY_144;
+class IGES_ENTITY_408;
 
 class IGES_GEOM_PCB : public MCAD_OUTLINE
 {
@@ -88,17 +102,12 @@ private:
     bool getCurveLine( IGES* aModel, std::list<IGES_CURVE*>& aCurves,
                        double zHeight, MCAD_SEGMENT* aSegment );
 
-    // routines to create curves suitable as subordinates to the BPTR of
-    // a trimmed parametric surface
-    bool copCircle( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
-                    double offX, double offY, double aScale,
-                    double zHeight, MCAD_SEGMENT* aSegment, bool aReverse );
-    bool copArc( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
-                 double offX, double offY, double aScale,
-                 double zHeight, MCAD_SEGMENT* aSegment, bool aReverse );
-    bool copLine( IGES* aModel, std::list<IGES_ENTITY_126*>& aCurves,
-                  double offX, double offY, double aScale,
-                  double zHeight, MCAD_SEGMENT* aSegment, bool aReverse );
+    // create the vertical sides; drill holes are rendered as instances
+    // if aDrills is not NULL
+    bool getVerticalSurface( IGES* aModel, bool& error,
+                             std::vector<IGES_ENTITY_144*>& aSurface,
+                             std::vector<IGES_ENTITY_408*>* aDrills,
+                             double aTopZ, double aBotZ, int aNThreads );
 
 protected:
    // create a Trimmed Parametric Surface entity with only the PTS member instantiated
@@ -119,17 +128,43 @@ public:
      * @param aSurface [in, out] is a list of surfaces to append to
      * @param aTopZ is the top height of the plane
      * @param aBotZ is the bottom height of the plane
+     * @param aNThreads is the number of threads used to calculate the NURBS
+     * data of the surfaces or 0 for the number of processors; the entities
+     * are created in the same order regardless of the number of threads
+     * @return true on success
+     */
+    bool GetVerticalSurface( IGES* aModel, bool& error,
+                             std::vector<IGES_ENTITY_144*>& aSurface,
+                             double aTopZ, double aBotZ, int aNThreads = 0 );
+
+    /**
+     * Function GetVerticalSurface
+     * retrieves trimmed parametric surfaces representing vertical sides
+     * of the main outline and all cutouts and subfigure instances
+     * representing the vertical sides of all drill holes
+     *
+     * @param aModel is a pointer to the IGES object which shall own all entities created
+     * @param error is set to true if an error is encountered; extended error information
+     * is available via GetErrors().
+     * @param aSurface [in, out] is a list of surfaces to append to
+     * @param aDrills [in, out] is a list of drill hole instances to append to
+     * @param aTopZ is the top height of the plane
+     * @param aBotZ is the bottom height of the plane
+     * @param aNThreads is the number of threads used to calculate the NURBS
+     * data of the surfaces or 0 for the number of processors
      * @return true on success
      */
     bool GetVerticalSurface( IGES* aModel, bool& error,
                              std::vector<IGES_ENTITY_144*>& aSurface,
-                             double aTopZ, double aBotZ );
+                             std::vector<IGES_ENTITY_408*>& aDrills,
+                             double aTopZ, double aBotZ, int aNThreads = 0 );
 
     // retrieve the trimmed parametric surfaces representing the
-    // top or bottom plane of the board
+    // top or bottom plane of the board; the NURBS data of the trimming
+    // curves is calculated by aNThreads threads (0 = number of processors)
     bool GetTrimmedPlane( IGES* aModel, bool& error,
                           std::vector<IGES_ENTITY_144*>& aSurface,
-                          double aHeight, bool aReverse );
+                          double aHeight, bool aReverse, int aNThreads = 0 );
 
     // retrieve the representation of the curve as IGES
     // 2D primitives (Entity 100 or Entity 110). An arc
@@ -0,0 +1,119 @@
+/*
+ * file: mcad_boolean.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: Boolean operations on any number of closed outlines
+ * consisting of lines, arcs and circles.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * NOTES:
+ * + The result of an operation is the union of all added regions less
+ *   the union of all subtracted regions. Unlike MCAD_OUTLINE::AddOutline()
+ *   and SubOutline() the operands may intersect at any number of points,
+ *   may overlap or touch each other and may be given in any order; the
+ *   result may consist of any number of separate bodies, each with its
+ *   own cutouts and drill holes.
+ *
+ * + The operation proceeds in 6 steps:
+ *   1. the segments of all operands are collected and the pairs of
+ *      segments from different operands whose bounding boxes overlap
+ *      are found by sweeping a line across the segments in X;
+ *   2. the intersections of each pair are calculated and each segment
+ *      is split at all of its intersections;
+ *   3. each piece is tested by sampling the region a short distance to
+ *      either side of its midpoint; a piece lies on the boundary of the
+ *      result if exactly one side is inside the result, and it is
+ *      oriented to keep the material on its left. Coincident pieces
+ *      from different operands are merged;
+ *   4. the pieces are joined at their endpoints into closed loops,
+ *      taking the sharpest right turn where several pieces meet;
+ *   5. counterclockwise loops are the outer edges of the bodies and each
+ *      clockwise loop is a cutout of the smallest body enclosing it; a
+ *      cutout which is a complete circle becomes a drill hole.
+ *   6. runs of collinear lines and co-circular arcs which remain where
+ *      the edges were split are merged by MCAD_OUTLINE::Simplify().
+ *
+ * + The operands are not modified and remain the property of the caller;
+ *   they must remain valid until Execute() returns. The cutouts and drill
+ *   holes of an added outline are subtracted; only the main loop of a
+ *   subtracted outline is used.
+ *
+ * + Operands must not intersect themselves. Features narrower than about
+ *   1e-6 of the size of the model may be misclassified.
+ */
+
+#ifndef MCAD_BOOLEAN_H
+#define MCAD_BOOLEAN_H
+
+#include <list>
+#include <string>
+#include <vector>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+#include <geom/mcad_outline.h>
+
+class MCAD_SEGMENT;
+
+class MCAD_BOOLEAN
+{
+private:
+    std::list< std::string > errors;
+
+    // operands in the order they were given
+    std::vector< MCAD_OUTLINE* > mOutlines;
+    std::vector< bool > mOutlineSub;
+    std::vector< MCAD_SEGMENT* > mCircles;
+    std::vector< bool > mCircleSub;
+
+public:
+    MCAD_BOOLEAN();
+    ~MCAD_BOOLEAN();
+
+    // remove all operands
+    void Clear( void );
+
+    // Retrieve the error stack
+    const std::list< std::string >* GetErrors( void );
+
+    // Clear the error stack
+    void ClearErrors( void );
+
+    // Add a closed outline to the operation; the region within the
+    // outline is removed if aSubtract is 'true', otherwise it is added.
+    bool AddOperand( MCAD_OUTLINE* aOutline, bool aSubtract, bool& error );
+
+    // Add a circle to the operation; the region within the circle
+    // is removed if aSubtract is 'true', otherwise it is added.
+    bool AddOperand( MCAD_SEGMENT* aCircle, bool aSubtract, bool& error );
+
+    // Calculate the result and append one new outline of the given
+    // type for each body of the result to aResult; the caller is
+    // responsible for the disposal of the new outlines. Returns
+    // 'false' and sets 'error' if the result could not be calculated,
+    // in which case aResult is not changed. The result is empty if
+    // nothing remains of the added regions.
+    bool Execute( std::list<MCAD_OUTLINE*>& aResult, bool& error,
+                  MCAD_OUTLINE_TYPE aType = MCAD_OT_BASE );
+};
+
+#endif  // MCAD_BOOLEAN_H
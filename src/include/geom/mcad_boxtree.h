@@ -0,0 +1,99 @@
+/*
+ * file: mcad_boxtree.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: dynamic tree of axis aligned bounding boxes used
+ * to find the outlines and holes which may overlap a region.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+/*
+ * NOTES:
+ * + Each leaf holds the bounding box (X, Y only) of an item and a key
+ *   chosen by the user; internal nodes hold the union of the boxes of
+ *   their children. A new leaf is placed beside the node which least
+ *   increases the perimeter of the tree and the tree is rebalanced by
+ *   rotations on the way back to the root so that its height remains
+ *   O(log n).
+ * + Leaf IDs remain valid until the leaf is removed; the ID of a
+ *   removed leaf may be reused by a later insertion.
+ */
+
+#ifndef MCAD_BOXTREE_H
+#define MCAD_BOXTREE_H
+
+#include <cstddef>
+#include <vector>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+
+class MCAD_BOXTREE
+{
+private:
+    struct NODE
+    {
+        MCAD_POINT bb0;     // bottom left
+        MCAD_POINT bb1;     // top right
+        int parent;         // parent node or the next free node
+        int child1;         // -1 for a leaf
+        int child2;
+        int height;         // 0 for a leaf, -1 for a free node
+        size_t key;
+    };
+
+    std::vector<NODE> mNodes;
+    int mRoot;
+    int mFree;      // first free node
+    size_t mLeaves;
+
+    int allocNode( void );
+    void freeNode( int aNode );
+    void insertLeaf( int aLeaf );
+    void removeLeaf( int aLeaf );
+    void refit( int aNode );
+    int balance( int aNode );
+
+public:
+    MCAD_BOXTREE();
+    ~MCAD_BOXTREE();
+
+    // remove all items
+    void Clear( void );
+
+    // number of items in the tree
+    size_t Size( void ) const;
+
+    // add an item with the bounding box (bb0, bb1); returns the leaf ID
+    int Insert( const MCAD_POINT& bb0, const MCAD_POINT& bb1, size_t aKey );
+
+    // remove the item with the given leaf ID; returns false if the ID is invalid
+    bool Remove( int aLeaf );
+
+    // change the bounding box of an item; returns false if the ID is invalid
+    bool Update( int aLeaf, const MCAD_POINT& bb0, const MCAD_POINT& bb1 );
+
+    // retrieve the keys of all items whose bounding boxes overlap (bb0, bb1);
+    // keys are appended to aKeyList in no particular order
+    void Query( const MCAD_POINT& bb0, const MCAD_POINT& bb1,
+                std::vector<size_t>& aKeyList ) const;
+};
+
+#endif  // MCAD_BOXTREE_H
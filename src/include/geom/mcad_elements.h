@@ -131,4 +131,28 @@ MCAD_API MCAD_TRANSFORM operator*(const MCAD_TRANSFORM& m, const MCAD_TRANSFORM&
 // TX * V (perform a transform + offset)
 MCAD_API MCAD_POINT operator*(const MCAD_TRANSFORM& m, const MCAD_POINT& v);
 
+// axis aligned bounding box; a default box is empty (lo > hi)
+struct MCAD_API MCAD_BOX
+{
+    MCAD_POINT lo;  // minimum X, Y, Z
+    MCAD_POINT hi;  // maximum X, Y, Z
+
+    MCAD_BOX();
+
+    void Clear( void );
+    bool IsEmpty( void ) const;
+    // grow the box to include the given point or box
+    void Add( const MCAD_POINT& p );
+    void Add( const MCAD_BOX& b );
+    bool Intersects( const MCAD_BOX& b ) const;
+    MCAD_POINT Center( void ) const;
+    // squared distance from the point to the box; 0 if the point is inside
+    double Distance2( const MCAD_POINT& p ) const;
+    // test a ray (origin and reciprocal of the direction) against the box;
+    // on a hit aT holds the parameter at which the ray enters the box
+    bool RayHit( const MCAD_POINT& aOrigin, const MCAD_POINT& aInvDir, double& aT ) const;
+};
+// TX * BOX (bounds of the transformed box)
+MCAD_API MCAD_BOX operator*(const MCAD_TRANSFORM& m, const MCAD_BOX& b);
+
 #endif  // MCAD_ELEMENTS_H
@@ -0,0 +1,156 @@
+/*
+ * file: mcad_nurbs.h
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description: self-contained evaluation of B-Spline and rational
+ * B-Spline (NURBS) curves and surfaces
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef MCAD_NURBS_H
+#define MCAD_NURBS_H
+
+#include <cstddef>
+#include <libigesconf.h>
+#include <geom/mcad_elements.h>
+
+// NOTE:
+// The evaluators do not depend on SISL. Control points are stored as
+// in the IGES Parameter Data: (x, y, z) for polynomial splines and
+// (x, y, z, w) for rational splines. The sum of the control points
+// weighted by the basis functions is computed on homogeneous
+// (wx, wy, wz, w) points; this maps onto a single AVX register or
+// a pair of SSE2 registers and the vector kernels are selected at
+// compile time with a scalar fallback for other targets.
+//
+// Parameters outside the knot range [knot[order-1], knot[nCoeffs]]
+// are clamped to the range.
+
+/**
+ * Function FindKnotSpan
+ * returns the index 'i' of the knot span such that knot[i] <= u < knot[i+1];
+ * at the end of the parameter range the last non-empty span is returned.
+ *
+ * @param aOrder = spline order (degree + 1)
+ * @param aNCoeffs = number of control points
+ * @param aKnots = knot vector with aNCoeffs + aOrder values
+ * @param aParam = parameter value (clamped to the knot range)
+ */
+MCAD_API int FindKnotSpan( int aOrder, int aNCoeffs, const double* aKnots, double aParam );
+
+/**
+ * Function CalcBasisDerivs
+ * calculates the aOrder non-zero basis functions in the given knot span
+ * and their derivatives up to aNDerivs.
+ *
+ * @param aOrder = spline order (degree + 1)
+ * @param aKnots = knot vector
+ * @param aSpan = knot span as returned by FindKnotSpan()
+ * @param aParam = parameter value
+ * @param aNDerivs = highest derivative required (0 .. 2)
+ * @param aResult = array of (aNDerivs + 1) * aOrder values to hold the
+ *        results; derivative 'k' of basis function 'j' is stored at
+ *        aResult[k * aOrder + j] and the function is associated with
+ *        control point aSpan - aOrder + 1 + j.
+ */
+MCAD_API void CalcBasisDerivs( int aOrder, const double* aKnots, int aSpan,
+    double aParam, int aNDerivs, double* aResult );
+
+/**
+ * Function EvalNURBSCurve
+ * evaluates a curve and optionally its first and second derivatives
+ * at a batch of parameters and returns true on success.
+ *
+ * @param aOrder = spline order (degree + 1)
+ * @param aNCoeffs = number of control points
+ * @param aKnots = knot vector with aNCoeffs + aOrder values
+ * @param aCoeffs = control points, (x, y, z) or (x, y, z, w) if aRational
+ * @param aRational = true if the control points include weights
+ * @param aNParams = number of parameters to evaluate
+ * @param aParams = parameters to evaluate
+ * @param aPoint = array of aNParams points to hold the positions or NULL
+ * @param aDeriv1 = array of aNParams points to hold the first derivatives or NULL
+ * @param aDeriv2 = array of aNParams points to hold the second derivatives or NULL
+ */
+MCAD_API bool EvalNURBSCurve( int aOrder, int aNCoeffs, const double* aKnots,
+    const double* aCoeffs, bool aRational, size_t aNParams, const double* aParams,
+    MCAD_POINT* aPoint, MCAD_POINT* aDeriv1 = NULL, MCAD_POINT* aDeriv2 = NULL );
+
+/**
+ * Function EvalNURBSSurfaceGrid
+ * evaluates a surface and optionally its partial derivatives and normals
+ * on the grid formed by the given U and V parameters and returns true on
+ * success. The basis functions are calculated once per U and V parameter
+ * and the result for (aU[i], aV[j]) is stored at index j * aNU + i of
+ * each of the output arrays.
+ *
+ * @param aOrder1 = spline order in U (degree + 1)
+ * @param aOrder2 = spline order in V (degree + 1)
+ * @param aNCoeffs1 = number of control points in U
+ * @param aNCoeffs2 = number of control points in V
+ * @param aKnots1 = knot vector in U with aNCoeffs1 + aOrder1 values
+ * @param aKnots2 = knot vector in V with aNCoeffs2 + aOrder2 values
+ * @param aCoeffs = control points, (x, y, z) or (x, y, z, w) if aRational,
+ *        ordered as in the IGES Parameter Data with the U index varying fastest
+ * @param aRational = true if the control points include weights
+ * @param aNU = number of U parameters
+ * @param aU = U parameters to evaluate
+ * @param aNV = number of V parameters
+ * @param aV = V parameters to evaluate
+ * @param aPoint = array of aNU * aNV points to hold the positions or NULL
+ * @param aDerivU = array of aNU * aNV points to hold dS/du or NULL
+ * @param aDerivV = array of aNU * aNV points to hold dS/dv or NULL
+ * @param aNormal = array of aNU * aNV points to hold the unit normals
+ *        (dS/du x dS/dv) or NULL; where the normal is undefined, such as
+ *        at a degenerate edge, a zero vector is stored
+ */
+MCAD_API bool EvalNURBSSurfaceGrid( int aOrder1, int aOrder2, int aNCoeffs1, int aNCoeffs2,
+    const double* aKnots1, const double* aKnots2, const double* aCoeffs, bool aRational,
+    size_t aNU, const double* aU, size_t aNV, const double* aV, MCAD_POINT* aPoint,
+    MCAD_POINT* aDerivU = NULL, MCAD_POINT* aDerivV = NULL, MCAD_POINT* aNormal = NULL );
+
+/**
+ * Function EvalNURBSSurfacePoints
+ * evaluates the position of a surface at a batch of arbitrary (u, v)
+ * parameter pairs and returns true on success. Only the control points
+ * of the current knot spans are converted to homogeneous form and for
+ * the usual low order surfaces no memory is allocated, so the function
+ * is suitable for evaluating one point at a time. Parameters outside
+ * the knot range are clamped to the range.
+ *
+ * @param aOrder1 = spline order in U (degree + 1)
+ * @param aOrder2 = spline order in V (degree + 1)
+ * @param aNCoeffs1 = number of control points in U
+ * @param aNCoeffs2 = number of control points in V
+ * @param aKnots1 = knot vector in U with aNCoeffs1 + aOrder1 values
+ * @param aKnots2 = knot vector in V with aNCoeffs2 + aOrder2 values
+ * @param aCoeffs = control points as in EvalNURBSSurfaceGrid()
+ * @param aRational = true if the control points include weights
+ * @param aNParams = number of parameter pairs to evaluate
+ * @param aU = U parameters to evaluate
+ * @param aV = V parameters to evaluate
+ * @param aPoint = array of aNParams points to hold the positions
+ */
+MCAD_API bool EvalNURBSSurfacePoints( int aOrder1, int aOrder2, int aNCoeffs1, int aNCoeffs2,
+    const double* aKnots1, const double* aKnots2, const double* aCoeffs, bool aRational,
+    size_t aNParams, const double* aU, const double* aV, MCAD_POINT* aPoint );
+
+#endif  // MCAD_NURBS_H
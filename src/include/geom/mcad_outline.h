@@ -69,9 +69,12 @@
 
 #include <list>
 #include <string>
+#include <vector>
 #include <libigesconf.h>
+#include <geom/mcad_boxtree.h>
 
 class MCAD_SEGMENT;
+class MCAD_SEGPOOL;
 
 enum MCAD_OUTLINE_TYPE
 {
@@ -94,6 +97,26 @@ struct MCAD_INTERSECT
     }
 };
 
+/**
+ * Struct MCAD_SIMPLIFY_STATS
+ * reports the savings achieved by MCAD_OUTLINE::Simplify()
+ */
+struct MCAD_SIMPLIFY_STATS
+{
+    size_t nLines;          // number of lines merged into a collinear neighbour
+    size_t nArcs;           // number of arcs merged into a co-circular neighbour
+    size_t nSegmentsIn;     // number of segments in the outline and cutouts before the pass
+    size_t nSegmentsOut;    // number of segments in the outline and cutouts after the pass
+
+    MCAD_SIMPLIFY_STATS()
+    {
+        nLines = 0;
+        nArcs = 0;
+        nSegmentsIn = 0;
+        nSegmentsOut = 0;
+    }
+};
+
 class MCAD_OUTLINE
 {
 private:
@@ -107,8 +130,13 @@ protected:
     bool opOutline( MCAD_SEGMENT* aCircle, bool& error, bool opsub );
     // operate on the generic outline (add/subtract)
     bool opOutline( MCAD_OUTLINE* aOutline, bool& error, bool opsub );
+    // operate on a list of circular outlines (add/subtract)
+    bool opOutlines( std::list<MCAD_SEGMENT*>& aCircles, bool& error, bool opsub );
     // recalculate the bounding box
     void calcBoundingBox( void );
+    // calculate the extent of the (closed) outline; returns false if
+    // the outline is not closed
+    bool getExtent( MCAD_POINT& bb0, MCAD_POINT& bb1 );
     // adjust the bounding box in preparation for rendering a surface
     void adjustBoundingBox( void );
     bool mBBisOK;       // true if the bounding box has been calculated and
@@ -122,6 +150,49 @@ protected:
     std::list<MCAD_OUTLINE*> mcutouts;  // list of non-overlapping cutouts
     std::list<MCAD_SEGMENT*> mholes;    // list of non-overlapping holes
 
+    // pool from which the segments created by the operations on this
+    // outline are allocated (see MCAD_SEGPOOL)
+    MCAD_SEGPOOL* mSegPool;
+
+    // Index of the segments by their extent in Y used by IsInside();
+    // the segments are sorted by their minimum Y and form an implicit
+    // balanced tree in which each node holds the maximum Y of its
+    // subtree. The index is built on demand and mEdgeIndexOK must be
+    // cleared whenever msegments is modified.
+    bool mEdgeIndexOK;
+    std::vector< std::list<MCAD_SEGMENT*>::iterator > mEdgeSegs;
+    std::vector<MCAD_POINT> mEdgeBB0;   // bottom left of each segment's bounding box
+    std::vector<MCAD_POINT> mEdgeBB1;   // top right of each segment's bounding box
+    std::vector<double> mEdgeMaxY;      // maximum Y within each subtree
+    double mEdgeTol;                    // margin applied to index queries
+    // build the segment index
+    void buildEdgeIndex( void );
+    // retrieve the indexed segments which may intersect a horizontal line
+    void findEdges( size_t aLo, size_t aHi, double aY0, double aY1,
+                    std::vector<size_t>& aList ) const;
+    // test a point against the (closed) outline using the segment index
+    bool isInside( const MCAD_POINT& aPoint, std::vector<size_t>& aList );
+
+    // Index of the cutouts by their extent used by AddCutout(); the key
+    // of each cutout is its position within mcutouts so the candidates
+    // can be tried in the order of the list. mcutouts must only be
+    // extended via pushCutout() so that the index remains in step with
+    // it; GetCutouts() therefore exposes the list as const.
+    MCAD_BOXTREE mCutoutTree;
+    std::vector<MCAD_OUTLINE*> mCutoutItems;    // cutouts in the order of mcutouts
+    std::vector<int> mCutoutLeaves;             // tree leaf of each cutout
+    // add a cutout to mcutouts and to the index
+    void pushCutout( MCAD_OUTLINE* aCutout );
+    // retrieve the positions of the cutouts which may overlap (bb0, bb1), in ascending order
+    void findCutouts( MCAD_POINT bb0, MCAD_POINT bb1, std::vector<size_t>& aList );
+    // update the index entry of a cutout which has changed
+    void updateCutout( size_t aIndex );
+
+    // merge runs of collinear lines and co-circular arcs within a closed
+    // loop of segments
+    void simplifyLoop( std::list<MCAD_SEGMENT*>& aLoop, double aTolerance,
+                       MCAD_SIMPLIFY_STATS& aStats );
+
 public:
     MCAD_OUTLINE();
     virtual ~MCAD_OUTLINE();
@@ -142,7 +213,9 @@ public:
     void DetachValidFlag( bool* aFlag );
 
     std::list<MCAD_SEGMENT*>* GetSegments( void );
-    std::list<MCAD_OUTLINE*>* GetCutouts( void );
+    // the cutouts are indexed by their extent; they must only be
+    // changed via AddCutout() and must not be modified directly
+    const std::list<MCAD_OUTLINE*>* GetCutouts( void );
     std::list<MCAD_SEGMENT*>* GetDrillHoles( void );
 
     // Retrieve the error stack
@@ -157,9 +230,17 @@ public:
     // Returns 'true' if the (closed) outline is contiguous
     bool IsContiguous( void );
 
-    // Returns 'true' if the point is on or inside this outline
+    // Returns 'true' if the point is on or inside this outline; only
+    // the segments which span the Y coordinate of the point are tested
+    // so a query takes O(log n) time once the segments are indexed.
     bool IsInside( MCAD_POINT aPoint, bool& error );
 
+    // Test a list of points against this outline; aResult[i] is set
+    // to 'true' if aPoints[i] is on or inside the outline. Returns
+    // 'false' and sets 'error' if the outline is not closed.
+    bool IsInside( const std::vector<MCAD_POINT>& aPoints,
+                   std::vector<bool>& aResult, bool& error );
+
     // Add a segment to this outline; the user must ensure that
     // the outline is closed before performing any other type
     // of operation.
@@ -183,6 +264,25 @@ public:
     // the two outlines may only intersect at 2 points.
     bool SubOutline( MCAD_SEGMENT* aCircle, bool& error );
 
+    // Merge each circle in the list with this outline; the circles
+    // which are merged are destroyed and removed from the list while
+    // the others remain in the list in their original order. Circles
+    // which cannot touch the outline are culled by their bounding
+    // boxes so only the circles near the edge are tested in full.
+    // Returns 'true' if at least one circle was merged; on error the
+    // offending circle and all following circles remain in the list.
+    bool AddOutlines( std::list<MCAD_SEGMENT*>& aCircles, bool& error );
+
+    // Subtract each circle in the list from this outline; the circles
+    // which intersect the edge are cut out and destroyed while all
+    // other circles are added to the list of drill holes. On success
+    // the list is empty and the outline manages all of the circles;
+    // it is the caller's responsibility to ensure that the holes do
+    // not overlap. Returns 'true' if at least one circle intersected
+    // the edge; on error the offending circle and all following
+    // circles remain in the list.
+    bool SubOutlines( std::list<MCAD_SEGMENT*>& aCircles, bool& error );
+
     // Add the given cutout in preparation for exporting a solid model.
     // If the cutout is known to be non-overlapping then the 'overlaps'
     // flag may be set to 'false' to skip overlap tests. If the user
@@ -205,6 +305,16 @@ public:
     // overlap with any other cutouts, otherwise the geometry will be invalid.
     bool AddCutout( MCAD_SEGMENT* aCircle, bool overlaps, bool& error );
 
+    // Merge each run of consecutive collinear lines and each run of
+    // consecutive arcs on the same circle and with the same sense into
+    // a single segment, within the (closed) outline and all cutouts.
+    // Every removed vertex lies within aTolerance of the merged line
+    // and the merged arcs must share their center and radius to within
+    // aTolerance; the cost is linear in the number of segments. Returns
+    // 'true' if any segments were merged; 'error' is set if the outline
+    // is not closed. A summary is stored in aStats if it is not NULL.
+    bool Simplify( double aTolerance, bool& error, MCAD_SIMPLIFY_STATS* aStats = NULL );
+
     // print routines for testing/debugging
     void PrintPoint( MCAD_POINT p0 );
     void PrintSeg( MCAD_SEGMENT* seg );
@@ -29,11 +29,69 @@
 #ifndef MCAD_SEGMENT_H
 #define MCAD_SEGMENT_H
 
+#include <cstddef>
 #include <list>
 #include <vector>
 #include <libigesconf.h>
 #include <geom/mcad_elements.h>
 
+class MCAD_SEGBLOCK;
+
+// result of testing a segment against one member of an MCAD_SEGBLOCK
+struct MCAD_SEGHIT
+{
+    size_t index;               // index of the member within the block
+    MCAD_INTERSECT_FLAG flags;  // flags as reported by GetIntersections()
+    bool intersects;            // true if GetIntersections() reported intersections
+    size_t firstPoint;          // index of the first intersection in the point list
+    size_t nPoints;             // number of intersections
+};
+
+// NOTE:
+// Segments are created and destroyed in large numbers while outlines
+// are split and merged. Each outline therefore has a segment pool from
+// which the segments created by its operations are allocated; the pool
+// hands out slots in order from blocks of contiguous storage so that
+// the segments of an outline lie close together in memory. A block is
+// released once all of its segments have been deleted, so segments may
+// be moved from one outline to another and may outlive the outline and
+// pool which created them. An outline makes its pool active on the
+// calling thread via MCAD_SEGPOOL_SCOPE for the duration of each
+// operation. Segments created while no pool is active, and objects of
+// classes derived from MCAD_SEGMENT, are allocated from the heap.
+
+struct MCAD_SEGPOOL_BLOCK;
+
+class MCAD_SEGPOOL
+{
+private:
+    friend class MCAD_SEGMENT;
+    MCAD_SEGPOOL_BLOCK* m_block;    // block from which slots are handed out
+
+    // the pool may not be copied
+    MCAD_SEGPOOL( const MCAD_SEGPOOL& );
+    MCAD_SEGPOOL& operator=( const MCAD_SEGPOOL& );
+
+    // allocate a slot for a segment
+    void* alloc( void );
+
+public:
+    MCAD_SEGPOOL();
+    ~MCAD_SEGPOOL();
+};
+
+
+// makes a segment pool active on the calling thread during its lifetime
+class MCAD_SEGPOOL_SCOPE
+{
+private:
+    MCAD_SEGPOOL* m_prev;   // pool which was previously active
+
+public:
+    MCAD_SEGPOOL_SCOPE( MCAD_SEGPOOL* aPool );
+    ~MCAD_SEGPOOL_SCOPE();
+};
+
 
 class MCAD_SEGMENT
 {
@@ -96,6 +154,10 @@ public:
     MCAD_SEGMENT();
     virtual ~MCAD_SEGMENT();
 
+    // allocate segments from the active segment pool, if any
+    static void* operator new( size_t aSize );
+    static void operator delete( void* aSegment );
+
     MCAD_SEGTYPE GetSegType( void ) const;
     double GetRadius( void ) const;
     double GetStartAngle( void ) const;
@@ -141,6 +203,15 @@ public:
                            std::list<MCAD_POINT>& aIntersectList,
                            MCAD_INTERSECT_FLAG& flags );
 
+    // + calculate intersections with each member of a block; the result for
+    //   each member is the same as that of GetIntersections() above. A hit is
+    //   appended to aHitList, in order of the member index, for each member
+    //   which intersects or which reports a flag and the intersections are
+    //   appended to aPointList. Returns true if any member intersects.
+    bool GetIntersections( const MCAD_SEGBLOCK& aBlock,
+                           std::vector<MCAD_SEGHIT>& aHitList,
+                           std::vector<MCAD_POINT>& aPointList );
+
     // + calculate the bottom-left and top-right rectangular bounds
     bool GetBoundingBox( MCAD_POINT& p0, MCAD_POINT& p1 );
 
@@ -166,4 +237,54 @@ public:
     //
 };
 
+
+// NOTE:
+// A block holds the parameters of a set of segments in separate arrays
+// (structure of arrays) so that the line/line and circle/circle tests of
+// MCAD_SEGMENT::GetIntersections( MCAD_SEGBLOCK ... ) can be evaluated
+// for several members at once with SSE2 or AVX instructions; the cases
+// which are rare or which require trigonometry are passed to the scalar
+// tests. The block refers to the segments which were added, which must
+// remain valid and unchanged while the block is in use.
+
+class MCAD_SEGBLOCK
+{
+private:
+    friend class MCAD_SEGMENT;
+
+    std::vector< const MCAD_SEGMENT* > mSegments;
+
+    // lines: start and end points as given by GetStart() and GetEnd()
+    std::vector< double > mLX0;
+    std::vector< double > mLY0;
+    std::vector< double > mLX1;
+    std::vector< double > mLY1;
+    std::vector< size_t > mLIdx;
+
+    // circles: center and radius
+    std::vector< double > mCX;
+    std::vector< double > mCY;
+    std::vector< double > mCR;
+    std::vector< size_t > mCIdx;
+
+    // arcs
+    std::vector< size_t > mAIdx;
+
+public:
+    // remove all members
+    void Clear( void );
+
+    // reserve storage for the given number of members
+    void Reserve( size_t aSize );
+
+    // number of members in the block
+    size_t Size( void ) const;
+
+    // add a segment to the block; returns false if the segment has no data
+    bool Add( const MCAD_SEGMENT* aSegment );
+
+    // retrieve the segment with the given index
+    const MCAD_SEGMENT* GetSegment( size_t aIndex ) const;
+};
+
 #endif  // MCAD_SEGMENT_H
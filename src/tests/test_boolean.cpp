@@ -0,0 +1,436 @@
+/*
+ * file: test_boolean.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the multi-operand outline booleans (MCAD_BOOLEAN).
+ * Rectangles and circles are combined into results which overlap,
+ * enclose holes, share edges or fall apart into several bodies; the
+ * number of bodies, segments, cutouts and drill holes is checked and
+ * sample points are tested against the material of the result.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <cmath>
+#include <geom/mcad_elements.h>
+#include <geom/mcad_segment.h>
+#include <geom/mcad_outline.h>
+#include <geom/mcad_boolean.h>
+
+using namespace std;
+
+// a point to test against the result and the expected result
+struct SAMPLE
+{
+    double x;
+    double y;
+    bool inside;
+};
+
+// the expected shape of one body of a result
+struct BODY
+{
+    size_t nSegs;       // segments of the outer edge
+    size_t nCutouts;
+    size_t nHoles;      // drill holes
+};
+
+// union of overlapping rectangles, one of which has a cutout
+void testUnionCutout( int& nTests, int& nFails );
+// subtraction of a rectangle and a circle which lie within a rectangle
+void testHole( int& nTests, int& nFails );
+// subtraction of a circle centered on a corner of a rectangle
+void testCornerCircle( int& nTests, int& nFails );
+// union of rectangles which share an edge
+void testSharedEdge( int& nTests, int& nFails );
+// subtraction of a rectangle which splits a rectangle into 2 bodies
+void testSplit( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testUnionCutout( nTests, nFails );
+    testHole( nTests, nFails );
+    testCornerCircle( nTests, nFails );
+    testSharedEdge( nTests, nFails );
+    testSplit( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+static MCAD_SEGMENT* makeLine( double x0, double y0, double x1, double y1 )
+{
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+    sp->SetParams( MCAD_POINT( x0, y0, 0.0 ), MCAD_POINT( x1, y1, 0.0 ) );
+    return sp;
+}
+
+
+// create a rectangle from (x0, y0) to (x1, y1)
+static MCAD_OUTLINE* makeRect( double x0, double y0, double x1, double y1 )
+{
+    MCAD_OUTLINE* op = new MCAD_OUTLINE;
+    bool error = false;
+
+    op->AddSegment( makeLine( x0, y0, x1, y0 ), error );
+    op->AddSegment( makeLine( x1, y0, x1, y1 ), error );
+    op->AddSegment( makeLine( x1, y1, x0, y1 ), error );
+    op->AddSegment( makeLine( x0, y1, x0, y0 ), error );
+
+    return op;
+}
+
+
+static MCAD_SEGMENT* makeCircle( double x, double y, double r )
+{
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+    MCAD_POINT c( x, y, 0.0 );
+    MCAD_POINT p( x + r, y, 0.0 );
+    sp->SetParams( c, p, p, false );
+    return sp;
+}
+
+
+// returns 'true' if the point lies within the material of the body
+static bool inBody( MCAD_OUTLINE* aBody, const MCAD_POINT& aPoint )
+{
+    bool error = false;
+
+    if( !aBody->IsInside( aPoint, error ) )
+        return false;
+
+    const list<MCAD_OUTLINE*>* cl = aBody->GetCutouts();
+    list<MCAD_OUTLINE*>::const_iterator sC = cl->begin();
+    list<MCAD_OUTLINE*>::const_iterator eC = cl->end();
+
+    while( sC != eC )
+    {
+        if( (*sC)->IsInside( aPoint, error ) )
+            return false;
+
+        ++sC;
+    }
+
+    list<MCAD_SEGMENT*>* hl = aBody->GetDrillHoles();
+    list<MCAD_SEGMENT*>::iterator sH = hl->begin();
+    list<MCAD_SEGMENT*>::iterator eH = hl->end();
+
+    while( sH != eH )
+    {
+        MCAD_POINT c = (*sH)->GetCenter();
+        double r = (*sH)->GetRadius();
+        double dx = aPoint.x - c.x;
+        double dy = aPoint.y - c.y;
+
+        if( dx * dx + dy * dy < r * r )
+            return false;
+
+        ++sH;
+    }
+
+    return true;
+}
+
+
+// compare the bodies of a result with the expected shapes, in any
+// order, and test the sample points; returns 'false' on mismatch
+static bool checkResult( list<MCAD_OUTLINE*>& aResult, const BODY* aBodies, size_t aNBodies,
+    const SAMPLE* aSamples, size_t aNSamples )
+{
+    if( aResult.size() != aNBodies )
+    {
+        cerr << "  [FAIL]: " << aResult.size() << " bodies; expected " << aNBodies << "\n";
+        return false;
+    }
+
+    vector<bool> matched( aNBodies, false );
+    list<MCAD_OUTLINE*>::iterator sB = aResult.begin();
+    list<MCAD_OUTLINE*>::iterator eB = aResult.end();
+
+    while( sB != eB )
+    {
+        size_t nSegs = (*sB)->GetSegments()->size();
+        size_t nCutouts = (*sB)->GetCutouts()->size();
+        size_t nHoles = (*sB)->GetDrillHoles()->size();
+        bool found = false;
+
+        for( size_t i = 0; i < aNBodies && !found; ++i )
+        {
+            if( !matched[i] && aBodies[i].nSegs == nSegs && aBodies[i].nCutouts == nCutouts
+                && aBodies[i].nHoles == nHoles )
+            {
+                matched[i] = true;
+                found = true;
+            }
+        }
+
+        if( !found )
+        {
+            cerr << "  [FAIL]: unexpected body with " << nSegs << " segments, ";
+            cerr << nCutouts << " cutouts and " << nHoles << " drill holes\n";
+            return false;
+        }
+
+        ++sB;
+    }
+
+    for( size_t i = 0; i < aNSamples; ++i )
+    {
+        MCAD_POINT p( aSamples[i].x, aSamples[i].y, 0.0 );
+        bool in = false;
+
+        for( sB = aResult.begin(); sB != eB && !in; ++sB )
+            in = inBody( *sB, p );
+
+        if( in != aSamples[i].inside )
+        {
+            cerr << "  [FAIL]: point (" << p.x << ", " << p.y << ") is ";
+            cerr << ( in ? "inside" : "outside" ) << " the result\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static void clearResult( list<MCAD_OUTLINE*>& aResult )
+{
+    while( !aResult.empty() )
+    {
+        delete aResult.back();
+        aResult.pop_back();
+    }
+
+    return;
+}
+
+
+static void report( bool aResult, int& nFails )
+{
+    if( aResult )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testUnionCutout( int& nTests, int& nFails )
+{
+    static const SAMPLE samples[] = {
+        { 1.0, 1.0, true }, { 3.0, 3.0, false }, { 7.0, 7.0, true }, { 14.0, 14.0, true },
+        { 12.0, 2.0, false }, { 2.0, 12.0, false }, { 16.0, 16.0, false } };
+    static const BODY bodies[] = { { 8, 1, 0 } };
+
+    ++nTests;
+    cerr << "* Test: union of overlapping rectangles with a cutout\n";
+
+    MCAD_OUTLINE* a = makeRect( 0.0, 0.0, 10.0, 10.0 );
+    MCAD_OUTLINE* b = makeRect( 5.0, 5.0, 15.0, 15.0 );
+    MCAD_OUTLINE* c = makeRect( 2.0, 2.0, 4.0, 4.0 );
+    bool error = false;
+    bool ok = a->AddCutout( c, true, error );
+    MCAD_BOOLEAN op;
+    list<MCAD_OUTLINE*> result;
+
+    if( !ok )
+    {
+        delete c;
+        cerr << "  [FAIL]: could not add the cutout\n";
+    }
+
+    if( ok && ( !op.AddOperand( a, false, error ) || !op.AddOperand( b, false, error )
+        || !op.Execute( result, error ) ) )
+    {
+        cerr << "  [FAIL]: the operation failed\n";
+        ok = false;
+    }
+
+    if( ok )
+        ok = checkResult( result, bodies, 1, samples, sizeof( samples ) / sizeof( samples[0] ) );
+
+    clearResult( result );
+    delete a;
+    delete b;
+    report( ok, nFails );
+    return;
+}
+
+
+void testHole( int& nTests, int& nFails )
+{
+    static const SAMPLE samples[] = {
+        { 1.0, 1.0, true }, { 5.0, 5.0, false }, { 3.5, 5.0, true },
+        { 8.0, 8.0, false }, { 8.0, 6.5, true }, { 11.0, 5.0, false } };
+    static const BODY bodies[] = { { 4, 1, 1 } };
+
+    ++nTests;
+    cerr << "* Test: rectangular and circular holes\n";
+
+    MCAD_OUTLINE* a = makeRect( 0.0, 0.0, 10.0, 10.0 );
+    MCAD_OUTLINE* b = makeRect( 4.0, 4.0, 6.0, 6.0 );
+    MCAD_SEGMENT* c = makeCircle( 8.0, 8.0, 1.0 );
+    bool error = false;
+    MCAD_BOOLEAN op;
+    list<MCAD_OUTLINE*> result;
+    bool ok = true;
+
+    if( !op.AddOperand( a, false, error ) || !op.AddOperand( b, true, error )
+        || !op.AddOperand( c, true, error ) || !op.Execute( result, error ) )
+    {
+        cerr << "  [FAIL]: the operation failed\n";
+        ok = false;
+    }
+
+    if( ok )
+        ok = checkResult( result, bodies, 1, samples, sizeof( samples ) / sizeof( samples[0] ) );
+
+    clearResult( result );
+    delete a;
+    delete b;
+    delete c;
+    report( ok, nFails );
+    return;
+}
+
+
+void testCornerCircle( int& nTests, int& nFails )
+{
+    static const SAMPLE samples[] = {
+        { 1.0, 1.0, true }, { 9.0, 9.0, false }, { 7.6, 8.5, false }, { 7.0, 7.0, true },
+        { 9.5, 6.5, true }, { 9.5, 7.5, false }, { 11.0, 11.0, false } };
+    static const BODY bodies[] = { { 5, 0, 0 } };
+
+    ++nTests;
+    cerr << "* Test: circle subtracted at a corner\n";
+
+    MCAD_OUTLINE* a = makeRect( 0.0, 0.0, 10.0, 10.0 );
+    MCAD_SEGMENT* c = makeCircle( 10.0, 10.0, 3.0 );
+    bool error = false;
+    MCAD_BOOLEAN op;
+    list<MCAD_OUTLINE*> result;
+    bool ok = true;
+
+    if( !op.AddOperand( a, false, error ) || !op.AddOperand( c, true, error )
+        || !op.Execute( result, error ) )
+    {
+        cerr << "  [FAIL]: the operation failed\n";
+        ok = false;
+    }
+
+    if( ok )
+        ok = checkResult( result, bodies, 1, samples, sizeof( samples ) / sizeof( samples[0] ) );
+
+    clearResult( result );
+    delete a;
+    delete c;
+    report( ok, nFails );
+    return;
+}
+
+
+void testSharedEdge( int& nTests, int& nFails )
+{
+    static const SAMPLE samples[] = {
+        { 5.0, 5.0, true }, { 10.0, 5.0, true }, { 15.0, 5.0, true },
+        { 21.0, 5.0, false }, { 10.0, 11.0, false } };
+    static const BODY bodies[] = { { 4, 0, 0 } };
+
+    ++nTests;
+    cerr << "* Test: union of rectangles which share an edge\n";
+
+    MCAD_OUTLINE* a = makeRect( 0.0, 0.0, 10.0, 10.0 );
+    MCAD_OUTLINE* b = makeRect( 10.0, 0.0, 20.0, 10.0 );
+    bool error = false;
+    MCAD_BOOLEAN op;
+    list<MCAD_OUTLINE*> result;
+    bool ok = true;
+
+    if( !op.AddOperand( a, false, error ) || !op.AddOperand( b, false, error )
+        || !op.Execute( result, error ) )
+    {
+        cerr << "  [FAIL]: the operation failed\n";
+        ok = false;
+    }
+
+    // the result is a single rectangle without vertices at x = 10
+    if( ok )
+        ok = checkResult( result, bodies, 1, samples, sizeof( samples ) / sizeof( samples[0] ) );
+
+    clearResult( result );
+    delete a;
+    delete b;
+    report( ok, nFails );
+    return;
+}
+
+
+void testSplit( int& nTests, int& nFails )
+{
+    static const SAMPLE samples[] = {
+        { 4.0, 5.0, true }, { 10.0, 5.0, false }, { 16.0, 5.0, true },
+        { 2.0, 2.0, false }, { 18.0, 8.0, true } };
+    static const BODY bodies[] = { { 4, 0, 0 }, { 4, 1, 0 } };
+
+    ++nTests;
+    cerr << "* Test: subtraction which splits a rectangle into 2 bodies\n";
+
+    MCAD_OUTLINE* a = makeRect( 0.0, 0.0, 20.0, 10.0 );
+    MCAD_OUTLINE* c = makeRect( 1.0, 1.0, 3.0, 3.0 );
+    MCAD_OUTLINE* b = makeRect( 8.0, -1.0, 12.0, 11.0 );
+    bool error = false;
+    bool ok = a->AddCutout( c, true, error );
+    MCAD_BOOLEAN op;
+    list<MCAD_OUTLINE*> result;
+
+    if( !ok )
+    {
+        delete c;
+        cerr << "  [FAIL]: could not add the cutout\n";
+    }
+
+    // the cutout remains with the body on the left
+    if( ok && ( !op.AddOperand( a, false, error ) || !op.AddOperand( b, true, error )
+        || !op.Execute( result, error ) ) )
+    {
+        cerr << "  [FAIL]: the operation failed\n";
+        ok = false;
+    }
+
+    if( ok )
+        ok = checkResult( result, bodies, 2, samples, sizeof( samples ) / sizeof( samples[0] ) );
+
+    clearResult( result );
+    delete a;
+    delete b;
+    report( ok, nFails );
+    return;
+}
@@ -0,0 +1,361 @@
+/*
+ * file: test_boxtree.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the bounding box tree (MCAD_BOXTREE) used to
+ * index the cutouts of an outline. Items are inserted, removed and
+ * moved at random and the results of region queries are compared
+ * with those of an exhaustive search.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <geom/mcad_boxtree.h>
+
+using namespace std;
+
+// number of items in the tree
+#define NITEMS 2000
+// number of queries after each change
+#define NQUERIES 500
+
+struct ITEM
+{
+    MCAD_POINT bb0;
+    MCAD_POINT bb1;
+    int leaf;           // leaf ID or -1 if the item is not in the tree
+};
+
+// compare queries of inserted items with an exhaustive search
+void testInsert( int& nTests, int& nFails );
+// compare queries after items are removed and reinserted
+void testRemove( int& nTests, int& nFails );
+// compare queries after items are moved
+void testUpdate( int& nTests, int& nFails );
+// check degenerate boxes, invalid leaf IDs and Clear()
+void testEdgeCases( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testInsert( nTests, nFails );
+    testRemove( nTests, nFails );
+    testUpdate( nTests, nFails );
+    testEdgeCases( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// deterministic pseudo-random numbers in the range [0, 1)
+static double rnd( void )
+{
+    static unsigned long seed = 12345;
+    seed = seed * 1103515245UL + 12345UL;
+    return double( ( seed >> 8 ) & 0xffffff ) / double( 0x1000000 );
+}
+
+
+// a random box of up to aSize in each direction within [0, 1000]
+static void randomBox( MCAD_POINT& bb0, MCAD_POINT& bb1, double aSize )
+{
+    bb0.x = rnd() * 1000.0;
+    bb0.y = rnd() * 1000.0;
+    bb1.x = bb0.x + rnd() * aSize;
+    bb1.y = bb0.y + rnd() * aSize;
+    return;
+}
+
+
+// compare random queries with an exhaustive search; returns the number of mismatches
+static int checkQueries( const MCAD_BOXTREE& aTree, const vector<ITEM>& aItems )
+{
+    int nBad = 0;
+    size_t nLive = 0;
+
+    for( size_t i = 0; i < aItems.size(); ++i )
+    {
+        if( aItems[i].leaf >= 0 )
+            ++nLive;
+    }
+
+    if( aTree.Size() != nLive )
+    {
+        cerr << "  [FAIL]: tree holds " << aTree.Size() << " items; expected " << nLive << "\n";
+        ++nBad;
+    }
+
+    for( int q = 0; q < NQUERIES; ++q )
+    {
+        MCAD_POINT q0;
+        MCAD_POINT q1;
+        randomBox( q0, q1, 100.0 );
+
+        vector<size_t> found;
+        vector<size_t> expected;
+        aTree.Query( q0, q1, found );
+
+        for( size_t i = 0; i < aItems.size(); ++i )
+        {
+            const ITEM& it = aItems[i];
+
+            if( it.leaf >= 0 && it.bb0.x <= q1.x && it.bb1.x >= q0.x
+                && it.bb0.y <= q1.y && it.bb1.y >= q0.y )
+                expected.push_back( i );
+        }
+
+        sort( found.begin(), found.end() );
+
+        if( found != expected )
+        {
+            if( 0 == nBad )
+            {
+                cerr << "  [FAIL]: query found " << found.size() << " items; expected ";
+                cerr << expected.size() << "\n";
+            }
+
+            ++nBad;
+        }
+    }
+
+    return nBad;
+}
+
+
+static void fillTree( MCAD_BOXTREE& aTree, vector<ITEM>& aItems )
+{
+    aItems.resize( NITEMS );
+
+    for( size_t i = 0; i < aItems.size(); ++i )
+    {
+        randomBox( aItems[i].bb0, aItems[i].bb1, 30.0 );
+        aItems[i].leaf = aTree.Insert( aItems[i].bb0, aItems[i].bb1, i );
+    }
+
+    return;
+}
+
+
+void testInsert( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: queries of " << NITEMS << " inserted items\n";
+
+    MCAD_BOXTREE tree;
+    vector<ITEM> items;
+    fillTree( tree, items );
+
+    if( checkQueries( tree, items ) )
+    {
+        ++nFails;
+        return;
+    }
+
+    cerr << "  [OK]\n";
+    return;
+}
+
+
+void testRemove( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: queries after removal and reinsertion of items\n";
+
+    MCAD_BOXTREE tree;
+    vector<ITEM> items;
+    fillTree( tree, items );
+    bool ok = true;
+
+    // remove every third item
+    for( size_t i = 0; i < items.size() && ok; i += 3 )
+    {
+        if( !tree.Remove( items[i].leaf ) )
+        {
+            cerr << "  [FAIL]: could not remove item " << i << "\n";
+            ok = false;
+        }
+
+        items[i].leaf = -1;
+    }
+
+    if( ok && checkQueries( tree, items ) )
+        ok = false;
+
+    // reinsert half of the removed items at new positions; the IDs of
+    // the removed leaves may be reused
+    for( size_t i = 0; i < items.size() && ok; i += 6 )
+    {
+        randomBox( items[i].bb0, items[i].bb1, 30.0 );
+        items[i].leaf = tree.Insert( items[i].bb0, items[i].bb1, i );
+    }
+
+    if( ok && checkQueries( tree, items ) )
+        ok = false;
+
+    // remove all items
+    for( size_t i = 0; i < items.size() && ok; ++i )
+    {
+        if( items[i].leaf >= 0 && !tree.Remove( items[i].leaf ) )
+        {
+            cerr << "  [FAIL]: could not remove item " << i << "\n";
+            ok = false;
+        }
+
+        items[i].leaf = -1;
+    }
+
+    if( ok && checkQueries( tree, items ) )
+        ok = false;
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testUpdate( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: queries after items are moved\n";
+
+    MCAD_BOXTREE tree;
+    vector<ITEM> items;
+    fillTree( tree, items );
+    bool ok = true;
+
+    // move items by small amounts (within their enlarged boxes) and by
+    // large amounts (to other parts of the tree)
+    for( int pass = 0; pass < 3 && ok; ++pass )
+    {
+        for( size_t i = pass; i < items.size() && ok; i += 2 )
+        {
+            if( pass == 1 )
+            {
+                randomBox( items[i].bb0, items[i].bb1, 60.0 );
+            }
+            else
+            {
+                double dx = rnd() - 0.5;
+                double dy = rnd() - 0.5;
+                items[i].bb0.x += dx;
+                items[i].bb0.y += dy;
+                items[i].bb1.x += dx;
+                items[i].bb1.y += dy;
+            }
+
+            if( !tree.Update( items[i].leaf, items[i].bb0, items[i].bb1 ) )
+            {
+                cerr << "  [FAIL]: could not update item " << i << "\n";
+                ok = false;
+            }
+        }
+
+        if( ok && checkQueries( tree, items ) )
+            ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testEdgeCases( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: degenerate boxes, invalid IDs and Clear()\n";
+
+    MCAD_BOXTREE tree;
+    vector<size_t> found;
+    bool ok = true;
+
+    tree.Query( MCAD_POINT( 0, 0, 0 ), MCAD_POINT( 10, 10, 0 ), found );
+
+    if( !found.empty() || 0 != tree.Size() )
+    {
+        cerr << "  [FAIL]: an empty tree returned items\n";
+        ok = false;
+    }
+
+    // a point and a segment are valid boxes; boxes which only touch overlap
+    int l0 = tree.Insert( MCAD_POINT( 5, 5, 0 ), MCAD_POINT( 5, 5, 0 ), 0 );
+    int l1 = tree.Insert( MCAD_POINT( 0, 2, 0 ), MCAD_POINT( 10, 2, 0 ), 1 );
+
+    tree.Query( MCAD_POINT( 5, 5, 0 ), MCAD_POINT( 6, 6, 0 ), found );
+
+    if( ok && ( found.size() != 1 || found[0] != 0 ) )
+    {
+        cerr << "  [FAIL]: a box touching a point item was not found\n";
+        ok = false;
+    }
+
+    found.clear();
+    tree.Query( MCAD_POINT( 3, 0, 0 ), MCAD_POINT( 4, 1.9, 0 ), found );
+
+    if( ok && !found.empty() )
+    {
+        cerr << "  [FAIL]: a box below a segment item returned items\n";
+        ok = false;
+    }
+
+    if( ok && ( tree.Remove( -1 ) || tree.Remove( 1000 ) || tree.Update( -1,
+        MCAD_POINT( 0, 0, 0 ), MCAD_POINT( 1, 1, 0 ) ) ) )
+    {
+        cerr << "  [FAIL]: an invalid leaf ID was accepted\n";
+        ok = false;
+    }
+
+    if( ok && ( !tree.Remove( l0 ) || tree.Remove( l0 ) ) )
+    {
+        cerr << "  [FAIL]: a leaf was not removed exactly once\n";
+        ok = false;
+    }
+
+    tree.Clear();
+    found.clear();
+    tree.Query( MCAD_POINT( -100, -100, 0 ), MCAD_POINT( 100, 100, 0 ), found );
+
+    if( ok && ( 0 != tree.Size() || !found.empty() || tree.Remove( l1 ) ) )
+    {
+        cerr << "  [FAIL]: items remain after Clear()\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
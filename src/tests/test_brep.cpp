@@ -0,0 +1,645 @@
+/*
+ * file: test_brep.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the topology index and the meshing of B-REP
+ * shells. A box is built from a Vertex List (502), an Edge List (504),
+ * Loops (508), Faces (510) and a Closed Shell (514); half of the faces
+ * lie on surfaces whose normals point into the box. The adjacency
+ * reported by IGES_BREP_TOPOLOGY is compared with that of the box and
+ * shells with a misoriented or a missing face are checked to be
+ * reported as defective. The mesh produced by
+ * IGES_TESSELLATOR::TessellateShell() must be closed: every directed
+ * edge of a triangle must be matched by exactly one edge in the
+ * opposite direction and the enclosed volume must be that of the box.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <core/iges.h>
+#include <core/entity110.h>
+#include <core/entity128.h>
+#include <core/entity502.h>
+#include <core/entity504.h>
+#include <core/entity508.h>
+#include <core/entity510.h>
+#include <core/entity514.h>
+#include <core/iges_tess.h>
+#include <core/iges_topology.h>
+
+using namespace std;
+
+// dimensions of the box
+#define BOX_X 10.0
+#define BOX_Y 4.0
+#define BOX_Z 2.0
+// relative tolerance of the volume
+#define TOL 1e-9
+
+// compare the adjacency of the topology index with that of the box
+void testTopology( int& nTests, int& nFails );
+// check that misoriented and missing faces are reported
+void testDefects( int& nTests, int& nFails );
+// mesh the shell and check that the mesh is closed
+void testShell( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testTopology( nTests, nFails );
+    testDefects( nTests, nFails );
+    testShell( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// the corners of each face in counterclockwise order as seen from
+// outside the box; corner i is at (x, y, z) = (i & 1, (i >> 1) & 1, (i >> 2) & 1)
+static const int faceCorners[6][4] =
+{
+    { 0, 2, 3, 1 },     // z = 0
+    { 4, 5, 7, 6 },     // z = 1
+    { 0, 1, 5, 4 },     // y = 0
+    { 2, 6, 7, 3 },     // y = 1
+    { 0, 4, 6, 2 },     // x = 0
+    { 1, 3, 7, 5 }      // x = 1
+};
+
+
+static MCAD_POINT corner( int aIndex )
+{
+    return MCAD_POINT( ( aIndex & 1 ) * BOX_X, ( ( aIndex >> 1 ) & 1 ) * BOX_Y,
+                       ( ( aIndex >> 2 ) & 1 ) * BOX_Z );
+}
+
+
+// create a bilinear plane through the corners p0 .. p3 of a face; the
+// normal of the surface is (p1 - p0) x (p3 - p0)
+static IGES_ENTITY_128* newPlane( IGES& aModel, const MCAD_POINT& p0, const MCAD_POINT& p1,
+    const MCAD_POINT& p2, const MCAD_POINT& p3 )
+{
+    static const double knots[] = { 0, 0, 1, 1 };
+    double coeffs[] = { p0.x, p0.y, p0.z, p1.x, p1.y, p1.z,
+                        p3.x, p3.y, p3.z, p2.x, p2.y, p2.z };
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_NURBS_SURFACE, &ep )
+        || !((IGES_ENTITY_128*)ep)->SetNURBSData( 2, 2, 2, 2, knots, knots, coeffs,
+        false, false, false, 0.0, 1.0, 0.0, 1.0 ) )
+        return NULL;
+
+    return (IGES_ENTITY_128*)ep;
+}
+
+
+// build the box; the faces with an odd index lie on surfaces whose
+// normals point into the box. Optionally one face is given the wrong
+// orientation flag and one face is left out; the faces are returned
+// in the order of faceCorners with NULL for a face which is left out.
+static IGES_ENTITY_514* buildBox( IGES& aModel, vector<IGES_ENTITY_510*>* aFaces = NULL,
+    int aFlipFace = -1, int aSkipFace = -1 )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_VERTEX, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_502* vl = (IGES_ENTITY_502*)ep;
+
+    for( int i = 0; i < 8; ++i )
+        vl->AddVertex( corner( i ) );
+
+    if( !aModel.NewEntity( ENT_EDGE, &ep ) )
+        return NULL;
+
+    // each edge runs from the lower to the higher numbered corner
+    IGES_ENTITY_504* el = (IGES_ENTITY_504*)ep;
+    map<pair<int, int>, int> edges;
+
+    for( int f = 0; f < 6; ++f )
+    {
+        for( int i = 0; i < 4; ++i )
+        {
+            int v0 = faceCorners[f][i];
+            int v1 = faceCorners[f][( i + 1 ) % 4];
+            pair<int, int> key( min( v0, v1 ), max( v0, v1 ) );
+
+            if( edges.find( key ) != edges.end() )
+                continue;
+
+            if( !aModel.NewEntity( ENT_LINE, &ep ) )
+                return NULL;
+
+            IGES_ENTITY_110* lp = (IGES_ENTITY_110*)ep;
+            MCAD_POINT p0 = corner( key.first );
+            MCAD_POINT p1 = corner( key.second );
+            lp->X1 = p0.x;
+            lp->Y1 = p0.y;
+            lp->Z1 = p0.z;
+            lp->X2 = p1.x;
+            lp->Y2 = p1.y;
+            lp->Z2 = p1.z;
+
+            if( !el->AddEdge( lp, vl, key.first + 1, vl, key.second + 1 ) )
+                return NULL;
+
+            int idx = (int)edges.size() + 1;
+            edges[key] = idx;
+        }
+    }
+
+    if( !aModel.NewEntity( ENT_SHELL, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_514* shell = (IGES_ENTITY_514*)ep;
+
+    if( NULL != aFaces )
+        aFaces->assign( 6, (IGES_ENTITY_510*)NULL );
+
+    for( int f = 0; f < 6; ++f )
+    {
+        if( f == aSkipFace )
+            continue;
+
+        // the loop runs counterclockwise about the normal of the surface
+        bool inward = ( f & 1 );
+        int fc[4];
+
+        for( int i = 0; i < 4; ++i )
+            fc[i] = faceCorners[f][inward ? ( 4 - i ) % 4 : i];
+
+        IGES_ENTITY_128* sp = newPlane( aModel, corner( fc[0] ), corner( fc[1] ),
+                                        corner( fc[2] ), corner( fc[3] ) );
+
+        if( NULL == sp || !aModel.NewEntity( ENT_LOOP, &ep ) )
+            return NULL;
+
+        IGES_ENTITY_508* loop = (IGES_ENTITY_508*)ep;
+
+        for( int i = 0; i < 4; ++i )
+        {
+            int v0 = fc[i];
+            int v1 = fc[( i + 1 ) % 4];
+            LOOP_DATA* ld = new LOOP_DATA;
+            ld->data = el;
+            ld->idx = edges[pair<int, int>( min( v0, v1 ), max( v0, v1 ) )];
+            ld->orientFlag = ( v0 < v1 );
+
+            if( !loop->AddEdge( ld ) )
+            {
+                delete ld;
+                return NULL;
+            }
+        }
+
+        if( !aModel.NewEntity( ENT_FACE, &ep ) )
+            return NULL;
+
+        IGES_ENTITY_510* face = (IGES_ENTITY_510*)ep;
+        face->SetOuterLoopFlag( true );
+
+        if( !face->SetSurface( sp ) || !face->AddBound( loop )
+            || !shell->AddFace( face, inward == ( f == aFlipFace ) ) )
+            return NULL;
+
+        if( NULL != aFaces )
+            (*aFaces)[f] = face;
+    }
+
+    return shell;
+}
+
+
+// returns true if two faces of the box share an edge
+static bool adjacent( int aFace0, int aFace1 )
+{
+    int n = 0;
+
+    for( int i = 0; i < 4; ++i )
+    {
+        for( int j = 0; j < 4; ++j )
+        {
+            if( faceCorners[aFace0][i] == faceCorners[aFace1][j] )
+                ++n;
+        }
+    }
+
+    return 2 == n;
+}
+
+
+// returns the corner of the box at the position of a vertex or -1
+static int findCorner( const MCAD_POINT& aPoint )
+{
+    for( int i = 0; i < 8; ++i )
+    {
+        MCAD_POINT d = corner( i ) - aPoint;
+
+        if( d.x * d.x + d.y * d.y + d.z * d.z < 1e-12 )
+            return i;
+    }
+
+    return -1;
+}
+
+
+void testTopology( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: topology of a closed shell\n";
+
+    IGES model;
+    vector<IGES_ENTITY_510*> boxFaces;
+    IGES_ENTITY_514* shell = buildBox( model, &boxFaces );
+    IGES_BREP_TOPOLOGY topo;
+    bool ok = true;
+
+    if( NULL == shell || !topo.Build( shell ) )
+    {
+        cerr << "  [FAIL]: could not index the shell\n";
+        ++nFails;
+        return;
+    }
+
+    if( topo.GetNVertices() != 8 || topo.GetNEdges() != 12 || topo.GetNUses() != 24
+        || topo.GetNLoops() != 6 || topo.GetNFaces() != 6 || topo.GetNShells() != 1 )
+    {
+        cerr << "  [FAIL]: " << topo.GetNVertices() << " vertices, " << topo.GetNEdges();
+        cerr << " edges and " << topo.GetNFaces() << " faces; expected 8, 12 and 6\n";
+        ok = false;
+    }
+
+    vector<int> defects;
+
+    if( ok && ( !topo.IsManifold() || topo.GetOpenEdges( defects )
+        || topo.GetNonManifoldEdges( defects ) || topo.GetMisorientedEdges( defects ) ) )
+    {
+        cerr << "  [FAIL]: the shell is reported as defective\n";
+        ok = false;
+    }
+
+    // the index of each face of the box
+    vector<int> faceIdx( 6, -1 );
+
+    for( int f = 0; f < 6 && ok; ++f )
+    {
+        faceIdx[f] = topo.FindFace( boxFaces[f] );
+
+        if( faceIdx[f] < 0 || topo.GetFace( faceIdx[f] )->face != boxFaces[f] )
+        {
+            cerr << "  [FAIL]: face " << f << " was not found\n";
+            ok = false;
+        }
+    }
+
+    // every corner has 3 edges and each edge joins distinct corners
+    set<int> corners;
+
+    for( int v = 0; v < (int)topo.GetNVertices() && ok; ++v )
+    {
+        size_t ne = 0;
+        int const* ep = NULL;
+
+        corners.insert( findCorner( topo.GetVertex( v )->point ) );
+
+        if( !topo.GetVertexEdges( v, ne, ep ) || 3 != ne )
+        {
+            cerr << "  [FAIL]: vertex " << v << " has " << ne << " edges; expected 3\n";
+            ok = false;
+            break;
+        }
+
+        for( size_t i = 0; i < ne; ++i )
+        {
+            const IGES_BREP_EDGE* edge = topo.GetEdge( ep[i] );
+
+            if( NULL == edge || ( edge->vertex[0] != v && edge->vertex[1] != v ) )
+            {
+                cerr << "  [FAIL]: edge " << ep[i] << " does not end at vertex " << v << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    if( ok && ( corners.size() != 8 || corners.count( -1 ) ) )
+    {
+        cerr << "  [FAIL]: the vertices are not the corners of the box\n";
+        ok = false;
+    }
+
+    // every edge is used once in each direction by two faces
+    for( int e = 0; e < (int)topo.GetNEdges() && ok; ++e )
+    {
+        size_t nu = 0;
+        int const* up = NULL;
+        vector<int> ef;
+
+        if( !topo.GetEdgeUses( e, nu, up ) || 2 != nu || !topo.GetEdgeFaces( e, ef )
+            || 2 != ef.size() || ef[0] == ef[1] )
+        {
+            cerr << "  [FAIL]: edge " << e << " is not used by 2 faces\n";
+            ok = false;
+            break;
+        }
+
+        if( topo.IsUseReversed( up[0] ) == topo.IsUseReversed( up[1] ) )
+        {
+            cerr << "  [FAIL]: edge " << e << " is used twice in the same direction\n";
+            ok = false;
+        }
+
+        for( size_t i = 0; i < nu; ++i )
+        {
+            int face = topo.GetLoop( topo.GetUse( up[i] )->loop )->face;
+
+            if( find( ef.begin(), ef.end(), face ) == ef.end() )
+            {
+                cerr << "  [FAIL]: use " << up[i] << " is not in a face of edge " << e << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    // the neighbours of a face are the faces with which it shares an edge
+    for( int f = 0; f < 6 && ok; ++f )
+    {
+        vector<int> nb;
+        set<int> expected;
+        set<int> result;
+
+        for( int g = 0; g < 6; ++g )
+        {
+            if( g != f && adjacent( f, g ) )
+                expected.insert( faceIdx[g] );
+        }
+
+        if( !topo.GetFaceNeighbors( faceIdx[f], nb ) )
+            nb.clear();
+
+        result.insert( nb.begin(), nb.end() );
+
+        if( result != expected || nb.size() != expected.size() )
+        {
+            cerr << "  [FAIL]: face " << f << " has " << nb.size();
+            cerr << " neighbours; expected " << expected.size() << "\n";
+            ok = false;
+        }
+    }
+
+    // a model is indexed through its shells which are not part of a solid
+    IGES_BREP_TOPOLOGY mtopo;
+
+    if( ok && ( !mtopo.Build( &model ) || mtopo.GetNShells() != 1
+        || mtopo.GetShell( 0 )->shell != shell || NULL != mtopo.GetShell( 0 )->solid
+        || mtopo.GetNFaces() != 6 ) )
+    {
+        cerr << "  [FAIL]: the shell of the model was not indexed\n";
+        ok = false;
+    }
+
+    topo.Clear();
+
+    if( ok && ( topo.GetNVertices() || topo.GetNEdges() || topo.GetNFaces()
+        || NULL != topo.GetFace( 0 ) || topo.FindFace( boxFaces[0] ) >= 0 ) )
+    {
+        cerr << "  [FAIL]: the index was not cleared\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testDefects( int& nTests, int& nFails )
+{
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        ++nTests;
+        cerr << "* Test: shell with a " << ( pass ? "missing" : "misoriented" ) << " face\n";
+
+        IGES model;
+        vector<IGES_ENTITY_510*> boxFaces;
+        IGES_ENTITY_514* shell = buildBox( model, &boxFaces, pass ? -1 : 2, pass ? 3 : -1 );
+        IGES_BREP_TOPOLOGY topo;
+        vector<int> open;
+        vector<int> nonManifold;
+        vector<int> misoriented;
+
+        if( NULL == shell || !topo.Build( shell ) )
+        {
+            cerr << "  [FAIL]: could not index the shell\n";
+            ++nFails;
+            continue;
+        }
+
+        topo.GetOpenEdges( open );
+        topo.GetNonManifoldEdges( nonManifold );
+        topo.GetMisorientedEdges( misoriented );
+
+        // the defective edges are those of the misoriented or missing face
+        vector<int>& defects = pass ? open : misoriented;
+        vector<int>& others = pass ? misoriented : open;
+        int face = pass ? 3 : 2;
+        bool ok = !topo.IsManifold() && 4 == defects.size() && others.empty()
+            && nonManifold.empty();
+
+        for( size_t i = 0; i < defects.size() && ok; ++i )
+        {
+            const IGES_BREP_EDGE* edge = topo.GetEdge( defects[i] );
+            int c0 = findCorner( topo.GetVertex( edge->vertex[0] )->point );
+            int c1 = findCorner( topo.GetVertex( edge->vertex[1] )->point );
+            int n = 0;
+
+            for( int j = 0; j < 4; ++j )
+            {
+                if( faceCorners[face][j] == c0 || faceCorners[face][j] == c1 )
+                    ++n;
+            }
+
+            ok = ( 2 == n );
+        }
+
+        if( ok )
+        {
+            cerr << "  [OK]\n";
+        }
+        else
+        {
+            cerr << "  [FAIL]: " << open.size() << " open, " << nonManifold.size();
+            cerr << " non-manifold and " << misoriented.size() << " misoriented edges\n";
+            ++nFails;
+        }
+    }
+
+    return;
+}
+
+
+// check that every directed edge of the mesh is matched by exactly one
+// edge in the opposite direction and that the mesh encloses the given
+// signed volume
+static bool checkClosed( const IGES_MESH& aMesh, double aVolume )
+{
+    const vector<int>& ip = aMesh.indices;
+    const vector<MCAD_POINT>& vp = aMesh.vertices;
+    map<pair<int, int>, int> dirEdges;
+    double vol = 0.0;
+
+    if( ip.empty() || ip.size() % 3 || aMesh.normals.size() != vp.size() )
+    {
+        cerr << "  [FAIL]: invalid mesh\n";
+        return false;
+    }
+
+    for( size_t i = 0; i < ip.size(); i += 3 )
+    {
+        for( int j = 0; j < 3; ++j )
+        {
+            int v0 = ip[i + j];
+            int v1 = ip[i + ( j + 1 ) % 3];
+
+            if( v0 < 0 || v0 >= (int)vp.size() || v0 == v1 )
+            {
+                cerr << "  [FAIL]: invalid triangle " << ( i / 3 ) << "\n";
+                return false;
+            }
+
+            ++dirEdges[pair<int, int>( v0, v1 )];
+        }
+
+        const MCAD_POINT& p0 = vp[ip[i]];
+        const MCAD_POINT& p1 = vp[ip[i + 1]];
+        const MCAD_POINT& p2 = vp[ip[i + 2]];
+        vol += ( p0.x * ( p1.y * p2.z - p1.z * p2.y )
+               - p0.y * ( p1.x * p2.z - p1.z * p2.x )
+               + p0.z * ( p1.x * p2.y - p1.y * p2.x ) ) / 6.0;
+    }
+
+    map<pair<int, int>, int>::iterator sE = dirEdges.begin();
+
+    while( sE != dirEdges.end() )
+    {
+        map<pair<int, int>, int>::iterator sO =
+            dirEdges.find( pair<int, int>( sE->first.second, sE->first.first ) );
+
+        if( sE->second != 1 || sO == dirEdges.end() || sO->second != 1 )
+        {
+            cerr << "  [FAIL]: edge (" << sE->first.first << ", " << sE->first.second;
+            cerr << ") is open or not manifold\n";
+            return false;
+        }
+
+        ++sE;
+    }
+
+    // V - E + F = 2 for a closed mesh of genus 0
+    long euler = (long)vp.size() - (long)( dirEdges.size() / 2 ) + (long)( ip.size() / 3 );
+
+    if( 2 != euler )
+    {
+        cerr << "  [FAIL]: Euler characteristic " << euler << "; expected 2\n";
+        return false;
+    }
+
+    if( fabs( vol - aVolume ) > TOL * fabs( aVolume ) )
+    {
+        cerr << "  [FAIL]: volume " << vol << "; expected " << aVolume << "\n";
+        return false;
+    }
+
+    // the vertex normals must agree with the orientation of the shell
+    MCAD_POINT centre( 0.5 * BOX_X, 0.5 * BOX_Y, 0.5 * BOX_Z );
+
+    for( size_t i = 0; i < vp.size(); ++i )
+    {
+        MCAD_POINT d = vp[i] - centre;
+        const MCAD_POINT& n = aMesh.normals[i];
+
+        if( ( d.x * n.x + d.y * n.y + d.z * n.z ) * aVolume <= 0.0 )
+        {
+            cerr << "  [FAIL]: the normal of vertex " << i << " has the wrong direction\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void testShell( int& nTests, int& nFails )
+{
+    IGES model;
+    IGES_ENTITY_514* shell = buildBox( model );
+    const double vol = BOX_X * BOX_Y * BOX_Z;
+
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        // the second pass reverses the orientation of the shell
+        bool orient = ( 0 == pass );
+
+        ++nTests;
+        cerr << "* Test: closed shell, orientation " << ( orient ? "true" : "false" ) << "\n";
+
+        if( NULL == shell )
+        {
+            cerr << "  [FAIL]: could not create the shell\n";
+            ++nFails;
+            continue;
+        }
+
+        IGES_TESSELLATOR tess;
+        IGES_MESH mesh;
+        bool ok = true;
+
+        tess.SetTolerance( 0.05, 0.2 );
+
+        if( !tess.TessellateShell( shell, mesh, orient, 4 ) )
+        {
+            cerr << "  [FAIL]: the shell could not be meshed\n";
+            ok = false;
+        }
+
+        ok = ok && checkClosed( mesh, orient ? vol : -vol );
+
+        if( ok )
+            cerr << "  [OK]\n";
+        else
+            ++nFails;
+    }
+
+    return;
+}
@@ -0,0 +1,495 @@
+/*
+ * file: test_bvh.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the entity bounds (IGES_ENTITY::GetBounds()) and
+ * of the Bounding Volume Hierarchy (IGES_BVH). The bounds of arcs are
+ * checked against points sampled along the arcs, and the results of box,
+ * ray and nearest entity queries over a model of many transformed lines
+ * and arcs are compared with those of an exhaustive search, before and
+ * after the entities are moved and the hierarchy is refit.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <core/iges.h>
+#include <core/iges_bvh.h>
+#include <core/entity100.h>
+#include <core/entity110.h>
+#include <core/entity124.h>
+
+using namespace std;
+
+// number of entities in the model
+#define NENTITIES 2000
+// number of queries of each kind
+#define NQUERIES 200
+
+// check the bounds of arcs against points sampled along the arcs
+void testArcBounds( int& nTests, int& nFails );
+// compare box, ray and nearest queries with an exhaustive search
+void testQueries( int& nTests, int& nFails );
+// compare the queries after the entities are moved and the hierarchy is refit
+void testRefit( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testArcBounds( nTests, nFails );
+    testQueries( nTests, nFails );
+    testRefit( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// deterministic pseudo-random numbers in the range [0, 1)
+static double rnd( void )
+{
+    static unsigned long seed = 12345;
+    seed = seed * 1103515245UL + 12345UL;
+    return double( ( seed >> 8 ) & 0xffffff ) / double( 0x1000000 );
+}
+
+
+static IGES_ENTITY_100* newArc( IGES& aModel, double aX, double aY, double aZ,
+    double aRadius, double aStart, double aEnd )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_CIRCULAR_ARC, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_100* ap = (IGES_ENTITY_100*)ep;
+    ap->zOffset = aZ;
+    ap->xCenter = aX;
+    ap->yCenter = aY;
+    ap->xStart = aX + aRadius * cos( aStart );
+    ap->yStart = aY + aRadius * sin( aStart );
+    ap->xEnd = aX + aRadius * cos( aEnd );
+    ap->yEnd = aY + aRadius * sin( aEnd );
+
+    // a full circle has coincident start and end points
+    if( aEnd - aStart >= 2.0 * M_PI )
+    {
+        ap->xEnd = ap->xStart;
+        ap->yEnd = ap->yStart;
+    }
+
+    return ap;
+}
+
+
+static IGES_ENTITY_124* newTransform( IGES& aModel, double aAngle, const MCAD_POINT& aOffset )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_TRANSFORMATION_MATRIX, &ep ) )
+        return NULL;
+
+    // rotation about the axis (1, 1, 1)
+    IGES_ENTITY_124* tp = (IGES_ENTITY_124*)ep;
+    double c = cos( aAngle );
+    double s = sin( aAngle );
+    double k = ( 1.0 - c ) / 3.0;
+    double w = s / sqrt( 3.0 );
+
+    for( int i = 0; i < 3; ++i )
+    {
+        for( int j = 0; j < 3; ++j )
+            tp->T.R.v[i][j] = k + ( i == j ? c : 0.0 );
+    }
+
+    tp->T.R.v[0][1] -= w;
+    tp->T.R.v[0][2] += w;
+    tp->T.R.v[1][0] += w;
+    tp->T.R.v[1][2] -= w;
+    tp->T.R.v[2][0] -= w;
+    tp->T.R.v[2][1] += w;
+    tp->T.T = aOffset;
+
+    return tp;
+}
+
+
+static bool inBox( const MCAD_BOX& aBox, const MCAD_POINT& p, double aTol )
+{
+    return p.x >= aBox.lo.x - aTol && p.x <= aBox.hi.x + aTol
+        && p.y >= aBox.lo.y - aTol && p.y <= aBox.hi.y + aTol
+        && p.z >= aBox.lo.z - aTol && p.z <= aBox.hi.z + aTol;
+}
+
+
+void testArcBounds( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: bounds of arcs\n";
+
+    IGES model;
+    IGES_ENTITY_124* tp = newTransform( model, 0.8, MCAD_POINT( 1.0, -2.0, 3.0 ) );
+    bool ok = ( NULL != tp );
+
+    for( int i = 0; i < 200 && ok; ++i )
+    {
+        double a0 = ( rnd() - 0.5 ) * 4.0 * M_PI;
+        double sweep = ( i % 10 ) ? rnd() * 2.0 * M_PI : 2.0 * M_PI;
+        double r = 0.5 + rnd() * 10.0;
+        IGES_ENTITY_100* ap = newArc( model, rnd() * 10.0, rnd() * 10.0, rnd(), r, a0,
+            a0 + sweep );
+
+        if( NULL == ap || ( ( i & 1 ) && !ap->SetTransform( tp ) ) )
+        {
+            cerr << "  [FAIL]: could not create the arcs\n";
+            ok = false;
+            break;
+        }
+
+        MCAD_BOX box;
+        MCAD_BOX tight;
+
+        if( !ap->GetBounds( box ) )
+        {
+            cerr << "  [FAIL]: no bounds for arc " << i << "\n";
+            ok = false;
+            break;
+        }
+
+        for( int j = 0; j <= 4000; ++j )
+        {
+            double ang = a0 + sweep * j / 4000.0;
+            MCAD_POINT p( ap->xCenter + r * cos( ang ), ap->yCenter + r * sin( ang ),
+                ap->zOffset );
+
+            if( i & 1 )
+                p = tp->GetTransformMatrix() * p;
+
+            tight.Add( p );
+
+            if( !inBox( box, p, 1e-9 ) )
+            {
+                cerr << "  [FAIL]: a point of arc " << i << " is outside its bounds\n";
+                ok = false;
+                break;
+            }
+        }
+
+        // the bounds of an arc without a transform are tight; the error of
+        // the sampled extremes is below r * (1 - cos(pi / 4000))
+        if( ok && !( i & 1 ) && ( !inBox( tight, box.lo, 1e-5 * r )
+            || !inBox( tight, box.hi, 1e-5 * r ) ) )
+        {
+            cerr << "  [FAIL]: the bounds of arc " << i << " are not tight\n";
+            ok = false;
+        }
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+// create a model of randomly placed lines and arcs, half of which are
+// transformed by one of 2 transforms
+static bool makeModel( IGES& aModel, vector<IGES_ENTITY*>& aEntities )
+{
+    IGES_ENTITY_124* t0 = newTransform( aModel, 0.3, MCAD_POINT( 10.0, 0.0, 0.0 ) );
+    IGES_ENTITY_124* t1 = newTransform( aModel, -1.2, MCAD_POINT( 0.0, 5.0, -5.0 ) );
+
+    if( NULL == t0 || NULL == t1 )
+        return false;
+
+    for( int i = 0; i < NENTITIES; ++i )
+    {
+        IGES_ENTITY* ep = NULL;
+        double x = rnd() * 100.0;
+        double y = rnd() * 100.0;
+        double z = rnd() * 100.0;
+
+        if( i % 3 )
+        {
+            if( !aModel.NewEntity( ENT_LINE, &ep ) )
+                return false;
+
+            IGES_ENTITY_110* lp = (IGES_ENTITY_110*)ep;
+            lp->X1 = x;
+            lp->Y1 = y;
+            lp->Z1 = z;
+            lp->X2 = x + rnd() * 5.0;
+            lp->Y2 = y + rnd() * 5.0;
+            lp->Z2 = z + rnd() * 5.0;
+        }
+        else
+        {
+            double a0 = rnd() * 2.0 * M_PI;
+            ep = newArc( aModel, x, y, z, 0.1 + rnd() * 3.0, a0, a0 + rnd() * 6.0 );
+
+            if( NULL == ep )
+                return false;
+        }
+
+        if( ( i % 4 ) == 1 && !ep->SetTransform( t0 ) )
+            return false;
+
+        if( ( i % 4 ) == 2 && !ep->SetTransform( t1 ) )
+            return false;
+
+        aEntities.push_back( ep );
+    }
+
+    return true;
+}
+
+
+// compare the queries of the hierarchy with an exhaustive search over
+// the bounds of the entities; returns the number of mismatches
+static int checkQueries( const IGES_BVH& aBVH, vector<IGES_ENTITY*>& aEntities )
+{
+    int nBad = 0;
+    vector<MCAD_BOX> boxes( aEntities.size() );
+
+    for( size_t i = 0; i < aEntities.size(); ++i )
+        aEntities[i]->GetBounds( boxes[i] );
+
+    if( aBVH.GetNEntities() != aEntities.size() )
+    {
+        cerr << "  [FAIL]: " << aBVH.GetNEntities() << " entities in the hierarchy; expected ";
+        cerr << aEntities.size() << "\n";
+        return 1;
+    }
+
+    for( int q = 0; q < NQUERIES && 0 == nBad; ++q )
+    {
+        // box query
+        MCAD_BOX qb;
+        qb.Add( MCAD_POINT( rnd() * 120.0 - 10.0, rnd() * 120.0 - 10.0, rnd() * 120.0 - 10.0 ) );
+        qb.Add( MCAD_POINT( qb.lo.x + rnd() * 20.0, qb.lo.y + rnd() * 20.0,
+            qb.lo.z + rnd() * 20.0 ) );
+
+        vector<IGES_ENTITY*> found;
+        vector<IGES_ENTITY*> expected;
+        aBVH.QueryBox( qb, found );
+
+        for( size_t i = 0; i < aEntities.size(); ++i )
+        {
+            if( boxes[i].Intersects( qb ) )
+                expected.push_back( aEntities[i] );
+        }
+
+        sort( found.begin(), found.end() );
+        sort( expected.begin(), expected.end() );
+
+        if( found != expected )
+        {
+            cerr << "  [FAIL]: box query found " << found.size() << " entities; expected ";
+            cerr << expected.size() << "\n";
+            ++nBad;
+            break;
+        }
+
+        // ray query; one ray in 4 is parallel to an axis
+        MCAD_POINT org( rnd() * 100.0, rnd() * 100.0, -20.0 );
+        MCAD_POINT dir( rnd() - 0.5, rnd() - 0.5, 1.0 );
+
+        if( 0 == q % 4 )
+            dir.x = dir.y = 0.0;
+
+        MCAD_POINT inv( 1.0 / dir.x, 1.0 / dir.y, 1.0 / dir.z );
+        vector<double> dist;
+        vector< pair<double, IGES_ENTITY*> > hits;
+        found.clear();
+        aBVH.QueryRay( org, dir, found, &dist );
+
+        for( size_t i = 0; i < aEntities.size(); ++i )
+        {
+            double t;
+
+            if( boxes[i].RayHit( org, inv, t ) )
+                hits.push_back( pair<double, IGES_ENTITY*>( t, aEntities[i] ) );
+        }
+
+        sort( hits.begin(), hits.end() );
+        bool same = ( found.size() == hits.size() && dist.size() == hits.size() );
+
+        for( size_t i = 0; i < hits.size() && same; ++i )
+        {
+            // entities at the same distance may be reported in any order
+            if( fabs( dist[i] - hits[i].first ) > 1e-9 * ( 1.0 + hits[i].first )
+                || find( found.begin(), found.end(), hits[i].second ) == found.end() )
+                same = false;
+        }
+
+        if( !same )
+        {
+            cerr << "  [FAIL]: ray query found " << found.size() << " entities; expected ";
+            cerr << hits.size() << "\n";
+            ++nBad;
+            break;
+        }
+
+        // nearest query
+        MCAD_POINT p( rnd() * 140.0 - 20.0, rnd() * 140.0 - 20.0, rnd() * 140.0 - 20.0 );
+        double d = -1.0;
+        double dMin = -1.0;
+        IGES_ENTITY* ep = aBVH.QueryNearest( p, &d );
+
+        for( size_t i = 0; i < aEntities.size(); ++i )
+        {
+            double d2 = boxes[i].Distance2( p );
+
+            if( dMin < 0.0 || d2 < dMin )
+                dMin = d2;
+        }
+
+        dMin = sqrt( dMin );
+
+        if( NULL == ep || fabs( d - dMin ) > 1e-9 * ( 1.0 + dMin ) )
+        {
+            cerr << "  [FAIL]: nearest entity at " << d << "; expected " << dMin << "\n";
+            ++nBad;
+            break;
+        }
+    }
+
+    return nBad;
+}
+
+
+void testQueries( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: queries of " << NENTITIES << " entities\n";
+
+    IGES model;
+    vector<IGES_ENTITY*> ents;
+    IGES_BVH bvh;
+    bool ok = makeModel( model, ents );
+
+    if( !ok )
+        cerr << "  [FAIL]: could not create the model\n";
+
+    // the model includes the transforms, which have no bounds
+    if( ok && !bvh.Build( &model, 4 ) )
+    {
+        cerr << "  [FAIL]: could not build the hierarchy\n";
+        ok = false;
+    }
+
+    if( ok && checkQueries( bvh, ents ) )
+        ok = false;
+
+    // a hierarchy over a list of entities
+    vector<IGES_ENTITY*> half( ents.begin(), ents.begin() + ents.size() / 2 );
+
+    if( ok && ( !bvh.Build( half, 1 ) || checkQueries( bvh, half ) ) )
+        ok = false;
+
+    bvh.Clear();
+
+    if( ok && ( 0 != bvh.GetNEntities() || NULL != bvh.QueryNearest( MCAD_POINT() ) ) )
+    {
+        cerr << "  [FAIL]: entities remain after Clear()\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testRefit( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: queries after the entities are moved\n";
+
+    IGES model;
+    vector<IGES_ENTITY*> ents;
+    IGES_BVH bvh;
+    bool ok = makeModel( model, ents );
+
+    if( !ok || !bvh.Build( &model ) )
+    {
+        cerr << "  [FAIL]: could not create the hierarchy\n";
+        ++nFails;
+        return;
+    }
+
+    // move some lines and refit them individually
+    for( size_t i = 1; i < ents.size() && ok; i += 5 )
+    {
+        if( ENT_LINE != ents[i]->GetEntityType() )
+            continue;
+
+        IGES_ENTITY_110* lp = (IGES_ENTITY_110*)ents[i];
+        lp->X2 += 30.0 * ( rnd() - 0.5 );
+        lp->Z1 -= 30.0 * rnd();
+
+        if( !bvh.Refit( lp ) )
+        {
+            cerr << "  [FAIL]: could not refit line " << i << "\n";
+            ok = false;
+        }
+    }
+
+    if( ok && checkQueries( bvh, ents ) )
+        ok = false;
+
+    // move all arcs and refit the whole hierarchy
+    for( size_t i = 0; i < ents.size() && ok; ++i )
+    {
+        if( ENT_CIRCULAR_ARC != ents[i]->GetEntityType() )
+            continue;
+
+        IGES_ENTITY_100* ap = (IGES_ENTITY_100*)ents[i];
+        double dx = 40.0 * ( rnd() - 0.5 );
+        ap->xCenter += dx;
+        ap->xStart += dx;
+        ap->xEnd += dx;
+        ap->zOffset += 10.0;
+    }
+
+    bvh.Refit( 4 );
+
+    if( ok && checkQueries( bvh, ents ) )
+        ok = false;
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
@@ -0,0 +1,404 @@
+/*
+ * file: test_cache.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the content versions of entities and of the
+ * model's cache of curve discretizations. Modifications must reach
+ * every entity which refers to the modified entity, even in graphs
+ * with many paths or malformed reference cycles, and the cache must
+ * never return results for a modified entity or transform, including
+ * when it is used concurrently.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <core/iges.h>
+#include <core/iges_cache.h>
+#include <core/iges_pool.h>
+#include <core/entity100.h>
+#include <core/entity110.h>
+#include <core/entity124.h>
+#include <core/entity308.h>
+
+using namespace std;
+
+// number of layers in the graph with many paths
+#define NLAYERS 48
+// number of arcs in the concurrency test
+#define NARCS 64
+// number of lookups per round of the concurrency test
+#define NTASKS 2048
+// chord tolerance used in the tests
+#define TOL 1e-3
+
+// check that Touch() reaches all ancestors in a graph with 2^NLAYERS paths
+void testTouchPaths( int& nTests, int& nFails );
+// check that Touch() terminates on a reference cycle
+void testTouchCycle( int& nTests, int& nFails );
+// check that the cache does not return stale polylines
+void testCacheStale( int& nTests, int& nFails );
+// look up polylines of arcs with a shared transform concurrently
+void testCacheConcurrent( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testTouchPaths( nTests, nFails );
+    testTouchCycle( nTests, nFails );
+    testCacheStale( nTests, nFails );
+    testCacheConcurrent( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+static IGES_ENTITY_308* newSubfigure( IGES& aModel )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_SUBFIGURE_DEFINITION, &ep ) )
+        return NULL;
+
+    return (IGES_ENTITY_308*)ep;
+}
+
+
+// create a half circle in the XY plane with the given center and radius
+static IGES_ENTITY_100* newArc( IGES& aModel, double aX, double aY, double aRadius )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_CIRCULAR_ARC, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_100* ap = (IGES_ENTITY_100*)ep;
+    ap->ZT = 0.0;
+    ap->X1 = aX;
+    ap->Y1 = aY;
+    ap->X2 = aX + aRadius;
+    ap->Y2 = aY;
+    ap->X3 = aX - aRadius;
+    ap->Y3 = aY;
+
+    return ap;
+}
+
+
+void testTouchPaths( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: modification reaches all ancestors along 2^" << NLAYERS << " paths\n";
+
+    // each layer holds 2 Subfigure Definitions which both contain the 2
+    // Subfigure Definitions of the layer below; each visit of a shared
+    // ancestor per path would never complete
+    IGES model;
+    IGES_ENTITY* ep;
+    vector<IGES_ENTITY_308*> layer[2];
+    bool ok = model.NewEntity( ENT_LINE, &ep );
+    IGES_ENTITY* base = ep;
+
+    for( int i = 0; i < NLAYERS && ok; ++i )
+    {
+        for( int j = 0; j < 2 && ok; ++j )
+        {
+            IGES_ENTITY_308* sp = newSubfigure( model );
+
+            if( NULL == sp )
+            {
+                ok = false;
+                break;
+            }
+
+            if( 0 == i )
+                ok = sp->AddDE( base );
+            else
+                ok = sp->AddDE( layer[0][i - 1] ) && sp->AddDE( layer[1][i - 1] );
+
+            layer[j].push_back( sp );
+        }
+    }
+
+    if( !ok )
+    {
+        cerr << "  [FAIL]: could not create the entities\n";
+        ++nFails;
+        return;
+    }
+
+    vector<unsigned long> v0;
+
+    for( int i = 0; i < NLAYERS; ++i )
+    {
+        v0.push_back( layer[0][i]->GetContentVersion() );
+        v0.push_back( layer[1][i]->GetContentVersion() );
+    }
+
+    unsigned long b0 = base->GetContentVersion();
+    base->Touch();
+
+    if( base->GetContentVersion() == b0 )
+    {
+        cerr << "  [FAIL]: the version of the modified entity did not change\n";
+        ok = false;
+    }
+
+    for( int i = 0; i < NLAYERS && ok; ++i )
+    {
+        if( layer[0][i]->GetContentVersion() == v0[2 * i]
+            || layer[1][i]->GetContentVersion() == v0[2 * i + 1] )
+        {
+            cerr << "  [FAIL]: the version of an ancestor in layer " << i;
+            cerr << " did not change\n";
+            ok = false;
+        }
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testTouchCycle( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: modification of an entity on a reference cycle\n";
+
+    // only direct cycles are rejected when references are added so a
+    // malformed file may contain a longer cycle such as this one
+    IGES model;
+    IGES_ENTITY* ep;
+    IGES_ENTITY_308* s0 = newSubfigure( model );
+    IGES_ENTITY_308* s1 = newSubfigure( model );
+    IGES_ENTITY_308* s2 = newSubfigure( model );
+    bool ok = s0 && s1 && s2 && model.NewEntity( ENT_LINE, &ep );
+
+    if( ok )
+        ok = s0->AddDE( ep ) && s1->AddDE( s0 ) && s2->AddDE( s1 ) && s0->AddDE( s2 );
+
+    if( !ok )
+    {
+        cerr << "  [FAIL]: could not create the entities\n";
+        ++nFails;
+        return;
+    }
+
+    unsigned long v0 = s0->GetContentVersion();
+    unsigned long v1 = s1->GetContentVersion();
+    unsigned long v2 = s2->GetContentVersion();
+    ep->Touch();
+
+    if( s0->GetContentVersion() == v0 || s1->GetContentVersion() == v1
+        || s2->GetContentVersion() == v2 )
+    {
+        cerr << "  [FAIL]: the version of an ancestor did not change\n";
+        ++nFails;
+    }
+    else
+    {
+        cerr << "  [OK]\n";
+    }
+
+    // break the cycle so that the entities may be deleted
+    s0->DelDE( s2 );
+    s2->delReference( s0 );
+
+    return;
+}
+
+
+// returns the largest distance between the points and the circle
+static double circleDeviation( const vector<MCAD_POINT>& aPoints, const MCAD_POINT& aCenter,
+    double aRadius )
+{
+    double dev = 0.0;
+
+    for( size_t i = 0; i < aPoints.size(); ++i )
+    {
+        double dx = aPoints[i].x - aCenter.x;
+        double dy = aPoints[i].y - aCenter.y;
+        double d = fabs( sqrt( dx * dx + dy * dy ) - aRadius ) + fabs( aPoints[i].z - aCenter.z );
+
+        if( d > dev )
+            dev = d;
+    }
+
+    return dev;
+}
+
+
+void testCacheStale( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: cached polylines of modified curves and transforms\n";
+
+    IGES model;
+    IGES_ENTITY* ep;
+    IGES_ENTITY_100* arc = newArc( model, 1.0, 2.0, 3.0 );
+    IGES_TESS_CACHE* cache = model.GetTessCache();
+    vector<MCAD_POINT> pts;
+    size_t hits, misses, evictions;
+    bool ok = ( NULL != arc ) && model.NewEntity( ENT_TRANSFORMATION_MATRIX, &ep );
+    IGES_ENTITY_124* tx = ok ? (IGES_ENTITY_124*)ep : NULL;
+
+    if( ok )
+        ok = arc->SetTransform( tx );
+
+    if( !ok )
+    {
+        cerr << "  [FAIL]: could not create the entities\n";
+        ++nFails;
+        return;
+    }
+
+    cache->ResetStats();
+
+    // the second lookup must be satisfied by the cache
+    ok = cache->GetPolyline( arc, pts, TOL ) && cache->GetPolyline( arc, pts, TOL );
+    cache->GetStats( hits, misses, evictions );
+
+    if( !ok || 1 != hits || 1 != misses
+        || circleDeviation( pts, MCAD_POINT( 1.0, 2.0, 0.0 ), 3.0 ) > 1e-9 )
+    {
+        cerr << "  [FAIL]: expected 1 hit and 1 miss, got " << hits << " and " << misses << "\n";
+        ++nFails;
+        return;
+    }
+
+    // modify the curve
+    arc->X2 = 1.0 + 5.0;
+    arc->X3 = 1.0 - 5.0;
+    arc->Touch();
+
+    if( !cache->GetPolyline( arc, pts, TOL )
+        || circleDeviation( pts, MCAD_POINT( 1.0, 2.0, 0.0 ), 5.0 ) > 1e-9 )
+    {
+        cerr << "  [FAIL]: stale polyline returned for a modified curve\n";
+        ++nFails;
+        return;
+    }
+
+    // modify the transform; Touch() reaches the arc through the transform
+    tx->T.T.z = 7.0;
+    tx->Touch();
+
+    if( !cache->GetPolyline( arc, pts, TOL )
+        || circleDeviation( pts, MCAD_POINT( 1.0, 2.0, 7.0 ), 5.0 ) > 1e-9 )
+    {
+        cerr << "  [FAIL]: stale polyline returned for a modified transform\n";
+        ++nFails;
+        return;
+    }
+
+    cerr << "  [OK]\n";
+    return;
+}
+
+
+struct CONCURRENT_DATA
+{
+    IGES_TESS_CACHE* cache;
+    IGES_ENTITY_100* arcs[NARCS];
+    double dev[NTASKS];
+    double offset;
+};
+
+
+static void lookupArc( void* aData, size_t aTask, int aWorker )
+{
+    CONCURRENT_DATA* dp = (CONCURRENT_DATA*)aData;
+    int idx = (int)( aTask % NARCS );
+    vector<MCAD_POINT> pts;
+
+    if( !dp->cache->GetPolyline( dp->arcs[idx], pts, TOL ) )
+    {
+        dp->dev[aTask] = -1.0;
+        return;
+    }
+
+    // the arcs are centered at (idx, 0, 0) and moved by the shared transform
+    dp->dev[aTask] = circleDeviation( pts, MCAD_POINT( idx, 0.0, dp->offset ), 1.0 + idx * 0.1 );
+    return;
+}
+
+
+void testCacheConcurrent( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: concurrent lookups of " << NARCS << " arcs with a shared transform\n";
+
+    IGES model;
+    IGES_ENTITY* ep;
+    CONCURRENT_DATA* dp = new CONCURRENT_DATA;
+    bool ok = model.NewEntity( ENT_TRANSFORMATION_MATRIX, &ep );
+    IGES_ENTITY_124* tx = ok ? (IGES_ENTITY_124*)ep : NULL;
+
+    dp->cache = model.GetTessCache();
+
+    for( int i = 0; i < NARCS && ok; ++i )
+    {
+        dp->arcs[i] = newArc( model, i, 0.0, 1.0 + i * 0.1 );
+        ok = ( NULL != dp->arcs[i] ) && dp->arcs[i]->SetTransform( tx );
+    }
+
+    if( !ok )
+        cerr << "  [FAIL]: could not create the entities\n";
+
+    // each round moves the shared transform so that all entries are stale
+    for( int round = 0; round < 8 && ok; ++round )
+    {
+        dp->offset = round * 0.5;
+        tx->T.T.z = dp->offset;
+        tx->Touch();
+
+        IGES_WORK_POOL::Run( NTASKS, lookupArc, dp, 8 );
+
+        for( int i = 0; i < NTASKS && ok; ++i )
+        {
+            if( dp->dev[i] < 0.0 || dp->dev[i] > 1e-9 )
+            {
+                cerr << "  [FAIL]: incorrect polyline for arc " << ( i % NARCS );
+                cerr << " in round " << round << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    delete dp;
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
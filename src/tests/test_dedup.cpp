@@ -0,0 +1,498 @@
+/*
+ * file: test_dedup.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of IGES::Deduplicate(). Models with duplicate
+ * Transformation Matrix (124), Color Definition (314) and NURBS
+ * Curve (126) entities are deduplicated and the number of merged
+ * entities, the sharing of the surviving entities and the geometry
+ * seen by the parents are checked.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <core/iges.h>
+#include <core/entity102.h>
+#include <core/entity110.h>
+#include <core/entity124.h>
+#include <core/entity126.h>
+#include <core/entity314.h>
+
+using namespace std;
+
+// number of lines which refer to each group of transforms
+#define NLINES 10
+
+// merge duplicate transforms, including transforms within chains
+void testTransforms( int& nTests, int& nFails );
+// merge duplicate colors
+void testColors( int& nTests, int& nFails );
+// merge duplicate NURBS curves within composite curves
+void testCurves( int& nTests, int& nFails );
+// merge entities whose values lie within tolerance on either side of
+// the boundary of a grid cell
+void testBoundary( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testTransforms( nTests, nFails );
+    testColors( nTests, nFails );
+    testCurves( nTests, nFails );
+    testBoundary( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+static size_t countType( IGES& aModel, int aType )
+{
+    size_t n = 0;
+    IGES_ENTITY* const* lp = NULL;
+
+    if( !aModel.GetEntitiesByType( aType, n, lp ) )
+        return 0;
+
+    return n;
+}
+
+
+static IGES_ENTITY_124* newTransform( IGES& aModel, IGES_ENTITY_124* aParent,
+    double aAngle, double aX )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_TRANSFORMATION_MATRIX, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_124* tp = (IGES_ENTITY_124*)ep;
+    tp->T.R.v[0][0] = cos( aAngle );
+    tp->T.R.v[0][1] = -sin( aAngle );
+    tp->T.R.v[1][0] = sin( aAngle );
+    tp->T.R.v[1][1] = cos( aAngle );
+    tp->T.T.x = aX;
+    tp->T.T.y = 2.0;
+    tp->T.T.z = -1.0;
+
+    if( NULL != aParent && !tp->SetTransform( aParent ) )
+        return NULL;
+
+    return tp;
+}
+
+
+static IGES_ENTITY_110* newLine( IGES& aModel, double aX )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_LINE, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_110* lp = (IGES_ENTITY_110*)ep;
+    lp->X1 = aX;
+    lp->Y1 = 1.0;
+    lp->Z1 = 0.5;
+    lp->X2 = aX + 1.0;
+    lp->Y2 = 3.0;
+    lp->Z2 = 0.0;
+
+    return lp;
+}
+
+
+// the start point of a line in model coordinates
+static MCAD_POINT worldStart( IGES_ENTITY_110* aLine )
+{
+    MCAD_POINT p( aLine->X1, aLine->Y1, aLine->Z1 );
+    IGES_ENTITY* tp = NULL;
+
+    if( aLine->GetTransform( &tp ) && NULL != tp )
+        p = ((IGES_ENTITY_124*)tp)->GetTransformMatrix() * p;
+
+    return p;
+}
+
+
+void testTransforms( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: duplicate transforms\n";
+
+    IGES model;
+    // 2 identical chains of 2 transforms and a distinct transform
+    IGES_ENTITY_124* b1 = newTransform( model, NULL, 0.3, 1.0 );
+    IGES_ENTITY_124* b2 = newTransform( model, NULL, 0.3, 1.0 );
+    IGES_ENTITY_124* c1 = b1 ? newTransform( model, b1, -0.7, 5.0 ) : NULL;
+    IGES_ENTITY_124* c2 = b2 ? newTransform( model, b2, -0.7, 5.0 ) : NULL;
+    IGES_ENTITY_124* d = newTransform( model, NULL, 1.1, -3.0 );
+    // a duplicate without parents is an independent object and is kept
+    IGES_ENTITY_124* u = newTransform( model, NULL, 1.1, -3.0 );
+    vector<IGES_ENTITY_110*> lines;
+    vector<MCAD_POINT> pts;
+    bool ok = ( NULL != c1 && NULL != c2 && NULL != d && NULL != u );
+
+    // lines refer to each chain, to the distinct transform and to
+    // their own copies of the distinct transform
+    for( int i = 0; i < 4 * NLINES && ok; ++i )
+    {
+        IGES_ENTITY_110* lp = newLine( model, i );
+        IGES_ENTITY_124* tp = NULL;
+
+        switch( i / NLINES )
+        {
+            case 0:
+                tp = c1;
+                break;
+
+            case 1:
+                tp = c2;
+                break;
+
+            case 2:
+                tp = d;
+                break;
+
+            default:
+                tp = newTransform( model, NULL, 1.1, -3.0 );
+                break;
+        }
+
+        if( NULL == lp || NULL == tp || !lp->SetTransform( tp ) )
+        {
+            ok = false;
+            break;
+        }
+
+        lines.push_back( lp );
+        pts.push_back( worldStart( lp ) );
+    }
+
+    if( !ok )
+    {
+        cerr << "  [FAIL]: could not create the entities\n";
+        ++nFails;
+        return;
+    }
+
+    IGES_DEDUP_STATS stats;
+
+    if( !model.Deduplicate( &stats ) )
+    {
+        cerr << "  [FAIL]: Deduplicate() failed\n";
+        ++nFails;
+        return;
+    }
+
+    // b2, c2 and the copies of d are merged
+    size_t nMerged = 2 + NLINES;
+
+    if( stats.nTransforms != nMerged || stats.nColors || stats.nCurves
+        || stats.nEntitiesIn - stats.nEntitiesOut != nMerged
+        || countType( model, ENT_TRANSFORMATION_MATRIX ) != 4 )
+    {
+        cerr << "  [FAIL]: merged " << stats.nTransforms << " transforms; expected ";
+        cerr << nMerged << "; " << countType( model, ENT_TRANSFORMATION_MATRIX );
+        cerr << " remain\n";
+        ok = false;
+    }
+
+    for( size_t i = 0; i < lines.size() && ok; ++i )
+    {
+        IGES_ENTITY* tp = NULL;
+        IGES_ENTITY* expected = ( i < 2 * NLINES ) ? (IGES_ENTITY*)c1 : (IGES_ENTITY*)d;
+        MCAD_POINT p = worldStart( lines[i] );
+
+        if( !lines[i]->GetTransform( &tp ) || tp != expected )
+        {
+            cerr << "  [FAIL]: line " << i << " does not refer to the surviving transform\n";
+            ok = false;
+        }
+        else if( fabs( p.x - pts[i].x ) > 1e-12 || fabs( p.y - pts[i].y ) > 1e-12
+            || fabs( p.z - pts[i].z ) > 1e-12 )
+        {
+            cerr << "  [FAIL]: the transformed line " << i << " has moved\n";
+            ok = false;
+        }
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testColors( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: duplicate colors\n";
+
+    IGES model;
+    vector<IGES_ENTITY*> colors;
+    bool ok = true;
+
+    // lines 0..3 are red, each with its own color, and line 4 is green;
+    // the last red color has no parents
+    for( int i = 0; i < 6 && ok; ++i )
+    {
+        IGES_ENTITY* ep;
+
+        if( !model.NewEntity( ENT_COLOR_DEFINITION, &ep ) )
+        {
+            ok = false;
+            break;
+        }
+
+        IGES_ENTITY_314* cp = (IGES_ENTITY_314*)ep;
+        cp->red = ( 4 == i ) ? 0.0 : 100.0;
+        cp->green = ( 4 == i ) ? 100.0 : 0.0;
+        cp->blue = 0.0;
+        colors.push_back( ep );
+
+        if( i < 5 )
+        {
+            IGES_ENTITY_110* lp = newLine( model, i );
+
+            if( NULL == lp || !lp->SetColor( ep ) )
+                ok = false;
+        }
+    }
+
+    IGES_DEDUP_STATS stats;
+
+    if( !ok || !model.Deduplicate( &stats ) )
+    {
+        cerr << "  [FAIL]: could not create and deduplicate the entities\n";
+        ++nFails;
+        return;
+    }
+
+    if( 3 != stats.nColors || stats.nTransforms || stats.nCurves
+        || countType( model, ENT_COLOR_DEFINITION ) != 3 )
+    {
+        cerr << "  [FAIL]: merged " << stats.nColors << " colors; expected 3\n";
+        ok = false;
+    }
+
+    // the surviving red color is shared by the 4 red lines
+    if( ok && ( 4 != colors[0]->getNRefs() || 1 != colors[4]->getNRefs()
+        || 0 != colors[5]->getNRefs() ) )
+    {
+        cerr << "  [FAIL]: the lines do not refer to the surviving colors\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testCurves( int& nTests, int& nFails )
+{
+    static const double knots[] = { 0, 0, 0, 1, 1, 1 };
+    static const double coeffs[] = { 0, 0, 0, 5, 10, 0, 10, 0, 0 };
+
+    ++nTests;
+    cerr << "* Test: duplicate NURBS curves\n";
+
+    IGES model;
+    vector<IGES_ENTITY_102*> composites;
+    bool ok = true;
+
+    // composite curves 0..4 each hold a copy of the same curve and
+    // composite curve 5 holds a curve with a different control point
+    for( int i = 0; i < 6 && ok; ++i )
+    {
+        IGES_ENTITY* ep;
+        IGES_ENTITY* cp;
+        double tc[9];
+
+        for( int j = 0; j < 9; ++j )
+            tc[j] = coeffs[j];
+
+        if( 5 == i )
+            tc[4] += 1e-3;
+
+        if( !model.NewEntity( ENT_NURBS_CURVE, &cp )
+            || !((IGES_ENTITY_126*)cp)->SetNURBSData( 3, 3, knots, tc, false, 0.0, 1.0 )
+            || !model.NewEntity( ENT_COMPOSITE_CURVE, &ep )
+            || !((IGES_ENTITY_102*)ep)->AddSegment( (IGES_CURVE*)((IGES_ENTITY_126*)cp) ) )
+        {
+            ok = false;
+            break;
+        }
+
+        composites.push_back( (IGES_ENTITY_102*)ep );
+    }
+
+    IGES_DEDUP_STATS stats;
+
+    if( !ok || !model.Deduplicate( &stats ) )
+    {
+        cerr << "  [FAIL]: could not create and deduplicate the entities\n";
+        ++nFails;
+        return;
+    }
+
+    if( 4 != stats.nCurves || stats.nTransforms || stats.nColors
+        || countType( model, ENT_NURBS_CURVE ) != 2 )
+    {
+        cerr << "  [FAIL]: merged " << stats.nCurves << " curves; expected 4\n";
+        ok = false;
+    }
+
+    IGES_CURVE* c0 = composites[0]->GetCurve( 0 );
+
+    for( size_t i = 0; i < composites.size() && ok; ++i )
+    {
+        IGES_CURVE* cp = composites[i]->GetCurve( 0 );
+        MCAD_POINT p;
+
+        if( 1 != composites[i]->GetNSegments() || ( cp == c0 ) != ( i < 5 ) )
+        {
+            cerr << "  [FAIL]: composite curve " << i << " does not refer to the expected curve\n";
+            ok = false;
+        }
+        else if( !composites[i]->GetEndPoint( p ) || fabs( p.x - 10.0 ) > 1e-12
+            || fabs( p.y ) > 1e-12 )
+        {
+            cerr << "  [FAIL]: incorrect end point of composite curve " << i << "\n";
+            ok = false;
+        }
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testBoundary( int& nTests, int& nFails )
+{
+    static const double knots[] = { 0, 0, 0, 1, 1, 1 };
+    static const double coeffs[] = { 0, 0, 0, 5, 10, 0, 10, 0, 0 };
+    // a tolerance which is exact in binary so that 1.0 and 3.0 lie
+    // exactly on the boundaries of the grid cells
+    const double tol = 1.0 / 4096.0;
+    // pairs of X translations; the first pair lies within tolerance and
+    // the second pair does not
+    const double tx[4] = { 1.0 - 0.4 * tol, 1.0 + 0.4 * tol, 3.0 - 0.6 * tol, 3.0 + 0.6 * tol };
+
+    ++nTests;
+    cerr << "* Test: duplicates on either side of a cell boundary\n";
+
+    IGES model;
+    model.globalData.minResolution = tol;
+    vector<IGES_ENTITY_110*> lines;
+    vector<IGES_ENTITY_102*> composites;
+    bool ok = true;
+
+    for( int i = 0; i < 4 && ok; ++i )
+    {
+        IGES_ENTITY_110* lp = newLine( model, i );
+        IGES_ENTITY_124* tp = newTransform( model, NULL, 0.0, tx[i] );
+
+        if( NULL == lp || NULL == tp || !lp->SetTransform( tp ) )
+            ok = false;
+
+        lines.push_back( lp );
+    }
+
+    // 2 curves whose first control points lie on either side of 0
+    for( int i = 0; i < 2 && ok; ++i )
+    {
+        IGES_ENTITY* ep;
+        IGES_ENTITY* cp;
+        double tc[9];
+
+        for( int j = 0; j < 9; ++j )
+            tc[j] = coeffs[j];
+
+        tc[0] = i ? 0.3 * tol : -0.3 * tol;
+
+        if( !model.NewEntity( ENT_NURBS_CURVE, &cp )
+            || !((IGES_ENTITY_126*)cp)->SetNURBSData( 3, 3, knots, tc, false, 0.0, 1.0 )
+            || !model.NewEntity( ENT_COMPOSITE_CURVE, &ep )
+            || !((IGES_ENTITY_102*)ep)->AddSegment( (IGES_CURVE*)((IGES_ENTITY_126*)cp) ) )
+            ok = false;
+        else
+            composites.push_back( (IGES_ENTITY_102*)ep );
+    }
+
+    IGES_DEDUP_STATS stats;
+
+    if( !ok || !model.Deduplicate( &stats ) )
+    {
+        cerr << "  [FAIL]: could not create and deduplicate the entities\n";
+        ++nFails;
+        return;
+    }
+
+    IGES_ENTITY* t[4];
+
+    for( int i = 0; i < 4; ++i )
+    {
+        t[i] = NULL;
+        lines[i]->GetTransform( &t[i] );
+    }
+
+    if( 1 != stats.nTransforms || 1 != stats.nCurves
+        || countType( model, ENT_TRANSFORMATION_MATRIX ) != 3
+        || countType( model, ENT_NURBS_CURVE ) != 1 )
+    {
+        cerr << "  [FAIL]: merged " << stats.nTransforms << " transforms and ";
+        cerr << stats.nCurves << " curves; expected 1 of each\n";
+        ok = false;
+    }
+    else if( t[0] != t[1] || t[2] == t[3] || NULL == t[2] || NULL == t[3] )
+    {
+        cerr << "  [FAIL]: the lines do not refer to the expected transforms\n";
+        ok = false;
+    }
+    else if( composites[0]->GetCurve( 0 ) != composites[1]->GetCurve( 0 ) )
+    {
+        cerr << "  [FAIL]: the composite curves do not share a curve\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
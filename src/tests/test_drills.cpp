@@ -0,0 +1,382 @@
+/*
+ * file: test_drills.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ *
+ */
+
+/*
+ *  This is a test of the merging of overlapping drill holes by idf2igs.
+ *  The bundles found by findDrillBundles() on a large random set of
+ *  drills are compared with those of an exhaustive search over all
+ *  pairs of drills in the order of the list, and mergeDrills() is
+ *  checked to produce one cutout per bundle, to keep the remaining
+ *  drills in order and to report invalid geometry.
+ */
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <cmath>
+#include <geom/mcad_elements.h>
+#include <geom/mcad_outline.h>
+#include <api/dll_mcad_segment.h>
+#include <api/dll_mcad_outline.h>
+#include <idf_drills.h>
+
+using namespace std;
+
+// number of random drills
+#define NDRILLS 3000
+// size of the board
+#define BOARD_X 200.0
+#define BOARD_Y 150.0
+
+// compare the bundles with those of an exhaustive search
+void testBundles( int& nTests, int& nFails );
+// merge a few drills into a cutout
+void testMerge( int& nTests, int& nFails );
+// check that a drill within another drill is reported
+void testNested( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testBundles( nTests, nFails );
+    testMerge( nTests, nFails );
+    testNested( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// deterministic pseudo-random number in the range [0, 1)
+static double rnd( void )
+{
+    static unsigned long seed = 12345;
+    seed = ( seed * 1103515245UL + 12345UL ) & 0x7fffffffUL;
+    return (double)seed / 2147483648.0;
+}
+
+
+// create a drill in the same manner as idf2igs
+static MCAD_SEGMENT* newDrill( double aX, double aY, double aRadius )
+{
+    DLL_MCAD_SEGMENT sp( false );
+    MCAD_POINT p[2];
+
+    sp.NewSegment();
+    p[0].x = aX;
+    p[0].y = aY;
+    p[0].z = 0.0;
+    p[1].x = aX + aRadius;
+    p[1].y = aY;
+    p[1].z = 0.0;
+    sp.SetParams( p[0], p[1], p[1], false );
+
+    MCAD_SEGMENT* dp = sp.GetRawPtr();
+    sp.Detach();
+    return dp;
+}
+
+
+// create random drills of a few sizes; drills which would be nested in
+// or nearly tangent to an earlier drill are not placed so that the
+// geometry is valid
+static void makeDrills( vector< MCAD_SEGMENT* >& aDrills )
+{
+    static const double radii[] = { 0.15, 0.3, 0.5, 1.2 };
+    vector< MCAD_POINT > ctr;
+    vector< double > rad;
+
+    while( (int)aDrills.size() < NDRILLS )
+    {
+        double r = radii[(int)( rnd() * 4.0 )];
+        double x;
+        double y;
+
+        // about a third of the drills are placed next to an earlier
+        // drill to produce chains of overlapping holes
+        if( !ctr.empty() && rnd() < 0.35 )
+        {
+            size_t k = (size_t)( rnd() * ctr.size() );
+            double a = rnd() * 2.0 * M_PI;
+            double d = ( rad[k] + r ) * ( 0.5 + 0.4 * rnd() );
+            x = ctr[k].x + d * cos( a );
+            y = ctr[k].y + d * sin( a );
+        }
+        else
+        {
+            x = rnd() * BOARD_X;
+            y = rnd() * BOARD_Y;
+        }
+
+        bool valid = true;
+
+        for( size_t i = 0; i < ctr.size() && valid; ++i )
+        {
+            double d = sqrt( ( ctr[i].x - x ) * ( ctr[i].x - x )
+                + ( ctr[i].y - y ) * ( ctr[i].y - y ) );
+
+            if( d < fabs( rad[i] - r ) + 0.01 || fabs( d - rad[i] - r ) < 0.01 )
+                valid = false;
+        }
+
+        if( !valid )
+            continue;
+
+        ctr.push_back( MCAD_POINT( x, y, 0.0 ) );
+        rad.push_back( r );
+        aDrills.push_back( newDrill( x, y, r ) );
+    }
+
+    return;
+}
+
+
+// returns true if two drills overlap; aError is set on invalid geometry
+static bool overlaps( MCAD_SEGMENT* aDrill0, MCAD_SEGMENT* aDrill1, bool& aError )
+{
+    DLL_MCAD_SEGMENT seg( false );
+    MCAD_POINT* ilist = NULL;
+    int nPoints = 0;
+    MCAD_INTERSECT_FLAG flag = MCAD_IFLAG_NONE;
+
+    seg.Attach( aDrill0 );
+    bool ok = seg.GetIntersections( aDrill1, ilist, nPoints, flag );
+    seg.Detach();
+
+    if( NULL != ilist )
+        delete [] ilist;
+
+    aError = ( !ok && flag );
+    return ok;
+}
+
+
+// the bundles as defined by the original exhaustive search: the first
+// drill which overlaps a later drill starts a bundle and each drill of
+// the bundle in turn collects all remaining drills which overlap it
+static bool bruteBundles( const vector< MCAD_SEGMENT* >& aDrills,
+    list< vector< size_t > >& aBundles )
+{
+    size_t nd = aDrills.size();
+    vector< char > used( nd, 0 );
+    bool error = false;
+
+    aBundles.clear();
+
+    for( size_t i = 0; i < nd; ++i )
+    {
+        if( used[i] )
+            continue;
+
+        size_t first = nd;
+
+        for( size_t j = i + 1; j < nd && nd == first; ++j )
+        {
+            if( !used[j] && overlaps( aDrills[i], aDrills[j], error ) )
+                first = j;
+
+            if( error )
+                return false;
+        }
+
+        if( nd == first )
+            continue;
+
+        aBundles.push_back( vector< size_t >() );
+        vector< size_t >& bundle = aBundles.back();
+        bundle.push_back( i );
+        bundle.push_back( first );
+        used[i] = 1;
+        used[first] = 1;
+
+        for( size_t k = 0; k < bundle.size(); ++k )
+        {
+            for( size_t j = 0; j < nd; ++j )
+            {
+                if( !used[j] && overlaps( aDrills[bundle[k]], aDrills[j], error ) )
+                {
+                    bundle.push_back( j );
+                    used[j] = 1;
+                }
+
+                if( error )
+                    return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static void killAll( vector< MCAD_SEGMENT* >& aDrills )
+{
+    list< MCAD_SEGMENT* > dl( aDrills.begin(), aDrills.end() );
+    killDrills( dl );
+    aDrills.clear();
+    return;
+}
+
+
+void testBundles( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: bundles of " << NDRILLS << " drills\n";
+
+    vector< MCAD_SEGMENT* > drills;
+    list< vector< size_t > > bundles;
+    list< vector< size_t > > expected;
+    bool ok = true;
+
+    makeDrills( drills );
+
+    if( !findDrillBundles( drills, bundles ) || !bruteBundles( drills, expected ) )
+    {
+        cerr << "  [FAIL]: invalid geometry was reported\n";
+        ok = false;
+    }
+    else if( bundles != expected )
+    {
+        cerr << "  [FAIL]: " << bundles.size() << " bundles; expected " << expected.size() << "\n";
+        ok = false;
+    }
+    else if( expected.size() < 50 )
+    {
+        // the test is of little value without a fair number of bundles
+        cerr << "  [FAIL]: only " << expected.size() << " bundles were produced\n";
+        ok = false;
+    }
+
+    killAll( drills );
+
+    if( ok )
+        cerr << "  [OK]: " << expected.size() << " bundles\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testMerge( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: merge drills into a cutout\n";
+
+    // a chain of 3 overlapping drills and 2 separate drills
+    list< MCAD_SEGMENT* > drills;
+    MCAD_SEGMENT* d0 = newDrill( 20.0, 20.0, 1.0 );
+    MCAD_SEGMENT* d1 = newDrill( 5.0, 5.0, 1.0 );
+    MCAD_SEGMENT* d2 = newDrill( 21.5, 20.0, 1.0 );
+    MCAD_SEGMENT* d3 = newDrill( 40.0, 5.0, 0.5 );
+    MCAD_SEGMENT* d4 = newDrill( 23.0, 20.5, 1.0 );
+    drills.push_back( d0 );
+    drills.push_back( d1 );
+    drills.push_back( d2 );
+    drills.push_back( d3 );
+    drills.push_back( d4 );
+
+    list< MCAD_OUTLINE* > cutouts;
+    bool error = true;
+    bool ok = mergeDrills( drills, cutouts, error );
+
+    if( !ok || error || cutouts.size() != 1 )
+    {
+        cerr << "  [FAIL]: " << cutouts.size() << " cutouts; expected 1\n";
+        ok = false;
+    }
+    else if( drills.size() != 2 || drills.front() != d1 || drills.back() != d3 )
+    {
+        cerr << "  [FAIL]: the separate drills were not kept in order\n";
+        ok = false;
+    }
+    else
+    {
+        // the cutout covers the centers of the merged drills only
+        static const double pts[][3] = { { 20.0, 20.0, 1 }, { 21.5, 20.0, 1 },
+            { 23.0, 20.5, 1 }, { 19.2, 20.0, 1 }, { 5.0, 5.0, 0 }, { 20.0, 22.0, 0 } };
+        DLL_MCAD_OUTLINE op( false );
+        op.Attach( cutouts.front() );
+
+        for( int i = 0; i < 6 && ok; ++i )
+        {
+            bool err = false;
+            bool inside = op.IsInside( MCAD_POINT( pts[i][0], pts[i][1], 0.0 ), err );
+
+            if( err || inside != ( pts[i][2] != 0 ) )
+            {
+                cerr << "  [FAIL]: point " << i << " is " << ( inside ? "inside" : "outside" );
+                cerr << " the cutout\n";
+                ok = false;
+            }
+        }
+
+        op.Detach();
+    }
+
+    killDrills( drills );
+    killCutouts( cutouts );
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testNested( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: drill within a drill\n";
+
+    list< MCAD_SEGMENT* > drills;
+    drills.push_back( newDrill( 10.0, 10.0, 1.0 ) );
+    drills.push_back( newDrill( 10.2, 10.0, 0.3 ) );
+    drills.push_back( newDrill( 30.0, 10.0, 0.3 ) );
+
+    list< MCAD_OUTLINE* > cutouts;
+    bool error = false;
+    bool ok = true;
+
+    if( mergeDrills( drills, cutouts, error ) || !error )
+    {
+        cerr << "  [FAIL]: invalid geometry was not reported\n";
+        ok = false;
+    }
+
+    killDrills( drills );
+    killCutouts( cutouts );
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
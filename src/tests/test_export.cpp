@@ -0,0 +1,337 @@
+/*
+ * file: test_export.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of IGES::Export(). Many small models are exported
+ * into a single assembly to ensure that every entity is transferred
+ * exactly once, and the scale and unit conversions applied during the
+ * transfer are checked against the expected coordinates.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <set>
+#include <cmath>
+#include <core/iges.h>
+#include <core/entity110.h>
+#include <core/entity144.h>
+#include <core/entity308.h>
+
+using namespace std;
+
+// number of parts exported into the assembly
+#define NPARTS 2000
+
+// export many parts into one assembly and check the membership of all entities
+void testExportMany( int& nTests, int& nFails );
+// check that duplicate additions of entities are ignored
+void testDuplicates( int& nTests, int& nFails );
+// check the scale and unit conversion of exported entities
+void testExportScale( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testExportMany( nTests, nFails );
+    testDuplicates( nTests, nFails );
+    testExportScale( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// create a part consisting of a line and an (empty) trimmed surface;
+// the trimmed surface makes the part eligible for packaging by Export()
+static bool makePart( IGES& aModel, double aX, IGES_ENTITY_110** aLine )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_LINE, &ep ) )
+        return false;
+
+    IGES_ENTITY_110* lp = (IGES_ENTITY_110*)ep;
+    lp->X1 = aX;
+    lp->Y1 = 1.0;
+    lp->Z1 = 0.0;
+    lp->X2 = aX + 1.0;
+    lp->Y2 = 2.0;
+    lp->Z2 = 0.0;
+
+    if( NULL != aLine )
+        *aLine = lp;
+
+    if( !aModel.NewEntity( ENT_TRIMMED_PARAMETRIC_SURFACE, &ep ) )
+        return false;
+
+    return true;
+}
+
+
+// count all entities in the model and the number of unique entities
+static size_t countEntities( IGES& aModel, set<IGES_ENTITY*>* aUnique )
+{
+    static const int types[] = { ENT_LINE, ENT_TRIMMED_PARAMETRIC_SURFACE,
+        ENT_SUBFIGURE_DEFINITION };
+    size_t total = 0;
+
+    for( size_t i = 0; i < sizeof( types ) / sizeof( types[0] ); ++i )
+    {
+        size_t n = 0;
+        IGES_ENTITY* const* lp = NULL;
+
+        if( !aModel.GetEntitiesByType( types[i], n, lp ) )
+            continue;
+
+        total += n;
+
+        if( NULL != aUnique )
+            aUnique->insert( lp, lp + n );
+    }
+
+    return total;
+}
+
+
+void testExportMany( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: export " << NPARTS << " parts into an assembly\n";
+
+    IGES assy;
+    vector<IGES_ENTITY_308*> packages;
+    bool ok = true;
+
+    for( int i = 0; i < NPARTS && ok; ++i )
+    {
+        IGES part;
+        IGES_ENTITY_308* p308 = NULL;
+
+        if( !makePart( part, i * 2.0, NULL ) || !part.Export( &assy, &p308 )
+            || NULL == p308 )
+        {
+            cerr << "  [FAIL]: could not export part " << i << "\n";
+            ok = false;
+            break;
+        }
+
+        packages.push_back( p308 );
+
+        if( 0 != countEntities( part, NULL ) )
+        {
+            cerr << "  [FAIL]: entities remain in part " << i << " after export\n";
+            ok = false;
+        }
+    }
+
+    if( ok )
+    {
+        set<IGES_ENTITY*> unique;
+        size_t total = countEntities( assy, &unique );
+
+        if( total != (size_t)NPARTS * 3 || unique.size() != total )
+        {
+            cerr << "  [FAIL]: expected " << NPARTS * 3 << " unique entities, found ";
+            cerr << unique.size() << " of " << total << "\n";
+            ok = false;
+        }
+
+        set<IGES_ENTITY*>::iterator sU = unique.begin();
+        set<IGES_ENTITY*>::iterator eU = unique.end();
+
+        while( sU != eU && ok )
+        {
+            if( (*sU)->GetParentIGES() != &assy )
+            {
+                cerr << "  [FAIL]: entity is not owned by the assembly\n";
+                ok = false;
+            }
+
+            ++sU;
+        }
+
+        for( size_t i = 0; i < packages.size() && ok; ++i )
+        {
+            size_t nDE = 0;
+            IGES_ENTITY** deList = NULL;
+
+            if( !packages[i]->GetDEList( nDE, deList ) || 1 != nDE
+                || deList[0]->GetEntityType() != ENT_TRIMMED_PARAMETRIC_SURFACE )
+            {
+                cerr << "  [FAIL]: Subfigure Definition " << i << " has ";
+                cerr << nDE << " members; expected 1\n";
+                ok = false;
+            }
+        }
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testDuplicates( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: duplicate additions to a model and a Subfigure Definition\n";
+
+    IGES model;
+    IGES_ENTITY* ep;
+    IGES_ENTITY_110* lp = NULL;
+    bool ok = makePart( model, 0.0, &lp );
+
+    if( ok )
+        ok = model.NewEntity( ENT_SUBFIGURE_DEFINITION, &ep );
+
+    IGES_ENTITY_308* p308 = ok ? (IGES_ENTITY_308*)ep : NULL;
+
+    // an entity created outside the model is added once only
+    IGES_ENTITY_110* extLine = new IGES_ENTITY_110( NULL );
+
+    if( ok && ( !model.AddEntity( lp ) || !model.AddEntity( extLine )
+        || !model.AddEntity( extLine ) ) )
+    {
+        cerr << "  [FAIL]: AddEntity() failed\n";
+        ok = false;
+    }
+
+    if( ok && ( !p308->AddDE( lp ) || !p308->AddDE( extLine )
+        || !p308->AddDE( lp ) || !p308->AddDE( extLine ) ) )
+    {
+        cerr << "  [FAIL]: AddDE() failed\n";
+        ok = false;
+    }
+
+    set<IGES_ENTITY*> unique;
+    size_t total = countEntities( model, &unique );
+
+    if( ok && ( 4 != total || unique.size() != total ) )
+    {
+        cerr << "  [FAIL]: expected 4 unique entities, found " << unique.size();
+        cerr << " of " << total << "\n";
+        ok = false;
+    }
+
+    size_t nDE = 0;
+    IGES_ENTITY** deList = NULL;
+
+    if( ok && ( !p308->GetDEList( nDE, deList ) || 2 != nDE
+        || 1 != lp->getNRefs() || 1 != extLine->getNRefs() ) )
+    {
+        cerr << "  [FAIL]: expected 2 members each with 1 parent, found " << nDE << "\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+// export a part in the given units and scale; return the start point of its line
+static bool exportLine( IGES_UNIT aPartUnit, double aPartScale, IGES_UNIT aAssyUnit,
+    double aAssyScale, MCAD_POINT& aPoint )
+{
+    IGES assy;
+    IGES part;
+    IGES_ENTITY_110* lp = NULL;
+    IGES_ENTITY_308* p308 = NULL;
+
+    assy.globalData.unitsFlag = aAssyUnit;
+    assy.globalData.modelScale = aAssyScale;
+    part.globalData.unitsFlag = aPartUnit;
+    part.globalData.modelScale = aPartScale;
+
+    if( !makePart( part, 1.0, &lp ) || !part.Export( &assy, &p308 ) || NULL == p308 )
+        return false;
+
+    aPoint.x = lp->X1;
+    aPoint.y = lp->Y1;
+    aPoint.z = lp->Z1;
+
+    return true;
+}
+
+
+void testExportScale( int& nTests, int& nFails )
+{
+    struct CASE
+    {
+        IGES_UNIT partUnit;
+        double    partScale;
+        IGES_UNIT assyUnit;
+        double    assyScale;
+        double    factor;
+        const char* name;
+    };
+
+    static const CASE cases[] = {
+        { UNIT_MM, 1.0, UNIT_MM, 1.0, 1.0, "no conversion" },
+        { UNIT_INCH, 1.0, UNIT_MM, 1.0, 25.4, "inch to mm" },
+        { UNIT_MM, 1.0, UNIT_MM, 2.0, 2.0, "model scale 2" },
+        { UNIT_INCH, 1.0, UNIT_MM, 0.5, 12.7, "inch to mm at model scale 0.5" },
+        { UNIT_MM, 1.0, UNIT_MM, 1.0e-9, 1.0, "rejected model scale 1e-9" },
+        { UNIT_MM, 1.0, UNIT_MM, 1.0e9, 1.0, "rejected model scale 1e9" },
+        { UNIT_INCH, 1.0, UNIT_MM, 1.0e9, 25.4, "inch to mm at rejected model scale" }
+    };
+
+    for( size_t i = 0; i < sizeof( cases ) / sizeof( cases[0] ); ++i )
+    {
+        ++nTests;
+        cerr << "* Test: export scale, " << cases[i].name << "\n";
+
+        MCAD_POINT p0;
+
+        if( !exportLine( cases[i].partUnit, cases[i].partScale, cases[i].assyUnit,
+            cases[i].assyScale, p0 ) )
+        {
+            cerr << "  [FAIL]: could not export part\n";
+            ++nFails;
+            continue;
+        }
+
+        double f = cases[i].factor;
+
+        if( fabs( p0.x - f ) > 1e-9 * f || fabs( p0.y - f ) > 1e-9 * f
+            || fabs( p0.z ) > 1e-12 )
+        {
+            cerr << "  [FAIL]: expected (" << f << ", " << f << ", 0), got (";
+            cerr << p0.x << ", " << p0.y << ", " << p0.z << ")\n";
+            ++nFails;
+            continue;
+        }
+
+        cerr << "  [OK]\n";
+    }
+
+    return;
+}
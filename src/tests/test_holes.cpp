@@ -0,0 +1,434 @@
+/*
+ * file: test_holes.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the batch operations MCAD_OUTLINE::SubOutlines()
+ * and AddOutlines(). A set of random circles, some of which cross the
+ * edge of an outline or each other, is applied to one outline in a
+ * batch and to a copy of the outline one circle at a time; the edges,
+ * drill holes and unused circles of the two outlines must be the same.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <cmath>
+#include <geom/mcad_elements.h>
+#include <geom/mcad_segment.h>
+#include <geom/mcad_outline.h>
+
+using namespace std;
+
+// number of random circles per test
+#define NCIRCLES 400
+// tolerance for comparing coordinates
+#define TOL 1e-9
+
+// a circle to be applied to the outlines
+struct CIRCLE
+{
+    double x;
+    double y;
+    double r;
+};
+
+// subtract circles from a board as a batch and one at a time
+void testSubOutlines( int& nTests, int& nFails );
+// merge circles with a cutout as a batch and one at a time
+void testAddOutlines( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testSubOutlines( nTests, nFails );
+    testAddOutlines( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// deterministic pseudo-random number in the range [0, 1)
+static double rnd( void )
+{
+    static unsigned long seed = 4321;
+    seed = ( seed * 1103515245UL + 12345UL ) & 0x7fffffffUL;
+    return (double)seed / 2147483648.0;
+}
+
+
+static MCAD_SEGMENT* makeLine( double x0, double y0, double x1, double y1 )
+{
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+    sp->SetParams( MCAD_POINT( x0, y0, 0.0 ), MCAD_POINT( x1, y1, 0.0 ) );
+    return sp;
+}
+
+
+// create a rectangle from (x0, y0) to (x1, y1)
+static MCAD_OUTLINE* makeRect( double x0, double y0, double x1, double y1 )
+{
+    MCAD_OUTLINE* op = new MCAD_OUTLINE;
+    bool error = false;
+
+    op->AddSegment( makeLine( x0, y0, x1, y0 ), error );
+    op->AddSegment( makeLine( x1, y0, x1, y1 ), error );
+    op->AddSegment( makeLine( x1, y1, x0, y1 ), error );
+    op->AddSegment( makeLine( x0, y1, x0, y0 ), error );
+
+    return op;
+}
+
+
+static MCAD_SEGMENT* makeCircle( const CIRCLE& aCircle )
+{
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+    MCAD_POINT c( aCircle.x, aCircle.y, 0.0 );
+    MCAD_POINT p( aCircle.x + aCircle.r, aCircle.y, 0.0 );
+    sp->SetParams( c, p, p, false );
+    return sp;
+}
+
+
+static bool samePoint( const MCAD_POINT& p0, const MCAD_POINT& p1 )
+{
+    return fabs( p0.x - p1.x ) < TOL && fabs( p0.y - p1.y ) < TOL;
+}
+
+
+// create random circles within the given rectangle; about a third of the
+// circles are centered on an edge of the rectangle. If aOverlap is true
+// some circles are placed across an earlier circle, otherwise circles
+// are kept apart. Circles which would be nested in or nearly tangent to
+// another circle or which would pass near a corner are not placed.
+static void makeCircles( double x0, double y0, double x1, double y1, bool aOverlap,
+    vector<CIRCLE>& aCircles )
+{
+    static const double radii[] = { 0.2, 0.45, 0.8, 1.5 };
+
+    while( aCircles.size() < NCIRCLES )
+    {
+        CIRCLE c;
+        c.r = radii[(int)( rnd() * 4.0 )];
+        double u = rnd();
+
+        if( aOverlap && !aCircles.empty() && u < 0.3 )
+        {
+            const CIRCLE& k = aCircles[(size_t)( rnd() * aCircles.size() )];
+            double a = rnd() * 2.0 * M_PI;
+            double d = ( k.r + c.r ) * ( 0.5 + 0.4 * rnd() );
+            c.x = k.x + d * cos( a );
+            c.y = k.y + d * sin( a );
+        }
+        else if( u < 0.65 )
+        {
+            c.x = x0 + rnd() * ( x1 - x0 );
+            c.y = y0 + rnd() * ( y1 - y0 );
+        }
+        else
+        {
+            // place the center near a random edge
+            int e = (int)( rnd() * 4.0 );
+            double t = rnd();
+            double d = ( rnd() - 0.5 ) * c.r;
+
+            c.x = ( e < 2 ) ? x0 + t * ( x1 - x0 ) : ( e == 2 ? x0 : x1 ) + d;
+            c.y = ( e < 2 ) ? ( e == 0 ? y0 : y1 ) + d : y0 + t * ( y1 - y0 );
+        }
+
+        // stay clear of the corners and of tangency with the edges
+        double dx0 = fabs( c.x - x0 );
+        double dx1 = fabs( c.x - x1 );
+        double dy0 = fabs( c.y - y0 );
+        double dy1 = fabs( c.y - y1 );
+        double dx = dx0 < dx1 ? dx0 : dx1;
+        double dy = dy0 < dy1 ? dy0 : dy1;
+
+        if( ( dx < c.r + 0.05 && dy < c.r + 0.05 )
+            || fabs( dx - c.r ) < 0.05 || fabs( dy - c.r ) < 0.05 )
+            continue;
+
+        bool valid = true;
+
+        for( size_t i = 0; i < aCircles.size() && valid; ++i )
+        {
+            double d = sqrt( ( aCircles[i].x - c.x ) * ( aCircles[i].x - c.x )
+                + ( aCircles[i].y - c.y ) * ( aCircles[i].y - c.y ) );
+
+            if( d < fabs( aCircles[i].r - c.r ) + 0.05 || fabs( d - aCircles[i].r - c.r ) < 0.05 )
+                valid = false;
+
+            if( !aOverlap && d < aCircles[i].r + c.r )
+                valid = false;
+        }
+
+        if( valid )
+            aCircles.push_back( c );
+    }
+
+    return;
+}
+
+
+// compare the edges and drill holes of two outlines
+static bool sameOutline( MCAD_OUTLINE* aBatch, MCAD_OUTLINE* aSeq )
+{
+    list<MCAD_SEGMENT*>* s0 = aBatch->GetSegments();
+    list<MCAD_SEGMENT*>* s1 = aSeq->GetSegments();
+
+    if( s0->size() != s1->size() )
+    {
+        cerr << "  [FAIL]: " << s0->size() << " edge segments; expected " << s1->size() << "\n";
+        return false;
+    }
+
+    list<MCAD_SEGMENT*>::iterator sS0 = s0->begin();
+    list<MCAD_SEGMENT*>::iterator sS1 = s1->begin();
+    list<MCAD_SEGMENT*>::iterator eS0 = s0->end();
+    size_t idx = 0;
+
+    while( sS0 != eS0 )
+    {
+        if( (*sS0)->GetSegType() != (*sS1)->GetSegType()
+            || !samePoint( (*sS0)->GetStart(), (*sS1)->GetStart() )
+            || !samePoint( (*sS0)->GetEnd(), (*sS1)->GetEnd() )
+            || ( MCAD_SEGTYPE_LINE != (*sS0)->GetSegType()
+                && !samePoint( (*sS0)->GetCenter(), (*sS1)->GetCenter() ) ) )
+        {
+            cerr << "  [FAIL]: edge segment " << idx << " differs\n";
+            return false;
+        }
+
+        ++idx;
+        ++sS0;
+        ++sS1;
+    }
+
+    list<MCAD_SEGMENT*>* h0 = aBatch->GetDrillHoles();
+    list<MCAD_SEGMENT*>* h1 = aSeq->GetDrillHoles();
+
+    if( h0->size() != h1->size() )
+    {
+        cerr << "  [FAIL]: " << h0->size() << " drill holes; expected " << h1->size() << "\n";
+        return false;
+    }
+
+    list<MCAD_SEGMENT*>::iterator sH0 = h0->begin();
+    list<MCAD_SEGMENT*>::iterator sH1 = h1->begin();
+    list<MCAD_SEGMENT*>::iterator eH0 = h0->end();
+    idx = 0;
+
+    while( sH0 != eH0 )
+    {
+        if( !samePoint( (*sH0)->GetCenter(), (*sH1)->GetCenter() )
+            || fabs( (*sH0)->GetRadius() - (*sH1)->GetRadius() ) > TOL )
+        {
+            cerr << "  [FAIL]: drill hole " << idx << " differs\n";
+            return false;
+        }
+
+        ++idx;
+        ++sH0;
+        ++sH1;
+    }
+
+    return true;
+}
+
+
+static void deleteCircles( list<MCAD_SEGMENT*>& aCircles )
+{
+    while( !aCircles.empty() )
+    {
+        delete aCircles.back();
+        aCircles.pop_back();
+    }
+
+    return;
+}
+
+
+void testSubOutlines( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: subtract " << NCIRCLES << " circles from a board\n";
+
+    vector<CIRCLE> circles;
+    makeCircles( 0.0, 0.0, 100.0, 60.0, false, circles );
+
+    MCAD_OUTLINE* batch = makeRect( 0.0, 0.0, 100.0, 60.0 );
+    MCAD_OUTLINE* seq = makeRect( 0.0, 0.0, 100.0, 60.0 );
+    list<MCAD_SEGMENT*> cl;
+    bool error = false;
+    bool ok = true;
+    size_t nCut = 0;
+
+    // subtract the circles one at a time as idf2igs once did
+    for( size_t i = 0; i < circles.size() && ok; ++i )
+    {
+        MCAD_SEGMENT* cp = makeCircle( circles[i] );
+
+        if( seq->SubOutline( cp, error ) )
+        {
+            ++nCut;
+            continue;
+        }
+
+        if( error || !seq->AddCutout( cp, false, error ) )
+        {
+            delete cp;
+            cerr << "  [FAIL]: could not subtract circle " << i << "\n";
+            ok = false;
+        }
+    }
+
+    for( size_t i = 0; i < circles.size(); ++i )
+        cl.push_back( makeCircle( circles[i] ) );
+
+    if( ok && ( batch->SubOutlines( cl, error ) != ( nCut > 0 ) || error ) )
+    {
+        cerr << "  [FAIL]: the batch operation failed\n";
+        ok = false;
+    }
+
+    if( ok && !cl.empty() )
+    {
+        cerr << "  [FAIL]: " << cl.size() << " circles remain in the list\n";
+        ok = false;
+    }
+
+    if( ok && nCut < 20 )
+    {
+        cerr << "  [FAIL]: only " << nCut << " circles crossed the edge\n";
+        ok = false;
+    }
+
+    if( ok )
+        ok = sameOutline( batch, seq );
+
+    deleteCircles( cl );
+    delete batch;
+    delete seq;
+
+    if( ok )
+        cerr << "  [OK]: " << nCut << " circles cut the edge\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testAddOutlines( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: merge " << NCIRCLES << " circles with a cutout\n";
+
+    vector<CIRCLE> circles;
+    makeCircles( 20.0, 15.0, 80.0, 45.0, true, circles );
+
+    MCAD_OUTLINE* batch = makeRect( 20.0, 15.0, 80.0, 45.0 );
+    MCAD_OUTLINE* seq = makeRect( 20.0, 15.0, 80.0, 45.0 );
+    list<MCAD_SEGMENT*> cl;
+    vector<size_t> unused;
+    bool error = false;
+    bool ok = true;
+    size_t nMerged = 0;
+
+    // merge the circles one at a time as idf2igs once did
+    for( size_t i = 0; i < circles.size() && ok; ++i )
+    {
+        MCAD_SEGMENT* cp = makeCircle( circles[i] );
+
+        if( seq->AddOutline( cp, error ) )
+        {
+            ++nMerged;
+            continue;
+        }
+
+        delete cp;
+
+        if( error )
+        {
+            cerr << "  [FAIL]: could not merge circle " << i << "\n";
+            ok = false;
+        }
+
+        unused.push_back( i );
+    }
+
+    for( size_t i = 0; i < circles.size(); ++i )
+        cl.push_back( makeCircle( circles[i] ) );
+
+    if( ok && ( batch->AddOutlines( cl, error ) != ( nMerged > 0 ) || error ) )
+    {
+        cerr << "  [FAIL]: the batch operation failed\n";
+        ok = false;
+    }
+
+    // the unused circles remain in their original order
+    if( ok && cl.size() != unused.size() )
+    {
+        cerr << "  [FAIL]: " << cl.size() << " circles remain; expected " << unused.size() << "\n";
+        ok = false;
+    }
+
+    if( ok )
+    {
+        list<MCAD_SEGMENT*>::iterator sC = cl.begin();
+
+        for( size_t i = 0; i < unused.size() && ok; ++i, ++sC )
+        {
+            const CIRCLE& c = circles[unused[i]];
+
+            if( !samePoint( (*sC)->GetCenter(), MCAD_POINT( c.x, c.y, 0.0 ) ) )
+            {
+                cerr << "  [FAIL]: remaining circle " << i << " is out of order\n";
+                ok = false;
+            }
+        }
+    }
+
+    if( ok && nMerged < 20 )
+    {
+        cerr << "  [FAIL]: only " << nMerged << " circles were merged\n";
+        ok = false;
+    }
+
+    if( ok )
+        ok = sameOutline( batch, seq );
+
+    deleteCircles( cl );
+    delete batch;
+    delete seq;
+
+    if( ok )
+        cerr << "  [OK]: " << nMerged << " circles merged\n";
+    else
+        ++nFails;
+
+    return;
+}
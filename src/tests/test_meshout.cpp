@@ -0,0 +1,501 @@
+/*
+ * file: test_meshout.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of IGES_MESH_WRITER. A model of planar surfaces, some
+ * of which are placed by Singular Subfigure Instances (408), is written
+ * as STL, PLY and OBJ; each file is read back and its counts and total
+ * surface area are compared with the statistics of the writer and with
+ * the area of the model. The output is also checked to be independent
+ * of the number of threads and the size of the batch, and surfaces which
+ * cannot be meshed are checked to be reported.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <core/iges.h>
+#include <core/entity128.h>
+#include <core/entity144.h>
+#include <core/entity308.h>
+#include <core/entity408.h>
+#include <core/iges_meshout.h>
+
+using namespace std;
+
+// temporary output files
+#define TMPFILE0 "test_meshout_tmp0"
+#define TMPFILE1 "test_meshout_tmp1"
+// number of placements of the instanced surface
+#define NINSTANCES 6
+// relative tolerance of the area
+#define TOL 1e-6
+
+// write each format, read it back and compare it with the statistics
+void testFormats( int& nTests, int& nFails );
+// compare the output of a single thread with that of several threads
+void testThreads( int& nTests, int& nFails );
+// check that a surface which cannot be meshed is reported
+void testFailed( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testFormats( nTests, nFails );
+    testThreads( nTests, nFails );
+    testFailed( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+static const char* formatName( IGES_MESH_FORMAT aFormat )
+{
+    switch( aFormat )
+    {
+    case MESH_FORMAT_STL:
+        return "STL";
+
+    case MESH_FORMAT_PLY:
+        return "PLY";
+
+    default:
+        break;
+    }
+
+    return "OBJ";
+}
+
+
+// create a plane over [0, aSize] x [0, aSize]
+static IGES_ENTITY_144* newSurface( IGES& aModel, double aSize )
+{
+    double knots[] = { 0, 0, 1, 1 };
+    double coeffs[] = { 0, 0, 0, aSize, 0, 0, 0, aSize, 0, aSize, aSize, 0 };
+    IGES_ENTITY* ep;
+    IGES_ENTITY* sp;
+
+    if( !aModel.NewEntity( ENT_NURBS_SURFACE, &ep )
+        || !aModel.NewEntity( ENT_TRIMMED_PARAMETRIC_SURFACE, &sp ) )
+        return NULL;
+
+    if( !((IGES_ENTITY_128*)ep)->SetNURBSData( 2, 2, 2, 2, knots, knots, coeffs,
+        false, false, false, 0.0, 1.0, 0.0, 1.0 ) )
+        return NULL;
+
+    if( !((IGES_ENTITY_144*)sp)->SetPTS( ep ) )
+        return NULL;
+
+    return (IGES_ENTITY_144*)sp;
+}
+
+
+// build a model with two independent surfaces and a definition of two
+// surfaces placed NINSTANCES times with various scales; returns the
+// total area or a negative value on failure
+static double buildModel( IGES& aModel )
+{
+    IGES_ENTITY* ep;
+    IGES_ENTITY_144* s0 = newSurface( aModel, 10.0 );
+    IGES_ENTITY_144* s1 = newSurface( aModel, 3.0 );
+    IGES_ENTITY_144* s2 = newSurface( aModel, 1.0 );
+    IGES_ENTITY_144* s3 = newSurface( aModel, 2.0 );
+
+    if( NULL == s0 || NULL == s1 || NULL == s2 || NULL == s3
+        || !aModel.NewEntity( ENT_SUBFIGURE_DEFINITION, &ep ) )
+        return -1.0;
+
+    IGES_ENTITY_308* dp = (IGES_ENTITY_308*)ep;
+
+    if( !dp->AddDE( s2 ) || !dp->AddDE( s3 ) )
+        return -1.0;
+
+    double area = 100.0 + 9.0;
+
+    for( int i = 0; i < NINSTANCES; ++i )
+    {
+        if( !aModel.NewEntity( ENT_SINGULAR_SUBFIGURE_INSTANCE, &ep ) )
+            return -1.0;
+
+        IGES_ENTITY_408* ip = (IGES_ENTITY_408*)ep;
+
+        if( !ip->SetDE( dp ) )
+            return -1.0;
+
+        ip->X = 20.0 * i;
+        ip->Y = 5.0;
+        ip->Z = i;
+        ip->S = 1.0 + 0.5 * i;
+        area += 5.0 * ip->S * ip->S;
+    }
+
+    return area;
+}
+
+
+static bool readFile( const char* aFileName, string& aData )
+{
+    ifstream file( aFileName, ios::in | ios::binary );
+
+    if( !file.is_open() )
+        return false;
+
+    ostringstream os;
+    os << file.rdbuf();
+    aData = os.str();
+    return true;
+}
+
+
+static unsigned int getU32( const string& aData, size_t aOffset )
+{
+    const unsigned char* p = (const unsigned char*)aData.data() + aOffset;
+    return p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int)p[3] << 24 );
+}
+
+
+static float getFloat( const string& aData, size_t aOffset )
+{
+    unsigned int v = getU32( aData, aOffset );
+    float f;
+    memcpy( &f, &v, 4 );
+    return f;
+}
+
+
+static double triArea( const MCAD_POINT& p0, const MCAD_POINT& p1, const MCAD_POINT& p2 )
+{
+    MCAD_POINT e0 = p1 - p0;
+    MCAD_POINT e1 = p2 - p0;
+    double x = e0.y * e1.z - e0.z * e1.y;
+    double y = e0.z * e1.x - e0.x * e1.z;
+    double z = e0.x * e1.y - e0.y * e1.x;
+    return 0.5 * sqrt( x * x + y * y + z * z );
+}
+
+
+// read back a file; retrieves the number of parts (OBJ only), vertices and
+// triangles and the total area of the triangles
+static bool readMesh( const char* aFileName, IGES_MESH_FORMAT aFormat, size_t& aNParts,
+    size_t& aNVertices, size_t& aNTriangles, double& aArea )
+{
+    string data;
+    aNParts = 0;
+    aNVertices = 0;
+    aNTriangles = 0;
+    aArea = 0.0;
+
+    if( !readFile( aFileName, data ) )
+        return false;
+
+    if( MESH_FORMAT_STL == aFormat )
+    {
+        if( data.size() < 84 )
+            return false;
+
+        aNTriangles = getU32( data, 80 );
+        aNVertices = aNTriangles * 3;
+
+        if( data.size() != 84 + 50 * aNTriangles )
+            return false;
+
+        for( size_t i = 0; i < aNTriangles; ++i )
+        {
+            MCAD_POINT p[3];
+            size_t off = 84 + 50 * i + 12;
+
+            for( int j = 0; j < 3; ++j, off += 12 )
+                p[j] = MCAD_POINT( getFloat( data, off ), getFloat( data, off + 4 ),
+                                   getFloat( data, off + 8 ) );
+
+            aArea += triArea( p[0], p[1], p[2] );
+        }
+
+        return true;
+    }
+
+    if( MESH_FORMAT_PLY == aFormat )
+    {
+        size_t hend = data.find( "end_header\n" );
+        size_t ov = data.find( "element vertex " );
+        size_t of = data.find( "element face " );
+
+        if( string::npos == hend || string::npos == ov || string::npos == of )
+            return false;
+
+        aNVertices = strtoul( data.c_str() + ov + 15, NULL, 10 );
+        aNTriangles = strtoul( data.c_str() + of + 13, NULL, 10 );
+
+        size_t off = hend + 11;
+
+        if( data.size() != off + 24 * aNVertices + 13 * aNTriangles )
+            return false;
+
+        vector<MCAD_POINT> vp( aNVertices );
+
+        for( size_t i = 0; i < aNVertices; ++i, off += 24 )
+            vp[i] = MCAD_POINT( getFloat( data, off ), getFloat( data, off + 4 ),
+                                getFloat( data, off + 8 ) );
+
+        for( size_t i = 0; i < aNTriangles; ++i, off += 13 )
+        {
+            unsigned int idx[3];
+
+            if( 3 != (unsigned char)data[off] )
+                return false;
+
+            for( int j = 0; j < 3; ++j )
+            {
+                idx[j] = getU32( data, off + 1 + 4 * j );
+
+                if( idx[j] >= aNVertices )
+                    return false;
+            }
+
+            aArea += triArea( vp[idx[0]], vp[idx[1]], vp[idx[2]] );
+        }
+
+        return true;
+    }
+
+    istringstream is( data );
+    string line;
+    vector<MCAD_POINT> vp;
+    size_t nNormals = 0;
+
+    while( getline( is, line ) )
+    {
+        if( !line.compare( 0, 2, "v " ) )
+        {
+            MCAD_POINT p;
+            sscanf( line.c_str() + 2, "%lf %lf %lf", &p.x, &p.y, &p.z );
+            vp.push_back( p );
+        }
+        else if( !line.compare( 0, 3, "vn " ) )
+        {
+            ++nNormals;
+        }
+        else if( !line.compare( 0, 2, "g " ) )
+        {
+            ++aNParts;
+        }
+        else if( !line.compare( 0, 2, "f " ) )
+        {
+            unsigned long idx[3];
+            unsigned long nrm[3];
+
+            if( 6 != sscanf( line.c_str() + 2, "%lu//%lu %lu//%lu %lu//%lu", &idx[0],
+                &nrm[0], &idx[1], &nrm[1], &idx[2], &nrm[2] ) )
+                return false;
+
+            for( int j = 0; j < 3; ++j )
+            {
+                // faces may only refer to the vertices of their own part
+                if( 0 == idx[j] || idx[j] > vp.size() || nrm[j] != idx[j] )
+                    return false;
+            }
+
+            aArea += triArea( vp[idx[0] - 1], vp[idx[1] - 1], vp[idx[2] - 1] );
+            ++aNTriangles;
+        }
+    }
+
+    aNVertices = vp.size();
+    return nNormals == aNVertices;
+}
+
+
+void testFormats( int& nTests, int& nFails )
+{
+    IGES model;
+    double area = buildModel( model );
+
+    for( int fmt = MESH_FORMAT_STL; fmt <= MESH_FORMAT_OBJ; ++fmt )
+    {
+        IGES_MESH_FORMAT format = (IGES_MESH_FORMAT)fmt;
+        ++nTests;
+        cerr << "* Test: " << formatName( format ) << " output\n";
+
+        if( area < 0.0 )
+        {
+            cerr << "  [FAIL]: could not create the model\n";
+            ++nFails;
+            continue;
+        }
+
+        IGES_MESH_WRITER writer;
+        size_t nParts, nVertices, nTriangles, nFailed;
+        size_t rParts, rVertices, rTriangles;
+        double rArea;
+        bool ok = true;
+
+        if( !writer.Write( &model, TMPFILE0, format, 4 ) )
+        {
+            cerr << "  [FAIL]: could not write the file\n";
+            ok = false;
+        }
+        else if( !readMesh( TMPFILE0, format, rParts, rVertices, rTriangles, rArea ) )
+        {
+            cerr << "  [FAIL]: could not read the file back\n";
+            ok = false;
+        }
+
+        writer.GetStats( nParts, nVertices, nTriangles, nFailed );
+
+        // every placement of every surface is a part
+        if( ok && ( nParts != 2 + 2 * NINSTANCES || nFailed || 0 == nTriangles ) )
+        {
+            cerr << "  [FAIL]: " << nParts << " parts and " << nFailed;
+            cerr << " failures were reported; expected " << ( 2 + 2 * NINSTANCES ) << " and 0\n";
+            ok = false;
+        }
+
+        if( ok && ( rVertices != nVertices || rTriangles != nTriangles
+            || ( MESH_FORMAT_OBJ == format && rParts != nParts ) ) )
+        {
+            cerr << "  [FAIL]: the file has " << rVertices << " vertices and " << rTriangles;
+            cerr << " triangles; expected " << nVertices << " and " << nTriangles << "\n";
+            ok = false;
+        }
+
+        if( ok && fabs( rArea - area ) > TOL * area )
+        {
+            cerr << "  [FAIL]: total area " << rArea << "; expected " << area << "\n";
+            ok = false;
+        }
+
+        remove( TMPFILE0 );
+
+        if( ok )
+            cerr << "  [OK]\n";
+        else
+            ++nFails;
+    }
+
+    return;
+}
+
+
+void testThreads( int& nTests, int& nFails )
+{
+    IGES model;
+    bool built = buildModel( model ) > 0.0;
+
+    for( int fmt = MESH_FORMAT_STL; fmt <= MESH_FORMAT_OBJ; ++fmt )
+    {
+        IGES_MESH_FORMAT format = (IGES_MESH_FORMAT)fmt;
+        ++nTests;
+        cerr << "* Test: " << formatName( format ) << " output with 1 and 4 threads\n";
+
+        IGES_MESH_WRITER w0;
+        IGES_MESH_WRITER w1;
+        string d0;
+        string d1;
+        bool ok = built;
+
+        // a small batch makes the parts of several batches complete out of order
+        w1.SetWindow( 3 );
+
+        if( !ok || !w0.Write( &model, TMPFILE0, format, 1 )
+            || !w1.Write( &model, TMPFILE1, format, 4 )
+            || !readFile( TMPFILE0, d0 ) || !readFile( TMPFILE1, d1 ) )
+        {
+            cerr << "  [FAIL]: could not write the files\n";
+            ok = false;
+        }
+        else if( d0.empty() || d0 != d1 )
+        {
+            cerr << "  [FAIL]: the files differ\n";
+            ok = false;
+        }
+
+        remove( TMPFILE0 );
+        remove( TMPFILE1 );
+
+        if( ok )
+            cerr << "  [OK]\n";
+        else
+            ++nFails;
+    }
+
+    return;
+}
+
+
+void testFailed( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: surface which cannot be meshed\n";
+
+    IGES model;
+    IGES_ENTITY* ep;
+    bool ok = buildModel( model ) > 0.0;
+
+    // a surface with no parametric surface cannot be meshed
+    if( !ok || !model.NewEntity( ENT_TRIMMED_PARAMETRIC_SURFACE, &ep ) )
+    {
+        cerr << "  [FAIL]: could not create the model\n";
+        ++nFails;
+        return;
+    }
+
+    IGES_MESH_WRITER writer;
+    size_t nParts, nVertices, nTriangles, nFailed;
+    size_t rParts, rVertices, rTriangles;
+    double rArea;
+
+    if( !writer.Write( &model, TMPFILE0, MESH_FORMAT_OBJ, 4 )
+        || !readMesh( TMPFILE0, MESH_FORMAT_OBJ, rParts, rVertices, rTriangles, rArea ) )
+    {
+        cerr << "  [FAIL]: could not write the file\n";
+        ok = false;
+    }
+
+    writer.GetStats( nParts, nVertices, nTriangles, nFailed );
+
+    // the remaining surfaces are written
+    if( ok && ( nFailed != 1 || nParts != 2 + 2 * NINSTANCES || rParts != nParts ) )
+    {
+        cerr << "  [FAIL]: " << nParts << " parts and " << nFailed << " failures were reported";
+        cerr << "; expected " << ( 2 + 2 * NINSTANCES ) << " and 1\n";
+        ok = false;
+    }
+
+    remove( TMPFILE0 );
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
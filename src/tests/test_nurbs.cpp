@@ -0,0 +1,847 @@
+/*
+ * file: test_nurbs.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test and benchmark of the NURBS curve and surface
+ * evaluators. Surfaces with a linear parameterization, exact circles
+ * and cylinders represented by rational splines and a Bezier curve
+ * are evaluated and the results tested against the analytic values;
+ * the derivatives of random rational splines are tested against
+ * finite differences and the scattered point evaluator is tested
+ * against the grid evaluator. The grid evaluator is then timed on cubic
+ * control nets of various sizes and the curve evaluator is timed on
+ * cubic curves, both as a single batch and one point per call; when
+ * built with SISL the curves are also evaluated one point at a time
+ * by s1225 for comparison. The throughput is reported in points per
+ * second.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <libigesconf.h>
+#include <geom/mcad_nurbs.h>
+
+#ifdef USE_SISL
+#include <sisl.h>
+#endif
+
+using namespace std;
+
+// order of the test surfaces
+#define ORDER 4
+// number of U and V parameters in each evaluated grid
+#define GRID 100
+// number of parameters in each evaluated curve batch
+#define NCURVE ( GRID * GRID )
+// minimum duration (seconds) of each benchmark
+#define MIN_TIME 0.25
+
+struct SURFACE
+{
+    int nc;                 // control points in U and in V
+    bool rational;
+    vector<double> knots;
+    vector<double> coeffs;
+};
+
+// create a clamped uniform surface with nc x nc control points; the control
+// points are placed at the Greville abscissae so that S(u, v) = (u, v, z(u, v))
+void makeSurface( SURFACE& aSurf, int aNC, bool aRational, double aZNoise );
+// evaluate the test surfaces and check the results
+void testSurfaces( int& nTests, int& nFails );
+// evaluate a rational full circle and check it against the analytic circle
+void testCircle( int& nTests, int& nFails );
+// evaluate a cubic Bezier curve and check it against the Bernstein form
+void testBezier( int& nTests, int& nFails );
+// evaluate a rational full cylinder and check it against the analytic cylinder
+void testCylinder( int& nTests, int& nFails );
+// check the derivatives of random rational splines against finite differences
+void testRationalDerivs( int& nTests, int& nFails );
+// check the scattered point evaluator against the grid evaluator
+void testSurfacePoints( int& nTests, int& nFails );
+// time the grid evaluator on the given surface
+void benchSurface( const SURFACE& aSurf, bool aDerivs );
+// time the curve evaluator on the first row of the given control net
+void benchCurve( const SURFACE& aSurf, bool aDerivs );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testSurfaces( nTests, nFails );
+    testCircle( nTests, nFails );
+    testBezier( nTests, nFails );
+    testCylinder( nTests, nFails );
+    testRationalDerivs( nTests, nFails );
+    testSurfacePoints( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    int sizes[] = { 4, 10, 25, 50 };
+
+    cerr << "* Benchmark: " << GRID << " x " << GRID << " grid, order " << ORDER << "\n";
+
+    for( size_t i = 0; i < sizeof( sizes ) / sizeof( sizes[0] ); ++i )
+    {
+        SURFACE surf;
+
+        for( int r = 0; r < 2; ++r )
+        {
+            makeSurface( surf, sizes[i], r != 0, 0.1 );
+            benchSurface( surf, false );
+            benchSurface( surf, true );
+        }
+    }
+
+    cerr << "* Benchmark: " << NCURVE << " curve parameters, order " << ORDER << "\n";
+
+    for( size_t i = 0; i < sizeof( sizes ) / sizeof( sizes[0] ); ++i )
+    {
+        SURFACE surf;
+
+        for( int r = 0; r < 2; ++r )
+        {
+            makeSurface( surf, sizes[i], r != 0, 0.1 );
+            benchCurve( surf, false );
+            benchCurve( surf, true );
+        }
+    }
+
+    return nFails ? -1 : 0;
+}
+
+
+void makeSurface( SURFACE& aSurf, int aNC, bool aRational, double aZNoise )
+{
+    aSurf.nc = aNC;
+    aSurf.rational = aRational;
+    aSurf.knots.clear();
+    aSurf.coeffs.clear();
+
+    int nSpans = aNC - ORDER + 1;
+
+    for( int i = 0; i < aNC + ORDER; ++i )
+    {
+        if( i < ORDER )
+            aSurf.knots.push_back( 0.0 );
+        else if( i >= aNC )
+            aSurf.knots.push_back( 1.0 );
+        else
+            aSurf.knots.push_back( (double)( i - ORDER + 1 ) / nSpans );
+    }
+
+    vector<double> gr( aNC );
+
+    for( int i = 0; i < aNC; ++i )
+    {
+        double s = 0.0;
+
+        for( int k = 1; k < ORDER; ++k )
+            s += aSurf.knots[i + k];
+
+        gr[i] = s / ( ORDER - 1 );
+    }
+
+    for( int j = 0; j < aNC; ++j )
+    {
+        for( int i = 0; i < aNC; ++i )
+        {
+            aSurf.coeffs.push_back( gr[i] );
+            aSurf.coeffs.push_back( gr[j] );
+            aSurf.coeffs.push_back( aZNoise * ( rand() % 1000 ) / 1000.0 );
+
+            if( aRational )
+                aSurf.coeffs.push_back( 1.0 );
+        }
+    }
+
+    return;
+}
+
+
+void testSurfaces( int& nTests, int& nFails )
+{
+    int n = 7;
+    vector<double> par( n );
+
+    for( int i = 0; i < n; ++i )
+        par[i] = (double) i / ( n - 1 );
+
+    vector<MCAD_POINT> pt( n * n );
+    vector<MCAD_POINT> du( n * n );
+    vector<MCAD_POINT> dv( n * n );
+    vector<MCAD_POINT> nv( n * n );
+
+    for( int r = 0; r < 2; ++r )
+    {
+        SURFACE surf;
+        makeSurface( surf, 6, r != 0, 0.0 );
+
+        cerr << "* Test: planar " << ( r ? "rational" : "polynomial" ) << " surface\n";
+        ++nTests;
+
+        if( !EvalNURBSSurfaceGrid( ORDER, ORDER, surf.nc, surf.nc, &surf.knots[0],
+            &surf.knots[0], &surf.coeffs[0], surf.rational, n, &par[0], n, &par[0],
+            &pt[0], &du[0], &dv[0], &nv[0] ) )
+        {
+            cerr << "  [FAIL]: evaluation failed\n";
+            ++nFails;
+            continue;
+        }
+
+        double maxErr = 0.0;
+
+        for( int j = 0; j < n; ++j )
+        {
+            for( int i = 0; i < n; ++i )
+            {
+                int k = j * n + i;
+                double e[] = { pt[k].x - par[i], pt[k].y - par[j], pt[k].z,
+                               du[k].x - 1.0, du[k].y, du[k].z,
+                               dv[k].x, dv[k].y - 1.0, dv[k].z,
+                               nv[k].x, nv[k].y, nv[k].z - 1.0 };
+
+                for( size_t m = 0; m < sizeof( e ) / sizeof( e[0] ); ++m )
+                {
+                    if( fabs( e[m] ) > maxErr )
+                        maxErr = fabs( e[m] );
+                }
+            }
+        }
+
+        if( maxErr > 1e-12 )
+        {
+            cerr << "  [FAIL]: max. error " << maxErr << "\n";
+            ++nFails;
+        }
+        else
+        {
+            cerr << "  [OK]: max. error " << maxErr << "\n";
+        }
+    }
+
+    return;
+}
+
+
+// knots and control points of a full circle of the given radius about
+// (0, 0, aZ) made of 4 rational quadratic arcs with weights 1 and 1/sqrt(2)
+static void makeCircle( double aRadius, double aZ, vector<double>& aKnots,
+    vector<double>& aCoeffs )
+{
+    static const double kv[] = { 0, 0, 0, 0.25, 0.25, 0.5, 0.5, 0.75, 0.75, 1, 1, 1 };
+    static const double cp[9][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 },
+        { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }, { 1, 0 } };
+
+    aKnots.assign( kv, kv + 12 );
+    aCoeffs.clear();
+
+    for( int i = 0; i < 9; ++i )
+    {
+        aCoeffs.push_back( aRadius * cp[i][0] );
+        aCoeffs.push_back( aRadius * cp[i][1] );
+        aCoeffs.push_back( aZ );
+        aCoeffs.push_back( ( i & 1 ) ? M_SQRT1_2 : 1.0 );
+    }
+
+    return;
+}
+
+
+static void report( double aErr, double aTol, int& nFails )
+{
+    if( aErr > aTol )
+    {
+        cerr << "  [FAIL]: max. error " << aErr << "\n";
+        ++nFails;
+    }
+    else
+    {
+        cerr << "  [OK]: max. error " << aErr << "\n";
+    }
+
+    return;
+}
+
+
+static inline double dot( const MCAD_POINT& a, const MCAD_POINT& b )
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+
+static inline MCAD_POINT cross( const MCAD_POINT& a, const MCAD_POINT& b )
+{
+    return MCAD_POINT( a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x );
+}
+
+
+void testCircle( int& nTests, int& nFails )
+{
+    const double R = 5.0;
+    const double Z = 2.0;
+    const int n = 401;
+    vector<double> knots;
+    vector<double> coeffs;
+    vector<double> par( n );
+
+    makeCircle( R, Z, knots, coeffs );
+
+    for( int i = 0; i < n; ++i )
+        par[i] = (double) i / ( n - 1 );
+
+    vector<MCAD_POINT> pt( n );
+    vector<MCAD_POINT> d1( n );
+    vector<MCAD_POINT> d2( n );
+
+    cerr << "* Test: rational full circle and its derivatives\n";
+    ++nTests;
+
+    if( !EvalNURBSCurve( 3, 9, &knots[0], &coeffs[0], true, n, &par[0], &pt[0],
+        &d1[0], &d2[0] ) )
+    {
+        cerr << "  [FAIL]: evaluation failed\n";
+        ++nFails;
+        return;
+    }
+
+    // for a circle about c: |p - c| = R, (p - c).p' = 0, (p - c).p'' = -|p'|^2
+    // and the curvature |p' x p''| / |p'|^3 = 1 / R for any parameterization
+    double maxErr = 0.0;
+
+    for( int i = 0; i < n; ++i )
+    {
+        MCAD_POINT r( pt[i].x, pt[i].y, 0.0 );
+        double s = sqrt( dot( d1[i], d1[i] ) );
+        MCAD_POINT k = cross( d1[i], d2[i] );
+        double e[] = { sqrt( dot( r, r ) ) - R, pt[i].z - Z, d1[i].z, d2[i].z,
+                       dot( r, d1[i] ) / ( R * s ),
+                       ( dot( r, d2[i] ) + s * s ) / ( s * s ),
+                       ( sqrt( dot( k, k ) ) / ( s * s * s ) - 1.0 / R ) * R };
+
+        for( size_t m = 0; m < sizeof( e ) / sizeof( e[0] ); ++m )
+        {
+            if( fabs( e[m] ) > maxErr )
+                maxErr = fabs( e[m] );
+        }
+    }
+
+    report( maxErr, 1e-12, nFails );
+    return;
+}
+
+
+void testBezier( int& nTests, int& nFails )
+{
+    static const double knots[] = { 0, 0, 0, 0, 1, 1, 1, 1 };
+    static const double cp[4][3] = { { 0, 0, 0 }, { 1, 3, -1 }, { 4, -2, 2 }, { 5, 1, 0.5 } };
+    const int n = 103;
+    vector<double> par( n );
+
+    // include parameters outside the range, which are clamped
+    for( int i = 0; i < n; ++i )
+        par[i] = (double)( i - 1 ) / ( n - 3 );
+
+    vector<MCAD_POINT> pt( n );
+    vector<MCAD_POINT> d1( n );
+    vector<MCAD_POINT> d2( n );
+
+    cerr << "* Test: cubic Bezier curve and its derivatives\n";
+    ++nTests;
+
+    if( !EvalNURBSCurve( 4, 4, knots, &cp[0][0], false, n, &par[0], &pt[0],
+        &d1[0], &d2[0] ) )
+    {
+        cerr << "  [FAIL]: evaluation failed\n";
+        ++nFails;
+        return;
+    }
+
+    double maxErr = 0.0;
+
+    for( int i = 0; i < n; ++i )
+    {
+        double t = par[i] < 0.0 ? 0.0 : ( par[i] > 1.0 ? 1.0 : par[i] );
+        double s = 1.0 - t;
+        // Bernstein polynomials and their derivatives
+        double b[4] = { s * s * s, 3 * t * s * s, 3 * t * t * s, t * t * t };
+        double db[4] = { -3 * s * s, 3 * s * s - 6 * t * s, 6 * t * s - 3 * t * t, 3 * t * t };
+        double d2b[4] = { 6 * s, 18 * t - 12, 6 - 18 * t, 6 * t };
+        double e[9] = { pt[i].x, pt[i].y, pt[i].z, d1[i].x, d1[i].y, d1[i].z,
+                        d2[i].x, d2[i].y, d2[i].z };
+
+        for( int j = 0; j < 4; ++j )
+        {
+            for( int k = 0; k < 3; ++k )
+            {
+                e[k] -= b[j] * cp[j][k];
+                e[3 + k] -= db[j] * cp[j][k];
+                e[6 + k] -= d2b[j] * cp[j][k];
+            }
+        }
+
+        for( int m = 0; m < 9; ++m )
+        {
+            if( fabs( e[m] ) > maxErr )
+                maxErr = fabs( e[m] );
+        }
+    }
+
+    report( maxErr, 1e-12, nFails );
+    return;
+}
+
+
+void testCylinder( int& nTests, int& nFails )
+{
+    const double R = 3.0;
+    const double H = 7.0;
+    const int n = 41;
+    vector<double> kU;
+    vector<double> circle;
+    double kV[] = { 0, 0, 1, 1 };
+    vector<double> coeffs;
+
+    makeCircle( R, 0.0, kU, circle );
+
+    // the circle at z = 0 followed by the circle at z = H
+    for( int j = 0; j < 2; ++j )
+    {
+        for( int i = 0; i < 9; ++i )
+        {
+            coeffs.push_back( circle[4 * i] );
+            coeffs.push_back( circle[4 * i + 1] );
+            coeffs.push_back( j * H );
+            coeffs.push_back( circle[4 * i + 3] );
+        }
+    }
+
+    vector<double> par( n );
+
+    for( int i = 0; i < n; ++i )
+        par[i] = (double) i / ( n - 1 );
+
+    vector<MCAD_POINT> pt( n * n );
+    vector<MCAD_POINT> du( n * n );
+    vector<MCAD_POINT> dv( n * n );
+    vector<MCAD_POINT> nv( n * n );
+
+    cerr << "* Test: rational full cylinder\n";
+    ++nTests;
+
+    if( !EvalNURBSSurfaceGrid( 3, 2, 9, 2, &kU[0], kV, &coeffs[0], true, n, &par[0],
+        n, &par[0], &pt[0], &du[0], &dv[0], &nv[0] ) )
+    {
+        cerr << "  [FAIL]: evaluation failed\n";
+        ++nFails;
+        return;
+    }
+
+    double maxErr = 0.0;
+
+    for( int j = 0; j < n; ++j )
+    {
+        for( int i = 0; i < n; ++i )
+        {
+            int k = j * n + i;
+            MCAD_POINT r( pt[k].x / R, pt[k].y / R, 0.0 );
+            double s = sqrt( dot( du[k], du[k] ) );
+            // the normal is radial; its sense depends on the parameterization
+            double e[] = { sqrt( dot( r, r ) ) - 1.0, ( pt[k].z - par[j] * H ) / H,
+                           dot( r, du[k] ) / s, du[k].z / s,
+                           dv[k].x / H, dv[k].y / H, dv[k].z / H - 1.0,
+                           fabs( dot( r, nv[k] ) ) - 1.0, nv[k].z };
+
+            for( size_t m = 0; m < sizeof( e ) / sizeof( e[0] ); ++m )
+            {
+                if( fabs( e[m] ) > maxErr )
+                    maxErr = fabs( e[m] );
+            }
+        }
+    }
+
+    report( maxErr, 1e-12, nFails );
+    return;
+}
+
+
+// largest difference between a derivative and the central difference of
+// the values at the neighbouring parameters, relative to the derivative
+static double fdError( const MCAD_POINT& aDeriv, const MCAD_POINT& aP0,
+    const MCAD_POINT& aP1, double aStep )
+{
+    double e[3] = { aDeriv.x - ( aP1.x - aP0.x ) / ( 2.0 * aStep ),
+                    aDeriv.y - ( aP1.y - aP0.y ) / ( 2.0 * aStep ),
+                    aDeriv.z - ( aP1.z - aP0.z ) / ( 2.0 * aStep ) };
+
+    return sqrt( e[0] * e[0] + e[1] * e[1] + e[2] * e[2] )
+        / ( 1.0 + sqrt( dot( aDeriv, aDeriv ) ) );
+}
+
+
+void testRationalDerivs( int& nTests, int& nFails )
+{
+    const double h = 1e-5;
+    const int nc = 8;
+    srand( 1 );
+
+    // curve: random control points and weights in [0.5, 2]
+    SURFACE surf;
+    makeSurface( surf, nc, true, 1.0 );
+
+    for( size_t i = 3; i < surf.coeffs.size(); i += 4 )
+        surf.coeffs[i] = 0.5 + 1.5 * ( rand() % 1000 ) / 1000.0;
+
+    cerr << "* Test: derivatives of a random rational curve\n";
+    ++nTests;
+
+    double maxErr = 0.0;
+    bool ok = true;
+
+    // interior knots are at multiples of 0.2; the samples avoid them
+    for( int i = 0; i < 50 && ok; ++i )
+    {
+        double t[3];
+        t[1] = 0.01 + 0.98 * i / 49.0;
+
+        if( fabs( t[1] * 5.0 - floor( t[1] * 5.0 + 0.5 ) ) < 1e-3 )
+            t[1] += 2e-3;
+
+        t[0] = t[1] - h;
+        t[2] = t[1] + h;
+
+        MCAD_POINT pt[3];
+        MCAD_POINT d1[3];
+        MCAD_POINT d2[3];
+
+        // the first row of the control net serves as the curve
+        if( !EvalNURBSCurve( ORDER, nc, &surf.knots[0], &surf.coeffs[0], true, 3, t,
+            pt, d1, d2 ) )
+        {
+            ok = false;
+            break;
+        }
+
+        double e = max( fdError( d1[1], pt[0], pt[2], h ), fdError( d2[1], d1[0], d1[2], h ) );
+
+        if( e > maxErr )
+            maxErr = e;
+    }
+
+    if( !ok )
+    {
+        cerr << "  [FAIL]: evaluation failed\n";
+        ++nFails;
+    }
+    else
+    {
+        report( maxErr, 1e-6, nFails );
+    }
+
+    cerr << "* Test: derivatives of a random rational surface\n";
+    ++nTests;
+
+    const int n = 20;
+    vector<double> par( 3 * n );
+
+    for( int i = 0; i < n; ++i )
+    {
+        double u = 0.01 + 0.98 * i / ( n - 1 );
+
+        if( fabs( u * 5.0 - floor( u * 5.0 + 0.5 ) ) < 1e-3 )
+            u += 2e-3;
+
+        par[3 * i] = u - h;
+        par[3 * i + 1] = u;
+        par[3 * i + 2] = u + h;
+    }
+
+    int np = 3 * n;
+    vector<MCAD_POINT> pt( np * np );
+    vector<MCAD_POINT> du( np * np );
+    vector<MCAD_POINT> dv( np * np );
+    vector<MCAD_POINT> nv( np * np );
+
+    if( !EvalNURBSSurfaceGrid( ORDER, ORDER, nc, nc, &surf.knots[0], &surf.knots[0],
+        &surf.coeffs[0], true, np, &par[0], np, &par[0], &pt[0], &du[0], &dv[0], &nv[0] ) )
+    {
+        cerr << "  [FAIL]: evaluation failed\n";
+        ++nFails;
+        return;
+    }
+
+    maxErr = 0.0;
+
+    for( int j = 1; j < np; j += 3 )
+    {
+        for( int i = 1; i < np; i += 3 )
+        {
+            int k = j * np + i;
+            MCAD_POINT c = cross( du[k], dv[k] );
+            double lc = sqrt( dot( c, c ) );
+            MCAD_POINT en( nv[k].x - c.x / lc, nv[k].y - c.y / lc, nv[k].z - c.z / lc );
+            double e[] = { fdError( du[k], pt[k - 1], pt[k + 1], h ),
+                           fdError( dv[k], pt[k - np], pt[k + np], h ),
+                           sqrt( dot( en, en ) ) };
+
+            for( size_t m = 0; m < sizeof( e ) / sizeof( e[0] ); ++m )
+            {
+                if( e[m] > maxErr )
+                    maxErr = e[m];
+            }
+        }
+    }
+
+    report( maxErr, 1e-6, nFails );
+    return;
+}
+
+
+void testSurfacePoints( int& nTests, int& nFails )
+{
+    const int n = 23;
+    vector<double> par( n );
+
+    // include parameters outside the range, which are clamped
+    for( int i = 0; i < n; ++i )
+        par[i] = (double)( i - 1 ) / ( n - 3 );
+
+    vector<MCAD_POINT> grid( n * n );
+
+    // the pairs are visited in a scrambled order so that the knot spans
+    // change in both directions between consecutive points
+    vector<double> pu;
+    vector<double> pv;
+    vector<int> idx;
+
+    for( int k = 0; k < n * n; ++k )
+    {
+        int m = ( k * 97 ) % ( n * n );
+        pu.push_back( par[m % n] );
+        pv.push_back( par[m / n] );
+        idx.push_back( m );
+    }
+
+    vector<MCAD_POINT> pt( n * n );
+    srand( 2 );
+
+    for( int r = 0; r < 2; ++r )
+    {
+        SURFACE surf;
+        makeSurface( surf, 9, r != 0, 1.0 );
+
+        if( r )
+        {
+            for( size_t i = 3; i < surf.coeffs.size(); i += 4 )
+                surf.coeffs[i] = 0.5 + 1.5 * ( rand() % 1000 ) / 1000.0;
+        }
+
+        cerr << "* Test: scattered points on a " << ( r ? "rational" : "polynomial" )
+            << " surface\n";
+        ++nTests;
+
+        if( !EvalNURBSSurfaceGrid( ORDER, ORDER, surf.nc, surf.nc, &surf.knots[0],
+            &surf.knots[0], &surf.coeffs[0], surf.rational, n, &par[0], n, &par[0],
+            &grid[0] ) || !EvalNURBSSurfacePoints( ORDER, ORDER, surf.nc, surf.nc,
+            &surf.knots[0], &surf.knots[0], &surf.coeffs[0], surf.rational, n * n,
+            &pu[0], &pv[0], &pt[0] ) )
+        {
+            cerr << "  [FAIL]: evaluation failed\n";
+            ++nFails;
+            continue;
+        }
+
+        double maxErr = 0.0;
+
+        for( int k = 0; k < n * n; ++k )
+        {
+            const MCAD_POINT& g = grid[idx[k]];
+            double e[] = { pt[k].x - g.x, pt[k].y - g.y, pt[k].z - g.z };
+
+            for( int m = 0; m < 3; ++m )
+            {
+                if( fabs( e[m] ) > maxErr )
+                    maxErr = fabs( e[m] );
+            }
+        }
+
+        report( maxErr, 1e-12, nFails );
+    }
+
+    return;
+}
+
+
+void benchSurface( const SURFACE& aSurf, bool aDerivs )
+{
+    vector<double> par( GRID );
+
+    for( int i = 0; i < GRID; ++i )
+        par[i] = (double) i / ( GRID - 1 );
+
+    vector<MCAD_POINT> pt( GRID * GRID );
+    vector<MCAD_POINT> du( GRID * GRID );
+    vector<MCAD_POINT> dv( GRID * GRID );
+    vector<MCAD_POINT> nv( GRID * GRID );
+
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    double dt = 0.0;
+    long nPoints = 0;
+
+    do
+    {
+        EvalNURBSSurfaceGrid( ORDER, ORDER, aSurf.nc, aSurf.nc, &aSurf.knots[0],
+            &aSurf.knots[0], &aSurf.coeffs[0], aSurf.rational, GRID, &par[0],
+            GRID, &par[0], &pt[0], aDerivs ? &du[0] : NULL, aDerivs ? &dv[0] : NULL,
+            aDerivs ? &nv[0] : NULL );
+
+        nPoints += GRID * GRID;
+        dt = chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+    } while( dt < MIN_TIME );
+
+    cerr << "  " << setw( 2 ) << aSurf.nc << " x " << setw( 2 ) << aSurf.nc
+        << ( aSurf.rational ? " rational  " : " polynomial" )
+        << ( aDerivs ? " (points, derivatives, normals): " : " (points):                        " )
+        << fixed << setprecision( 2 ) << setw( 7 ) << ( nPoints / dt * 1e-6 )
+        << " Mpoints/s\n";
+    cerr.unsetf( ios::fixed );
+
+    return;
+}
+
+
+// print the throughput of one curve benchmark
+static void reportCurve( const char* aName, long aNPoints, double aTime )
+{
+    cerr << "    " << left << setw( 22 ) << aName << right << fixed << setprecision( 2 )
+        << setw( 7 ) << ( aNPoints / aTime * 1e-6 ) << " Mpoints/s\n";
+    cerr.unsetf( ios::fixed );
+
+    return;
+}
+
+
+void benchCurve( const SURFACE& aSurf, bool aDerivs )
+{
+    vector<double> par( NCURVE );
+
+    for( int i = 0; i < NCURVE; ++i )
+        par[i] = (double) i / ( NCURVE - 1 );
+
+    vector<MCAD_POINT> pt( NCURVE );
+    vector<MCAD_POINT> d1( NCURVE );
+    vector<MCAD_POINT> d2( NCURVE );
+    MCAD_POINT* p1 = aDerivs ? &d1[0] : NULL;
+    MCAD_POINT* p2 = aDerivs ? &d2[0] : NULL;
+
+    cerr << "  " << setw( 2 ) << aSurf.nc << ( aSurf.rational ? " rational  " : " polynomial" )
+        << ( aDerivs ? " (points, 1st and 2nd derivatives):\n" : " (points):\n" );
+
+    // the first row of the control net serves as the curve
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    double dt = 0.0;
+    long nPoints = 0;
+
+    do
+    {
+        EvalNURBSCurve( ORDER, aSurf.nc, &aSurf.knots[0], &aSurf.coeffs[0],
+            aSurf.rational, NCURVE, &par[0], &pt[0], p1, p2 );
+
+        nPoints += NCURVE;
+        dt = chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+    } while( dt < MIN_TIME );
+
+    reportCurve( "batch", nPoints, dt );
+
+    t0 = chrono::steady_clock::now();
+    nPoints = 0;
+
+    do
+    {
+        for( int i = 0; i < NCURVE; ++i )
+        {
+            EvalNURBSCurve( ORDER, aSurf.nc, &aSurf.knots[0], &aSurf.coeffs[0],
+                aSurf.rational, 1, &par[i], &pt[i], p1 ? p1 + i : NULL,
+                p2 ? p2 + i : NULL );
+        }
+
+        nPoints += NCURVE;
+        dt = chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+    } while( dt < MIN_TIME );
+
+    reportCurve( "one point per call", nPoints, dt );
+
+#ifdef USE_SISL
+    // SISL expects the control points of a rational curve in homogeneous form
+    int stride = aSurf.rational ? 4 : 3;
+    vector<double> coeffs( aSurf.coeffs.begin(), aSurf.coeffs.begin() + stride * aSurf.nc );
+
+    if( aSurf.rational )
+    {
+        for( int i = 0; i < aSurf.nc; ++i )
+        {
+            for( int k = 0; k < 3; ++k )
+                coeffs[4 * i + k] *= coeffs[4 * i + 3];
+        }
+    }
+
+    SISLCurve* pCurve = newCurve( aSurf.nc, ORDER, (double*)&aSurf.knots[0], &coeffs[0],
+        aSurf.rational ? 2 : 1, 3, 1 );
+
+    if( NULL == pCurve )
+    {
+        cerr << "    [INFO]: could not create the SISL curve\n";
+        return;
+    }
+
+    int nDer = aDerivs ? 2 : 0;
+    double der[9];
+    double curv[3];
+    double rad;
+    int left = 0;
+    int stat;
+
+    t0 = chrono::steady_clock::now();
+    nPoints = 0;
+
+    do
+    {
+        for( int i = 0; i < NCURVE; ++i )
+            s1225( pCurve, nDer, par[i], &left, der, curv, &rad, &stat );
+
+        nPoints += NCURVE;
+        dt = chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+    } while( dt < MIN_TIME );
+
+    freeCurve( pCurve );
+    reportCurve( "SISL s1225", nPoints, dt );
+#endif
+
+    return;
+}
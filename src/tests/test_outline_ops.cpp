@@ -0,0 +1,586 @@
+/*
+ * file: test_outline_ops.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the operations on the MCAD_OUTLINE object.
+ * The results are verified by testing sample points against the
+ * resulting outlines and by inspecting the resulting segments. The
+ * segments created by the operations on an outline are allocated from
+ * the segment pool of that outline; they are also checked after the
+ * outline which created them has been deleted.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <cmath>
+#include <geom/mcad_elements.h>
+#include <geom/mcad_helpers.h>
+#include <geom/mcad_segment.h>
+#include <geom/mcad_outline.h>
+
+using namespace std;
+
+// a point to test against an outline and the expected result
+struct SAMPLE
+{
+    double x;
+    double y;
+    bool inside;
+};
+
+// create a rectangle from (x0, y0) to (x1, y1)
+MCAD_OUTLINE* makeRect( double x0, double y0, double x1, double y1 );
+// test the sample points against an outline; returns the number of mismatches
+int checkSamples( MCAD_OUTLINE* aOutline, const SAMPLE* aList, size_t aSize );
+// report the result of a test
+void report( bool aResult, const char* aMsg, int& nFails );
+// operations on an outline whose segment index was built before the operation
+void testStaleIndex( int& nTests, int& nFails );
+// merging of collinear lines by MCAD_OUTLINE::Simplify()
+void testSimplifyLines( int& nTests, int& nFails );
+// merging of co-circular arcs by MCAD_OUTLINE::Simplify()
+void testSimplifyArcs( int& nTests, int& nFails );
+// merging of overlapping cutouts found via the cutout index
+void testCutoutIndex( int& nTests, int& nFails );
+// segments allocated from the pool of an outline which outlive the outline
+void testSegmentPool( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testStaleIndex( nTests, nFails );
+    testSimplifyLines( nTests, nFails );
+    testSimplifyArcs( nTests, nFails );
+    testCutoutIndex( nTests, nFails );
+    testSegmentPool( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+static MCAD_SEGMENT* makeLine( double x0, double y0, double x1, double y1 )
+{
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+    sp->SetParams( MCAD_POINT( x0, y0, 0.0 ), MCAD_POINT( x1, y1, 0.0 ) );
+    return sp;
+}
+
+
+MCAD_OUTLINE* makeRect( double x0, double y0, double x1, double y1 )
+{
+    MCAD_OUTLINE* op = new MCAD_OUTLINE;
+    bool error = false;
+
+    op->AddSegment( makeLine( x0, y0, x1, y0 ), error );
+    op->AddSegment( makeLine( x1, y0, x1, y1 ), error );
+    op->AddSegment( makeLine( x1, y1, x0, y1 ), error );
+    op->AddSegment( makeLine( x0, y1, x0, y0 ), error );
+
+    return op;
+}
+
+
+int checkSamples( MCAD_OUTLINE* aOutline, const SAMPLE* aList, size_t aSize )
+{
+    int nBad = 0;
+    bool error = false;
+
+    for( size_t i = 0; i < aSize; ++i )
+    {
+        MCAD_POINT p( aList[i].x, aList[i].y, 0.0 );
+
+        if( aOutline->IsInside( p, error ) != aList[i].inside || error )
+            ++nBad;
+    }
+
+    return nBad;
+}
+
+
+void report( bool aResult, const char* aMsg, int& nFails )
+{
+    if( aResult )
+    {
+        cerr << "  [OK]\n";
+        return;
+    }
+
+    cerr << "  [FAIL]: " << aMsg << "\n";
+    ++nFails;
+    return;
+}
+
+
+void testStaleIndex( int& nTests, int& nFails )
+{
+    // overlapping squares; the index of the operand is built by a query
+    // before the operation so the operation must not rely on it
+    static const SAMPLE subSamples[] = {
+        { 2.0, 2.0, true }, { 7.0, 2.0, true }, { 2.0, 7.0, true },
+        { 7.0, 7.0, false }, { 12.0, 12.0, false } };
+    static const SAMPLE addSamples[] = {
+        { 2.0, 2.0, true }, { 7.0, 7.0, true }, { 12.0, 12.0, true },
+        { 2.0, 12.0, false }, { 12.0, 2.0, false } };
+
+    for( int k = 0; k < 2; ++k )
+    {
+        bool sub = ( 0 == k );
+        MCAD_OUTLINE* a = makeRect( 0.0, 0.0, 10.0, 10.0 );
+        MCAD_OUTLINE* b = makeRect( 5.0, 5.0, 15.0, 15.0 );
+        bool error = false;
+
+        cerr << "* Test: " << ( sub ? "subtract" : "add" )
+            << " an outline with an indexed edge\n";
+        ++nTests;
+
+        a->IsInside( MCAD_POINT( 1.0, 1.0, 0.0 ), error );
+        b->IsInside( MCAD_POINT( 6.0, 6.0, 0.0 ), error );
+
+        bool res = sub ? a->SubOutline( b, error ) : a->AddOutline( b, error );
+
+        if( !res || error )
+        {
+            report( false, "operation failed", nFails );
+            delete b;
+        }
+        else
+        {
+            report( 0 == checkSamples( a, sub ? subSamples : addSamples, 5 )
+                && ( sub ? 6 : 8 ) == a->GetSegments()->size(), "incorrect result", nFails );
+        }
+
+        delete a;
+    }
+
+    return;
+}
+
+
+// create a closed polygon from the given vertices
+static MCAD_OUTLINE* makePolygon( const vector<MCAD_POINT>& aVertices )
+{
+    MCAD_OUTLINE* op = new MCAD_OUTLINE;
+    bool error = false;
+
+    for( size_t i = 0; i < aVertices.size(); ++i )
+    {
+        const MCAD_POINT& p0 = aVertices[i];
+        const MCAD_POINT& p1 = aVertices[( i + 1 ) % aVertices.size()];
+        op->AddSegment( makeLine( p0.x, p0.y, p1.x, p1.y ), error );
+    }
+
+    return op;
+}
+
+
+// maximum distance of the given points from an outline consisting of lines
+static double maxDeviation( const vector<MCAD_POINT>& aPoints, MCAD_OUTLINE* aOutline )
+{
+    list<MCAD_SEGMENT*>* segs = aOutline->GetSegments();
+    double maxD = 0.0;
+
+    for( size_t i = 0; i < aPoints.size(); ++i )
+    {
+        double dMin = 1e30;
+        list<MCAD_SEGMENT*>::iterator sS = segs->begin();
+
+        while( sS != segs->end() )
+        {
+            MCAD_POINT p0 = (*sS)->GetMStart();
+            MCAD_POINT p1 = (*sS)->GetMEnd();
+            double dx = p1.x - p0.x;
+            double dy = p1.y - p0.y;
+            double t = ( ( aPoints[i].x - p0.x ) * dx + ( aPoints[i].y - p0.y ) * dy )
+                / ( dx * dx + dy * dy );
+            t = ( t < 0.0 ) ? 0.0 : ( t > 1.0 ? 1.0 : t );
+            dx = p0.x + t * dx - aPoints[i].x;
+            dy = p0.y + t * dy - aPoints[i].y;
+            dMin = min( dMin, sqrt( dx * dx + dy * dy ) );
+            ++sS;
+        }
+
+        maxD = max( maxD, dMin );
+    }
+
+    return maxD;
+}
+
+
+void testSimplifyLines( int& nTests, int& nFails )
+{
+    double tol = 1e-6;
+    bool error = false;
+    MCAD_SIMPLIFY_STATS stats;
+    vector<MCAD_POINT> v;
+
+    // the bottom edge of a rectangle is split at points within the tolerance
+    v.push_back( MCAD_POINT( 0.0, 0.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 2.5, 1e-9, 0.0 ) );
+    v.push_back( MCAD_POINT( 5.0, -4e-7, 0.0 ) );
+    v.push_back( MCAD_POINT( 7.5, 0.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 10.0, 0.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 10.0, 4.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 0.0, 4.0, 0.0 ) );
+
+    cerr << "* Test: simplify near-collinear lines\n";
+    ++nTests;
+    MCAD_OUTLINE* op = makePolygon( v );
+    bool res = op->Simplify( tol, error, &stats );
+    report( res && !error && 3 == stats.nLines && 4 == op->GetSegments()->size()
+        && op->IsClosed() && maxDeviation( v, op ) <= tol, "lines were not merged", nFails );
+    delete op;
+
+    cerr << "* Test: simplify a kink beyond the tolerance\n";
+    ++nTests;
+    v[1].y = 0.0;
+    v[2].y = 1e-5;
+    op = makePolygon( v );
+    op->Simplify( tol, error, &stats );
+    report( !error && 0 == stats.nLines && 7 == op->GetSegments()->size(),
+        "the kink was removed", nFails );
+    delete op;
+
+    // the bottom edge is a shallow curve; each vertex is within the tolerance
+    // of the line through its neighbours but the whole edge is not
+    cerr << "* Test: simplify a slowly curving run of lines\n";
+    ++nTests;
+    v.clear();
+
+    for( int i = 0; i <= 40; ++i )
+    {
+        double x = 0.25 * i;
+        double t = ( x - 5.0 ) / 5.0;
+        v.push_back( MCAD_POINT( x, -8e-6 * ( 1.0 - t * t ), 0.0 ) );
+    }
+
+    v.push_back( MCAD_POINT( 10.0, 4.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 0.0, 4.0, 0.0 ) );
+    op = makePolygon( v );
+    res = op->Simplify( tol, error, &stats );
+    report( res && !error && op->GetSegments()->size() > 4 && op->IsClosed()
+        && maxDeviation( v, op ) <= tol, "deviation exceeds the tolerance", nFails );
+    delete op;
+
+    // a square which starts in the middle of an edge; the run across the
+    // start of the outline must also be merged
+    cerr << "* Test: simplify a run across the start of the outline\n";
+    ++nTests;
+    v.clear();
+    v.push_back( MCAD_POINT( 5.0, 0.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 10.0, 0.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 10.0, 10.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 0.0, 10.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 0.0, 0.0, 0.0 ) );
+    v.push_back( MCAD_POINT( 2.0, 0.0, 0.0 ) );
+    op = makePolygon( v );
+    res = op->Simplify( tol, error, &stats );
+
+    int nCorners = 0;
+    list<MCAD_SEGMENT*>::iterator sS = op->GetSegments()->begin();
+
+    while( sS != op->GetSegments()->end() )
+    {
+        MCAD_POINT p = (*sS)->GetMStart();
+
+        if( ( 0.0 == p.x || 10.0 == p.x ) && ( 0.0 == p.y || 10.0 == p.y ) )
+            ++nCorners;
+
+        ++sS;
+    }
+
+    report( res && !error && 2 == stats.nLines && 4 == op->GetSegments()->size()
+        && 4 == nCorners && op->IsClosed(), "the outline was not rotated", nFails );
+    delete op;
+
+    return;
+}
+
+
+void testSimplifyArcs( int& nTests, int& nFails )
+{
+    double tol = 1e-6;
+    double r = 5.0;
+    bool error = false;
+    MCAD_SIMPLIFY_STATS stats;
+
+    // a circle made of 6 arcs whose centers differ slightly in each
+    // direction; the arcs merge into 2 since an arc may not be closed
+    for( int k = 0; k < 2; ++k )
+    {
+        bool cw = ( 1 == k );
+        MCAD_OUTLINE* op = new MCAD_OUTLINE;
+
+        for( int i = 0; i < 6; ++i )
+        {
+            double a0 = ( cw ? -1.0 : 1.0 ) * M_PI * i / 3.0;
+            double a1 = ( cw ? -1.0 : 1.0 ) * M_PI * ( i + 1 ) / 3.0;
+            MCAD_POINT c( ( i % 2 ) ? 1e-9 : -1e-9, ( i % 3 ) ? 1e-9 : 0.0, 0.0 );
+            MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+            sp->SetParams( c, MCAD_POINT( r * cos( a0 ), r * sin( a0 ), 0.0 ),
+                MCAD_POINT( r * cos( a1 ), r * sin( a1 ), 0.0 ), cw );
+            op->AddSegment( sp, error );
+        }
+
+        cerr << "* Test: simplify near co-circular " << ( cw ? "CW" : "CCW" ) << " arcs\n";
+        ++nTests;
+
+        bool res = op->Simplify( tol, error, &stats );
+        bool ok = res && !error && 4 == stats.nArcs && 2 == op->GetSegments()->size()
+            && op->IsClosed();
+        double sweep = 0.0;
+        list<MCAD_SEGMENT*>::iterator sS = op->GetSegments()->begin();
+
+        while( ok && sS != op->GetSegments()->end() )
+        {
+            // note: the outline is reoriented when it is closed
+            ok = MCAD_SEGTYPE_ARC == (*sS)->GetSegType()
+                && op->GetSegments()->front()->IsCW() == (*sS)->IsCW()
+                && fabs( (*sS)->GetRadius() - r ) <= tol;
+            sweep += (*sS)->GetMEAngle() - (*sS)->GetMSAngle();
+            ++sS;
+        }
+
+        report( ok && fabs( fabs( sweep ) - 2.0 * M_PI ) < 1e-9, "arcs were not merged", nFails );
+        delete op;
+    }
+
+    // arcs on circles of different radius must not merge
+    cerr << "* Test: simplify arcs of different radius\n";
+    ++nTests;
+    MCAD_OUTLINE* op = new MCAD_OUTLINE;
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+    sp->SetParams( MCAD_POINT( 0.0, 0.0, 0.0 ), MCAD_POINT( 5.0, 0.0, 0.0 ),
+        MCAD_POINT( 0.0, 5.0, 0.0 ), false );
+    op->AddSegment( sp, error );
+    sp = new MCAD_SEGMENT;
+    sp->SetParams( MCAD_POINT( 0.0, 5.0 - 5.001, 0.0 ), MCAD_POINT( 0.0, 5.0, 0.0 ),
+        MCAD_POINT( -5.001, 5.0 - 5.001, 0.0 ), false );
+    op->AddSegment( sp, error );
+    op->AddSegment( makeLine( -5.001, 5.0 - 5.001, 5.0, 0.0 ), error );
+    op->Simplify( tol, error, &stats );
+    report( !error && 0 == stats.nArcs && 3 == op->GetSegments()->size(),
+        "arcs were merged", nFails );
+    delete op;
+
+    return;
+}
+
+
+void testCutoutIndex( int& nTests, int& nFails )
+{
+    // a grid of square cutouts; each is then extended by a second square
+    // which overlaps it and no other cutout so the cutouts must be merged
+    // while the number of cutouts is unchanged; the squares are offset in
+    // both directions since overlapping collinear edges are not supported
+    const int nGrid = 12;
+    MCAD_OUTLINE* board = makeRect( 0.0, 0.0, 200.0, 200.0 );
+    bool error = false;
+    bool ok = true;
+
+    cerr << "* Test: merge " << nGrid * nGrid << " overlapping cutouts\n";
+    ++nTests;
+
+    for( int pass = 0; pass < 2 && ok; ++pass )
+    {
+        for( int i = 0; i < nGrid && ok; ++i )
+        {
+            for( int j = 0; j < nGrid && ok; ++j )
+            {
+                double x = 10.0 + 15.0 * i + 2.0 * pass;
+                double y = 10.0 + 15.0 * j + 1.0 * pass;
+                MCAD_OUTLINE* op = makeRect( x, y, x + 4.0, y + 4.0 );
+
+                if( !board->AddCutout( op, true, error ) )
+                {
+                    delete op;
+                    ok = false;
+                }
+            }
+        }
+    }
+
+    const list<MCAD_OUTLINE*>* cl = board->GetCutouts();
+
+    if( ok && (size_t)( nGrid * nGrid ) != cl->size() )
+    {
+        cerr << "  [INFO]: " << cl->size() << " cutouts\n";
+        ok = false;
+    }
+
+    // each merged cutout is the union of [x, x + 4] x [y, y + 4] and
+    // [x + 2, x + 6] x [y + 1, y + 5] and holds 8 segments
+    for( int i = 0; i < nGrid && ok; ++i )
+    {
+        for( int j = 0; j < nGrid && ok; ++j )
+        {
+            double x = 10.0 + 15.0 * i;
+            double y = 10.0 + 15.0 * j;
+            int nIn[3] = { 0, 0, 0 };
+            list<MCAD_OUTLINE*>::const_iterator sC = cl->begin();
+            list<MCAD_OUTLINE*>::const_iterator eC = cl->end();
+
+            while( sC != eC )
+            {
+                if( (*sC)->IsInside( MCAD_POINT( x + 1.0, y + 0.5, 0.0 ), error ) )
+                    ++nIn[0];
+
+                if( (*sC)->IsInside( MCAD_POINT( x + 5.0, y + 4.5, 0.0 ), error ) )
+                    ++nIn[1];
+
+                if( (*sC)->IsInside( MCAD_POINT( x + 1.0, y + 4.5, 0.0 ), error ) )
+                    ++nIn[2];
+
+                ++sC;
+            }
+
+            if( 1 != nIn[0] || 1 != nIn[1] || 0 != nIn[2] )
+                ok = false;
+        }
+    }
+
+    list<MCAD_OUTLINE*>::const_iterator sC = cl->begin();
+    list<MCAD_OUTLINE*>::const_iterator eC = cl->end();
+
+    while( sC != eC && ok )
+    {
+        if( (*sC)->GetSegments()->size() != 8 )
+            ok = false;
+
+        ++sC;
+    }
+
+    report( ok && !error, "incorrect cutouts", nFails );
+    delete board;
+    return;
+}
+
+
+void testSegmentPool( int& nTests, int& nFails )
+{
+    // notches are cut into a rectangle and the resulting segments, most
+    // of which come from the pool of the rectangle, are moved to a second
+    // outline before the rectangle is deleted
+    const int nNotch = 100;
+    MCAD_OUTLINE* a = makeRect( 0.0, 0.0, 2.0 * nNotch + 2.0, 10.0 );
+    bool error = false;
+    bool ok = true;
+
+    cerr << "* Test: segments which outlive the outline which created them\n";
+    ++nTests;
+
+    // the radii differ so that no notch is tangent to the line through
+    // the test points of another notch
+    for( int i = 0; i < nNotch && ok; ++i )
+    {
+        MCAD_SEGMENT* cp = new MCAD_SEGMENT;
+        MCAD_POINT c( 2.0 * i + 2.0, 0.1, 0.0 );
+        double r = 0.5 + 0.002 * i;
+        cp->SetParams( c, MCAD_POINT( c.x + r, c.y, 0.0 ),
+            MCAD_POINT( c.x + r, c.y, 0.0 ), false );
+
+        if( !a->SubOutline( cp, error ) )
+        {
+            delete cp;
+            ok = false;
+        }
+    }
+
+    list<MCAD_SEGMENT*> segs;
+    vector<MCAD_POINT> ends;
+
+    if( ok )
+    {
+        segs.splice( segs.end(), *a->GetSegments() );
+        list<MCAD_SEGMENT*>::iterator sS = segs.begin();
+
+        while( sS != segs.end() )
+        {
+            ends.push_back( (*sS)->GetStart() );
+            ends.push_back( (*sS)->GetEnd() );
+            ++sS;
+        }
+    }
+
+    delete a;
+
+    // 4 sides, one arc per notch and one extra piece of the bottom edge
+    if( ok && segs.size() != (size_t)( 4 + 2 * nNotch ) )
+    {
+        cerr << "  [INFO]: " << segs.size() << " segments\n";
+        ok = false;
+    }
+
+    MCAD_OUTLINE* b = new MCAD_OUTLINE;
+
+    if( ok )
+    {
+        list<MCAD_SEGMENT*>::iterator sS = segs.begin();
+        size_t idx = 0;
+
+        while( sS != segs.end() && ok )
+        {
+            if( !PointMatches( (*sS)->GetStart(), ends[idx], 1e-12 )
+                || !PointMatches( (*sS)->GetEnd(), ends[idx + 1], 1e-12 ) )
+                ok = false;
+
+            idx += 2;
+            ++sS;
+        }
+    }
+
+    while( ok && !segs.empty() )
+    {
+        MCAD_SEGMENT* sp = segs.front();
+        segs.pop_front();
+
+        if( !b->AddSegment( sp, error ) )
+        {
+            delete sp;
+            ok = false;
+        }
+    }
+
+    while( !segs.empty() )
+    {
+        delete segs.front();
+        segs.pop_front();
+    }
+
+    static const SAMPLE samples[] = {
+        { 1.0, 5.0, true }, { 2.0, 0.2, false }, { 3.0, 0.2, true },
+        { 2.0 * nNotch, 0.2, false }, { 2.0 * nNotch + 1.0, 0.2, true },
+        { 1.0, 11.0, false } };
+
+    if( ok && ( !b->IsClosed() || checkSamples( b, samples, 6 ) ) )
+        ok = false;
+
+    delete b;
+    report( ok && !error, "incorrect segments", nFails );
+
+    return;
+}
@@ -0,0 +1,499 @@
+/*
+ * file: test_pcb.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the parallel calculation of the surfaces of a
+ * board by IGES_GEOM_PCB. A board with edge notches, cutouts and many
+ * drill holes is converted to walls and trimmed planes by a single
+ * thread and by several threads; the IGES files written from the two
+ * models must be the same apart from the Global section. The board is
+ * also written with the drill holes as instances of shared barrels;
+ * when read back the instances must be placed at the drill holes and
+ * the mesh of the board must match that of the plain output.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <core/iges.h>
+#include <core/entity144.h>
+#include <core/entity308.h>
+#include <core/entity408.h>
+#include <core/iges_meshout.h>
+#include <geom/mcad_elements.h>
+#include <geom/mcad_helpers.h>
+#include <geom/mcad_segment.h>
+#include <geom/iges_geom_pcb.h>
+
+using namespace std;
+
+// temporary output files
+#define TMPFILE0 "test_pcb_tmp0.igs"
+#define TMPFILE1 "test_pcb_tmp1.igs"
+#define TMPMESH0 "test_pcb_tmp0.stl"
+#define TMPMESH1 "test_pcb_tmp1.stl"
+// top and bottom heights of the board
+#define BTOP (0.8)
+#define BBOT (-0.8)
+// number of drill holes and of distinct drill sizes
+#define NDRILLS 76
+#define NSIZES 3
+// relative tolerance of the mesh area
+#define TOL 1e-6
+
+// compare the surfaces calculated by 1 thread and by several threads
+void testThreads( int& nTests, int& nFails );
+// read back the drill holes written as instances and compare the result
+// with the plain output
+void testInstances( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testThreads( nTests, nFails );
+    testInstances( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+static MCAD_SEGMENT* makeLine( double x0, double y0, double x1, double y1 )
+{
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+    sp->SetParams( MCAD_POINT( x0, y0, 0.0 ), MCAD_POINT( x1, y1, 0.0 ) );
+    return sp;
+}
+
+
+static MCAD_SEGMENT* makeCircle( double x, double y, double r )
+{
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+    MCAD_POINT c( x, y, 0.0 );
+    MCAD_POINT p( x + r, y, 0.0 );
+    sp->SetParams( c, p, p, false );
+    return sp;
+}
+
+
+// create a rectangle from (x0, y0) to (x1, y1) within the given outline
+static bool makeRect( MCAD_OUTLINE& aOutline, double x0, double y0, double x1, double y1 )
+{
+    bool error = false;
+
+    return aOutline.AddSegment( makeLine( x0, y0, x1, y0 ), error )
+        && aOutline.AddSegment( makeLine( x1, y0, x1, y1 ), error )
+        && aOutline.AddSegment( makeLine( x1, y1, x0, y1 ), error )
+        && aOutline.AddSegment( makeLine( x0, y1, x0, y0 ), error );
+}
+
+
+// create a 100 x 60 board with notches along the edge, 4 cutouts with
+// rounded notches and a grid of drill holes of 3 sizes; the board has
+// well over the number of segments which is processed by one thread
+static bool makeBoard( IGES_GEOM_PCB& aBoard, vector<MCAD_POINT>* aDrills = NULL )
+{
+    bool error = false;
+
+    if( !makeRect( aBoard, 0.0, 0.0, 100.0, 60.0 ) )
+        return false;
+
+    // the radii differ so that no notch is tangent to the line through
+    // the test points of another notch
+    for( int i = 0; i < 9; ++i )
+    {
+        double x = 10.0 * ( i + 1 );
+
+        if( !aBoard.SubOutline( makeCircle( x, 0.3, 1.5 + 0.05 * i ), error )
+            || !aBoard.SubOutline( makeCircle( x, 59.8, 1.0 + 0.05 * i ), error ) )
+            return false;
+    }
+
+    for( int i = 0; i < 4; ++i )
+    {
+        double x = 8.0 + 22.0 * i;
+        MCAD_OUTLINE* op = new MCAD_OUTLINE;
+
+        if( !makeRect( *op, x, 25.0, x + 12.0, 35.0 )
+            || !op->AddOutline( makeCircle( x + 6.0, 35.5, 2.0 ), error )
+            || !aBoard.AddCutout( op, true, error ) )
+        {
+            delete op;
+            return false;
+        }
+    }
+
+    static const double radii[] = { 0.3, 0.45, 0.6 };
+
+    for( int i = 0; i < 19; ++i )
+    {
+        for( int j = 0; j < 4; ++j )
+        {
+            double x = 5.0 + 5.0 * i;
+            double y = ( j < 2 ) ? 8.0 + 6.0 * j : 42.0 + 6.0 * ( j - 2 );
+            MCAD_SEGMENT* sp = makeCircle( x, y, radii[( i + j ) % 3] );
+
+            if( !aBoard.AddCutout( sp, false, error ) )
+            {
+                delete sp;
+                return false;
+            }
+
+            if( NULL != aDrills )
+                aDrills->push_back( MCAD_POINT( x, y, 0.0 ) );
+        }
+    }
+
+    return true;
+}
+
+
+// create the surfaces of the board with the given number of threads and
+// write them to a file; if aDrills is not NULL the drill holes are written
+// as instances and the centers of the holes are retrieved
+static bool writeBoard( const char* aFileName, int aNThreads, size_t& aNSurfaces,
+    vector<MCAD_POINT>* aDrills = NULL )
+{
+    IGES_GEOM_PCB board;
+    IGES model;
+    vector<IGES_ENTITY_144*> surfs;
+    vector<IGES_ENTITY_408*> holes;
+    bool error = false;
+
+    aNSurfaces = 0;
+
+    if( !makeBoard( board, aDrills ) )
+    {
+        cerr << "  [FAIL]: could not create the board\n";
+        return false;
+    }
+
+    bool ok = ( NULL == aDrills )
+        ? board.GetVerticalSurface( &model, error, surfs, BTOP, BBOT, aNThreads )
+        : board.GetVerticalSurface( &model, error, surfs, holes, BTOP, BBOT, aNThreads );
+
+    if( !ok || holes.size() != ( NULL == aDrills ? 0 : aDrills->size() )
+        || !board.GetTrimmedPlane( &model, error, surfs, BTOP, false, aNThreads )
+        || !board.GetTrimmedPlane( &model, error, surfs, BBOT, true, aNThreads ) )
+    {
+        cerr << "  [FAIL]: could not create the surfaces with " << aNThreads << " threads\n";
+        return false;
+    }
+
+    aNSurfaces = surfs.size();
+
+    if( !model.Write( aFileName, true ) )
+    {
+        cerr << "  [FAIL]: could not write '" << aFileName << "'\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+// read the lines of an IGES file except for the Global section, which
+// includes the file name and the time of writing
+static bool readLines( const char* aFileName, vector<string>& aLines )
+{
+    ifstream file( aFileName );
+
+    if( !file.is_open() )
+        return false;
+
+    string line;
+
+    while( getline( file, line ) )
+    {
+        if( line.size() > 72 && 'G' == line[72] )
+            continue;
+
+        aLines.push_back( line );
+    }
+
+    return true;
+}
+
+
+void testThreads( int& nTests, int& nFails )
+{
+    static const int nThreads[] = { 2, 4, 0 };
+
+    size_t ns0 = 0;
+    vector<string> d0;
+    bool built = writeBoard( TMPFILE0, 1, ns0 ) && readLines( TMPFILE0, d0 );
+
+    for( int i = 0; i < 3; ++i )
+    {
+        ++nTests;
+        cerr << "* Test: board surfaces with 1 and " << nThreads[i] << " threads\n";
+
+        size_t ns1 = 0;
+        vector<string> d1;
+        bool ok = built;
+
+        if( ok && ( !writeBoard( TMPFILE1, nThreads[i], ns1 ) || !readLines( TMPFILE1, d1 ) ) )
+            ok = false;
+
+        if( ok && ( ns1 != ns0 || ns0 < 100 ) )
+        {
+            cerr << "  [FAIL]: " << ns1 << " surfaces; expected " << ns0 << "\n";
+            ok = false;
+        }
+
+        for( size_t j = 0; ok && j < d0.size(); ++j )
+        {
+            if( j >= d1.size() || d0[j] != d1[j] )
+            {
+                cerr << "  [FAIL]: the files differ at line " << ( j + 1 ) << "\n";
+                ok = false;
+            }
+        }
+
+        if( ok && d1.size() != d0.size() )
+        {
+            cerr << "  [FAIL]: the files differ in length\n";
+            ok = false;
+        }
+
+        remove( TMPFILE1 );
+
+        if( ok )
+            cerr << "  [OK]: " << ns0 << " surfaces\n";
+        else
+            ++nFails;
+    }
+
+    remove( TMPFILE0 );
+    return;
+}
+
+
+static bool readFile( const char* aFileName, string& aData )
+{
+    ifstream file( aFileName, ios::in | ios::binary );
+
+    if( !file.is_open() )
+        return false;
+
+    ostringstream os;
+    os << file.rdbuf();
+    aData = os.str();
+    return true;
+}
+
+
+static float getFloat( const string& aData, size_t aOffset )
+{
+    const unsigned char* p = (const unsigned char*)aData.data() + aOffset;
+    unsigned int v = p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (unsigned int)p[3] << 24 );
+    float f;
+    memcpy( &f, &v, 4 );
+    return f;
+}
+
+
+// read an IGES file, mesh it as a binary STL file and retrieve the
+// number of triangles, their total area and their bounding box
+static bool meshBoard( const char* aFileName, IGES& aModel, size_t& aNTriangles,
+    double& aArea, MCAD_POINT& aBB0, MCAD_POINT& aBB1 )
+{
+    IGES_MESH_WRITER writer;
+    string data;
+    size_t nParts = 0;
+    size_t nVertices = 0;
+    size_t nFailed = 0;
+
+    aNTriangles = 0;
+    aArea = 0.0;
+
+    if( !aModel.Read( aFileName ) || !writer.Write( &aModel, TMPMESH0, MESH_FORMAT_STL, 4 )
+        || !readFile( TMPMESH0, data ) )
+    {
+        cerr << "  [FAIL]: could not mesh '" << aFileName << "'\n";
+        remove( TMPMESH0 );
+        return false;
+    }
+
+    remove( TMPMESH0 );
+    writer.GetStats( nParts, nVertices, aNTriangles, nFailed );
+
+    if( nFailed || 0 == aNTriangles || data.size() != 84 + 50 * aNTriangles )
+    {
+        cerr << "  [FAIL]: invalid mesh of '" << aFileName << "'\n";
+        return false;
+    }
+
+    for( size_t i = 0; i < aNTriangles; ++i )
+    {
+        MCAD_POINT p[3];
+        size_t off = 84 + 50 * i + 12;
+
+        for( int j = 0; j < 3; ++j, off += 12 )
+        {
+            p[j] = MCAD_POINT( getFloat( data, off ), getFloat( data, off + 4 ),
+                               getFloat( data, off + 8 ) );
+
+            if( 0 == i && 0 == j )
+            {
+                aBB0 = p[0];
+                aBB1 = p[0];
+            }
+
+            aBB0.x = min( aBB0.x, p[j].x );
+            aBB0.y = min( aBB0.y, p[j].y );
+            aBB0.z = min( aBB0.z, p[j].z );
+            aBB1.x = max( aBB1.x, p[j].x );
+            aBB1.y = max( aBB1.y, p[j].y );
+            aBB1.z = max( aBB1.z, p[j].z );
+        }
+
+        MCAD_POINT e0 = p[1] - p[0];
+        MCAD_POINT e1 = p[2] - p[0];
+        double x = e0.y * e1.z - e0.z * e1.y;
+        double y = e0.z * e1.x - e0.x * e1.z;
+        double z = e0.x * e1.y - e0.y * e1.x;
+        aArea += 0.5 * sqrt( x * x + y * y + z * z );
+    }
+
+    return true;
+}
+
+
+// check that each instance of the model refers to a barrel and is placed
+// at a distinct drill hole
+static bool checkInstances( IGES& aModel, const vector<MCAD_POINT>& aDrills )
+{
+    size_t n308 = 0;
+    size_t n408 = 0;
+    IGES_ENTITY* const* list308 = NULL;
+    IGES_ENTITY* const* list408 = NULL;
+
+    aModel.GetEntitiesByType( ENT_SUBFIGURE_DEFINITION, n308, list308 );
+    aModel.GetEntitiesByType( ENT_SINGULAR_SUBFIGURE_INSTANCE, n408, list408 );
+
+    if( NSIZES != n308 || aDrills.size() != n408 )
+    {
+        cerr << "  [FAIL]: " << n308 << " barrels and " << n408 << " instances; expected ";
+        cerr << NSIZES << " and " << aDrills.size() << "\n";
+        return false;
+    }
+
+    vector<bool> used( aDrills.size(), false );
+
+    for( size_t i = 0; i < n408; ++i )
+    {
+        IGES_ENTITY_408* ip = dynamic_cast<IGES_ENTITY_408*>( list408[i] );
+        IGES_ENTITY_308* dp = NULL;
+
+        if( NULL == ip || !ip->GetDE( dp ) || NULL == dp || ip->S != 1.0 || ip->Z != 0.0 )
+        {
+            cerr << "  [FAIL]: instance " << i << " is invalid\n";
+            return false;
+        }
+
+        bool found = false;
+
+        for( size_t j = 0; j < aDrills.size() && !found; ++j )
+        {
+            if( !used[j] && fabs( ip->X - aDrills[j].x ) < 1e-9
+                && fabs( ip->Y - aDrills[j].y ) < 1e-9 )
+            {
+                used[j] = true;
+                found = true;
+            }
+        }
+
+        if( !found )
+        {
+            cerr << "  [FAIL]: instance " << i << " at (" << ip->X << ", " << ip->Y;
+            cerr << ") is not placed at a drill hole\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void testInstances( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: read back drill holes written as instances\n";
+
+    vector<MCAD_POINT> drills;
+    size_t ns0 = 0;
+    size_t ns1 = 0;
+    IGES m0;
+    IGES m1;
+    size_t nt0 = 0;
+    size_t nt1 = 0;
+    double a0 = 0.0;
+    double a1 = 0.0;
+    MCAD_POINT bb0[2];
+    MCAD_POINT bb1[2];
+    bool ok = writeBoard( TMPFILE0, 1, ns0 ) && writeBoard( TMPFILE1, 1, ns1, &drills );
+
+    // the wall of each drill hole consists of 2 surfaces
+    if( ok && ( NDRILLS != drills.size() || ns0 != ns1 + 2 * drills.size() ) )
+    {
+        cerr << "  [FAIL]: " << ns1 << " surfaces with instances; expected ";
+        cerr << ( ns0 - 2 * drills.size() ) << "\n";
+        ok = false;
+    }
+
+    if( ok )
+        ok = meshBoard( TMPFILE0, m0, nt0, a0, bb0[0], bb1[0] )
+            && meshBoard( TMPFILE1, m1, nt1, a1, bb0[1], bb1[1] );
+
+    if( ok )
+        ok = checkInstances( m1, drills );
+
+    // the barrels are meshed in their own coordinates and then moved
+    // so the coordinates may differ in the last digits
+    if( ok && ( nt0 != nt1 || fabs( a0 - a1 ) > TOL * a0
+        || !PointMatches( bb0[0], bb0[1], 1e-4 ) || !PointMatches( bb1[0], bb1[1], 1e-4 ) ) )
+    {
+        cerr << "  [FAIL]: " << nt1 << " triangles with an area of " << a1;
+        cerr << "; expected " << nt0 << " and " << a0 << "\n";
+        ok = false;
+    }
+
+    remove( TMPFILE0 );
+    remove( TMPFILE1 );
+
+    if( ok )
+        cerr << "  [OK]: " << nt0 << " triangles\n";
+    else
+        ++nFails;
+
+    return;
+}
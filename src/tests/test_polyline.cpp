@@ -0,0 +1,372 @@
+/*
+ * file: test_polyline.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the polyline discretization of curves. The
+ * polylines are tested against the exact curves to ensure that
+ * the points lie on the curve and that the chords lie within
+ * the requested tolerance of the curve.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <core/iges.h>
+#include <core/entity100.h>
+#include <core/entity102.h>
+#include <core/entity104.h>
+#include <core/entity110.h>
+#include <core/entity128.h>
+#include <core/entity142.h>
+#include <api/dll_entity142.h>
+#include <geom/mcad_helpers.h>
+
+using namespace std;
+
+// chord tolerance used in the tests
+#define TOL 1e-3
+
+// test full ellipses starting at each degree around the ellipse
+void testFullEllipse( int& nTests, int& nFails );
+// test the joints of a composite curve with many segments
+void testComposite( int& nTests, int& nFails );
+// test a parameter space curve on a curved surface against the exact curve
+void testCurveOnSurface( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testFullEllipse( nTests, nFails );
+    testComposite( nTests, nFails );
+    testCurveOnSurface( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// distance from a point to the ellipse (x/a)^2 + (y/b)^2 = 1, estimated
+// from the residual and gradient of the implicit function
+static double ellipseDist( const MCAD_POINT& p, double a, double b )
+{
+    double f = p.x * p.x / ( a * a ) + p.y * p.y / ( b * b ) - 1.0;
+    double gx = 2.0 * p.x / ( a * a );
+    double gy = 2.0 * p.y / ( b * b );
+
+    return fabs( f ) / sqrt( gx * gx + gy * gy );
+}
+
+
+void testFullEllipse( int& nTests, int& nFails )
+{
+    IGES model;
+    IGES_ENTITY* ep = NULL;
+    double a = 3.0;
+    double b = 1.5;
+
+    if( !model.NewEntity( ENT_CONIC_ARC, &ep ) )
+    {
+        cerr << "  [FAIL]: could not create a conic\n";
+        ++nTests;
+        ++nFails;
+        return;
+    }
+
+    IGES_ENTITY_104* cp = (IGES_ENTITY_104*)ep;
+    cp->A = 1.0 / ( a * a );
+    cp->B = 0.0;
+    cp->C = 1.0 / ( b * b );
+    cp->D = 0.0;
+    cp->E = 0.0;
+    cp->F = -1.0;
+    cp->ZT = 0.0;
+
+    cerr << "* Test: full ellipses starting at 360 angles\n";
+    ++nTests;
+
+    vector<MCAD_POINT> pts;
+    double maxErr = 0.0;
+    int nBad = 0;
+
+    for( int k = 0; k < 360; ++k )
+    {
+        double t = k * M_PI / 180.0 - M_PI;
+        cp->X1 = a * cos( t );
+        cp->Y1 = b * sin( t );
+        cp->X2 = cp->X1;
+        cp->Y2 = cp->Y1;
+
+        if( !cp->GetPolyline( pts, TOL ) || pts.size() < 9
+            || pts.front().x != pts.back().x || pts.front().y != pts.back().y )
+        {
+            ++nBad;
+            continue;
+        }
+
+        for( size_t i = 0; i < pts.size(); ++i )
+        {
+            maxErr = max( maxErr, ellipseDist( pts[i], a, b ) );
+
+            if( i > 0 )
+            {
+                MCAD_POINT m( 0.5 * ( pts[i].x + pts[i - 1].x ),
+                              0.5 * ( pts[i].y + pts[i - 1].y ), 0.0 );
+                maxErr = max( maxErr, ellipseDist( m, a, b ) );
+            }
+        }
+    }
+
+    if( nBad || maxErr > TOL )
+    {
+        cerr << "  [FAIL]: " << nBad << " failed polylines, max. error " << maxErr << "\n";
+        ++nFails;
+    }
+    else
+    {
+        cerr << "  [OK]: max. error " << maxErr << "\n";
+    }
+
+    return;
+}
+
+
+void testComposite( int& nTests, int& nFails )
+{
+    IGES model;
+    IGES_ENTITY* ep = NULL;
+    int nSides = 500;
+    double r = 10.0;
+
+    if( !model.NewEntity( ENT_COMPOSITE_CURVE, &ep ) )
+    {
+        cerr << "  [FAIL]: could not create a composite curve\n";
+        ++nTests;
+        ++nFails;
+        return;
+    }
+
+    IGES_ENTITY_102* ccp = (IGES_ENTITY_102*)ep;
+
+    // a polygon of lines with every tenth side replaced by an arc
+    for( int i = 0; i < nSides; ++i )
+    {
+        double t0 = 2.0 * M_PI * i / nSides;
+        double t1 = 2.0 * M_PI * ( i + 1 ) / nSides;
+
+        if( i % 10 )
+        {
+            model.NewEntity( ENT_LINE, &ep );
+            IGES_ENTITY_110* lp = (IGES_ENTITY_110*)ep;
+            lp->X1 = r * cos( t0 );
+            lp->Y1 = r * sin( t0 );
+            lp->Z1 = 0.0;
+            lp->X2 = r * cos( t1 );
+            lp->Y2 = r * sin( t1 );
+            lp->Z2 = 0.0;
+        }
+        else
+        {
+            model.NewEntity( ENT_CIRCULAR_ARC, &ep );
+            IGES_ENTITY_100* ap = (IGES_ENTITY_100*)ep;
+            ap->zOffset = 0.0;
+            ap->xCenter = 0.0;
+            ap->yCenter = 0.0;
+            ap->xStart = r * cos( t0 );
+            ap->yStart = r * sin( t0 );
+            ap->xEnd = r * cos( t1 );
+            ap->yEnd = r * sin( t1 );
+        }
+
+        ccp->AddSegment( (IGES_CURVE*)ep );
+    }
+
+    cerr << "* Test: composite curve of " << nSides << " segments\n";
+    ++nTests;
+
+    vector<MCAD_POINT> pts;
+    int nBad = 0;
+
+    if( !ccp->GetPolyline( pts, TOL ) )
+    {
+        cerr << "  [FAIL]: no polyline\n";
+        ++nFails;
+        return;
+    }
+
+    // each vertex of the polygon must appear exactly once
+    size_t k = 0;
+
+    for( int i = 0; i <= nSides && !nBad; ++i )
+    {
+        double t = 2.0 * M_PI * i / nSides;
+        MCAD_POINT v( r * cos( t ), r * sin( t ), 0.0 );
+
+        while( k < pts.size() && !PointMatches( pts[k], v, 1e-9 ) )
+            ++k;
+
+        if( k == pts.size() || ( k + 1 < pts.size() && PointMatches( pts[k + 1], v, 1e-9 ) ) )
+            ++nBad;
+
+        ++k;
+    }
+
+    for( size_t i = 1; i < pts.size(); ++i )
+    {
+        if( PointMatches( pts[i], pts[i - 1], 1e-9 ) )
+            ++nBad;
+    }
+
+    if( nBad || k != pts.size() )
+    {
+        cerr << "  [FAIL]: " << nBad << " missing or duplicated points\n";
+        ++nFails;
+    }
+    else
+    {
+        cerr << "  [OK]: " << pts.size() << " points\n";
+    }
+
+    return;
+}
+
+
+void testCurveOnSurface( int& nTests, int& nFails )
+{
+    IGES model;
+    IGES_ENTITY* ep = NULL;
+    double r = 10.0;
+
+    // quarter cylinder of radius r: a rational quadratic arc in U
+    // and linear from z = 0 to z = 10 in V
+    double w = sqrt( 0.5 );
+    double knots1[] = { 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 };
+    double knots2[] = { 0.0, 0.0, 1.0, 1.0 };
+    double coeffs[] = { r, 0.0, 0.0, 1.0,    r, r, 0.0, w,    0.0, r, 0.0, 1.0,
+                        r, 0.0, 10.0, 1.0,   r, r, 10.0, w,   0.0, r, 10.0, 1.0 };
+
+    model.NewEntity( ENT_NURBS_SURFACE, &ep );
+    IGES_ENTITY_128* sp = (IGES_ENTITY_128*)ep;
+
+    if( !sp->SetNURBSData( 3, 2, 3, 2, knots1, knots2, coeffs, true, false, false,
+        0.0, 1.0, 0.0, 1.0 ) )
+    {
+        cerr << "  [FAIL]: could not create the surface\n";
+        ++nTests;
+        ++nFails;
+        return;
+    }
+
+    // a circle in the parameter space of the surface
+    double uc = 0.5;
+    double vc = 0.5;
+    double ur = 0.4;
+
+    model.NewEntity( ENT_CIRCULAR_ARC, &ep );
+    IGES_ENTITY_100* ap = (IGES_ENTITY_100*)ep;
+    ap->zOffset = 0.0;
+    ap->xCenter = uc;
+    ap->yCenter = vc;
+    ap->xStart = uc + ur;
+    ap->yStart = vc;
+    ap->xEnd = uc + ur;
+    ap->yEnd = vc;
+
+    model.NewEntity( ENT_CURVE_ON_PARAMETRIC_SURFACE, &ep );
+    IGES_ENTITY_142* cp = (IGES_ENTITY_142*)ep;
+    cp->SetSPTR( sp );
+    cp->SetBPTR( ap );
+
+    cerr << "* Test: parameter space circle on a cylinder\n";
+    ++nTests;
+
+    DLL_IGES_ENTITY_142 dcp( &model, false );
+    dcp.Attach( cp );
+    MCAD_POINT* pts = NULL;
+    int nPts = 0;
+
+    if( !dcp.GetPolyline( pts, nPts, TOL ) || nPts < 3 )
+    {
+        cerr << "  [FAIL]: no polyline\n";
+        ++nFails;
+        delete [] pts;
+        return;
+    }
+
+    // sample the exact curve and find the distance of each sample from
+    // the polyline; all points of the polyline must lie on the cylinder
+    int nSamples = 2000;
+    vector<double> u( nSamples );
+    vector<double> v( nSamples );
+    vector<MCAD_POINT> exact( nSamples );
+
+    for( int i = 0; i < nSamples; ++i )
+    {
+        double t = 2.0 * M_PI * i / nSamples;
+        u[i] = uc + ur * cos( t );
+        v[i] = vc + ur * sin( t );
+        sp->EvaluateGrid( 1, &u[i], 1, &v[i], &exact[i] );
+    }
+
+    double maxErr = 0.0;
+
+    for( int i = 0; i < nPts; ++i )
+        maxErr = max( maxErr, fabs( sqrt( pts[i].x * pts[i].x + pts[i].y * pts[i].y ) - r ) );
+
+    for( int i = 0; i < nSamples; ++i )
+    {
+        double dMin = 1e30;
+
+        for( int j = 1; j < nPts; ++j )
+        {
+            MCAD_POINT d( pts[j].x - pts[j - 1].x, pts[j].y - pts[j - 1].y,
+                          pts[j].z - pts[j - 1].z );
+            MCAD_POINT e( exact[i].x - pts[j - 1].x, exact[i].y - pts[j - 1].y,
+                          exact[i].z - pts[j - 1].z );
+            double dd = d.x * d.x + d.y * d.y + d.z * d.z;
+            double t = ( dd > 0.0 ) ? ( e.x * d.x + e.y * d.y + e.z * d.z ) / dd : 0.0;
+            t = ( t < 0.0 ) ? 0.0 : ( t > 1.0 ? 1.0 : t );
+            e.x -= t * d.x;
+            e.y -= t * d.y;
+            e.z -= t * d.z;
+            dMin = min( dMin, sqrt( e.x * e.x + e.y * e.y + e.z * e.z ) );
+        }
+
+        maxErr = max( maxErr, dMin );
+    }
+
+    if( maxErr > TOL )
+    {
+        cerr << "  [FAIL]: max. error " << maxErr << " (" << nPts << " points)\n";
+        ++nFails;
+    }
+    else
+    {
+        cerr << "  [OK]: max. error " << maxErr << " (" << nPts << " points)\n";
+    }
+
+    delete [] pts;
+    return;
+}
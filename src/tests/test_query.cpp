@@ -0,0 +1,397 @@
+/*
+ * file: test_query.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the per-type entity index of a model and of
+ * the queries IGES::GetEntitiesByType() and IGES::GetEntities().
+ * Entities of several types and with various attributes are created,
+ * modified and deleted, and the results of the queries are compared
+ * with those of an exhaustive search; the index is also checked after
+ * the model is written and read back.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <core/iges.h>
+#include <core/entity110.h>
+#include <core/entity124.h>
+
+using namespace std;
+
+// number of entities created
+#define NENTITIES 3000
+// temporary file for the test of the index of a model which was read
+#define TMPFILE "test_query_tmp.igs"
+
+// check the type index as entities are created and deleted
+void testTypeIndex( int& nTests, int& nFails );
+// compare attribute queries with an exhaustive search
+void testQueries( int& nTests, int& nFails );
+// check the type index of a model which was written and read back
+void testReadBack( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testTypeIndex( nTests, nFails );
+    testQueries( nTests, nFails );
+    testReadBack( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// the types of entities which are created
+static const int types[] = { ENT_LINE, ENT_TRANSFORMATION_MATRIX, ENT_COLOR_DEFINITION };
+#define NTYPES ( sizeof( types ) / sizeof( types[0] ) )
+
+
+// returns true if GetEntitiesByType() returns exactly the entities of
+// each type in aAll
+static bool checkIndex( IGES& aModel, const vector<IGES_ENTITY*>& aAll )
+{
+    for( size_t i = 0; i < NTYPES; ++i )
+    {
+        vector<IGES_ENTITY*> expected;
+
+        for( size_t j = 0; j < aAll.size(); ++j )
+        {
+            if( aAll[j]->GetEntityType() == types[i] )
+                expected.push_back( aAll[j] );
+        }
+
+        size_t n = 0;
+        IGES_ENTITY* const* lp = NULL;
+        bool found = aModel.GetEntitiesByType( types[i], n, lp );
+        vector<IGES_ENTITY*> result;
+
+        if( found )
+            result.assign( lp, lp + n );
+
+        sort( expected.begin(), expected.end() );
+        sort( result.begin(), result.end() );
+
+        if( found == expected.empty() || result != expected )
+        {
+            cerr << "  [FAIL]: " << result.size() << " entities of type " << types[i];
+            cerr << "; expected " << expected.size() << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void testTypeIndex( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: type index with " << NENTITIES << " entities\n";
+
+    IGES model;
+    vector<IGES_ENTITY*> all;
+    bool ok = true;
+
+    for( int i = 0; i < NENTITIES && ok; ++i )
+    {
+        IGES_ENTITY* ep;
+
+        if( !model.NewEntity( types[( i * 7 ) % NTYPES], &ep ) )
+            ok = false;
+        else
+            all.push_back( ep );
+    }
+
+    if( !ok )
+        cerr << "  [FAIL]: could not create the entities\n";
+
+    ok = ok && checkIndex( model, all );
+
+    // delete every third entity
+    for( size_t i = 0; i < all.size() && ok; i += 2 )
+    {
+        if( !model.DelEntity( all[i] ) )
+        {
+            cerr << "  [FAIL]: could not delete an entity\n";
+            ok = false;
+        }
+
+        all.erase( all.begin() + i );
+    }
+
+    ok = ok && checkIndex( model, all );
+
+    // an unlinked entity is no longer part of the model
+    if( ok )
+    {
+        IGES_ENTITY* ep = all.back();
+        all.pop_back();
+
+        if( !model.UnlinkEntity( ep ) )
+        {
+            cerr << "  [FAIL]: could not unlink an entity\n";
+            ok = false;
+        }
+
+        ok = ok && checkIndex( model, all );
+        delete ep;
+    }
+
+    // an entity which was created outside the model is indexed when added
+    if( ok )
+    {
+        IGES_ENTITY* ep = new IGES_ENTITY_110( NULL );
+
+        if( !model.AddEntity( ep ) )
+        {
+            cerr << "  [FAIL]: could not add an entity\n";
+            delete ep;
+            ok = false;
+        }
+        else
+        {
+            all.push_back( ep );
+            ok = checkIndex( model, all );
+        }
+    }
+
+    model.Clear();
+    all.clear();
+    ok = ok && checkIndex( model, all );
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+// returns true if the entity satisfies the query; this mirrors the
+// documented semantics of IGES_QUERY
+static bool matches( IGES_ENTITY* aEntity, const IGES_QUERY& aQuery )
+{
+    if( aEntity->GetEntityType() != aQuery.entityType )
+        return false;
+
+    int level = 0;
+    IGES_ENTITY* pl = NULL;
+
+    if( aQuery.level >= 0 && ( !aEntity->GetLevel( level ) || level != aQuery.level
+        || ( aEntity->GetLevelEntity( &pl ) && NULL != pl ) ) )
+        return false;
+
+    IGES_COLOR color;
+
+    if( aQuery.color >= 0 && ( !aEntity->GetColor( color ) || color != aQuery.color ) )
+        return false;
+
+    string label;
+    aEntity->GetLabel( label );
+
+    if( NULL != aQuery.label && label.compare( aQuery.label ) )
+        return false;
+
+    bool visible = true;
+
+    if( aQuery.visible >= 0 && ( !aEntity->GetVisibility( visible )
+        || visible != ( aQuery.visible != 0 ) ) )
+        return false;
+
+    return true;
+}
+
+
+void testQueries( int& nTests, int& nFails )
+{
+    static const char* labels[] = { "EDGE", "HOLE", "SLOT" };
+    static const IGES_COLOR colors[] = { COLOR_NONE, COLOR_RED, COLOR_GREEN, COLOR_BLUE };
+
+    ++nTests;
+    cerr << "* Test: attribute queries\n";
+
+    IGES model;
+    vector<IGES_ENTITY*> all;
+    bool ok = true;
+
+    for( int i = 0; i < NENTITIES && ok; ++i )
+    {
+        IGES_ENTITY* ep;
+
+        if( !model.NewEntity( ( i % 5 ) ? ENT_LINE : ENT_TRANSFORMATION_MATRIX, &ep ) )
+        {
+            ok = false;
+            break;
+        }
+
+        all.push_back( ep );
+
+        if( ENT_LINE != ep->GetEntityType() )
+            continue;
+
+        if( !ep->SetLevel( i % 4 ) || !ep->SetColor( colors[( i / 3 ) % 4] )
+            || !ep->SetLabel( labels[( i / 7 ) % 3] ) || !ep->SetVisibility( i % 11 ) )
+            ok = false;
+    }
+
+    if( !ok )
+        cerr << "  [FAIL]: could not create the entities\n";
+
+    for( int pass = 0; pass < 2 && ok; ++pass )
+    {
+        // the second pass checks the queries after the attributes are changed
+        if( 1 == pass )
+        {
+            for( size_t i = 0; i < all.size(); i += 3 )
+            {
+                if( ENT_LINE == all[i]->GetEntityType() )
+                {
+                    all[i]->SetLevel( 7 );
+                    all[i]->SetVisibility( true );
+                }
+            }
+        }
+
+        for( int q = 0; q < 64 && ok; ++q )
+        {
+            IGES_QUERY query( ( q & 32 ) ? ENT_TRANSFORMATION_MATRIX : ENT_LINE );
+
+            if( q & 1 )
+                query.level = ( q & 16 ) ? 7 : q % 4;
+
+            if( q & 2 )
+                query.color = colors[( q / 4 ) % 4];
+
+            if( q & 4 )
+                query.label = labels[q % 3];
+
+            if( q & 8 )
+                query.visible = ( q / 16 ) % 2;
+
+            vector<IGES_ENTITY*> result;
+            vector<IGES_ENTITY*> expected;
+            model.GetEntities( query, result );
+
+            for( size_t i = 0; i < all.size(); ++i )
+            {
+                if( matches( all[i], query ) )
+                    expected.push_back( all[i] );
+            }
+
+            sort( result.begin(), result.end() );
+            sort( expected.begin(), expected.end() );
+
+            size_t n = 0;
+            IGES_ENTITY* const* lp = NULL;
+            bool found = model.GetEntities( query, n, lp );
+
+            if( result != expected || found == expected.empty() || n != expected.size() )
+            {
+                cerr << "  [FAIL]: query " << q << " found " << result.size();
+                cerr << " entities; expected " << expected.size() << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testReadBack( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: type index of a model which was read\n";
+
+    IGES model;
+    size_t nLines = 0;
+    bool ok = true;
+
+    for( int i = 0; i < 100 && ok; ++i )
+    {
+        IGES_ENTITY* ep;
+
+        if( !model.NewEntity( ENT_LINE, &ep ) )
+        {
+            ok = false;
+            break;
+        }
+
+        IGES_ENTITY_110* lp = (IGES_ENTITY_110*)ep;
+        lp->X2 = i + 1.0;
+        ++nLines;
+    }
+
+    if( !ok || !model.Write( TMPFILE, true ) )
+    {
+        cerr << "  [FAIL]: could not write the model\n";
+        ++nFails;
+        return;
+    }
+
+    IGES model2;
+    size_t n = 0;
+    IGES_ENTITY* const* lp = NULL;
+
+    if( !model2.Read( TMPFILE ) )
+    {
+        cerr << "  [FAIL]: could not read the model\n";
+        ok = false;
+    }
+    else if( !model2.GetEntitiesByType( ENT_LINE, n, lp ) || n != nLines )
+    {
+        cerr << "  [FAIL]: " << n << " lines were read; expected " << nLines << "\n";
+        ok = false;
+    }
+
+    for( size_t i = 0; i < n && ok; ++i )
+    {
+        if( lp[i]->GetEntityType() != ENT_LINE )
+        {
+            cerr << "  [FAIL]: an entity of type " << lp[i]->GetEntityType();
+            cerr << " is listed as a line\n";
+            ok = false;
+        }
+    }
+
+    remove( TMPFILE );
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
@@ -0,0 +1,441 @@
+/*
+ * file: test_scene.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the instanced scene extracted by IGES_SCENE.
+ * A model with nested Subfigure Definitions (308), Singular Subfigure
+ * Instances (408) with offsets, scales and Transformation Matrices (124)
+ * and an independent surface is built; the definitions, the instances
+ * and their world transforms are compared with the expected values and
+ * each definition is checked to be meshed only once.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <cmath>
+#include <core/iges.h>
+#include <core/entity124.h>
+#include <core/entity128.h>
+#include <core/entity144.h>
+#include <core/entity308.h>
+#include <core/entity408.h>
+#include <core/iges_tess.h>
+#include <core/iges_scene.h>
+
+using namespace std;
+
+// tolerance for the comparison of points
+#define TOL 1e-9
+
+// check the definitions and instances without meshing
+void testStructure( int& nTests, int& nFails );
+// check that each definition is meshed once in its own space
+void testMeshes( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testStructure( nTests, nFails );
+    testMeshes( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// the entities of the test model
+struct SCENE_MODEL
+{
+    IGES model;
+    IGES_ENTITY_144* s1;            // surface of D1; offset by (0, 0, 1)
+    IGES_ENTITY_144* s2;            // independent surface
+    IGES_ENTITY_308* d1;            // lists s1
+    IGES_ENTITY_308* d2;            // lists i1
+    IGES_ENTITY_408* i1;            // D1 offset by (0, 0, 5); nested in D2
+    IGES_ENTITY_408* r1;            // D1 scaled by 2 and offset by (100, 0, 0)
+    IGES_ENTITY_408* r2;            // D2 rotated by 90 degrees and offset by (0, 50, 0)
+};
+
+
+// create a plane over [0, 10] x [0, 10] bounded by the edges of the untrimmed surface
+static IGES_ENTITY_144* newSurface( IGES& aModel )
+{
+    static const double knots[] = { 0, 0, 10, 10 };
+    static const double coeffs[] = { 0, 0, 0, 10, 0, 0, 0, 10, 0, 10, 10, 0 };
+    IGES_ENTITY* ep;
+    IGES_ENTITY* sp;
+
+    if( !aModel.NewEntity( ENT_NURBS_SURFACE, &ep )
+        || !aModel.NewEntity( ENT_TRIMMED_PARAMETRIC_SURFACE, &sp ) )
+        return NULL;
+
+    if( !((IGES_ENTITY_128*)ep)->SetNURBSData( 2, 2, 2, 2, knots, knots, coeffs,
+        false, false, false, 0.0, 10.0, 0.0, 10.0 ) )
+        return NULL;
+
+    if( !((IGES_ENTITY_144*)sp)->SetPTS( ep ) )
+        return NULL;
+
+    return (IGES_ENTITY_144*)sp;
+}
+
+
+static IGES_ENTITY_308* newDefinition( IGES& aModel, IGES_ENTITY* aMember )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_SUBFIGURE_DEFINITION, &ep )
+        || !((IGES_ENTITY_308*)ep)->AddDE( aMember ) )
+        return NULL;
+
+    return (IGES_ENTITY_308*)ep;
+}
+
+
+static IGES_ENTITY_408* newInstance( IGES& aModel, IGES_ENTITY_308* aDef, double aX,
+    double aY, double aZ, double aScale )
+{
+    IGES_ENTITY* ep;
+
+    if( NULL == aDef || !aModel.NewEntity( ENT_SINGULAR_SUBFIGURE_INSTANCE, &ep )
+        || !((IGES_ENTITY_408*)ep)->SetDE( aDef ) )
+        return NULL;
+
+    IGES_ENTITY_408* ip = (IGES_ENTITY_408*)ep;
+    ip->X = aX;
+    ip->Y = aY;
+    ip->Z = aZ;
+    ip->S = aScale;
+    return ip;
+}
+
+
+// build the test model; returns false on failure
+static bool buildModel( SCENE_MODEL& aScene )
+{
+    IGES& model = aScene.model;
+    IGES_ENTITY* ep;
+
+    aScene.s1 = newSurface( model );
+    aScene.s2 = newSurface( model );
+
+    if( NULL == aScene.s1 || NULL == aScene.s2 )
+        return false;
+
+    if( !model.NewEntity( ENT_TRANSFORMATION_MATRIX, &ep ) )
+        return false;
+
+    ((IGES_ENTITY_124*)ep)->T.T.z = 1.0;
+
+    if( !aScene.s1->SetTransform( ep ) )
+        return false;
+
+    aScene.d1 = newDefinition( model, aScene.s1 );
+    aScene.i1 = newInstance( model, aScene.d1, 0.0, 0.0, 5.0, 1.0 );
+    aScene.d2 = aScene.i1 ? newDefinition( model, aScene.i1 ) : NULL;
+    aScene.r1 = newInstance( model, aScene.d1, 100.0, 0.0, 0.0, 2.0 );
+    aScene.r2 = newInstance( model, aScene.d2, 0.0, 50.0, 0.0, 1.0 );
+
+    if( NULL == aScene.r1 || NULL == aScene.r2 )
+        return false;
+
+    if( !model.NewEntity( ENT_TRANSFORMATION_MATRIX, &ep ) )
+        return false;
+
+    IGES_ENTITY_124* tp = (IGES_ENTITY_124*)ep;
+    tp->T.R.v[0][0] = 0.0;
+    tp->T.R.v[0][1] = -1.0;
+    tp->T.R.v[1][0] = 1.0;
+    tp->T.R.v[1][1] = 0.0;
+
+    return aScene.r2->SetTransform( tp );
+}
+
+
+// apply the expected world transform of an instance to a point in
+// the space of definition D1
+static MCAD_POINT placeR1( const MCAD_POINT& p )
+{
+    return MCAD_POINT( 2.0 * p.x + 100.0, 2.0 * p.y, 2.0 * p.z );
+}
+
+
+static MCAD_POINT placeR2( const MCAD_POINT& p )
+{
+    // offset by I1, then by R2 and finally rotated by T(R2)
+    MCAD_POINT q( p.x, p.y + 50.0, p.z + 5.0 );
+    return MCAD_POINT( -q.y, q.x, q.z );
+}
+
+
+static bool samePoint( const MCAD_POINT& p0, const MCAD_POINT& p1 )
+{
+    return fabs( p0.x - p1.x ) < TOL && fabs( p0.y - p1.y ) < TOL && fabs( p0.z - p1.z ) < TOL;
+}
+
+
+// check the definitions and instances of a scene built from the test
+// model; the meshes are not examined
+static bool checkStructure( const IGES_SCENE& aScene, const SCENE_MODEL& aModel )
+{
+    // the independent surfaces plus one record per Subfigure Definition
+    if( aScene.GetNDefinitions() != 3 )
+    {
+        cerr << "  [FAIL]: " << aScene.GetNDefinitions() << " definitions; expected 3\n";
+        return false;
+    }
+
+    const IGES_SCENE_DEF* dp = aScene.GetDefinition( 0 );
+
+    if( NULL != dp->definition || dp->surfaces.size() != 1 || dp->surfaces[0] != aModel.s2 )
+    {
+        cerr << "  [FAIL]: bad definition of the independent surfaces\n";
+        return false;
+    }
+
+    int idx1 = -1;
+
+    for( size_t i = 1; i < aScene.GetNDefinitions(); ++i )
+    {
+        dp = aScene.GetDefinition( i );
+
+        if( dp->definition == aModel.d1 )
+        {
+            idx1 = (int)i;
+
+            if( dp->surfaces.size() != 1 || dp->surfaces[0] != aModel.s1 )
+            {
+                cerr << "  [FAIL]: bad surfaces in definition D1\n";
+                return false;
+            }
+        }
+        else if( dp->definition != aModel.d2 || !dp->surfaces.empty() )
+        {
+            cerr << "  [FAIL]: bad definition D2\n";
+            return false;
+        }
+    }
+
+    if( idx1 < 0 || NULL != aScene.GetDefinition( 3 ) )
+    {
+        cerr << "  [FAIL]: definition D1 was not found\n";
+        return false;
+    }
+
+    // the independent surfaces, D1 through R1 and D1 through R2 and I1;
+    // D2 itself has no surfaces and is not instanced
+    if( aScene.GetNInstances() != 3 )
+    {
+        cerr << "  [FAIL]: " << aScene.GetNInstances() << " instances; expected 3\n";
+        return false;
+    }
+
+    bool found[3] = { false, false, false };
+    MCAD_POINT pt[3] = { MCAD_POINT( 0.0, 0.0, 0.0 ), MCAD_POINT( 10.0, 0.0, 1.0 ),
+                         MCAD_POINT( 3.0, 7.0, -2.0 ) };
+
+    for( size_t i = 0; i < aScene.GetNInstances(); ++i )
+    {
+        const IGES_SCENE_INSTANCE* ip = aScene.GetInstance( i );
+        int which = -1;
+
+        if( 0 == ip->definition && NULL == ip->instance )
+            which = 0;
+        else if( idx1 == ip->definition && aModel.r1 == ip->instance )
+            which = 1;
+        else if( idx1 == ip->definition && aModel.r2 == ip->instance )
+            which = 2;
+
+        if( which < 0 || found[which] )
+        {
+            cerr << "  [FAIL]: unexpected instance " << i << "\n";
+            return false;
+        }
+
+        found[which] = true;
+
+        for( int j = 0; j < 3; ++j )
+        {
+            MCAD_POINT expected = pt[j];
+
+            if( 1 == which )
+                expected = placeR1( pt[j] );
+            else if( 2 == which )
+                expected = placeR2( pt[j] );
+
+            if( !samePoint( ip->transform * pt[j], expected ) )
+            {
+                cerr << "  [FAIL]: bad transform of instance " << i << "\n";
+                return false;
+            }
+        }
+    }
+
+    if( NULL != aScene.GetInstance( 3 ) )
+    {
+        cerr << "  [FAIL]: an instance index out of range was accepted\n";
+        return false;
+    }
+
+    return true;
+}
+
+
+void testStructure( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: scene definitions and instances\n";
+
+    SCENE_MODEL sm;
+
+    if( !buildModel( sm ) )
+    {
+        cerr << "  [FAIL]: could not create the model\n";
+        ++nFails;
+        return;
+    }
+
+    IGES_SCENE scene;
+    bool ok = scene.Build( &sm.model ) && checkStructure( scene, sm );
+    size_t nMeshed = 1;
+    size_t nExpanded = 1;
+
+    if( ok )
+    {
+        scene.GetNTriangles( nMeshed, nExpanded );
+
+        if( nMeshed || nExpanded || !scene.GetDefinition( 1 )->meshes.empty() )
+        {
+            cerr << "  [FAIL]: meshes were created without a tessellator\n";
+            ok = false;
+        }
+    }
+
+    scene.Clear();
+
+    if( ok && ( scene.GetNDefinitions() || scene.GetNInstances() ) )
+    {
+        cerr << "  [FAIL]: the scene was not cleared\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testMeshes( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: meshed scene\n";
+
+    SCENE_MODEL sm;
+
+    if( !buildModel( sm ) )
+    {
+        cerr << "  [FAIL]: could not create the model\n";
+        ++nFails;
+        return;
+    }
+
+    IGES_TESSELLATOR tess;
+    tess.SetTolerance( 0.5, 0.2 );
+
+    IGES_SCENE scene;
+    bool ok = scene.Build( &sm.model, tess, 4 ) && checkStructure( scene, sm );
+    size_t nt[3] = { 0, 0, 0 };
+
+    for( size_t i = 0; i < scene.GetNDefinitions() && ok; ++i )
+    {
+        const IGES_SCENE_DEF* dp = scene.GetDefinition( i );
+
+        if( dp->meshes.size() != dp->surfaces.size() )
+        {
+            cerr << "  [FAIL]: definition " << i << " has " << dp->meshes.size();
+            cerr << " meshes; expected " << dp->surfaces.size() << "\n";
+            ok = false;
+            break;
+        }
+
+        for( size_t j = 0; j < dp->meshes.size(); ++j )
+        {
+            const IGES_MESH& mesh = dp->meshes[j];
+
+            if( mesh.surface != dp->surfaces[j] || mesh.indices.empty() )
+            {
+                cerr << "  [FAIL]: surface " << j << " of definition " << i;
+                cerr << " was not meshed\n";
+                ok = false;
+                break;
+            }
+
+            nt[i] += mesh.indices.size() / 3;
+
+            // the meshes are in the space of the definition; the
+            // transform of the surface is applied
+            double z = ( NULL == dp->definition ) ? 0.0 : 1.0;
+
+            for( size_t k = 0; k < mesh.vertices.size() && ok; ++k )
+            {
+                const MCAD_POINT& p = mesh.vertices[k];
+
+                if( fabs( p.z - z ) > TOL || p.x < -TOL || p.x > 10.0 + TOL
+                    || p.y < -TOL || p.y > 10.0 + TOL )
+                {
+                    cerr << "  [FAIL]: vertex " << k << " of definition " << i;
+                    cerr << " is not in the space of the definition\n";
+                    ok = false;
+                }
+            }
+        }
+    }
+
+    size_t nMeshed = 0;
+    size_t nExpanded = 0;
+    scene.GetNTriangles( nMeshed, nExpanded );
+
+    // D1 is meshed once and placed twice
+    size_t n1 = nt[1] + nt[2];
+
+    if( ok && ( nMeshed != nt[0] + n1 || nExpanded != nt[0] + 2 * n1 ) )
+    {
+        cerr << "  [FAIL]: " << nMeshed << " meshed and " << nExpanded;
+        cerr << " expanded triangles; expected " << ( nt[0] + n1 ) << " and ";
+        cerr << ( nt[0] + 2 * n1 ) << "\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
@@ -0,0 +1,320 @@
+/*
+ * file: test_segbatch.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the batched intersection tests of the
+ * segment object. The results for a block of segments are
+ * compared with the results of the individual tests and the
+ * throughput of both methods is reported.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <list>
+#include <cmath>
+#include <cstdlib>
+#include <chrono>
+#include <geom/mcad_elements.h>
+#include <geom/mcad_segment.h>
+
+using namespace std;
+
+// number of segments in each block
+#define BLOCK_SIZE 256
+// number of segments tested against each block
+#define NQUERY 64
+// minimum duration (seconds) of each benchmark
+#define MIN_TIME 0.25
+
+enum SEGKIND
+{
+    KIND_LINE = 0,
+    KIND_CIRCLE,
+    KIND_ARC,
+    KIND_MIXED
+};
+
+// create a random segment of the given kind within a 100 x 100 area
+MCAD_SEGMENT* makeSegment( SEGKIND aKind );
+// create a set of random segments
+void makeSegments( SEGKIND aKind, int aCount, vector<MCAD_SEGMENT*>& aList );
+// compare the batched and individual results; returns the number of mismatches
+int checkBlock( vector<MCAD_SEGMENT*>& aQuery, vector<MCAD_SEGMENT*>& aBlock, int& nPairs );
+// report the throughput of the individual and batched tests
+void benchBlock( const char* aName, vector<MCAD_SEGMENT*>& aQuery, vector<MCAD_SEGMENT*>& aBlock );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+    const char* names[4] = { "lines", "circles", "arcs", "mixed" };
+
+    srand( 1 );
+
+    for( int k = 0; k < 4; ++k )
+    {
+        vector<MCAD_SEGMENT*> query;
+        vector<MCAD_SEGMENT*> block;
+        int nPairs = 0;
+
+        makeSegments( (SEGKIND)k, NQUERY, query );
+        makeSegments( (SEGKIND)k, BLOCK_SIZE, block );
+
+        // include some coincident, parallel and shared-endpoint cases
+        for( int i = 0; i < 8; ++i )
+        {
+            MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+            *sp = *query[i];
+            delete block[i * 7];
+            block[i * 7] = sp;
+        }
+
+        cerr << "* Test: batched intersections of " << names[k] << "\n";
+        ++nTests;
+        int nBad = checkBlock( query, block, nPairs );
+
+        if( nBad )
+        {
+            ++nFails;
+            cerr << "  [FAIL]: " << nBad << " mismatches in " << nPairs << " pairs\n";
+        }
+        else
+        {
+            cerr << "  [OK]: " << nPairs << " pairs\n";
+        }
+
+        benchBlock( names[k], query, block );
+
+        for( size_t i = 0; i < query.size(); ++i )
+            delete query[i];
+
+        for( size_t i = 0; i < block.size(); ++i )
+            delete block[i];
+    }
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return 0;
+}
+
+
+static double frand( double aMin, double aMax )
+{
+    return aMin + ( aMax - aMin ) * rand() / (double)RAND_MAX;
+}
+
+
+MCAD_SEGMENT* makeSegment( SEGKIND aKind )
+{
+    MCAD_SEGMENT* sp = new MCAD_SEGMENT;
+
+    if( KIND_MIXED == aKind )
+        aKind = (SEGKIND)( rand() % 3 );
+
+    MCAD_POINT c( frand( 0.0, 100.0 ), frand( 0.0, 100.0 ), 0.0 );
+
+    switch( aKind )
+    {
+        case KIND_LINE:
+            do
+            {
+                double a = frand( -M_PI, M_PI );
+                double l = frand( 1.0, 20.0 );
+                MCAD_POINT p1( c.x + l * cos( a ), c.y + l * sin( a ), 0.0 );
+                sp->SetParams( c, p1 );
+            } while( 0 );
+            break;
+
+        case KIND_CIRCLE:
+            do
+            {
+                double r = frand( 0.2, 5.0 );
+                MCAD_POINT p( c.x + r, c.y, 0.0 );
+                sp->SetParams( c, p, p, false );
+            } while( 0 );
+            break;
+
+        default:
+            do
+            {
+                double r = frand( 0.5, 10.0 );
+                double a0 = frand( -M_PI, M_PI );
+                double a1 = a0 + frand( 0.2, 1.8 * M_PI );
+                MCAD_POINT p0( c.x + r * cos( a0 ), c.y + r * sin( a0 ), 0.0 );
+                MCAD_POINT p1( c.x + r * cos( a1 ), c.y + r * sin( a1 ), 0.0 );
+                sp->SetParams( c, p0, p1, ( rand() & 1 ) ? true : false );
+            } while( 0 );
+            break;
+    }
+
+    return sp;
+}
+
+
+void makeSegments( SEGKIND aKind, int aCount, vector<MCAD_SEGMENT*>& aList )
+{
+    aList.clear();
+
+    for( int i = 0; i < aCount; ++i )
+        aList.push_back( makeSegment( aKind ) );
+
+    return;
+}
+
+
+int checkBlock( vector<MCAD_SEGMENT*>& aQuery, vector<MCAD_SEGMENT*>& aBlock, int& nPairs )
+{
+    MCAD_SEGBLOCK blk;
+    vector<MCAD_SEGHIT> hits;
+    vector<MCAD_POINT> points;
+    int nBad = 0;
+
+    for( size_t i = 0; i < aBlock.size(); ++i )
+        blk.Add( aBlock[i] );
+
+    for( size_t i = 0; i < aQuery.size(); ++i )
+    {
+        hits.clear();
+        points.clear();
+        aQuery[i]->GetIntersections( blk, hits, points );
+        size_t h = 0;
+
+        for( size_t j = 0; j < aBlock.size(); ++j )
+        {
+            list<MCAD_POINT> iList;
+            MCAD_INTERSECT_FLAG flag;
+            bool res = aQuery[i]->GetIntersections( *aBlock[j], iList, flag );
+            ++nPairs;
+
+            if( !res && MCAD_IFLAG_NONE == flag )
+            {
+                if( h < hits.size() && hits[h].index == j )
+                {
+                    ++nBad;
+                    ++h;
+                }
+
+                continue;
+            }
+
+            if( h >= hits.size() || hits[h].index != j || hits[h].intersects != res
+                || hits[h].flags != flag || hits[h].nPoints != iList.size() )
+            {
+                ++nBad;
+
+                if( h < hits.size() && hits[h].index == j )
+                    ++h;
+
+                continue;
+            }
+
+            list<MCAD_POINT>::iterator sP = iList.begin();
+
+            for( size_t k = 0; k < hits[h].nPoints; ++k, ++sP )
+            {
+                const MCAD_POINT& p = points[hits[h].firstPoint + k];
+
+                if( p.x != sP->x || p.y != sP->y || p.z != sP->z )
+                {
+                    ++nBad;
+                    break;
+                }
+            }
+
+            ++h;
+        }
+
+        if( h != hits.size() )
+            nBad += (int)( hits.size() - h );
+    }
+
+    return nBad;
+}
+
+
+void benchBlock( const char* aName, vector<MCAD_SEGMENT*>& aQuery, vector<MCAD_SEGMENT*>& aBlock )
+{
+    MCAD_SEGBLOCK blk;
+
+    for( size_t i = 0; i < aBlock.size(); ++i )
+        blk.Add( aBlock[i] );
+
+    double rate[2];
+    long nHits[2];
+
+    for( int m = 0; m < 2; ++m )
+    {
+        chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+        double dt = 0.0;
+        long nPairs = 0;
+        vector<MCAD_SEGHIT> hits;
+        vector<MCAD_POINT> points;
+        list<MCAD_POINT> iList;
+        MCAD_INTERSECT_FLAG flag;
+
+        nHits[m] = 0;
+
+        do
+        {
+            for( size_t i = 0; i < aQuery.size(); ++i )
+            {
+                if( 0 == m )
+                {
+                    for( size_t j = 0; j < aBlock.size(); ++j )
+                    {
+                        iList.clear();
+
+                        if( aQuery[i]->GetIntersections( *aBlock[j], iList, flag ) )
+                            ++nHits[m];
+                    }
+                }
+                else
+                {
+                    hits.clear();
+                    points.clear();
+                    aQuery[i]->GetIntersections( blk, hits, points );
+
+                    for( size_t j = 0; j < hits.size(); ++j )
+                    {
+                        if( hits[j].intersects )
+                            ++nHits[m];
+                    }
+                }
+
+                nPairs += (long)aBlock.size();
+            }
+
+            dt = chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+        } while( dt < MIN_TIME );
+
+        rate[m] = nPairs / dt * 1e-6;
+    }
+
+    cerr << "  " << setw( 8 ) << aName << " individual: " << fixed << setprecision( 2 )
+        << setw( 7 ) << rate[0] << " Mpairs/s, batched: " << setw( 7 ) << rate[1]
+        << " Mpairs/s (x" << setprecision( 2 ) << ( rate[1] / rate[0] ) << ")\n";
+    cerr.unsetf( ios::fixed );
+
+    return;
+}
@@ -0,0 +1,400 @@
+/*
+ * file: test_trim.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the point classifier for the parameter space
+ * boundaries of trimmed surfaces (IGES_TRIM_GRID). Points are classified
+ * against star shaped polygons with holes and compared with an exhaustive
+ * even-odd test, and points on a trimmed surface with circular holes are
+ * classified by IGES_ENTITY_144::ClassifyPoints() and compared with the
+ * analytic result, including after the boundaries of the surface change.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <core/iges.h>
+#include <core/iges_trim.h>
+#include <core/entity100.h>
+#include <core/entity128.h>
+#include <core/entity142.h>
+#include <core/entity144.h>
+
+using namespace std;
+
+// number of points classified in each test
+#define NPOINTS 20000
+
+// classify points against polygons with and without an outer boundary
+void testPolygons( int& nTests, int& nFails );
+// classify points on a trimmed surface with circular holes
+void testSurface( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testPolygons( nTests, nFails );
+    testSurface( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// deterministic pseudo-random numbers in the range [0, 1)
+static double rnd( void )
+{
+    static unsigned long seed = 12345;
+    seed = seed * 1103515245UL + 12345UL;
+    return double( ( seed >> 8 ) & 0xffffff ) / double( 0x1000000 );
+}
+
+
+// a star shaped polygon about (aX, aY) with radii between aR0 and aR1
+static void makeStar( vector<MCAD_POINT>& aLoop, double aX, double aY, double aR0,
+    double aR1, int aNPoints )
+{
+    aLoop.clear();
+
+    for( int i = 0; i < aNPoints; ++i )
+    {
+        double ang = 2.0 * M_PI * i / aNPoints;
+        double r = aR0 + ( aR1 - aR0 ) * rnd();
+        aLoop.push_back( MCAD_POINT( aX + r * cos( ang ), aY + r * sin( ang ), 0.0 ) );
+    }
+
+    return;
+}
+
+
+// even-odd test of a point against all loops; aNear is set if the point
+// lies within aTol of a boundary
+static bool bruteInside( const vector< vector<MCAD_POINT> >& aLoops, double aU, double aV,
+    double aTol, bool& aNear )
+{
+    bool odd = false;
+    aNear = false;
+
+    for( size_t i = 0; i < aLoops.size(); ++i )
+    {
+        const vector<MCAD_POINT>& lp = aLoops[i];
+
+        for( size_t j = 0; j < lp.size(); ++j )
+        {
+            const MCAD_POINT& a = lp[j];
+            const MCAD_POINT& b = lp[( j + 1 ) % lp.size()];
+
+            if( ( a.y > aV ) != ( b.y > aV )
+                && aU < a.x + ( aV - a.y ) * ( b.x - a.x ) / ( b.y - a.y ) )
+                odd = !odd;
+
+            // distance to the segment
+            double dx = b.x - a.x;
+            double dy = b.y - a.y;
+            double t = ( ( aU - a.x ) * dx + ( aV - a.y ) * dy ) / ( dx * dx + dy * dy );
+            t = t < 0.0 ? 0.0 : ( t > 1.0 ? 1.0 : t );
+            double ex = a.x + t * dx - aU;
+            double ey = a.y + t * dy - aV;
+
+            if( ex * ex + ey * ey < aTol * aTol )
+                aNear = true;
+        }
+    }
+
+    return odd;
+}
+
+
+void testPolygons( int& nTests, int& nFails )
+{
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        ++nTests;
+        cerr << "* Test: polygons " << ( pass ? "without" : "with" ) << " an outer boundary\n";
+
+        vector< vector<MCAD_POINT> > loops;
+
+        if( 0 == pass )
+        {
+            loops.push_back( vector<MCAD_POINT>() );
+            makeStar( loops.back(), 50.0, 50.0, 30.0, 50.0, 2000 );
+        }
+
+        // holes of various sizes and detail
+        for( int i = 0; i < 20; ++i )
+        {
+            loops.push_back( vector<MCAD_POINT>() );
+            makeStar( loops.back(), 25.0 + 50.0 * ( i % 5 ) / 4.0, 25.0 + 50.0 * ( i / 5 ) / 3.0,
+                1.0, 4.0, 3 + i * 20 );
+        }
+
+        IGES_TRIM_GRID grid;
+        vector<double> u( NPOINTS );
+        vector<double> v( NPOINTS );
+        bool* res = new bool[NPOINTS];
+        bool ok = grid.Build( loops, 0 == pass );
+
+        if( !ok )
+            cerr << "  [FAIL]: could not build the grid\n";
+
+        for( int i = 0; i < NPOINTS; ++i )
+        {
+            u[i] = rnd() * 120.0 - 10.0;
+            v[i] = rnd() * 120.0 - 10.0;
+        }
+
+        size_t nIn = ok ? grid.Classify( NPOINTS, &u[0], &v[0], res ) : 0;
+        size_t nExpected = 0;
+
+        for( int i = 0; i < NPOINTS && ok; ++i )
+        {
+            bool near;
+            bool in = bruteInside( loops, u[i], v[i], 1e-9, near );
+
+            // outside of every loop is inside when there is no outer boundary
+            if( 1 == pass )
+                in = !in;
+
+            if( in )
+                ++nExpected;
+
+            if( near )
+                continue;
+
+            if( res[i] != in || grid.IsInside( u[i], v[i] ) != in )
+            {
+                cerr << "  [FAIL]: point (" << u[i] << ", " << v[i] << ") is classified as ";
+                cerr << ( res[i] ? "inside" : "outside" ) << "\n";
+                ok = false;
+            }
+        }
+
+        if( ok && nIn != nExpected )
+        {
+            cerr << "  [FAIL]: " << nIn << " points inside; expected " << nExpected << "\n";
+            ok = false;
+        }
+
+        delete [] res;
+
+        if( ok )
+            cerr << "  [OK]\n";
+        else
+            ++nFails;
+    }
+
+    return;
+}
+
+
+// create a bilinear plane over the parameter space [0, 10] x [0, 10]
+static IGES_ENTITY_128* newPlane( IGES& aModel )
+{
+    static const double knots[] = { 0, 0, 10, 10 };
+    static const double coeffs[] = { 0, 0, 0, 10, 0, 0, 0, 10, 0, 10, 10, 0 };
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_NURBS_SURFACE, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_128* sp = (IGES_ENTITY_128*)ep;
+
+    if( !sp->SetNURBSData( 2, 2, 2, 2, knots, knots, coeffs, false, false, false,
+        0.0, 10.0, 0.0, 10.0 ) )
+        return NULL;
+
+    return sp;
+}
+
+
+// create a circular boundary in the parameter space of a surface
+static IGES_ENTITY_142* newHole( IGES& aModel, IGES_ENTITY* aSurface, double aU,
+    double aV, double aRadius, IGES_ENTITY_100** aCircle )
+{
+    IGES_ENTITY* ep;
+    IGES_ENTITY* cp;
+
+    if( !aModel.NewEntity( ENT_CIRCULAR_ARC, &cp ) || !aModel.NewEntity( ENT_CURVE_ON_PARAMETRIC_SURFACE, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_100* ap = (IGES_ENTITY_100*)cp;
+    ap->xCenter = aU;
+    ap->yCenter = aV;
+    ap->xStart = aU + aRadius;
+    ap->yStart = aV;
+    ap->xEnd = aU + aRadius;
+    ap->yEnd = aV;
+
+    IGES_ENTITY_142* bp = (IGES_ENTITY_142*)ep;
+
+    if( !bp->SetSPTR( aSurface ) || !bp->SetBPTR( cp ) )
+        return NULL;
+
+    if( NULL != aCircle )
+        *aCircle = ap;
+
+    return bp;
+}
+
+
+struct HOLE
+{
+    double u;
+    double v;
+    double r;
+};
+
+
+// compare ClassifyPoints() with the analytic result for a surface over
+// [0, 10] x [0, 10] with the given circular holes
+static bool checkSurface( IGES_ENTITY_144* aSurface, const vector<HOLE>& aHoles, double aTol )
+{
+    vector<double> u( NPOINTS );
+    vector<double> v( NPOINTS );
+    bool* res = new bool[NPOINTS];
+    bool ok = true;
+
+    for( int i = 0; i < NPOINTS; ++i )
+    {
+        u[i] = rnd() * 12.0 - 1.0;
+        v[i] = rnd() * 12.0 - 1.0;
+    }
+
+    if( !aSurface->ClassifyPoints( NPOINTS, &u[0], &v[0], res, aTol ) )
+    {
+        cerr << "  [FAIL]: could not classify the points\n";
+        delete [] res;
+        return false;
+    }
+
+    for( int i = 0; i < NPOINTS && ok; ++i )
+    {
+        bool in = u[i] >= 0.0 && u[i] <= 10.0 && v[i] >= 0.0 && v[i] <= 10.0;
+        bool near = fabs( u[i] ) < 1e-9 || fabs( u[i] - 10.0 ) < 1e-9
+            || fabs( v[i] ) < 1e-9 || fabs( v[i] - 10.0 ) < 1e-9;
+
+        for( size_t j = 0; j < aHoles.size(); ++j )
+        {
+            double du = u[i] - aHoles[j].u;
+            double dv = v[i] - aHoles[j].v;
+            double d = sqrt( du * du + dv * dv );
+
+            if( d < aHoles[j].r )
+                in = false;
+
+            // the boundary is discretized to within aTol of the circle
+            if( fabs( d - aHoles[j].r ) <= 2.0 * aTol )
+                near = true;
+        }
+
+        if( !near && res[i] != in )
+        {
+            cerr << "  [FAIL]: point (" << u[i] << ", " << v[i] << ") is classified as ";
+            cerr << ( res[i] ? "inside" : "outside" ) << "\n";
+            ok = false;
+        }
+    }
+
+    delete [] res;
+    return ok;
+}
+
+
+void testSurface( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: trimmed surface with circular holes\n";
+
+    const double tol = 1e-3;
+    IGES model;
+    IGES_ENTITY* ep;
+    IGES_ENTITY_128* plane = newPlane( model );
+    IGES_ENTITY_100* c0 = NULL;
+    IGES_ENTITY_142* h0 = plane ? newHole( model, plane, 3.0, 3.0, 1.5, &c0 ) : NULL;
+    IGES_ENTITY_142* h1 = plane ? newHole( model, plane, 7.0, 6.0, 2.0, NULL ) : NULL;
+    IGES_ENTITY_142* h2 = plane ? newHole( model, plane, 2.0, 8.0, 1.0, NULL ) : NULL;
+    IGES_ENTITY_144* surf = NULL;
+    bool ok = ( NULL != h0 && NULL != h1 && NULL != h2 );
+
+    if( ok && model.NewEntity( ENT_TRIMMED_PARAMETRIC_SURFACE, &ep ) )
+        surf = (IGES_ENTITY_144*)ep;
+
+    // the outer boundary is that of the untrimmed surface
+    if( NULL == surf || !surf->SetPTS( plane ) || !surf->AddPTI( h0 ) || !surf->AddPTI( h1 ) )
+    {
+        cerr << "  [FAIL]: could not create the surface\n";
+        ++nFails;
+        return;
+    }
+
+    vector<HOLE> holes;
+    HOLE h;
+    h.u = 3.0;
+    h.v = 3.0;
+    h.r = 1.5;
+    holes.push_back( h );
+    h.u = 7.0;
+    h.v = 6.0;
+    h.r = 2.0;
+    holes.push_back( h );
+
+    // the second classification reuses the cached grid
+    ok = checkSurface( surf, holes, tol ) && checkSurface( surf, holes, tol );
+
+    // a new boundary discards the cached grid
+    if( ok )
+    {
+        if( !surf->AddPTI( h2 ) )
+        {
+            cerr << "  [FAIL]: could not add a boundary\n";
+            ok = false;
+        }
+
+        h.u = 2.0;
+        h.v = 8.0;
+        h.r = 1.0;
+        holes.push_back( h );
+        ok = ok && checkSurface( surf, holes, tol );
+    }
+
+    // a change to a boundary curve requires ClearTrimCache()
+    if( ok )
+    {
+        c0->xCenter += 1.0;
+        c0->xStart += 1.0;
+        c0->xEnd += 1.0;
+        holes[0].u += 1.0;
+        surf->ClearTrimCache();
+        ok = checkSurface( surf, holes, tol );
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
@@ -0,0 +1,355 @@
+/*
+ * file: test_xform.cpp
+ *
+ * Copyright 2015, Dr. Cirilo Bernardo (cirilo.bernardo@gmail.com)
+ *
+ * Description:
+ *  This is a test of the cached overall transforms of chains of
+ * Transformation Matrix entities (Entity 124). The cached results
+ * are checked against the chain applied one link at a time, after
+ * modification of a link and when many transforms which share a
+ * referenced transform are evaluated concurrently.
+ *
+ * This file is part of libIGES.
+ *
+ * libIGES is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libIGES is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, If not, see
+ * <http://www.gnu.org/licenses/> or write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <core/iges.h>
+#include <core/iges_pool.h>
+#include <core/entity110.h>
+#include <core/entity124.h>
+
+using namespace std;
+
+// number of transforms which share a referenced transform
+#define NLEAVES 64
+// number of evaluations per round of the concurrency test
+#define NTASKS 4096
+
+// check a chain of transforms before and after modification of a link
+void testChain( int& nTests, int& nFails );
+// evaluate transforms which share a referenced transform concurrently
+void testConcurrent( int& nTests, int& nFails );
+// check the transforms of all entities of a model
+void testWorldTransforms( int& nTests, int& nFails );
+
+int main()
+{
+    int nTests = 0;
+    int nFails = 0;
+
+    testChain( nTests, nFails );
+    testConcurrent( nTests, nFails );
+    testWorldTransforms( nTests, nFails );
+
+    cerr << "\n** SUMMARY: " << nFails << " failures in " << nTests << " tests\n\n";
+
+    return nFails ? -1 : 0;
+}
+
+
+// set a rotation about Z followed by an offset
+static void setTransform( MCAD_TRANSFORM& aT, double aAngle, double aX, double aY, double aZ )
+{
+    aT = MCAD_TRANSFORM();
+    aT.R.v[0][0] = cos( aAngle );
+    aT.R.v[0][1] = -sin( aAngle );
+    aT.R.v[1][0] = sin( aAngle );
+    aT.R.v[1][1] = cos( aAngle );
+    aT.T.x = aX;
+    aT.T.y = aY;
+    aT.T.z = aZ;
+    return;
+}
+
+
+// apply the chain of transforms one link at a time, starting with aTx
+static MCAD_POINT applyChain( IGES_ENTITY_124* aTx, const MCAD_POINT& aPoint )
+{
+    MCAD_POINT p = aPoint;
+    IGES_ENTITY* ep = aTx;
+
+    while( NULL != ep )
+    {
+        p = ((IGES_ENTITY_124*)ep)->T * p;
+
+        if( !ep->GetTransform( &ep ) )
+            ep = NULL;
+    }
+
+    return p;
+}
+
+
+// returns true if aT maps test points as the chain starting at aTx does
+static bool checkTransform( const MCAD_TRANSFORM& aT, IGES_ENTITY_124* aTx )
+{
+    static const double pts[4][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 2, 3 } };
+
+    for( int i = 0; i < 4; ++i )
+    {
+        MCAD_POINT p( pts[i][0], pts[i][1], pts[i][2] );
+        MCAD_POINT p0 = aT * p;
+        MCAD_POINT p1 = aTx ? applyChain( aTx, p ) : p;
+
+        if( fabs( p0.x - p1.x ) > 1e-12 || fabs( p0.y - p1.y ) > 1e-12
+            || fabs( p0.z - p1.z ) > 1e-12 )
+            return false;
+    }
+
+    return true;
+}
+
+
+static IGES_ENTITY_124* newTransform( IGES& aModel, IGES_ENTITY_124* aParent,
+    double aAngle, double aX, double aY, double aZ )
+{
+    IGES_ENTITY* ep;
+
+    if( !aModel.NewEntity( ENT_TRANSFORMATION_MATRIX, &ep ) )
+        return NULL;
+
+    IGES_ENTITY_124* tp = (IGES_ENTITY_124*)ep;
+    setTransform( tp->T, aAngle, aX, aY, aZ );
+
+    if( NULL != aParent && !tp->SetTransform( aParent ) )
+        return NULL;
+
+    return tp;
+}
+
+
+void testChain( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: chain of 3 transforms\n";
+
+    IGES model;
+    IGES_ENTITY_124* t0 = newTransform( model, NULL, 0.3, 1.0, 2.0, 3.0 );
+    IGES_ENTITY_124* t1 = t0 ? newTransform( model, t0, -1.1, 5.0, 0.0, -2.0 ) : NULL;
+    IGES_ENTITY_124* t2 = t1 ? newTransform( model, t1, 2.5, 0.0, 7.0, 0.5 ) : NULL;
+
+    if( NULL == t2 )
+    {
+        cerr << "  [FAIL]: could not create the transforms\n";
+        ++nFails;
+        return;
+    }
+
+    bool ok = checkTransform( t2->GetTransformMatrix(), t2 );
+    unsigned long v0 = t2->GetVersion();
+
+    if( !ok )
+        cerr << "  [FAIL]: incorrect overall transform\n";
+
+    if( ok && v0 != t2->GetVersion() )
+    {
+        cerr << "  [FAIL]: version changed without modification\n";
+        ok = false;
+    }
+
+    // modify the link at the end of the chain
+    setTransform( t0->T, 0.7, -1.0, 0.0, 4.0 );
+    t0->Touch();
+
+    if( ok && ( !checkTransform( t2->GetTransformMatrix(), t2 ) || v0 == t2->GetVersion() ) )
+    {
+        cerr << "  [FAIL]: modification of the referenced transform not detected\n";
+        ok = false;
+    }
+
+    if( ok && !checkTransform( t1->GetTransformMatrix(), t1 ) )
+    {
+        cerr << "  [FAIL]: incorrect transform within the chain\n";
+        ok = false;
+    }
+
+    // link t1 to a new transform; the setter invokes Touch()
+    IGES_ENTITY_124* t3 = newTransform( model, NULL, -0.4, 3.0, 3.0, 3.0 );
+    unsigned long v1 = t2->GetVersion();
+
+    if( ok && ( NULL == t3 || !t1->SetTransform( t3 ) ) )
+    {
+        cerr << "  [FAIL]: could not link a new transform\n";
+        ok = false;
+    }
+
+    if( ok && ( !checkTransform( t2->GetTransformMatrix(), t2 ) || v1 == t2->GetVersion() ) )
+    {
+        cerr << "  [FAIL]: a new link in the chain was not detected\n";
+        ok = false;
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+struct CONCURRENT_DATA
+{
+    IGES_ENTITY_124* leaves[NLEAVES];
+    MCAD_TRANSFORM results[NTASKS];
+    unsigned long versions[NTASKS];
+};
+
+
+static void evalTransform( void* aData, size_t aTask, int aWorker )
+{
+    CONCURRENT_DATA* dp = (CONCURRENT_DATA*)aData;
+    IGES_ENTITY_124* tp = dp->leaves[aTask % NLEAVES];
+
+    dp->versions[aTask] = tp->GetVersion();
+    dp->results[aTask] = tp->GetTransformMatrix();
+    return;
+}
+
+
+void testConcurrent( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: concurrent evaluation of " << NLEAVES << " transforms with a shared base\n";
+
+    IGES model;
+    IGES_ENTITY_124* base = newTransform( model, NULL, 0.0, 0.0, 0.0, 0.0 );
+    IGES_ENTITY_124* mid = base ? newTransform( model, base, 0.0, 0.0, 0.0, 0.0 ) : NULL;
+    CONCURRENT_DATA* dp = new CONCURRENT_DATA;
+    bool ok = ( NULL != mid );
+
+    for( int i = 0; i < NLEAVES && ok; ++i )
+    {
+        dp->leaves[i] = newTransform( model, mid, 0.1 * i, i, -i, 0.5 * i );
+
+        if( NULL == dp->leaves[i] )
+            ok = false;
+    }
+
+    if( !ok )
+        cerr << "  [FAIL]: could not create the transforms\n";
+
+    // each round modifies the shared transforms so that every cache is stale
+    for( int round = 0; round < 8 && ok; ++round )
+    {
+        setTransform( base->T, 0.2 * round, round, 1.0, 0.0 );
+        setTransform( mid->T, -0.3 * round, 0.0, round, 2.0 );
+        base->Touch();
+        mid->Touch();
+
+        IGES_WORK_POOL::Run( NTASKS, evalTransform, dp, 8 );
+
+        for( int i = 0; i < NTASKS && ok; ++i )
+        {
+            IGES_ENTITY_124* tp = dp->leaves[i % NLEAVES];
+
+            if( !checkTransform( dp->results[i], tp ) )
+            {
+                cerr << "  [FAIL]: incorrect transform in round " << round << "\n";
+                ok = false;
+            }
+            else if( dp->versions[i] != dp->versions[i % NLEAVES] )
+            {
+                cerr << "  [FAIL]: a transform was given several versions in round ";
+                cerr << round << "\n";
+                ok = false;
+            }
+        }
+    }
+
+    delete dp;
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}
+
+
+void testWorldTransforms( int& nTests, int& nFails )
+{
+    ++nTests;
+    cerr << "* Test: world transforms of all entities\n";
+
+    IGES model;
+    IGES_ENTITY_124* t0 = newTransform( model, NULL, 0.4, 1.0, 0.0, 0.0 );
+    IGES_ENTITY_124* t1 = t0 ? newTransform( model, t0, 1.3, 0.0, 3.0, 0.0 ) : NULL;
+    bool ok = ( NULL != t1 );
+
+    for( int i = 0; i < 30 && ok; ++i )
+    {
+        IGES_ENTITY* ep;
+
+        if( !model.NewEntity( ENT_LINE, &ep ) )
+        {
+            ok = false;
+            break;
+        }
+
+        // lines alternate between no transform and each of the transforms
+        if( i % 3 == 1 )
+            ok = ep->SetTransform( t0 );
+        else if( i % 3 == 2 )
+            ok = ep->SetTransform( t1 );
+    }
+
+    if( !ok )
+    {
+        cerr << "  [FAIL]: could not create the entities\n";
+        ++nFails;
+        return;
+    }
+
+    vector<IGES_ENTITY*> ents;
+    vector<MCAD_TRANSFORM> xforms;
+    model.GetWorldTransforms( &ents, xforms );
+
+    if( ents.size() != xforms.size() || ents.size() != 32 )
+    {
+        cerr << "  [FAIL]: expected 32 transforms, got " << xforms.size() << "\n";
+        ++nFails;
+        return;
+    }
+
+    for( size_t i = 0; i < ents.size() && ok; ++i )
+    {
+        IGES_ENTITY* tx = NULL;
+
+        if( !ents[i]->GetTransform( &tx ) )
+            tx = NULL;
+
+        if( !checkTransform( xforms[i], (IGES_ENTITY_124*)tx ) )
+        {
+            cerr << "  [FAIL]: incorrect transform for entity " << i << "\n";
+            ok = false;
+        }
+    }
+
+    if( ok )
+        cerr << "  [OK]\n";
+    else
+        ++nFails;
+
+    return;
+}